@@ -0,0 +1,384 @@
+/*
+ * SUMMARY:      Adaptive.c - Adaptive model time step
+ * USAGE:        Part of DHSVM
+ *
+ * AUTHOR:       DHSVM development team
+ * ORG:          University of Washington, Department of Civil Engineering
+ * E-MAIL:
+ * ORIG-DATE:    Oct-2026
+ * DESCRIPTION:  During dry periods in which the model state changes slowly
+ *               several base time steps are taken as one longer model time
+ *               step, with the station forcing averaged (precipitation
+ *               summed) over the base steps.  The base step is used as soon
+ *               as there is precipitation, snow melt or a change in the
+ *               stream outflow.
+ * DESCRIP-END.
+ * FUNCTIONS:    ChooseTimeStep()
+ *               EndTimeStep()
+ *               StepEndTime()
+ *               AggregateMetRecord()
+ *               StepShadow()
+ * COMMENTS:
+ * $Id: Adaptive.c,v 1.0 2026/10/17 Exp $
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "settings.h"
+#include "constants.h"
+#include "data.h"
+#include "DHSVMerror.h"
+#include "functions.h"
+#include "rad.h"
+
+static int IsDumpDate(DUMPSTRUCT *Dump, DATE *Date);
+static int IsQuiet(ADAPTIVESTRUCT *Adaptive, AGGREGATED *Total,
+		   CHANNEL *ChannelData);
+
+/*****************************************************************************
+  Function name: ChooseTimeStep()
+
+  Purpose      : Choose the number of base time steps in the next model time
+                 step and set the model time step accordingly
+
+  Required     :
+    OPTIONSTRUCT *Options     - Structure with different program options
+    TIMESTRUCT *Time          - Model time, with the base time step
+    DUMPSTRUCT *Dump          - Dump dates
+    int NSoilLayers           - Number of soil layers
+    int NStats                - Number of met stations
+    METLOCATION *Stat         - Met stations
+    SOLARGEOMETRY *SolarGeo   - Solar geometry of the current day
+    AGGREGATED *Total         - Basin totals of the previous time step
+    CHANNEL *ChannelData      - Channel network
+
+  Returns      : void
+
+  Modifies     : Options->Adaptive, Time->Dt, the channel routing parameters
+
+  Comments     : A longer step is only taken if the previous step had no
+                 snow melt and no change in the stream outflow above the
+                 thresholds, and is cut short before the first base step
+                 with station precipitation above the threshold.  The
+                 number of base steps must divide the number of steps per
+                 day and the step must start at a multiple of its length, so
+                 that a model step never crosses midnight and the output
+                 records of a dry period are evenly spaced.  A model step
+                 never skips a state or map dump date or runs past the end
+                 of the model period.  The met files are read ahead and
+                 returned to their position, GetMetData() then reads and
+                 averages the records of the model step.
+*****************************************************************************/
+void ChooseTimeStep(OPTIONSTRUCT *Options, TIMESTRUCT *Time,
+		    DUMPSTRUCT *Dump, int NSoilLayers, int NStats,
+		    METLOCATION *Stat, SOLARGEOMETRY *SolarGeo,
+		    AGGREGATED *Total, CHANNEL *ChannelData)
+{
+  const char *Routine = "ChooseTimeStep";
+  ADAPTIVESTRUCT *Adaptive = &(Options->Adaptive);
+  TIMESTRUCT Next;		/* time of the base steps ahead */
+  MET Record;			/* met record of a base step ahead */
+  long *Position;		/* position in each met file */
+  int MaxSteps;			/* maximum number of base steps */
+  int Steps;			/* number of base steps in the model step */
+  int LastSteps;		/* base steps in the previous model step */
+  int i;
+  int k;
+  float SineSolarAltitude;
+  int DayLight;
+  float SolarTimeStep;
+  float SunMax;
+  float SolarAzimuth;
+
+  LastSteps = Adaptive->Steps;
+
+  /* the quiet criteria also update the stream outflow of the previous step,
+     so they are always evaluated */
+  MaxSteps = IsQuiet(Adaptive, Total, ChannelData) ?
+    Adaptive->MaxSteps : 1;
+
+  /* no model step crosses midnight, a dump date or the end of the run */
+  if (MaxSteps > Time->NDaySteps - Time->DayStep)
+    MaxSteps = Time->NDaySteps - Time->DayStep;
+  Next = *Time;
+  Next.Dt = Adaptive->Dt;
+  for (k = 1; k < MaxSteps; k++) {
+    IncreaseTime(&Next);
+    if (After(&(Next.Current), &(Time->End)) ||
+	IsDumpDate(Dump, &(Next.Current))) {
+      MaxSteps = k;
+      break;
+    }
+  }
+
+  /* look ahead for precipitation */
+  if (MaxSteps > 1) {
+    if (!(Position = (long *) calloc(NStats, sizeof(long))))
+      ReportError((char *) Routine, 1);
+    for (i = 0; i < NStats; i++)
+      Position[i] = ftell(Stat[i].MetFile.FilePtr);
+    Next = *Time;
+    Next.Dt = Adaptive->Dt;
+    for (k = 0; k < MaxSteps; k++) {
+      for (i = 0; i < NStats; i++) {
+	ReadMetRecord(Options, &(Next.Current), NSoilLayers,
+		      &(Stat[i].MetFile), Stat[i].IsWindModelLocation, &Record);
+	if (Record.Precip > Adaptive->PrecipThreshold)
+	  break;
+      }
+      if (i < NStats)
+	break;
+      IncreaseTime(&Next);
+    }
+    if (k < MaxSteps)
+      MaxSteps = (k > 0) ? k : 1;
+    for (i = 0; i < NStats; i++)
+      if (fseek(Stat[i].MetFile.FilePtr, Position[i], SEEK_SET) != 0)
+	ReportError(Stat[i].MetFile.FileName, 2);
+    free(Position);
+  }
+
+  for (Steps = MaxSteps; Steps > 1; Steps--)
+    if (Time->NDaySteps % Steps == 0 && Time->DayStep % Steps == 0)
+      break;
+
+  Adaptive->Steps = Steps;
+  Time->Dt = Steps * Adaptive->Dt;
+  Adaptive->NModelSteps++;
+  Adaptive->NBaseSteps += Steps;
+
+  /* the Muskingum-Cunge coefficients depend on the time step */
+  if (Steps != LastSteps && Options->HasNetwork) {
+    channel_routing_parameters(ChannelData->streams, Time->Dt);
+    channel_routing_parameters(ChannelData->roads, Time->Dt);
+  }
+
+  /* the shadow maps of the base steps are weighted with the extraterrestrial
+     radiation during each base step */
+  if (Steps > 1 && Options->Shading) {
+    for (k = 0; k < Steps; k++) {
+      SolarHour(SolarGeo->Latitude,
+		(Time->DayStep + k + 1) * ((float) Adaptive->Dt) / SECPHOUR,
+		((float) Adaptive->Dt) / SECPHOUR, SolarGeo->NoonHour,
+		SolarGeo->Declination, SolarGeo->Sunrise, SolarGeo->Sunset,
+		SolarGeo->TimeAdjustment, SolarGeo->SunEarthDistance,
+		&SineSolarAltitude, &DayLight, &SolarTimeStep, &SunMax,
+		&SolarAzimuth);
+      Adaptive->ShadowWeight[k] = SunMax;
+    }
+  }
+}
+
+/*****************************************************************************
+  Function name: EndTimeStep()
+
+  Purpose      : Advance the model time over the base steps of the model
+                 time step and restore the base time step
+
+  Required     :
+    ADAPTIVESTRUCT *Adaptive - Adaptive time step information
+    TIMESTRUCT *Time         - Model time
+
+  Returns      : void
+
+  Modifies     : Time
+
+  Comments     : The model time is always kept in base steps, so that
+                 Time->DayStep, the dump dates and the month and day
+                 boundaries are the same as in a run without adaptive steps
+*****************************************************************************/
+void EndTimeStep(ADAPTIVESTRUCT *Adaptive, TIMESTRUCT *Time)
+{
+  int k;
+
+  Time->Dt = Adaptive->Dt;
+  for (k = 0; k < Adaptive->Steps; k++)
+    IncreaseTime(Time);
+}
+
+/*****************************************************************************
+  Function name: StepEndTime()
+
+  Purpose      : Time at the end of the current model time step
+
+  Required     :
+    ADAPTIVESTRUCT *Adaptive - Adaptive time step information
+    TIMESTRUCT *Time         - Model time at the start of the step
+    TIMESTRUCT *End          - Time to set
+
+  Returns      : void
+
+  Modifies     : End
+
+  Comments     : Time->Step counts base steps, so the end of a longer model
+                 step is found by advancing over its base steps with the
+                 base time step, not with the model time step.  Used by the
+                 kinematic wave and road routing, which take sub-steps up to
+                 the end of the model step.  Without adaptive steps this is
+                 one IncreaseTime()
+*****************************************************************************/
+void StepEndTime(ADAPTIVESTRUCT *Adaptive, TIMESTRUCT *Time,
+		 TIMESTRUCT *End)
+{
+  int k;
+
+  *End = *Time;
+  End->Dt = Adaptive->Dt;
+  for (k = 0; k < Adaptive->Steps; k++)
+    IncreaseTime(End);
+  End->Dt = Time->Dt;
+}
+
+/*****************************************************************************
+  Function name: AggregateMetRecord()
+
+  Purpose      : Average the met records of a station over the base steps
+                 of the model time step
+
+  Required     :
+    OPTIONSTRUCT *Options - Structure with different program options
+    TIMESTRUCT *Time      - Model time
+    int NSoilLayers       - Number of soil layers
+    METLOCATION *Stat     - Met station, with the record of the first base
+                            step
+
+  Returns      : void
+
+  Modifies     : Stat->Data, Stat->MetFile
+
+  Comments     : The precipitation is summed, the other variables are
+                 averaged.  The wind direction of the first base step is
+                 kept
+*****************************************************************************/
+void AggregateMetRecord(OPTIONSTRUCT *Options, TIMESTRUCT *Time,
+			int NSoilLayers, METLOCATION *Stat)
+{
+  TIMESTRUCT Next;		/* time of the next base step */
+  MET Record;			/* met record of the next base step */
+  MET *Data = &(Stat->Data);
+  int Steps = Options->Adaptive.Steps;
+  int i;
+  int k;
+
+  Next = *Time;
+  Next.Dt = Options->Adaptive.Dt;
+  for (k = 1; k < Steps; k++) {
+    IncreaseTime(&Next);
+    ReadMetRecord(Options, &(Next.Current), NSoilLayers, &(Stat->MetFile),
+		  Stat->IsWindModelLocation, &Record);
+    Data->Tair += Record.Tair;
+    Data->TempLapse += Record.TempLapse;
+    Data->Rh += Record.Rh;
+    Data->Wind += Record.Wind;
+    Data->Sin += Record.Sin;
+    Data->Lin += Record.Lin;
+    Data->Precip += Record.Precip;
+    Data->PrecipLapse += Record.PrecipLapse;
+    if (Options->HeatFlux == TRUE)
+      for (i = 0; i < NSoilLayers; i++)
+	Data->Tsoil[i] += Record.Tsoil[i];
+  }
+
+  Data->Tair /= Steps;
+  Data->TempLapse /= Steps;
+  Data->Rh /= Steps;
+  Data->Wind /= Steps;
+  Data->Sin /= Steps;
+  Data->Lin /= Steps;
+  Data->PrecipLapse /= Steps;
+  if (Options->HeatFlux == TRUE)
+    for (i = 0; i < NSoilLayers; i++)
+      Data->Tsoil[i] /= Steps;
+}
+
+/*****************************************************************************
+  Function name: StepShadow()
+
+  Purpose      : Shadow value of a pixel over the base steps of the model
+                 time step
+
+  Required     :
+    ADAPTIVESTRUCT *Adaptive  - Adaptive time step information
+    uchar ***ShadowMap        - Shadow map for each base step of the day
+    int DayStep               - First base step of the model step
+    int y                     - Row of the pixel
+    int x                     - Column of the pixel
+
+  Returns      : uchar - shadow value weighted with the extraterrestrial
+                 radiation of each base step
+
+  Modifies     : void
+
+  Comments     : Falls back to the first base step at night
+*****************************************************************************/
+uchar StepShadow(ADAPTIVESTRUCT *Adaptive, uchar ***ShadowMap, int DayStep,
+		 int y, int x)
+{
+  float Shadow = 0.0;
+  float WeightSum = 0.0;
+  int k;
+
+  for (k = 0; k < Adaptive->Steps; k++) {
+    Shadow += Adaptive->ShadowWeight[k] * ShadowMap[DayStep + k][y][x];
+    WeightSum += Adaptive->ShadowWeight[k];
+  }
+
+  if (WeightSum <= 0.0)
+    return ShadowMap[DayStep][y][x];
+
+  return (uchar) (Shadow / WeightSum + 0.5);
+}
+
+/*****************************************************************************
+  IsDumpDate()
+*****************************************************************************/
+static int IsDumpDate(DUMPSTRUCT *Dump, DATE *Date)
+{
+  int i;
+  int j;
+
+  for (i = 0; i < Dump->NStates; i++)
+    if (IsEqualTime(Date, &(Dump->DState[i])))
+      return TRUE;
+
+  for (i = 0; i < Dump->NMaps; i++)
+    for (j = 0; j < Dump->DMap[i].N; j++)
+      if (IsEqualTime(Date, &(Dump->DMap[i].DumpDate[j])))
+	return TRUE;
+
+  return FALSE;
+}
+
+/*****************************************************************************
+  IsQuiet()
+
+  TRUE if the snow melt and the change in the stream outflow during the
+  previous model time step are below the thresholds.  Also stores the stream
+  outflow of the previous step for the next call.
+*****************************************************************************/
+static int IsQuiet(ADAPTIVESTRUCT *Adaptive, AGGREGATED *Total,
+		   CHANNEL *ChannelData)
+{
+  Channel *Segment;
+  float Flow = 0.0;
+  float LastFlow = Adaptive->LastFlow;
+  int Quiet = TRUE;
+
+  if (Total->Snow.Melt / Adaptive->Steps > Adaptive->MeltThreshold)
+    Quiet = FALSE;
+
+  if (ChannelData->streams != NULL) {
+    for (Segment = ChannelData->streams; Segment != NULL;
+	 Segment = Segment->next)
+      if (Segment->outlet == NULL)
+	Flow += Segment->outflow;
+    Flow /= (float) (Adaptive->Steps * Adaptive->Dt);
+    Adaptive->LastFlow = Flow;
+    if (LastFlow < 0.0 ||
+	fabs(Flow - LastFlow) > Adaptive->FlowThreshold * LastFlow)
+      Quiet = FALSE;
+  }
+
+  return Quiet;
+}
@@ -57,15 +57,21 @@ void Aggregate(MAPSIZE *Map, OPTIONSTRUCT *Options, TOPOPIX **TopoMap,
   int jj;				/* FineMap counter */
   int xx;				/* x-coordinate on FineMap grid */
   int yy;				/* y-coordinate on FineMap grid */
+  float LastGlacier;		/* Glacier total before this time step */
+  double RoadArea;		/* Road area summed over the MPI ranks */
 
   NPixels = 0;
   *roadarea = 0.;
   NPixelsfine = 0;
+  LastGlacier = Total->Snow.Glacier;
 
   for (y = 0; y < Map->NY; y++) {
     for (x = 0; x < Map->NX; x++) {
       if (INBASIN(TopoMap[y][x].Mask)) {
 		  NPixels++;
+		  /* in an MPI run the other pixels are added by their own rank */
+		  if (!ISOWNED(Options->Parallel, y, x))
+			  continue;
 		  NSoilL = Soil->NLayers[SoilMap[y][x].Soil - 1];
 		  NVegL = Veg->NLayers[VegMap[y][x].Veg - 1];
 		  
@@ -122,51 +128,53 @@ void Aggregate(MAPSIZE *Map, OPTIONSTRUCT *Options, TOPOPIX **TopoMap,
 		Total->Snow.VaporMassFlux += Snow[y][x].VaporMassFlux;
 		Total->Snow.CanopyVaporMassFlux += Snow[y][x].CanopyVaporMassFlux;
 
-		/* aggregate soil moisture data */
-		Total->Soil.Depth += SoilMap[y][x].Depth;
-		DeepDepth = 0.0;
+		/* aggregate soil moisture data, the soil water is only simulated in
+		   FULL_MODEL runs */
+		if (Options->Components == FULL_MODEL) {
+			DeepDepth = 0.0;
 
-		for (i = 0; i < NSoilL; i++) {
-			Total->Soil.Moist[i] += SoilMap[y][x].Moist[i];
-			assert(SoilMap[y][x].Moist[i] >= 0.0);
-			Total->Soil.Perc[i] += SoilMap[y][x].Perc[i];
-			Total->Soil.Temp[i] += SoilMap[y][x].Temp[i];
-			Total->SoilWater += SoilMap[y][x].Moist[i] * VType[VegMap[y][x].Veg - 1].RootDepth[i] * Network[y][x].Adjust[i]; 
-			DeepDepth += VType[VegMap[y][x].Veg - 1].RootDepth[i];
-		}
+			for (i = 0; i < NSoilL; i++) {
+				Total->Soil.Moist[i] += SoilMap[y][x].Moist[i];
+				assert(SoilMap[y][x].Moist[i] >= 0.0);
+				Total->Soil.Perc[i] += SoilMap[y][x].Perc[i];
+				Total->Soil.Temp[i] += SoilMap[y][x].Temp[i];
+				Total->SoilWater += SoilMap[y][x].Moist[i] * VType[VegMap[y][x].Veg - 1].RootDepth[i] * Network[y][x].Adjust[i]; 
+				DeepDepth += VType[VegMap[y][x].Veg - 1].RootDepth[i];
+			}
 
-		Total->Soil.Moist[Soil->MaxLayers] += SoilMap[y][x].Moist[NSoilL];
-		Total->SoilWater += SoilMap[y][x].Moist[NSoilL] * (SoilMap[y][x].Depth - DeepDepth) * Network[y][x].Adjust[NSoilL];
-		Total->Soil.TableDepth += SoilMap[y][x].TableDepth;
+			Total->Soil.Moist[Soil->MaxLayers] += SoilMap[y][x].Moist[NSoilL];
+			Total->SoilWater += SoilMap[y][x].Moist[NSoilL] * (SOILDEPTH(SoilMap[y][x]) - DeepDepth) * Network[y][x].Adjust[NSoilL];
+			Total->Soil.TableDepth += SoilMap[y][x].TableDepth;
 
-		if (SoilMap[y][x].TableDepth <= 0)
-			(Total->Saturated)++;
+			if (SoilMap[y][x].TableDepth <= 0)
+				(Total->Saturated)++;
 		
-		Total->Soil.WaterLevel += SoilMap[y][x].WaterLevel;
-		Total->Soil.SatFlow += SoilMap[y][x].SatFlow;
-		Total->Soil.TSurf += SoilMap[y][x].TSurf;
-		Total->Soil.Qnet += SoilMap[y][x].Qnet;
-		Total->Soil.Qs += SoilMap[y][x].Qs;
-		Total->Soil.Qe += SoilMap[y][x].Qe;
-		Total->Soil.Qg += SoilMap[y][x].Qg;
-		Total->Soil.Qst += SoilMap[y][x].Qst;
-		Total->Soil.IExcess += SoilMap[y][x].IExcess;
-		Total->Soil.DetentionStorage += SoilMap[y][x].DetentionStorage;
-		if(Options->RoadRouting){
-			if (Network[y][x].RoadArea > 0) {
-				for (i = 0; i < CELLFACTOR; i++)
-					Total->Road.IExcess += (Network[y][x].h[i]* Network[y][x].RoadArea)/((float)CELLFACTOR * (Map->DX*Map->DY));
+			Total->Soil.WaterLevel += SoilMap[y][x].WaterLevel;
+			Total->Soil.SatFlow += SoilMap[y][x].SatFlow;
+			Total->Soil.TSurf += SoilMap[y][x].TSurf;
+			Total->Soil.Qnet += SoilMap[y][x].Qnet;
+			Total->Soil.Qs += SoilMap[y][x].Qs;
+			Total->Soil.Qe += SoilMap[y][x].Qe;
+			Total->Soil.Qg += SoilMap[y][x].Qg;
+			Total->Soil.Qst += SoilMap[y][x].Qst;
+			Total->Soil.IExcess += SoilMap[y][x].IExcess;
+			Total->Soil.DetentionStorage += SoilMap[y][x].DetentionStorage;
+			if(Options->RoadRouting){
+				if (Network[y][x].RoadArea > 0) {
+					for (i = 0; i < CELLFACTOR; i++)
+						Total->Road.IExcess += (Network[y][x].h[i]* Network[y][x].RoadArea)/((float)CELLFACTOR * (Map->DX*Map->DY));
+				}
 			}
-		}
 		
-		if (Options->Infiltration == DYNAMIC)
-			Total->Soil.InfiltAcc += SoilMap[y][x].InfiltAcc;
+			if (Options->Infiltration == DYNAMIC)
+				Total->Soil.InfiltAcc += SoilMap[y][x].InfiltAcc;
 		
-		Total->Runoff += SoilMap[y][x].Runoff;
-		Total->ChannelInt += SoilMap[y][x].ChannelInt;
-		SoilMap[y][x].ChannelInt = 0.0;
-		Total->RoadInt += SoilMap[y][x].RoadInt;
-		SoilMap[y][x].RoadInt = 0.0;
+			Total->Runoff += SoilMap[y][x].Runoff;
+			Total->ChannelInt += SoilMap[y][x].ChannelInt;
+			SoilMap[y][x].ChannelInt = 0.0;
+			Total->RoadInt += SoilMap[y][x].RoadInt;
+			SoilMap[y][x].RoadInt = 0.0;
+		}
 		
 		if(Options->Sediment){
 			if (Options->SurfaceErosion) {
@@ -192,6 +200,15 @@ void Aggregate(MAPSIZE *Map, OPTIONSTRUCT *Options, TOPOPIX **TopoMap,
       }
     }
   }
+  /* sum the totals over the ranks of an MPI run */
+  ReduceAggregate(Options, Soil, Veg, Total, LastGlacier);
+  if (Options->Parallel.Active) {
+    RoadArea = *roadarea;
+    SumOverRanks(&(Options->Parallel), &RoadArea, 1);
+    *roadarea = (float) RoadArea;
+    NPixels = (int) Options->Parallel.NCells;
+  }
+
   /* divide road area by pixel area so it can be used to calculate depths
      over the road surface in FinalMassBalancs */
   *roadarea /= Map->DX * Map->DY * NPixels;
@@ -248,7 +265,6 @@ void Aggregate(MAPSIZE *Map, OPTIONSTRUCT *Options, TOPOPIX **TopoMap,
   Total->Snow.CanopyVaporMassFlux /= NPixels;
 
   /* average soil moisture data */
-  Total->Soil.Depth /= NPixels;
   for (i = 0; i < Soil->MaxLayers; i++) {
     Total->Soil.Moist[i] /= NPixels;
     Total->Soil.Perc[i] /= NPixels;
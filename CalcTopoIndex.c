@@ -20,6 +20,7 @@
 #include "data.h"
 #include "settings.h"
 #include "slopeaspect.h"
+#include "compact.h"
 
 #define VERTRES 1 /* vertical resolution of the dem */
 
@@ -76,7 +77,8 @@ void CalcTopoIndex(MAPSIZE *Map, FINEPIX ***FineMap, TOPOPIX **TopoMap)
   FILE *fo;
   char topoindexmap[100];
   int printmap;
-  int i, j, k, x, y, n, lower;  /* counters */
+  int i, j, x, y, n, lower;  /* counters */
+  long k;			/* index in OrderedCellsfine */
   int dx, dy;
   float celev;
   float neighbor_elev[NNEIGHBORS];
@@ -145,7 +147,7 @@ void CalcTopoIndex(MAPSIZE *Map, FINEPIX ***FineMap, TOPOPIX **TopoMap)
       
       /* Save the elevation, y, and x in the ITEM structure. */
       if (INBASIN(TopoMap[coarsei][coarsej].Mask)) {
-	OrderedCellsfine[k].Rank = (*FineMap[y][x]).Dem;
+	OrderedCellsfine[k].Rank = FINEDEM(*FineMap[y][x]);
 	OrderedCellsfine[k].y = y;
 	OrderedCellsfine[k].x = x;
 	k++;
@@ -188,7 +190,7 @@ void CalcTopoIndex(MAPSIZE *Map, FINEPIX ***FineMap, TOPOPIX **TopoMap)
         if (INBASIN(TopoMap[coarsei][coarsej].Mask)){
 
 	  // Solve for all grid cells within the coarse mask, not just the fine mask. 
-	  neighbor_elev[n] = ((TopoMap[coarsei][coarsej].Mask) ? (*FineMap[yn][xn]).Dem : (float) OUTSIDEBASIN);
+	  neighbor_elev[n] = ((TopoMap[coarsei][coarsej].Mask) ? FINEDEM(*FineMap[yn][xn]) : (float) OUTSIDEBASIN);
 
         }
 
@@ -196,7 +198,7 @@ void CalcTopoIndex(MAPSIZE *Map, FINEPIX ***FineMap, TOPOPIX **TopoMap)
 
     }
     
-    celev = (*FineMap[y][x]).Dem; 
+    celev = FINEDEM(*FineMap[y][x]); 
     
     switch (NNEIGHBORS) { 
     case 8:
@@ -285,7 +287,7 @@ void CalcTopoIndex(MAPSIZE *Map, FINEPIX ***FineMap, TOPOPIX **TopoMap)
     y = OrderedCellsfine[k].y;
     x = OrderedCellsfine[k].x;
     
-    (*FineMap[y][x]).TopoIndex = log(a[y][x]/tanbeta[y][x]);
+    SETFINETOPOINDEX(*FineMap[y][x], log(a[y][x]/tanbeta[y][x]));
   }
   
   /*************************************************************************/
@@ -320,7 +322,7 @@ void CalcTopoIndex(MAPSIZE *Map, FINEPIX ***FineMap, TOPOPIX **TopoMap)
 	
         /* Check to make sure region is in the basin. */
         if (INBASIN(TopoMap[i][j].Mask)) 	
-	   	fprintf(fo, "%2.3f ", (*FineMap[y][x]).TopoIndex);
+	   	fprintf(fo, "%2.3f ", FINETOPOINDEX(*FineMap[y][x]));
 	  /*   fprintf(fo, "%2.3f ", log(a[y][x])); */ 
 	/*   fprintf(fo, "%2.3f ", log(1/tanbeta[y][x])); */
 	else 
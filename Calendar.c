@@ -467,7 +467,7 @@ double GregorianToJulianDay(int year, int mon, int day, int h, int mi,
 void JulianDayToGregorian(double jd, int *y, int *m, int *d, int *h, int *mi,
 			  double *sec)
 {
-  static int ret[4];
+  int ret[4];
 
   long j = jd;
   double tmp, frac = jd - j;
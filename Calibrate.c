@@ -0,0 +1,420 @@
+/*
+ * SUMMARY:      Calibrate.c - Evaluate calibration parameter sets
+ * USAGE:        Part of DHSVM
+ *
+ * AUTHOR:       DHSVM development team
+ * ORG:          University of Washington, Department of Civil Engineering
+ * E-MAIL:
+ * ORIG-DATE:    Oct-2026
+ * DESCRIPTION:  The model is initialized once, including the initial model
+ *               state, after which a separate process is forked for each
+ *               parameter set.  Each process starts from the initial state in
+ *               memory, applies its parameter set to the soil and vegetation
+ *               tables and only writes the stream flow of its run.
+ *               Parameter sets are read one line at a time, so they can be
+ *               written to the standard input by an optimizer while earlier
+ *               sets are still running.
+ * DESCRIP-END.
+ * FUNCTIONS:    InitCalibration()
+ *               RunCalibration()
+ *               ApplyCalibration()
+ *               InitCalibrationDump()
+ * COMMENTS:
+ * $Id: Calibrate.c,v 1.0 2026/10/17 Exp $
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "settings.h"
+#include "constants.h"
+#include "data.h"
+#include "DHSVMerror.h"
+#include "fileio.h"
+#include "functions.h"
+#include "soilmoisture.h"
+
+/* Calibration parameters.  The soil parameters come first, a parameter
+   with an index of FIRSTVEGPARAM or higher is a vegetation parameter */
+enum CALIBPARAMS {
+  CAL_KSLAT = 0, CAL_KSLATEXP, CAL_KS, CAL_POROSITY, CAL_FCAP, CAL_WP,
+  CAL_MAXINFILT, CAL_RSMIN, CAL_RSMAX, CAL_MOISTTHRES, CAL_VPDTHRES,
+  NCALIBPARAMS
+};
+#define FIRSTVEGPARAM CAL_RSMIN
+
+static char *ParamNames[NCALIBPARAMS] = {
+  "KSLAT", "KSLATEXP", "KS", "POROSITY", "FCAP", "WP", "MAXINFILT",
+  "RSMIN", "RSMAX", "MOISTTHRES", "VPDTHRES"
+};
+
+static int ReadParameterSet(CALIBRATIONSTRUCT *Calibration, int *LineNo);
+
+/*****************************************************************************
+  Function name: InitCalibration()
+
+  Purpose      : Open the file with calibration parameter sets
+
+  Required     :
+    char *CalibrationFile        - File with one parameter set per line, or
+                                   "-" for the standard input
+    CALIBRATIONSTRUCT *Calibration - Calibration information
+
+  Returns      : void
+
+  Modifies     : Calibration->In, Calibration->Active
+
+  Comments     : Each line is "name PARAM=value PARAM:type=value ...".  A
+                 parameter without a type is set for all soil or vegetation
+                 types, a type is the 1-based class number in the soil or
+                 vegetation table.  The soil parameters are KSLAT, KSLATEXP,
+                 KS, POROSITY, FCAP, WP and MAXINFILT, the vegetation
+                 parameters RSMIN, RSMAX, MOISTTHRES and VPDTHRES.  Layered
+                 parameters are set for all layers.  The parameters are
+                 applied from left to right, and a set without parameters
+                 reproduces the run without calibration.  Empty lines and
+                 lines starting with '#' are skipped.
+*****************************************************************************/
+void InitCalibration(char *CalibrationFile, CALIBRATIONSTRUCT *Calibration)
+{
+  if (strcmp(CalibrationFile, "-") == 0)
+    Calibration->In = stdin;
+  else
+    OpenFile(&(Calibration->In), CalibrationFile, "r", FALSE);
+
+  /* the input is shared with the forked processes, which would move the
+     file offset back to the end of the last line when they exit if the
+     parent had read ahead */
+  setvbuf(Calibration->In, NULL, _IONBF, 0);
+
+  Calibration->NParams = 0;
+  Calibration->Active = TRUE;
+}
+
+/*****************************************************************************
+  Function name: RunCalibration()
+
+  Purpose      : Fork one process for each parameter set, with no more than
+                 Calibration->MaxProcesses sets running at the same time
+
+  Required     :
+    CALIBRATIONSTRUCT *Calibration - Calibration information
+    int NStats                     - Number of met stations
+    METLOCATION *Stat              - Met stations
+
+  Returns      : void
+
+  Modifies     : Calibration, the met file pointers in the child processes
+
+  Comments     : Only returns in the child processes, with the parameter set
+                 of the process in Calibration.  The parent reads the next
+                 set when a process slot is free, waits for all sets at the
+                 end of the input and exits with EXIT_FAILURE if any of them
+                 failed.  A forked process shares the file offset of the met
+                 station files with its parent, so each set opens its own
+                 copy.
+*****************************************************************************/
+void RunCalibration(CALIBRATIONSTRUCT *Calibration, int NStats,
+		    METLOCATION *Stat)
+{
+  const char *Routine = "RunCalibration";
+  char (*Running)[BUFSIZE + 1];	/* name of the set in each process slot */
+  pid_t *Pid;			/* process id in each process slot, 0 if free */
+  pid_t NewPid;
+  int ExitStatus;		/* exit status of a parameter set */
+  int LineNo;			/* line number in the parameter set input */
+  int NSets;			/* Number of sets started */
+  int NRunning;			/* Number of sets running */
+  int NFailed;			/* Number of sets that failed */
+  int i;			/* counter */
+
+  if (!(Running = calloc(Calibration->MaxProcesses, sizeof(*Running))))
+    ReportError((char *) Routine, 1);
+  if (!(Pid = (pid_t *) calloc(Calibration->MaxProcesses, sizeof(pid_t))))
+    ReportError((char *) Routine, 1);
+
+  printf("\nSTARTING CALIBRATION, %d PARAMETER SETS AT A TIME\n\n",
+	 Calibration->MaxProcesses);
+
+  LineNo = 0;
+  NSets = 0;
+  NRunning = 0;
+  NFailed = 0;
+  while (ReadParameterSet(Calibration, &LineNo)) {
+    if (NRunning == Calibration->MaxProcesses) {
+      i = WaitForProcess((char *) Routine, Pid, Calibration->MaxProcesses,
+			 &ExitStatus);
+      NFailed += ProcessFailed("Parameter set", Running[i], ExitStatus);
+      NRunning--;
+    }
+    for (i = 0; i < Calibration->MaxProcesses; i++)
+      if (Pid[i] == 0)
+	break;
+
+    /* flush the output first, otherwise it is printed again by the child */
+    fflush(stdout);
+    fflush(stderr);
+
+    NewPid = fork();
+    if (NewPid == -1)
+      ReportError(Calibration->Name, 84);
+    if (NewPid == 0) {
+      free(Running);
+      free(Pid);
+      for (i = 0; i < NStats; i++) {
+	fclose(Stat[i].MetFile.FilePtr);
+	OpenFile(&(Stat[i].MetFile.FilePtr), Stat[i].MetFile.FileName, "r",
+		 FALSE);
+      }
+      return;
+    }
+    Pid[i] = NewPid;
+    strcpy(Running[i], Calibration->Name);
+    printf("Started parameter set %s (process %d)\n", Calibration->Name,
+	   (int) NewPid);
+    NSets++;
+    NRunning++;
+  }
+  for (; NRunning > 0; NRunning--) {
+    i = WaitForProcess((char *) Routine, Pid, Calibration->MaxProcesses,
+		       &ExitStatus);
+    NFailed += ProcessFailed("Parameter set", Running[i], ExitStatus);
+  }
+
+  printf("\nEND OF CALIBRATION, %d OF %d PARAMETER SETS FAILED\n\n", NFailed,
+	 NSets);
+
+  exit(NFailed > 0 ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+
+/*****************************************************************************
+  Function name: ApplyCalibration()
+
+  Purpose      : Apply the parameter set of a calibration process and update
+                 the model state that is derived from the soil parameters
+
+  Required     :
+    CALIBRATIONSTRUCT *Calibration - Calibration information
+    MAPSIZE *Map                   - Size and location of model area
+    LAYER *Soil                    - Soil layer information
+    LAYER *Veg                     - Vegetation layer information
+    SOILTABLE *SType               - Soil parameters
+    VEGTABLE *VType                - Vegetation parameters
+    TOPOPIX **TopoMap              - Topography
+    SOILPIX **SoilMap              - Soil moisture
+    VEGPIX **VegMap                - Vegetation map
+    ROADSTRUCT **Network           - Road and channel cut information
+
+  Returns      : void
+
+  Modifies     : SType, VType, SoilMap
+
+  Comments     : The tables are shared with the calibration parent until they
+                 are modified here.  As in InitModelState() the soil moisture
+                 is kept at or above the wilting point and the field capacity
+                 of the deep layer, after which the water table depth is
+                 calculated with the new porosity and field capacity.
+*****************************************************************************/
+void ApplyCalibration(CALIBRATIONSTRUCT *Calibration, MAPSIZE *Map,
+		      LAYER *Soil, LAYER *Veg, SOILTABLE *SType,
+		      VEGTABLE *VType, TOPOPIX **TopoMap, SOILPIX **SoilMap,
+		      VEGPIX **VegMap, ROADSTRUCT **Network)
+{
+  CALIBPARAM *Param;
+  SOILTABLE *ST;
+  VEGTABLE *VT;
+  int NSoil;			/* Number of soil layers */
+  int NTypes;			/* Number of soil or vegetation types */
+  int i;			/* counter */
+  int j;			/* counter */
+  int k;			/* counter */
+  int x;			/* counter */
+  int y;			/* counter */
+
+  for (i = 0; i < Calibration->NParams; i++) {
+    Param = &(Calibration->Params[i]);
+    NTypes = Param->Id < FIRSTVEGPARAM ? Soil->NTypes : Veg->NTypes;
+    if (Param->Type > NTypes) {
+      sprintf(errorstr, "%s, %s:%d", Calibration->Name,
+	      ParamNames[Param->Id], Param->Type);
+      ReportError(errorstr, 83);
+    }
+    for (j = 0; j < NTypes; j++) {
+      if (Param->Type != 0 && Param->Type != j + 1)
+	continue;
+      /* j counts the soil types for a soil parameter and the vegetation
+	 types for a vegetation parameter, only index the matching table */
+      ST = Param->Id < FIRSTVEGPARAM ? &(SType[j]) : NULL;
+      VT = Param->Id < FIRSTVEGPARAM ? NULL : &(VType[j]);
+      switch (Param->Id) {
+      case CAL_KSLAT:
+	ST->KsLat = Param->Value;
+	break;
+      case CAL_KSLATEXP:
+	ST->KsLatExp = Param->Value;
+	break;
+      case CAL_KS:
+	for (k = 0; k < Soil->NLayers[j]; k++)
+	  ST->Ks[k] = Param->Value;
+	break;
+      case CAL_POROSITY:
+	for (k = 0; k < Soil->NLayers[j]; k++)
+	  ST->Porosity[k] = Param->Value;
+	break;
+      case CAL_FCAP:
+	for (k = 0; k < Soil->NLayers[j]; k++)
+	  ST->FCap[k] = Param->Value;
+	break;
+      case CAL_WP:
+	for (k = 0; k < Soil->NLayers[j]; k++)
+	  ST->WP[k] = Param->Value;
+	break;
+      case CAL_MAXINFILT:
+	ST->MaxInfiltrationRate = Param->Value;
+	break;
+      case CAL_RSMIN:
+	for (k = 0; k < VT->NVegLayers; k++)
+	  VT->RsMin[k] = Param->Value;
+	break;
+      case CAL_RSMAX:
+	for (k = 0; k < VT->NVegLayers; k++)
+	  VT->RsMax[k] = Param->Value;
+	break;
+      case CAL_MOISTTHRES:
+	for (k = 0; k < VT->NVegLayers; k++)
+	  VT->MoistThres[k] = Param->Value;
+	break;
+      case CAL_VPDTHRES:
+	for (k = 0; k < VT->NVegLayers; k++)
+	  VT->VpdThres[k] = Param->Value;
+	break;
+      }
+    }
+  }
+
+  for (y = 0; y < Map->NY; y++) {
+    for (x = 0; x < Map->NX; x++) {
+      if (!INBASIN(TopoMap[y][x].Mask) || !SoilMap[y][x].Moist)
+	continue;
+      ST = &(SType[SoilMap[y][x].Soil - 1]);
+      NSoil = Soil->NLayers[SoilMap[y][x].Soil - 1];
+      for (k = 0; k < NSoil; k++)
+	if (SoilMap[y][x].Moist[k] < ST->WP[NSoil - 1])
+	  SoilMap[y][x].Moist[k] = ST->WP[NSoil - 1];
+      if (SoilMap[y][x].Moist[NSoil] < ST->FCap[NSoil - 1])
+	SoilMap[y][x].Moist[NSoil] = ST->FCap[NSoil - 1];
+      SoilMap[y][x].TableDepth =
+	WaterTableDepth(NSoil, SOILDEPTH(SoilMap[y][x]),
+			VType[VegMap[y][x].Veg - 1].RootDepth, ST->Porosity,
+			ST->FCap, Network[y][x].Adjust, SoilMap[y][x].Moist);
+      if (SoilMap[y][x].TableDepth < 0.0)
+	SoilMap[y][x].TableDepth = 0.0;
+    }
+  }
+}
+
+/*****************************************************************************
+  Function name: InitCalibrationDump()
+
+  Purpose      : Create the output directory of a parameter set and send
+                 the standard output and standard error of the set to it
+
+  Required     :
+    CALIBRATIONSTRUCT *Calibration - Calibration information
+    char *Path                     - Output directory
+
+  Returns      : void
+
+  Modifies     : Path, stdout, stderr
+
+  Comments     : The set directory is a subdirectory of the output directory
+                 with the name of the set.  The stream flow, which is opened
+                 after this call, is the only model output of a calibration
+                 run, the output that InitDump() opened in the parent is left
+                 alone.
+*****************************************************************************/
+void InitCalibrationDump(CALIBRATIONSTRUCT *Calibration, char *Path)
+{
+  char FileName[BUFSIZE + 1];
+
+  strcat(Path, Calibration->Name);
+  strcat(Path, "/");
+  if (mkdir(Path, 0755) != 0 && errno != EEXIST)
+    ReportError(Path, 81);
+
+  sprintf(FileName, "%sStandard.Out", Path);
+  if (!freopen(FileName, "w", stdout))
+    ReportError(FileName, 3);
+  sprintf(FileName, "%sStandard.Error", Path);
+  if (!freopen(FileName, "w", stderr))
+    ReportError(FileName, 3);
+
+  printf("Parameter set %s\n\n", Calibration->Name);
+}
+
+/*****************************************************************************
+  ReadParameterSet()
+
+  Reads the next parameter set into Calibration.  Returns FALSE at the end of
+  the input.
+*****************************************************************************/
+static int ReadParameterSet(CALIBRATIONSTRUCT *Calibration, int *LineNo)
+{
+  char Buffer[BUFSIZ + 1];
+  char *Str;
+  char *Token;
+  char *Value;
+  char *Type;
+  char *End;
+  CALIBPARAM *Param;
+
+  while (fgets(Buffer, BUFSIZ, Calibration->In)) {
+    (*LineNo)++;
+    if (!(Str = strtok(Buffer, " \t\r\n")) || *Str == '#')
+      continue;
+
+    if (strlen(Str) > BUFSIZE || strchr(Str, '/') != NULL ||
+	strchr(Str, '=') != NULL) {
+      sprintf(errorstr, "line %d", *LineNo);
+      ReportError(errorstr, 83);
+    }
+    strcpy(Calibration->Name, Str);
+
+    Calibration->NParams = 0;
+    while ((Token = strtok(NULL, " \t\r\n"))) {
+      if (Calibration->NParams == MAXCALIBPARAMS ||
+	  !(Value = strchr(Token, '='))) {
+	sprintf(errorstr, "line %d, %s", *LineNo, Token);
+	ReportError(errorstr, 83);
+      }
+      *Value++ = '\0';
+      Param = &(Calibration->Params[Calibration->NParams]);
+      Param->Type = 0;
+      if ((Type = strchr(Token, ':'))) {
+	*Type++ = '\0';
+	Param->Type = (int) strtol(Type, &End, 10);
+	if (End == Type || *End != '\0' || Param->Type < 1) {
+	  sprintf(errorstr, "line %d, %s", *LineNo, Token);
+	  ReportError(errorstr, 83);
+	}
+      }
+      for (Param->Id = 0; Param->Id < NCALIBPARAMS; Param->Id++)
+	if (strcmp(Token, ParamNames[Param->Id]) == 0)
+	  break;
+      Param->Value = (float) strtod(Value, &End);
+      if (Param->Id == NCALIBPARAMS || End == Value || *End != '\0' ||
+	  Param->Value < 0.0) {
+	sprintf(errorstr, "line %d, %s", *LineNo, Token);
+	ReportError(errorstr, 83);
+      }
+      Calibration->NParams++;
+    }
+    return TRUE;
+  }
+  return FALSE;
+}
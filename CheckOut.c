@@ -23,8 +23,8 @@
 #include "functions.h"
 #include "constants.h"
 
-void CheckOut(int CanopyRadAttOption, LAYER Veg, LAYER Soil, 
-	      VEGTABLE *VType, SOILTABLE *SType, MAPSIZE *Map, 
+void CheckOut(int CanopyRadAttOption, int ComponentsOption, LAYER Veg,
+	      LAYER Soil, VEGTABLE *VType, SOILTABLE *SType, MAPSIZE *Map, 
 	      TOPOPIX **TopoMap, VEGPIX **VegMap, SOILPIX **SoilMap)
 {
 
@@ -134,15 +134,18 @@ void CheckOut(int CanopyRadAttOption, LAYER Veg, LAYER Soil,
     }
   }
 
-  for (y = 0; y < Map->NY; y++) {
-    for (x = 0; x < Map->NX; x++) {
-      if (INBASIN(TopoMap[y][x].Mask)) {
-	if (SoilMap[y][x].Depth <= VType[VegMap[y][x].Veg - 1].TotalDepth) {
-	  printf("Error for class %d of Type %s  \n", VegMap[y][x].Veg,
-		 VType[VegMap[y][x].Veg - 1].Desc);
-	  printf("%d %d Soil depth is %f, Root depth is %f \n", y,x,SoilMap[y][x].Depth,
-		 VType[VegMap[y][x].Veg - 1].TotalDepth);
-	  exit(-1);
+  /* the soil depth is only read when the soil water is simulated */
+  if (ComponentsOption == FULL_MODEL) {
+    for (y = 0; y < Map->NY; y++) {
+      for (x = 0; x < Map->NX; x++) {
+	if (INBASIN(TopoMap[y][x].Mask)) {
+	  if (SOILDEPTH(SoilMap[y][x]) <= VType[VegMap[y][x].Veg - 1].TotalDepth) {
+	    printf("Error for class %d of Type %s  \n", VegMap[y][x].Veg,
+		   VType[VegMap[y][x].Veg - 1].Desc);
+	    printf("%d %d Soil depth is %f, Root depth is %f \n", y,x,SOILDEPTH(SoilMap[y][x]),
+		   VType[VegMap[y][x].Veg - 1].TotalDepth);
+	    exit(-1);
+	  }
 	}
       }
     }
@@ -0,0 +1,594 @@
+/*
+ * SUMMARY:      Clip.c - Clip the basin to the subbasin upstream of a target
+ * USAGE:        Part of DHSVM
+ *
+ * AUTHOR:       DHSVM development team
+ * ORG:          University of Washington, Department of Civil Engineering
+ * E-MAIL:
+ * ORIG-DATE:    Oct-2026
+ * DESCRIPTION:  When only the flow at one channel segment or outlet cell is
+ *               needed, the pixels that cannot contribute water to that
+ *               target are removed from the basin mask, the channel and road
+ *               segments that are not upstream of the target are removed
+ *               from the networks, and the model grid is cropped to the
+ *               bounding box of the subbasin.  Met stations that no longer
+ *               carry an interpolation weight are closed.  The maps and the
+ *               pixel loops only cover the bounding box, so the memory and
+ *               the run time follow the size of the subbasin.
+ * DESCRIP-END.
+ * FUNCTIONS:    ClipToSubbasin()
+ *               DropUnusedStations()
+ *               CropGrid()
+ * COMMENTS:     The maps that are read after the clip, the model state and
+ *               the output maps keep the size of the original grid, see
+ *               SetMapWindow() in FileIOBin.c
+ * $Id: Clip.c,v 1.0 2026/10/17 Exp $
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "settings.h"
+#include "constants.h"
+#include "data.h"
+#include "DHSVMerror.h"
+#include "fileio.h"
+#include "functions.h"
+#include "memtrack.h"
+#include "slopeaspect.h"
+
+static int MaxSegmentID(Channel *Head);
+static void MarkUpstream(Channel *Head, char *Marked);
+static int DropSegments(Channel **Head, char *Marked);
+static void AddPixel(MAPSIZE *Map, uchar *Upstream, long *Queue, long *NQueued,
+		     int y, int x);
+static void **CropRows(void **Rows, int NY, int NX, size_t Size,
+		       int y0, int x0, int NYCrop, int NXCrop, int Subsystem,
+		       const char *Structure);
+
+/*****************************************************************************
+  Function name: ClipToSubbasin()
+
+  Purpose      : Remove the pixels and channel and road segments that cannot
+                 contribute water to the clip target, and crop the model
+                 grid to the remaining pixels
+
+  Required     :
+    OPTIONSTRUCT *Options - Program options, with the clip target
+    MAPSIZE *Map          - Size and location of model area
+    LAYER *Soil           - Number of soil layers of each soil type
+    VEGTABLE *VType       - Vegetation parameters
+    TOPOPIX ***TopoMap    - Topography, with the flow directions
+    SOILPIX ***SoilMap    - Soil map
+    VEGPIX ***VegMap      - Vegetation map
+    ROADSTRUCT ***Network - Channel and road cuts of each pixel
+    CHANNEL *ChannelData  - Channel and road network
+    int NStats            - Number of met stations
+    METLOCATION *Stat     - Met stations
+
+  Returns      : void
+
+  Modifies     : Map, the maps, ChannelData, the locations of the stations
+
+  Comments     : The subbasin is found by walking the flow graph upstream from
+                 the target.  A pixel is upstream if it drains to an upstream
+                 pixel in any flow direction, if its impervious area drains
+                 to an upstream pixel, if it contains an upstream channel
+                 segment, or if it contains a road segment that drains to a
+                 culvert in an upstream pixel.  A channel segment is upstream
+                 if it is the target, lies in the target pixel, or drains to
+                 an upstream segment.  Flow from the subbasin into removed
+                 pixels never reaches the target, so the flow at the target
+                 is the same as without clipping.  Needs the flow directions
+                 of FLOW GRADIENT = TOPOGRAPHY, which do not change during the
+                 run, and CONVENTIONAL overland routing: the sub-step of the
+                 kinematic wave routing is set by the fastest pixel of the
+                 whole basin, so it would change with the clip.  Removed
+                 segments are unlinked but not freed, because
+                 the channel maps of removed pixels still point at them.
+
+                 The grid is cropped to the bounding box of the subbasin and
+                 of the pixels its impervious areas drain to, so that
+                 RouteSurface() can still add the impervious runoff of a
+                 pixel to its (removed) target.  The soil and network arrays
+                 of the removed pixels are freed.  Map->OffsetY and
+                 Map->OffsetX give the first row and column of the box in
+                 the original grid.
+*****************************************************************************/
+void ClipToSubbasin(OPTIONSTRUCT *Options, MAPSIZE *Map, LAYER *Soil,
+		    VEGTABLE *VType, TOPOPIX ***TopoMap, SOILPIX ***SoilMap,
+		    VEGPIX ***VegMap, ROADSTRUCT ***Network,
+		    CHANNEL *ChannelData, int NStats, METLOCATION *Stat)
+{
+  const char *Routine = "ClipToSubbasin";
+  Channel *Segment;
+  ChannelMapPtr Cell;
+  char *Streams;		/* TRUE for upstream channel segments */
+  char *Roads;			/* 1 for upstream road segments whose pixels
+				   have not been added yet, 2 once they are */
+  uchar *Upstream;		/* TRUE for upstream pixels */
+  long *Queue;			/* Upstream pixels that still have to be
+				   visited */
+  long *Drains;			/* First pixel whose impervious area drains to
+				   each pixel, -1 if none */
+  long *NextDrains;		/* Next pixel that drains to the same pixel */
+  long NQueued;			/* Number of pixels added to the queue */
+  long NVisited;			/* Number of pixels visited */
+  long NCells;			/* Number of pixels in the basin */
+  int NStreams;			/* Number of channel segments */
+  int NRoads;			/* Number of road segments */
+  long i;			/* counter */
+  long k;			/* counter */
+  int n;			/* counter */
+  int x;			/* counter */
+  int y;			/* counter */
+  int xn;			/* x-index of the neighbor */
+  int yn;			/* y-index of the neighbor */
+  int x0;			/* first column of the bounding box */
+  int x1;			/* last column of the bounding box */
+  int y0;			/* first row of the bounding box */
+  int y1;			/* last row of the bounding box */
+
+  if (!(Upstream = (uchar *) CallocMap(Map->NY, Map->NX, sizeof(uchar))))
+    ReportError((char *) Routine, 1);
+  if (!(Queue = (long *) CallocMap(Map->NY, Map->NX, sizeof(long))))
+    ReportError((char *) Routine, 1);
+  if (!(Drains = (long *) CallocMap(Map->NY, Map->NX, sizeof(long))))
+    ReportError((char *) Routine, 1);
+  if (!(NextDrains = (long *) CallocMap(Map->NY, Map->NX, sizeof(long))))
+    ReportError((char *) Routine, 1);
+  if (!(Streams = (char *) calloc(MaxSegmentID(ChannelData->streams) + 1,
+				  sizeof(char))))
+    ReportError((char *) Routine, 1);
+  if (!(Roads = (char *) calloc(MaxSegmentID(ChannelData->roads) + 1,
+				sizeof(char))))
+    ReportError((char *) Routine, 1);
+
+  /* pixels whose impervious area drains to each pixel, see RouteSurface() */
+  for (i = 0; i < (long) Map->NY * Map->NX; i++)
+    Drains[i] = -1;
+  for (y = 0; y < Map->NY; y++) {
+    for (x = 0; x < Map->NX; x++) {
+      if (INBASIN((*TopoMap)[y][x].Mask) &&
+	  VType[(*VegMap)[y][x].Veg - 1].ImpervFrac > 0.0 &&
+	  !channel_grid_has_channel(ChannelData->stream_map, x, y)) {
+	i = (long) (*TopoMap)[y][x].drains_y * Map->NX +
+	  (*TopoMap)[y][x].drains_x;
+	NextDrains[(long) y * Map->NX + x] = Drains[i];
+	Drains[i] = (long) y * Map->NX + x;
+      }
+    }
+  }
+
+  /* the target segment, or the target pixel and the segments in it */
+  NQueued = 0;
+  if (Options->Clip.Segment >= 0) {
+    if (!(Segment = channel_find_segment(ChannelData->streams,
+					 (SegmentID) Options->Clip.Segment))) {
+      sprintf(errorstr, "segment %d", Options->Clip.Segment);
+      ReportError(errorstr, 85);
+    }
+    Streams[Segment->id] = TRUE;
+  }
+  else {
+    y = Options->Clip.CellY;
+    x = Options->Clip.CellX;
+    if (!valid_cell(Map, x, y) || !INBASIN((*TopoMap)[y][x].Mask)) {
+      sprintf(errorstr, "pixel (%d, %d)", y, x);
+      ReportError(errorstr, 85);
+    }
+    for (Cell = ChannelData->stream_map[x][y]; Cell; Cell = Cell->next)
+      Streams[Cell->channel->id] = TRUE;
+    AddPixel(Map, Upstream, Queue, &NQueued, y, x);
+  }
+
+  /* all pixels with an upstream channel segment */
+  MarkUpstream(ChannelData->streams, Streams);
+  for (y = 0; y < Map->NY; y++)
+    for (x = 0; x < Map->NX; x++)
+      if (INBASIN((*TopoMap)[y][x].Mask))
+	for (Cell = ChannelData->stream_map[x][y]; Cell; Cell = Cell->next)
+	  if (Streams[Cell->channel->id])
+	    AddPixel(Map, Upstream, Queue, &NQueued, y, x);
+
+  /* walk upstream until no more pixels are added.  Road segments are only
+     found after all pixels that are reachable over land have been visited,
+     after which the pixels of the new road segments are walked in turn */
+  NVisited = 0;
+  do {
+    for (; NVisited < NQueued; NVisited++) {
+      y = Queue[NVisited] / Map->NX;
+      x = Queue[NVisited] % Map->NX;
+      for (n = 0; n < NDIRS; n++) {
+	xn = x + xdirection[n];
+	yn = y + ydirection[n];
+	if (valid_cell(Map, xn, yn) && INBASIN((*TopoMap)[yn][xn].Mask) &&
+	    (*TopoMap)[yn][xn].Dir[(n + 2) % NDIRS] > 0)
+	  AddPixel(Map, Upstream, Queue, &NQueued, yn, xn);
+      }
+      for (i = Drains[Queue[NVisited]]; i >= 0; i = NextDrains[i])
+	AddPixel(Map, Upstream, Queue, &NQueued, i / Map->NX, i % Map->NX);
+    }
+
+    if (ChannelData->roads != NULL) {
+      for (k = 0; k < NQueued; k++) {
+	y = Queue[k] / Map->NX;
+	x = Queue[k] % Map->NX;
+	for (Cell = ChannelData->road_map[x][y]; Cell; Cell = Cell->next)
+	  if (Cell->sink && !Roads[Cell->channel->id])
+	    Roads[Cell->channel->id] = 1;
+      }
+      MarkUpstream(ChannelData->roads, Roads);
+      for (y = 0; y < Map->NY; y++)
+	for (x = 0; x < Map->NX; x++)
+	  if (INBASIN((*TopoMap)[y][x].Mask))
+	    for (Cell = ChannelData->road_map[x][y]; Cell; Cell = Cell->next)
+	      if (Roads[Cell->channel->id] == 1)
+		AddPixel(Map, Upstream, Queue, &NQueued, y, x);
+      for (Segment = ChannelData->roads; Segment; Segment = Segment->next)
+	if (Roads[Segment->id] == 1)
+	  Roads[Segment->id] = 2;
+    }
+  } while (NVisited < NQueued);
+
+  /* remove everything that is not upstream */
+  NCells = Map->NumCells;
+  for (y = 0; y < Map->NY; y++)
+    for (x = 0; x < Map->NX; x++)
+      if (!Upstream[(size_t) y * Map->NX + x])
+	(*TopoMap)[y][x].Mask = OUTSIDEBASIN;
+
+  for (i = 0, k = 0; i < Map->NumCells; i++) {
+    y = Map->OrderedCells[i].y;
+    x = Map->OrderedCells[i].x;
+    if (INBASIN((*TopoMap)[y][x].Mask))
+      Map->OrderedCells[k++] = Map->OrderedCells[i];
+  }
+  Map->NumCells = k;
+
+  NStreams = DropSegments(&(ChannelData->streams), Streams);
+  NRoads = DropSegments(&(ChannelData->roads), Roads);
+
+  /* bounding box of the subbasin and of the targets of its impervious
+     runoff */
+  y0 = Map->NY;
+  y1 = -1;
+  x0 = Map->NX;
+  x1 = -1;
+  for (y = 0; y < Map->NY; y++) {
+    for (x = 0; x < Map->NX; x++) {
+      if (!Upstream[(size_t) y * Map->NX + x])
+	continue;
+      y0 = MIN(y0, y);
+      y1 = MAX(y1, y);
+      x0 = MIN(x0, x);
+      x1 = MAX(x1, x);
+      if (VType[(*VegMap)[y][x].Veg - 1].ImpervFrac > 0.0 &&
+	  !channel_grid_has_channel(ChannelData->stream_map, x, y)) {
+	yn = (*TopoMap)[y][x].drains_y;
+	xn = (*TopoMap)[y][x].drains_x;
+	y0 = MIN(y0, yn);
+	y1 = MAX(y1, yn);
+	x0 = MIN(x0, xn);
+	x1 = MAX(x1, xn);
+      }
+    }
+  }
+
+  printf("Clipped the basin to the %ld of %ld pixels upstream of ",
+	 Map->NumCells, NCells);
+  if (Options->Clip.Segment >= 0)
+    printf("segment %d\n", Options->Clip.Segment);
+  else
+    printf("pixel (%d, %d)\n", Options->Clip.CellY, Options->Clip.CellX);
+  printf("Removed %d channel segments and %d road segments\n", NStreams,
+	 NRoads);
+  printf("Cropped the grid of %d by %d pixels to the %d by %d pixels from "
+	 "row %d and column %d\n\n", Map->NY, Map->NX, y1 - y0 + 1,
+	 x1 - x0 + 1, y0, x0);
+
+  CropGrid(Map, Soil, VType, TopoMap, SoilMap, VegMap, Network, ChannelData,
+	   NStats, Stat, y0, x0, y1 - y0 + 1, x1 - x0 + 1);
+
+  FreeMap(Upstream);
+  FreeMap(Queue);
+  FreeMap(Drains);
+  FreeMap(NextDrains);
+  free(Streams);
+  free(Roads);
+}
+
+/*****************************************************************************
+  Function name: DropUnusedStations()
+
+  Purpose      : Close the met stations that have no interpolation weight in
+                 any pixel of the clipped basin
+
+  Required     :
+    OPTIONSTRUCT *Options - Program options
+    MAPSIZE *Map          - Size and location of model area
+    TOPOPIX **TopoMap     - Topography, with the basin mask
+    uchar ***MetWeights   - Station interpolation weights
+    int *NStats           - Number of met stations
+    METLOCATION *Stat     - Met stations
+
+  Returns      : void
+
+  Modifies     : NStats, Stat, MetWeights
+
+  Comments     : The remaining stations and their weights are moved to the
+                 front of the arrays, so their order is unchanged.  Stations
+                 that provide the wind for the wind model are always kept.
+                 Nothing is done when the met inputs come from MM5 only.
+*****************************************************************************/
+void DropUnusedStations(OPTIONSTRUCT *Options, MAPSIZE *Map,
+			TOPOPIX **TopoMap, uchar ***MetWeights, int *NStats,
+			METLOCATION *Stat)
+{
+  int Used;			/* TRUE if the station is used */
+  int NKept;			/* Number of stations kept */
+  int i;			/* counter */
+  int x;			/* counter */
+  int y;			/* counter */
+
+  if (Options->MM5 == TRUE && Options->QPF == FALSE)
+    return;
+
+  NKept = 0;
+  for (i = 0; i < *NStats; i++) {
+    Used = (Options->WindSource == MODEL && Stat[i].IsWindModelLocation);
+    for (y = 0; y < Map->NY && !Used; y++)
+      for (x = 0; x < Map->NX && !Used; x++)
+	if (INBASIN(TopoMap[y][x].Mask) && MetWeights[y][x][i] > 0)
+	  Used = TRUE;
+
+    if (!Used) {
+      printf("Met station %s is not used in the clipped basin\n",
+	     Stat[i].Name);
+      fclose(Stat[i].MetFile.FilePtr);
+      continue;
+    }
+    if (NKept < i) {
+      Stat[NKept] = Stat[i];
+      for (y = 0; y < Map->NY; y++)
+	for (x = 0; x < Map->NX; x++)
+	  if (INBASIN(TopoMap[y][x].Mask))
+	    MetWeights[y][x][NKept] = MetWeights[y][x][i];
+    }
+    NKept++;
+  }
+  printf("Using %d of %d met stations\n\n", NKept, *NStats);
+  *NStats = NKept;
+}
+
+/*****************************************************************************
+  MaxSegmentID()
+*****************************************************************************/
+static int MaxSegmentID(Channel *Head)
+{
+  int MaxID = 0;
+
+  for (; Head; Head = Head->next)
+    if (Head->id > MaxID)
+      MaxID = Head->id;
+  return MaxID;
+}
+
+/*****************************************************************************
+  MarkUpstream()
+
+  Marks all segments that drain to a marked segment.
+*****************************************************************************/
+static void MarkUpstream(Channel *Head, char *Marked)
+{
+  Channel *Segment;
+  int Changed;
+
+  do {
+    Changed = FALSE;
+    for (Segment = Head; Segment; Segment = Segment->next)
+      if (!Marked[Segment->id] && Segment->outlet &&
+	  Marked[Segment->outlet->id]) {
+	Marked[Segment->id] = 1;
+	Changed = TRUE;
+      }
+  } while (Changed);
+}
+
+/*****************************************************************************
+  DropSegments()
+
+  Unlinks the segments that are not marked.  Returns the number of segments
+  removed.
+*****************************************************************************/
+static int DropSegments(Channel **Head, char *Marked)
+{
+  Channel **Link;
+  int NDropped = 0;
+
+  for (Link = Head; *Link;) {
+    if (Marked[(*Link)->id])
+      Link = &((*Link)->next);
+    else {
+      *Link = (*Link)->next;
+      NDropped++;
+    }
+  }
+  return NDropped;
+}
+
+/*****************************************************************************
+  AddPixel()
+*****************************************************************************/
+static void AddPixel(MAPSIZE *Map, uchar *Upstream, long *Queue, long *NQueued,
+		     int y, int x)
+{
+  if (Upstream[(size_t) y * Map->NX + x])
+    return;
+  Upstream[(size_t) y * Map->NX + x] = TRUE;
+  Queue[(*NQueued)++] = (long) y * Map->NX + x;
+}
+
+/*****************************************************************************
+  Function name: CropGrid()
+
+  Purpose      : Crop the model grid to the NY by NX pixels from row y0 and
+                 column x0
+
+  Required     :
+    MAPSIZE *Map          - Size and location of model area
+    LAYER *Soil           - Number of soil layers of each soil type
+    VEGTABLE *VType       - Vegetation parameters
+    TOPOPIX ***TopoMap    - Topography
+    SOILPIX ***SoilMap    - Soil map
+    VEGPIX ***VegMap      - Vegetation map
+    ROADSTRUCT ***Network - Channel and road cuts of each pixel
+    CHANNEL *ChannelData  - Channel and road network
+    int NStats            - Number of met stations
+    METLOCATION *Stat     - Met stations
+    int y0                - First row of the cropped grid
+    int x0                - First column of the cropped grid
+    int NY                - Number of rows of the cropped grid
+    int NX                - Number of columns of the cropped grid
+
+  Returns      : void
+
+  Modifies     : Map, the maps, the channel maps, the locations of the
+                 stations, the map window
+
+  Comments     : The soil and network arrays of the pixels outside the
+                 basin are freed first, the maps are then copied to the new
+                 size.  Used by ClipToSubbasin() and by PartitionBasin() in
+                 Parallel.c.  A grid that is already a window of the map
+                 files stays a window of the same files.
+*****************************************************************************/
+void CropGrid(MAPSIZE *Map, LAYER *Soil, VEGTABLE *VType,
+	      TOPOPIX ***TopoMap, SOILPIX ***SoilMap, VEGPIX ***VegMap,
+	      ROADSTRUCT ***Network, CHANNEL *ChannelData, int NStats,
+	      METLOCATION *Stat, int y0, int x0, int NY, int NX)
+{
+  MAPWINDOW Window;		/* window of the grid in the map files */
+  SOILPIX *SoilPix;
+  ROADSTRUCT *Cut;
+  int NLayers;			/* number of soil layers of a pixel */
+  long i;			/* counter */
+  int x;			/* counter */
+  int y;			/* counter */
+
+  for (y = 0; y < Map->NY; y++) {
+    for (x = 0; x < Map->NX; x++) {
+      if (INBASIN((*TopoMap)[y][x].Mask))
+	continue;
+      SoilPix = &((*SoilMap)[y][x]);
+      if (SoilPix->Moist) {
+	NLayers = Soil->NLayers[SoilPix->Soil - 1];
+	TrackedFree(SoilPix->Moist, (NLayers + 1) * sizeof(float), MEM_SOIL,
+		    "SoilMap");
+	TrackedFree(SoilPix->Perc, NLayers * sizeof(float), MEM_SOIL,
+		    "SoilMap");
+	TrackedFree(SoilPix->Temp, NLayers * sizeof(float), MEM_SOIL,
+		    "SoilMap");
+	SoilPix->Moist = NULL;
+	SoilPix->Perc = NULL;
+	SoilPix->Temp = NULL;
+      }
+      Cut = &((*Network)[y][x]);
+      if (Cut->Adjust) {
+	NLayers = VType[(*VegMap)[y][x].Veg - 1].NSoilLayers;
+	TrackedFree(Cut->Adjust, (NLayers + 1) * sizeof(float), MEM_NETWORK,
+		    "Network");
+	TrackedFree(Cut->PercArea, (NLayers + 1) * sizeof(float),
+		    MEM_NETWORK, "Network");
+	Cut->Adjust = NULL;
+	Cut->PercArea = NULL;
+      }
+    }
+  }
+
+  *TopoMap = (TOPOPIX **) CropRows((void **) *TopoMap, Map->NY, Map->NX,
+				   sizeof(TOPOPIX), y0, x0, NY, NX,
+				   MEM_TERRAIN, "TopoMap");
+  *SoilMap = (SOILPIX **) CropRows((void **) *SoilMap, Map->NY, Map->NX,
+				   sizeof(SOILPIX), y0, x0, NY, NX,
+				   MEM_SOIL, "SoilMap");
+  *VegMap = (VEGPIX **) CropRows((void **) *VegMap, Map->NY, Map->NX,
+				 sizeof(VEGPIX), y0, x0, NY, NX,
+				 MEM_VEGETATION, "VegMap");
+  *Network = (ROADSTRUCT **) CropRows((void **) *Network, Map->NY, Map->NX,
+				      sizeof(ROADSTRUCT), y0, x0, NY, NX,
+				      MEM_NETWORK, "Network");
+  ChannelData->stream_map =
+    channel_grid_crop_map(ChannelData->stream_map, x0, y0, NX, NY);
+  ChannelData->road_map =
+    channel_grid_crop_map(ChannelData->road_map, x0, y0, NX, NY);
+  channel_grid_init(NX, NY);
+
+  /* the locations on the grid move with the origin */
+  for (y = 0; y < NY; y++) {
+    for (x = 0; x < NX; x++) {
+      (*TopoMap)[y][x].drains_y -= y0;
+      (*TopoMap)[y][x].drains_x -= x0;
+    }
+  }
+  for (i = 0; i < Map->NumCells; i++) {
+    Map->OrderedCells[i].y -= y0;
+    Map->OrderedCells[i].x -= x0;
+  }
+  for (i = 0; i < NStats; i++) {
+    Stat[i].Loc.N -= y0;
+    Stat[i].Loc.E -= x0;
+  }
+
+  /* the map files keep the original grid */
+  GetMapWindow(&Window);
+  if (!Window.Active) {
+    Window.Active = TRUE;
+    Window.NY = Map->NY;
+    Window.NX = Map->NX;
+    Window.OffsetY = 0;
+    Window.OffsetX = 0;
+    Window.Gather = NULL;
+  }
+  Window.OffsetY += y0;
+  Window.OffsetX += x0;
+  Window.ModelNY = NY;
+  Window.ModelNX = NX;
+  SetMapWindow(&Window);
+
+  Map->Yorig -= y0 * Map->DY;
+  Map->Xorig += x0 * Map->DX;
+  Map->OffsetY += y0;
+  Map->OffsetX += x0;
+  Map->NY = NY;
+  Map->NX = NX;
+}
+
+/*****************************************************************************
+  CropRows()
+
+  Returns a copy of the NYCrop by NXCrop elements from row y0 and column x0
+  of a map with NY rows of NX elements, and frees the map.
+*****************************************************************************/
+static void **CropRows(void **Rows, int NY, int NX, size_t Size,
+		       int y0, int x0, int NYCrop, int NXCrop, int Subsystem,
+		       const char *Structure)
+{
+  const char *Routine = "ClipToSubbasin";
+  void **Cropped;
+  int y;
+
+  if (!(Cropped = (void **) TrackedCalloc(NYCrop, sizeof(void *), Subsystem,
+					  Structure)))
+    ReportError((char *) Routine, 1);
+  for (y = 0; y < NYCrop; y++) {
+    if (!(Cropped[y] = TrackedCalloc(NXCrop, Size, Subsystem, Structure)))
+      ReportError((char *) Routine, 1);
+    memcpy(Cropped[y], (char *) Rows[y0 + y] + x0 * Size, NXCrop * Size);
+  }
+
+  for (y = 0; y < NY; y++)
+    TrackedFree(Rows[y], NX * Size, Subsystem, Structure);
+  TrackedFree(Rows, NY * sizeof(void *), Subsystem, Structure);
+
+  return Cropped;
+}
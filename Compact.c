@@ -0,0 +1,387 @@
+/*
+ * SUMMARY:      Compact.c - Compact storage of the static maps and fields
+ * USAGE:        Part of DHSVM
+ *
+ * AUTHOR:       DHSVM development team
+ * ORG:          University of Washington, Department of Civil Engineering
+ * E-MAIL:
+ * ORIG-DATE:    Oct-2026
+ * DESCRIPTION:  Encode static float maps and fields as 16-bit fixed point
+ *               codes with a per-map or per-field offset and scale, or as
+ *               half precision floats, see compact.h
+ * DESCRIP-END.
+ * FUNCTIONS:    CompactMap()
+ *               CompactMaps()
+ *               EncodeMap()
+ *               FixedCode()
+ *               FloatToHalf()
+ *               FreeCompactMaps()
+ *               HalfToFloat()
+ *               SetFixedScale()
+ * COMMENTS:
+ * $Id: Compact.c,v 1.0 2026/10/17 Exp $
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "settings.h"
+#include "data.h"
+#include "DHSVMerror.h"
+#include "memtrack.h"
+#include "compact.h"
+
+#define MB (1024. * 1024.)
+
+/* scales of the fixed point fields of the pixels, see compact.h */
+__thread FIXEDSCALE FixedScale[NFIXEDCODES];
+
+/*****************************************************************************
+  Function name: CompactMap()
+
+  Purpose      : Encode a float map and free it
+
+  Required     :
+    COMPACTMAP *Compact - Compact map
+    float ***Map        - Float map, row by row
+    int NY              - Rows of the map
+    int NX              - Columns of the map
+    const char *Name    - Name of the map in the message
+
+  Returns      : void
+
+  Modifies     : Compact, *Map is freed and set to NULL
+
+  Comments     : The largest difference between the decoded and the float
+                 values is printed, see EncodeMap()
+*****************************************************************************/
+void CompactMap(COMPACTMAP *Compact, float ***Map, int NY, int NX,
+		const char *Name)
+{
+  const char *Routine = "CompactMap";
+  double MaxError;		/* Largest error of the codes */
+  int y;			/* counter */
+
+  Compact->NX = NX;
+  if (!(Compact->Code =
+	(unsigned short *) TrackedCalloc((size_t) NY * NX,
+					 sizeof(unsigned short),
+					 MEM_METEOROLOGY, "CompactMap")))
+    ReportError((char *) Routine, 1);
+
+  MaxError = EncodeMap(Compact, *Map, NY, NX);
+
+  printf("Compact %s: offset %g, scale %g, largest error %g (%.2g%% of "
+	 "the range)\n", Name, Compact->Offset, Compact->Scale, MaxError,
+	 Compact->Scale > 0. ? 100. * MaxError / (MAXCODE * Compact->Scale) :
+	 0.);
+
+  for (y = 0; y < NY; y++)
+    free((*Map)[y]);
+  free(*Map);
+  *Map = NULL;
+}
+
+/*****************************************************************************
+  Function name: CompactMaps()
+
+  Purpose      : Encode the static float maps of the meteorology
+
+  Required     :
+    COMPACTMAPS *Compact    - Compact maps
+    MAPSIZE *Map            - Size of the model area
+    float ***SkyViewMap     - Sky view factor, NULL if not used
+    float ***PrecipLapseMap - Precipitation lapse rate map, NULL if not used
+    float ****WindModel     - Wind model maps, NULL if not used
+    int NWindMaps           - Number of wind model maps
+
+  Returns      : void
+
+  Modifies     : Compact, the float maps are freed and set to NULL
+
+  Comments     : Called at the end of the initialization, after the maps
+                 have been read.  Prints the memory of the float maps and
+                 of the codes
+*****************************************************************************/
+void CompactMaps(COMPACTMAPS *Compact, MAPSIZE *Map, float ***SkyViewMap,
+		 float ***PrecipLapseMap, float ****WindModel, int NWindMaps)
+{
+  const char *Routine = "CompactMaps";
+  char Name[BUFSIZE + 1];	/* Name of a wind model map */
+  int NMaps = 0;		/* Number of maps compacted */
+  int n;			/* counter */
+
+  if (*SkyViewMap) {
+    CompactMap(&(Compact->SkyView), SkyViewMap, Map->NY, Map->NX,
+	       "SkyViewMap");
+    NMaps++;
+  }
+  if (*PrecipLapseMap) {
+    CompactMap(&(Compact->PrecipLapse), PrecipLapseMap, Map->NY, Map->NX,
+	       "PrecipLapseMap");
+    NMaps++;
+  }
+  if (*WindModel) {
+    if (!(Compact->Wind = (COMPACTMAP *) calloc(NWindMaps,
+						sizeof(COMPACTMAP))))
+      ReportError((char *) Routine, 1);
+    for (n = 0; n < NWindMaps; n++) {
+      sprintf(Name, "WindModel %d", n + 1);
+      CompactMap(&(Compact->Wind[n]), &((*WindModel)[n]), Map->NY, Map->NX,
+		 Name);
+    }
+    Compact->NWind = NWindMaps;
+    NMaps += NWindMaps;
+    free(*WindModel);
+    *WindModel = NULL;
+  }
+
+  if (NMaps > 0)
+    printf("Compact maps: %.3g MB of float maps stored in %.3g MB (%d "
+	   "maps)\n", NMaps * (double) Map->NY * Map->NX * sizeof(float) / MB,
+	   NMaps * (double) Map->NY * Map->NX * sizeof(unsigned short) / MB,
+	   NMaps);
+
+  Compact->Active = TRUE;
+}
+
+/*****************************************************************************
+  Function name: EncodeMap()
+
+  Purpose      : Encode a float map into the codes of a compact map
+
+  Required     :
+    COMPACTMAP *Compact - Compact map, with the codes allocated
+    float **Map         - Float map
+    int NY              - Rows of the map
+    int NX              - Columns of the map
+
+  Returns      : double - Largest difference between the decoded and the
+                          float values
+
+  Modifies     : Compact
+
+  Comments     : Sets the offset and the scale from the smallest and the
+                 largest value of the map, a map with a single value gets a
+                 scale of 0.  The codes are rounded to the nearest code.
+                 Used for the MM5 input maps every time they are read
+*****************************************************************************/
+double EncodeMap(COMPACTMAP *Compact, float **Map, int NY, int NX)
+{
+  float Min;			/* Smallest value of the map */
+  float Max;			/* Largest value of the map */
+  double Code;			/* Unrounded code of a pixel */
+  double MaxError = 0.;		/* Largest error of the codes */
+  long i;			/* index of the pixel */
+  int x;			/* counter */
+  int y;			/* counter */
+
+  Min = Max = Map[0][0];
+  for (y = 0; y < NY; y++) {
+    for (x = 0; x < NX; x++) {
+      if (Map[y][x] < Min)
+	Min = Map[y][x];
+      if (Map[y][x] > Max)
+	Max = Map[y][x];
+    }
+  }
+
+  Compact->Offset = Min;
+  Compact->Scale = (Max - Min) / MAXCODE;
+  for (y = 0; y < NY; y++) {
+    for (x = 0; x < NX; x++) {
+      i = (long) y * NX + x;
+      Compact->Code[i] = 0;
+      if (Compact->Scale > 0.) {
+	Code = floor((Map[y][x] - Min) / Compact->Scale + 0.5);
+	Compact->Code[i] = (unsigned short) MIN(MAX(Code, 0.), MAXCODE);
+      }
+      if (fabs(COMPACTVALUE(Compact, y, x) - Map[y][x]) > MaxError)
+	MaxError = fabs(COMPACTVALUE(Compact, y, x) - Map[y][x]);
+    }
+  }
+
+  return MaxError;
+}
+
+/*****************************************************************************
+  Function name: SetFixedScale()
+
+  Purpose      : Set the offset and the scale of a fixed point field of the
+                 pixels
+
+  Required     :
+    int Field        - Field, ELEVATION_CODE, ... (compact.h)
+    const char *Name - Name of the field in the message
+    float Min        - Smallest value to encode
+    float Max        - Largest value to encode
+
+  Returns      : void
+
+  Modifies     : FixedScale[Field]
+
+  Comments     : Only prints the scale and the error in a COMPACT_MAPS
+                 build, where the field is encoded.  Values outside
+                 Min - Max get the nearest code
+*****************************************************************************/
+void SetFixedScale(int Field, const char *Name, float Min, float Max)
+{
+  FixedScale[Field].Offset = Min;
+  FixedScale[Field].Scale = (Max - Min) / MAXCODE;
+
+#ifdef COMPACT_MAPS
+  printf("Compact %s: offset %g, scale %g, largest error %g\n", Name,
+	 FixedScale[Field].Offset, FixedScale[Field].Scale,
+	 FixedScale[Field].Scale / 2.);
+#endif
+}
+
+/*****************************************************************************
+  Function name: FixedCode()
+
+  Purpose      : Encode a value of a fixed point field of the pixels
+
+  Required     :
+    int Field   - Field, ELEVATION_CODE, ... (compact.h)
+    float Value - Value
+
+  Returns      : unsigned short - Nearest code
+
+  Modifies     :
+
+  Comments     : See SetFixedScale()
+*****************************************************************************/
+unsigned short FixedCode(int Field, float Value)
+{
+  double Code;			/* Unrounded code */
+
+  if (FixedScale[Field].Scale <= 0.)
+    return 0;
+  Code = floor((Value - FixedScale[Field].Offset) / FixedScale[Field].Scale +
+	       0.5);
+  return (unsigned short) MIN(MAX(Code, 0.), MAXCODE);
+}
+
+/*****************************************************************************
+  Function name: FloatToHalf()
+
+  Purpose      : Round a float to a half precision float
+
+  Required     :
+    float Value - Value
+
+  Returns      : unsigned short - IEEE 754 half precision bits of Value
+
+  Modifies     :
+
+  Comments     : Rounds to the nearest half, ties to even.  Values beyond
+                 65504 become infinite, values below 2^-24 become subnormal
+                 or zero
+*****************************************************************************/
+unsigned short FloatToHalf(float Value)
+{
+  union {
+    float f;
+    unsigned int u;
+  } Bits;			/* bits of Value */
+  unsigned int Sign;		/* sign bit of the half */
+  unsigned int Mantissa;	/* mantissa of Value */
+  unsigned int Half;		/* bits of the half without the sign */
+  unsigned int Rest;		/* bits that are rounded off */
+  unsigned int Tie;		/* Rest of a tie */
+  int Exponent;			/* exponent of the half */
+  int Shift;			/* bits that are rounded off */
+
+  Bits.f = Value;
+  Sign = (Bits.u >> 16) & 0x8000;
+  Mantissa = Bits.u & 0x7fffff;
+  if (((Bits.u >> 23) & 0xff) == 0xff)
+    return Sign | 0x7c00 | (Mantissa ? 0x200 : 0);
+
+  Exponent = (int) ((Bits.u >> 23) & 0xff) - 127 + 15;
+  if (Exponent >= 0x1f)
+    return Sign | 0x7c00;
+  if (Exponent <= 0) {
+    /* subnormal half */
+    if (Exponent < -10)
+      return Sign;
+    Mantissa |= 0x800000;
+    Shift = 14 - Exponent;
+  }
+  else {
+    Mantissa |= (unsigned int) Exponent << 23;
+    Shift = 13;
+  }
+
+  Half = Mantissa >> Shift;
+  Rest = Mantissa & ((1u << Shift) - 1);
+  Tie = 1u << (Shift - 1);
+  if (Rest > Tie || (Rest == Tie && (Half & 1)))
+    Half++;
+
+  return Sign | Half;
+}
+
+/*****************************************************************************
+  Function name: HalfToFloat()
+
+  Purpose      : Convert a half precision float to a float
+
+  Required     :
+    unsigned short Code - IEEE 754 half precision bits
+
+  Returns      : float - Value
+
+  Modifies     :
+*****************************************************************************/
+float HalfToFloat(unsigned short Code)
+{
+  union {
+    float f;
+    unsigned int u;
+  } Bits;			/* bits of the value */
+  unsigned int Exponent;	/* exponent of the half */
+  unsigned int Mantissa;	/* mantissa of the half */
+
+  Exponent = (Code >> 10) & 0x1f;
+  Mantissa = Code & 0x3ff;
+  if (Exponent == 0) {
+    /* zero or subnormal */
+    Bits.f = (float) Mantissa * 5.9604644775390625e-8f;
+    if (Code & 0x8000)
+      Bits.f = -Bits.f;
+    return Bits.f;
+  }
+  if (Exponent == 0x1f)
+    Bits.u = 0x7f800000 | (Mantissa << 13);
+  else
+    Bits.u = ((Exponent + 112) << 23) | (Mantissa << 13);
+  Bits.u |= (unsigned int) (Code & 0x8000) << 16;
+
+  return Bits.f;
+}
+
+/*****************************************************************************
+  Function name: FreeCompactMaps()
+
+  Purpose      : Free the compact maps
+
+  Required     :
+    COMPACTMAPS *Compact - Compact maps
+
+  Returns      : void
+
+  Modifies     : Compact
+*****************************************************************************/
+void FreeCompactMaps(COMPACTMAPS *Compact)
+{
+  int n;			/* counter */
+
+  free(Compact->SkyView.Code);
+  free(Compact->PrecipLapse.Code);
+  for (n = 0; n < Compact->NWind; n++)
+    free(Compact->Wind[n].Code);
+  free(Compact->Wind);
+  memset(Compact, 0, sizeof(COMPACTMAPS));
+}
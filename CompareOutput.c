@@ -0,0 +1,762 @@
+/*
+ * SUMMARY:      CompareOutput.c - Compare model output with golden results
+ * USAGE:        CompareOutput [-tolerance file] [-abs a] [-rel r]
+ *                             configfile goldendir outputdir
+ *
+ * AUTHOR:       DHSVM development team
+ * ORG:          University of Washington, Department of Civil Engineering
+ * E-MAIL:
+ * ORIG-DATE:    Oct-2026
+ * DESCRIPTION:  Compares every file in a directory with golden (reference)
+ *               results against the file with the same name in an output
+ *               directory, and reports for each file the first value that
+ *               differs by more than the tolerance, with its time step and
+ *               location, the number of values that differ and the largest
+ *               difference.
+ *               Text output (aggregated values, mass balance, stream flow,
+ *               pixel dumps, channel state) is compared token by token,
+ *               the step is the date at the start of the line and the
+ *               location the column.  Binary maps and model states are read
+ *               record by record with Read2DMatrix() in the format given in
+ *               the configuration file, the step is the map date or the
+ *               state date and the location the row and column.  NetCDF
+ *               files are compared variable by variable.
+ *               Two values a and b match when
+ *                 |a - b| <= absolute + relative * max(|a|, |b|)
+ *               The tolerances are looked up per file and per variable
+ *               (text column or map name) in the tolerance file, lines of
+ *                 filepattern  variablepattern  absolute  relative
+ *               with shell wildcards in the patterns.  The first matching
+ *               line is used, otherwise the -abs and -rel values (default
+ *               0, i.e. identical output).  "skip" instead of the
+ *               tolerances excludes the file from the comparison.
+ * DESCRIP-END.
+ * FUNCTIONS:    main()
+ * COMMENTS:     Returns 0 when all files match, 1 otherwise.
+ * $Id: CompareOutput.c,v 1.0 2026/10/17 Exp $
+ */
+
+#include <ctype.h>
+#include <dirent.h>
+#include <fnmatch.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include "settings.h"
+#include "data.h"
+#include "DHSVMerror.h"
+#include "fileio.h"
+#include "getinit.h"
+#include "sizeofnt.h"
+#include "varid.h"
+
+#define MAXFILES      1024	/* files in the golden directory */
+#define MAXTOLERANCES 256	/* lines in the tolerance file */
+#define MAXCOLUMNS    1024	/* values on a line of text output */
+#define MAXRECORDS    4096	/* maps or layers in a binary file */
+#define SKIP          -1.	/* absolute tolerance of skipped files */
+
+typedef struct {
+  char File[BUFSIZE + 1];	/* file name pattern */
+  char Var[BUFSIZE + 1];	/* column or map name pattern */
+  double Abs;			/* absolute tolerance, SKIP to skip the file */
+  double Rel;			/* relative tolerance */
+} TOLERANCE;
+
+typedef struct {
+  long NValues;			/* number of values compared */
+  long NDiff;			/* number of values outside the tolerance */
+  double MaxDiff;		/* largest absolute difference */
+  char First[2 * BUFSIZE + 1];	/* first divergence */
+} COMPARISON;
+
+typedef struct {
+  LISTPTR Input;		/* configuration file */
+  int NY;			/* rows */
+  int NX;			/* columns */
+  char *Golden;			/* directory with golden results */
+  char *Output;			/* directory with the output to check */
+  TOLERANCE Default;		/* tolerance when no line matches */
+  int NTol;			/* number of lines in the tolerance file */
+  TOLERANCE Tol[MAXTOLERANCES];	/* tolerance file */
+} COMPAREOPTIONS;
+
+static void ReadTolerances(char *FileName, COMPAREOPTIONS *Opt);
+static int IsSkipped(COMPAREOPTIONS *Opt, const char *File);
+static TOLERANCE *FindTolerance(COMPAREOPTIONS *Opt, const char *File,
+				const char *Var);
+static int Compare(double Golden, double Output, TOLERANCE *Tol,
+		   COMPARISON *Result);
+static void CompareText(COMPAREOPTIONS *Opt, const char *Name,
+			COMPARISON *Result);
+static void CompareBinary(COMPAREOPTIONS *Opt, const char *Name,
+			  COMPARISON *Result);
+#ifdef HAVE_NETCDF
+static void CompareNetCDF(COMPAREOPTIONS *Opt, const char *Name,
+			  COMPARISON *Result);
+#endif
+static int BinaryLayout(COMPAREOPTIONS *Opt, const char *Name, long Size,
+			int *Type, char Label[][BUFSIZE + 1]);
+static int SplitLine(char *Line, char **Token);
+static int IsNumber(const char *Str, double *Value);
+static double GetValue(void *Array, int NumberType, long i);
+static int CompareName(const void *A, const void *B);
+static int ListFiles(const char *Path, char Name[][BUFSIZE + 1]);
+static void Usage(char *Program);
+
+/*****************************************************************************
+  main()
+*****************************************************************************/
+int main(int argc, char **argv)
+{
+  static char Golden[MAXFILES][BUFSIZE + 1];
+  static char Output[MAXFILES][BUFSIZE + 1];
+  COMPAREOPTIONS Opt;
+  COMPARISON Result;
+  char Format[BUFSIZE + 1];
+  char *TolFile = NULL;
+  int NGolden;
+  int NOutput;
+  int NFailed = 0;
+  int NCompared = 0;
+  int i;
+  int j;
+
+  memset(&Opt, 0, sizeof(COMPAREOPTIONS));
+  strcpy(Opt.Default.File, "*");
+  strcpy(Opt.Default.Var, "*");
+
+  for (i = 1; i < argc && argv[i][0] == '-'; i++) {
+    if (i + 1 >= argc)
+      Usage(argv[0]);
+    if (strcmp(argv[i], "-tolerance") == 0)
+      TolFile = argv[++i];
+    else if (strcmp(argv[i], "-abs") == 0)
+      Opt.Default.Abs = atof(argv[++i]);
+    else if (strcmp(argv[i], "-rel") == 0)
+      Opt.Default.Rel = atof(argv[++i]);
+    else
+      Usage(argv[0]);
+  }
+  if (argc - i != 3)
+    Usage(argv[0]);
+  Opt.Golden = argv[i + 1];
+  Opt.Output = argv[i + 2];
+  if (TolFile)
+    ReadTolerances(TolFile, &Opt);
+
+  ReadInitFile(argv[i], &(Opt.Input));
+  Opt.NY = GetInitLong("AREA", "NUMBER OF ROWS", 0, Opt.Input);
+  Opt.NX = GetInitLong("AREA", "NUMBER OF COLUMNS", 0, Opt.Input);
+  if (Opt.NY < 1 || Opt.NX < 1)
+    ReportError("NUMBER OF ROWS", 51);
+  GetInitString("OPTIONS", "FORMAT", "BIN", Format, BUFSIZE, Opt.Input);
+  if (strncmp(Format, "NETCDF", 3) == 0)
+    InitFileIO(NETCDF);
+  else if (strncmp(Format, "BYTESWAP", 3) == 0)
+    InitFileIO(BYTESWAP);
+  else
+    InitFileIO(BIN);
+
+  NGolden = ListFiles(Opt.Golden, Golden);
+  NOutput = ListFiles(Opt.Output, Output);
+
+  printf("\nComparing %s with golden results in %s\n", Opt.Output,
+	 Opt.Golden);
+  for (i = 0; i < NGolden; i++) {
+    if (IsSkipped(&Opt, Golden[i]))
+      continue;
+    NCompared++;
+    if (!bsearch(Golden[i], Output, NOutput, BUFSIZE + 1, CompareName)) {
+      printf("  MISSING  %s\n", Golden[i]);
+      NFailed++;
+      continue;
+    }
+    memset(&Result, 0, sizeof(COMPARISON));
+    j = strlen(Golden[i]);
+    if (j > 4 && strcmp(&(Golden[i][j - 4]), ".bin") == 0)
+      CompareBinary(&Opt, Golden[i], &Result);
+#ifdef HAVE_NETCDF
+    else if (j > 3 && strcmp(&(Golden[i][j - 3]), ".nc") == 0)
+      CompareNetCDF(&Opt, Golden[i], &Result);
+#endif
+    else
+      CompareText(&Opt, Golden[i], &Result);
+    if (Result.NDiff == 0)
+      printf("  OK       %s (%ld values)\n", Golden[i], Result.NValues);
+    else {
+      printf("  DIFF     %s: %ld of %ld values differ, largest difference "
+	     "%g\n           first at %s\n", Golden[i], Result.NDiff,
+	     Result.NValues, Result.MaxDiff, Result.First);
+      NFailed++;
+    }
+  }
+  for (i = 0; i < NOutput; i++) {
+    if (!IsSkipped(&Opt, Output[i]) &&
+	!bsearch(Output[i], Golden, NGolden, BUFSIZE + 1, CompareName)) {
+      printf("  EXTRA    %s\n", Output[i]);
+      NCompared++;
+      NFailed++;
+    }
+  }
+
+  printf("%d files compared, %d differ\n", NCompared, NFailed);
+  DeleteList(Opt.Input);
+  return NFailed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/*****************************************************************************
+  ReadTolerances() - read the tolerance file, # starts a comment
+*****************************************************************************/
+static void ReadTolerances(char *FileName, COMPAREOPTIONS *Opt)
+{
+  FILE *InFile;
+  char Line[BUFSIZE + 1];
+  char Abs[BUFSIZE + 1];
+  TOLERANCE *Tol;
+  int N;
+
+  OpenFile(&InFile, FileName, "r", FALSE);
+  while (fgets(Line, BUFSIZE, InFile)) {
+    if (strchr(Line, '#'))
+      *strchr(Line, '#') = '\0';
+    if (Opt->NTol >= MAXTOLERANCES)
+      ReportError(FileName, 65);
+    Tol = &(Opt->Tol[Opt->NTol]);
+    N = sscanf(Line, "%255s %255s %255s %lf", Tol->File, Tol->Var, Abs,
+	       &(Tol->Rel));
+    if (N <= 0)
+      continue;
+    if (N == 3 && strcmp(Abs, "skip") == 0)
+      Tol->Abs = SKIP;
+    else if (N == 4 && IsNumber(Abs, &(Tol->Abs)) && Tol->Abs >= 0. &&
+	     Tol->Rel >= 0.)
+      ;
+    else
+      ReportError(Line, 51);
+    Opt->NTol++;
+  }
+  fclose(InFile);
+}
+
+/*****************************************************************************
+  IsSkipped() - TRUE if the file matches a "skip" line
+*****************************************************************************/
+static int IsSkipped(COMPAREOPTIONS *Opt, const char *File)
+{
+  int i;
+
+  for (i = 0; i < Opt->NTol; i++)
+    if (Opt->Tol[i].Abs == SKIP && fnmatch(Opt->Tol[i].File, File, 0) == 0)
+      return TRUE;
+  return FALSE;
+}
+
+/*****************************************************************************
+  FindTolerance() - first line of the tolerance file that matches the file
+  and the variable
+*****************************************************************************/
+static TOLERANCE *FindTolerance(COMPAREOPTIONS *Opt, const char *File,
+				const char *Var)
+{
+  int i;
+
+  for (i = 0; i < Opt->NTol; i++)
+    if (Opt->Tol[i].Abs != SKIP && fnmatch(Opt->Tol[i].File, File, 0) == 0
+	&& fnmatch(Opt->Tol[i].Var, Var, 0) == 0)
+      return &(Opt->Tol[i]);
+  return &(Opt->Default);
+}
+
+/*****************************************************************************
+  Compare() - compare one value and keep track of the differences, returns
+  TRUE for the first value outside the tolerance, so that the caller can
+  describe where it is
+*****************************************************************************/
+static int Compare(double Golden, double Output, TOLERANCE *Tol,
+		   COMPARISON *Result)
+{
+  double Diff = fabs(Golden - Output);
+
+  Result->NValues++;
+  if (isnan(Golden) || isnan(Output)) {
+    if (isnan(Golden) && isnan(Output))
+      return FALSE;
+    Diff = HUGE_VAL;
+  }
+  else if (Diff <= Tol->Abs + Tol->Rel * fmax(fabs(Golden), fabs(Output)))
+    return FALSE;
+
+  if (Diff > Result->MaxDiff)
+    Result->MaxDiff = Diff;
+  return Result->NDiff++ == 0;
+}
+
+/*****************************************************************************
+  CompareText()
+
+  Text output is compared line by line.  A first line that does not start
+  with a number is a header with the column names.  Numbers are compared
+  with the tolerance of their column, other tokens have to be identical.
+*****************************************************************************/
+static void CompareText(COMPAREOPTIONS *Opt, const char *Name,
+			COMPARISON *Result)
+{
+  static char *GoldenToken[MAXCOLUMNS];
+  static char *OutputToken[MAXCOLUMNS];
+  static char *Header[MAXCOLUMNS];
+  char FileName[2 * BUFSIZE + 2];
+  char Column[BUFSIZE + 1];
+  char Where[2 * 40 + 2];
+  char *HeaderLine = NULL;
+  char *GoldenLine = NULL;
+  char *OutputLine = NULL;
+  size_t GoldenSize = 0;
+  size_t OutputSize = 0;
+  FILE *GoldenFile;
+  FILE *OutputFile;
+  TOLERANCE *Tol;
+  double GoldenValue;
+  double OutputValue;
+  char *Step;
+  char *Label;
+  int NHeader = 0;
+  int NGolden;
+  int NOutput;
+  int Line;
+  int i;
+
+  sprintf(FileName, "%s/%s", Opt->Golden, Name);
+  OpenFile(&GoldenFile, FileName, "r", FALSE);
+  sprintf(FileName, "%s/%s", Opt->Output, Name);
+  OpenFile(&OutputFile, FileName, "r", FALSE);
+
+  for (Line = 1;; Line++) {
+    NGolden = getline(&GoldenLine, &GoldenSize, GoldenFile) < 0 ? -1 :
+      SplitLine(GoldenLine, GoldenToken);
+    NOutput = getline(&OutputLine, &OutputSize, OutputFile) < 0 ? -1 :
+      SplitLine(OutputLine, OutputToken);
+    if (NGolden < 0 && NOutput < 0)
+      break;
+    if (NGolden < 0 || NOutput < 0) {
+      Result->NValues++;
+      if (Result->NDiff++ == 0)
+	sprintf(Result->First, "line %d: %s has more lines", Line,
+		NGolden < 0 ? "output" : "golden");
+      break;
+    }
+
+    /* header */
+    if (Line == 1 && NGolden > 0 && !IsNumber(GoldenToken[0], &GoldenValue)
+	&& !isdigit((unsigned char) GoldenToken[0][0])) {
+      /* the line has been split in place, keep a copy of the tokens */
+      if ((HeaderLine = malloc(GoldenSize)) == NULL)
+	ReportError("CompareText()", 1);
+      memcpy(HeaderLine, GoldenLine, GoldenSize);
+      for (NHeader = 0; NHeader < NGolden; NHeader++)
+	Header[NHeader] = HeaderLine + (GoldenToken[NHeader] - GoldenLine);
+    }
+
+    /* the date (or segment) at the start of the line, and a quoted name
+       (stream flow) if there is one */
+    Step = NGolden > 0 ? GoldenToken[0] : "";
+    for (i = 0, Label = NULL; i < NGolden; i++)
+      if (GoldenToken[i][0] == '"')
+	Label = GoldenToken[i];
+    if (Label)
+      sprintf(Where, "%.40s %.40s", Step, Label);
+    else
+      sprintf(Where, "%.40s", Step);
+
+    if (NGolden != NOutput) {
+      Result->NValues++;
+      if (Result->NDiff++ == 0)
+	sprintf(Result->First, "line %d (%s): %d values in golden, "
+		"%d in output", Line, Where, NGolden, NOutput);
+      continue;
+    }
+
+    for (i = 0; i < NGolden; i++) {
+      if (i < NHeader)
+	strcpy(Column, Header[i]);
+      else
+	sprintf(Column, "%d", i + 1);
+      if (IsNumber(GoldenToken[i], &GoldenValue) &&
+	  IsNumber(OutputToken[i], &OutputValue)) {
+	Tol = FindTolerance(Opt, Name, Column);
+	if (Compare(GoldenValue, OutputValue, Tol, Result))
+	  snprintf(Result->First, 2 * BUFSIZE, "line %d (%s), "
+		   "column %.40s: golden %.9g, output %.9g", Line, Where,
+		   Column, GoldenValue, OutputValue);
+      }
+      else {
+	Result->NValues++;
+	if (strcmp(GoldenToken[i], OutputToken[i]) != 0 &&
+	    Result->NDiff++ == 0)
+	  snprintf(Result->First, 2 * BUFSIZE, "line %d (%s), "
+		   "column %.40s: golden %.40s, output %.40s", Line, Where,
+		   Column, GoldenToken[i], OutputToken[i]);
+      }
+    }
+  }
+
+  free(HeaderLine);
+  free(GoldenLine);
+  free(OutputLine);
+  fclose(GoldenFile);
+  fclose(OutputFile);
+}
+
+/*****************************************************************************
+  CompareBinary()
+
+  Binary maps and model states are compared record by record (a map date
+  or a state layer), the records are read with Read2DMatrix() so that the
+  byte order of the configuration is used.
+*****************************************************************************/
+static void CompareBinary(COMPAREOPTIONS *Opt, const char *Name,
+			  COMPARISON *Result)
+{
+  static int Type[MAXRECORDS];
+  static char Label[MAXRECORDS][BUFSIZE + 1];
+  char GoldenName[2 * BUFSIZE + 2];
+  char OutputName[2 * BUFSIZE + 2];
+  struct stat GoldenStat;
+  struct stat OutputStat;
+  TOLERANCE *Tol;
+  void *Golden;
+  void *Output;
+  double GoldenValue;
+  double OutputValue;
+  long i;
+  int NRecords;
+  int r;
+
+  sprintf(GoldenName, "%s/%s", Opt->Golden, Name);
+  sprintf(OutputName, "%s/%s", Opt->Output, Name);
+  if (stat(GoldenName, &GoldenStat) || stat(OutputName, &OutputStat))
+    ReportError((char *) Name, 3);
+  if (GoldenStat.st_size != OutputStat.st_size) {
+    Result->NValues++;
+    Result->NDiff++;
+    sprintf(Result->First, "file size: golden %ld bytes, output %ld bytes",
+	    (long) GoldenStat.st_size, (long) OutputStat.st_size);
+    return;
+  }
+
+  NRecords = BinaryLayout(Opt, Name, (long) GoldenStat.st_size, Type, Label);
+  if (NRecords < 1) {
+    Result->NValues++;
+    Result->NDiff++;
+    sprintf(Result->First, "file size %ld bytes is not a number of "
+	    "%d x %d maps", (long) GoldenStat.st_size, Opt->NY, Opt->NX);
+    return;
+  }
+
+  if (!(Golden = malloc(Opt->NY * Opt->NX * sizeof(double))) ||
+      !(Output = malloc(Opt->NY * Opt->NX * sizeof(double))))
+    ReportError("CompareBinary()", 1);
+
+  for (r = 0; r < NRecords; r++) {
+    Read2DMatrix(GoldenName, Golden, Type[r], Opt->NY, Opt->NX, r, NULL, r);
+    Read2DMatrix(OutputName, Output, Type[r], Opt->NY, Opt->NX, r, NULL, r);
+    Tol = FindTolerance(Opt, Name, Label[r]);
+    for (i = 0; i < (long) Opt->NY * Opt->NX; i++) {
+      GoldenValue = GetValue(Golden, Type[r], i);
+      OutputValue = GetValue(Output, Type[r], i);
+      if (Compare(GoldenValue, OutputValue, Tol, Result))
+	snprintf(Result->First, 2 * BUFSIZE, "%s, row %ld, column %ld: "
+		 "golden %.9g, output %.9g", Label[r], i / Opt->NX,
+		 i % Opt->NX, GoldenValue, OutputValue);
+    }
+  }
+
+  free(Golden);
+  free(Output);
+}
+
+/*****************************************************************************
+  BinaryLayout() - number type and label of each record in a binary file,
+  returns the number of records (0 if the file size does not fit)
+
+  Map dumps are looked up in the [OUTPUT] section of the configuration
+  file, the label is the map date.  States are written as floats by
+  StoreModelState(), except for the met state.
+*****************************************************************************/
+static int BinaryLayout(COMPAREOPTIONS *Opt, const char *Name, long Size,
+			int *Type, char Label[][BUFSIZE + 1])
+{
+  int MetState[] = { 701, 702, 703, 704, 303 };
+  char KeyName[BUFSIZE + 1];
+  char Date[BUFSIZE + 1];
+  MAPDUMP DMap;
+  long MapSize = (long) Opt->NY * Opt->NX;
+  long Total;
+  int NMaps;
+  int N;
+  int i;
+  int j;
+
+  /* map dumps */
+  if (strncmp(Name, "Map.", 4) == 0) {
+    NMaps = GetInitLong("OUTPUT", "NUMBER OF MAP VARIABLES", 0, Opt->Input);
+    for (i = 1; i <= NMaps; i++) {
+      memset(&DMap, 0, sizeof(MAPDUMP));
+      sprintf(KeyName, "MAP VARIABLE %d", i);
+      DMap.ID = GetInitLong("OUTPUT", KeyName, 0, Opt->Input);
+      sprintf(KeyName, "MAP LAYER %d", i);
+      DMap.Layer = GetInitLong("OUTPUT", KeyName, 1, Opt->Input);
+      DMap.Resolution = MAP_OUTPUT;
+      if (!IsValidID(DMap.ID))
+	continue;
+      GetVarAttr(&DMap);
+      if (strcmp(DMap.FileName, Name) != 0)
+	continue;
+      sprintf(KeyName, "NUMBER OF MAPS %d", i);
+      N = GetInitLong("OUTPUT", KeyName, 0, Opt->Input);
+      if (N < 1 || N > MAXRECORDS ||
+	  Size != N * MapSize * SizeOfNumberType(DMap.NumberType))
+	return 0;
+      for (j = 0; j < N; j++) {
+	Type[j] = DMap.NumberType;
+	sprintf(KeyName, "MAP DATE %d %d", j + 1, i);
+	GetInitString("OUTPUT", KeyName, "", Date, BUFSIZE, Opt->Input);
+	sprintf(Label[j], "map %d, step %s", j + 1, Date);
+      }
+      return N;
+    }
+  }
+
+  /* images are stored as bytes */
+  if (strncmp(Name, "Image.", 6) == 0) {
+    if (Size % MapSize != 0 || Size / MapSize > MAXRECORDS)
+      return 0;
+    N = Size / MapSize;
+    for (j = 0; j < N; j++) {
+      Type[j] = NC_BYTE;
+      sprintf(Label[j], "image %d", j + 1);
+    }
+    return N;
+  }
+
+  /* the met state has integer layers */
+  if (strncmp(Name, "Met.State.", 10) == 0) {
+    N = sizeof(MetState) / sizeof(int);
+    for (j = 0, Total = 0; j < N; j++) {
+      GetVarNumberType(MetState[j], &(Type[j]));
+      Total += MapSize * SizeOfNumberType(Type[j]);
+      sprintf(Label[j], "layer %d", j + 1);
+    }
+    return Total == Size ? N : 0;
+  }
+
+  /* model states and anything else are float layers */
+  if (Size % (MapSize * sizeof(float)) != 0 ||
+      Size / (MapSize * sizeof(float)) > MAXRECORDS)
+    return 0;
+  N = Size / (MapSize * sizeof(float));
+  for (j = 0; j < N; j++) {
+    Type[j] = NC_FLOAT;
+    sprintf(Label[j], "layer %d", j + 1);
+  }
+  return N;
+}
+
+#ifdef HAVE_NETCDF
+/*****************************************************************************
+  CompareNetCDF() - compare all variables in a NetCDF file, the location is
+  given as the index along each dimension
+*****************************************************************************/
+static void CompareNetCDF(COMPAREOPTIONS *Opt, const char *Name,
+			  COMPARISON *Result)
+{
+  char FileName[2 * BUFSIZE + 2];
+  char VarName[NC_MAX_NAME + 1];
+  char Str[BUFSIZE + 1];
+  int DimId[NC_MAX_VAR_DIMS];
+  size_t DimLen[NC_MAX_VAR_DIMS];
+  size_t Position[NC_MAX_VAR_DIMS];
+  TOLERANCE *Tol;
+  double *Golden;
+  double *Output;
+  size_t N;
+  size_t Index;
+  size_t i;
+  int GoldenId;
+  int OutputId;
+  int GoldenVar;
+  int OutputVar;
+  int NVars;
+  int NDims;
+  int v;
+  int d;
+
+  sprintf(FileName, "%s/%s", Opt->Golden, Name);
+  if (nc_open(FileName, NC_NOWRITE, &GoldenId) != NC_NOERR)
+    ReportError(FileName, 3);
+  sprintf(FileName, "%s/%s", Opt->Output, Name);
+  if (nc_open(FileName, NC_NOWRITE, &OutputId) != NC_NOERR)
+    ReportError(FileName, 3);
+
+  nc_inq_nvars(GoldenId, &NVars);
+  for (GoldenVar = 0; GoldenVar < NVars; GoldenVar++) {
+    nc_inq_var(GoldenId, GoldenVar, VarName, NULL, &NDims, DimId, NULL);
+    for (d = 0, N = 1; d < NDims; d++) {
+      nc_inq_dimlen(GoldenId, DimId[d], &(DimLen[d]));
+      N *= DimLen[d];
+    }
+    if (nc_inq_varid(OutputId, VarName, &OutputVar) != NC_NOERR) {
+      Result->NValues++;
+      if (Result->NDiff++ == 0)
+	sprintf(Result->First, "variable %.40s missing in output", VarName);
+      continue;
+    }
+    if (N == 0)
+      continue;
+    if (!(Golden = (double *) malloc(N * sizeof(double))) ||
+	!(Output = (double *) malloc(N * sizeof(double))))
+      ReportError("CompareNetCDF()", 1);
+    if (nc_get_var_double(GoldenId, GoldenVar, Golden) != NC_NOERR ||
+	nc_get_var_double(OutputId, OutputVar, Output) != NC_NOERR) {
+      Result->NValues++;
+      if (Result->NDiff++ == 0)
+	sprintf(Result->First, "variable %.40s cannot be read", VarName);
+      free(Golden);
+      free(Output);
+      continue;
+    }
+    Tol = FindTolerance(Opt, Name, VarName);
+    for (i = 0; i < N; i++) {
+      if (!Compare(Golden[i], Output[i], Tol, Result))
+	continue;
+      /* index along each dimension, the first one is time for maps */
+      for (d = NDims - 1, Index = i; d >= 0; d--) {
+	Position[d] = Index % DimLen[d];
+	Index /= DimLen[d];
+      }
+      sprintf(Result->First, "%.40s", VarName);
+      for (d = 0; d < NDims && d < 8; d++) {
+	sprintf(Str, "[%lu]", (unsigned long) Position[d]);
+	strcat(Result->First, Str);
+      }
+      sprintf(Str, ": golden %.9g, output %.9g", Golden[i], Output[i]);
+      strcat(Result->First, Str);
+    }
+    free(Golden);
+    free(Output);
+  }
+
+  nc_close(GoldenId);
+  nc_close(OutputId);
+}
+#endif
+
+/*****************************************************************************
+  SplitLine() - split a line at white space, a quoted string with spaces
+  is one token, returns the number of tokens
+*****************************************************************************/
+static int SplitLine(char *Line, char **Token)
+{
+  int N = 0;
+
+  while (*Line && N < MAXCOLUMNS) {
+    while (*Line && isspace((unsigned char) *Line))
+      Line++;
+    if (!*Line)
+      break;
+    Token[N++] = Line;
+    if (*Line == '"') {
+      for (Line++; *Line && *Line != '"'; Line++) ;
+      if (*Line)
+	Line++;
+    }
+    else
+      while (*Line && !isspace((unsigned char) *Line))
+	Line++;
+    if (*Line)
+      *Line++ = '\0';
+  }
+  return N;
+}
+
+/*****************************************************************************
+  IsNumber() - TRUE if the whole string is a number
+*****************************************************************************/
+static int IsNumber(const char *Str, double *Value)
+{
+  char *End;
+
+  *Value = strtod(Str, &End);
+  return End != Str && *End == '\0';
+}
+
+/*****************************************************************************
+  GetValue() - element i of an array of the given number type
+*****************************************************************************/
+static double GetValue(void *Array, int NumberType, long i)
+{
+  switch (NumberType) {
+  case NC_BYTE:
+  case NC_CHAR:
+    return ((unsigned char *) Array)[i];
+  case NC_SHORT:
+    return ((short *) Array)[i];
+  case NC_INT:
+    return ((int *) Array)[i];
+  case NC_FLOAT:
+    return ((float *) Array)[i];
+  case NC_DOUBLE:
+    return ((double *) Array)[i];
+  default:
+    ReportError("GetValue()", 40);
+  }
+  return 0.;
+}
+
+/*****************************************************************************
+  ListFiles() - sorted list of the regular files in a directory
+*****************************************************************************/
+static int ListFiles(const char *Path, char Name[][BUFSIZE + 1])
+{
+  char FileName[2 * BUFSIZE + 2];
+  struct dirent *Entry;
+  struct stat Stat;
+  DIR *Dir;
+  int N = 0;
+
+  if (!(Dir = opendir(Path)))
+    ReportError((char *) Path, 3);
+  while ((Entry = readdir(Dir)) != NULL) {
+    snprintf(FileName, sizeof(FileName), "%s/%s", Path, Entry->d_name);
+    if (stat(FileName, &Stat) || !S_ISREG(Stat.st_mode))
+      continue;
+    if (N >= MAXFILES)
+      ReportError((char *) Path, 65);
+    strncpy(Name[N++], Entry->d_name, BUFSIZE);
+  }
+  closedir(Dir);
+
+  qsort(Name, N, BUFSIZE + 1, CompareName);
+  return N;
+}
+
+/*****************************************************************************
+  CompareName() - qsort() and bsearch() comparison of file names
+*****************************************************************************/
+static int CompareName(const void *A, const void *B)
+{
+  return strcmp((const char *) A, (const char *) B);
+}
+
+/*****************************************************************************
+  Usage()
+*****************************************************************************/
+static void Usage(char *Program)
+{
+  fprintf(stderr, "Usage: %s [-tolerance file] [-abs a] [-rel r] "
+	  "configfile goldendir outputdir\n", Program);
+  exit(EXIT_FAILURE);
+}
@@ -21,6 +21,7 @@
 #include "settings.h"
 #include "errorhandler.h"
 #include "fileio.h"
+#include "profile.h"
 
 /* -----------------------------------------------------------------------------
    InitChannel
@@ -191,11 +192,14 @@ RouteChannel(CHANNEL * ChannelData, TIMESTRUCT * Time, MAPSIZE * Map,
   int flag;
   char buffer[32];
   float CulvertFlow;
+  long Pos;			/* Position in the outflow file */
+  long Pos2;			/* Position in the flow only file */
 
-  /* give any surface water to roads w/o sinks */
+  /* give any surface water to roads w/o sinks.  In an MPI run each rank
+     handles its own pixels, and all ranks route the whole networks */
   for (y = 0; y < Map->NY; y++) {
     for (x = 0; x < Map->NX; x++) {
-      if (INBASIN(TopoMap[y][x].Mask)) {
+      if (INBASIN(TopoMap[y][x].Mask) && ISOWNED(Options->Parallel, y, x)) {
 	SoilMap[y][x].IExcessSed = SoilMap[y][x].IExcess;
 	if (channel_grid_has_channel(ChannelData->road_map, x, y) && !channel_grid_has_sink(ChannelData->road_map, x, y)) {	/* road w/o sink */
 
@@ -211,24 +215,31 @@ RouteChannel(CHANNEL * ChannelData, TIMESTRUCT * Time, MAPSIZE * Map,
   
   if(Options->RoadRouting){
     RouteRoad(Map, Time, TopoMap, SoilMap, Network, SType, ChannelData, 
-	      PrecipMap, SedMap, Tair, Rh, SedDiams);  
+	      PrecipMap, SedMap, &(Options->Adaptive), Tair, Rh, SedDiams);  
   }
 
   /* route the road network and save results */
   SPrintDate(&(Time->Current), buffer);
   flag = IsEqualTime(&(Time->Current), &(Time->Start));
+  ExchangeInflow(&(Options->Parallel));
   if (ChannelData->roads != NULL) {
     channel_route_network(ChannelData->roads, Time->Dt);
-    channel_save_outflow_text(buffer, ChannelData->roads,
-			      ChannelData->roadout, ChannelData->roadflowout,
-			      flag);
+    if (!Options->Spinup.Active && Options->Parallel.Rank == 0) {
+      Pos = PROFILE_TELL(ChannelData->roadout);
+      Pos2 = PROFILE_TELL(ChannelData->roadflowout);
+      channel_save_outflow_text(buffer, ChannelData->roads,
+				ChannelData->roadout, ChannelData->roadflowout,
+				flag);
+      PROFILE_COUNT_FILE(PROF_BYTESWRITTEN, ChannelData->roadout, Pos);
+      PROFILE_COUNT_FILE(PROF_BYTESWRITTEN, ChannelData->roadflowout, Pos2);
+    }
   }
   
   /* add culvert outflow to surface water */
   Total->CulvertReturnFlow = 0.0;
   for (y = 0; y < Map->NY; y++) {
     for (x = 0; x < Map->NX; x++) {
-      if (INBASIN(TopoMap[y][x].Mask)) {
+      if (INBASIN(TopoMap[y][x].Mask) && ISOWNED(Options->Parallel, y, x)) {
 
 	CulvertFlow = ChannelCulvertFlow(y, x, ChannelData);
 	CulvertFlow /= Map->DX * Map->DY;
@@ -255,11 +266,19 @@ RouteChannel(CHANNEL * ChannelData, TIMESTRUCT * Time, MAPSIZE * Map,
     }
   }
   /* route stream channels */
+  ExchangeInflow(&(Options->Parallel));
   if (ChannelData->streams != NULL) {
     channel_route_network(ChannelData->streams, Time->Dt);
-    channel_save_outflow_text(buffer, ChannelData->streams,
-			      ChannelData->streamout,
-			      ChannelData->streamflowout, flag);
+    if (!Options->Spinup.Active && Options->Parallel.Rank == 0) {
+      Pos = PROFILE_TELL(ChannelData->streamout);
+      Pos2 = PROFILE_TELL(ChannelData->streamflowout);
+      channel_save_outflow_text(buffer, ChannelData->streams,
+				ChannelData->streamout,
+				ChannelData->streamflowout, flag);
+      PROFILE_COUNT_FILE(PROF_BYTESWRITTEN, ChannelData->streamout, Pos);
+      PROFILE_COUNT_FILE(PROF_BYTESWRITTEN, ChannelData->streamflowout,
+			 Pos2);
+    }
   }
   
 }
@@ -303,13 +322,13 @@ uchar ChannelFraction(TOPOPIX * topo, ChannelMapRec * rds)
   if (rds == NULL) {
     return 0;
   }
-  cosine = cos(topo->Aspect);
-  sine = sin(topo->Aspect);
-  total_width = topo->FlowGrad / topo->Slope;
+  cosine = cos(TOPOASPECT(*topo));
+  sine = sin(TOPOASPECT(*topo));
+  total_width = topo->FlowGrad / TOPOSLOPE(*topo);
   effective_width = 0.0;
 
   for (r = rds; r != NULL; r = r->next) {
-    effective_width += r->length * sin(fabs(topo->Aspect - r->aspect));
+    effective_width += r->length * sin(fabs(TOPOASPECT(*topo) - r->aspect));
   }
   fract = effective_width / total_width * 255.0;
   fract = (fract > 255.0 ? 255.0 : floor(fract + 0.5));
@@ -16,8 +16,11 @@
 #ifndef DHSVM_ERROR_H
 #define DHSVM_ERROR_H
 
-extern char errorstr[];
+#include <setjmp.h>
+
+extern __thread char errorstr[];
 void ReportError(char *ErrorString, int ErrorCode);
 void ReportWarning(char *ErrorString, int ErrorCode);
+void SetErrorReturn(jmp_buf *Return);
 
 #endif
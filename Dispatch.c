@@ -0,0 +1,655 @@
+/*
+ * SUMMARY:      Dispatch.c - CPU dispatch of the vector kernels
+ * USAGE:        Part of DHSVM
+ *
+ * AUTHOR:       DHSVM development team
+ * ORG:          University of Washington, Department of Civil Engineering
+ * E-MAIL:
+ * ORIG-DATE:    Oct-2026
+ * DESCRIPTION:  Detect the instruction set of the processor and set the
+ *               kernel function pointers to the matching version, see
+ *               dispatch.h.  The vector versions are compiled for their
+ *               instruction set with the target attribute of gcc and clang
+ *               on x86 processors; elsewhere only the scalar versions are
+ *               built.
+ * DESCRIP-END.
+ * FUNCTIONS:    DetectCpu()
+ *               InitDispatch()
+ *               CpuName()
+ *               InterpolateStations()
+ *               PackStations()
+ *               FreeStations()
+ * COMMENTS:     Floating point contraction is switched off in this file, so
+ *               that the AVX2 and AVX-512 versions do not fuse multiplies
+ *               and adds that are rounded separately in the scalar version.
+ *               The kernels work element by element, and every version,
+ *               including the scalar one, does the same operations in the
+ *               same order, so that the results do not depend on the
+ *               instruction set.  This is also why the exponential of the
+ *               transmissivity kernel is computed here (Exp()) rather than
+ *               by the C library.  The AVX2 and AVX-512 versions clear the
+ *               upper halves of the vector registers before they return to
+ *               scalar code, which is otherwise slowed down by the
+ *               transition on many processors.
+ * $Id: Dispatch.c,v 1.0 2026/10/17 Exp $
+ */
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC optimize ("fp-contract=off")
+#endif
+#if defined(__clang__)
+#pragma clang fp contract(off)
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "settings.h"
+#include "data.h"
+#include "DHSVMerror.h"
+#include "dispatch.h"
+
+#if (defined(__GNUC__) || defined(__clang__)) && \
+    (defined(__x86_64__) || defined(__i386__))
+#define X86DISPATCH
+#include <immintrin.h>
+#endif
+
+/* exponential, see Exp() */
+#define EXPMAX 709.		/* Largest argument */
+#define EXPMIN -708.		/* Smallest argument */
+#define LOG2E 1.44269504088896338700e+00	/* 1 / ln(2) */
+#define LN2HI 6.93147180369123816490e-01	/* ln(2), leading bits */
+#define LN2LO 1.90821492927058770002e-10	/* ln(2) - LN2HI */
+#define ROUNDER 6755399441055744.	/* 1.5 * 2^52, rounds to an integer */
+#define EXPTERMS 14		/* Terms of the Taylor series */
+
+static const char *LevelName[NCPULEVELS] = {
+  "scalar", "SSE4.2", "AVX2", "AVX-512"
+};
+
+/* Taylor coefficients 1 / k! of exp(r) */
+static const double ExpCoef[EXPTERMS] = {
+  1., 1., 1. / 2., 1. / 6., 1. / 24., 1. / 120., 1. / 720., 1. / 5040.,
+  1. / 40320., 1. / 362880., 1. / 3628800., 1. / 39916800.,
+  1. / 479001600., 1. / 6227020800.
+};
+
+static double Exp(double x);
+static float Transmissivity(float SoilDepth, float WaterTable,
+			    float LateralKs, float KsExponent,
+			    float DepthThresh);
+static void CalcTransmissivitiesScalar(int N, float *SoilDepth,
+				       float *WaterTable, float *LateralKs,
+				       float *KsExponent, float *DepthThresh,
+				       float *Out);
+#ifdef X86DISPATCH
+static void CalcTransmissivitiesSSE42(int N, float *SoilDepth,
+				      float *WaterTable, float *LateralKs,
+				      float *KsExponent, float *DepthThresh,
+				      float *Out);
+static void CalcTransmissivitiesAVX2(int N, float *SoilDepth,
+				     float *WaterTable, float *LateralKs,
+				     float *KsExponent, float *DepthThresh,
+				     float *Out);
+static void CalcTransmissivitiesAVX512(int N, float *SoilDepth,
+				       float *WaterTable, float *LateralKs,
+				       float *KsExponent, float *DepthThresh,
+				       float *Out);
+#endif
+
+/* kernel function pointers of the calling thread, the scalar versions
+   until InitDispatch() */
+__thread void (*CalcTransmissivities) (int N, float *SoilDepth,
+				       float *WaterTable, float *LateralKs,
+				       float *KsExponent, float *DepthThresh,
+				       float *Out) =
+  CalcTransmissivitiesScalar;
+
+/*****************************************************************************
+  Function name: DetectCpu()
+
+  Purpose      : Detect the instruction set of the processor
+
+  Required     : void
+
+  Returns      : int - best instruction set supported by the processor and
+                       the operating system, see dispatch.h
+
+  Modifies     : void
+*****************************************************************************/
+int DetectCpu(void)
+{
+#ifdef X86DISPATCH
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f"))
+    return CPU_AVX512;
+  if (__builtin_cpu_supports("avx2"))
+    return CPU_AVX2;
+  if (__builtin_cpu_supports("sse4.2"))
+    return CPU_SSE42;
+#endif
+  return CPU_SCALAR;
+}
+
+/*****************************************************************************
+  Function name: InitDispatch()
+
+  Purpose      : Set the kernel function pointers
+
+  Required     :
+    int Requested - Highest instruction set to use, CPU_AUTO for the best
+                    one the processor supports
+
+  Returns      : int - instruction set used
+
+  Modifies     : The kernel function pointers
+
+  Comments     : An instruction set that the processor does not support is
+                 replaced by the best one it does support, with a warning
+*****************************************************************************/
+int InitDispatch(int Requested)
+{
+  int Detected;			/* Best instruction set of the processor */
+  int Level;			/* Instruction set used */
+
+  Detected = DetectCpu();
+  if (Requested == CPU_AUTO)
+    Level = Detected;
+  else if (Requested > Detected) {
+    fprintf(stderr, "WARNING: %s kernels are not supported by this "
+	    "processor, using %s\n", LevelName[Requested],
+	    LevelName[Detected]);
+    Level = Detected;
+  }
+  else
+    Level = Requested;
+
+  switch (Level) {
+#ifdef X86DISPATCH
+  case CPU_AVX512:
+    CalcTransmissivities = CalcTransmissivitiesAVX512;
+    break;
+  case CPU_AVX2:
+    CalcTransmissivities = CalcTransmissivitiesAVX2;
+    break;
+  case CPU_SSE42:
+    CalcTransmissivities = CalcTransmissivitiesSSE42;
+    break;
+#endif
+  default:
+    Level = CPU_SCALAR;
+    CalcTransmissivities = CalcTransmissivitiesScalar;
+    break;
+  }
+
+  return Level;
+}
+
+/*****************************************************************************
+  Function name: CpuName()
+
+  Purpose      : Name of an instruction set
+
+  Required     :
+    int Level - Instruction set, see dispatch.h
+
+  Returns      : const char * - name
+*****************************************************************************/
+const char *CpuName(int Level)
+{
+  if (Level < 0 || Level >= NCPULEVELS)
+    return "unknown";
+  return LevelName[Level];
+}
+
+/*****************************************************************************
+  Function name: InterpolateStations()
+
+  Purpose      : Weighted sums of the station variables for a pixel, the
+                 loop of InterpolateLocalMet()
+
+  Required     :
+    int NStats              - Number of stations
+    uchar *Weights          - Interpolation weights of the pixel
+    STATIONARRAYS *Stations - Station data of the time step
+    float LocalElev         - Elevation of the pixel (m)
+    float *Sums             - Sums, see enum STATIONSUMS
+    float *WeightSum        - Sum of the weights
+
+  Returns      : void
+
+  Modifies     : Sums, WeightSum
+
+  Comments     : The air temperature is lapsed to the pixel.  Not
+                 dispatched: there are only a few stations, and a vector
+                 version would add them up in an order that depends on the
+                 number of lanes
+*****************************************************************************/
+void InterpolateStations(int NStats, uchar *Weights, STATIONARRAYS *Stations,
+			 float LocalElev, float *Sums, float *WeightSum)
+{
+  float CurrentWeight;		/* weight for current station */
+  float Tair;			/* Air temperature lapsed to the pixel */
+  int i;			/* counter */
+
+  *WeightSum = 0.0;
+  for (i = 0; i < NStats; i++)
+    *WeightSum += (float) Weights[i];
+  for (i = 0; i < NSTATIONSUMS; i++)
+    Sums[i] = 0.0;
+
+  for (i = 0; i < NStats; i++) {
+    CurrentWeight = ((float) Weights[i]) / *WeightSum;
+    Tair = Stations->Tair[i] +
+      (LocalElev - Stations->Elev[i]) * Stations->TempLapse[i];
+    Sums[SUM_TAIR] += CurrentWeight * Tair;
+    Sums[SUM_RH] += CurrentWeight * Stations->Rh[i];
+    Sums[SUM_WIND] += CurrentWeight * Stations->Wind[i];
+    Sums[SUM_LIN] += CurrentWeight * Stations->Lin[i];
+    Sums[SUM_SIN] += CurrentWeight * Stations->Sin[i];
+    Sums[SUM_SINBEAM] += CurrentWeight * Stations->SinBeamObs[i];
+    Sums[SUM_SINDIFFUSE] += CurrentWeight * Stations->SinDiffuseObs[i];
+    Sums[SUM_TEMPLAPSE] += CurrentWeight * Stations->TempLapse[i];
+  }
+}
+
+/*****************************************************************************
+  Function name: PackStations()
+
+  Purpose      : Copy the station data of the current time step into one
+                 array per variable
+
+  Required     :
+    int NStats              - Number of stations
+    METLOCATION *Stat       - Stations
+    STATIONARRAYS *Stations - Arrays to fill
+
+  Returns      : void
+
+  Modifies     : Stations
+
+  Comments     : Called once per time step after the station data have been
+                 read and perturbed, before the pixels are interpolated.
+                 The arrays are allocated on the first call
+*****************************************************************************/
+void PackStations(int NStats, METLOCATION *Stat, STATIONARRAYS *Stations)
+{
+  float *Block;			/* Memory of all arrays */
+  int i;			/* counter */
+
+  if (NStats > Stations->NAlloc) {
+    FreeStations(Stations);
+    if (!(Block = (float *) calloc(9 * (size_t) NStats, sizeof(float))))
+      ReportError("PackStations()", 1);
+    Stations->Tair = Block;
+    Stations->Elev = Block + NStats;
+    Stations->TempLapse = Block + 2 * NStats;
+    Stations->Rh = Block + 3 * NStats;
+    Stations->Wind = Block + 4 * NStats;
+    Stations->Lin = Block + 5 * NStats;
+    Stations->Sin = Block + 6 * NStats;
+    Stations->SinBeamObs = Block + 7 * NStats;
+    Stations->SinDiffuseObs = Block + 8 * NStats;
+    Stations->NAlloc = NStats;
+  }
+
+  for (i = 0; i < NStats; i++) {
+    Stations->Tair[i] = Stat[i].Data.Tair;
+    Stations->Elev[i] = Stat[i].Elev;
+    Stations->TempLapse[i] = Stat[i].Data.TempLapse;
+    Stations->Rh[i] = Stat[i].Data.Rh;
+    Stations->Wind[i] = Stat[i].Data.Wind;
+    Stations->Lin[i] = Stat[i].Data.Lin;
+    Stations->Sin[i] = Stat[i].Data.Sin;
+    Stations->SinBeamObs[i] = Stat[i].Data.SinBeamObs;
+    Stations->SinDiffuseObs[i] = Stat[i].Data.SinDiffuseObs;
+  }
+  Stations->NStats = NStats;
+}
+
+/*****************************************************************************
+  Function name: FreeStations()
+
+  Purpose      : Release the station arrays
+
+  Required     :
+    STATIONARRAYS *Stations - Arrays to release
+
+  Returns      : void
+
+  Modifies     : Stations
+*****************************************************************************/
+void FreeStations(STATIONARRAYS *Stations)
+{
+  free(Stations->Tair);
+  memset(Stations, 0, sizeof(STATIONARRAYS));
+}
+
+
+/*****************************************************************************
+  Exp()
+
+  Exponential of x, the same to the last bit in all versions of the
+  kernels.  x is clamped to the range of normal results, then
+  exp(x) = 2^n exp(r) with n the integer nearest to x / ln(2) and
+  |r| <= ln(2) / 2, and exp(r) is summed with the Taylor series
+*****************************************************************************/
+static double Exp(double x)
+{
+  union {
+    double Real;
+    unsigned long long Bits;
+  } t, Scale;			/* 2^n, and the float holding n */
+  double n;			/* Power of two */
+  double r;			/* Reduced argument */
+  double p;			/* exp(r) */
+  int k;			/* counter */
+
+  x = x < EXPMAX ? x : EXPMAX;
+  x = x > EXPMIN ? x : EXPMIN;
+  t.Real = x * LOG2E + ROUNDER;
+  n = t.Real - ROUNDER;
+  r = x - n * LN2HI;
+  r = r - n * LN2LO;
+  p = ExpCoef[EXPTERMS - 1];
+  for (k = EXPTERMS - 2; k >= 0; k--)
+    p = p * r + ExpCoef[k];
+  Scale.Bits = (t.Bits + 1023) << 52;
+  return p * Scale.Real;
+}
+
+/*****************************************************************************
+  Transmissivity()
+
+  CalcTransmissivity() for one pixel, with Exp() and without the warning
+*****************************************************************************/
+static float Transmissivity(float SoilDepth, float WaterTable,
+			    float LateralKs, float KsExponent,
+			    float DepthThresh)
+{
+  float Depth;			/* Upper depth of the integral */
+  float Thresh;			/* Transmissivity above Depth */
+
+  if (KsExponent == 0.0)
+    return LateralKs * (SoilDepth - WaterTable);
+  Depth = WaterTable < DepthThresh ? WaterTable : DepthThresh;
+  Thresh = (LateralKs / KsExponent) *
+    (Exp(-KsExponent * Depth) - Exp(-KsExponent * SoilDepth));
+  if (WaterTable < DepthThresh)
+    return Thresh;
+  return (SoilDepth - WaterTable) / (SoilDepth - DepthThresh) * Thresh;
+}
+
+/*****************************************************************************
+  CalcTransmissivitiesScalar()
+
+  Scalar version of CalcTransmissivities
+*****************************************************************************/
+static void CalcTransmissivitiesScalar(int N, float *SoilDepth,
+				       float *WaterTable, float *LateralKs,
+				       float *KsExponent, float *DepthThresh,
+				       float *Out)
+{
+  int i;			/* counter */
+
+  for (i = 0; i < N; i++)
+    Out[i] = Transmissivity(SoilDepth[i], WaterTable[i], LateralKs[i],
+			    KsExponent[i], DepthThresh[i]);
+}
+
+#ifdef X86DISPATCH
+
+/*****************************************************************************
+  ExpSSE42()
+
+  Exp() for two values
+*****************************************************************************/
+__attribute__ ((target("sse4.2")))
+static __m128d ExpSSE42(__m128d x)
+{
+  __m128d t;			/* Float holding n */
+  __m128d n;			/* Power of two */
+  __m128d r;			/* Reduced argument */
+  __m128d p;			/* exp(r) */
+  __m128i Scale;		/* 2^n */
+  int k;			/* counter */
+
+  x = _mm_min_pd(x, _mm_set1_pd(EXPMAX));
+  x = _mm_max_pd(x, _mm_set1_pd(EXPMIN));
+  t = _mm_add_pd(_mm_mul_pd(x, _mm_set1_pd(LOG2E)), _mm_set1_pd(ROUNDER));
+  n = _mm_sub_pd(t, _mm_set1_pd(ROUNDER));
+  r = _mm_sub_pd(x, _mm_mul_pd(n, _mm_set1_pd(LN2HI)));
+  r = _mm_sub_pd(r, _mm_mul_pd(n, _mm_set1_pd(LN2LO)));
+  p = _mm_set1_pd(ExpCoef[EXPTERMS - 1]);
+  for (k = EXPTERMS - 2; k >= 0; k--)
+    p = _mm_add_pd(_mm_mul_pd(p, r), _mm_set1_pd(ExpCoef[k]));
+  Scale = _mm_slli_epi64(_mm_add_epi64(_mm_castpd_si128(t),
+				       _mm_set1_epi64x(1023)), 52);
+  return _mm_mul_pd(p, _mm_castsi128_pd(Scale));
+}
+
+/*****************************************************************************
+  CalcTransmissivitiesSSE42()
+
+  CalcTransmissivities for four pixels at a time, the exponentials two at a
+  time
+*****************************************************************************/
+__attribute__ ((target("sse4.2")))
+static void CalcTransmissivitiesSSE42(int N, float *SoilDepth,
+				      float *WaterTable, float *LateralKs,
+				      float *KsExponent, float *DepthThresh,
+				      float *Out)
+{
+  __m128 D, WT, Ks, K, DT;	/* Inputs of four pixels */
+  __m128 Depth;			/* Upper depth of the integral */
+  __m128 Above;			/* TRUE where WaterTable < DepthThresh */
+  __m128 Ratio;			/* Ks / KsExponent */
+  __m128 Thresh;		/* Transmissivity above Depth */
+  __m128 T;			/* Transmissivity */
+  __m128d Lo, Hi;		/* Exponentials of the lower and upper
+				   pixels */
+  __m128d DepthLo, DepthHi;	/* -KsExponent * Depth */
+  __m128d SoilLo, SoilHi;	/* -KsExponent * SoilDepth */
+  __m128 KD, KS;		/* -KsExponent * Depth, * SoilDepth */
+  int i;			/* counter */
+
+  for (i = 0; i + 4 <= N; i += 4) {
+    D = _mm_loadu_ps(SoilDepth + i);
+    WT = _mm_loadu_ps(WaterTable + i);
+    Ks = _mm_loadu_ps(LateralKs + i);
+    K = _mm_loadu_ps(KsExponent + i);
+    DT = _mm_loadu_ps(DepthThresh + i);
+
+    Above = _mm_cmplt_ps(WT, DT);
+    Depth = _mm_blendv_ps(DT, WT, Above);
+    KD = _mm_mul_ps(_mm_sub_ps(_mm_setzero_ps(), K), Depth);
+    KS = _mm_mul_ps(_mm_sub_ps(_mm_setzero_ps(), K), D);
+    DepthLo = _mm_cvtps_pd(KD);
+    DepthHi = _mm_cvtps_pd(_mm_movehl_ps(KD, KD));
+    SoilLo = _mm_cvtps_pd(KS);
+    SoilHi = _mm_cvtps_pd(_mm_movehl_ps(KS, KS));
+    Ratio = _mm_div_ps(Ks, K);
+    Lo = _mm_mul_pd(_mm_cvtps_pd(Ratio),
+		    _mm_sub_pd(ExpSSE42(DepthLo), ExpSSE42(SoilLo)));
+    Hi = _mm_mul_pd(_mm_cvtps_pd(_mm_movehl_ps(Ratio, Ratio)),
+		    _mm_sub_pd(ExpSSE42(DepthHi), ExpSSE42(SoilHi)));
+    Thresh = _mm_movelh_ps(_mm_cvtpd_ps(Lo), _mm_cvtpd_ps(Hi));
+
+    T = _mm_mul_ps(_mm_div_ps(_mm_sub_ps(D, WT), _mm_sub_ps(D, DT)), Thresh);
+    T = _mm_blendv_ps(T, Thresh, Above);
+    T = _mm_blendv_ps(T, _mm_mul_ps(Ks, _mm_sub_ps(D, WT)),
+		      _mm_cmpeq_ps(K, _mm_setzero_ps()));
+    _mm_storeu_ps(Out + i, T);
+  }
+  CalcTransmissivitiesScalar(N - i, SoilDepth + i, WaterTable + i,
+			     LateralKs + i, KsExponent + i, DepthThresh + i,
+			     Out + i);
+}
+
+/*****************************************************************************
+  ExpAVX2()
+
+  Exp() for four values
+*****************************************************************************/
+__attribute__ ((target("avx2")))
+static __m256d ExpAVX2(__m256d x)
+{
+  __m256d t;			/* Float holding n */
+  __m256d n;			/* Power of two */
+  __m256d r;			/* Reduced argument */
+  __m256d p;			/* exp(r) */
+  __m256i Scale;		/* 2^n */
+  int k;			/* counter */
+
+  x = _mm256_min_pd(x, _mm256_set1_pd(EXPMAX));
+  x = _mm256_max_pd(x, _mm256_set1_pd(EXPMIN));
+  t = _mm256_add_pd(_mm256_mul_pd(x, _mm256_set1_pd(LOG2E)),
+		    _mm256_set1_pd(ROUNDER));
+  n = _mm256_sub_pd(t, _mm256_set1_pd(ROUNDER));
+  r = _mm256_sub_pd(x, _mm256_mul_pd(n, _mm256_set1_pd(LN2HI)));
+  r = _mm256_sub_pd(r, _mm256_mul_pd(n, _mm256_set1_pd(LN2LO)));
+  p = _mm256_set1_pd(ExpCoef[EXPTERMS - 1]);
+  for (k = EXPTERMS - 2; k >= 0; k--)
+    p = _mm256_add_pd(_mm256_mul_pd(p, r), _mm256_set1_pd(ExpCoef[k]));
+  Scale = _mm256_slli_epi64(_mm256_add_epi64(_mm256_castpd_si256(t),
+					     _mm256_set1_epi64x(1023)), 52);
+  return _mm256_mul_pd(p, _mm256_castsi256_pd(Scale));
+}
+
+/*****************************************************************************
+  CalcTransmissivitiesAVX2()
+
+  CalcTransmissivities for four pixels at a time, the exponentials in
+  double precision
+*****************************************************************************/
+__attribute__ ((target("avx2")))
+static void CalcTransmissivitiesAVX2(int N, float *SoilDepth,
+				     float *WaterTable, float *LateralKs,
+				     float *KsExponent, float *DepthThresh,
+				     float *Out)
+{
+  __m128 D, WT, Ks, K, DT;	/* Inputs of four pixels */
+  __m128 Depth;			/* Upper depth of the integral */
+  __m128 Above;			/* TRUE where WaterTable < DepthThresh */
+  __m128 Thresh;		/* Transmissivity above Depth */
+  __m128 T;			/* Transmissivity */
+  __m128 Zero;			/* 0.0 */
+  __m128 KD, KS;		/* -KsExponent * Depth, * SoilDepth */
+  __m256d Ratio;		/* Ks / KsExponent */
+  __m256d E;			/* Difference of the exponentials */
+  int i;			/* counter */
+
+  Zero = _mm_setzero_ps();
+  for (i = 0; i + 4 <= N; i += 4) {
+    D = _mm_loadu_ps(SoilDepth + i);
+    WT = _mm_loadu_ps(WaterTable + i);
+    Ks = _mm_loadu_ps(LateralKs + i);
+    K = _mm_loadu_ps(KsExponent + i);
+    DT = _mm_loadu_ps(DepthThresh + i);
+
+    Above = _mm_cmp_ps(WT, DT, _CMP_LT_OQ);
+    Depth = _mm_blendv_ps(DT, WT, Above);
+    KD = _mm_mul_ps(_mm_sub_ps(Zero, K), Depth);
+    KS = _mm_mul_ps(_mm_sub_ps(Zero, K), D);
+    E = _mm256_sub_pd(ExpAVX2(_mm256_cvtps_pd(KD)),
+		      ExpAVX2(_mm256_cvtps_pd(KS)));
+    Ratio = _mm256_cvtps_pd(_mm_div_ps(Ks, K));
+    Thresh = _mm256_cvtpd_ps(_mm256_mul_pd(Ratio, E));
+
+    T = _mm_mul_ps(_mm_div_ps(_mm_sub_ps(D, WT), _mm_sub_ps(D, DT)), Thresh);
+    T = _mm_blendv_ps(T, Thresh, Above);
+    T = _mm_blendv_ps(T, _mm_mul_ps(Ks, _mm_sub_ps(D, WT)),
+		      _mm_cmp_ps(K, Zero, _CMP_EQ_OQ));
+    _mm_storeu_ps(Out + i, T);
+  }
+  _mm256_zeroupper();
+  CalcTransmissivitiesScalar(N - i, SoilDepth + i, WaterTable + i,
+			     LateralKs + i, KsExponent + i, DepthThresh + i,
+			     Out + i);
+}
+
+/*****************************************************************************
+  ExpAVX512()
+
+  Exp() for eight values
+*****************************************************************************/
+__attribute__ ((target("avx512f")))
+static __m512d ExpAVX512(__m512d x)
+{
+  __m512d t;			/* Float holding n */
+  __m512d n;			/* Power of two */
+  __m512d r;			/* Reduced argument */
+  __m512d p;			/* exp(r) */
+  __m512i Scale;		/* 2^n */
+  int k;			/* counter */
+
+  x = _mm512_min_pd(x, _mm512_set1_pd(EXPMAX));
+  x = _mm512_max_pd(x, _mm512_set1_pd(EXPMIN));
+  t = _mm512_add_pd(_mm512_mul_pd(x, _mm512_set1_pd(LOG2E)),
+		    _mm512_set1_pd(ROUNDER));
+  n = _mm512_sub_pd(t, _mm512_set1_pd(ROUNDER));
+  r = _mm512_sub_pd(x, _mm512_mul_pd(n, _mm512_set1_pd(LN2HI)));
+  r = _mm512_sub_pd(r, _mm512_mul_pd(n, _mm512_set1_pd(LN2LO)));
+  p = _mm512_set1_pd(ExpCoef[EXPTERMS - 1]);
+  for (k = EXPTERMS - 2; k >= 0; k--)
+    p = _mm512_add_pd(_mm512_mul_pd(p, r), _mm512_set1_pd(ExpCoef[k]));
+  Scale = _mm512_slli_epi64(_mm512_add_epi64(_mm512_castpd_si512(t),
+					     _mm512_set1_epi64(1023)), 52);
+  return _mm512_mul_pd(p, _mm512_castsi512_pd(Scale));
+}
+
+/*****************************************************************************
+  CalcTransmissivitiesAVX512()
+
+  CalcTransmissivities for eight pixels at a time, the exponentials in
+  double precision
+*****************************************************************************/
+__attribute__ ((target("avx512f")))
+static void CalcTransmissivitiesAVX512(int N, float *SoilDepth,
+				       float *WaterTable, float *LateralKs,
+				       float *KsExponent, float *DepthThresh,
+				       float *Out)
+{
+  __m256 D, WT, Ks, K, DT;	/* Inputs of eight pixels */
+  __m256 Depth;			/* Upper depth of the integral */
+  __m256 Above;			/* TRUE where WaterTable < DepthThresh */
+  __m256 Thresh;		/* Transmissivity above Depth */
+  __m256 T;			/* Transmissivity */
+  __m256 Zero;			/* 0.0 */
+  __m256 KD, KS;		/* -KsExponent * Depth, * SoilDepth */
+  __m512d Ratio;		/* Ks / KsExponent */
+  __m512d E;			/* Difference of the exponentials */
+  int i;			/* counter */
+
+  Zero = _mm256_setzero_ps();
+  for (i = 0; i + 8 <= N; i += 8) {
+    D = _mm256_loadu_ps(SoilDepth + i);
+    WT = _mm256_loadu_ps(WaterTable + i);
+    Ks = _mm256_loadu_ps(LateralKs + i);
+    K = _mm256_loadu_ps(KsExponent + i);
+    DT = _mm256_loadu_ps(DepthThresh + i);
+
+    Above = _mm256_cmp_ps(WT, DT, _CMP_LT_OQ);
+    Depth = _mm256_blendv_ps(DT, WT, Above);
+    KD = _mm256_mul_ps(_mm256_sub_ps(Zero, K), Depth);
+    KS = _mm256_mul_ps(_mm256_sub_ps(Zero, K), D);
+    E = _mm512_sub_pd(ExpAVX512(_mm512_cvtps_pd(KD)),
+		      ExpAVX512(_mm512_cvtps_pd(KS)));
+    Ratio = _mm512_cvtps_pd(_mm256_div_ps(Ks, K));
+    Thresh = _mm512_cvtpd_ps(_mm512_mul_pd(Ratio, E));
+
+    T = _mm256_mul_ps(_mm256_div_ps(_mm256_sub_ps(D, WT),
+				    _mm256_sub_ps(D, DT)), Thresh);
+    T = _mm256_blendv_ps(T, Thresh, Above);
+    T = _mm256_blendv_ps(T, _mm256_mul_ps(Ks, _mm256_sub_ps(D, WT)),
+			 _mm256_cmp_ps(K, Zero, _CMP_EQ_OQ));
+    _mm256_storeu_ps(Out + i, T);
+  }
+  _mm256_zeroupper();
+  CalcTransmissivitiesScalar(N - i, SoilDepth + i, WaterTable + i,
+			     LateralKs + i, KsExponent + i, DepthThresh + i,
+			     Out + i);
+}
+
+#endif
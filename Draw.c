@@ -162,7 +162,7 @@ void draw(DATE * Day, int first, int DayStep, MAPSIZE *Map, int NGraphics,
 	      for (j = 0; j < Map->NY; j++) {
 
 		if (INBASIN(TopoMap[j][i].Mask)) {
-		  temp = TopoMap[j][i].Dem;
+		  temp = TOPODEM(TopoMap[j][i]);
 		  if (temp > max)
 		    max = temp;
 		  if (temp < min)
@@ -216,7 +216,7 @@ void draw(DATE * Day, int first, int DayStep, MAPSIZE *Map, int NGraphics,
 	      for (j = 0; j < Map->NY; j++) {
 
 		if (INBASIN(TopoMap[j][i].Mask)) {
-		  temp = SoilMap[j][i].Depth * 1000.;
+		  temp = SOILDEPTH(SoilMap[j][i]) * 1000.;
 		  if (temp > max)
 		    max = temp;
 		  if (temp < min)
@@ -803,7 +803,7 @@ void draw(DATE * Day, int first, int DayStep, MAPSIZE *Map, int NGraphics,
 		    for (jj=0; jj< Map->DX/Map->DMASS; jj++) {
 		      yy = (int) j*Map->DY/Map->DMASS + ii;
 		      xx = (int) i*Map->DX/Map->DMASS + jj;
-		      temp += (*FineMap[yy][xx]).Dem;
+		      temp += FINEDEM(*FineMap[yy][xx]);
 		    }
 		  }
 		  // Normalize by # FineMap cells in a pixel
@@ -1018,7 +1018,7 @@ void draw(DATE * Day, int first, int DayStep, MAPSIZE *Map, int NGraphics,
 	      for (j = 0; j < Map->NY; j++) {
 
 		if (INBASIN(TopoMap[j][i].Mask)) {
-		  temp = TopoMap[j][i].Aspect * 57.2957;
+		  temp = TOPOASPECT(TopoMap[j][i]) * 57.2957;
 		  if (temp > max)
 		    max = temp;
 		  if (temp < min)
@@ -1036,7 +1036,7 @@ void draw(DATE * Day, int first, int DayStep, MAPSIZE *Map, int NGraphics,
 	      for (j = 0; j < Map->NY; j++) {
 
 		if (INBASIN(TopoMap[j][i].Mask)) {
-		  temp = TopoMap[j][i].Slope * 100.0;
+		  temp = TOPOSLOPE(TopoMap[j][i]) * 100.0;
 		  if (temp > max)
 		    max = temp;
 		  if (temp < min)
@@ -0,0 +1,727 @@
+/*
+ * SUMMARY:      Ensemble.c - Run a scenario ensemble
+ * USAGE:        Part of DHSVM
+ *
+ * AUTHOR:       DHSVM development team
+ * ORG:          University of Washington, Department of Civil Engineering
+ * E-MAIL:
+ * ORIG-DATE:    Oct-2026
+ * DESCRIPTION:  With ENSEMBLE MODE = PROCESS the model is initialized once,
+ *               after which a separate process is forked for each ensemble
+ *               member.  The members share the initialized terrain, tables,
+ *               channel network and met interpolation weights copy-on-write,
+ *               apply their own perturbations and write their output to
+ *               their own directory.  With ENSEMBLE MODE = SHARED all members
+ *               run in one process, each with its own full set of model state
+ *               maps, and the met interpolation of a pixel is done once and
+ *               shared by all members, except for the air temperature and
+ *               the precipitation of the perturbed members, see
+ *               PerturbLocalMet()
+ * DESCRIP-END.
+ * FUNCTIONS:    InitEnsemble()
+ *               RunEnsemble()
+ *               InitEnsembleMember()
+ *               PerturbParameters()
+ *               PerturbMetData()
+ *               InitMemberStates()
+ *               InitMemberSweep()
+ *               MemberMassEnergyBalance()
+ *               FreeMemberSweep()
+ *               SwapMemberState()
+ *               WaitForProcess()
+ *               ProcessFailed()
+ * COMMENTS:
+ * $Id: Ensemble.c,v 1.0 2026/10/17 Exp $
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "settings.h"
+#include "constants.h"
+#include "data.h"
+#include "DHSVMerror.h"
+#include "fileio.h"
+#include "functions.h"
+#include "ensemble.h"
+
+/*****************************************************************************
+  Function name: InitEnsemble()
+
+  Purpose      : Read the perturbations for each ensemble member
+
+  Required     :
+    char *EnsembleFile        - File with one line per member:
+                                "name precip_multiplier temperature_offset
+                                ks_lateral_multiplier".  Empty lines and
+                                lines starting with '#' are skipped
+    ENSEMBLESTRUCT *Ensemble  - Ensemble information
+
+  Returns      : void
+
+  Modifies     : Ensemble->NMembers, Ensemble->Members
+
+  Comments     : The member name is used as the name of the output
+                 subdirectory and therefore cannot contain a '/'.  A member
+                 with multipliers of 1 and an offset of 0 reproduces the run
+                 without ensemble.
+*****************************************************************************/
+void InitEnsemble(char *EnsembleFile, ENSEMBLESTRUCT *Ensemble)
+{
+  const char *Routine = "InitEnsemble";
+  FILE *InFile = NULL;
+  char Buffer[BUFSIZE + 1];
+  char *Str;
+  int NLines;			/* Number of lines in the ensemble file */
+  int i;			/* counter */
+  int j;			/* counter */
+  ENSMEMBER *Member;
+
+  OpenFile(&InFile, EnsembleFile, "r", FALSE);
+
+  NLines = CountLines(InFile);
+  rewind(InFile);
+
+  if (!(Ensemble->Members = (ENSMEMBER *) calloc(NLines, sizeof(ENSMEMBER))))
+    ReportError((char *) Routine, 1);
+
+  Ensemble->NMembers = 0;
+  for (i = 0; i < NLines; i++) {
+    if (!fgets(Buffer, BUFSIZE, InFile))
+      break;
+    for (Str = Buffer; *Str == ' ' || *Str == '\t'; Str++)
+      ;
+    if (*Str == '#' || *Str == '\n' || *Str == '\r' || *Str == '\0')
+      continue;
+    Member = &(Ensemble->Members[Ensemble->NMembers]);
+    if (sscanf(Str, "%s %f %f %f", Member->Name, &(Member->PrecipMultiplier),
+	       &(Member->TempOffset), &(Member->KsLatMultiplier)) != 4 ||
+	strchr(Member->Name, '/') != NULL || Member->PrecipMultiplier < 0.0 ||
+	Member->KsLatMultiplier <= 0.0) {
+      sprintf(errorstr, "%s, line %d", EnsembleFile, i + 1);
+      ReportError(errorstr, 5);
+    }
+    for (j = 0; j < Ensemble->NMembers; j++)
+      if (strcmp(Ensemble->Members[j].Name, Member->Name) == 0) {
+	sprintf(errorstr, "%s, line %d", EnsembleFile, i + 1);
+	ReportError(errorstr, 5);
+      }
+    Ensemble->NMembers++;
+  }
+  fclose(InFile);
+
+  if (Ensemble->NMembers == 0)
+    ReportError(EnsembleFile, 2);
+
+  printf("Running %d ensemble members from %s\n", Ensemble->NMembers,
+	 EnsembleFile);
+}
+
+/*****************************************************************************
+  Function name: RunEnsemble()
+
+  Purpose      : Fork one process for each ensemble member, with no more than
+                 Ensemble->MaxProcesses members running at the same time
+
+  Required     :
+    ENSEMBLESTRUCT *Ensemble  - Ensemble information
+    int NStats                - Number of met stations
+    METLOCATION *Stat         - Met stations
+
+  Returns      : void
+
+  Modifies     : Ensemble->Member, the met file pointers in the members
+
+  Comments     : Only returns in the member processes, with Ensemble->Member
+                 set to the member that the process simulates.  The parent
+                 waits for all members and exits with EXIT_FAILURE if any of
+                 them failed.  The met station files are opened before the
+                 fork, and a forked process shares the file offset with its
+                 parent, so each member opens its own copy.
+*****************************************************************************/
+void RunEnsemble(ENSEMBLESTRUCT *Ensemble, int NStats, METLOCATION *Stat)
+{
+  const char *Routine = "RunEnsemble";
+  pid_t *Pid;			/* process id for each member, 0 if done */
+  pid_t NewPid;
+  int ExitStatus;		/* exit status of a member */
+  int NRunning;			/* Number of members running */
+  int NFailed;			/* Number of members that failed */
+  int i;			/* counter */
+  int j;			/* counter */
+
+  if (!(Pid = (pid_t *) calloc(Ensemble->NMembers, sizeof(pid_t))))
+    ReportError((char *) Routine, 1);
+
+  printf("\nSTARTING %d ENSEMBLE MEMBERS, %d AT A TIME\n\n",
+	 Ensemble->NMembers, Ensemble->MaxProcesses);
+
+  NRunning = 0;
+  NFailed = 0;
+  for (i = 0; i < Ensemble->NMembers; i++) {
+    if (NRunning == Ensemble->MaxProcesses) {
+      j = WaitForProcess((char *) Routine, Pid, Ensemble->NMembers,
+			 &ExitStatus);
+      NFailed += ProcessFailed("Ensemble member", Ensemble->Members[j].Name,
+			       ExitStatus);
+      NRunning--;
+    }
+
+    /* flush the output first, otherwise it is printed again by the member */
+    fflush(stdout);
+    fflush(stderr);
+
+    NewPid = fork();
+    if (NewPid == -1)
+      ReportError(Ensemble->Members[i].Name, 80);
+    if (NewPid == 0) {
+      Ensemble->Member = i;
+      free(Pid);
+      for (j = 0; j < NStats; j++) {
+	fclose(Stat[j].MetFile.FilePtr);
+	OpenFile(&(Stat[j].MetFile.FilePtr), Stat[j].MetFile.FileName, "r",
+		 FALSE);
+      }
+      return;
+    }
+    Pid[i] = NewPid;
+    printf("Started ensemble member %s (process %d)\n",
+	   Ensemble->Members[i].Name, (int) NewPid);
+    NRunning++;
+  }
+  for (; NRunning > 0; NRunning--) {
+    j = WaitForProcess((char *) Routine, Pid, Ensemble->NMembers, &ExitStatus);
+    NFailed += ProcessFailed("Ensemble member", Ensemble->Members[j].Name,
+			     ExitStatus);
+  }
+
+  printf("\nEND OF ENSEMBLE RUN, %d OF %d MEMBERS FAILED\n\n", NFailed,
+	 Ensemble->NMembers);
+
+  exit(NFailed > 0 ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+
+/*****************************************************************************
+  Function name: InitEnsembleMember()
+
+  Purpose      : Create the output directory of an ensemble member and send
+                 the standard output and standard error of the member to it
+
+  Required     :
+    ENSEMBLESTRUCT *Ensemble  - Ensemble information
+    char *Path                - Output directory
+
+  Returns      : void
+
+  Modifies     : Path, stdout, stderr
+
+  Comments     : The member directory is a subdirectory of the output
+                 directory with the name of the member.  Nothing is done in
+                 the ensemble parent or in a run without ensemble.  With
+                 ENSEMBLE MODE = SHARED all members write to the same
+                 standard output and standard error.
+*****************************************************************************/
+void InitEnsembleMember(ENSEMBLESTRUCT *Ensemble, char *Path)
+{
+  char FileName[BUFSIZE + 1];
+
+  if (Ensemble->Member < 0)
+    return;
+
+  strcat(Path, Ensemble->Members[Ensemble->Member].Name);
+  strcat(Path, "/");
+  if (mkdir(Path, 0755) != 0 && errno != EEXIST)
+    ReportError(Path, 81);
+
+  if (Ensemble->Mode == ENSEMBLE_SHARED) {
+    printf("Initializing ensemble member %s\n",
+	   Ensemble->Members[Ensemble->Member].Name);
+    return;
+  }
+
+  sprintf(FileName, "%sStandard.Out", Path);
+  if (!freopen(FileName, "w", stdout))
+    ReportError(FileName, 3);
+  sprintf(FileName, "%sStandard.Error", Path);
+  if (!freopen(FileName, "w", stderr))
+    ReportError(FileName, 3);
+
+  printf("Ensemble member %s: precipitation multiplier %g, temperature "
+	 "offset %g, lateral conductivity multiplier %g\n\n",
+	 Ensemble->Members[Ensemble->Member].Name,
+	 Ensemble->Members[Ensemble->Member].PrecipMultiplier,
+	 Ensemble->Members[Ensemble->Member].TempOffset,
+	 Ensemble->Members[Ensemble->Member].KsLatMultiplier);
+}
+
+/*****************************************************************************
+  Function name: PerturbParameters()
+
+  Purpose      : Apply the parameter perturbations of an ensemble member
+
+  Required     :
+    ENSEMBLESTRUCT *Ensemble  - Ensemble information
+    LAYER *Soil               - Soil layer information
+    SOILTABLE *SType          - Soil parameters
+
+  Returns      : void
+
+  Modifies     : SType
+
+  Comments     : The soil table is shared with the ensemble parent until it
+                 is modified here, after which the member has its own copy
+*****************************************************************************/
+void PerturbParameters(ENSEMBLESTRUCT *Ensemble, LAYER *Soil,
+		       SOILTABLE *SType)
+{
+  int i;
+
+  if (Ensemble->Mode != ENSEMBLE_PROCESS || Ensemble->Member < 0)
+    return;
+
+  for (i = 0; i < Soil->NTypes; i++)
+    SType[i].KsLat *= Ensemble->Members[Ensemble->Member].KsLatMultiplier;
+}
+
+/*****************************************************************************
+  Function name: PerturbMetData()
+
+  Purpose      : Apply the forcing perturbations of an ensemble member to the
+                 met data for the current time step
+
+  Required     :
+    ENSEMBLESTRUCT *Ensemble  - Ensemble information
+    OPTIONSTRUCT *Options     - Structure with different program options
+    MAPSIZE *Map              - Coverage and resolution of model area
+    MAPSIZE *Radar            - Coverage and resolution of the radar data
+    int NStats                - Number of met stations
+    METLOCATION *Stat         - Met stations
+    RADARPIX **RadarMap       - Radar precipitation
+    MM5MAPS MM5Input         - MM5 input maps, see compact.h
+
+  Returns      : void
+
+  Modifies     : Stat[].Data, RadarMap, MM5Input
+
+  Comments     : Must be called once after InitNewStep(), and only modifies
+                 the inputs that InitNewStep() has read for this time step.
+                 With ENSEMBLE MODE = SHARED the perturbations are applied by
+                 SweepCellMembers() instead.
+*****************************************************************************/
+void PerturbMetData(ENSEMBLESTRUCT *Ensemble, OPTIONSTRUCT *Options,
+		    MAPSIZE *Map, MAPSIZE *Radar, int NStats,
+		    METLOCATION *Stat, RADARPIX **RadarMap, MM5MAPS MM5Input)
+{
+  ENSMEMBER *Member;
+  int i;			/* counter */
+  int x;			/* counter */
+  int y;			/* counter */
+
+  if (Ensemble->Mode != ENSEMBLE_PROCESS || Ensemble->Member < 0)
+    return;
+  Member = &(Ensemble->Members[Ensemble->Member]);
+
+  if (Options->MM5 == TRUE) {
+#ifdef COMPACT_MAPS
+    /* shift and scale the codes of the maps instead */
+    MM5Input[MM5_temperature - 1].Offset += Member->TempOffset;
+    MM5Input[MM5_precip - 1].Offset *= Member->PrecipMultiplier;
+    MM5Input[MM5_precip - 1].Scale *= Member->PrecipMultiplier;
+#else
+    for (y = 0; y < Map->NY; y++)
+      for (x = 0; x < Map->NX; x++) {
+	MM5Input[MM5_temperature - 1][y][x] += Member->TempOffset;
+	MM5Input[MM5_precip - 1][y][x] *= Member->PrecipMultiplier;
+      }
+#endif
+  }
+
+  if ((Options->MM5 == TRUE && Options->QPF == TRUE) || Options->MM5 == FALSE) {
+    for (i = 0; i < NStats; i++) {
+      Stat[i].Data.Tair += Member->TempOffset;
+      Stat[i].Data.Precip *= Member->PrecipMultiplier;
+    }
+    if (Options->PrecipType == RADAR)
+      for (y = 0; y < Radar->NY; y++)
+	for (x = 0; x < Radar->NX; x++)
+	  RadarMap[y][x].Precip *= Member->PrecipMultiplier;
+  }
+}
+
+/*****************************************************************************
+  Function name: InitMemberStates()
+
+  Purpose      : Set up the model state of each member of an ensemble that
+                 runs in one process (ENSEMBLE MODE = SHARED)
+
+  Required     :
+    LISTPTR Input               - Linked list with input strings
+    OPTIONSTRUCT *Options       - Structure with different program options
+    MAPSIZE *Map                - Coverage and resolution of model area
+    TIMESTRUCT *Time            - Model time
+    LAYER *Soil                 - Soil layer information
+    LAYER *Veg                  - Vegetation layer information
+    SOILTABLE *SType            - Soil parameters
+    VEGTABLE *VType             - Vegetation parameters
+    VEGPIX **VegMap             - Vegetation map
+    TOPOPIX **TopoMap           - Topography
+    SNOWTABLE *SnowAlbedo       - Snow albedo table
+    UNITHYDRINFO *HydrographInfo - Unit hydrograph information
+    float *Hydrograph           - Unit hydrograph outflow of the first
+                                  member, NULL if not used
+    int *MaxStreamID            - Largest stream segment ID
+    int *MaxRoadID              - Largest road segment ID
+    MEMBERSTATE **Members       - Model state of each member
+
+  Returns      : void
+
+  Modifies     : Members, Options->Ensemble.Member
+
+  Comments     : The model state of the first member is the state that the
+                 main program has already set up, and is copied into
+                 (*Members)[0] by the caller.  For the other members the soil
+                 map, channel network, road network, precipitation, snow and
+                 evaporation maps and the output files are set up in the
+                 same way as in the main program, and the initial state is
+                 read from the same state files.  The vegetation map is
+                 copied, because it holds the canopy temperature.  Each
+                 member gets its own copy of the soil table with its lateral
+                 conductivity multiplier applied.
+*****************************************************************************/
+void InitMemberStates(LISTPTR Input, OPTIONSTRUCT *Options, MAPSIZE *Map,
+		      TIMESTRUCT *Time, LAYER *Soil, LAYER *Veg,
+		      SOILTABLE *SType, VEGTABLE *VType, VEGPIX **VegMap,
+		      TOPOPIX **TopoMap, SNOWTABLE *SnowAlbedo,
+		      UNITHYDRINFO *HydrographInfo, float *Hydrograph,
+		      int *MaxStreamID, int *MaxRoadID,
+		      MEMBERSTATE **Members)
+{
+  const char *Routine = "InitMemberStates";
+  ENSEMBLESTRUCT *Ensemble = &(Options->Ensemble);
+  MEMBERSTATE *Member;
+  int NGraphics;		/* number of graphics for X11 */
+  int *which_graphics;		/* which graphics for X11 */
+  int e;			/* member counter */
+  int i;			/* counter */
+  int x;			/* counter */
+  int y;			/* counter */
+
+  if (!(*Members = (MEMBERSTATE *) calloc(Ensemble->NMembers,
+					  sizeof(MEMBERSTATE))))
+    ReportError((char *) Routine, 1);
+
+  for (e = 0; e < Ensemble->NMembers; e++) {
+    Member = &((*Members)[e]);
+
+    if (!(Member->SType = (SOILTABLE *) calloc(Soil->NTypes,
+					       sizeof(SOILTABLE))))
+      ReportError((char *) Routine, 1);
+    for (i = 0; i < Soil->NTypes; i++) {
+      Member->SType[i] = SType[i];
+      Member->SType[i].KsLat *= Ensemble->Members[e].KsLatMultiplier;
+    }
+
+    if (e == 0)
+      continue;
+
+    Ensemble->Member = e;
+
+    if (!(Member->VegMap = (VEGPIX **) calloc(Map->NY, sizeof(VEGPIX *))))
+      ReportError((char *) Routine, 1);
+    for (y = 0; y < Map->NY; y++) {
+      if (!(Member->VegMap[y] = (VEGPIX *) calloc(Map->NX, sizeof(VEGPIX))))
+	ReportError((char *) Routine, 1);
+      for (x = 0; x < Map->NX; x++)
+	Member->VegMap[y][x] = VegMap[y][x];
+    }
+
+    InitSoilMap(Input, Options, Map, Soil, TopoMap, &(Member->SoilMap));
+
+    if (Options->HasNetwork)
+      InitChannel(Input, Map, Time->Dt, &(Member->ChannelData),
+		  Member->SoilMap, MaxStreamID, MaxRoadID, Options);
+    else if (Hydrograph != NULL) {
+      if (!(Member->Hydrograph =
+	    (float *) calloc(HydrographInfo->TotalWaveLength, sizeof(float))))
+	ReportError((char *) Routine, 1);
+    }
+
+    if (Options->Components == FULL_MODEL)
+      InitNetwork(Map->NY, Map->NX, Map->DX, Map->DY, TopoMap,
+		  Member->SoilMap, Member->VegMap, VType, &(Member->Network),
+		  &(Member->ChannelData), *Veg, Options);
+
+    InitEvapMap(Map, &(Member->EvapMap), Member->SoilMap, Soil,
+		Member->VegMap, Veg, TopoMap);
+    InitPrecipMap(Map, &(Member->PrecipMap), Member->VegMap, Veg, TopoMap);
+
+    InitDump(Input, Options, Map, Soil->MaxLayers, Veg->MaxLayers, Time->Dt,
+	     TopoMap, &(Member->Dump), &NGraphics, &which_graphics);
+
+    if (Options->HasNetwork == TRUE) {
+      InitChannelDump(&(Member->ChannelData), Member->Dump.Path);
+      ReadChannelState(Member->Dump.InitStatePath, &(Time->Start),
+		       Member->ChannelData.streams);
+    }
+
+    InitSnowMap(Map, &(Member->SnowMap));
+    InitAggregated(Veg->MaxLayers, Soil->MaxLayers, &(Member->Total));
+
+    InitModelState(&(Time->Start), Map, Options, Member->PrecipMap,
+		   Member->SnowMap, Member->SoilMap, *Soil, Member->SType,
+		   Member->VegMap, *Veg, VType, Member->Dump.InitStatePath,
+		   SnowAlbedo, TopoMap, Member->Network, HydrographInfo,
+		   Member->Hydrograph);
+  }
+}
+
+/*****************************************************************************
+  Function name: InitMemberSweep()
+
+  Purpose      : Allocate the arrays that MemberMassEnergyBalance() passes to
+                 SweepCellMembers()
+
+  Required     :
+    int NMembers              - Number of members
+    MEMBERSTATE *Members      - Model state of each member
+    MEMBERSWEEP *MemberSweep  - Model structures of each member
+
+  Returns      : void
+
+  Modifies     : MemberSweep
+
+  Comments     : The radiation totals stay in Members, which is not moved
+                 after the initialization
+*****************************************************************************/
+void InitMemberSweep(int NMembers, MEMBERSTATE *Members,
+		     MEMBERSWEEP *MemberSweep)
+{
+  const char *Routine = "InitMemberSweep";
+  int e;			/* member counter */
+
+  if (!(MemberSweep->Sweep = (CELLSWEEP *) calloc(NMembers,
+						  sizeof(CELLSWEEP))))
+    ReportError((char *) Routine, 1);
+  if (!(MemberSweep->TotalRad = (PIXRAD **) calloc(NMembers,
+						   sizeof(PIXRAD *))))
+    ReportError((char *) Routine, 1);
+  if (!(MemberSweep->LocalMet = (PIXMET *) calloc(NMembers, sizeof(PIXMET))))
+    ReportError((char *) Routine, 1);
+
+  for (e = 0; e < NMembers; e++)
+    MemberSweep->TotalRad[e] = &(Members[e].Total.Rad);
+}
+
+/*****************************************************************************
+  Function name: MemberMassEnergyBalance()
+
+  Purpose      : Run the column physics for all pixels and all members of an
+                 ensemble that runs in one process
+
+  Required     :
+    MEMBERSTATE *Members      - Model state of each member
+    ENSEMBLESTRUCT *Ensemble  - Ensemble information
+    CELLSWEEP *Sweep          - Pointers to the shared model structures
+    MEMBERSWEEP *MemberSweep  - Model structures of each member, from
+                                InitMemberSweep()
+
+  Returns      : void
+
+  Modifies     : the model state of each member
+
+  Comments     : The pixels are processed in the outer loop and the members
+                 in the inner loop (in SweepCellMembers()), so that the met
+                 interpolation of a pixel is done once for all members.  The
+                 column physics itself runs once per member, on the maps of
+                 that member.  InitNewStep() only sets the water level of the
+                 first member, the water level of the other members is set
+                 here.
+*****************************************************************************/
+void MemberMassEnergyBalance(MEMBERSTATE *Members, ENSEMBLESTRUCT *Ensemble,
+			     CELLSWEEP *Sweep, MEMBERSWEEP *MemberSweep)
+{
+  MAPSIZE *Map = Sweep->Map;
+  int e;			/* member counter */
+  int x;			/* counter */
+  int y;			/* counter */
+
+  /* the shared structures and the maps of the members are swapped in and
+     out of the main program between steps, so the pointers are set again */
+  for (e = 0; e < Ensemble->NMembers; e++) {
+    MemberSweep->Sweep[e] = *Sweep;
+    MemberSweep->Sweep[e].PrecipMap = Members[e].PrecipMap;
+    MemberSweep->Sweep[e].SnowMap = Members[e].SnowMap;
+    MemberSweep->Sweep[e].Network = Members[e].Network;
+    MemberSweep->Sweep[e].SType = Members[e].SType;
+    MemberSweep->Sweep[e].SoilMap = Members[e].SoilMap;
+    MemberSweep->Sweep[e].VegMap = Members[e].VegMap;
+    MemberSweep->Sweep[e].EvapMap = Members[e].EvapMap;
+    MemberSweep->Sweep[e].ChannelData = &(Members[e].ChannelData);
+
+    if (e > 0 && Sweep->Options->FlowGradient == WATERTABLE)
+      for (y = 0; y < Map->NY; y++)
+	for (x = 0; x < Map->NX; x++)
+	  if (INBASIN(Sweep->TopoMap[y][x].Mask))
+	    Members[e].SoilMap[y][x].WaterLevel =
+	      TOPODEM(Sweep->TopoMap[y][x]) - Members[e].SoilMap[y][x].TableDepth;
+  }
+
+  for (y = 0; y < Map->NY; y++)
+    for (x = 0; x < Map->NX; x++)
+      if (INBASIN(Sweep->TopoMap[y][x].Mask))
+	SweepCellMembers(MemberSweep->Sweep, Ensemble->NMembers,
+			 Ensemble->Members, y, x, MemberSweep->TotalRad,
+			 MemberSweep->LocalMet);
+
+  for (e = 0; e < Ensemble->NMembers; e++)
+    Members[e].LocalMet = MemberSweep->LocalMet[e];
+}
+
+/*****************************************************************************
+  Function name: FreeMemberSweep()
+*****************************************************************************/
+void FreeMemberSweep(MEMBERSWEEP *MemberSweep)
+{
+  free(MemberSweep->Sweep);
+  free(MemberSweep->TotalRad);
+  free(MemberSweep->LocalMet);
+}
+
+/*****************************************************************************
+  Function name: SwapMemberState()
+
+  Purpose      : Exchange the model state of a member with the model state
+                 used by the main program
+
+  Required     :
+    MEMBERSTATE *Member - Model state of the member
+    the model state of the main program
+
+  Returns      : void
+
+  Modifies     : Member and the model state of the main program
+
+  Comments     : Called in pairs around the routing and output of each
+                 member, so that the main program can route and write the
+                 output for each member in turn with the same code as
+                 without ensemble.  After the second call the main program
+                 has its own model state back.
+*****************************************************************************/
+void SwapMemberState(MEMBERSTATE *Member, AGGREGATED *Total,
+		     WATERBALANCE *Mass, DUMPSTRUCT *Dump,
+		     CHANNEL *ChannelData, EVAPPIX ***EvapMap,
+		     PRECIPPIX ***PrecipMap, ROADSTRUCT ***Network,
+		     SNOWPIX ***SnowMap, SOILPIX ***SoilMap,
+		     VEGPIX ***VegMap, SOILTABLE **SType, float **Hydrograph,
+		     PIXMET *LocalMet)
+{
+  MEMBERSTATE Main;
+
+  Main.Total = *Total;
+  Main.Mass = *Mass;
+  Main.Dump = *Dump;
+  Main.ChannelData = *ChannelData;
+  Main.EvapMap = *EvapMap;
+  Main.PrecipMap = *PrecipMap;
+  Main.Network = *Network;
+  Main.SnowMap = *SnowMap;
+  Main.SoilMap = *SoilMap;
+  Main.VegMap = *VegMap;
+  Main.SType = *SType;
+  Main.Hydrograph = *Hydrograph;
+  Main.LocalMet = *LocalMet;
+
+  *Total = Member->Total;
+  *Mass = Member->Mass;
+  *Dump = Member->Dump;
+  *ChannelData = Member->ChannelData;
+  *EvapMap = Member->EvapMap;
+  *PrecipMap = Member->PrecipMap;
+  *Network = Member->Network;
+  *SnowMap = Member->SnowMap;
+  *SoilMap = Member->SoilMap;
+  *VegMap = Member->VegMap;
+  *SType = Member->SType;
+  *Hydrograph = Member->Hydrograph;
+  *LocalMet = Member->LocalMet;
+
+  *Member = Main;
+}
+
+/*****************************************************************************
+  Function name: WaitForProcess()
+
+  Purpose      : Wait for one of the processes forked by an ensemble or
+                 calibration run to finish
+
+  Required     :
+    char *Routine   - Name of the calling routine, for the error message
+    pid_t *Pid      - Process id in each slot, 0 for a free slot
+    int NSlots      - Number of slots
+    int *ExitStatus - Exit status of the process that finished
+
+  Returns      : int, the slot of the process that finished
+
+  Modifies     : Pid, ExitStatus
+
+  Comments     : The slot of the process that finished is freed.  Other
+                 child processes are waited for as well but ignored.
+*****************************************************************************/
+int WaitForProcess(char *Routine, pid_t *Pid, int NSlots, int *ExitStatus)
+{
+  pid_t Done;			/* process id of the finished process */
+  int i;
+
+  do {
+    Done = wait(ExitStatus);
+    if (Done == -1)
+      ReportError(Routine, 14);
+    for (i = 0; i < NSlots; i++)
+      if (Pid[i] == Done)
+	break;
+  } while (i == NSlots);
+
+  Pid[i] = 0;
+  return i;
+}
+
+/*****************************************************************************
+  Function name: ProcessFailed()
+
+  Purpose      : Report how a process forked by an ensemble or calibration
+                 run finished
+
+  Required     :
+    char *Kind     - What the process simulated, e.g. "Ensemble member"
+    char *Name     - Name of the member or parameter set
+    int ExitStatus - Exit status from WaitForProcess()
+
+  Returns      : int, TRUE if the process failed, FALSE otherwise
+
+  Modifies     : void
+
+  Comments     :
+*****************************************************************************/
+int ProcessFailed(char *Kind, char *Name, int ExitStatus)
+{
+  int Failed = TRUE;
+
+  if (WIFEXITED(ExitStatus) && WEXITSTATUS(ExitStatus) == EXIT_SUCCESS) {
+    printf("%s %s finished\n", Kind, Name);
+    Failed = FALSE;
+  }
+  else if (WIFEXITED(ExitStatus))
+    printf("%s %s failed with exit status %d\n", Kind, Name,
+	   WEXITSTATUS(ExitStatus));
+  else
+    printf("%s %s was terminated by signal %d\n", Kind, Name,
+	   WTERMSIG(ExitStatus));
+  fflush(stdout);
+
+  return Failed;
+}
@@ -39,6 +39,8 @@ void EvapoTranspiration(int Layer, int Dt, PIXMET * Met, float NetRad,
 				   after the interception storage is depleted 
 				   (sec) */
   float F;			/* Fractional coverage by vegetation layer */
+  float MaxInt;			/* Maximum interception storage as if the
+				   entire pixel is covered (m) */
   float SoilMoisture;		/* Amount of water in each soil layer (m) */
   float WetArea;		/* relative leaf area wetted by interception 
 				   storage */
@@ -57,7 +59,7 @@ void EvapoTranspiration(int Layer, int Dt, PIXMET * Met, float NetRad,
   *Int /= F;
   NetRad /= F;
   MoistureFlux /= F;
-  VType->MaxInt[Layer] /= F;
+  MaxInt = VType->MaxInt[Layer] / F;
 
   /* allocate memory for the canopy resistance array */
 
@@ -87,7 +89,7 @@ void EvapoTranspiration(int Layer, int Dt, PIXMET * Met, float NetRad,
     LocalEvap->EPot[Layer] = 0;
 
   /* WetArea = pow(*Int/VType->MaxInt[Layer], (double) 2.0/3.0); */
-  WetArea = cbrt(*Int / VType->MaxInt[Layer]);
+  WetArea = cbrt(*Int / MaxInt);
   WetArea = WetArea * WetArea;
   DryArea = 1 - WetArea;
 
@@ -139,7 +141,6 @@ void EvapoTranspiration(int Layer, int Dt, PIXMET * Met, float NetRad,
   LocalEvap->EInt[Layer] *= F;
   LocalEvap->ETot += LocalEvap->EInt[Layer];
   *Int *= F;
-  VType->MaxInt[Layer] *= F;   
 
   /* calculate the canopy conductances associated with the conditions in 
      each of the soil layers */
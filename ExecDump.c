@@ -26,6 +26,7 @@
 #include "DHSVMerror.h"
 #include "functions.h"
 #include "constants.h"
+#include "profile.h"
 
 /*****************************************************************************
   ExecDump()
@@ -49,27 +50,41 @@ void ExecDump(MAPSIZE * Map, DATE * Current, DATE * Start, OPTIONSTRUCT * Option
   float overlandinflow;          /* Hillslope erosion that enters the channel network */
   float overroadinflow;          /* Road surface erosion that enters the channel network */
   FINEPIX PixAggFineMap;	/* FineMap quanitities aggregated over a pixel */
+  long Pos;			/* Position in a text file before the dump */
+
+  /* dump the aggregated basin values for this timestep.  In an MPI run
+     rank 0 writes the basin output, each rank writes the pixels it owns,
+     and the maps of all ranks are written by rank 0, see GatherWindow() in
+     FileIOBin.c */
+  if (Options->Parallel.Rank == 0) {
+    Pos = PROFILE_TELL(Dump->Aggregate.FilePtr);
+    DumpPix(Current, IsEqualTime(Current, Start), &(Dump->Aggregate),
+	    &(Total->Evap),&(Total->Precip), &(Total->RadClass),
+	    &(Total->Snow), &(Total->Soil), Soil->MaxLayers, Veg->MaxLayers,
+	    Options);
+    fprintf(Dump->Aggregate.FilePtr, " %lu", Total->Saturated);
+    fprintf(Dump->Aggregate.FilePtr, "\n");
+    PROFILE_COUNT_FILE(PROF_BYTESWRITTEN, Dump->Aggregate.FilePtr, Pos);
+  }
 
-  /* dump the aggregated basin values for this timestep */
-  DumpPix(Current, IsEqualTime(Current, Start), &(Dump->Aggregate),
-	  &(Total->Evap),&(Total->Precip), &(Total->RadClass), &(Total->Snow),
-	  &(Total->Soil), Soil->MaxLayers, Veg->MaxLayers, Options);
-  fprintf(Dump->Aggregate.FilePtr, " %lu", Total->Saturated);
-  fprintf(Dump->Aggregate.FilePtr, "\n");
-
-  if (Options->Sediment)
-  DumpPixSed(Current, IsEqualTime(Current, Start), &(Dump->AggregateSediment),
-          &(Total->Sediment), &(Total->Road), Total->SedimentOverlandInflow, 
-          Total->SedimentOverroadInflow, &(Total->Fine) );
+  if (Options->Sediment && Options->Parallel.Rank == 0) {
+    Pos = PROFILE_TELL(Dump->AggregateSediment.FilePtr);
+    DumpPixSed(Current, IsEqualTime(Current, Start),
+	       &(Dump->AggregateSediment), &(Total->Sediment), &(Total->Road),
+	       Total->SedimentOverlandInflow, Total->SedimentOverroadInflow,
+	       &(Total->Fine));
+    PROFILE_COUNT_FILE(PROF_BYTESWRITTEN, Dump->AggregateSediment.FilePtr,
+		       Pos);
+  }
 
-  if (Options->Extent != POINT) {
+  if (Options->Extent == BASIN) {
     /* check whether the model state needs to be dumped at this timestep, and
        dump state if needed */
     if (Dump->NStates < 0) {
       StoreModelState(Dump->Path, Current, Map, Options, TopoMap, PrecipMap,
 		      SnowMap, MetMap, RadMap, VegMap, Veg, SoilMap, Soil,
 		      Network, HydrographInfo, Hydrograph, ChannelData);
-      if (Options->HasNetwork)
+      if (Options->HasNetwork && Options->Parallel.Rank == 0)
 	StoreChannelState(Dump->Path, Current, ChannelData->streams);
     }
     else {
@@ -79,7 +94,7 @@ void ExecDump(MAPSIZE * Map, DATE * Current, DATE * Start, OPTIONSTRUCT * Option
 			  PrecipMap, SnowMap, MetMap, RadMap, VegMap, Veg,
 			  SoilMap, Soil, Network, HydrographInfo, Hydrograph,
 			  ChannelData);
-	  if (Options->HasNetwork)
+	  if (Options->HasNetwork && Options->Parallel.Rank == 0)
 	    StoreChannelState(Dump->Path, Current, ChannelData->streams);
 	}
 	  }
@@ -144,16 +159,22 @@ void ExecDump(MAPSIZE * Map, DATE * Current, DATE * Start, OPTIONSTRUCT * Option
       else overroadinflow = -999.;
       
       /* output sediment-related variable at the pixel */
-      if ( Options->Sediment) 
+      if ( Options->Sediment) {
+        Pos = PROFILE_TELL(Dump->Pix[i].OutFileSediment.FilePtr);
         DumpPixSed(Current, IsEqualTime(Current, Start), &(Dump->Pix[i].OutFileSediment),
               &(SedMap[y][x]), &(Network[y][x]), overlandinflow, overroadinflow, &PixAggFineMap);
+        PROFILE_COUNT_FILE(PROF_BYTESWRITTEN,
+			   Dump->Pix[i].OutFileSediment.FilePtr, Pos);
+      }
 
       /* output variable at the pixel */
+      Pos = PROFILE_TELL(Dump->Pix[i].OutFile.FilePtr);
       DumpPix(Current, IsEqualTime(Current, Start), &(Dump->Pix[i].OutFile),
               &(EvapMap[y][x]), &(PrecipMap[y][x]),&(RadMap[y][x]), &(SnowMap[y][x]),
               &(SoilMap[y][x]), Soil->NLayers[(SoilMap[y][x].Soil - 1)],
               Veg->NLayers[(VegMap[y][x].Veg - 1)], Options);
       fprintf(Dump->Pix[i].OutFile.FilePtr, "\n");
+      PROFILE_COUNT_FILE(PROF_BYTESWRITTEN, Dump->Pix[i].OutFile.FilePtr, Pos);
     }
 
     /* check which maps need to be dumped at this timestep, and dump maps if needed */
@@ -194,7 +215,8 @@ void DumpMap(MAPSIZE * Map, DATE * Current, MAPDUMP * DMap, TOPOPIX ** TopoMap,
   int y;			/* counter */
   int ii, jj, yy, xx; 		/* counters for FineMap variables */
   void *Array;
-  int numPoints;
+  size_t numPoints;		/* Pixels in the map, more than 2^31 for a
+				   large mass wasting map */
   char VarIDStr[4];		/* stores VarID for sending to ReportError */
 
   sprintf(DataLabel, "%02d.%02d.%04d.%02d.%02d.%02d", Current->Month,
@@ -210,10 +232,11 @@ void DumpMap(MAPSIZE * Map, DATE * Current, MAPDUMP * DMap, TOPOPIX ** TopoMap,
   sprintf(VarIDStr, "%d", DMap->ID);
 
   if(DMap->ID >= 800 && DMap->ID < 900) {
-    numPoints = Map->NX * Map->NY * Map->DX * Map->DY / (Map->DMASS*Map->DMASS);
+    numPoints = (size_t) (int) (Map->NY * Map->DY / Map->DMASS) *
+      (int) (Map->NX * Map->DX / Map->DMASS);
   }
   else {
-    numPoints = Map->NX * Map->NY;
+    numPoints = (size_t) Map->NX * Map->NY;
   }
 
   switch (DMap->NumberType) {
@@ -257,14 +280,14 @@ void DumpMap(MAPSIZE * Map, DATE * Current, MAPDUMP * DMap, TOPOPIX ** TopoMap,
     if (DMap->Resolution == MAP_OUTPUT) {
       for (y = 0; y < Map->NY; y++)
 	for (x = 0; x < Map->NX; x++)
-	  ((float *) Array)[y * Map->NX + x] = EvapMap[y][x].ETot;
+	  ((float *) Array)[(size_t) y * Map->NX + x] = EvapMap[y][x].ETot;
       Write2DMatrix(DMap->FileName, Array, DMap->NumberType, Map->NY, Map->NX,
 		    DMap, Index);
     }
     else if (DMap->Resolution == IMAGE_OUTPUT) {
       for (y = 0; y < Map->NY; y++)
 	for (x = 0; x < Map->NX; x++)
-	  ((unsigned char *) Array)[y * Map->NX + x] =
+	  ((unsigned char *) Array)[(size_t) y * Map->NX + x] =
 	    (unsigned char) ((EvapMap[y][x].ETot - Offset) / Range * MAXUCHAR);
       Write2DMatrix(DMap->FileName, Array, NC_BYTE, Map->NY, Map->NX, DMap,
 		    Index);
@@ -281,17 +304,17 @@ void DumpMap(MAPSIZE * Map, DATE * Current, MAPDUMP * DMap, TOPOPIX ** TopoMap,
 	    NVeg = Veg->NLayers[(VegMap[y][x].Veg - 1)];
 	    if (DMap->Layer > Veg->MaxLayers)
 	      /* soil */
-	      ((float *) Array)[y * Map->NX + x] = EvapMap[y][x].EPot[NVeg];
+	      ((float *) Array)[(size_t) y * Map->NX + x] = EvapMap[y][x].EPot[NVeg];
 	    else if (DMap->Layer <= NVeg)
 	      /* vegetation layer */
-	      ((float *) Array)[y * Map->NX + x] =
+	      ((float *) Array)[(size_t) y * Map->NX + x] =
 		EvapMap[y][x].EPot[DMap->Layer - 1];
 	    else
 	      /* vegetation layer not present at this pixel */
-	      ((float *) Array)[y * Map->NX + x] = NA;
+	      ((float *) Array)[(size_t) y * Map->NX + x] = NA;
 	  }
 	  else
-	    ((float *) Array)[y * Map->NX + x] = NA;
+	    ((float *) Array)[(size_t) y * Map->NX + x] = NA;
 	}
       }
       Write2DMatrix(DMap->FileName, Array, DMap->NumberType, Map->NY, Map->NX,
@@ -303,18 +326,18 @@ void DumpMap(MAPSIZE * Map, DATE * Current, MAPDUMP * DMap, TOPOPIX ** TopoMap,
 	  if (INBASIN(TopoMap[y][x].Mask)) {
 	    NVeg = Veg->NLayers[(VegMap[y][x].Veg - 1)];
 	    if (DMap->Layer > Veg->MaxLayers)
-	      ((unsigned char *) Array)[y * Map->NX + x] =
+	      ((unsigned char *) Array)[(size_t) y * Map->NX + x] =
 		(unsigned char) ((EvapMap[y][x].EPot[NVeg] - Offset) /
 				 Range * MAXUCHAR);
 	    else if (DMap->Layer <= NVeg)
-	      ((unsigned char *) Array)[y * Map->NX + x] =
+	      ((unsigned char *) Array)[(size_t) y * Map->NX + x] =
 		(unsigned char) ((EvapMap[y][x].EPot[DMap->Layer - 1] - Offset)
 				 / Range * MAXUCHAR);
 	    else
-	      ((unsigned char *) Array)[y * Map->NX + x] = 0;
+	      ((unsigned char *) Array)[(size_t) y * Map->NX + x] = 0;
 	  }
 	  else
-	    ((float *) Array)[y * Map->NX + x] = 0;
+	    ((float *) Array)[(size_t) y * Map->NX + x] = 0;
 	}
       }
       Write2DMatrix(DMap->FileName, Array, NC_BYTE, Map->NY, Map->NX, DMap,
@@ -331,15 +354,15 @@ void DumpMap(MAPSIZE * Map, DATE * Current, MAPDUMP * DMap, TOPOPIX ** TopoMap,
 	  if (INBASIN(TopoMap[y][x].Mask)) {
 	    NVeg = Veg->NLayers[(VegMap[y][x].Veg - 1)];
 	    if (DMap->Layer > Veg->MaxLayers)
-	      ((float *) Array)[y * Map->NX + x] = EvapMap[y][x].EInt[NVeg];
+	      ((float *) Array)[(size_t) y * Map->NX + x] = EvapMap[y][x].EInt[NVeg];
 	    else if (DMap->Layer <= NVeg)
-	      ((float *) Array)[y * Map->NX + x] =
+	      ((float *) Array)[(size_t) y * Map->NX + x] =
 		EvapMap[y][x].EInt[DMap->Layer - 1];
 	    else
-	      ((float *) Array)[y * Map->NX + x] = NA;
+	      ((float *) Array)[(size_t) y * Map->NX + x] = NA;
 	  }
 	  else
-	    ((float *) Array)[y * Map->NX + x] = NA;
+	    ((float *) Array)[(size_t) y * Map->NX + x] = NA;
 	}
       }
       Write2DMatrix(DMap->FileName, Array, DMap->NumberType, Map->NY, Map->NX,
@@ -351,18 +374,18 @@ void DumpMap(MAPSIZE * Map, DATE * Current, MAPDUMP * DMap, TOPOPIX ** TopoMap,
 	  if (INBASIN(TopoMap[y][x].Mask)) {
 	    NVeg = Veg->NLayers[(VegMap[y][x].Veg - 1)];
 	    if (DMap->Layer > Veg->MaxLayers)
-	      ((unsigned char *) Array)[y * Map->NX + x] =
+	      ((unsigned char *) Array)[(size_t) y * Map->NX + x] =
 		(unsigned char) ((EvapMap[y][x].EInt[NVeg] - Offset) /
 				 Range * MAXUCHAR);
 	    else if (DMap->Layer <= NVeg)
-	      ((unsigned char *) Array)[y * Map->NX + x] =
+	      ((unsigned char *) Array)[(size_t) y * Map->NX + x] =
 		(unsigned char) ((EvapMap[y][x].EInt[DMap->Layer - 1] - Offset)
 				 / Range * MAXUCHAR);
 	    else
-	      ((unsigned char *) Array)[y * Map->NX + x] = 0;
+	      ((unsigned char *) Array)[(size_t) y * Map->NX + x] = 0;
 	  }
 	  else
-	    ((unsigned char *) Array)[y * Map->NX + x] = 0;
+	    ((unsigned char *) Array)[(size_t) y * Map->NX + x] = 0;
 	}
       }
       Write2DMatrix(DMap->FileName, Array, NC_BYTE, Map->NY, Map->NX, DMap,
@@ -381,13 +404,13 @@ void DumpMap(MAPSIZE * Map, DATE * Current, MAPDUMP * DMap, TOPOPIX ** TopoMap,
 	    if (INBASIN(TopoMap[y][x].Mask)) {
 	      NVeg = Veg->NLayers[(VegMap[y][x].Veg - 1)];
 	      if (DMap->Layer <= NVeg)
-		((float *) Array)[y * Map->NX + x] =
+		((float *) Array)[(size_t) y * Map->NX + x] =
 		  EvapMap[y][x].ESoil[DMap->Layer - 1][i];
 	      else
-		((float *) Array)[y * Map->NX + x] = NA;
+		((float *) Array)[(size_t) y * Map->NX + x] = NA;
 	    }
 	    else
-	      ((float *) Array)[y * Map->NX + x] = NA;
+	      ((float *) Array)[(size_t) y * Map->NX + x] = NA;
 	  }
 	}
 	Write2DMatrix(DMap->FileName, Array, DMap->NumberType, Map->NY,
@@ -401,14 +424,14 @@ void DumpMap(MAPSIZE * Map, DATE * Current, MAPDUMP * DMap, TOPOPIX ** TopoMap,
 	    if (INBASIN(TopoMap[y][x].Mask)) {
 	      NVeg = Veg->NLayers[(VegMap[y][x].Veg - 1)];
 	      if (DMap->Layer <= NVeg)
-		((unsigned char *) Array)[y * Map->NX + x] =
+		((unsigned char *) Array)[(size_t) y * Map->NX + x] =
 		  (unsigned char) ((EvapMap[y][x].ESoil[DMap->Layer - 1][i] -
 				    Offset) / Range * MAXUCHAR);
 	      else
-		((unsigned char *) Array)[y * Map->NX + x] = 0;
+		((unsigned char *) Array)[(size_t) y * Map->NX + x] = 0;
 	    }
 	    else
-	      ((unsigned char *) Array)[y * Map->NX + x] = 0;
+	      ((unsigned char *) Array)[(size_t) y * Map->NX + x] = 0;
 	  }
 	}
 	Write2DMatrix(DMap->FileName, Array, NC_BYTE, Map->NY, Map->NX, DMap,
@@ -426,15 +449,15 @@ void DumpMap(MAPSIZE * Map, DATE * Current, MAPDUMP * DMap, TOPOPIX ** TopoMap,
 	  if (INBASIN(TopoMap[y][x].Mask)) {
 	    NVeg = Veg->NLayers[(VegMap[y][x].Veg - 1)];
 	    if (DMap->Layer > Veg->MaxLayers)
-	      ((float *) Array)[y * Map->NX + x] = EvapMap[y][x].EAct[NVeg];
+	      ((float *) Array)[(size_t) y * Map->NX + x] = EvapMap[y][x].EAct[NVeg];
 	    else if (DMap->Layer <= NVeg)
-	      ((float *) Array)[y * Map->NX + x] =
+	      ((float *) Array)[(size_t) y * Map->NX + x] =
 		EvapMap[y][x].EAct[DMap->Layer - 1];
 	    else
-	      ((float *) Array)[y * Map->NX + x] = NA;
+	      ((float *) Array)[(size_t) y * Map->NX + x] = NA;
 	  }
 	  else
-	    ((float *) Array)[y * Map->NX + x] = NA;
+	    ((float *) Array)[(size_t) y * Map->NX + x] = NA;
 	}
       }
       Write2DMatrix(DMap->FileName, Array, DMap->NumberType, Map->NY, Map->NX,
@@ -446,18 +469,18 @@ void DumpMap(MAPSIZE * Map, DATE * Current, MAPDUMP * DMap, TOPOPIX ** TopoMap,
 	  if (INBASIN(TopoMap[y][x].Mask)) {
 	    NVeg = Veg->NLayers[(VegMap[y][x].Veg - 1)];
 	    if (DMap->Layer > NVeg)
-	      ((unsigned char *) Array)[y * Map->NX + x] =
+	      ((unsigned char *) Array)[(size_t) y * Map->NX + x] =
 		(unsigned char) ((EvapMap[y][x].EAct[NVeg] - Offset) /
 				 Range * MAXUCHAR);
 	    else if (DMap->Layer <= NVeg)
-	      ((unsigned char *) Array)[y * Map->NX + x] =
+	      ((unsigned char *) Array)[(size_t) y * Map->NX + x] =
 		(unsigned char) ((EvapMap[y][x].EAct[DMap->Layer - 1] - Offset)
 				 / Range * MAXUCHAR);
 	    else
-	      ((unsigned char *) Array)[y * Map->NX + x] = 0;
+	      ((unsigned char *) Array)[(size_t) y * Map->NX + x] = 0;
 	  }
 	  else
-	    ((unsigned char *) Array)[y * Map->NX + x] = 0;
+	    ((unsigned char *) Array)[(size_t) y * Map->NX + x] = 0;
 	}
       }
       Write2DMatrix(DMap->FileName, Array, NC_BYTE, Map->NY, Map->NX, DMap,
@@ -471,14 +494,14 @@ void DumpMap(MAPSIZE * Map, DATE * Current, MAPDUMP * DMap, TOPOPIX ** TopoMap,
     if (DMap->Resolution == MAP_OUTPUT) {
       for (y = 0; y < Map->NY; y++)
 	for (x = 0; x < Map->NX; x++)
-	  ((float *) Array)[y * Map->NX + x] = PrecipMap[y][x].Precip;
+	  ((float *) Array)[(size_t) y * Map->NX + x] = PrecipMap[y][x].Precip;
       Write2DMatrix(DMap->FileName, Array, DMap->NumberType, Map->NY, Map->NX,
 		    DMap, Index);
     }
     else if (DMap->Resolution == IMAGE_OUTPUT) {
       for (y = 0; y < Map->NY; y++)
 	for (x = 0; x < Map->NX; x++)
-	  ((unsigned char *) Array)[y * Map->NX + x] =
+	  ((unsigned char *) Array)[(size_t) y * Map->NX + x] =
 	    (unsigned char) ((PrecipMap[y][x].Precip - Offset) /
 			     Range * MAXUCHAR);
       Write2DMatrix(DMap->FileName, Array, NC_BYTE, Map->NY, Map->NX, DMap,
@@ -495,13 +518,13 @@ void DumpMap(MAPSIZE * Map, DATE * Current, MAPDUMP * DMap, TOPOPIX ** TopoMap,
 	  if (INBASIN(TopoMap[y][x].Mask)) {
 	    NVeg = Veg->NLayers[(VegMap[y][x].Veg - 1)];
 	    if (DMap->Layer <= NVeg)
-	      ((float *) Array)[y * Map->NX + x] =
+	      ((float *) Array)[(size_t) y * Map->NX + x] =
 		PrecipMap[y][x].IntRain[DMap->Layer - 1];
 	    else
-	      ((float *) Array)[y * Map->NX + x] = NA;
+	      ((float *) Array)[(size_t) y * Map->NX + x] = NA;
 	  }
 	  else
-	    ((float *) Array)[y * Map->NX + x] = NA;
+	    ((float *) Array)[(size_t) y * Map->NX + x] = NA;
 	}
       }
       Write2DMatrix(DMap->FileName, Array, DMap->NumberType, Map->NY, Map->NX,
@@ -513,14 +536,14 @@ void DumpMap(MAPSIZE * Map, DATE * Current, MAPDUMP * DMap, TOPOPIX ** TopoMap,
 	  if (INBASIN(TopoMap[y][x].Mask)) {
 	    NVeg = Veg->NLayers[(VegMap[y][x].Veg - 1)];
 	    if (DMap->Layer <= NVeg)
-	      ((unsigned char *) Array)[y * Map->NX + x] =
+	      ((unsigned char *) Array)[(size_t) y * Map->NX + x] =
 		(unsigned char) ((PrecipMap[y][x].IntRain[DMap->Layer - 1] -
 				  Offset) / Range * MAXUCHAR);
 	    else
-	      ((unsigned char *) Array)[y * Map->NX + x] = 0;
+	      ((unsigned char *) Array)[(size_t) y * Map->NX + x] = 0;
 	  }
 	  else
-	    ((unsigned char *) Array)[y * Map->NX + x] = 0;
+	    ((unsigned char *) Array)[(size_t) y * Map->NX + x] = 0;
 	}
       }
       Write2DMatrix(DMap->FileName, Array, NC_BYTE, Map->NY, Map->NX, DMap,
@@ -537,13 +560,13 @@ void DumpMap(MAPSIZE * Map, DATE * Current, MAPDUMP * DMap, TOPOPIX ** TopoMap,
 	  if (INBASIN(TopoMap[y][x].Mask)) {
 	    NVeg = Veg->NLayers[(VegMap[y][x].Veg - 1)];
 	    if (DMap->Layer <= NVeg)
-	      ((float *) Array)[y * Map->NX + x] =
+	      ((float *) Array)[(size_t) y * Map->NX + x] =
 		PrecipMap[y][x].IntSnow[DMap->Layer - 1];
 	    else
-	      ((float *) Array)[y * Map->NX + x] = NA;
+	      ((float *) Array)[(size_t) y * Map->NX + x] = NA;
 	  }
 	  else
-	    ((float *) Array)[y * Map->NX + x] = NA;
+	    ((float *) Array)[(size_t) y * Map->NX + x] = NA;
 	}
       }
       Write2DMatrix(DMap->FileName, Array, DMap->NumberType, Map->NY, Map->NX,
@@ -555,14 +578,14 @@ void DumpMap(MAPSIZE * Map, DATE * Current, MAPDUMP * DMap, TOPOPIX ** TopoMap,
 	  if (INBASIN(TopoMap[y][x].Mask)) {
 	    NVeg = Veg->NLayers[(VegMap[y][x].Veg - 1)];
 	    if (DMap->Layer <= NVeg)
-	      ((unsigned char *) Array)[y * Map->NX + x] =
+	      ((unsigned char *) Array)[(size_t) y * Map->NX + x] =
 		(unsigned char) ((PrecipMap[y][x].IntSnow[DMap->Layer - 1] -
 				  Offset) / Range * MAXUCHAR);
 	    else
-	      ((unsigned char *) Array)[y * Map->NX + x] = 0;
+	      ((unsigned char *) Array)[(size_t) y * Map->NX + x] = 0;
 	  }
 	  else
-	    ((unsigned char *) Array)[y * Map->NX + x] = 0;
+	    ((unsigned char *) Array)[(size_t) y * Map->NX + x] = 0;
 	}
       }
       Write2DMatrix(DMap->FileName, Array, NC_BYTE, Map->NY, Map->NX, DMap,
@@ -576,14 +599,14 @@ void DumpMap(MAPSIZE * Map, DATE * Current, MAPDUMP * DMap, TOPOPIX ** TopoMap,
     if (DMap->Resolution == MAP_OUTPUT) {
       for (y = 0; y < Map->NY; y++)
 	for (x = 0; x < Map->NX; x++)
-	  ((float *) Array)[y * Map->NX + x] = RadMap[y][x].Beam;
+	  ((float *) Array)[(size_t) y * Map->NX + x] = RadMap[y][x].Beam;
       Write2DMatrix(DMap->FileName, Array, DMap->NumberType, Map->NY, Map->NX,
 		    Index);
     }
     else if (DMap->Resolution == IMAGE_OUTPUT) {
       for (y = 0; y < Map->NY; y++)
 	for (x = 0; x < Map->NX; x++)
-	  ((unsigned char *) Array)[y * Map->NX + x] =
+	  ((unsigned char *) Array)[(size_t) y * Map->NX + x] =
 	    (unsigned char) ((RadMap[y][x].Beam - Offset) / Range * MAXUCHAR);
       Write2DMatrix(DMap->FileName, Array, NC_BYTE, Map->NY, Map->NX, DMap,
 		    Index);
@@ -596,14 +619,14 @@ void DumpMap(MAPSIZE * Map, DATE * Current, MAPDUMP * DMap, TOPOPIX ** TopoMap,
     if (DMap->Resolution == MAP_OUTPUT) {
       for (y = 0; y < Map->NY; y++)
 	for (x = 0; x < Map->NX; x++)
-	  ((float *) Array)[y * Map->NX + x] = RadMap[y][x].Diffuse;
+	  ((float *) Array)[(size_t) y * Map->NX + x] = RadMap[y][x].Diffuse;
       Write2DMatrix(DMap->FileName, Array, DMap->NumberType, Map->NY, Map->NX,
 		    DMap, Index);
     }
     else if (DMap->Resolution == IMAGE_OUTPUT) {
       for (y = 0; y < Map->NY; y++)
 	for (x = 0; x < Map->NX; x++)
-	  ((unsigned char *) Array)[y * Map->NX + x] =
+	  ((unsigned char *) Array)[(size_t) y * Map->NX + x] =
 	    (unsigned char) ((RadMap[y][x].Diffuse - Offset) /
 			     Range * MAXUCHAR);
       Write2DMatrix(DMap->FileName, Array, NC_BYTE, Map->NY, Map->NX, DMap,
@@ -617,14 +640,14 @@ void DumpMap(MAPSIZE * Map, DATE * Current, MAPDUMP * DMap, TOPOPIX ** TopoMap,
     if (DMap->Resolution == MAP_OUTPUT) {
       for (y = 0; y < Map->NY; y++)
 	for (x = 0; x < Map->NX; x++)
-	  ((unsigned char *) Array)[y * Map->NX + x] = SnowMap[y][x].HasSnow;
+	  ((unsigned char *) Array)[(size_t) y * Map->NX + x] = SnowMap[y][x].HasSnow;
       Write2DMatrix(DMap->FileName, Array, DMap->NumberType, Map->NY, Map->NX,
 		    DMap, Index);
     }
     else if (DMap->Resolution == IMAGE_OUTPUT) {
       for (y = 0; y < Map->NY; y++)
 	for (x = 0; x < Map->NX; x++)
-	  ((unsigned char *) Array)[y * Map->NX + x] = SnowMap[y][x].HasSnow;
+	  ((unsigned char *) Array)[(size_t) y * Map->NX + x] = SnowMap[y][x].HasSnow;
       Write2DMatrix(DMap->FileName, Array, NC_BYTE, Map->NY, Map->NX, DMap,
 		    Index);
     }
@@ -636,7 +659,7 @@ void DumpMap(MAPSIZE * Map, DATE * Current, MAPDUMP * DMap, TOPOPIX ** TopoMap,
     if (DMap->Resolution == MAP_OUTPUT) {
       for (y = 0; y < Map->NY; y++)
 	for (x = 0; x < Map->NX; x++)
-	  ((unsigned char *) Array)[y * Map->NX + x] =
+	  ((unsigned char *) Array)[(size_t) y * Map->NX + x] =
 	    SnowMap[y][x].SnowCoverOver;
       Write2DMatrix(DMap->FileName, Array, DMap->NumberType, Map->NY, Map->NX,
 		    DMap, Index);
@@ -644,7 +667,7 @@ void DumpMap(MAPSIZE * Map, DATE * Current, MAPDUMP * DMap, TOPOPIX ** TopoMap,
     else if (DMap->Resolution == IMAGE_OUTPUT) {
       for (y = 0; y < Map->NY; y++)
 	for (x = 0; x < Map->NX; x++)
-	  ((unsigned char *) Array)[y * Map->NX + x] =
+	  ((unsigned char *) Array)[(size_t) y * Map->NX + x] =
 	    SnowMap[y][x].SnowCoverOver;
       Write2DMatrix(DMap->FileName, Array, NC_BYTE, Map->NY, Map->NX, DMap,
 		    Index);
@@ -657,14 +680,14 @@ void DumpMap(MAPSIZE * Map, DATE * Current, MAPDUMP * DMap, TOPOPIX ** TopoMap,
     if (DMap->Resolution == MAP_OUTPUT) {
       for (y = 0; y < Map->NY; y++)
 	for (x = 0; x < Map->NX; x++)
-	  ((unsigned short *) Array)[y * Map->NX + x] = SnowMap[y][x].LastSnow;
+	  ((unsigned short *) Array)[(size_t) y * Map->NX + x] = SnowMap[y][x].LastSnow;
       Write2DMatrix(DMap->FileName, Array, DMap->NumberType, Map->NY, Map->NX,
 		    DMap, Index);
     }
     else if (DMap->Resolution == IMAGE_OUTPUT) {
       for (y = 0; y < Map->NY; y++)
 	for (x = 0; x < Map->NX; x++)
-	  ((unsigned char *) Array)[y * Map->NX + x] =
+	  ((unsigned char *) Array)[(size_t) y * Map->NX + x] =
 	    (unsigned char) (((float) SnowMap[y][x].LastSnow - Offset) / Range
 			     * MAXUCHAR);
       Write2DMatrix(DMap->FileName, Array, NC_BYTE, Map->NY, Map->NX, DMap,
@@ -678,14 +701,14 @@ void DumpMap(MAPSIZE * Map, DATE * Current, MAPDUMP * DMap, TOPOPIX ** TopoMap,
     if (DMap->Resolution == MAP_OUTPUT) {
       for (y = 0; y < Map->NY; y++)
 	for (x = 0; x < Map->NX; x++)
-	  ((float *) Array)[y * Map->NX + x] = SnowMap[y][x].Swq;
+	  ((float *) Array)[(size_t) y * Map->NX + x] = SnowMap[y][x].Swq;
       Write2DMatrix(DMap->FileName, Array, DMap->NumberType, Map->NY, Map->NX,
 		    DMap, Index);
     }
     else if (DMap->Resolution == IMAGE_OUTPUT) {
       for (y = 0; y < Map->NY; y++)
 	for (x = 0; x < Map->NX; x++)
-	  ((unsigned char *) Array)[y * Map->NX + x] =
+	  ((unsigned char *) Array)[(size_t) y * Map->NX + x] =
 	    (unsigned char) ((SnowMap[y][x].Swq - Offset) / Range * MAXUCHAR);
       Write2DMatrix(DMap->FileName, Array, NC_BYTE, Map->NY, Map->NX, DMap,
 		    Index);
@@ -698,14 +721,14 @@ void DumpMap(MAPSIZE * Map, DATE * Current, MAPDUMP * DMap, TOPOPIX ** TopoMap,
     if (DMap->Resolution == MAP_OUTPUT) {
       for (y = 0; y < Map->NY; y++)
 	for (x = 0; x < Map->NX; x++)
-	  ((float *) Array)[y * Map->NX + x] = SnowMap[y][x].Melt;
+	  ((float *) Array)[(size_t) y * Map->NX + x] = SnowMap[y][x].Melt;
       Write2DMatrix(DMap->FileName, Array, DMap->NumberType, Map->NY, Map->NX,
 		    DMap, Index);
     }
     else if (DMap->Resolution == IMAGE_OUTPUT) {
       for (y = 0; y < Map->NY; y++)
 	for (x = 0; x < Map->NX; x++)
-	  ((unsigned char *) Array)[y * Map->NX + x] =
+	  ((unsigned char *) Array)[(size_t) y * Map->NX + x] =
 	    (unsigned char) ((SnowMap[y][x].Melt - Offset) / Range * MAXUCHAR);
       Write2DMatrix(DMap->FileName, Array, NC_BYTE, Map->NY, Map->NX, DMap,
 		    Index);
@@ -718,14 +741,14 @@ void DumpMap(MAPSIZE * Map, DATE * Current, MAPDUMP * DMap, TOPOPIX ** TopoMap,
     if (DMap->Resolution == MAP_OUTPUT) {
       for (y = 0; y < Map->NY; y++)
 	for (x = 0; x < Map->NX; x++)
-	  ((float *) Array)[y * Map->NX + x] = SnowMap[y][x].PackWater;
+	  ((float *) Array)[(size_t) y * Map->NX + x] = SnowMap[y][x].PackWater;
       Write2DMatrix(DMap->FileName, Array, DMap->NumberType, Map->NY, Map->NX,
 		    DMap, Index);
     }
     else if (DMap->Resolution == IMAGE_OUTPUT) {
       for (y = 0; y < Map->NY; y++)
 	for (x = 0; x < Map->NX; x++)
-	  ((unsigned char *) Array)[y * Map->NX + x] =
+	  ((unsigned char *) Array)[(size_t) y * Map->NX + x] =
 	    (unsigned char) ((SnowMap[y][x].PackWater - Offset) /
 			     Range * MAXUCHAR);
       Write2DMatrix(DMap->FileName, Array, NC_BYTE, Map->NY, Map->NX, DMap,
@@ -739,14 +762,14 @@ void DumpMap(MAPSIZE * Map, DATE * Current, MAPDUMP * DMap, TOPOPIX ** TopoMap,
     if (DMap->Resolution == MAP_OUTPUT) {
       for (y = 0; y < Map->NY; y++)
 	for (x = 0; x < Map->NX; x++)
-	  ((float *) Array)[y * Map->NX + x] = SnowMap[y][x].TPack;
+	  ((float *) Array)[(size_t) y * Map->NX + x] = SnowMap[y][x].TPack;
       Write2DMatrix(DMap->FileName, Array, DMap->NumberType, Map->NY, Map->NX,
 		    DMap, Index);
     }
     else if (DMap->Resolution == IMAGE_OUTPUT) {
       for (y = 0; y < Map->NY; y++)
 	for (x = 0; x < Map->NX; x++)
-	  ((unsigned char *) Array)[y * Map->NX + x] =
+	  ((unsigned char *) Array)[(size_t) y * Map->NX + x] =
 	    (unsigned char) ((SnowMap[y][x].TPack - Offset) / Range * MAXUCHAR);
       Write2DMatrix(DMap->FileName, Array, NC_BYTE, Map->NY, Map->NX, DMap,
 		    Index);
@@ -759,14 +782,14 @@ void DumpMap(MAPSIZE * Map, DATE * Current, MAPDUMP * DMap, TOPOPIX ** TopoMap,
     if (DMap->Resolution == MAP_OUTPUT) {
       for (y = 0; y < Map->NY; y++)
 	for (x = 0; x < Map->NX; x++)
-	  ((float *) Array)[y * Map->NX + x] = SnowMap[y][x].SurfWater;
+	  ((float *) Array)[(size_t) y * Map->NX + x] = SnowMap[y][x].SurfWater;
       Write2DMatrix(DMap->FileName, Array, DMap->NumberType, Map->NY, Map->NX,
 		    DMap, Index);
     }
     else if (DMap->Resolution == IMAGE_OUTPUT) {
       for (y = 0; y < Map->NY; y++)
 	for (x = 0; x < Map->NX; x++)
-	  ((unsigned char *) Array)[y * Map->NX + x] =
+	  ((unsigned char *) Array)[(size_t) y * Map->NX + x] =
 	    (unsigned char) ((SnowMap[y][x].SurfWater - Offset) /
 			     Range * MAXUCHAR);
       Write2DMatrix(DMap->FileName, Array, NC_BYTE, Map->NY, Map->NX, DMap,
@@ -780,14 +803,14 @@ void DumpMap(MAPSIZE * Map, DATE * Current, MAPDUMP * DMap, TOPOPIX ** TopoMap,
     if (DMap->Resolution == MAP_OUTPUT) {
       for (y = 0; y < Map->NY; y++)
 	for (x = 0; x < Map->NX; x++)
-	  ((float *) Array)[y * Map->NX + x] = SnowMap[y][x].TSurf;
+	  ((float *) Array)[(size_t) y * Map->NX + x] = SnowMap[y][x].TSurf;
       Write2DMatrix(DMap->FileName, Array, DMap->NumberType, Map->NY, Map->NX,
 		    DMap, Index);
     }
     else if (DMap->Resolution == IMAGE_OUTPUT) {
       for (y = 0; y < Map->NY; y++)
 	for (x = 0; x < Map->NX; x++)
-	  ((unsigned char *) Array)[y * Map->NX + x] =
+	  ((unsigned char *) Array)[(size_t) y * Map->NX + x] =
 	    (unsigned char) ((SnowMap[y][x].TSurf - Offset) / Range * MAXUCHAR);
       Write2DMatrix(DMap->FileName, Array, NC_BYTE, Map->NY, Map->NX, DMap,
 		    Index);
@@ -800,14 +823,14 @@ void DumpMap(MAPSIZE * Map, DATE * Current, MAPDUMP * DMap, TOPOPIX ** TopoMap,
     if (DMap->Resolution == MAP_OUTPUT) {
       for (y = 0; y < Map->NY; y++)
 	for (x = 0; x < Map->NX; x++)
-	  ((float *) Array)[y * Map->NX + x] = SnowMap[y][x].ColdContent;
+	  ((float *) Array)[(size_t) y * Map->NX + x] = SnowMap[y][x].ColdContent;
       Write2DMatrix(DMap->FileName, Array, DMap->NumberType, Map->NY, Map->NX,
 		    DMap, Index);
     }
     else if (DMap->Resolution == IMAGE_OUTPUT) {
       for (y = 0; y < Map->NY; y++)
 	for (x = 0; x < Map->NX; x++)
-	  ((unsigned char *) Array)[y * Map->NX + x] =
+	  ((unsigned char *) Array)[(size_t) y * Map->NX + x] =
 	    (unsigned char) ((SnowMap[y][x].ColdContent - Offset) /
 			     Range * MAXUCHAR);
       Write2DMatrix(DMap->FileName, Array, NC_BYTE, Map->NY, Map->NX, DMap,
@@ -823,14 +846,14 @@ void DumpMap(MAPSIZE * Map, DATE * Current, MAPDUMP * DMap, TOPOPIX ** TopoMap,
 	for (x = 0; x < Map->NX; x++) {
 	  if (INBASIN(TopoMap[y][x].Mask)) {
 	    NSoil = Soil->NLayers[(SoilMap[y][x].Soil - 1)];
-	    if (DMap->Layer <= NSoil)
-	      ((float *) Array)[y * Map->NX + x] =
+	    if (DMap->Layer <= NSoil && SoilMap[y][x].Moist)
+	      ((float *) Array)[(size_t) y * Map->NX + x] =
 		SoilMap[y][x].Moist[DMap->Layer - 1];
 	    else
-	      ((float *) Array)[y * Map->NX + x] = NA;
+	      ((float *) Array)[(size_t) y * Map->NX + x] = NA;
 	  }
 	  else
-	    ((float *) Array)[y * Map->NX + x] = NA;
+	    ((float *) Array)[(size_t) y * Map->NX + x] = NA;
 	}
       }
       Write2DMatrix(DMap->FileName, Array, DMap->NumberType, Map->NY, Map->NX,
@@ -841,15 +864,15 @@ void DumpMap(MAPSIZE * Map, DATE * Current, MAPDUMP * DMap, TOPOPIX ** TopoMap,
 	for (x = 0; x < Map->NX; x++) {
 	  if (INBASIN(TopoMap[y][x].Mask)) {
 	    NSoil = Soil->NLayers[(SoilMap[y][x].Soil - 1)];
-	    if (DMap->Layer <= NSoil)
-	      ((unsigned char *) Array)[y * Map->NX + x] =
+	    if (DMap->Layer <= NSoil && SoilMap[y][x].Moist)
+	      ((unsigned char *) Array)[(size_t) y * Map->NX + x] =
 		(unsigned char) ((SoilMap[y][x].Moist[DMap->Layer - 1] - Offset)
 				 / Range * MAXUCHAR);
 	    else
-	      ((unsigned char *) Array)[y * Map->NX + x] = 0;
+	      ((unsigned char *) Array)[(size_t) y * Map->NX + x] = 0;
 	  }
 	  else
-	    ((unsigned char *) Array)[y * Map->NX + x] = 0;
+	    ((unsigned char *) Array)[(size_t) y * Map->NX + x] = 0;
 	}
       }
       Write2DMatrix(DMap->FileName, Array, NC_BYTE, Map->NY, Map->NX, DMap,
@@ -865,14 +888,14 @@ void DumpMap(MAPSIZE * Map, DATE * Current, MAPDUMP * DMap, TOPOPIX ** TopoMap,
 	for (x = 0; x < Map->NX; x++) {
 	  if (INBASIN(TopoMap[y][x].Mask)) {
 	    NSoil = Soil->NLayers[(SoilMap[y][x].Soil - 1)];
-	    if (DMap->Layer <= NSoil)
-	      ((float *) Array)[y * Map->NX + x] =
+	    if (DMap->Layer <= NSoil && SoilMap[y][x].Perc)
+	      ((float *) Array)[(size_t) y * Map->NX + x] =
 		SoilMap[y][x].Perc[DMap->Layer - 1];
 	    else
-	      ((float *) Array)[y * Map->NX + x] = NA;
+	      ((float *) Array)[(size_t) y * Map->NX + x] = NA;
 	  }
 	  else
-	    ((float *) Array)[y * Map->NX + x] = NA;
+	    ((float *) Array)[(size_t) y * Map->NX + x] = NA;
 	}
       }
       Write2DMatrix(DMap->FileName, Array, DMap->NumberType, Map->NY, Map->NX,
@@ -883,15 +906,15 @@ void DumpMap(MAPSIZE * Map, DATE * Current, MAPDUMP * DMap, TOPOPIX ** TopoMap,
 	for (x = 0; x < Map->NX; x++) {
 	  if (INBASIN(TopoMap[y][x].Mask)) {
 	    NSoil = Soil->NLayers[(SoilMap[y][x].Soil - 1)];
-	    if (DMap->Layer <= NSoil)
-	      ((unsigned char *) Array)[y * Map->NX + x] =
+	    if (DMap->Layer <= NSoil && SoilMap[y][x].Perc)
+	      ((unsigned char *) Array)[(size_t) y * Map->NX + x] =
 		(unsigned char) ((SoilMap[y][x].Perc[DMap->Layer - 1] - Offset)
 				 / Range * MAXUCHAR);
 	    else
-	      ((unsigned char *) Array)[y * Map->NX + x] = 0;
+	      ((unsigned char *) Array)[(size_t) y * Map->NX + x] = 0;
 	  }
 	  else
-	    ((unsigned char *) Array)[y * Map->NX + x] = 0;
+	    ((unsigned char *) Array)[(size_t) y * Map->NX + x] = 0;
 	}
       }
       Write2DMatrix(DMap->FileName, Array, NC_BYTE, Map->NY, Map->NX, DMap,
@@ -905,14 +928,14 @@ void DumpMap(MAPSIZE * Map, DATE * Current, MAPDUMP * DMap, TOPOPIX ** TopoMap,
     if (DMap->Resolution == MAP_OUTPUT) {
       for (y = 0; y < Map->NY; y++)
 	for (x = 0; x < Map->NX; x++)
-	  ((float *) Array)[y * Map->NX + x] = SoilMap[y][x].TableDepth;
+	  ((float *) Array)[(size_t) y * Map->NX + x] = SoilMap[y][x].TableDepth;
       Write2DMatrix(DMap->FileName, Array, DMap->NumberType, Map->NY, Map->NX,
 		    DMap, Index);
     }
     else if (DMap->Resolution == IMAGE_OUTPUT) {
       for (y = 0; y < Map->NY; y++)
 	for (x = 0; x < Map->NX; x++)
-	  ((unsigned char *) Array)[y * Map->NX + x] =
+	  ((unsigned char *) Array)[(size_t) y * Map->NX + x] =
 	    (unsigned char) ((SoilMap[y][x].TableDepth - Offset) /
 			     Range * MAXUCHAR);
       Write2DMatrix(DMap->FileName, Array, NC_BYTE, Map->NY, Map->NX, DMap,
@@ -926,14 +949,14 @@ void DumpMap(MAPSIZE * Map, DATE * Current, MAPDUMP * DMap, TOPOPIX ** TopoMap,
     if (DMap->Resolution == MAP_OUTPUT) {
       for (y = 0; y < Map->NY; y++)
 	for (x = 0; x < Map->NX; x++)
-	  ((float *) Array)[y * Map->NX + x] = SoilMap[y][x].SatFlow;
+	  ((float *) Array)[(size_t) y * Map->NX + x] = SoilMap[y][x].SatFlow;
       Write2DMatrix(DMap->FileName, Array, DMap->NumberType, Map->NY, Map->NX,
 		    DMap, Index);
     }
     else if (DMap->Resolution == IMAGE_OUTPUT) {
       for (y = 0; y < Map->NY; y++)
 	for (x = 0; x < Map->NX; x++)
-	  ((unsigned char *) Array)[y * Map->NX + x] =
+	  ((unsigned char *) Array)[(size_t) y * Map->NX + x] =
 	    (unsigned char) ((SoilMap[y][x].SatFlow - Offset) /
 			     Range * MAXUCHAR);
       Write2DMatrix(DMap->FileName, Array, NC_BYTE, Map->NY, Map->NX, DMap,
@@ -947,14 +970,14 @@ void DumpMap(MAPSIZE * Map, DATE * Current, MAPDUMP * DMap, TOPOPIX ** TopoMap,
     if (DMap->Resolution == MAP_OUTPUT) {
       for (y = 0; y < Map->NY; y++)
 	for (x = 0; x < Map->NX; x++)
-	  ((float *) Array)[y * Map->NX + x] = SoilMap[y][x].TSurf;
+	  ((float *) Array)[(size_t) y * Map->NX + x] = SoilMap[y][x].TSurf;
       Write2DMatrix(DMap->FileName, Array, DMap->NumberType, Map->NY, Map->NX,
 		    DMap, Index);
     }
     else if (DMap->Resolution == IMAGE_OUTPUT) {
       for (y = 0; y < Map->NY; y++)
 	for (x = 0; x < Map->NX; x++)
-	  ((unsigned char *) Array)[y * Map->NX + x] =
+	  ((unsigned char *) Array)[(size_t) y * Map->NX + x] =
 	    (unsigned char) ((SoilMap[y][x].TSurf - Offset) / Range * MAXUCHAR);
       Write2DMatrix(DMap->FileName, Array, NC_BYTE, Map->NY, Map->NX, DMap,
 		    Index);
@@ -967,14 +990,14 @@ void DumpMap(MAPSIZE * Map, DATE * Current, MAPDUMP * DMap, TOPOPIX ** TopoMap,
     if (DMap->Resolution == MAP_OUTPUT) {
       for (y = 0; y < Map->NY; y++)
 	for (x = 0; x < Map->NX; x++)
-	  ((float *) Array)[y * Map->NX + x] = SoilMap[y][x].Qnet;
+	  ((float *) Array)[(size_t) y * Map->NX + x] = SoilMap[y][x].Qnet;
       Write2DMatrix(DMap->FileName, Array, DMap->NumberType, Map->NY, Map->NX,
 		    DMap, Index);
     }
     else if (DMap->Resolution == IMAGE_OUTPUT) {
       for (y = 0; y < Map->NY; y++)
 	for (x = 0; x < Map->NX; x++)
-	  ((unsigned char *) Array)[y * Map->NX + x] =
+	  ((unsigned char *) Array)[(size_t) y * Map->NX + x] =
 	    (unsigned char) ((SoilMap[y][x].Qnet - Offset) / Range * MAXUCHAR);
       Write2DMatrix(DMap->FileName, Array, NC_BYTE, Map->NY, Map->NX, DMap,
 		    Index);
@@ -987,14 +1010,14 @@ void DumpMap(MAPSIZE * Map, DATE * Current, MAPDUMP * DMap, TOPOPIX ** TopoMap,
     if (DMap->Resolution == MAP_OUTPUT) {
       for (y = 0; y < Map->NY; y++)
 	for (x = 0; x < Map->NX; x++)
-	  ((float *) Array)[y * Map->NX + x] = SoilMap[y][x].Qs;
+	  ((float *) Array)[(size_t) y * Map->NX + x] = SoilMap[y][x].Qs;
       Write2DMatrix(DMap->FileName, Array, DMap->NumberType, Map->NY, Map->NX,
 		    DMap, Index);
     }
     else if (DMap->Resolution == IMAGE_OUTPUT) {
       for (y = 0; y < Map->NY; y++)
 	for (x = 0; x < Map->NX; x++)
-	  ((unsigned char *) Array)[y * Map->NX + x] =
+	  ((unsigned char *) Array)[(size_t) y * Map->NX + x] =
 	    (unsigned char) ((SoilMap[y][x].Qs - Offset) / Range * MAXUCHAR);
       Write2DMatrix(DMap->FileName, Array, NC_BYTE, Map->NY, Map->NX, DMap,
 		    Index);
@@ -1007,14 +1030,14 @@ void DumpMap(MAPSIZE * Map, DATE * Current, MAPDUMP * DMap, TOPOPIX ** TopoMap,
     if (DMap->Resolution == MAP_OUTPUT) {
       for (y = 0; y < Map->NY; y++)
 	for (x = 0; x < Map->NX; x++)
-	  ((float *) Array)[y * Map->NX + x] = SoilMap[y][x].Qe;
+	  ((float *) Array)[(size_t) y * Map->NX + x] = SoilMap[y][x].Qe;
       Write2DMatrix(DMap->FileName, Array, DMap->NumberType, Map->NY, Map->NX,
 		    DMap, Index);
     }
     else if (DMap->Resolution == IMAGE_OUTPUT) {
       for (y = 0; y < Map->NY; y++)
 	for (x = 0; x < Map->NX; x++)
-	  ((unsigned char *) Array)[y * Map->NX + x] =
+	  ((unsigned char *) Array)[(size_t) y * Map->NX + x] =
 	    (unsigned char) ((SoilMap[y][x].Qe - Offset) / Range * MAXUCHAR);
       Write2DMatrix(DMap->FileName, Array, NC_BYTE, Map->NY, Map->NX, DMap,
 		    Index);
@@ -1027,14 +1050,14 @@ void DumpMap(MAPSIZE * Map, DATE * Current, MAPDUMP * DMap, TOPOPIX ** TopoMap,
     if (DMap->Resolution == MAP_OUTPUT) {
       for (y = 0; y < Map->NY; y++)
 	for (x = 0; x < Map->NX; x++)
-	  ((float *) Array)[y * Map->NX + x] = SoilMap[y][x].Qg;
+	  ((float *) Array)[(size_t) y * Map->NX + x] = SoilMap[y][x].Qg;
       Write2DMatrix(DMap->FileName, Array, DMap->NumberType, Map->NY, Map->NX,
 		    DMap, Index);
     }
     else if (DMap->Resolution == IMAGE_OUTPUT) {
       for (y = 0; y < Map->NY; y++)
 	for (x = 0; x < Map->NX; x++)
-	  ((unsigned char *) Array)[y * Map->NX + x] =
+	  ((unsigned char *) Array)[(size_t) y * Map->NX + x] =
 	    (unsigned char) ((SoilMap[y][x].Qg - Offset) / Range * MAXUCHAR);
       Write2DMatrix(DMap->FileName, Array, NC_BYTE, Map->NY, Map->NX, DMap,
 		    Index);
@@ -1047,14 +1070,14 @@ void DumpMap(MAPSIZE * Map, DATE * Current, MAPDUMP * DMap, TOPOPIX ** TopoMap,
     if (DMap->Resolution == MAP_OUTPUT) {
       for (y = 0; y < Map->NY; y++)
 	for (x = 0; x < Map->NX; x++)
-	  ((float *) Array)[y * Map->NX + x] = SoilMap[y][x].Qst;
+	  ((float *) Array)[(size_t) y * Map->NX + x] = SoilMap[y][x].Qst;
       Write2DMatrix(DMap->FileName, Array, DMap->NumberType, Map->NY, Map->NX,
 		    DMap, Index);
     }
     else if (DMap->Resolution == IMAGE_OUTPUT) {
       for (y = 0; y < Map->NY; y++)
 	for (x = 0; x < Map->NX; x++)
-	  ((unsigned char *) Array)[y * Map->NX + x] =
+	  ((unsigned char *) Array)[(size_t) y * Map->NX + x] =
 	    (unsigned char) ((SoilMap[y][x].Qst - Offset) / Range * MAXUCHAR);
       Write2DMatrix(DMap->FileName, Array, NC_BYTE, Map->NY, Map->NX, DMap,
 		    Index);
@@ -1067,14 +1090,14 @@ void DumpMap(MAPSIZE * Map, DATE * Current, MAPDUMP * DMap, TOPOPIX ** TopoMap,
     if (DMap->Resolution == MAP_OUTPUT) {
       for (y = 0; y < Map->NY; y++)
 	for (x = 0; x < Map->NX; x++)
-	  ((float *) Array)[y * Map->NX + x] = SoilMap[y][x].IExcess;
+	  ((float *) Array)[(size_t) y * Map->NX + x] = SoilMap[y][x].IExcess;
       Write2DMatrix(DMap->FileName, Array, DMap->NumberType, Map->NY, Map->NX,
 		    DMap, Index);
     }
     else if (DMap->Resolution == IMAGE_OUTPUT) {
       for (y = 0; y < Map->NY; y++)
 	for (x = 0; x < Map->NX; x++)
-	  ((unsigned char *) Array)[y * Map->NX + x] =
+	  ((unsigned char *) Array)[(size_t) y * Map->NX + x] =
 	    (unsigned char) ((SoilMap[y][x].IExcess - Offset) / Range * MAXUCHAR);
       Write2DMatrix(DMap->FileName, Array, NC_BYTE, Map->NY, Map->NX, DMap,
 		    Index);
@@ -1090,14 +1113,14 @@ void DumpMap(MAPSIZE * Map, DATE * Current, MAPDUMP * DMap, TOPOPIX ** TopoMap,
     if (DMap->Resolution == MAP_OUTPUT) {
       for (y = 0; y < Map->NY; y++)
 	for (x = 0; x < Map->NX; x++)
-	  ((float *) Array)[y * Map->NX + x] = SoilMap[y][x].InfiltAcc;
+	  ((float *) Array)[(size_t) y * Map->NX + x] = SoilMap[y][x].InfiltAcc;
       Write2DMatrix(DMap->FileName, Array, DMap->NumberType, Map->NY, Map->NX,
 		    DMap, Index);
     }
     else if (DMap->Resolution == IMAGE_OUTPUT) {
       for (y = 0; y < Map->NY; y++)
 	for (x = 0; x < Map->NX; x++)
-	  ((unsigned char *) Array)[y * Map->NX + x] =
+	  ((unsigned char *) Array)[(size_t) y * Map->NX + x] =
 	    (unsigned char) ((SoilMap[y][x].InfiltAcc - Offset) / Range * MAXUCHAR);
       Write2DMatrix(DMap->FileName, Array, NC_BYTE, Map->NY, Map->NX, DMap,
 		    Index);
@@ -1118,7 +1141,7 @@ void DumpMap(MAPSIZE * Map, DATE * Current, MAPDUMP * DMap, TOPOPIX ** TopoMap,
 	      for (jj=0; jj< Map->DX/Map->DMASS; jj++) {
 		yy = (int) y*Map->DY/Map->DMASS + ii;
 		xx = (int) x*Map->DX/Map->DMASS + jj;
-		((float *) Array)[yy * (int)(Map->NX*Map->DX/Map->DMASS) + xx] = (*FineMap[yy][xx]).Dem;
+		((float *) Array)[(size_t) yy * (int)(Map->NX*Map->DX/Map->DMASS) + xx] = FINEDEM(*FineMap[yy][xx]);
 	      }
 	    }
 	  }
@@ -1127,7 +1150,7 @@ void DumpMap(MAPSIZE * Map, DATE * Current, MAPDUMP * DMap, TOPOPIX ** TopoMap,
 	      for (jj=0; jj< Map->DX/Map->DMASS; jj++) {
 		yy = (int) y*Map->DY/Map->DMASS + ii;
 		xx = (int) x*Map->DX/Map->DMASS + jj;
-		((float *) Array)[yy * (int)(Map->NX*Map->DX/Map->DMASS) + xx] = NA;
+		((float *) Array)[(size_t) yy * (int)(Map->NX*Map->DX/Map->DMASS) + xx] = NA;
 	      }
 	    }
           }
@@ -1144,8 +1167,8 @@ void DumpMap(MAPSIZE * Map, DATE * Current, MAPDUMP * DMap, TOPOPIX ** TopoMap,
 	      for (jj=0; jj< Map->DX/Map->DMASS; jj++) {
 		yy = (int) y*Map->DY/Map->DMASS + ii;
 		xx = (int) x*Map->DX/Map->DMASS + jj;
-		((unsigned char *) Array)[yy * (int)(Map->NX*Map->DX/Map->DMASS) + xx] =
-		  (unsigned char) (((*FineMap[yy][xx]).Dem - Offset) / Range * MAXUCHAR);
+		((unsigned char *) Array)[(size_t) yy * (int)(Map->NX*Map->DX/Map->DMASS) + xx] =
+		  (unsigned char) ((FINEDEM(*FineMap[yy][xx]) - Offset) / Range * MAXUCHAR);
 	      }
 	    }
 	  }
@@ -1154,7 +1177,7 @@ void DumpMap(MAPSIZE * Map, DATE * Current, MAPDUMP * DMap, TOPOPIX ** TopoMap,
 	      for (jj=0; jj< Map->DX/Map->DMASS; jj++) {
 		yy = (int) y*Map->DY/Map->DMASS + ii;
 		xx = (int) x*Map->DX/Map->DMASS + jj;
-		((float *) Array)[yy * (int)(Map->NX*Map->DX/Map->DMASS) + xx] = NA;
+		((float *) Array)[(size_t) yy * (int)(Map->NX*Map->DX/Map->DMASS) + xx] = NA;
 	      }
 	    }
           }
@@ -1179,7 +1202,7 @@ void DumpMap(MAPSIZE * Map, DATE * Current, MAPDUMP * DMap, TOPOPIX ** TopoMap,
 	      for (jj=0; jj< Map->DX/Map->DMASS; jj++) {
 		yy = (int) y*Map->DY/Map->DMASS + ii;
 		xx = (int) x*Map->DX/Map->DMASS + jj;
-		((float *) Array)[yy * (int)(Map->NX*Map->DX/Map->DMASS) + xx] = (*FineMap[yy][xx]).SatThickness;
+		((float *) Array)[(size_t) yy * (int)(Map->NX*Map->DX/Map->DMASS) + xx] = (*FineMap[yy][xx]).SatThickness;
 	      }
 	    }
 	  }
@@ -1188,7 +1211,7 @@ void DumpMap(MAPSIZE * Map, DATE * Current, MAPDUMP * DMap, TOPOPIX ** TopoMap,
 	      for (jj=0; jj< Map->DX/Map->DMASS; jj++) {
 		yy = (int) y*Map->DY/Map->DMASS + ii;
 		xx = (int) x*Map->DX/Map->DMASS + jj;
-		((float *) Array)[yy * (int)(Map->NX*Map->DX/Map->DMASS) + xx] = NA;
+		((float *) Array)[(size_t) yy * (int)(Map->NX*Map->DX/Map->DMASS) + xx] = NA;
 	      }
 	    }
           }
@@ -1205,7 +1228,7 @@ void DumpMap(MAPSIZE * Map, DATE * Current, MAPDUMP * DMap, TOPOPIX ** TopoMap,
 	      for (jj=0; jj< Map->DX/Map->DMASS; jj++) {
 		yy = (int) y*Map->DY/Map->DMASS + ii;
 		xx = (int) x*Map->DX/Map->DMASS + jj;
-		((unsigned char *) Array)[yy * (int)(Map->NX*Map->DX/Map->DMASS) + xx] =
+		((unsigned char *) Array)[(size_t) yy * (int)(Map->NX*Map->DX/Map->DMASS) + xx] =
 		  (unsigned char) (((*FineMap[yy][xx]).SatThickness - Offset) / Range * MAXUCHAR);
 	      }
 	    }
@@ -1215,7 +1238,7 @@ void DumpMap(MAPSIZE * Map, DATE * Current, MAPDUMP * DMap, TOPOPIX ** TopoMap,
 	      for (jj=0; jj< Map->DX/Map->DMASS; jj++) {
 		yy = (int) y*Map->DY/Map->DMASS + ii;
 		xx = (int) x*Map->DX/Map->DMASS + jj;
-		((float *) Array)[yy * (int)(Map->NX*Map->DX/Map->DMASS) + xx] = NA;
+		((float *) Array)[(size_t) yy * (int)(Map->NX*Map->DX/Map->DMASS) + xx] = NA;
 	      }
 	    }
           }
@@ -1240,7 +1263,7 @@ void DumpMap(MAPSIZE * Map, DATE * Current, MAPDUMP * DMap, TOPOPIX ** TopoMap,
 	      for (jj=0; jj< Map->DX/Map->DMASS; jj++) {
 		yy = (int) y*Map->DY/Map->DMASS + ii;
 		xx = (int) x*Map->DX/Map->DMASS + jj;
-		((float *) Array)[yy * (int)(Map->NX*Map->DX/Map->DMASS) + xx] = (*FineMap[yy][xx]).DeltaDepth;
+		((float *) Array)[(size_t) yy * (int)(Map->NX*Map->DX/Map->DMASS) + xx] = (*FineMap[yy][xx]).DeltaDepth;
 	      }
 	    }
 	  }
@@ -1249,7 +1272,7 @@ void DumpMap(MAPSIZE * Map, DATE * Current, MAPDUMP * DMap, TOPOPIX ** TopoMap,
 	      for (jj=0; jj< Map->DX/Map->DMASS; jj++) {
 		yy = (int) y*Map->DY/Map->DMASS + ii;
 		xx = (int) x*Map->DX/Map->DMASS + jj;
-		((float *) Array)[yy * (int)(Map->NX*Map->DX/Map->DMASS) + xx] = NA;
+		((float *) Array)[(size_t) yy * (int)(Map->NX*Map->DX/Map->DMASS) + xx] = NA;
 	      }
 	    }
           }
@@ -1266,7 +1289,7 @@ void DumpMap(MAPSIZE * Map, DATE * Current, MAPDUMP * DMap, TOPOPIX ** TopoMap,
 	      for (jj=0; jj< Map->DX/Map->DMASS; jj++) {
 		yy = (int) y*Map->DY/Map->DMASS + ii;
 		xx = (int) x*Map->DX/Map->DMASS + jj;
-		((unsigned char *) Array)[yy * (int)(Map->NX*Map->DX/Map->DMASS) + xx] =
+		((unsigned char *) Array)[(size_t) yy * (int)(Map->NX*Map->DX/Map->DMASS) + xx] =
 		  (unsigned char) (((*FineMap[yy][xx]).DeltaDepth - Offset) / Range * MAXUCHAR);
 	      }
 	    }
@@ -1276,7 +1299,7 @@ void DumpMap(MAPSIZE * Map, DATE * Current, MAPDUMP * DMap, TOPOPIX ** TopoMap,
 	      for (jj=0; jj< Map->DX/Map->DMASS; jj++) {
 		yy = (int) y*Map->DY/Map->DMASS + ii;
 		xx = (int) x*Map->DX/Map->DMASS + jj;
-		((float *) Array)[yy * (int)(Map->NX*Map->DX/Map->DMASS) + xx] = NA;
+		((float *) Array)[(size_t) yy * (int)(Map->NX*Map->DX/Map->DMASS) + xx] = NA;
 	      }
 	    }
           }
@@ -1301,7 +1324,7 @@ void DumpMap(MAPSIZE * Map, DATE * Current, MAPDUMP * DMap, TOPOPIX ** TopoMap,
 	      for (jj=0; jj< Map->DX/Map->DMASS; jj++) {
 		yy = (int) y*Map->DY/Map->DMASS + ii;
 		xx = (int) x*Map->DX/Map->DMASS + jj;
-		((float *) Array)[yy * (int)(Map->NX*Map->DX/Map->DMASS) + xx] = (*FineMap[yy][xx]).Probability;
+		((float *) Array)[(size_t) yy * (int)(Map->NX*Map->DX/Map->DMASS) + xx] = (*FineMap[yy][xx]).Probability;
 	      }
 	    }
 	  }
@@ -1310,7 +1333,7 @@ void DumpMap(MAPSIZE * Map, DATE * Current, MAPDUMP * DMap, TOPOPIX ** TopoMap,
 	      for (jj=0; jj< Map->DX/Map->DMASS; jj++) {
 		yy = (int) y*Map->DY/Map->DMASS + ii;
 		xx = (int) x*Map->DX/Map->DMASS + jj;
-		((float *) Array)[yy * (int)(Map->NX*Map->DX/Map->DMASS) + xx] = NA;
+		((float *) Array)[(size_t) yy * (int)(Map->NX*Map->DX/Map->DMASS) + xx] = NA;
 	      }
 	    }
           }
@@ -1327,7 +1350,7 @@ void DumpMap(MAPSIZE * Map, DATE * Current, MAPDUMP * DMap, TOPOPIX ** TopoMap,
 	      for (jj=0; jj< Map->DX/Map->DMASS; jj++) {
 		yy = (int) y*Map->DY/Map->DMASS + ii;
 		xx = (int) x*Map->DX/Map->DMASS + jj;
-		((unsigned char *) Array)[yy * (int)(Map->NX*Map->DX/Map->DMASS) + xx] =
+		((unsigned char *) Array)[(size_t) yy * (int)(Map->NX*Map->DX/Map->DMASS) + xx] =
 		  (unsigned char) (((*FineMap[yy][xx]).Probability - Offset) / Range * MAXUCHAR);
 	      }
 	    }
@@ -1337,7 +1360,7 @@ void DumpMap(MAPSIZE * Map, DATE * Current, MAPDUMP * DMap, TOPOPIX ** TopoMap,
 	      for (jj=0; jj< Map->DX/Map->DMASS; jj++) {
 		yy = (int) y*Map->DY/Map->DMASS + ii;
 		xx = (int) x*Map->DX/Map->DMASS + jj;
-		((float *) Array)[yy * (int)(Map->NX*Map->DX/Map->DMASS) + xx] = NA;
+		((float *) Array)[(size_t) yy * (int)(Map->NX*Map->DX/Map->DMASS) + xx] = NA;
 	      }
 	    }
           }
@@ -1362,7 +1385,7 @@ void DumpMap(MAPSIZE * Map, DATE * Current, MAPDUMP * DMap, TOPOPIX ** TopoMap,
 	      for (jj=0; jj< Map->DX/Map->DMASS; jj++) {
 		yy = (int) y*Map->DY/Map->DMASS + ii;
 		xx = (int) x*Map->DX/Map->DMASS + jj;
-		((float *) Array)[yy * (int)(Map->NX*Map->DX/Map->DMASS) + xx] = (*FineMap[yy][xx]).SedimentToChannel;
+		((float *) Array)[(size_t) yy * (int)(Map->NX*Map->DX/Map->DMASS) + xx] = (*FineMap[yy][xx]).SedimentToChannel;
 	      }
 	    }
 	  }
@@ -1371,7 +1394,7 @@ void DumpMap(MAPSIZE * Map, DATE * Current, MAPDUMP * DMap, TOPOPIX ** TopoMap,
 	      for (jj=0; jj< Map->DX/Map->DMASS; jj++) {
 		yy = (int) y*Map->DY/Map->DMASS + ii;
 		xx = (int) x*Map->DX/Map->DMASS + jj;
-		((float *) Array)[yy * (int)(Map->NX*Map->DX/Map->DMASS) + xx] = NA;
+		((float *) Array)[(size_t) yy * (int)(Map->NX*Map->DX/Map->DMASS) + xx] = NA;
 	      }
 	    }
           }
@@ -1388,7 +1411,7 @@ void DumpMap(MAPSIZE * Map, DATE * Current, MAPDUMP * DMap, TOPOPIX ** TopoMap,
 	      for (jj=0; jj< Map->DX/Map->DMASS; jj++) {
 		yy = (int) y*Map->DY/Map->DMASS + ii;
 		xx = (int) x*Map->DX/Map->DMASS + jj;
-		((unsigned char *) Array)[yy * (int)(Map->NX*Map->DX/Map->DMASS) + xx] =
+		((unsigned char *) Array)[(size_t) yy * (int)(Map->NX*Map->DX/Map->DMASS) + xx] =
 		  (unsigned char) (((*FineMap[yy][xx]).SedimentToChannel - Offset) / Range * MAXUCHAR);
 	      }
 	    }
@@ -1398,7 +1421,7 @@ void DumpMap(MAPSIZE * Map, DATE * Current, MAPDUMP * DMap, TOPOPIX ** TopoMap,
 	      for (jj=0; jj< Map->DX/Map->DMASS; jj++) {
 		yy = (int) y*Map->DY/Map->DMASS + ii;
 		xx = (int) x*Map->DX/Map->DMASS + jj;
-		((float *) Array)[yy * (int)(Map->NX*Map->DX/Map->DMASS) + xx] = NA;
+		((float *) Array)[(size_t) yy * (int)(Map->NX*Map->DX/Map->DMASS) + xx] = NA;
 	      }
 	    }
           }
@@ -1418,14 +1441,14 @@ void DumpMap(MAPSIZE * Map, DATE * Current, MAPDUMP * DMap, TOPOPIX ** TopoMap,
     if (DMap->Resolution == MAP_OUTPUT) {
       for (y = 0; y < Map->NY; y++)
 	for (x = 0; x < Map->NX; x++)
-	  ((float *) Array)[y * Map->NX + x] = SedMap[y][x].SedFluxOut;
+	  ((float *) Array)[(size_t) y * Map->NX + x] = SedMap[y][x].SedFluxOut;
       Write2DMatrix(DMap->FileName, Array, DMap->NumberType, Map->NY, Map->NX,
 		    DMap, Index);
     }
     else if (DMap->Resolution == IMAGE_OUTPUT) {
       for (y = 0; y < Map->NY; y++)
 	for (x = 0; x < Map->NX; x++)
-	  ((unsigned char *) Array)[y * Map->NX + x] =
+	  ((unsigned char *) Array)[(size_t) y * Map->NX + x] =
 	    (unsigned char) ((SedMap[y][x].SedFluxOut - Offset) / Range * MAXUCHAR);
       Write2DMatrix(DMap->FileName, Array, NC_BYTE, Map->NY, Map->NX, DMap,
 		    Index);
@@ -1441,14 +1464,14 @@ void DumpMap(MAPSIZE * Map, DATE * Current, MAPDUMP * DMap, TOPOPIX ** TopoMap,
     if (DMap->Resolution == MAP_OUTPUT) {
       for (y = 0; y < Map->NY; y++)
 	for (x = 0; x < Map->NX; x++)
-	  ((float *) Array)[y * Map->NX + x] = SedMap[y][x].Erosion;
+	  ((float *) Array)[(size_t) y * Map->NX + x] = SedMap[y][x].Erosion;
       Write2DMatrix(DMap->FileName, Array, DMap->NumberType, Map->NY, Map->NX,
 		    DMap, Index);
     }
     else if (DMap->Resolution == IMAGE_OUTPUT) {
       for (y = 0; y < Map->NY; y++)
 	for (x = 0; x < Map->NX; x++)
-	  ((unsigned char *) Array)[y * Map->NX + x] =
+	  ((unsigned char *) Array)[(size_t) y * Map->NX + x] =
 	    (unsigned char) ((SedMap[y][x].Erosion - Offset) / Range * MAXUCHAR);
       Write2DMatrix(DMap->FileName, Array, NC_BYTE, Map->NY, Map->NX, DMap,
 		    Index);
@@ -1464,14 +1487,14 @@ void DumpMap(MAPSIZE * Map, DATE * Current, MAPDUMP * DMap, TOPOPIX ** TopoMap,
     if (DMap->Resolution == MAP_OUTPUT) {
       for (y = 0; y < Map->NY; y++)
 	for (x = 0; x < Map->NX; x++)
-	  ((float *) Array)[y * Map->NX + x] = Network[y][x].Erosion;
+	  ((float *) Array)[(size_t) y * Map->NX + x] = Network[y][x].Erosion;
       Write2DMatrix(DMap->FileName, Array, DMap->NumberType, Map->NY, Map->NX,
 		    DMap, Index);
     }
     else if (DMap->Resolution == IMAGE_OUTPUT) {
       for (y = 0; y < Map->NY; y++)
 	for (x = 0; x < Map->NX; x++)
-	  ((unsigned char *) Array)[y * Map->NX + x] =
+	  ((unsigned char *) Array)[(size_t) y * Map->NX + x] =
 	    (unsigned char) ((Network[y][x].Erosion - Offset) / Range * MAXUCHAR);
       Write2DMatrix(DMap->FileName, Array, NC_BYTE, Map->NY, Map->NX, DMap,
 		    Index);
@@ -1577,10 +1600,11 @@ void DumpPix(DATE * Current, int first, FILES * OutFile, EVAPPIX * Evap,
     fprintf(OutFile->FilePtr, " %g", Precip->IntSnow[i]);
 
 
+  /* the soil layers are NULL unless the soil water is simulated */
   for (i = 0; i < NSoil; i++)
-    fprintf(OutFile->FilePtr, " %9.3E ", Soil->Moist[i]);
+    fprintf(OutFile->FilePtr, " %9.3E ", Soil->Moist ? Soil->Moist[i] : NA);
   for (i = 0; i < NSoil; i++)
-    fprintf(OutFile->FilePtr, " %9.3E ", Soil->Perc[i]);
+    fprintf(OutFile->FilePtr, " %9.3E ", Soil->Perc ? Soil->Perc[i] : NA);
   fprintf(OutFile->FilePtr, " %9.2E %9.2E %9.2E %9.2E %9.2E", Soil->TableDepth,
 	  Soil->SatFlow, Soil->Runoff, Soil->DetentionStorage, Soil->IExcess);
   
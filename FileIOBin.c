@@ -13,22 +13,47 @@
  *               Read2DMatrixByteSwapBin()
  *               Write2DMatrixBin()
  *		 Write2DMatrixByteSwapBin()
+ *               GetMapWindow()
+ *               SetMapWindow()
  *               SizeOfNumberType()
  *               byte_swap_long()
  *               byte_swap_short()
- * COMMENTS:
+ * COMMENTS:     File offsets and element counts are 64-bit, so that files
+ *               larger than 2 GB and maps with more than 2^31 pixels can
+ *               be read and written.  In a clipped run the maps of the
+ *               model grid are a window of the map files, see fileio.h.
+ *               In an MPI run rank 0 writes the output maps, with the
+ *               pixels of all ranks
  * $Id: FileIOBin.c,v 1.4 2003/07/01 21:26:14 olivier Exp $     
  */
 
+#define _FILE_OFFSET_BITS 64
+#include <limits.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <sys/types.h>
+#ifdef HAVE_MPI
+#include <mpi.h>
+#endif
 #include "fifobin.h"
 #include "fileio.h"
 #include "sizeofnt.h"
 #include "settings.h"
 #include "DHSVMerror.h"
+#include "profile.h"
+
+static __thread MAPWINDOW Window;	/* window of the model grid, see
+					   fileio.h */
+
+static int InWindow(int NY, int NX);
+static size_t ReadWindow(FILE *InFile, char *FileName, void *Matrix,
+			 size_t ElemSize, int NDataSet);
+static void WriteWindow(FILE *OutFile, char *FileName, void *Matrix,
+			int NumberType, int Swap);
+static void GatherWindow(char *FileName, void *Matrix, int NumberType,
+			 int Swap);
+static void FillOutside(char *Outside, int NumberType, int N, int Swap);
 
 /*****************************************************************************
   Function name: CreateMapFileBin()
@@ -43,12 +68,15 @@
 
   Modifies     : 
 
-  Comments     :
+  Comments     : In an MPI run only rank 0 creates the map files
 *****************************************************************************/
 void CreateMapFileBin(char *FileName, ...)
 {
   FILE *NewFile;
 
+  if (Window.Active && Window.Gather && Window.Gather->Rank != 0)
+    return;
+
   OpenFile(&NewFile, FileName, "w", TRUE);
 }
 
@@ -68,7 +96,7 @@ void CreateMapFileBin(char *FileName, ...)
                  file is number 0, etc.
     Any remaining arguments are not used in straight binary
 
-  Returns      : Number of elements read
+  Returns      : Number of elements read, at most INT_MAX
 
   Modifies     : Matrix
 
@@ -78,9 +106,9 @@ int Read2DMatrixBin(char *FileName, void *Matrix, int NumberType, int NY,
 		    int NX, int NDataSet, ...)
 {
   FILE *InFile;
-  int NElements = 0;		/* number of elements read */
+  size_t NElements = 0;		/* number of elements read */
   size_t ElemSize;
-  unsigned long OffSet;		/* number of bytes to OffSet (is non-zero when
+  off_t OffSet;			/* number of bytes to OffSet (is non-zero when
 				   reading matrices other than the first one
 				   in the file */
 
@@ -88,17 +116,22 @@ int Read2DMatrixBin(char *FileName, void *Matrix, int NumberType, int NY,
 
   ElemSize = SizeOfNumberType(NumberType);
 
-  OffSet = NY * NX * ElemSize * NDataSet;
+  if (InWindow(NY, NX))
+    NElements = ReadWindow(InFile, FileName, Matrix, ElemSize, NDataSet);
+  else {
+    OffSet = (off_t) NY * NX * ElemSize * NDataSet;
 
-  if (fseek(InFile, OffSet, SEEK_SET))
-    ReportError(FileName, 39);
-  NElements = fread(Matrix, ElemSize, NY * NX, InFile);
-  if (NElements != NY * NX)
+    if (fseeko(InFile, OffSet, SEEK_SET))
+      ReportError(FileName, 39);
+    NElements = fread(Matrix, ElemSize, (size_t) NY * NX, InFile);
+  }
+  if (NElements != (size_t) NY * NX)
     ReportError(FileName, 2);
+  PROFILE_COUNT(PROF_BYTESREAD, (double) NElements * ElemSize);
 
   fclose(InFile);
 
-  return NElements;
+  return (int) MIN(NElements, INT_MAX);
 }
 
 /******************************************************************************/
@@ -106,9 +139,9 @@ int Read2DMatrixByteSwapBin(char *FileName, void *Matrix, int NumberType,
 			    int NY, int NX, int NDataSet, ...)
 {
   FILE *InFile;
-  int NElements = 0;		/* number of elements read */
+  size_t NElements = 0;		/* number of elements read */
   size_t ElemSize;
-  unsigned long OffSet;		/* number of bytes to OffSet (is non-zero when
+  off_t OffSet;			/* number of bytes to OffSet (is non-zero when
 				   reading matrices other than the first one
 				   in the file */
 
@@ -116,15 +149,20 @@ int Read2DMatrixByteSwapBin(char *FileName, void *Matrix, int NumberType,
 
   ElemSize = SizeOfNumberType(NumberType);
 
-  OffSet = NY * NX * ElemSize * NDataSet;
+  if (InWindow(NY, NX))
+    NElements = ReadWindow(InFile, FileName, Matrix, ElemSize, NDataSet);
+  else {
+    OffSet = (off_t) NY * NX * ElemSize * NDataSet;
 
-  if (fseek(InFile, OffSet, SEEK_SET)) {
-    ReportError(FileName, 39);
+    if (fseeko(InFile, OffSet, SEEK_SET)) {
+      ReportError(FileName, 39);
+    }
+    NElements = fread(Matrix, ElemSize, (size_t) NY * NX, InFile);
   }
-  NElements = fread(Matrix, ElemSize, NY * NX, InFile);
-  if (NElements != NY * NX) {
+  if (NElements != (size_t) NY * NX) {
     ReportError(FileName, 2);
   }
+  PROFILE_COUNT(PROF_BYTESREAD, (double) NElements * ElemSize);
   fclose(InFile);
 
   if (ElemSize == 4) {
@@ -137,7 +175,7 @@ int Read2DMatrixByteSwapBin(char *FileName, void *Matrix, int NumberType,
     ReportError(FileName, 61);
   }
 
-  return NElements;
+  return (int) MIN(NElements, INT_MAX);
 }
 
 /*****************************************************************************
@@ -154,11 +192,12 @@ int Read2DMatrixByteSwapBin(char *FileName, void *Matrix, int NumberType,
     NY         - Number of rows
     NX         - Number of columns
 
-  Returns      : Number of elements written 
+  Returns      : Number of elements written, at most INT_MAX
 
   Modifies     :
 
-  Comments     :
+  Comments     : In an MPI run all ranks write the maps of the model grid
+                 together, see GatherWindow()
 *****************************************************************************/
 int Write2DMatrixBin(char *FileName, void *Matrix, int NumberType, int NY,
 		     int NX, ...)
@@ -166,15 +205,23 @@ int Write2DMatrixBin(char *FileName, void *Matrix, int NumberType, int NY,
   FILE *OutFile;		/* output file */
   size_t ElemSize = 0;		/* size of number type in bytes */
 
+  if (InWindow(NY, NX) && Window.Gather) {
+    GatherWindow(FileName, Matrix, NumberType, FALSE);
+    return (int) MIN((size_t) NY * NX, INT_MAX);
+  }
+
   OpenFile(&OutFile, FileName, "ab", FALSE);
   ElemSize = SizeOfNumberType(NumberType);
 
-  if (!(fwrite(Matrix, ElemSize, NY * NX, OutFile)))
+  if (InWindow(NY, NX))
+    WriteWindow(OutFile, FileName, Matrix, NumberType, FALSE);
+  else if (!(fwrite(Matrix, ElemSize, (size_t) NY * NX, OutFile)))
     ReportError(FileName, 41);
+  PROFILE_COUNT(PROF_BYTESWRITTEN, (double) NY * NX * ElemSize);
 
   fclose(OutFile);
 
-  return NY * NX;
+  return (int) MIN((size_t) NY * NX, INT_MAX);
 }
 
 /******************************************************************************/
@@ -183,10 +230,9 @@ int Write2DMatrixByteSwapBin(char *FileName, void *Matrix, int NumberType,
 {
   FILE *OutFile;		/* output file */
   size_t ElemSize = 0;		/* size of number type in bytes */
-  int NElements;
-  NElements = NX * NY;
+  size_t NElements;
+  NElements = (size_t) NX * NY;
 
-  OpenFile(&OutFile, FileName, "ab", FALSE);
   ElemSize = SizeOfNumberType(NumberType);
 
   if (ElemSize == 4) {
@@ -199,20 +245,247 @@ int Write2DMatrixByteSwapBin(char *FileName, void *Matrix, int NumberType,
     ReportError(FileName, 61);
   }
 
-  if (!(fwrite(Matrix, ElemSize, NY * NX, OutFile))) {
+  if (InWindow(NY, NX) && Window.Gather) {
+    GatherWindow(FileName, Matrix, NumberType, TRUE);
+    return (int) MIN(NElements, INT_MAX);
+  }
+
+  OpenFile(&OutFile, FileName, "ab", FALSE);
+
+  if (InWindow(NY, NX))
+    WriteWindow(OutFile, FileName, Matrix, NumberType, TRUE);
+  else if (!(fwrite(Matrix, ElemSize, NElements, OutFile))) {
     ReportError(FileName, 41);
   }
+  PROFILE_COUNT(PROF_BYTESWRITTEN, (double) NY * NX * ElemSize);
 
   fclose(OutFile);
 
-  return NY * NX;
+  return (int) MIN(NElements, INT_MAX);
+}
+
+/*****************************************************************************
+  Function name: GetMapWindow()
+
+  Purpose      : Copy the window of the model grid in the map files
+
+  Required     :
+    MAPWINDOW *Copy - Copy of the window
+
+  Returns      : void
+
+  Modifies     : Copy
+*****************************************************************************/
+void GetMapWindow(MAPWINDOW *Copy)
+{
+  *Copy = Window;
+}
+
+/*****************************************************************************
+  Function name: SetMapWindow()
+
+  Purpose      : Set the window of the model grid in the map files
+
+  Required     :
+    MAPWINDOW *Copy - Window of the model grid, NULL if the model grid and
+                      the map files have the same size
+
+  Returns      : void
+
+  Modifies     : The window used by the binary IO functions
+
+  Comments     : Once a window is set, matrices with the size of the model
+                 grid are read from and written to the window of matrices
+                 with the size of the files.  Cells of the files outside the
+                 window are written as NA, bytes as 0.  Matrices of any
+                 other size are read and written as a whole.  If the window
+                 has a Gather, the cells of the files that no rank
+                 simulates are written as NA as well.
+*****************************************************************************/
+void SetMapWindow(MAPWINDOW *Copy)
+{
+  if (Copy)
+    Window = *Copy;
+  else
+    Window.Active = FALSE;
+}
+
+/*****************************************************************************
+  InWindow() - TRUE if a matrix of NY by NX is a window of the map files
+*****************************************************************************/
+static int InWindow(int NY, int NX)
+{
+  return Window.Active && NY == Window.ModelNY && NX == Window.ModelNX;
+}
+
+/*****************************************************************************
+  ReadWindow() - read the window from matrix NDataSet of a file, row by row.
+  Returns the number of elements read
+*****************************************************************************/
+static size_t ReadWindow(FILE *InFile, char *FileName, void *Matrix,
+			 size_t ElemSize, int NDataSet)
+{
+  size_t NElements = 0;		/* number of elements read */
+  off_t OffSet;			/* offset of a row of the window */
+  int y;			/* counter */
+
+  for (y = 0; y < Window.ModelNY; y++) {
+    OffSet = (((off_t) NDataSet * Window.NY + Window.OffsetY + y) *
+	      Window.NX + Window.OffsetX) * ElemSize;
+    if (fseeko(InFile, OffSet, SEEK_SET))
+      ReportError(FileName, 39);
+    NElements += fread((char *) Matrix + (size_t) y * Window.ModelNX *
+		       ElemSize, ElemSize, (size_t) Window.ModelNX, InFile);
+  }
+
+  return NElements;
+}
+
+/*****************************************************************************
+  WriteWindow() - append a matrix with the size of the files, with the
+  window set to Matrix.  The cells outside the window are NA, as the cells
+  outside the basin in the model state, and 0 for bytes.  If Swap is TRUE
+  Matrix is already byte swapped and the NA cells are swapped as well
+*****************************************************************************/
+static void WriteWindow(FILE *OutFile, char *FileName, void *Matrix,
+			int NumberType, int Swap)
+{
+  char *Row;			/* row of the file */
+  char *Outside;		/* row of the file outside the window */
+  size_t ElemSize;		/* size of number type in bytes */
+  size_t RowSize;		/* bytes in a row of the file */
+  size_t WindowSize;		/* bytes in a row of the window */
+  int y;			/* counter */
+
+  ElemSize = SizeOfNumberType(NumberType);
+  RowSize = (size_t) Window.NX * ElemSize;
+  WindowSize = (size_t) Window.ModelNX * ElemSize;
+  if (!(Row = (char *) calloc(Window.NX, ElemSize)) ||
+      !(Outside = (char *) calloc(Window.NX, ElemSize)))
+    ReportError(FileName, 1);
+
+  FillOutside(Outside, NumberType, Window.NX, Swap);
+  memcpy(Row, Outside, RowSize);
+
+  for (y = 0; y < Window.NY; y++) {
+    if (y >= Window.OffsetY && y < Window.OffsetY + Window.ModelNY) {
+      memcpy(Row + Window.OffsetX * ElemSize, (char *) Matrix +
+	     (size_t) (y - Window.OffsetY) * WindowSize, WindowSize);
+      if (fwrite(Row, 1, RowSize, OutFile) != RowSize)
+	ReportError(FileName, 41);
+    }
+    else if (fwrite(Outside, 1, RowSize, OutFile) != RowSize)
+      ReportError(FileName, 41);
+  }
+
+  free(Row);
+  free(Outside);
+}
+
+/*****************************************************************************
+  GatherWindow() - send the pixels of this rank of an MPI run to rank 0,
+  which appends a matrix with the size of the files, with the pixels of all
+  ranks set.  The other cells are NA, and 0 for bytes.  If Swap is TRUE
+  Matrix is already byte swapped and the NA cells are swapped as well.  All
+  ranks call it for the same maps in the same order
+*****************************************************************************/
+static void GatherWindow(char *FileName, void *Matrix, int NumberType,
+			 int Swap)
+{
+#ifdef HAVE_MPI
+  MAPGATHER *Gather = Window.Gather;
+  MPI_Datatype Type;		/* one element */
+  FILE *OutFile;		/* output file */
+  char *Values;			/* pixels of this rank */
+  char *Gathered = NULL;	/* pixels of all ranks */
+  char *Row;			/* row of the file */
+  char *Outside;		/* row of the file outside the basin */
+  size_t ElemSize;		/* size of number type in bytes */
+  size_t RowSize;		/* bytes in a row of the file */
+  long i;			/* counter */
+  long k;			/* counter */
+  int y;			/* counter */
+
+  ElemSize = SizeOfNumberType(NumberType);
+  if (!(Values = (char *) malloc((Gather->NOwned + 1) * ElemSize)))
+    ReportError(FileName, 1);
+  for (i = 0; i < Gather->NOwned; i++)
+    memcpy(Values + i * ElemSize, (char *) Matrix + Gather->Owned[i] *
+	   ElemSize, ElemSize);
+  if (Gather->Rank == 0 &&
+      !(Gathered = (char *) malloc((Gather->NCells + 1) * ElemSize)))
+    ReportError(FileName, 1);
+
+  MPI_Type_contiguous((int) ElemSize, MPI_BYTE, &Type);
+  MPI_Type_commit(&Type);
+  MPI_Gatherv(Values, (int) Gather->NOwned, Type, Gathered, Gather->Counts,
+	      Gather->Displs, Type, 0, MPI_COMM_WORLD);
+  MPI_Type_free(&Type);
+
+  if (Gather->Rank == 0) {
+    RowSize = (size_t) Window.NX * ElemSize;
+    if (!(Row = (char *) calloc(Window.NX, ElemSize)) ||
+	!(Outside = (char *) calloc(Window.NX, ElemSize)))
+      ReportError(FileName, 1);
+    FillOutside(Outside, NumberType, Window.NX, Swap);
+
+    OpenFile(&OutFile, FileName, "ab", FALSE);
+    for (y = 0, k = 0; y < Window.NY; y++) {
+      memcpy(Row, Outside, RowSize);
+      for (; k < Gather->NCells && Gather->Cells[k] / Window.NX == y; k++)
+	memcpy(Row + (Gather->Cells[k] % Window.NX) * ElemSize,
+	       Gathered + Gather->Entries[k] * ElemSize, ElemSize);
+      if (fwrite(Row, 1, RowSize, OutFile) != RowSize)
+	ReportError(FileName, 41);
+    }
+    PROFILE_COUNT(PROF_BYTESWRITTEN, (double) Window.NY * RowSize);
+    fclose(OutFile);
+
+    free(Row);
+    free(Outside);
+    free(Gathered);
+  }
+  free(Values);
+#endif
+}
+
+/*****************************************************************************
+  FillOutside() - set N cells of the number type to NA, or to 0 for bytes,
+  byte swapped if Swap is TRUE
+*****************************************************************************/
+static void FillOutside(char *Outside, int NumberType, int N, int Swap)
+{
+  int x;			/* counter */
+
+  for (x = 0; x < N; x++) {
+    switch (NumberType) {
+    case NC_SHORT:
+      ((short *) Outside)[x] = NA;
+      break;
+    case NC_INT:
+      ((int *) Outside)[x] = NA;
+      break;
+    case NC_FLOAT:
+      ((float *) Outside)[x] = NA;
+      break;
+    case NC_DOUBLE:
+      ((double *) Outside)[x] = NA;
+      break;
+    default:
+      break;
+    }
+  }
+  if (Swap && SizeOfNumberType(NumberType) == 4)
+    byte_swap_long((unsigned int *) Outside, N);
+  else if (Swap && SizeOfNumberType(NumberType) == 2)
+    byte_swap_short((short *) Outside, N);
 }
 
 /******************************************************************************/
-void byte_swap_short(short *buffer, int number_of_swaps)
+void byte_swap_short(short *buffer, size_t number_of_swaps)
 {
   short *temp;
-  int swap_loop;
+  size_t swap_loop;
 
   for (swap_loop = 0, temp = buffer; swap_loop < number_of_swaps;
        swap_loop++, temp++) {
@@ -221,10 +494,10 @@ void byte_swap_short(short *buffer, int number_of_swaps)
 }
 
 /******************************************************************************/
-void byte_swap_long(long *buffer, int number_of_swaps)
+void byte_swap_long(unsigned int *buffer, size_t number_of_swaps)
 {
-  long *temp;
-  int swap_loop;
+  unsigned int *temp;
+  size_t swap_loop;
 
   for (swap_loop = 0, temp = buffer; swap_loop < number_of_swaps;
        swap_loop++, temp++) {
@@ -57,6 +57,7 @@
 #include "settings.h"
 #include "DHSVMerror.h"
 #include "sizeofnt.h"
+#include "profile.h"
 
 static void nc_check_err(const int ncstatus, const int line, const char *file);
 static int GenerateHistory(int argc, char **argv, char *History);
@@ -391,6 +392,8 @@ fit your needs. \n");
     break;
   }
   nc_check_err(ncstatus, __LINE__, __FILE__);
+  PROFILE_COUNT(PROF_BYTESREAD, (double) NY * NX *
+		SizeOfNumberType(NumberType));
 
   /****************************************************************************/
   /*                                CLEAN UP                                  */
@@ -542,6 +545,8 @@ int Write2DMatrixNetCDF(char *FileName, void *Matrix, int NumberType, int NY,
     break;
   }
   nc_check_err(ncstatus, __LINE__, __FILE__);
+  PROFILE_COUNT(PROF_BYTESWRITTEN, (double) NY * NX *
+		SizeOfNumberType(NumberType));
 
   /****************************************************************************/
   /*                                CLEAN UP                                  */
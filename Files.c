@@ -9,6 +9,8 @@
  * DESCRIPTION:  File and I/O functions
  * DESCRIP-END.
  * FUNCTIONS:    OpenFile() 
+ *               SetOutputBuffer()
+ *               GetOutputBuffer()
  *               ScanInts() 
  *               ScanFloats() 
  *               SkipLines()             
@@ -32,6 +34,11 @@
 #include "constants.h"
 #include "fileio.h"
 
+static __thread int OutputBuffer = 0;	/* Buffer of the output files of
+					   the calling thread (bytes), 0
+					   for the default of the C
+					   library */
+
 /*****************************************************************************
   OpenFile()
 *****************************************************************************/
@@ -49,6 +56,29 @@ void OpenFile(FILE ** FilePtr, char *FileName, char *Mode, uchar OverWrite)
   if (!(*FilePtr = fopen(FileName, Mode)))
     ReportError(FileName, 3);
 
+  if (OutputBuffer > 0 && (strstr(Mode, "w") || strstr(Mode, "a")))
+    setvbuf(*FilePtr, NULL, _IOFBF, OutputBuffer);
+}
+
+/*****************************************************************************
+  SetOutputBuffer()
+
+  Set the buffer of the output files opened by OpenFile() from now on
+  (bytes), 0 for the default of the C library
+*****************************************************************************/
+void SetOutputBuffer(int Bytes)
+{
+  OutputBuffer = Bytes;
+}
+
+/*****************************************************************************
+  GetOutputBuffer()
+
+  Buffer of the output files set by SetOutputBuffer() (bytes)
+*****************************************************************************/
+int GetOutputBuffer(void)
+{
+  return OutputBuffer;
 }
 
 /*****************************************************************************
@@ -35,9 +35,23 @@ void GetMetData(OPTIONSTRUCT * Options, TIMESTRUCT * Time, int NSoilLayers,
   if (DEBUG)
     printf("Reading all met data for current timestep\n");
 
-  for (i = 0; i < NStats; i++)
+  for (i = 0; i < NStats; i++) {
     ReadMetRecord(Options, &(Time->Current), NSoilLayers, &(Stat[i].MetFile),
 		  Stat[i].IsWindModelLocation, &(Stat[i].Data));
+    /* a longer adaptive time step uses the average of its base steps */
+    if (Options->Adaptive.Steps > 1)
+      AggregateMetRecord(Options, Time, NSoilLayers, &(Stat[i]));
+    /* forcing set by a program that runs the model through libdhsvm */
+    if (Stat[i].HasForcing) {
+      Stat[i].Data.Tair = Stat[i].Forcing.Tair;
+      Stat[i].Data.Rh = Stat[i].Forcing.Rh;
+      Stat[i].Data.Wind = Stat[i].Forcing.Wind;
+      Stat[i].Data.Sin = Stat[i].Forcing.Sin;
+      Stat[i].Data.Lin = Stat[i].Forcing.Lin;
+      Stat[i].Data.Precip = Stat[i].Forcing.Precip;
+      Stat[i].HasForcing = FALSE;
+    }
+  }
 
   if (Options->PrecipType == RADAR)
     ReadRadarMap(&(Time->Current), &(Time->StartRadar), Time->Dt, Radar,
@@ -18,6 +18,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
 #include "settings.h"
 #include "data.h"
 #include "Calendar.h"
@@ -27,6 +28,7 @@
 #include "getinit.h"
 #include "constants.h"
 #include "rad.h"
+#include "dispatch.h"
 
 /*****************************************************************************
   Function name: InitConstants()
@@ -91,6 +93,25 @@ void InitConstants(LISTPTR Input, OPTIONSTRUCT * Options, MAPSIZE * Map,
     {"OPTIONS", "SHADING DATA PATH", "", ""},
     {"OPTIONS", "SHADING DATA EXTENSION", "", ""},
     {"OPTIONS", "SKYVIEW DATA PATH", "", ""},
+    {"OPTIONS", "THREADS", "", ""},
+    {"OPTIONS", "MODEL COMPONENTS", "", ""},
+    {"OPTIONS", "ENSEMBLE FILE", "", ""},
+    {"OPTIONS", "ENSEMBLE PROCESSES", "", ""},
+    {"OPTIONS", "ENSEMBLE MODE", "", ""},
+    {"OPTIONS", "SERVER SOCKET", "", ""},
+    {"OPTIONS", "CALIBRATION FILE", "", ""},
+    {"OPTIONS", "CALIBRATION PROCESSES", "", ""},
+    {"OPTIONS", "PROFILE", "", ""},
+    {"OPTIONS", "PROFILE STEPS", "", ""},
+    {"OPTIONS", "PROGRESS", "", ""},
+    {"OPTIONS", "PROGRESS INTERVAL", "", ""},
+    {"OPTIONS", "CPU", "", ""},
+    {"OPTIONS", "TILE SIZE", "", ""},
+    {"OPTIONS", "OUTPUT BUFFER", "", ""},
+    {"OPTIONS", "PARAMETER MAPS", "", ""},
+    {"OPTIONS", "FIRST TOUCH", "", ""},
+    {"OPTIONS", "HUGE PAGES", "", ""},
+    {"OPTIONS", "CELL ORDER", "", ""},
     {"AREA", "COORDINATE SYSTEM", "", ""},
     {"AREA", "EXTREME NORTH", "", ""},
     {"AREA", "EXTREME WEST", "", ""},
@@ -102,9 +123,21 @@ void InitConstants(LISTPTR Input, OPTIONSTRUCT * Options, MAPSIZE * Map,
     {"AREA", "GRID SPACING", "", ""},
     {"AREA", "POINT NORTH", "", ""},
     {"AREA", "POINT EAST", "", ""},
+    {"AREA", "POINT FILE", "", ""},
+    {"AREA", "CLIP SEGMENT", "", ""},
+    {"AREA", "CLIP NORTH", "", ""},
+    {"AREA", "CLIP EAST", "", ""},
     {"TIME", "TIME STEP", "", ""},
     {"TIME", "MODEL START", "", ""},
     {"TIME", "MODEL END", "", ""},
+    {"TIME", "SPINUP START", "", ""},
+    {"TIME", "SPINUP END", "", ""},
+    {"TIME", "SPINUP CYCLES", "", ""},
+    {"TIME", "SPINUP TOLERANCE", "", ""},
+    {"TIME", "ADAPTIVE STEPS", "", ""},
+    {"TIME", "ADAPTIVE PRECIPITATION", "", ""},
+    {"TIME", "ADAPTIVE MELT", "", ""},
+    {"TIME", "ADAPTIVE FLOW CHANGE", "", ""},
     {"CONSTANTS", "GROUND ROUGHNESS", "", ""},
     {"CONSTANTS", "SNOW ROUGHNESS", "", ""},
     {"CONSTANTS", "RAIN THRESHOLD", "", ""},
@@ -137,12 +170,17 @@ void InitConstants(LISTPTR Input, OPTIONSTRUCT * Options, MAPSIZE * Map,
   else
     ReportError(StrEnv[format].KeyName, 51);
 
-  /* Determine whether the model should be run in POINT mode or in BASIN mode.
-     If in POINT mode also read which pixel to model */
+  /* Determine whether the model should be run in POINT mode, MULTIPOINT 
+     mode or in BASIN mode.  If in POINT mode also read which pixel to model, 
+     in MULTIPOINT mode the pixels are read from the POINT FILE */
   if (strncmp(StrEnv[extent].VarStr, "POINT", 5) == 0) {
     Options->Extent = POINT;
     Options->HasNetwork = FALSE;
   }
+  else if (strncmp(StrEnv[extent].VarStr, "MULTIPOINT", 10) == 0) {
+    Options->Extent = MULTIPOINT;
+    Options->HasNetwork = FALSE;
+  }
   else if (strncmp(StrEnv[extent].VarStr, "BASIN", 5) == 0) {
     Options->Extent = BASIN;
   }
@@ -150,7 +188,7 @@ void InitConstants(LISTPTR Input, OPTIONSTRUCT * Options, MAPSIZE * Map,
     ReportError(StrEnv[extent].KeyName, 51);
 
   /* Determine how the flow gradient should be calculated */
-  if (Options->Extent != POINT) {
+  if (Options->Extent == BASIN) {
     if (strncmp(StrEnv[gradient].VarStr, "TOPO", 4) == 0)
       Options->FlowGradient = TOPOGRAPHY;
     else if (strncmp(StrEnv[gradient].VarStr, "WATER", 5) == 0)
@@ -182,7 +220,7 @@ void InitConstants(LISTPTR Input, OPTIONSTRUCT * Options, MAPSIZE * Map,
   }
 
   /* Determine whether a road/network is imposed on the model area */
-  if (Options->Extent != POINT) {
+  if (Options->Extent == BASIN) {
     if (strncmp(StrEnv[flow_routing].VarStr, "NETWORK", 7) == 0)
       Options->HasNetwork = TRUE;
     else if (strncmp(StrEnv[flow_routing].VarStr, "UNIT", 4) == 0)
@@ -193,6 +231,112 @@ void InitConstants(LISTPTR Input, OPTIONSTRUCT * Options, MAPSIZE * Map,
   else
     Options->HasNetwork = FALSE;
 
+  /* Determine the number of threads used for the column physics.  Settings
+     that are left out are taken from the tuning file, see tuning.h */
+  if (IsEmptyStr(StrEnv[threads].VarStr))
+    Options->NThreads = 0;
+  else if (!CopyInt(&(Options->NThreads), StrEnv[threads].VarStr, 1) ||
+	   Options->NThreads < 1)
+    ReportError(StrEnv[threads].KeyName, 51);
+  if (IsEmptyStr(StrEnv[tile_size].VarStr))
+    Options->TileSize = 0;
+  else if (!CopyInt(&(Options->TileSize), StrEnv[tile_size].VarStr, 1) ||
+	   Options->TileSize < 1)
+    ReportError(StrEnv[tile_size].KeyName, 51);
+  if (IsEmptyStr(StrEnv[output_buffer].VarStr))
+    Options->OutputBuffer = 0;
+  else if (!CopyInt(&(Options->OutputBuffer), StrEnv[output_buffer].VarStr, 1)
+	   || Options->OutputBuffer < 1)
+    ReportError(StrEnv[output_buffer].KeyName, 51);
+
+  /* Determine whether the routing uses per-pixel parameter maps, see
+     params.h */
+  if (IsEmptyStr(StrEnv[param_maps].VarStr) ||
+      strncmp(StrEnv[param_maps].VarStr, "FALSE", 5) == 0)
+    Options->ParamMaps = FALSE;
+  else if (strncmp(StrEnv[param_maps].VarStr, "TRUE", 4) == 0)
+    Options->ParamMaps = TRUE;
+  else
+    ReportError(StrEnv[param_maps].KeyName, 51);
+
+  /* Determine the placement of the model maps in memory, see placement.h */
+  if (IsEmptyStr(StrEnv[first_touch].VarStr) ||
+      strncmp(StrEnv[first_touch].VarStr, "FALSE", 5) == 0)
+    Options->FirstTouch = FALSE;
+  else if (strncmp(StrEnv[first_touch].VarStr, "TRUE", 4) == 0)
+    Options->FirstTouch = TRUE;
+  else
+    ReportError(StrEnv[first_touch].KeyName, 51);
+  if (IsEmptyStr(StrEnv[huge_pages].VarStr) ||
+      strncmp(StrEnv[huge_pages].VarStr, "NONE", 4) == 0)
+    Options->HugePages = HUGEPAGES_NONE;
+  else if (strncmp(StrEnv[huge_pages].VarStr, "TRANSPARENT", 11) == 0)
+    Options->HugePages = HUGEPAGES_TRANSPARENT;
+  else if (strncmp(StrEnv[huge_pages].VarStr, "EXPLICIT", 8) == 0)
+    Options->HugePages = HUGEPAGES_EXPLICIT;
+  else
+    ReportError(StrEnv[huge_pages].KeyName, 51);
+
+  /* Determine the storage order of the kinematic wave routing, see
+     order.h */
+  if (IsEmptyStr(StrEnv[cell_order].VarStr) ||
+      strncmp(StrEnv[cell_order].VarStr, "ELEVATION", 9) == 0)
+    Options->CellOrder = ORDER_ELEVATION;
+  else if (strncmp(StrEnv[cell_order].VarStr, "TILED", 5) == 0)
+    Options->CellOrder = ORDER_TILED;
+  else if (strncmp(StrEnv[cell_order].VarStr, "MORTON", 6) == 0)
+    Options->CellOrder = ORDER_MORTON;
+  else if (strncmp(StrEnv[cell_order].VarStr, "HILBERT", 7) == 0)
+    Options->CellOrder = ORDER_HILBERT;
+  else
+    ReportError(StrEnv[cell_order].KeyName, 51);
+
+  /* Determine whether the time steps are profiled, see Profile.c */
+  if (IsEmptyStr(StrEnv[profile].VarStr) ||
+      strncmp(StrEnv[profile].VarStr, "FALSE", 5) == 0)
+    Options->Profile = FALSE;
+  else if (strncmp(StrEnv[profile].VarStr, "TRUE", 4) == 0)
+    Options->Profile = TRUE;
+  else
+    ReportError(StrEnv[profile].KeyName, 51);
+  if (IsEmptyStr(StrEnv[profile_steps].VarStr) ||
+      strncmp(StrEnv[profile_steps].VarStr, "FALSE", 5) == 0)
+    Options->ProfileSteps = FALSE;
+  else if (strncmp(StrEnv[profile_steps].VarStr, "TRUE", 4) == 0)
+    Options->ProfileSteps = TRUE;
+  else
+    ReportError(StrEnv[profile_steps].KeyName, 51);
+
+  /* Determine whether the progress file is written, see Progress.c */
+  if (IsEmptyStr(StrEnv[progress].VarStr) ||
+      strncmp(StrEnv[progress].VarStr, "FALSE", 5) == 0)
+    Options->Progress = FALSE;
+  else if (strncmp(StrEnv[progress].VarStr, "TRUE", 4) == 0)
+    Options->Progress = TRUE;
+  else
+    ReportError(StrEnv[progress].KeyName, 51);
+  if (IsEmptyStr(StrEnv[progress_interval].VarStr))
+    Options->ProgressInterval = 0;
+  else if (!CopyInt(&(Options->ProgressInterval),
+		    StrEnv[progress_interval].VarStr, 1) ||
+	   Options->ProgressInterval < 1)
+    ReportError(StrEnv[progress_interval].KeyName, 51);
+
+  /* Determine the instruction set of the vector kernels, see Dispatch.c */
+  if (IsEmptyStr(StrEnv[cpu].VarStr) ||
+      strncmp(StrEnv[cpu].VarStr, "AUTO", 4) == 0)
+    Options->Cpu = CPU_AUTO;
+  else if (strncmp(StrEnv[cpu].VarStr, "SCALAR", 6) == 0)
+    Options->Cpu = CPU_SCALAR;
+  else if (strncmp(StrEnv[cpu].VarStr, "SSE4.2", 6) == 0)
+    Options->Cpu = CPU_SSE42;
+  else if (strncmp(StrEnv[cpu].VarStr, "AVX2", 4) == 0)
+    Options->Cpu = CPU_AVX2;
+  else if (strncmp(StrEnv[cpu].VarStr, "AVX512", 6) == 0)
+    Options->Cpu = CPU_AVX512;
+  else
+    ReportError(StrEnv[cpu].KeyName, 51);
+
   /* Determine whether a sensible heat flux should be calculated */
   if (strncmp(StrEnv[sensible_heat_flux].VarStr, "TRUE", 4) == 0)
     Options->HeatFlux = TRUE;
@@ -220,6 +364,66 @@ void InitConstants(LISTPTR Input, OPTIONSTRUCT * Options, MAPSIZE * Map,
       ReportError(StrEnv[sed_input_file].KeyName, 51);
     strcpy(Options->SedFile, StrEnv[sed_input_file].VarStr);
   }
+
+  /* Determine which model components are simulated.  The SNOW option only
+     calculates the meteorology, the interception and the snow pack, the MET
+     option only the meteorology.  Soil water, routing, channels and sediment
+     are not allocated, initialized or calculated in either case */
+  if (IsEmptyStr(StrEnv[model_components].VarStr) ||
+      strncmp(StrEnv[model_components].VarStr, "FULL", 4) == 0)
+    Options->Components = FULL_MODEL;
+  else if (strncmp(StrEnv[model_components].VarStr, "SNOW", 4) == 0)
+    Options->Components = SNOW_MODEL;
+  else if (strncmp(StrEnv[model_components].VarStr, "MET", 3) == 0)
+    Options->Components = MET_MODEL;
+  else
+    ReportError(StrEnv[model_components].KeyName, 51);
+
+  if (Options->Components != FULL_MODEL) {
+    if (Options->HasNetwork || Options->Sediment) {
+      printf("WARNING: Only the %s components are simulated. Channel\n",
+	     Options->Components == SNOW_MODEL ? "snow" : "meteorology");
+      printf("routing and sediment options are being turned off.\n\n");
+    }
+    Options->HasNetwork = FALSE;
+    Options->RoadRouting = FALSE;
+    Options->Sediment = FALSE;
+    Options->MassWaste = FALSE;
+    Options->SurfaceErosion = FALSE;
+    Options->ErosionPeriod = FALSE;
+  }
+
+  /* Determine whether a scenario ensemble is run, and how many members can
+     run at the same time */
+  Options->Ensemble.Mode = ENSEMBLE_PROCESS;
+  Options->Ensemble.NMembers = 0;
+  Options->Ensemble.Member = -1;
+  Options->Ensemble.Members = NULL;
+  if (!IsEmptyStr(StrEnv[ensemble_file].VarStr)) {
+    InitEnsemble(StrEnv[ensemble_file].VarStr, &(Options->Ensemble));
+    if (IsEmptyStr(StrEnv[ensemble_mode].VarStr) ||
+	strncmp(StrEnv[ensemble_mode].VarStr, "PROCESS", 7) == 0)
+      Options->Ensemble.Mode = ENSEMBLE_PROCESS;
+    else if (strncmp(StrEnv[ensemble_mode].VarStr, "SHARED", 6) == 0) {
+      /* all members run in this process, the state of each member is set up
+	 in turn, starting with the first */
+      Options->Ensemble.Mode = ENSEMBLE_SHARED;
+      Options->Ensemble.Member = 0;
+      if (Options->Sediment || Options->Extent == MULTIPOINT)
+	ReportError("ENSEMBLE MODE = SHARED with the sediment model or "
+		    "EXTENT = MULTIPOINT", 65);
+    }
+    else
+      ReportError(StrEnv[ensemble_mode].KeyName, 51);
+    if (IsEmptyStr(StrEnv[ensemble_processes].VarStr))
+      Options->Ensemble.MaxProcesses = (int) sysconf(_SC_NPROCESSORS_ONLN);
+    else if (!CopyInt(&(Options->Ensemble.MaxProcesses),
+		      StrEnv[ensemble_processes].VarStr, 1) ||
+	     Options->Ensemble.MaxProcesses < 1)
+      ReportError(StrEnv[ensemble_processes].KeyName, 51);
+    if (Options->Ensemble.MaxProcesses < 1)
+      Options->Ensemble.MaxProcesses = 1;
+  }
   
   /* Determine overland flow routing method to use */
   if (strncmp(StrEnv[routing].VarStr, "KINEMATIC", 9) == 0)
@@ -228,6 +432,11 @@ void InitConstants(LISTPTR Input, OPTIONSTRUCT * Options, MAPSIZE * Map,
     Options->Routing = FALSE;
   else
     ReportError(StrEnv[routing].KeyName, 51);
+
+  /* the storage order of the kinematic wave routing has no hillslope
+     sediment routing, see order.h */
+  if (Options->CellOrder != ORDER_ELEVATION && Options->Sediment)
+    ReportError("CELL ORDER with the sediment model", 65);
   
  
   /* Determine if the maximum infiltration rate is static or dynamic */
@@ -438,6 +647,64 @@ void InitConstants(LISTPTR Input, OPTIONSTRUCT * Options, MAPSIZE * Map,
     Options->PointX = 0;
   }
 
+  Options->NPoints = 0;
+  Options->Points = NULL;
+  if (Options->Extent == MULTIPOINT) {
+    if (IsEmptyStr(StrEnv[point_file].VarStr))
+      ReportError(StrEnv[point_file].KeyName, 51);
+    InitMultiPoint(StrEnv[point_file].VarStr, Map, Options);
+  }
+
+  /* Clip the basin to the area upstream of a channel segment or of an outlet
+     cell, see Clip.c */
+  Options->Clip.Active = FALSE;
+  Options->Clip.Segment = -1;
+  Options->Clip.CellY = -1;
+  Options->Clip.CellX = -1;
+  if (!IsEmptyStr(StrEnv[clip_segment].VarStr) ||
+      !IsEmptyStr(StrEnv[clip_north].VarStr)) {
+    if (Options->Extent != BASIN || Options->Components != FULL_MODEL ||
+	!Options->HasNetwork || Options->Sediment)
+      ReportError("CLIP SEGMENT or CLIP NORTH without EXTENT = BASIN, the "
+		  "full model and a channel network, or with the sediment "
+		  "model", 65);
+    if (Options->FlowGradient != TOPOGRAPHY)
+      ReportError("CLIP SEGMENT or CLIP NORTH with FLOW GRADIENT = "
+		  "WATERTABLE", 65);
+    /* the kinematic wave sub-step (FindDT) is the Courant step of the
+       fastest pixel in the basin, so with the pixels outside the subbasin
+       removed the sub-step and with it the flow at the target change */
+    if (Options->Routing)
+      ReportError("CLIP SEGMENT or CLIP NORTH with OVERLAND ROUTING = "
+		  "KINEMATIC", 65);
+    /* the grid is cropped to the subbasin, the inputs that have a grid of
+       their own or that are not read through the binary map window cannot
+       follow it */
+    if (Options->FileFormat == NETCDF || Options->MM5 ||
+	Options->PrecipType == RADAR || Options->Prism)
+      ReportError("CLIP SEGMENT or CLIP NORTH with FORMAT = NETCDF, MM5, "
+		  "RADAR or PRISM", 65);
+    if (Options->Ensemble.Mode == ENSEMBLE_SHARED)
+      ReportError("CLIP SEGMENT or CLIP NORTH with ENSEMBLE MODE = SHARED",
+		  65);
+    if (!IsEmptyStr(StrEnv[clip_segment].VarStr)) {
+      if (!CopyInt(&(Options->Clip.Segment), StrEnv[clip_segment].VarStr, 1)
+	  || Options->Clip.Segment < 0)
+	ReportError(StrEnv[clip_segment].KeyName, 51);
+    }
+    else {
+      if (!CopyDouble(&PointModelY, StrEnv[clip_north].VarStr, 1))
+	ReportError(StrEnv[clip_north].KeyName, 51);
+      if (!CopyDouble(&PointModelX, StrEnv[clip_east].VarStr, 1))
+	ReportError(StrEnv[clip_east].KeyName, 51);
+      Options->Clip.CellY =
+	Round(((Map->Yorig - 0.5 * Map->DY) - PointModelY) / Map->DY);
+      Options->Clip.CellX =
+	Round((PointModelX - (Map->Xorig + 0.5 * Map->DX)) / Map->DX);
+    }
+    Options->Clip.Active = TRUE;
+  }
+
   /**************** Determine model period ****************/
 
   if (!CopyFloat(&(TimeStep), StrEnv[time_step].VarStr, 1))
@@ -450,7 +717,134 @@ void InitConstants(LISTPTR Input, OPTIONSTRUCT * Options, MAPSIZE * Map,
   if (!SScanDate(StrEnv[model_end].VarStr, &(End)))
     ReportError(StrEnv[model_end].KeyName, 51);
 
-  InitTime(Time, &Start, &End, NULL, NULL, (int) TimeStep);
+  /* If a spin-up period is given, the model first cycles through the
+     spin-up period until the model state no longer changes and then
+     continues with the model period.  The model time is set to the
+     spin-up period here and switched in EndSpinupCycle() */
+  Options->Spinup.Active = FALSE;
+  if (!IsEmptyStr(StrEnv[spinup_start].VarStr)) {
+    if (Options->Ensemble.Mode == ENSEMBLE_SHARED)
+      ReportError("ENSEMBLE MODE = SHARED with a spin-up", 65);
+    if (Options->Sediment == TRUE)
+      ReportError(StrEnv[spinup_start].KeyName, 79);
+    if (!SScanDate(StrEnv[spinup_start].VarStr, &(Options->Spinup.Start)))
+      ReportError(StrEnv[spinup_start].KeyName, 51);
+    if (!SScanDate(StrEnv[spinup_end].VarStr, &(Options->Spinup.End)))
+      ReportError(StrEnv[spinup_end].KeyName, 51);
+    if (!CopyInt(&(Options->Spinup.MaxCycles), StrEnv[spinup_cycles].VarStr,
+		 1) || Options->Spinup.MaxCycles < 1)
+      ReportError(StrEnv[spinup_cycles].KeyName, 51);
+    if (!CopyFloat(&(Options->Spinup.Tolerance),
+		   StrEnv[spinup_tolerance].VarStr, 1) ||
+	Options->Spinup.Tolerance <= 0.)
+      ReportError(StrEnv[spinup_tolerance].KeyName, 51);
+    CopyDate(&(Options->Spinup.ModelStart), &Start);
+    CopyDate(&(Options->Spinup.ModelEnd), &End);
+    Options->Spinup.Active = TRUE;
+    Options->Spinup.Cycle = 0;
+    Options->Spinup.Dt = (int) TimeStep;
+    if (!InitTime(Time, &(Options->Spinup.Start), &(Options->Spinup.End),
+		  NULL, NULL, (int) TimeStep))
+      ReportError(StrEnv[spinup_end].KeyName, 51);
+  }
+  else
+    InitTime(Time, &Start, &End, NULL, NULL, (int) TimeStep);
+
+  /* In server mode the model is only run on request, see Server.c */
+  Options->Server.Active = FALSE;
+  if (!IsEmptyStr(StrEnv[server_socket].VarStr)) {
+    if (Options->Ensemble.NMembers > 0 || Options->Spinup.Active)
+      ReportError("SERVER SOCKET with an ensemble or a spin-up", 65);
+    if (Options->MM5 || Options->PrecipType == RADAR)
+      ReportError("SERVER SOCKET with MM5 input or radar precipitation", 65);
+    strcpy(Options->Server.SocketPath, StrEnv[server_socket].VarStr);
+    Options->Server.Active = TRUE;
+  }
+
+  /* In a calibration run each parameter set is evaluated in its own process,
+     see Calibrate.c */
+  Options->Calibration.Active = FALSE;
+  if (!IsEmptyStr(StrEnv[calibration_file].VarStr)) {
+    if (Options->Ensemble.NMembers > 0 || Options->Server.Active ||
+	Options->Sediment)
+      ReportError("CALIBRATION FILE with an ensemble, a forecast server or "
+		  "the sediment model", 65);
+    if (Options->Components != FULL_MODEL || !Options->HasNetwork)
+      ReportError("CALIBRATION FILE without the full model and a channel "
+		  "network", 65);
+    if (IsEmptyStr(StrEnv[calibration_processes].VarStr))
+      Options->Calibration.MaxProcesses = (int) sysconf(_SC_NPROCESSORS_ONLN);
+    else if (!CopyInt(&(Options->Calibration.MaxProcesses),
+		      StrEnv[calibration_processes].VarStr, 1) ||
+	     Options->Calibration.MaxProcesses < 1)
+      ReportError(StrEnv[calibration_processes].KeyName, 51);
+    if (Options->Calibration.MaxProcesses < 1)
+      Options->Calibration.MaxProcesses = 1;
+    InitCalibration(StrEnv[calibration_file].VarStr, &(Options->Calibration));
+  }
+
+  /* With an adaptive time step several base time steps are taken at once
+     when there is no precipitation and the model state changes slowly, see
+     Adaptive.c */
+  Options->Adaptive.Active = FALSE;
+  Options->Adaptive.Steps = 1;
+  Options->Adaptive.Dt = (int) TimeStep;
+  if (!IsEmptyStr(StrEnv[adaptive_steps].VarStr)) {
+    if (!CopyInt(&(Options->Adaptive.MaxSteps),
+		 StrEnv[adaptive_steps].VarStr, 1) ||
+	Options->Adaptive.MaxSteps < 1 ||
+	Options->Adaptive.MaxSteps > MAXADAPTIVESTEPS)
+      ReportError(StrEnv[adaptive_steps].KeyName, 51);
+    Options->Adaptive.PrecipThreshold = 0.;
+    if (!IsEmptyStr(StrEnv[adaptive_precip].VarStr) &&
+	(!CopyFloat(&(Options->Adaptive.PrecipThreshold),
+		    StrEnv[adaptive_precip].VarStr, 1) ||
+	 Options->Adaptive.PrecipThreshold < 0.))
+      ReportError(StrEnv[adaptive_precip].KeyName, 51);
+    Options->Adaptive.MeltThreshold = 0.;
+    if (!IsEmptyStr(StrEnv[adaptive_melt].VarStr) &&
+	(!CopyFloat(&(Options->Adaptive.MeltThreshold),
+		    StrEnv[adaptive_melt].VarStr, 1) ||
+	 Options->Adaptive.MeltThreshold < 0.))
+      ReportError(StrEnv[adaptive_melt].KeyName, 51);
+    Options->Adaptive.FlowThreshold = 0.01;
+    if (!IsEmptyStr(StrEnv[adaptive_flow].VarStr) &&
+	(!CopyFloat(&(Options->Adaptive.FlowThreshold),
+		    StrEnv[adaptive_flow].VarStr, 1) ||
+	 Options->Adaptive.FlowThreshold < 0.))
+      ReportError(StrEnv[adaptive_flow].KeyName, 51);
+    if (Options->MM5 || Options->PrecipType == RADAR || Options->Sediment)
+      ReportError("ADAPTIVE STEPS with MM5 input, radar precipitation or "
+		  "the sediment model", 65);
+    if (Options->Ensemble.Mode == ENSEMBLE_SHARED || Options->Server.Active)
+      ReportError("ADAPTIVE STEPS with a shared ensemble or a forecast "
+		  "server", 65);
+    if (Options->Extent == BASIN && !Options->HasNetwork)
+      ReportError("ADAPTIVE STEPS with a unit hydrograph", 65);
+    Options->Adaptive.LastFlow = -1.;
+    Options->Adaptive.NModelSteps = 0;
+    Options->Adaptive.NBaseSteps = 0;
+    Options->Adaptive.Active = (Options->Adaptive.MaxSteps > 1);
+  }
+
+  /* In an MPI run each rank simulates part of the basin and holds the maps
+     of that part, see Parallel.c.  The division follows the stream network
+     of a full model */
+  if (Options->Parallel.Active) {
+    if (Options->Extent != BASIN || Options->Components != FULL_MODEL ||
+	!Options->HasNetwork)
+      ReportError("MPI run without the full model and a channel network", 65);
+    if (Options->CellOrder != ORDER_ELEVATION)
+      ReportError("MPI run with a CELL ORDER", 65);
+    if (Options->FileFormat == NETCDF || Options->Prism)
+      ReportError("MPI run with NETCDF files or PRISM maps", 65);
+    if (Options->Sediment || Options->RoadRouting)
+      ReportError("MPI run with the sediment model or road routing", 65);
+    if (Options->Ensemble.NMembers > 0 || Options->Server.Active ||
+	Options->Calibration.Active || Options->Adaptive.Active)
+      ReportError("MPI run with an ensemble, a forecast server, a calibration "
+		  "or adaptive steps", 65);
+  }
 
    /**************** Determine model constants ****************/
 
@@ -51,7 +51,9 @@
 
   Modifies     : Members of Dump
 
-  Comments     :
+  Comments     : In an ensemble run with ENSEMBLE MODE = PROCESS this is
+                 called in the parent, for the initial state path, and again
+                 in each member after the fork
 *****************************************************************************/
 void InitDump(LISTPTR Input, OPTIONSTRUCT * Options, MAPSIZE * Map,
 	      int MaxSoilLayers, int MaxVegLayers, int Dt,
@@ -82,8 +84,6 @@ void InitDump(LISTPTR Input, OPTIONSTRUCT * Options, MAPSIZE * Map,
     {NULL, NULL, "", NULL},
   };
 
-  printf("Initializing dump procedures\n");
-
   /* Get the key-entry pairs from the input file */
   for (i = 0; StrEnv[i].SectionName; i++)
     GetInitString(StrEnv[i].SectionName, StrEnv[i].KeyName, StrEnv[i].Default,
@@ -94,6 +94,14 @@ void InitDump(LISTPTR Input, OPTIONSTRUCT * Options, MAPSIZE * Map,
     ReportError(StrEnv[output_path].KeyName, 51);
   strcpy(Dump->Path, StrEnv[output_path].VarStr);
 
+  /* each ensemble member writes to its own subdirectory */
+  InitEnsembleMember(&(Options->Ensemble), Dump->Path);
+
+  /* and so does each MPI rank other than rank 0 */
+  InitParallelRank(&(Options->Parallel), Dump->Path);
+
+  printf("Initializing dump procedures\n");
+
   // delete any previous failure_summary.txt file
   sprintf(sumoutfile, "%sfailure_summary.txt", Dump->Path);
   if (remove(sumoutfile) != -1)
@@ -103,6 +111,14 @@ void InitDump(LISTPTR Input, OPTIONSTRUCT * Options, MAPSIZE * Map,
     strcpy(Dump->InitStatePath, Dump->Path);
   strcpy(Dump->InitStatePath, StrEnv[initial_state_path].VarStr);
 
+  /* the parent of an ensemble run only reads the initial state, the output
+     is opened by the members once they have been forked */
+  if (Options->Ensemble.Mode == ENSEMBLE_PROCESS &&
+      Options->Ensemble.NMembers > 0 && Options->Ensemble.Member < 0) {
+    *NGraphics = 0;
+    return;
+  }
+
   if (IsEmptyStr(StrEnv[npixels].VarStr))
     Dump->NPix = 0;
   else if (!CopyInt(&(Dump->NPix), StrEnv[npixels].VarStr, 1) || Dump->NPix < 0)
@@ -129,9 +145,12 @@ void InitDump(LISTPTR Input, OPTIONSTRUCT * Options, MAPSIZE * Map,
   else if (!CopyInt(NGraphics, StrEnv[ngraphics].VarStr, 1) || *NGraphics < 0)
     ReportError(StrEnv[ngraphics].KeyName, 51);
 
-  if (Options->Extent == POINT)
+  if (Options->Extent != BASIN)
     *NGraphics = 0;
 
+  if (Options->Parallel.Active && *NGraphics > 0)
+    ReportError("MPI run with X11 graphics", 65);
+
   Dump->NMaps = NMapVars + NImageVars;
 
   // Open file for recording aggregated values for entire basin
@@ -148,11 +167,14 @@ void InitDump(LISTPTR Input, OPTIONSTRUCT * Options, MAPSIZE * Map,
     OpenFile(&(Dump->SedBalance.FilePtr), Dump->SedBalance.FileName, "w", TRUE);
   }
 
-  // Open file for recording mass balance for entire basin
-  sprintf(Dump->Balance.FileName, "%sMass.Balance", Dump->Path);
-  OpenFile(&(Dump->Balance.FilePtr), Dump->Balance.FileName, "w", TRUE);
+  // Open file for recording mass balance for entire basin, the water balance
+  // is only closed when the soil water is simulated
+  if (Options->Components == FULL_MODEL) {
+    sprintf(Dump->Balance.FileName, "%sMass.Balance", Dump->Path);
+    OpenFile(&(Dump->Balance.FilePtr), Dump->Balance.FileName, "w", TRUE);
+  }
 
-  if (Options->Extent != POINT) {
+  if (Options->Extent == BASIN) {
 
     /* Read remaining information from dump info file */
 
@@ -200,7 +222,7 @@ void InitDump(LISTPTR Input, OPTIONSTRUCT * Options, MAPSIZE * Map,
       InitGraphicsDump(Input, *NGraphics, &which_graphics);
 
     /* if no network open unit hydrograph file */
-    if (!(Options->HasNetwork)) {
+    if (!(Options->HasNetwork) && Options->Components == FULL_MODEL) {
       sprintf(Dump->Stream.FileName, "%sStream.Flow", Dump->Path);
       OpenFile(&(Dump->Stream.FilePtr), Dump->Stream.FileName, "w", TRUE);
     }
@@ -521,7 +543,8 @@ void InitMapDump(LISTPTR Input, MAPSIZE * Map, int MaxSoilLayers,
 
   Modifies     : NPix and its members
 
-  Comments     :
+  Comments     : In an MPI run each rank writes the pixels it owns, to the
+                 output directory of the run
 *******************************************************************************/
 int InitPixDump(LISTPTR Input, MAPSIZE * Map, uchar ** BasinMask, char *Path,
 		int NPix, PIXDUMP ** Pix, OPTIONSTRUCT *Options)
@@ -542,8 +565,12 @@ int InitPixDump(LISTPTR Input, MAPSIZE * Map, uchar ** BasinMask, char *Path,
   };
   char *SectionName = "OUTPUT";
   char VarStr[name + 1][BUFSIZE + 1];
+  double Found;			/* 1 if a rank of an MPI run owns the pixel */
+  int Owned;			/* TRUE if this rank writes the pixel */
 
   ok = 0;
+  if (Options->Parallel.Active)
+    Path = Options->Parallel.Path;
 
   if (!(*Pix = (PIXDUMP *) calloc(NPix, sizeof(PIXDUMP))))
     ReportError(Routine, 1);
@@ -572,10 +599,19 @@ int InitPixDump(LISTPTR Input, MAPSIZE * Map, uchar ** BasinMask, char *Path,
     (*Pix)[i].Loc.N = Round(((Map->Yorig - 0.5 * Map->DY) - North) / Map->DY);
     (*Pix)[i].Loc.E = Round((East - (Map->Xorig + 0.5 * Map->DX)) / Map->DX);
 
-    if (!InArea(Map, &((*Pix)[i].Loc)) ||
-	!INBASIN(BasinMask[(*Pix)[i].Loc.N][(*Pix)[i].Loc.E])) {
+    Owned = InArea(Map, &((*Pix)[i].Loc)) &&
+      INBASIN(BasinMask[(*Pix)[i].Loc.N][(*Pix)[i].Loc.E]) &&
+      ISOWNED(Options->Parallel, (*Pix)[i].Loc.N, (*Pix)[i].Loc.E);
+    Found = Owned ? 1. : 0.;
+    SumOverRanks(&(Options->Parallel), &Found, 1);
+
+    if (Found == 0.) {
       printf("Ignoring dump command for pixel named %s \n", temp_name);
     }
+    else if (!Owned) {
+      printf("Dump command for pixel named %s is written by another MPI "
+	     "rank\n", temp_name);
+    }
     else {
       printf("Accepting dump command for pixel named %s \n", temp_name);
       sprintf(Str, "%s", temp_name);
@@ -85,6 +85,9 @@ void InitFileIO(int FileFormat)
 
   printf("Initializing file IO\n");
 
+  /* the maps have the size of the model grid until the basin is clipped */
+  SetMapWindow(NULL);
+
   /************************* Binary format **********************/
   if (FileFormat == BIN) {
     strcpy(fileext, ".bin");
@@ -24,6 +24,8 @@
 #include "varid.h"
 #include "sizeofnt.h"
 #include "slopeaspect.h"
+#include "memtrack.h"
+#include "compact.h"
 
 void CalcTopoIndex (MAPSIZE *Map, FINEPIX ***FineMap, TOPOPIX **TopoMap);
 
@@ -38,11 +40,17 @@ void InitFineMaps(LISTPTR Input, OPTIONSTRUCT *Options, MAPSIZE *Map,
   const char *Routine = "InitFineMaps";
   char VarName[BUFSIZE+1];	/* Variable name */
   int i, k, x, y;		/* Counters */
-  int ii, jj, xx, yy, xy;            /* Counters */
+  int ii, jj, xx, yy;            /* Counters */
+  size_t xy;			/* Index in the fine map, which can have
+				   more than 2^31 pixels */
   int NumberType;		/* Number type of data set */
   float *Elev;                   /* Surface elevation */
   int MASKFLAG;
   unsigned char *Mask = NULL;          /* Fine resolution mask */
+  float Min, Max;		/* Range of the elevations, which sets the
+				   scale of their codes with COMPACT_MAPS */
+  float BedMin, BedMax;		/* Range of the bedrock elevations */
+  int First = TRUE;		/* TRUE before the first pixel of the basin */
 
   STRINIENTRY StrEnv[] = {
     {"FINEDEM", "DEM FILE"        , ""  , ""},
@@ -64,8 +72,8 @@ void InitFineMaps(LISTPTR Input, OPTIONSTRUCT *Options, MAPSIZE *Map,
   
   GetVarName(001, 0, VarName);
   GetVarNumberType(001, &NumberType);
-  if (!(Elev = (float *) calloc(Map->NXfine * Map->NYfine, 
-				SizeOfNumberType(NumberType)))) 
+  if (!(Elev = (float *) CallocMap(Map->NYfine, Map->NXfine,
+				   SizeOfNumberType(NumberType)))) 
     ReportError((char *) Routine, 1);
   Read2DMatrix(StrEnv[demfile].VarStr, Elev, NumberType, Map->NYfine, Map->NXfine, 0,
 	       VarName);
@@ -83,8 +91,8 @@ void InitFineMaps(LISTPTR Input, OPTIONSTRUCT *Options, MAPSIZE *Map,
     /* Read the mask */
     GetVarName(002, 0, VarName);
     GetVarNumberType(002, &NumberType);
-    if (!(Mask = (unsigned char *) calloc(Map->NXfine * Map->NYfine,
-					  SizeOfNumberType(NumberType))))
+    if (!(Mask = (unsigned char *) CallocMap(Map->NYfine, Map->NXfine,
+					     SizeOfNumberType(NumberType))))
       ReportError((char *) Routine, 1);
     Read2DMatrix(StrEnv[maskfile].VarStr, Mask, NumberType, Map->NYfine, Map->NXfine, 0,
 		 VarName);
@@ -93,10 +101,13 @@ void InitFineMaps(LISTPTR Input, OPTIONSTRUCT *Options, MAPSIZE *Map,
   }
   
   /* Assign the attributes to the correct map pixel */
-  if (!(*FineMap = (FINEPIX ***) calloc(Map->NYfine, sizeof(FINEPIX **))))
+  if (!(*FineMap = (FINEPIX ***) TrackedCalloc(Map->NYfine, sizeof(FINEPIX **),
+					       MEM_SEDIMENT, "FineMap")))
     ReportError((char *) Routine, 1);
   for (y = 0; y < Map->NYfine; y++) {
-    if (!((*FineMap)[y] = (FINEPIX **) calloc(Map->NXfine, sizeof(FINEPIX *))))
+    if (!((*FineMap)[y] = (FINEPIX **) TrackedCalloc(Map->NXfine,
+						     sizeof(FINEPIX *),
+						     MEM_SEDIMENT, "FineMap")))
       ReportError((char *) Routine, 1);
   }
   // Only allocate a FINEPIX structure for a fine grid cell if that grid cell
@@ -108,7 +119,9 @@ void InitFineMaps(LISTPTR Input, OPTIONSTRUCT *Options, MAPSIZE *Map,
  	  for (jj=0; jj< Map->DX/Map->DMASS; jj++) { 
 	    yy = (int) y*Map->DY/Map->DMASS + ii; 
  	    xx = (int) x*Map->DX/Map->DMASS + jj; 
-            if (!((*FineMap)[yy][xx] = (FINEPIX *) malloc(sizeof(FINEPIX)))) {
+            if (!((*FineMap)[yy][xx] =
+		  (FINEPIX *) TrackedMalloc(sizeof(FINEPIX), MEM_SEDIMENT,
+					    "FineMap"))) {
 	      printf("error allocating FineMap[%d][%d]\n",yy,xx);
               ReportError((char *) Routine, 1);
             }
@@ -118,6 +131,7 @@ void InitFineMaps(LISTPTR Input, OPTIONSTRUCT *Options, MAPSIZE *Map,
     }
   }
   
+  Min = Max = BedMin = BedMax = 0.;
   for (y = 0; y < Map->NY; y++) {
     for (x = 0; x < Map->NX; x++) { 
       if (INBASIN((*TopoMap)[y][x].Mask)) {
@@ -125,15 +139,44 @@ void InitFineMaps(LISTPTR Input, OPTIONSTRUCT *Options, MAPSIZE *Map,
  	  for (jj=0; jj< Map->DX/Map->DMASS; jj++) { 
 	    yy = (int) y*Map->DY/Map->DMASS + ii; 
  	    xx = (int) x*Map->DX/Map->DMASS + jj; 
-	    xy = (int) yy*Map->NXfine + xx;
-	    (*(*FineMap)[yy][xx]).Dem  = Elev[xy]; 
+	    xy = (size_t) yy*Map->NXfine + xx;
+	    if (First || Elev[xy] < Min)
+	      Min = Elev[xy];
+	    if (First || Elev[xy] > Max)
+	      Max = Elev[xy];
+	    if (First || Elev[xy] - SOILDEPTH((*SoilMap)[y][x]) < BedMin)
+	      BedMin = Elev[xy] - SOILDEPTH((*SoilMap)[y][x]);
+	    if (First || Elev[xy] - SOILDEPTH((*SoilMap)[y][x]) > BedMax)
+	      BedMax = Elev[xy] - SOILDEPTH((*SoilMap)[y][x]);
+	    First = FALSE;
+	  }
+	}
+      }
+    }
+  }
+  SetFixedScale(FINEDEM_CODE, "FineMap.Dem", Min, Max);
+  /* the bedrock is set from the decoded surface elevation, which is up to
+     half a code step off */
+  SetFixedScale(BEDROCK_CODE, "FineMap.bedrock",
+		BedMin - FixedScale[FINEDEM_CODE].Scale / 2.,
+		BedMax + FixedScale[FINEDEM_CODE].Scale / 2.);
+
+  for (y = 0; y < Map->NY; y++) {
+    for (x = 0; x < Map->NX; x++) { 
+      if (INBASIN((*TopoMap)[y][x].Mask)) {
+	for (ii=0; ii< Map->DY/Map->DMASS; ii++) { 
+ 	  for (jj=0; jj< Map->DX/Map->DMASS; jj++) { 
+	    yy = (int) y*Map->DY/Map->DMASS + ii; 
+ 	    xx = (int) x*Map->DX/Map->DMASS + jj; 
+	    xy = (size_t) yy*Map->NXfine + xx;
+	    SETFINEDEM(*(*FineMap)[yy][xx], Elev[xy]);
 	  }
 	}
       }
     }
   }
   
-  free(Elev);
+  FreeMap(Elev);
   
   if(MASKFLAG == TRUE){
     for (y = 0; y < Map->NY; y++) {
@@ -143,7 +186,7 @@ void InitFineMaps(LISTPTR Input, OPTIONSTRUCT *Options, MAPSIZE *Map,
 	    for (jj=0; jj< Map->DX/Map->DMASS; jj++) { 
 	      yy = (int) y*Map->DY/Map->DMASS + ii; 
 	      xx = (int) x*Map->DX/Map->DMASS + jj; 
-	      xy = (int) yy*Map->NXfine + xx;
+	      xy = (size_t) yy*Map->NXfine + xx;
 	      (*(*FineMap)[yy][xx]).Mask  = Mask[xy]; 
 	    }
 	  }
@@ -152,7 +195,7 @@ void InitFineMaps(LISTPTR Input, OPTIONSTRUCT *Options, MAPSIZE *Map,
     }
   }
 
- free(Mask);  
+ FreeMap(Mask);  
   /* Create fine resolution mask, sediment and bedrock maps.
    Initialize other variables*/
   
@@ -172,15 +215,17 @@ void InitFineMaps(LISTPTR Input, OPTIONSTRUCT *Options, MAPSIZE *Map,
 	/*       if (!INBASIN((*TopoMap)[y][x].Mask)) */
 /* 		(*(*FineMap)[yy][xx]).Mask = (*TopoMap)[y][x].Mask; */
 	 /*    } */
-	    (*(*FineMap)[yy][xx]).bedrock = (*(*FineMap)[yy][xx]).Dem - (*SoilMap)[y][x].Depth;
-	    (*(*FineMap)[yy][xx]).sediment = (*SoilMap)[y][x].Depth;
+	    SETFINEBEDROCK(*(*FineMap)[yy][xx],
+			   FINEDEM(*(*FineMap)[yy][xx]) -
+			   SOILDEPTH((*SoilMap)[y][x]));
+	    (*(*FineMap)[yy][xx]).sediment = SOILDEPTH((*SoilMap)[y][x]);
 	    (*(*FineMap)[yy][xx]).SatThickness = 0.;
 	    (*(*FineMap)[yy][xx]).DeltaDepth = 0.;
 	    (*(*FineMap)[yy][xx]).Probability = 0.;
 	    (*(*FineMap)[yy][xx]).MassWasting = 0.;
 	    (*(*FineMap)[yy][xx]).MassDeposition = 0.;
 	    (*(*FineMap)[yy][xx]).SedimentToChannel = 0.;
-	    (*(*FineMap)[yy][xx]).TopoIndex = 0.;
+	    SETFINETOPOINDEX(*(*FineMap)[yy][xx], 0.);
 	  }
 	}
       }
@@ -193,9 +238,9 @@ void InitFineMaps(LISTPTR Input, OPTIONSTRUCT *Options, MAPSIZE *Map,
      fine cell within the boundary of the coarse mask, so this number may exceed the 
      number of pixels within the fine resolution mask.  */
 
-  Map->NumCellsfine = Map->NumCells*Map->NumFineIn;
+  Map->NumCellsfine = (long) Map->NumCells*Map->NumFineIn;
 
-  printf("Basin has %d active pixels in the mass wasting resolution map\n",
+  printf("Basin has %ld active pixels in the mass wasting resolution map\n",
 	 Map->NumCellsfine);
   
   /* Calculate the topographic index */
@@ -204,7 +249,9 @@ void InitFineMaps(LISTPTR Input, OPTIONSTRUCT *Options, MAPSIZE *Map,
   for (y = 0; y < Map->NY; y++) {
     for (x  = 0; x < Map->NX; x++) {
       if (INBASIN((*TopoMap)[y][x].Mask)) {
-	if (!((*TopoMap)[y][x].OrderedTopoIndex = (ITEM *) calloc(Map->NumFineIn, sizeof(ITEM))))
+	if (!((*TopoMap)[y][x].OrderedTopoIndex =
+	      (ITEM *) TrackedCalloc(Map->NumFineIn, sizeof(ITEM),
+				     MEM_SEDIMENT, "OrderedTopoIndex")))
 	  ReportError((char *) Routine, 1);
       }
     }
@@ -218,7 +265,7 @@ void InitFineMaps(LISTPTR Input, OPTIONSTRUCT *Options, MAPSIZE *Map,
 	  for(jj=0; jj< Map->DX/Map->DMASS; jj++) {
 	    yy = (int) y*Map->DY/Map->DMASS + ii;
 	    xx = (int) x*Map->DX/Map->DMASS + jj;
-	    (*TopoMap)[y][x].OrderedTopoIndex[k].Rank = (*(*FineMap)[yy][xx]).TopoIndex;
+	    (*TopoMap)[y][x].OrderedTopoIndex[k].Rank = FINETOPOINDEX(*(*FineMap)[yy][xx]);
 	    (*TopoMap)[y][x].OrderedTopoIndex[k].y = yy;
 	    (*TopoMap)[y][x].OrderedTopoIndex[k].x = xx;
 	    k++;
@@ -17,9 +17,11 @@
 #include <stdlib.h>
 #include "settings.h"
 #include "data.h"
+#include "compact.h"
 #include "DHSVMerror.h"
 #include "functions.h"
 #include "constants.h"
+#include "memtrack.h"
 
 /*****************************************************************************
   InitInterpolationWeights()
@@ -36,11 +38,15 @@ void InitInterpolationWeights(MAPSIZE * Map, OPTIONSTRUCT * Options,
   int i;
 
   if (Options->MM5 == TRUE && Options->QPF == FALSE) {
-    if (!((*MetWeights) = (uchar ***) calloc(Map->NY, sizeof(uchar **))))
+    if (!((*MetWeights) = (uchar ***) TrackedCalloc(Map->NY, sizeof(uchar **),
+						    MEM_METEOROLOGY,
+						    "MetWeights")))
       ReportError("CalcWeights()", 1);
 
     for (y = 0; y < Map->NY; y++)
-      if (!((*MetWeights)[y] = (uchar **) calloc(Map->NX, sizeof(uchar *))))
+      if (!((*MetWeights)[y] =
+	    (uchar **) TrackedCalloc(Map->NX, sizeof(uchar *), MEM_METEOROLOGY,
+				     "MetWeights")))
 	ReportError("CalcWeights()", 1);
 
     for (y = 0; y < Map->NY; y++)
@@ -65,8 +71,8 @@ void InitInterpolationWeights(MAPSIZE * Map, OPTIONSTRUCT * Options,
     printf("\nSummary info on met stations used for current model run \n");
     printf("        Name\t\tY\tX\tIn Mask\tDefined Elev\tActual Elev\n");
     for (i = 0; i < NStats; i++) {
-      if ((Stats[i].Loc.N > Map->NY || Stats[i].Loc.N < 0 ||
-	   Stats[i].Loc.E > Map->NX || Stats[i].Loc.E < 0))
+      if ((Stats[i].Loc.N >= Map->NY || Stats[i].Loc.N < 0 ||
+	   Stats[i].Loc.E >= Map->NX || Stats[i].Loc.E < 0))
 	printf("%20s\t%d\t%d\t%5s\t%5.1f\t\t%5s\n",
 	       Stats[i].Name, Stats[i].Loc.N, Stats[i].Loc.E,
 	       "NA", Stats[i].Elev, "NA");
@@ -75,7 +81,7 @@ void InitInterpolationWeights(MAPSIZE * Map, OPTIONSTRUCT * Options,
 	printf("%20s\t%d\t%d\t%d\t%5.1f\t\t%5.1f\n",
 	       Stats[i].Name, Stats[i].Loc.N, Stats[i].Loc.E,
 	       BasinMask[Stats[i].Loc.N][Stats[i].Loc.E], Stats[i].Elev,
-	       TopoMap[Stats[i].Loc.N][Stats[i].Loc.E].Dem);
+	       TOPODEM(TopoMap[Stats[i].Loc.N][Stats[i].Loc.E]));
     }
     printf("\n");
 
@@ -29,6 +29,7 @@
 #include "rad.h"
 #include "sizeofnt.h"
 #include "varid.h"
+#include "memtrack.h"
 
 
 /*****************************************************************************
@@ -41,7 +42,7 @@ void InitMetMaps(int NDaySteps, MAPSIZE *Map, MAPSIZE *Radar,
 		 EVAPPIX ***EvapMap, PRECIPPIX ***PrecipMap,
 		 RADARPIX ***RadarMap, RADCLASSPIX ***RadMap,
 		 SOILPIX **SoilMap, LAYER *Soil, VEGPIX **VegMap,
-		 LAYER *Veg, TOPOPIX **TopoMap, float ****MM5Input,
+		 LAYER *Veg, TOPOPIX **TopoMap, MM5MAPS *MM5Input,
 		 float ****WindModel)
 {
   printf("Initializing meteorological maps\n");
@@ -89,11 +90,14 @@ void InitEvapMap(MAPSIZE *Map, EVAPPIX ***EvapMap, SOILPIX **SoilMap,
   if (DEBUG)
     printf("Initializing evaporation map\n");
 
-  if (!(*EvapMap = (EVAPPIX **) calloc(Map->NY, sizeof(EVAPPIX *))))
+  if (!(*EvapMap = (EVAPPIX **) TrackedCalloc(Map->NY, sizeof(EVAPPIX *),
+					      MEM_METEOROLOGY, "EvapMap")))
     ReportError((char *) Routine, 1);
 
   for (y = 0; y < Map->NY; y++) {
-    if (!((*EvapMap)[y] = (EVAPPIX *) calloc(Map->NX, sizeof(EVAPPIX))))
+    if (!((*EvapMap)[y] = (EVAPPIX *) TrackedCalloc(Map->NX, sizeof(EVAPPIX),
+						    MEM_METEOROLOGY,
+						    "EvapMap")))
       ReportError((char *) Routine, 1);
   }
 
@@ -105,23 +109,29 @@ void InitEvapMap(MAPSIZE *Map, EVAPPIX ***EvapMap, SOILPIX **SoilMap,
 	assert(VegMap[y][x].Veg > 0 && SoilMap[y][x].Soil > 0);
 
 	if (!((*EvapMap)[y][x].EPot =
-	      (float *) calloc(NVeg + 1, sizeof(float))))
+	      (float *) TrackedCalloc(NVeg + 1, sizeof(float), MEM_METEOROLOGY,
+				      "EvapMap")))
 	  ReportError((char *) Routine, 1);
 
 	if (!((*EvapMap)[y][x].EAct =
-	      (float *) calloc(NVeg + 1, sizeof(float))))
+	      (float *) TrackedCalloc(NVeg + 1, sizeof(float), MEM_METEOROLOGY,
+				      "EvapMap")))
 	  ReportError((char *) Routine, 1);
 
-	if (!((*EvapMap)[y][x].EInt = (float *) calloc(NVeg, sizeof(float))))
+	if (!((*EvapMap)[y][x].EInt =
+	      (float *) TrackedCalloc(NVeg, sizeof(float), MEM_METEOROLOGY,
+				      "EvapMap")))
 	  ReportError((char *) Routine, 1);
 
 	if (!((*EvapMap)[y][x].ESoil =
-	      (float **) calloc(NVeg, sizeof(float *))))
+	      (float **) TrackedCalloc(NVeg, sizeof(float *), MEM_METEOROLOGY,
+				       "EvapMap")))
 	  ReportError((char *) Routine, 1);
 
 	for (i = 0; i < NVeg; i++) {
 	  if (!((*EvapMap)[y][x].ESoil[i] =
-		(float *) calloc(NSoil, sizeof(float))))
+		(float *) TrackedCalloc(NSoil, sizeof(float), MEM_METEOROLOGY,
+					"EvapMap")))
 	    ReportError((char *) Routine, 1);
 	}
       }
@@ -143,11 +153,15 @@ void InitPrecipMap(MAPSIZE * Map, PRECIPPIX *** PrecipMap, VEGPIX ** VegMap,
   if (DEBUG)
     printf("Initializing precipitation map\n");
 
-  if (!(*PrecipMap = (PRECIPPIX **) calloc(Map->NY, sizeof(PRECIPPIX *))))
+  if (!(*PrecipMap = (PRECIPPIX **) TrackedCalloc(Map->NY, sizeof(PRECIPPIX *),
+						  MEM_METEOROLOGY,
+						  "PrecipMap")))
     ReportError((char *) Routine, 1);
 
   for (y = 0; y < Map->NY; y++) {
-    if (!((*PrecipMap)[y] = (PRECIPPIX *) calloc(Map->NX, sizeof(PRECIPPIX))))
+    if (!((*PrecipMap)[y] =
+	  (PRECIPPIX *) TrackedCalloc(Map->NX, sizeof(PRECIPPIX),
+				      MEM_METEOROLOGY, "PrecipMap")))
       ReportError((char *) Routine, 1);
   }
 
@@ -156,7 +170,8 @@ void InitPrecipMap(MAPSIZE * Map, PRECIPPIX *** PrecipMap, VEGPIX ** VegMap,
       if (INBASIN(TopoMap[y][x].Mask)) {
 	NVeg = Veg->NLayers[(VegMap[y][x].Veg - 1)];
 	if (!((*PrecipMap)[y][x].IntRain =
-	      (float *) calloc(NVeg, sizeof(float))))
+	      (float *) TrackedCalloc(NVeg, sizeof(float), MEM_METEOROLOGY,
+				      "PrecipMap")))
 	  ReportError((char *) Routine, 1);
       }
     }
@@ -167,7 +182,8 @@ void InitPrecipMap(MAPSIZE * Map, PRECIPPIX *** PrecipMap, VEGPIX ** VegMap,
       if (INBASIN(TopoMap[y][x].Mask)) {
 	NVeg = Veg->NLayers[(VegMap[y][x].Veg - 1)];
 	if (!((*PrecipMap)[y][x].IntSnow =
-	      (float *) calloc(NVeg, sizeof(float))))
+	      (float *) TrackedCalloc(NVeg, sizeof(float), MEM_METEOROLOGY,
+				      "PrecipMap")))
 	  ReportError((char *) Routine, 1);
       }
     }
@@ -184,7 +200,7 @@ void InitPrecipMap(MAPSIZE * Map, PRECIPPIX *** PrecipMap, VEGPIX ** VegMap,
 /*******************************************************************************
   InitMM5Maps()
 *******************************************************************************/
-void InitMM5Maps(int NSoilLayers, int NY, int NX, float ****MM5Input,
+void InitMM5Maps(int NSoilLayers, int NY, int NX, MM5MAPS *MM5Input,
 		 RADCLASSPIX ***RadMap, OPTIONSTRUCT *Options)
 {
   char *Routine = "InitMM5Maps";
@@ -195,23 +211,49 @@ void InitMM5Maps(int NSoilLayers, int NY, int NX, float ****MM5Input,
   if (Options->HeatFlux == FALSE)
     NTotalMaps -= NSoilLayers;
 
-  if (!((*MM5Input) = (float ***) calloc(NTotalMaps, sizeof(float **))))
+#ifdef COMPACT_MAPS
+  /* the maps are encoded every time they are read, see InitNewStep() */
+  if (!((*MM5Input) = (COMPACTMAP *) TrackedCalloc(NTotalMaps,
+						   sizeof(COMPACTMAP),
+						   MEM_METEOROLOGY,
+						   "MM5Input")))
     ReportError(Routine, 1);
 
   for (n = 0; n < NTotalMaps; n++) {
-    if (!((*MM5Input)[n] = (float **) calloc(NY, sizeof(float *))))
+    (*MM5Input)[n].NX = NX;
+    if (!((*MM5Input)[n].Code =
+	  (unsigned short *) TrackedCalloc((size_t) NY * NX,
+					   sizeof(unsigned short),
+					   MEM_METEOROLOGY, "MM5Input")))
+      ReportError(Routine, 1);
+  }
+#else
+  if (!((*MM5Input) = (float ***) TrackedCalloc(NTotalMaps, sizeof(float **),
+						MEM_METEOROLOGY, "MM5Input")))
+    ReportError(Routine, 1);
+
+  for (n = 0; n < NTotalMaps; n++) {
+    if (!((*MM5Input)[n] = (float **) TrackedCalloc(NY, sizeof(float *),
+						    MEM_METEOROLOGY,
+						    "MM5Input")))
       ReportError(Routine, 1);
     for (y = 0; y < NY; y++) {
-      if (!((*MM5Input)[n][y] = (float *) calloc(NX, sizeof(float))))
+      if (!((*MM5Input)[n][y] = (float *) TrackedCalloc(NX, sizeof(float),
+							MEM_METEOROLOGY,
+							"MM5Input")))
 	ReportError(Routine, 1);
     }
   }
+#endif
 
-  if (!(*RadMap = (RADCLASSPIX **) calloc(NY, sizeof(RADCLASSPIX *))))
+  if (!(*RadMap = (RADCLASSPIX **) TrackedCalloc(NY, sizeof(RADCLASSPIX *),
+						 MEM_METEOROLOGY, "RadMap")))
     ReportError((char *) Routine, 1);
 
   for (y = 0; y < NY; y++) {
-    if (!((*RadMap)[y] = (RADCLASSPIX *) calloc(NX, sizeof(RADCLASSPIX))))
+    if (!((*RadMap)[y] = (RADCLASSPIX *) TrackedCalloc(NX, sizeof(RADCLASSPIX),
+						       MEM_METEOROLOGY,
+						       "RadMap")))
       ReportError((char *) Routine, 1);
   }
 }
@@ -230,19 +272,25 @@ void InitWindModelMaps(char *WindPath, int NY, int NX, float ****WindModel)
   int y;
   float *Array = NULL;
 
-  if (!((*WindModel) = (float ***) calloc(NWINDMAPS, sizeof(float **))))
+  if (!((*WindModel) = (float ***) TrackedCalloc(NWINDMAPS, sizeof(float **),
+						 MEM_METEOROLOGY,
+						 "WindModel")))
     ReportError(Routine, 1);
 
   for (n = 0; n < NWINDMAPS; n++) {
-    if (!((*WindModel)[n] = (float **) calloc(NY, sizeof(float *))))
+    if (!((*WindModel)[n] = (float **) TrackedCalloc(NY, sizeof(float *),
+						     MEM_METEOROLOGY,
+						     "WindModel")))
       ReportError(Routine, 1);
     for (y = 0; y < NY; y++) {
-      if (!((*WindModel)[n][y] = (float *) calloc(NX, sizeof(float))))
+      if (!((*WindModel)[n][y] = (float *) TrackedCalloc(NX, sizeof(float),
+							 MEM_METEOROLOGY,
+							 "WindModel")))
 	ReportError(Routine, 1);
     }
   }
 
-  if (!(Array = (float *) calloc(NY * NX, sizeof(float))))
+  if (!(Array = (float *) CallocMap(NY, NX, sizeof(float))))
     ReportError((char *) Routine, 1);
   NumberType = NC_FLOAT;
 
@@ -253,11 +301,11 @@ void InitWindModelMaps(char *WindPath, int NY, int NX, float ****WindModel)
     Read2DMatrix(InFileName, Array, NumberType, NY, NX, 0);
     for (y = 0; y < NY; y++) {
       for (x = 0; x < NX; x++) {
-	(*WindModel)[n][y][x] = Array[y * NX + x];
+	(*WindModel)[n][y][x] = Array[(size_t) y * NX + x];
       }
     }
   }
-  free(Array);
+  FreeMap(Array);
 }
 
 /*******************************************************************************
@@ -271,11 +319,14 @@ void InitRadarMap(MAPSIZE *Radar, RADARPIX ***RadarMap)
   if (DEBUG)
     printf("Initializing radar precipitation map\n");
 
-  if (!(*RadarMap = (RADARPIX **) calloc(Radar->NY, sizeof(RADARPIX *))))
+  if (!(*RadarMap = (RADARPIX **) TrackedCalloc(Radar->NY, sizeof(RADARPIX *),
+						MEM_METEOROLOGY, "RadarMap")))
     ReportError((char *) Routine, 1);
 
   for (y = 0; y < Radar->NY; y++) {
-    if (!((*RadarMap)[y] = (RADARPIX *) calloc(Radar->NX, sizeof(RADARPIX))))
+    if (!((*RadarMap)[y] =
+	  (RADARPIX *) TrackedCalloc(Radar->NX, sizeof(RADARPIX),
+				     MEM_METEOROLOGY, "RadarMap")))
       ReportError((char *) Routine, 1);
   }
 }
@@ -291,11 +342,15 @@ void InitRadMap(MAPSIZE *Map, RADCLASSPIX ***RadMap)
   if (DEBUG)
     printf("Initializing radiation map\n");
   
-  if (!(*RadMap = (RADCLASSPIX **) calloc(Map->NY, sizeof(RADCLASSPIX *))))
+  if (!(*RadMap = (RADCLASSPIX **) TrackedCalloc(Map->NY,
+						 sizeof(RADCLASSPIX *),
+						 MEM_METEOROLOGY, "RadMap")))
     ReportError((char *) Routine, 1);
   
   for (y = 0; y < Map->NY; y++) {
-    if (!((*RadMap)[y] = (RADCLASSPIX *) calloc(Map->NX, sizeof(RADCLASSPIX))))
+    if (!((*RadMap)[y] =
+	  (RADCLASSPIX *) TrackedCalloc(Map->NX, sizeof(RADCLASSPIX),
+					MEM_METEOROLOGY, "RadMap")))
       ReportError((char *) Routine, 1);
   }
 }
@@ -312,26 +367,30 @@ void InitPrecipLapseMap(char *PrecipLapseFile, int NY, int NX,
   int y;			/* counter */
   float *Array = NULL;
 
-  if (!((*PrecipLapseMap) = (float **) calloc(NY, sizeof(float *))))
+  if (!((*PrecipLapseMap) = (float **) TrackedCalloc(NY, sizeof(float *),
+						     MEM_METEOROLOGY,
+						     "PrecipLapseMap")))
     ReportError((char *) Routine, 1);
 
   for (y = 0; y < NY; y++) {
-    if (!((*PrecipLapseMap)[y] = (float *) calloc(NX, sizeof(float))))
+    if (!((*PrecipLapseMap)[y] = (float *) TrackedCalloc(NX, sizeof(float),
+							 MEM_METEOROLOGY,
+							 "PrecipLapseMap")))
       ReportError((char *) Routine, 1);
   }
 
-  if (!(Array = (float *) calloc(NY * NX, sizeof(float))))
+  if (!(Array = (float *) CallocMap(NY, NX, sizeof(float))))
     ReportError((char *) Routine, 1);
   NumberType = NC_FLOAT;
 
   Read2DMatrix(PrecipLapseFile, Array, NumberType, NY, NX, 0);
   for (y = 0; y < NY; y++) {
     for (x = 0; x < NX; x++) {
-      (*PrecipLapseMap)[y][x] = Array[y * NX + x];
+      (*PrecipLapseMap)[y][x] = Array[(size_t) y * NX + x];
     }
   }
 
-  free(Array);
+  FreeMap(Array);
 }
 
 /******************************************************************************/
@@ -344,11 +403,14 @@ void InitPrismMap(int NY, int NX, float ***PrismMap)
   int x;			/* counter */
   int y;			/* counter */
 
-  if (!((*PrismMap) = (float **) calloc(NY, sizeof(float *))))
+  if (!((*PrismMap) = (float **) TrackedCalloc(NY, sizeof(float *),
+					       MEM_METEOROLOGY, "PrismMap")))
     ReportError((char *) Routine, 1);
 
   for (y = 0; y < NY; y++) {
-    if (!((*PrismMap)[y] = (float *) calloc(NX, sizeof(float))))
+    if (!((*PrismMap)[y] = (float *) TrackedCalloc(NX, sizeof(float),
+						   MEM_METEOROLOGY,
+						   "PrismMap")))
       ReportError((char *) Routine, 1);
   }
 
@@ -375,23 +437,30 @@ void InitShadeMap(OPTIONSTRUCT * Options, int NDaySteps, int NY, int NX,
   float *Array = NULL;
 
   if (!((*ShadowMap) =
-       (unsigned char ***) calloc(NDaySteps, sizeof(unsigned char **))))
+       (unsigned char ***) TrackedCalloc(NDaySteps, sizeof(unsigned char **),
+					 MEM_METEOROLOGY, "ShadowMap")))
     ReportError((char *) Routine, 1);
   for (n = 0; n < NDaySteps; n++) {
     if (!((*ShadowMap)[n] =
-	 (unsigned char **) calloc(NY, sizeof(unsigned char *))))
+	 (unsigned char **) TrackedCalloc(NY, sizeof(unsigned char *),
+					  MEM_METEOROLOGY, "ShadowMap")))
       ReportError((char *) Routine, 1);
     for (y = 0; y < NY; y++) {
       if (!((*ShadowMap)[n][y] =
-	   (unsigned char *) calloc(NX, sizeof(unsigned char))))
+	   (unsigned char *) TrackedCalloc(NX, sizeof(unsigned char),
+					   MEM_METEOROLOGY, "ShadowMap")))
 	ReportError((char *) Routine, 1);
     }
   }
 
-  if (!((*SkyViewMap) = (float **) calloc(NY, sizeof(float *))))
+  if (!((*SkyViewMap) = (float **) TrackedCalloc(NY, sizeof(float *),
+						 MEM_METEOROLOGY,
+						 "SkyViewMap")))
     ReportError((char *) Routine, 1);
   for (y = 0; y < NY; y++) {
-    if (!((*SkyViewMap)[y] = (float *) calloc(NX, sizeof(float))))
+    if (!((*SkyViewMap)[y] = (float *) TrackedCalloc(NX, sizeof(float),
+						     MEM_METEOROLOGY,
+						     "SkyViewMap")))
       ReportError((char *) Routine, 1);
   }
 
@@ -403,15 +472,15 @@ void InitShadeMap(OPTIONSTRUCT * Options, int NDaySteps, int NY, int NX,
 
   GetVarName(305, 0, VarName);
   GetVarNumberType(305, &NumberType);
-  if (!(Array = (float *) calloc(NY * NX, sizeof(float))))
+  if (!(Array = (float *) CallocMap(NY, NX, sizeof(float))))
     ReportError((char *) Routine, 1);
   Read2DMatrix(Options->SkyViewDataPath, Array, NumberType, NY, NX, 0, 
 	       VarName, 0);
   for (y = 0; y < NY; y++) {
     for (x = 0; x < NX; x++) {
-      (*SkyViewMap)[y][x] = Array[y * NX + x];
+      (*SkyViewMap)[y][x] = Array[(size_t) y * NX + x];
     }
   }
 
-  free(Array);
+  FreeMap(Array);
 }
@@ -21,6 +21,7 @@
 #include "DHSVMerror.h"
 #include "fileio.h"
 #include "functions.h"
+#include "memtrack.h"
 #include "constants.h"
 #include "sizeofnt.h"
 #include "soilmoisture.h"
@@ -68,6 +69,10 @@ void InitModelState(DATE *Start, MAPSIZE *Map, OPTIONSTRUCT *Options, PRECIPPIX
 
   printf("Restoring model state\n");
 
+  /* There is no model state to restore in MET_MODEL runs */
+  if (Options->Components == MET_MODEL)
+    return;
+
   /* Restore canopy interception */
   NSet = 0;
   if (DEBUG)
@@ -83,7 +88,7 @@ sprintf(FileName, "%sInterception.State.%s%s", Path, Str, fileext);
   DMap.Resolution = MAP_OUTPUT;
   strcpy(DMap.FileName, "");
   GetVarAttr(&DMap);
-  if (!(Array = calloc(Map->NY * Map->NX, SizeOfNumberType(DMap.NumberType))))
+  if (!(Array = CallocMap(Map->NY, Map->NX, SizeOfNumberType(DMap.NumberType))))
     ReportError((char *) Routine, 1);
   for (i = 0; i < Veg.MaxLayers; i++) {
     DMap.ID = 202;
@@ -95,10 +100,9 @@ sprintf(FileName, "%sInterception.State.%s%s", Path, Str, fileext);
     for (y = 0; y < Map->NY; y++) {
 		for (x = 0; x < Map->NX; x++) {
 			if (INBASIN(TopoMap[y][x].Mask)) {
-				PrecipMap[y][x].IntRain[i] = 0.0;
 				NVeg = Veg.NLayers[(VegMap[y][x].Veg - 1)];
 				if (i < NVeg) {
-					PrecipMap[y][x].IntRain[i] = ((float *) Array)[y * Map->NX + x];
+					PrecipMap[y][x].IntRain[i] = ((float *) Array)[(size_t) y * Map->NX + x];
 					if (PrecipMap[y][x].IntRain[i] < 0.0) {
 						fprintf(stderr, "InitModelState at (x, y) is (%d, %d):\n", x, y);
 						fprintf(stderr,
@@ -120,10 +124,9 @@ sprintf(FileName, "%sInterception.State.%s%s", Path, Str, fileext);
     for (y = 0; y < Map->NY; y++) {
       for (x = 0; x < Map->NX; x++) {
 		  if (INBASIN(TopoMap[y][x].Mask)) {
-			  PrecipMap[y][x].IntSnow[i] = 0.0;
 			  NVeg = Veg.NLayers[(VegMap[y][x].Veg - 1)];
 			  if (i < NVeg) {
-				  PrecipMap[y][x].IntSnow[i] = ((float *) Array)[y * Map->NX + x];
+				  PrecipMap[y][x].IntSnow[i] = ((float *) Array)[(size_t) y * Map->NX + x];
 				  if (PrecipMap[y][x].IntSnow[i] < 0.0) {
 					  fprintf(stderr, "InitModelState at (x, y) is (%d, %d):\n", x, y);
 					  fprintf(stderr,
@@ -143,7 +146,7 @@ sprintf(FileName, "%sInterception.State.%s%s", Path, Str, fileext);
   for (y = 0; y < Map->NY; y++) {
     for (x = 0; x < Map->NX; x++) {
       if (INBASIN(TopoMap[y][x].Mask)) {
-	PrecipMap[y][x].TempIntStorage = ((float *) Array)[y * Map->NX + x];
+	PrecipMap[y][x].TempIntStorage = ((float *) Array)[(size_t) y * Map->NX + x];
 	if (PrecipMap[y][x].TempIntStorage < 0.0) {
 	  fprintf(stderr, "InitModelState at (x, y) is (%d, %d):\n", x, y);
 	  fprintf(stderr,
@@ -153,7 +156,7 @@ sprintf(FileName, "%sInterception.State.%s%s", Path, Str, fileext);
       }
     }
   }
-  free(Array);
+  FreeMap(Array);
   /* Restore snow pack conditions */
   NSet = 0;
   if (DEBUG)
@@ -165,13 +168,13 @@ sprintf(FileName, "%sInterception.State.%s%s", Path, Str, fileext);
   DMap.Resolution = MAP_OUTPUT;
   strcpy(DMap.FileName, "");
   GetVarAttr(&DMap);
-  if (!(Array = (float *) calloc(Map->NY * Map->NX, SizeOfNumberType(DMap.NumberType))))
+  if (!(Array = (float *) CallocMap(Map->NY, Map->NX, SizeOfNumberType(DMap.NumberType))))
     ReportError((char *) Routine, 1);
   Read2DMatrix(FileName, Array, DMap.NumberType, Map->NY, Map->NX, NSet++, DMap.Name, 0);
   for (y = 0; y < Map->NY; y++) {
     for (x = 0; x < Map->NX; x++) {
       if (INBASIN(TopoMap[y][x].Mask)) {
-		  SnowMap[y][x].HasSnow = (unsigned char) ((float *) Array)[y * Map->NX + x]; }
+		  SnowMap[y][x].HasSnow = (unsigned char) ((float *) Array)[(size_t) y * Map->NX + x]; }
     }
   }
 
@@ -183,7 +186,7 @@ Read2DMatrix(FileName, Array, DMap.NumberType, Map->NY, Map->NX, NSet++,  DMap.N
   for (y = 0; y < Map->NY; y++) {
     for (x = 0; x < Map->NX; x++) {
       if (INBASIN(TopoMap[y][x].Mask)) {
-		  SnowMap[y][x].LastSnow = (unsigned short) ((float *) Array)[y * Map->NX + x];}
+		  SnowMap[y][x].LastSnow = (unsigned short) ((float *) Array)[(size_t) y * Map->NX + x];}
     }
   }
 
@@ -195,7 +198,7 @@ Read2DMatrix(FileName, Array, DMap.NumberType, Map->NY, Map->NX, NSet++, DMap.Na
   for (y = 0; y < Map->NY; y++) {
     for (x = 0; x < Map->NX; x++) {
       if (INBASIN(TopoMap[y][x].Mask)) {
-		  SnowMap[y][x].Swq = ((float *) Array)[y * Map->NX + x];}
+		  SnowMap[y][x].Swq = ((float *) Array)[(size_t) y * Map->NX + x];}
     }
   }
 
@@ -207,7 +210,7 @@ Read2DMatrix(FileName, Array, DMap.NumberType, Map->NY, Map->NX, NSet++, DMap.Na
   for (y = 0; y < Map->NY; y++) {
     for (x = 0; x < Map->NX; x++) {
       if (INBASIN(TopoMap[y][x].Mask)) {
-		  SnowMap[y][x].PackWater = ((float *) Array)[y * Map->NX + x];
+		  SnowMap[y][x].PackWater = ((float *) Array)[(size_t) y * Map->NX + x];
       }
     }
   }
@@ -220,7 +223,7 @@ Read2DMatrix(FileName, Array, DMap.NumberType, Map->NY, Map->NX, NSet++, DMap.Na
   for (y = 0; y < Map->NY; y++) {
     for (x = 0; x < Map->NX; x++) {
       if (INBASIN(TopoMap[y][x].Mask)) {
-		  SnowMap[y][x].TPack = ((float *) Array)[y * Map->NX + x]; }
+		  SnowMap[y][x].TPack = ((float *) Array)[(size_t) y * Map->NX + x]; }
     }
   }
 
@@ -232,7 +235,7 @@ Read2DMatrix(FileName, Array, DMap.NumberType, Map->NY, Map->NX, NSet++, DMap.Na
   for (y = 0; y < Map->NY; y++) {
     for (x = 0; x < Map->NX; x++) {
       if (INBASIN(TopoMap[y][x].Mask)) {
-		  SnowMap[y][x].SurfWater = ((float *) Array)[y * Map->NX + x];}
+		  SnowMap[y][x].SurfWater = ((float *) Array)[(size_t) y * Map->NX + x];}
     }
   }
 
@@ -245,7 +248,7 @@ Read2DMatrix(FileName, Array, DMap.NumberType, Map->NY, Map->NX, NSet++, DMap.Na
   for (y = 0; y < Map->NY; y++) {
     for (x = 0; x < Map->NX; x++) {
       if (INBASIN(TopoMap[y][x].Mask)) {
-		  SnowMap[y][x].TSurf = ((float *) Array)[y * Map->NX + x];}
+		  SnowMap[y][x].TSurf = ((float *) Array)[(size_t) y * Map->NX + x];}
     }
   }
 
@@ -257,10 +260,10 @@ Read2DMatrix(FileName, Array, DMap.NumberType, Map->NY, Map->NX, NSet++, DMap.Na
   for (y = 0; y < Map->NY; y++) {
     for (x = 0; x < Map->NX; x++) {
       if (INBASIN(TopoMap[y][x].Mask)) {
-		  SnowMap[y][x].ColdContent = ((float *) Array)[y * Map->NX + x];}
+		  SnowMap[y][x].ColdContent = ((float *) Array)[(size_t) y * Map->NX + x];}
     }
   }
-  free(Array);
+  FreeMap(Array);
 
   for (y = 0; y < Map->NY; y++) {
     for (x = 0; x < Map->NX; x++) {
@@ -273,6 +276,11 @@ Read2DMatrix(FileName, Array, DMap.NumberType, Map->NY, Map->NX, NSet++, DMap.Na
     }
   }
 
+  /* The soil water, and with it the unit hydrograph, is only simulated in
+     FULL_MODEL runs */
+  if (Options->Components != FULL_MODEL)
+    return;
+
   /* Restore soil conditions */
   NSet = 0;
   if (DEBUG)
@@ -285,7 +293,7 @@ Read2DMatrix(FileName, Array, DMap.NumberType, Map->NY, Map->NX, NSet++, DMap.Na
   strcpy(DMap.FileName, "");
   GetVarAttr(&DMap);
 
-  if (!(Array = (float *) calloc(Map->NY * Map->NX, SizeOfNumberType(DMap.NumberType))))
+  if (!(Array = (float *) CallocMap(Map->NY, Map->NX, SizeOfNumberType(DMap.NumberType))))
     ReportError((char *) Routine, 1);
   for (i = 0; i < Soil.MaxLayers + 1; i++) {
     DMap.ID = 501;
@@ -299,7 +307,7 @@ Read2DMatrix(FileName, Array, DMap.NumberType, Map->NY, Map->NX, NSet++, DMap.Na
 		  if (INBASIN(TopoMap[y][x].Mask)) {
 			  NSoil = Soil.NLayers[(SoilMap[y][x].Soil - 1)];
 			  if (i <= NSoil) {
-				  SoilMap[y][x].Moist[i] = ((float *) Array)[y * Map->NX + x];
+				  SoilMap[y][x].Moist[i] = ((float *) Array)[(size_t) y * Map->NX + x];
 				  if (SoilMap[y][x].Moist[i] < 0.0) {
 					  fprintf(stderr, "InitModelState at (x, y) is (%d, %d):\n", x, y);
 					  fprintf(stderr,
@@ -329,7 +337,7 @@ Read2DMatrix(FileName, Array, DMap.NumberType, Map->NY, Map->NX, NSet++, DMap.Na
   for (y = 0; y < Map->NY; y++) {
     for (x = 0; x < Map->NX; x++) {
       if (INBASIN(TopoMap[y][x].Mask)) {
-		  SoilMap[y][x].TSurf = ((float *) Array)[y * Map->NX + x];
+		  SoilMap[y][x].TSurf = ((float *) Array)[(size_t) y * Map->NX + x];
       }
     }
   }
@@ -346,7 +354,7 @@ Read2DMatrix(FileName, Array, DMap.NumberType, Map->NY, Map->NX, NSet++, DMap.Na
 		  if (INBASIN(TopoMap[y][x].Mask)) {
 			  NSoil = Soil.NLayers[(SoilMap[y][x].Soil - 1)];
 			  if (i < NSoil)
-				  SoilMap[y][x].Temp[i] = ((float *) Array)[y * Map->NX + x];
+				  SoilMap[y][x].Temp[i] = ((float *) Array)[(size_t) y * Map->NX + x];
 		  }
       }
     }
@@ -359,7 +367,7 @@ Read2DMatrix(FileName, Array, DMap.NumberType, Map->NY, Map->NX, NSet++, DMap.Na
   for (y = 0; y < Map->NY; y++) {
     for (x = 0; x < Map->NX; x++) {
       if (INBASIN(TopoMap[y][x].Mask)) {
-		  SoilMap[y][x].Qst = ((float *) Array)[y * Map->NX + x];
+		  SoilMap[y][x].Qst = ((float *) Array)[(size_t) y * Map->NX + x];
       }
     }
   }
@@ -372,12 +380,12 @@ Read2DMatrix(FileName, Array, DMap.NumberType, Map->NY, Map->NX, NSet++, DMap.Na
   for (y = 0; y < Map->NY; y++) {
     for (x = 0; x < Map->NX; x++) {
         if (INBASIN(TopoMap[y][x].Mask)) {
-			SoilMap[y][x].IExcess = ((float *) Array)[y * Map->NX + x];
+			SoilMap[y][x].IExcess = ((float *) Array)[(size_t) y * Map->NX + x];
 			SoilMap[y][x].startRunoff = 0.0;
 	  }
 	}
   }
-  free(Array);
+  FreeMap(Array);
 
   /* Calculate the water table depth at each point based on the soil moisture profile. Give an error message if the water 
   ponds on the surface since that should not be allowed at this point */
@@ -389,7 +397,7 @@ Read2DMatrix(FileName, Array, DMap.NumberType, Map->NY, Map->NX, NSet++, DMap.Na
 		  SoilMap[y][x].SatFlow = 0.0;
 		  if (INBASIN(TopoMap[y][x].Mask)) {
 			  if ((SoilMap[y][x].TableDepth =
-				  WaterTableDepth((Soil.NLayers[SoilMap[y][x].Soil - 1]), SoilMap[y][x].Depth,
+				  WaterTableDepth((Soil.NLayers[SoilMap[y][x].Soil - 1]), SOILDEPTH(SoilMap[y][x]),
 				  VType[VegMap[y][x].Veg - 1].RootDepth, SType[SoilMap[y][x].Soil - 1].Porosity,
 				  SType[SoilMap[y][x].Soil - 1].FCap, Network[y][x].Adjust, SoilMap[y][x].Moist))< 0.0)
 				  /* ReportError((char *) Routine, 35); */  {
@@ -24,6 +24,7 @@
 #include "settings.h"
 #include "soilmoisture.h"
 #include "DHSVMChannel.h"
+#include "memtrack.h"
 
 /*****************************************************************************
   Function name: InitNetwork()
@@ -52,11 +53,14 @@ void InitNetwork(int NY, int NX, float DX, float DY, TOPOPIX **TopoMap,
   FILE *inputfile;
   /* Allocate memory for network structure */
 
-  if (!(*Network = (ROADSTRUCT **) calloc(NY, sizeof(ROADSTRUCT *))))
+  if (!(*Network = (ROADSTRUCT **) TrackedCalloc(NY, sizeof(ROADSTRUCT *),
+						 MEM_NETWORK, "Network")))
     ReportError((char *) Routine, 1);
 
   for (y = 0; y < NY; y++) {
-    if (!((*Network)[y] = (ROADSTRUCT *) calloc(NX, sizeof(ROADSTRUCT))))
+    if (!((*Network)[y] = (ROADSTRUCT *) TrackedCalloc(NX, sizeof(ROADSTRUCT),
+						       MEM_NETWORK,
+						       "Network")))
       ReportError((char *) Routine, 1);
   }
 
@@ -64,11 +68,15 @@ void InitNetwork(int NY, int NX, float DX, float DY, TOPOPIX **TopoMap,
     for (x = 0; x < NX; x++) {
       if (INBASIN(TopoMap[y][x].Mask)) {
 		  if (!((*Network)[y][x].Adjust = 
-			  (float *) calloc((VType[VegMap[y][x].Veg - 1].NSoilLayers + 1), sizeof(float))))
+			  (float *) TrackedCalloc((VType[VegMap[y][x].Veg - 1].NSoilLayers + 1),
+						  sizeof(float), MEM_NETWORK,
+						  "Network")))
 			  ReportError((char *) Routine, 1);
 		  
 		  if (!((*Network)[y][x].PercArea =
-			  (float *) calloc((VType[VegMap[y][x].Veg - 1].NSoilLayers + 1), sizeof(float))))
+			  (float *) TrackedCalloc((VType[VegMap[y][x].Veg - 1].NSoilLayers + 1),
+						  sizeof(float), MEM_NETWORK,
+						  "Network")))
 			  ReportError((char *) Routine, 1);
       }
     }
@@ -85,7 +93,7 @@ void InitNetwork(int NY, int NX, float DX, float DY, TOPOPIX **TopoMap,
 	if (INBASIN(TopoMap[y][x].Mask)) {
 	  ChannelCut(y, x, ChannelData, &((*Network)[y][x]));
 	  AdjustStorage(VType[VegMap[y][x].Veg - 1].NSoilLayers,
-			SoilMap[y][x].Depth,
+			SOILDEPTH(SoilMap[y][x]),
 			VType[VegMap[y][x].Veg - 1].RootDepth,
 			(*Network)[y][x].Area, DX, DY, 
 			(*Network)[y][x].BankHeight,
@@ -16,6 +16,7 @@
  * $Id: InitNewMonth.c,v 3.1 2013/02/06 ning Exp $     
  */
 
+#include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <math.h>
@@ -23,6 +24,7 @@
 #include "data.h"
 #include "DHSVMerror.h"
 #include "functions.h"
+#include "memtrack.h"
 #include "constants.h"
 #include "fifobin.h"
 #include "fileio.h"
@@ -67,18 +69,18 @@ void InitNewMonth(TIMESTRUCT *Time, OPTIONSTRUCT *Options, MAPSIZE *Map,
 
     GetVarName(205, 0, VarName);
     GetVarNumberType(205, &NumberType);
-    if (!(Array = (float *) calloc(Map->NY * Map->NX, sizeof(float))))
+    if (!(Array = (float *) CallocMap(Map->NY, Map->NX, sizeof(float))))
       ReportError((char *) Routine, 1);
 
     Read2DMatrix(FileName, Array, NumberType, Map->NY, Map->NX, 0);
 
     for (y = 0; y < Map->NY; y++) {
       for (x = 0; x < Map->NX; x++) {
-	PrismMap[y][x] = Array[y * Map->NX + x];
+	PrismMap[y][x] = Array[(size_t) y * Map->NX + x];
       }
     }
 
-    free(Array);
+    FreeMap(Array);
 
   }
 
@@ -91,7 +93,7 @@ void InitNewMonth(TIMESTRUCT *Time, OPTIONSTRUCT *Options, MAPSIZE *Map,
 
     if (!
 	(Array1 =
-	 (unsigned char *) calloc(Map->NY * Map->NX, sizeof(unsigned char))))
+	 (unsigned char *) CallocMap(Map->NY, Map->NX, sizeof(unsigned char))))
       ReportError((char *) Routine, 1);
 
     for (i = 0; i < Time->NDaySteps; i++) {
@@ -101,11 +103,11 @@ void InitNewMonth(TIMESTRUCT *Time, OPTIONSTRUCT *Options, MAPSIZE *Map,
 
       for (y = 0; y < Map->NY; y++) {
 	for (x = 0; x < Map->NX; x++) {
-	  ShadowMap[i][y][x] = Array1[y * Map->NX + x];
+	  ShadowMap[i][y][x] = Array1[(size_t) y * Map->NX + x];
 	}
       }
     }
-    free(Array1);
+    FreeMap(Array1);
   }
 
   printf("changing LAI, albedo and diffuse transmission parameters\n");
@@ -187,7 +189,7 @@ void InitNewDay(int DayOfYear, SOLARGEOMETRY * SolarGeo)
     SOLARGEOMETRY *SolarGeo  - structure with information about Earth-Sun 
                                geometry
     SOILPIX **SoilMap        - structure with soil information
-    float ***MM5Input        - MM5 input maps
+    MM5MAPS MM5Input         - MM5 input maps, see compact.h
     float ***WindModel       - Wind model maps
                            
   Returns      : void
@@ -201,7 +203,7 @@ void InitNewStep(INPUTFILES *InFiles, MAPSIZE *Map, TIMESTRUCT *Time,
 		 METLOCATION *Stat, char *RadarFileName, MAPSIZE *Radar,
 		 RADARPIX **RadarMap, SOLARGEOMETRY *SolarGeo, 
 		 TOPOPIX **TopoMap, RADCLASSPIX **RadMap, SOILPIX **SoilMap,
-		 float ***MM5Input, float ***WindModel, MAPSIZE *MM5Map)
+		 MM5MAPS MM5Input, float ***WindModel, MAPSIZE *MM5Map)
 {
   const char *Routine = "InitNewStep";
   int i;			/* counter */
@@ -211,6 +213,10 @@ void InitNewStep(INPUTFILES *InFiles, MAPSIZE *Map, TIMESTRUCT *Time,
   int NumberType;		/* number type in MM5 input */
   int Step;			/* Step in the MM5 Input */
   float *Array = NULL;
+  float **Values;		/* Rows of the MM5 map being read */
+#ifdef COMPACT_MAPS
+  float **Scratch = NULL;	/* Float map that is encoded */
+#endif
   int MM5Y, MM5X;
 
   /*printf("current time is %4d-%2d-%2d-%2d\n", Time->Current.Year,Time->Current.Month, Time->Current.Day, Time->Current.Hour);*/
@@ -219,7 +225,8 @@ void InitNewStep(INPUTFILES *InFiles, MAPSIZE *Map, TIMESTRUCT *Time,
      horizon, this is only necessary if shading is TRUE */
 
   SolarHour(SolarGeo->Latitude,
-	    (Time->DayStep + 1) * ((float) Time->Dt) / SECPHOUR,
+	    (Time->DayStep + Options->Adaptive.Steps) *
+	    ((float) Time->Dt / Options->Adaptive.Steps) / SECPHOUR,
 	    ((float) Time->Dt) / SECPHOUR, SolarGeo->NoonHour,
 	    SolarGeo->Declination, SolarGeo->Sunrise, SolarGeo->Sunset,
 	    SolarGeo->TimeAdjustment, SolarGeo->SunEarthDistance,
@@ -232,102 +239,133 @@ void InitNewStep(INPUTFILES *InFiles, MAPSIZE *Map, TIMESTRUCT *Time,
 
     /* Read the data from the MM5 files */
 
-    if (!(Array = (float *) calloc(MM5Map->NY * MM5Map->NX, sizeof(float))))
+    if (!(Array = (float *) CallocMap(MM5Map->NY, MM5Map->NX, sizeof(float))))
       ReportError((char *) Routine, 1);
     NumberType = NC_FLOAT;
+#ifdef COMPACT_MAPS
+    /* each map is resampled here and then encoded, see compact.h */
+    if (!(Scratch = (float **) calloc(Map->NY, sizeof(float *))))
+      ReportError((char *) Routine, 1);
+    for (y = 0; y < Map->NY; y++)
+      if (!(Scratch[y] = (float *) calloc(Map->NX, sizeof(float))))
+	ReportError((char *) Routine, 1);
+#endif
 
     Step = NumberOfSteps(&(Time->StartMM5), &(Time->Current), Time->Dt);
 
     Read2DMatrix(InFiles->MM5Temp, Array, NumberType, MM5Map->NY,
 		 MM5Map->NX, Step);
+    Values = MM5ROWS(MM5Input, MM5_temperature - 1, Scratch);
     for (y = 0; y < Map->NY; y++)
       for (x = 0; x < Map->NX; x++) {
 		  MM5Y = (int) ((y + MM5Map->OffsetY) * Map->DY / MM5Map->DY);
 		  MM5X = (int) ((x - MM5Map->OffsetX) * Map->DX / MM5Map->DY);
-		  MM5Input[MM5_temperature - 1][y][x] = Array[MM5Y * MM5Map->NX + MM5X];
+		  Values[y][x] = Array[(size_t) MM5Y * MM5Map->NX + MM5X];
       }
+    STOREMM5(MM5Input, MM5_temperature - 1, Scratch, Map->NY, Map->NX);
 
     Read2DMatrix(InFiles->MM5Humidity, Array, NumberType, MM5Map->NY,
 		 MM5Map->NX, Step);
 
+    Values = MM5ROWS(MM5Input, MM5_humidity - 1, Scratch);
     for (y = 0; y < Map->NY; y++)
       for (x = 0; x < Map->NX; x++) {
 		  MM5Y = (int) ((y + MM5Map->OffsetY) * Map->DY / MM5Map->DY);
 		  MM5X = (int) ((x - MM5Map->OffsetX) * Map->DX / MM5Map->DY);
-		  MM5Input[MM5_humidity - 1][y][x] = Array[MM5Y * MM5Map->NX + MM5X];
+		  Values[y][x] = Array[(size_t) MM5Y * MM5Map->NX + MM5X];
       }
+    STOREMM5(MM5Input, MM5_humidity - 1, Scratch, Map->NY, Map->NX);
 
     Read2DMatrix(InFiles->MM5Wind, Array, NumberType, MM5Map->NY,
 		 MM5Map->NX, Step);
+    Values = MM5ROWS(MM5Input, MM5_wind - 1, Scratch);
     for (y = 0; y < Map->NY; y++)
       for (x = 0; x < Map->NX; x++) {
 		  MM5Y = (int) ((y + MM5Map->OffsetY) * Map->DY / MM5Map->DY);
 		  MM5X = (int) ((x - MM5Map->OffsetX) * Map->DX / MM5Map->DY);
-		  MM5Input[MM5_wind - 1][y][x] = Array[MM5Y * MM5Map->NX + MM5X];
+		  Values[y][x] = Array[(size_t) MM5Y * MM5Map->NX + MM5X];
       }
+    STOREMM5(MM5Input, MM5_wind - 1, Scratch, Map->NY, Map->NX);
 
     Read2DMatrix(InFiles->MM5ShortWave, Array, NumberType, MM5Map->NY,
 		 MM5Map->NX, Step);
+    Values = MM5ROWS(MM5Input, MM5_shortwave - 1, Scratch);
     for (y = 0; y < Map->NY; y++)
       for (x = 0; x < Map->NX; x++) {
 	MM5Y = (int) ((y + MM5Map->OffsetY) * Map->DY / MM5Map->DY);
 	MM5X = (int) ((x - MM5Map->OffsetX) * Map->DX / MM5Map->DY);
-	MM5Input[MM5_shortwave - 1][y][x] = Array[MM5Y * MM5Map->NX + MM5X];
+	Values[y][x] = Array[(size_t) MM5Y * MM5Map->NX + MM5X];
       }
+    STOREMM5(MM5Input, MM5_shortwave - 1, Scratch, Map->NY, Map->NX);
 
     Read2DMatrix(InFiles->MM5LongWave, Array, NumberType, MM5Map->NY,
 		 MM5Map->NX, Step);
+    Values = MM5ROWS(MM5Input, MM5_longwave - 1, Scratch);
     for (y = 0; y < Map->NY; y++)
       for (x = 0; x < Map->NX; x++) {
 	MM5Y = (int) ((y + MM5Map->OffsetY) * Map->DY / MM5Map->DY);
 	MM5X = (int) ((x - MM5Map->OffsetX) * Map->DX / MM5Map->DY);
-	MM5Input[MM5_longwave - 1][y][x] = Array[MM5Y * MM5Map->NX + MM5X];
+	Values[y][x] = Array[(size_t) MM5Y * MM5Map->NX + MM5X];
       }
+    STOREMM5(MM5Input, MM5_longwave - 1, Scratch, Map->NY, Map->NX);
 
     Read2DMatrix(InFiles->MM5Precipitation, Array, NumberType, MM5Map->NY,
 		 MM5Map->NX, Step);
+    Values = MM5ROWS(MM5Input, MM5_precip - 1, Scratch);
     for (y = 0; y < Map->NY; y++)
       for (x = 0; x < Map->NX; x++) {
 	MM5Y = (int) ((y + MM5Map->OffsetY) * Map->DY / MM5Map->DY);
 	MM5X = (int) ((x - MM5Map->OffsetX) * Map->DX / MM5Map->DY);
-	MM5Input[MM5_precip - 1][y][x] = Array[MM5Y * MM5Map->NX + MM5X];
-	if (MM5Input[MM5_precip - 1][y][x] < 0.0) {
+	Values[y][x] = Array[(size_t) MM5Y * MM5Map->NX + MM5X];
+	if (Values[y][x] < 0.0) {
 	  printf("Warning: MM5 precip is less than zero %f\n",
-		 MM5Input[MM5_precip - 1][y][x]);
-	  MM5Input[MM5_precip - 1][y][x] = 0.0;
+		 Values[y][x]);
+	  Values[y][x] = 0.0;
 	}
       }
+    STOREMM5(MM5Input, MM5_precip - 1, Scratch, Map->NY, Map->NX);
     Read2DMatrix(InFiles->MM5Terrain, Array, NumberType, MM5Map->NY,
 		 MM5Map->NX, Step);
+    Values = MM5ROWS(MM5Input, MM5_terrain - 1, Scratch);
     for (y = 0; y < Map->NY; y++)
       for (x = 0; x < Map->NX; x++) {
 	MM5Y = (int) ((y + MM5Map->OffsetY) * Map->DY / MM5Map->DY);
 	MM5X = (int) ((x - MM5Map->OffsetX) * Map->DX / MM5Map->DY);
-	MM5Input[MM5_terrain - 1][y][x] = Array[MM5Y * MM5Map->NX + MM5X];
+	Values[y][x] = Array[(size_t) MM5Y * MM5Map->NX + MM5X];
       }
+    STOREMM5(MM5Input, MM5_terrain - 1, Scratch, Map->NY, Map->NX);
     Read2DMatrix(InFiles->MM5Lapse, Array, NumberType, MM5Map->NY,
 		 MM5Map->NX, Step);
+    Values = MM5ROWS(MM5Input, MM5_lapse - 1, Scratch);
     for (y = 0; y < Map->NY; y++)
       for (x = 0; x < Map->NX; x++) {
 	MM5Y = (int) ((y + MM5Map->OffsetY) * Map->DY / MM5Map->DY);
 	MM5X = (int) ((x - MM5Map->OffsetX) * Map->DX / MM5Map->DY);
-	MM5Input[MM5_lapse - 1][y][x] = Array[MM5Y * MM5Map->NX + MM5X];
+	Values[y][x] = Array[(size_t) MM5Y * MM5Map->NX + MM5X];
       }
+    STOREMM5(MM5Input, MM5_lapse - 1, Scratch, Map->NY, Map->NX);
 
     if (Options->HeatFlux == TRUE) {
 
       for (i = 0, j = MM5_lapse; i < NSoilLayers; i++, j++) {
 	Read2DMatrix(InFiles->MM5SoilTemp[i], Array, NumberType, MM5Map->NY,
 		     MM5Map->NX, Step);
+	Values = MM5ROWS(MM5Input, j, Scratch);
 	for (y = 0; y < Map->NY; y++)
 	  for (x = 0; x < Map->NX; x++) {
 	    MM5Y = (int) ((y + MM5Map->OffsetY) * Map->DY / MM5Map->DY);
 	    MM5X = (int) ((x - MM5Map->OffsetX) * Map->DX / MM5Map->DY);
-	    MM5Input[j][y][x] = Array[MM5Y * MM5Map->NX + MM5X];
+	    Values[y][x] = Array[(size_t) MM5Y * MM5Map->NX + MM5X];
 	  }
+	STOREMM5(MM5Input, j, Scratch, Map->NY, Map->NX);
       }
     }
-    free(Array);
+    FreeMap(Array);
+#ifdef COMPACT_MAPS
+    for (y = 0; y < Map->NY; y++)
+      free(Scratch[y]);
+    free(Scratch);
+#endif
   }
 /*end if MM5*/
 
@@ -340,10 +378,13 @@ void InitNewStep(INPUTFILES *InFiles, MAPSIZE *Map, TIMESTRUCT *Time,
       for (x = 0; x < Map->NX; x++) {
 	if (INBASIN(TopoMap[y][x].Mask)) {
 	  SoilMap[y][x].WaterLevel =
-	    TopoMap[y][x].Dem - SoilMap[y][x].TableDepth;
+	    TOPODEM(TopoMap[y][x]) - SoilMap[y][x].TableDepth;
 	}
       }
     }
+    /* the water levels of the pixels of other MPI ranks next to those of
+       this rank */
+    ExchangeHalo(&(Options->Parallel), SoilMap, offsetof(SOILPIX, WaterLevel));
 /*     HeadSlopeAspect(Map, TopoMap, SoilMap); */
   }
 
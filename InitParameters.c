@@ -27,6 +27,7 @@
 #include "getinit.h"
 #include "constants.h"
 #include "rad.h"
+#include "memtrack.h"
 
 /*****************************************************************************
   Function name: InitParameterss()
@@ -119,19 +120,24 @@ void InitParameters(LISTPTR Input, OPTIONSTRUCT * Options, MAPSIZE * Map,
 	if (INBASIN(TopoMap[y][x].Mask)) {
 	  if ((*Network)[y][x].RoadArea > 0) {
 	    if (!((*Network)[y][x].h = 
-		  (float *) calloc(CELLFACTOR, sizeof(float))))
+		  (float *) TrackedCalloc(CELLFACTOR, sizeof(float),
+					  MEM_SEDIMENT, "RoadErosion")))
 	      ReportError((char *) Routine, 1);
 	    if (!((*Network)[y][x].startRunoff =
-		  (float *) calloc(CELLFACTOR, sizeof(float))))
+		  (float *) TrackedCalloc(CELLFACTOR, sizeof(float),
+					  MEM_SEDIMENT, "RoadErosion")))
 	      ReportError((char *) Routine, 1);
 	    if (!((*Network)[y][x].startRunon =
-		  (float *) calloc(CELLFACTOR, sizeof(float))))
+		  (float *) TrackedCalloc(CELLFACTOR, sizeof(float),
+					  MEM_SEDIMENT, "RoadErosion")))
 	      ReportError((char *) Routine, 1);
 	    if (!((*Network)[y][x].OldSedIn = 
-		  (float *) calloc(CELLFACTOR, sizeof(float))))
+		  (float *) TrackedCalloc(CELLFACTOR, sizeof(float),
+					  MEM_SEDIMENT, "RoadErosion")))
 	      ReportError((char *) Routine, 1);
 	    if (!((*Network)[y][x].OldSedOut =
-		  (float *) calloc(CELLFACTOR, sizeof(float))))
+		  (float *) TrackedCalloc(CELLFACTOR, sizeof(float),
+					  MEM_SEDIMENT, "RoadErosion")))
 	      ReportError((char *) Routine, 1);
 	  }
 	}
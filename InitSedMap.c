@@ -16,6 +16,7 @@
 #include <stdlib.h>
 #include "data.h"
 #include "DHSVMerror.h"
+#include "memtrack.h"
 
 /*****************************************************************************
   InitSedMap()
@@ -24,10 +25,12 @@ void InitSedMap(MAPSIZE *Map, SEDPIX *** SedMap )
 {
   int   y;		/* Counters */
   
-  if (!(*SedMap = (SEDPIX **) calloc(Map->NY, sizeof(SEDPIX *))))
+  if (!(*SedMap = (SEDPIX **) TrackedCalloc(Map->NY, sizeof(SEDPIX *),
+					    MEM_SEDIMENT, "SedMap")))
      ReportError("InitSedMap", 1);
   for (y = 0; y < Map->NY; y++) {
-    if (!((*SedMap)[y] = (SEDPIX *) calloc(Map->NX, sizeof(SEDPIX))))
+    if (!((*SedMap)[y] = (SEDPIX *) TrackedCalloc(Map->NX, sizeof(SEDPIX),
+						  MEM_SEDIMENT, "SedMap")))
       ReportError("InitSedMap", 1);
     }
 }
@@ -20,6 +20,7 @@
 #include "DHSVMerror.h"
 #include "functions.h"
 #include "constants.h"
+#include "memtrack.h"
 
 /*****************************************************************************
   Function name: InitSnowMap()
@@ -44,11 +45,13 @@ void InitSnowMap(MAPSIZE * Map, SNOWPIX *** SnowMap)
 
   printf("Initializing snow map\n");
 
-  if (!(*SnowMap = (SNOWPIX **) calloc(Map->NY, sizeof(SNOWPIX *))))
+  if (!(*SnowMap = (SNOWPIX **) TrackedCalloc(Map->NY, sizeof(SNOWPIX *),
+					      MEM_SNOW, "SnowMap")))
     ReportError((char *) Routine, 1);
 
   for (y = 0; y < Map->NY; y++) {
-    if (!((*SnowMap)[y] = (SNOWPIX *) calloc(Map->NX, sizeof(SNOWPIX))))
+    if (!((*SnowMap)[y] = (SNOWPIX *) TrackedCalloc(Map->NX, sizeof(SNOWPIX),
+						    MEM_SNOW, "SnowMap")))
       ReportError((char *) Routine, 1);
   }
 }
@@ -9,6 +9,7 @@
  * DESCRIPTION:  Initialize terrain coverages
  * DESCRIP-END.
  * FUNCTIONS:    InitTerrainMaps()
+ *               BasinRange()
  *               InitTopoMap()
  *               InitSoilMap()
  *               InitVegMap()
@@ -29,6 +30,11 @@
 #include "sizeofnt.h"
 #include "slopeaspect.h"
 #include "varid.h"
+#include "memtrack.h"
+#include "compact.h"
+
+static void BasinRange(float *Values, int Flipped, MAPSIZE *Map,
+		       TOPOPIX **TopoMap, float *Min, float *Max);
 
 /*****************************************************************************
   InitTerrainMaps()
@@ -43,6 +49,36 @@ void InitTerrainMaps(LISTPTR Input, OPTIONSTRUCT * Options, MAPSIZE * Map,
   InitVegMap(Options,Input, Map, VegMap);
 }
 
+/*****************************************************************************
+  BasinRange()
+
+  Smallest and largest value of a map in the pixels of the basin, which set
+  the scale of a field that is stored in fixed point (compact.h).  Flipped
+  is TRUE if Read2DMatrix() returned the rows of Values in reverse order
+*****************************************************************************/
+static void BasinRange(float *Values, int Flipped, MAPSIZE *Map,
+		       TOPOPIX **TopoMap, float *Min, float *Max)
+{
+  int First = TRUE;		/* TRUE before the first pixel of the basin */
+  long i;			/* index of the pixel in Values */
+  int x;			/* counter */
+  int y;			/* counter */
+
+  *Min = *Max = 0.;
+  for (y = 0; y < Map->NY; y++) {
+    for (x = 0; x < Map->NX; x++) {
+      if (!INBASIN(TopoMap[y][x].Mask))
+	continue;
+      i = (long) (Flipped ? Map->NY - 1 - y : y) * Map->NX + x;
+      if (First || Values[i] < *Min)
+	*Min = Values[i];
+      if (First || Values[i] > *Max)
+	*Max = Values[i];
+      First = FALSE;
+    }
+  }
+}
+
 /*****************************************************************************
   InitTopoMap()
 *****************************************************************************/
@@ -55,9 +91,13 @@ void InitTopoMap(LISTPTR Input, OPTIONSTRUCT * Options, MAPSIZE * Map,
   int x;			/* Counter */
   int y;			/* Counter */
   int flag;         /* either or not reverse the matrix */
+  int demflag;			/* flag of the elevation */
+  float Min;			/* Smallest elevation in the basin */
+  float Max;			/* Largest elevation in the basin */
   int NumberType;		/* Number type of data set */
   unsigned char *Mask = NULL;	/* Basin mask */
   float *Elev;			/* Surface elevation */
+  float **ElevRows;		/* Rows of Elev in the order of the map */
   STRINIENTRY StrEnv[] = {
     {"TERRAIN", "DEM FILE", "", ""},
     {"TERRAIN", "BASIN MASK FILE", "", ""},
@@ -65,10 +105,12 @@ void InitTopoMap(LISTPTR Input, OPTIONSTRUCT * Options, MAPSIZE * Map,
   };
 
   /* Process the [TERRAIN] section in the input file */
-  if (!(*TopoMap = (TOPOPIX **) calloc(Map->NY, sizeof(TOPOPIX *))))
+  if (!(*TopoMap = (TOPOPIX **) TrackedCalloc(Map->NY, sizeof(TOPOPIX *),
+					      MEM_TERRAIN, "TopoMap")))
     ReportError((char *) Routine, 1);
   for (y = 0; y < Map->NY; y++) {
-    if (!((*TopoMap)[y] = (TOPOPIX *) calloc(Map->NX, sizeof(TOPOPIX))))
+    if (!((*TopoMap)[y] = (TOPOPIX *) TrackedCalloc(Map->NX, sizeof(TOPOPIX),
+						    MEM_TERRAIN, "TopoMap")))
       ReportError((char *) Routine, 1);
   }
 
@@ -84,36 +126,18 @@ void InitTopoMap(LISTPTR Input, OPTIONSTRUCT * Options, MAPSIZE * Map,
 
   GetVarName(001, 0, VarName);
   GetVarNumberType(001, &NumberType);
-  if (!(Elev = (float *) calloc(Map->NX * Map->NY,
-				SizeOfNumberType(NumberType))))
+  if (!(Elev = (float *) CallocMap(Map->NY, Map->NX,
+				   SizeOfNumberType(NumberType))))
     ReportError((char *) Routine, 1);
 
-  flag = Read2DMatrix(StrEnv[demfile].VarStr, Elev, NumberType, Map->NY, Map->NX, 0,
-	       VarName, 0);
-
-  /* Assign the attributes to the map pixel */
-  /* Reverse the matrix is flag = 1 & netcdf option is selected */
-  if ((Options->FileFormat == NETCDF && flag == 0) || (Options->FileFormat == BIN))
-  {
-	  for (y = 0, i = 0; y < Map->NY; y++) {
-		  for (x = 0; x < Map->NX; x++, i++) {
-			  (*TopoMap)[y][x].Dem = Elev[i]; }
-	  }
-  }
-  else if (Options->FileFormat == NETCDF && flag == 1){
-	  for (y = Map->NY - 1, i = 0; y >= 0; y--) {
-		  for (x = 0; x < Map->NX; x++, i++) {
-			  (*TopoMap)[y][x].Dem = Elev[i]; }
-	  }
-  }
-  else ReportError((char *) Routine, 57);
-  free(Elev);
+  demflag = Read2DMatrix(StrEnv[demfile].VarStr, Elev, NumberType, Map->NY,
+			 Map->NX, 0, VarName, 0);
 
   /* Read the mask */
   GetVarName(002, 0, VarName);
   GetVarNumberType(002, &NumberType);
-  if (!(Mask = (unsigned char *) calloc(Map->NX * Map->NY,
-					SizeOfNumberType(NumberType))))
+  if (!(Mask = (unsigned char *) CallocMap(Map->NY, Map->NX,
+					   SizeOfNumberType(NumberType))))
     ReportError((char *) Routine, 1);
   flag = Read2DMatrix(StrEnv[maskfile].VarStr, Mask, NumberType, Map->NY, Map->NX, 0,
 	       VarName, 0);
@@ -135,22 +159,62 @@ void InitTopoMap(LISTPTR Input, OPTIONSTRUCT * Options, MAPSIZE * Map,
 	  }
   }
   else ReportError((char *) Routine, 57);
-  free(Mask);
-  
+  FreeMap(Mask);
+
+  /* Assign the attributes to the map pixel, after the mask, which sets the
+     range of the elevation codes with COMPACT_MAPS */
+  BasinRange(Elev, Options->FileFormat == NETCDF && demflag == 1, Map,
+	     *TopoMap, &Min, &Max);
+  SetFixedScale(ELEVATION_CODE, "Basin.DEM", Min, Max);
+  /* Reverse the matrix is flag = 1 & netcdf option is selected */
+  if ((Options->FileFormat == NETCDF && demflag == 0) || (Options->FileFormat == BIN))
+  {
+	  for (y = 0, i = 0; y < Map->NY; y++) {
+		  for (x = 0; x < Map->NX; x++, i++) {
+			  SETTOPODEM((*TopoMap)[y][x], Elev[i]); }
+	  }
+  }
+  else if (Options->FileFormat == NETCDF && demflag == 1){
+	  for (y = Map->NY - 1, i = 0; y >= 0; y--) {
+		  for (x = 0; x < Map->NX; x++, i++) {
+			  SETTOPODEM((*TopoMap)[y][x], Elev[i]); }
+	  }
+  }
+  else ReportError((char *) Routine, 57);
+
   /* Calculate slope, aspect, magnitude of subsurface flow gradient, and 
      fraction of flow flowing in each direction based on the land surface 
-     slope. */
-  ElevationSlopeAspect(Map, *TopoMap);
+     slope.  This uses the elevation as read, the Dem of the pixels is
+     rounded with COMPACT_MAPS */
+  if (!(ElevRows = (float **) calloc(Map->NY, sizeof(float *))))
+    ReportError((char *) Routine, 1);
+  for (y = 0; y < Map->NY; y++) {
+    if (Options->FileFormat == NETCDF && demflag == 1)
+      ElevRows[y] = &(Elev[(long) (Map->NY - 1 - y) * Map->NX]);
+    else
+      ElevRows[y] = &(Elev[(long) y * Map->NX]);
+  }
+  ElevationSlopeAspect(Map, *TopoMap, ElevRows);
+  free(ElevRows);
+  FreeMap(Elev);
 
   
   /* After calculating the slopes and aspects for all the points, reset the 
-     mask if the model is to be run in point mode */
+     mask if the model is to be run in point or multi-point mode */
   if (Options->Extent == POINT) {
     for (y = 0; y < Map->NY; y++)
       for (x = 0; x < Map->NX; x++)
 	(*TopoMap)[y][x].Mask = OUTSIDEBASIN;
     (*TopoMap)[Options->PointY][Options->PointX].Mask = (1 != OUTSIDEBASIN);
   }
+  else if (Options->Extent == MULTIPOINT) {
+    for (y = 0; y < Map->NY; y++)
+      for (x = 0; x < Map->NX; x++)
+	(*TopoMap)[y][x].Mask = OUTSIDEBASIN;
+    for (i = 0; i < Options->NPoints; i++)
+      (*TopoMap)[Options->Points[i].N][Options->Points[i].E].Mask =
+	(1 != OUTSIDEBASIN);
+  }
 }
 
 /*****************************************************************************
@@ -167,6 +231,8 @@ void InitSoilMap(LISTPTR Input, OPTIONSTRUCT * Options, MAPSIZE * Map,
   int NumberType;		/* number type */
   unsigned char *Type;		/* Soil type */
   float *Depth;			/* Soil depth */
+  float Min;			/* Smallest soil depth in the basin */
+  float Max;			/* Largest soil depth in the basin */
   int flag;
   STRINIENTRY StrEnv[] = {
     {"SOILS", "SOIL MAP FILE", "", ""},
@@ -176,26 +242,30 @@ void InitSoilMap(LISTPTR Input, OPTIONSTRUCT * Options, MAPSIZE * Map,
 
   /* Process the filenames in the [SOILS] section in the input file */
   /* Assign the attributes to the correct map pixel */
-  if (!(*SoilMap = (SOILPIX **) calloc(Map->NY, sizeof(SOILPIX *))))
+  if (!(*SoilMap = (SOILPIX **) TrackedCalloc(Map->NY, sizeof(SOILPIX *),
+					      MEM_SOIL, "SoilMap")))
     ReportError((char *) Routine, 1);
   for (y = 0; y < Map->NY; y++) {
-    if (!((*SoilMap)[y] = (SOILPIX *) calloc(Map->NX, sizeof(SOILPIX))))
+    if (!((*SoilMap)[y] = (SOILPIX *) TrackedCalloc(Map->NX, sizeof(SOILPIX),
+						    MEM_SOIL, "SoilMap")))
       ReportError((char *) Routine, 1);
   }
 
-  /* Read the key-entry pairs from the input file */
+  /* Read the key-entry pairs from the input file, the soil depth is only
+     needed when the soil water is simulated */
   for (i = 0; StrEnv[i].SectionName; i++) {
     GetInitString(StrEnv[i].SectionName, StrEnv[i].KeyName, StrEnv[i].Default,
 		  StrEnv[i].VarStr, (unsigned long) BUFSIZE, Input);
-    if (IsEmptyStr(StrEnv[i].VarStr))
+    if (IsEmptyStr(StrEnv[i].VarStr) &&
+	(i == soiltype_file || Options->Components == FULL_MODEL))
       ReportError(StrEnv[i].KeyName, 51);
   }
 
   /* Read the soil type */
   GetVarName(003, 0, VarName);
   GetVarNumberType(003, &NumberType);
-  if (!(Type = (unsigned char *) calloc(Map->NX * Map->NY,
-					SizeOfNumberType(NumberType))))
+  if (!(Type = (unsigned char *) CallocMap(Map->NY, Map->NX,
+					   SizeOfNumberType(NumberType))))
     ReportError((char *) Routine, 1);
   flag = Read2DMatrix(StrEnv[soiltype_file].VarStr, Type, NumberType, Map->NY,
 	       Map->NX, 0, VarName, 0);
@@ -220,28 +290,39 @@ void InitSoilMap(LISTPTR Input, OPTIONSTRUCT * Options, MAPSIZE * Map,
   }
   else ReportError((char *) Routine, 57);
 
+  /* In SNOW_MODEL and MET_MODEL runs only the soil type is used (for the
+     albedo of the soil surface), the soil depth and the layer arrays are
+     not read or allocated and the layer pointers stay NULL */
+  if (Options->Components != FULL_MODEL) {
+    FreeMap(Type);
+    return;
+  }
+
   /* Read the total soil depth  */
   GetVarName(004, 0, VarName);
   GetVarNumberType(004, &NumberType);
-  if (!(Depth = (float *) calloc(Map->NX * Map->NY,
-				 SizeOfNumberType(NumberType))))
+  if (!(Depth = (float *) CallocMap(Map->NY, Map->NX,
+				    SizeOfNumberType(NumberType))))
     ReportError((char *) Routine, 1);
   flag = Read2DMatrix(StrEnv[soildepth_file].VarStr, Depth, NumberType, Map->NY,
 	       Map->NX, 0, VarName, 0);
 
   /* Assign the attributes to the correct map pixel */
+  BasinRange(Depth, Options->FileFormat == NETCDF && flag == 1, Map,
+	     TopoMap, &Min, &Max);
+  SetFixedScale(SOILDEPTH_CODE, "Soil.Depth", Min, Max);
   if ((Options->FileFormat == NETCDF && flag == 0) 
 	  || (Options->FileFormat == BIN))
   {
 	  for (y = 0, i = 0; y < Map->NY; y++) {
 		  for (x = 0; x < Map->NX; x++, i++) {
-			  (*SoilMap)[y][x].Depth = Depth[i]; }
+			  SETSOILDEPTH((*SoilMap)[y][x], Depth[i]); }
 	  }
   }
   else if (Options->FileFormat == NETCDF && flag == 1){
 	  for (y = Map->NY - 1, i = 0; y >= 0; y--) {
 		  for (x = 0; x < Map->NX; x++, i++) {
-			  (*SoilMap)[y][x].Depth = Depth[i]; }
+			  SETSOILDEPTH((*SoilMap)[y][x], Depth[i]); }
 	  }
   }
   else ReportError((char *) Routine, 57);
@@ -256,13 +337,19 @@ void InitSoilMap(LISTPTR Input, OPTIONSTRUCT * Options, MAPSIZE * Map,
 	  layer below the deepest root layer */
 	  if (INBASIN(TopoMap[y][x].Mask)) {
 		  if (!((*SoilMap)[y][x].Moist = 
-			  (float *) calloc((Soil->NLayers[Type[i] - 1] + 1), sizeof(float))))
+			  (float *) TrackedCalloc((Soil->NLayers[Type[i] - 1] + 1),
+						  sizeof(float), MEM_SOIL,
+						  "SoilMap")))
 			  ReportError((char *) Routine, 1);
 		  if (!((*SoilMap)[y][x].Perc =
-			  (float *) calloc(Soil->NLayers[Type[i] - 1], sizeof(float))))
+			  (float *) TrackedCalloc(Soil->NLayers[Type[i] - 1],
+						  sizeof(float), MEM_SOIL,
+						  "SoilMap")))
 			  ReportError((char *) Routine, 1);
 		  if (!((*SoilMap)[y][x].Temp =
-			  (float *) calloc(Soil->NLayers[Type[i] - 1], sizeof(float))))
+			  (float *) TrackedCalloc(Soil->NLayers[Type[i] - 1],
+						  sizeof(float), MEM_SOIL,
+						  "SoilMap")))
 			  ReportError((char *) Routine, 1);
 	  }
       else {
@@ -272,8 +359,8 @@ void InitSoilMap(LISTPTR Input, OPTIONSTRUCT * Options, MAPSIZE * Map,
       }
     }
   }
-  free(Type);
-  free(Depth);
+  FreeMap(Type);
+  FreeMap(Depth);
 }
 
 /*****************************************************************************
@@ -300,16 +387,18 @@ void InitVegMap(OPTIONSTRUCT * Options, LISTPTR Input, MAPSIZE * Map, VEGPIX ***
   /* Read the vegetation type */
   GetVarName(005, 0, VarName);
   GetVarNumberType(005, &NumberType);
-  if (!(Type = (unsigned char *) calloc(Map->NX * Map->NY,
-					SizeOfNumberType(NumberType))))
+  if (!(Type = (unsigned char *) CallocMap(Map->NY, Map->NX,
+					   SizeOfNumberType(NumberType))))
     ReportError((char *) Routine, 1);
   flag = Read2DMatrix(VegMapFileName, Type, NumberType, Map->NY, Map->NX, 0, VarName, 0);
 
   /* Assign the attributes to the correct map pixel */
-  if (!(*VegMap = (VEGPIX **) calloc(Map->NY, sizeof(VEGPIX *))))
+  if (!(*VegMap = (VEGPIX **) TrackedCalloc(Map->NY, sizeof(VEGPIX *),
+					    MEM_VEGETATION, "VegMap")))
     ReportError((char *) Routine, 1);
   for (y = 0; y < Map->NY; y++) {
-    if (!((*VegMap)[y] = (VEGPIX *) calloc(Map->NX, sizeof(VEGPIX))))
+    if (!((*VegMap)[y] = (VEGPIX *) TrackedCalloc(Map->NX, sizeof(VEGPIX),
+						  MEM_VEGETATION, "VegMap")))
       ReportError((char *) Routine, 1);
   }
 
@@ -333,7 +422,7 @@ void InitVegMap(OPTIONSTRUCT * Options, LISTPTR Input, MAPSIZE * Map, VEGPIX ***
   }
   else ReportError((char *) Routine, 57);
 
-  free(Type);
+  FreeMap(Type);
 }
 
 
@@ -22,6 +22,7 @@
 #include "data.h"
 #include "DHSVMerror.h"
 #include "functions.h"
+#include "memtrack.h"
 #include "fileio.h"
 #include "getinit.h"
 #include "sizeofnt.h"
@@ -77,8 +78,8 @@ void InitUnitHydrograph(LISTPTR Input, MAPSIZE * Map, TOPOPIX ** TopoMap,
   /* Read the travel times */
   GetVarName(006, 0, VarName);
   GetVarNumberType(006, &NumberType);
-  if (!(Travel = (unsigned short *) calloc(Map->NX * Map->NY,
-					   SizeOfNumberType(NumberType))))
+  if (!(Travel = (unsigned short *) CallocMap(Map->NY, Map->NX,
+					      SizeOfNumberType(NumberType))))
     ReportError((char *) Routine, 1);
 
   Read2DMatrix(StrEnv[travel_file].VarStr, Travel, NumberType, Map->NY,
@@ -88,7 +89,7 @@ void InitUnitHydrograph(LISTPTR Input, MAPSIZE * Map, TOPOPIX ** TopoMap,
   for (y = 0, i = 0; y < Map->NY; y++)
     for (x = 0; x < Map->NX; x++, i++)
       TopoMap[y][x].Travel = Travel[i];
-  free(Travel);
+  FreeMap(Travel);
 
   /* Read the unit hydrograph file */
   OpenFile(&HydrographFile, StrEnv[hydrograph_file].VarStr, "r", FALSE);
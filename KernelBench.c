@@ -0,0 +1,891 @@
+/*
+ * SUMMARY:      KernelBench.c - Microbenchmark for the physics and routing
+ *               kernels
+ * USAGE:        KernelBench [-n samples] [-repeat n] [-seed n]
+ *                           [-kernels name,name,...] [-cpu level]
+ *                           [-stations n]
+ *
+ * AUTHOR:       DHSVM development team
+ * ORG:          University of Washington, Department of Civil Engineering
+ * E-MAIL:
+ * ORIG-DATE:    Oct-2026
+ * DESCRIPTION:  Calls the individual kernels of the model on arrays of
+ *               synthesized inputs and reports the time per call and the
+ *               distribution of the result.  The inputs are drawn from the
+ *               ranges the kernels see in a mountain basin run, and derived
+ *               quantities (vapor pressure, air density, ...) are computed
+ *               the way MakeLocalMetData() does.  The kernels are
+ *                 snowmelt          - SnowMelt(), snow pack energy balance
+ *                 unsaturated       - UnsaturatedFlow(), three soil layers
+ *                 transmissivity    - CalcTransmissivities(), the
+ *                                     dispatched kernel of RouteSubSurface()
+ *                 evapotranspiration - EvapoTranspiration(), overstory
+ *                 bagnold           - CalcBagnold(), channel sediment capacity
+ *                 channel           - channel_route_network(), per segment
+ *                 safetyfactor      - CalcSafetyFactor(), stochastic
+ *                 interpolation     - InterpolateStations(), weighted sums
+ *                                     over the stations for a pixel
+ *               -cpu caps the instruction set of the vector kernels
+ *               (scalar, sse4.2, avx2, avx512), see dispatch.h.
+ * DESCRIP-END.
+ * FUNCTIONS:    main()
+ * COMMENTS:     Kernels that update their state get a fresh copy of the
+ *               initial state before every repeat, outside the timed loop.
+ *               The result distribution is taken from the last repeat.
+ *               channel_route_segment() is local to channel.c, the channel
+ *               kernel routes a random tree of segments through
+ *               channel_route_network() and reports the time per segment.
+ * $Id: KernelBench.c,v 1.0 2026/10/17 Exp $
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "settings.h"
+#include "constants.h"
+#include "data.h"
+#include "DHSVMChannel.h"
+#include "DHSVMerror.h"
+#include "functions.h"
+#include "massenergy.h"
+#include "snow.h"
+#include "soilmoisture.h"
+#include "dispatch.h"
+
+#define NLAYERS   3		/* soil layers in the synthesized soil columns */
+#define NTYPES    4		/* synthesized soil and vegetation types */
+#define DT        3600		/* model time step (s) */
+#define CELLSIZE  90.		/* grid cell size (m) */
+
+typedef struct {
+  char *Name;			/* kernel name on the command line */
+  char *Output;			/* result that is summarized */
+  int (*Bench) (int N, int Repeats, float *Out, double *Time);
+} KERNEL;
+
+static int BenchSnowMelt(int N, int Repeats, float *Out, double *Time);
+static int BenchUnsaturated(int N, int Repeats, float *Out, double *Time);
+static int BenchTransmissivity(int N, int Repeats, float *Out, double *Time);
+static int BenchEvapoTranspiration(int N, int Repeats, float *Out,
+				   double *Time);
+static int BenchBagnold(int N, int Repeats, float *Out, double *Time);
+static int BenchChannel(int N, int Repeats, float *Out, double *Time);
+static int BenchSafetyFactor(int N, int Repeats, float *Out, double *Time);
+static int BenchInterpolation(int N, int Repeats, float *Out, double *Time);
+
+static KERNEL Kernel[] = {
+  {"snowmelt", "melt outflow (mm)", BenchSnowMelt},
+  {"unsaturated", "water table depth (m)", BenchUnsaturated},
+  {"transmissivity", "transmissivity (m2/s)", BenchTransmissivity},
+  {"evapotranspiration", "total ET (mm)", BenchEvapoTranspiration},
+  {"bagnold", "capacity (kg/s)", BenchBagnold},
+  {"channel", "outflow (m3/s)", BenchChannel},
+  {"safetyfactor", "factor of safety", BenchSafetyFactor},
+  {"interpolation", "air temperature (C)", BenchInterpolation}
+};
+#define NKERNELS ((int) (sizeof(Kernel) / sizeof(KERNEL)))
+
+static unsigned long long RandomState;
+static int NStations = 32;	/* stations of the interpolation kernel */
+
+static double Clock(void);
+static double Uniform(double Min, double Max);
+static void SampleMet(PIXMET *Met, float TMin, float TMax);
+static void *Allocate(size_t N, size_t Size);
+static int CompareFloat(const void *A, const void *B);
+static void Usage(char *Program);
+
+/*****************************************************************************
+  main()
+*****************************************************************************/
+int main(int argc, char **argv)
+{
+  char KernelList[BUFSIZE + 1] = "";
+  char *Item;
+  float *Out;
+  double Time;
+  double Sum;
+  int Selected[NKERNELS];
+  int N = 100000;
+  int Repeats = 5;
+  int Cpu = CPU_AUTO;
+  long Seed = 1;
+  int Calls;
+  int i;
+  int k;
+
+  for (i = 1; i < argc; i++) {
+    if (i + 1 >= argc)
+      Usage(argv[0]);
+    if (strcmp(argv[i], "-n") == 0)
+      N = atoi(argv[++i]);
+    else if (strcmp(argv[i], "-repeat") == 0)
+      Repeats = atoi(argv[++i]);
+    else if (strcmp(argv[i], "-seed") == 0)
+      Seed = atol(argv[++i]);
+    else if (strcmp(argv[i], "-kernels") == 0)
+      strncpy(KernelList, argv[++i], BUFSIZE);
+    else if (strcmp(argv[i], "-stations") == 0)
+      NStations = atoi(argv[++i]);
+    else if (strcmp(argv[i], "-cpu") == 0) {
+      i++;
+      if (strcmp(argv[i], "scalar") == 0)
+	Cpu = CPU_SCALAR;
+      else if (strcmp(argv[i], "sse4.2") == 0)
+	Cpu = CPU_SSE42;
+      else if (strcmp(argv[i], "avx2") == 0)
+	Cpu = CPU_AVX2;
+      else if (strcmp(argv[i], "avx512") == 0)
+	Cpu = CPU_AVX512;
+      else
+	Usage(argv[0]);
+    }
+    else
+      Usage(argv[0]);
+  }
+  if (N < 1 || Repeats < 1 || NStations < 1)
+    Usage(argv[0]);
+
+  for (k = 0; k < NKERNELS; k++)
+    Selected[k] = (KernelList[0] == '\0');
+  for (Item = strtok(KernelList, ","); Item; Item = strtok(NULL, ",")) {
+    for (k = 0; k < NKERNELS && strcmp(Item, Kernel[k].Name); k++) ;
+    if (k == NKERNELS)
+      Usage(argv[0]);
+    Selected[k] = TRUE;
+  }
+
+  /* the model constants the kernels depend on, as in the default
+     configuration file */
+  InitSatVaporTable();
+  LIQUID_WATER_CAPACITY = 0.03;
+  Z0_SNOW = 0.01;
+  MASSITER = 1;
+  srand48(Seed);
+
+  Out = (float *) Allocate(N, sizeof(float));
+
+  printf("\nDHSVM kernel benchmark, %d samples, %d repeats, %s kernels\n",
+	 N, Repeats, CpuName(InitDispatch(Cpu)));
+  printf("%-18s %10s %10s %11s %11s %11s %11s  %s\n", "Kernel", "Calls",
+	 "ns/call", "min", "median", "mean", "max", "Result");
+  for (k = 0; k < NKERNELS; k++) {
+    if (!Selected[k])
+      continue;
+    RandomState = 0x9E3779B97F4A7C15ULL ^ (unsigned long long) Seed;
+    Time = 0.;
+    Calls = Kernel[k].Bench(N, Repeats, Out, &Time);
+    for (i = 0, Sum = 0.; i < Calls; i++)
+      Sum += Out[i];
+    qsort(Out, Calls, sizeof(float), CompareFloat);
+    printf("%-18s %10ld %10.1f %11.4g %11.4g %11.4g %11.4g  %s\n",
+	   Kernel[k].Name, (long) Calls * Repeats,
+	   1e9 * Time / ((double) Calls * Repeats), Out[0], Out[Calls / 2],
+	   Sum / Calls, Out[Calls - 1], Kernel[k].Output);
+  }
+
+  free(Out);
+  return EXIT_SUCCESS;
+}
+
+/*****************************************************************************
+  BenchSnowMelt() - snow packs between -15 and 5 C, with and without new
+  snow or rain
+*****************************************************************************/
+static int BenchSnowMelt(int N, int Repeats, float *Out, double *Time)
+{
+  typedef struct {
+    PIXMET Met;
+    float BaseRa;
+    float ShortRad;
+    float RainFall;
+    float SnowFall;
+    float PackWater;
+    float SurfWater;
+    float Swq;
+    float TPack;
+    float TSurf;
+  } SNOWSAMPLE;
+  SNOWSAMPLE *Init;
+  SNOWSAMPLE *S;
+  float VaporMassFlux;
+  float MeltEnergy;
+  double Start;
+  int r;
+  int i;
+
+  Init = (SNOWSAMPLE *) Allocate(N, sizeof(SNOWSAMPLE));
+  S = (SNOWSAMPLE *) Allocate(N, sizeof(SNOWSAMPLE));
+
+  for (i = 0; i < N; i++) {
+    SampleMet(&(Init[i].Met), -15., 5.);
+    Init[i].BaseRa = log((2. + Z0_SNOW) / Z0_SNOW) *
+      log((2. + Z0_SNOW) / Z0_SNOW) /
+      (VON_KARMAN * VON_KARMAN * Init[i].Met.Wind);
+    Init[i].ShortRad = Uniform(0., 1.) < 0.4 ? 0. : Uniform(0., 400.);
+    Init[i].RainFall = 0.;
+    Init[i].SnowFall = 0.;
+    if (Uniform(0., 1.) < 0.3) {
+      if (Init[i].Met.Tair > 0.5)
+	Init[i].RainFall = Uniform(0., 0.005);
+      else
+	Init[i].SnowFall = Uniform(0., 0.005);
+    }
+    Init[i].Swq = Uniform(0.01, 1.0);
+    Init[i].TPack = Uniform(-5., 0.);
+    Init[i].TSurf = Uniform(-5., 0.);
+    if (Init[i].Met.Tair > 0.) {
+      Init[i].TPack = 0.;
+      Init[i].TSurf = 0.;
+    }
+    Init[i].PackWater = (Init[i].TPack < 0.) ? 0. :
+      Uniform(0., LIQUID_WATER_CAPACITY) * (Init[i].Swq - MAX_SURFACE_SWE);
+    if (Init[i].PackWater < 0.)
+      Init[i].PackWater = 0.;
+    Init[i].SurfWater = (Init[i].TSurf < 0.) ? 0. :
+      Uniform(0., LIQUID_WATER_CAPACITY) * MAX_SURFACE_SWE;
+  }
+
+  for (r = 0; r < Repeats; r++) {
+    memcpy(S, Init, N * sizeof(SNOWSAMPLE));
+    Start = Clock();
+    for (i = 0; i < N; i++)
+      Out[i] = SnowMelt(0, i, DT, 2. + Z0_SNOW, 0.f, Z0_SNOW, S[i].BaseRa,
+			S[i].Met.AirDens, S[i].Met.Eact, S[i].Met.Lv,
+			S[i].ShortRad, S[i].Met.Lin, S[i].Met.Press,
+			S[i].RainFall, S[i].SnowFall, S[i].Met.Tair,
+			S[i].Met.Vpd, S[i].Met.Wind, &(S[i].PackWater),
+			&(S[i].SurfWater), &(S[i].Swq), &VaporMassFlux,
+			&(S[i].TPack), &(S[i].TSurf), &MeltEnergy);
+    *Time += Clock() - Start;
+  }
+
+  for (i = 0; i < N; i++)
+    Out[i] *= 1000.;
+
+  free(Init);
+  free(S);
+  return N;
+}
+
+/*****************************************************************************
+  BenchUnsaturated() - three layer soil columns with the water table
+  anywhere between the surface and the bottom of the column
+*****************************************************************************/
+static int BenchUnsaturated(int N, int Repeats, float *Out, double *Time)
+{
+  float RootDepth[NTYPES][NLAYERS];
+  float Ks[NTYPES][NLAYERS];
+  float PoreDist[NTYPES][NLAYERS];
+  float Porosity[NTYPES][NLAYERS];
+  float FCap[NTYPES][NLAYERS];
+  float TotalDepth[NTYPES];
+  float PercArea[NLAYERS] = { 1., 1., 1. };
+  float Adjust[NLAYERS + 1] = { 1., 1., 1., 1. };
+  float *Infiltration;
+  float *SatFlow;
+  int *Type;
+  float *InitMoist;
+  float *InitPerc;
+  float *InitTable;
+  float *Moist;
+  float *Perc;
+  float *Table;
+  float Runoff;
+  float RoadIExcess;
+  double Start;
+  int r;
+  int i;
+  int j;
+  int t;
+
+  for (t = 0; t < NTYPES; t++) {
+    TotalDepth[t] = Uniform(1.0, 3.0);
+    for (j = 0; j < NLAYERS; j++) {
+      RootDepth[t][j] = Uniform(0.1, 0.3);
+      Ks[t][j] = Uniform(1e-6, 1e-4) / (j + 1);
+      PoreDist[t][j] = Uniform(0.15, 0.4);
+      Porosity[t][j] = Uniform(0.4, 0.5);
+      FCap[t][j] = Uniform(0.2, 0.3);
+    }
+  }
+
+  Infiltration = (float *) Allocate(N, sizeof(float));
+  SatFlow = (float *) Allocate(N, sizeof(float));
+  Type = (int *) Allocate(N, sizeof(int));
+  InitMoist = (float *) Allocate(N * (NLAYERS + 1), sizeof(float));
+  InitPerc = (float *) Allocate(N * NLAYERS, sizeof(float));
+  InitTable = (float *) Allocate(N, sizeof(float));
+  Moist = (float *) Allocate(N * (NLAYERS + 1), sizeof(float));
+  Perc = (float *) Allocate(N * NLAYERS, sizeof(float));
+  Table = (float *) Allocate(N, sizeof(float));
+
+  for (i = 0; i < N; i++) {
+    t = Type[i] = (int) Uniform(0., NTYPES);
+    Infiltration[i] = Uniform(0., 1.) < 0.7 ? 0. : Uniform(0., 0.005);
+    SatFlow[i] = Uniform(-0.002, 0.002);
+    InitTable[i] = Uniform(0., TotalDepth[t]);
+    for (j = 0; j <= NLAYERS; j++)
+      InitMoist[i * (NLAYERS + 1) + j] = Uniform(0.15, 0.5);
+    for (j = 0; j < NLAYERS; j++)
+      InitPerc[i * NLAYERS + j] = Uniform(0., 1e-4);
+  }
+
+  for (r = 0; r < Repeats; r++) {
+    memcpy(Moist, InitMoist, N * (NLAYERS + 1) * sizeof(float));
+    memcpy(Perc, InitPerc, N * NLAYERS * sizeof(float));
+    memcpy(Table, InitTable, N * sizeof(float));
+    Start = Clock();
+    for (i = 0; i < N; i++) {
+      t = Type[i];
+      Runoff = 0.;
+      RoadIExcess = 0.;
+      UnsaturatedFlow(DT, CELLSIZE, CELLSIZE, Infiltration[i], 0.,
+		      SatFlow[i], NLAYERS, TotalDepth[t],
+		      CELLSIZE * CELLSIZE, RootDepth[t], Ks[t], PoreDist[t],
+		      Porosity[t], FCap[t], &(Perc[i * NLAYERS]), PercArea,
+		      Adjust, 0, 0., &(Table[i]), &Runoff,
+		      &(Moist[i * (NLAYERS + 1)]), FALSE, STATIC,
+		      &RoadIExcess);
+    }
+    *Time += Clock() - Start;
+  }
+
+  memcpy(Out, Table, N * sizeof(float));
+
+  free(Infiltration);
+  free(SatFlow);
+  free(Type);
+  free(InitMoist);
+  free(InitPerc);
+  free(InitTable);
+  free(Moist);
+  free(Perc);
+  free(Table);
+  return N;
+}
+
+/*****************************************************************************
+  BenchTransmissivity() - exponential and linear decay of the lateral
+  conductivity, water table above and below the threshold depth
+*****************************************************************************/
+static int BenchTransmissivity(int N, int Repeats, float *Out, double *Time)
+{
+  float *SoilDepth;
+  float *WaterTable;
+  float *LateralKs;
+  float *KsExponent;
+  float *DepthThresh;
+  double Start;
+  int r;
+  int i;
+
+  SoilDepth = (float *) Allocate(N, sizeof(float));
+  WaterTable = (float *) Allocate(N, sizeof(float));
+  LateralKs = (float *) Allocate(N, sizeof(float));
+  KsExponent = (float *) Allocate(N, sizeof(float));
+  DepthThresh = (float *) Allocate(N, sizeof(float));
+
+  for (i = 0; i < N; i++) {
+    SoilDepth[i] = Uniform(0.5, 3.0);
+    WaterTable[i] = Uniform(0., SoilDepth[i]);
+    LateralKs[i] = Uniform(1e-5, 1e-3);
+    KsExponent[i] = Uniform(0., 1.) < 0.1 ? 0. : Uniform(0.5, 5.);
+    DepthThresh[i] = Uniform(0.5, 1.) * SoilDepth[i];
+  }
+
+  for (r = 0; r < Repeats; r++) {
+    Start = Clock();
+    CalcTransmissivities(N, SoilDepth, WaterTable, LateralKs, KsExponent,
+			 DepthThresh, Out);
+    *Time += Clock() - Start;
+  }
+
+  free(SoilDepth);
+  free(WaterTable);
+  free(LateralKs);
+  free(KsExponent);
+  free(DepthThresh);
+  return N;
+}
+
+/*****************************************************************************
+  BenchEvapoTranspiration() - overstory transpiration and evaporation of
+  intercepted water from a partly wet canopy
+*****************************************************************************/
+static int BenchEvapoTranspiration(int N, int Repeats, float *Out,
+				   double *Time)
+{
+  VEGTABLE VType[NTYPES];
+  SOILTABLE SType[NTYPES];
+  float Fract[NTYPES][2];
+  float MaxInt[NTYPES][2];
+  float LAI[NTYPES][2];
+  float RsMin[NTYPES][2];
+  float RsMax[NTYPES][2];
+  float Rpc[NTYPES][2];
+  float VpdThres[NTYPES][2];
+  float MoistThres[NTYPES][2];
+  float RootFractData[NTYPES][2][NLAYERS];
+  float *RootFract[NTYPES][2];
+  float RootDepth[NTYPES][NLAYERS];
+  float WP[NTYPES][NLAYERS];
+  float Adjust[NLAYERS] = { 1., 1., 1. };
+  float EPot[2];
+  float EAct[2];
+  float EInt[2];
+  float ESoilData[2][NLAYERS];
+  float *ESoil[2] = { ESoilData[0], ESoilData[1] };
+  EVAPPIX Evap;
+  SOILPIX Soil;
+  PIXMET *Met;
+  float *NetRad;
+  float *Rp;
+  float *Ra;
+  int *Type;
+  float *InitInt;
+  float *InitMoist;
+  float *Int;
+  float *Moist;
+  float *Temp;
+  double Start;
+  int r;
+  int i;
+  int j;
+  int l;
+  int t;
+
+  memset(VType, 0, sizeof(VType));
+  memset(SType, 0, sizeof(SType));
+  for (t = 0; t < NTYPES; t++) {
+    for (l = 0; l < 2; l++) {
+      Fract[t][l] = Uniform(0.5, 1.);
+      LAI[t][l] = Uniform(1., 6.);
+      MaxInt[t][l] = 0.0001 * LAI[t][l] * Fract[t][l];
+      RsMin[t][l] = Uniform(100., 300.);
+      RsMax[t][l] = 5000.;
+      Rpc[t][l] = Uniform(0.05, 0.15);
+      VpdThres[t][l] = Uniform(3000., 4000.);
+      MoistThres[t][l] = Uniform(0.25, 0.35);
+      RootFract[t][l] = RootFractData[t][l];
+      for (j = 0; j < NLAYERS; j++)
+	RootFractData[t][l][j] = (j == 0) ? 0.4 : 0.3;
+    }
+    for (j = 0; j < NLAYERS; j++) {
+      RootDepth[t][j] = Uniform(0.1, 0.3);
+      WP[t][j] = Uniform(0.08, 0.15);
+    }
+    VType[t].NVegLayers = 2;
+    VType[t].NSoilLayers = NLAYERS;
+    VType[t].Fract = Fract[t];
+    VType[t].MaxInt = MaxInt[t];
+    VType[t].LAI = LAI[t];
+    VType[t].RsMin = RsMin[t];
+    VType[t].RsMax = RsMax[t];
+    VType[t].Rpc = Rpc[t];
+    VType[t].VpdThres = VpdThres[t];
+    VType[t].MoistThres = MoistThres[t];
+    VType[t].RootFract = RootFract[t];
+    VType[t].RootDepth = RootDepth[t];
+    SType[t].NLayers = NLAYERS;
+    SType[t].WP = WP[t];
+  }
+
+  Met = (PIXMET *) Allocate(N, sizeof(PIXMET));
+  NetRad = (float *) Allocate(N, sizeof(float));
+  Rp = (float *) Allocate(N, sizeof(float));
+  Ra = (float *) Allocate(N, sizeof(float));
+  Type = (int *) Allocate(N, sizeof(int));
+  InitInt = (float *) Allocate(N, sizeof(float));
+  InitMoist = (float *) Allocate(N * NLAYERS, sizeof(float));
+  Int = (float *) Allocate(N, sizeof(float));
+  Moist = (float *) Allocate(N * NLAYERS, sizeof(float));
+  Temp = (float *) Allocate(N * NLAYERS, sizeof(float));
+
+  for (i = 0; i < N; i++) {
+    SampleMet(&(Met[i]), 0., 30.);
+    t = Type[i] = (int) Uniform(0., NTYPES);
+    NetRad[i] = Uniform(-50., 500.);
+    Rp[i] = NetRad[i] > 0. ? 0.5 * NetRad[i] : 0.;
+    Ra[i] = Uniform(5., 100.);
+    InitInt[i] = Uniform(0., 1.) < 0.5 ? 0. : Uniform(0., MaxInt[t][0]);
+    for (j = 0; j < NLAYERS; j++) {
+      InitMoist[i * NLAYERS + j] = Uniform(0.1, 0.45);
+      Temp[i * NLAYERS + j] = Uniform(0., 20.);
+    }
+  }
+
+  memset(&Evap, 0, sizeof(EVAPPIX));
+  memset(&Soil, 0, sizeof(SOILPIX));
+  Evap.EPot = EPot;
+  Evap.EAct = EAct;
+  Evap.EInt = EInt;
+  Evap.ESoil = ESoil;
+
+  for (r = 0; r < Repeats; r++) {
+    memcpy(Int, InitInt, N * sizeof(float));
+    memcpy(Moist, InitMoist, N * NLAYERS * sizeof(float));
+    Start = Clock();
+    for (i = 0; i < N; i++) {
+      Soil.Moist = &(Moist[i * NLAYERS]);
+      Soil.Temp = &(Temp[i * NLAYERS]);
+      Evap.ETot = 0.;
+      EvapoTranspiration(0, DT, &(Met[i]), NetRad[i], Rp[i],
+			 &(VType[Type[i]]), &(SType[Type[i]]), 0., &Soil,
+			 &(Int[i]), &Evap, Adjust, Ra[i]);
+      Out[i] = Evap.ETot;
+    }
+    *Time += Clock() - Start;
+  }
+
+  for (i = 0; i < N; i++)
+    Out[i] *= 1000.;
+
+  free(Met);
+  free(NetRad);
+  free(Rp);
+  free(Ra);
+  free(Type);
+  free(InitInt);
+  free(InitMoist);
+  free(Int);
+  free(Moist);
+  free(Temp);
+  return N;
+}
+
+/*****************************************************************************
+  BenchBagnold() - sand and gravel in channels from headwater streams to
+  small rivers
+*****************************************************************************/
+static int BenchBagnold(int N, int Repeats, float *Out, double *Time)
+{
+  TIMESTRUCT Step;
+  float *DS;
+  float *Outflow;
+  float *Width;
+  float *Manning;
+  float *Slope;
+  double Start;
+  int r;
+  int i;
+
+  memset(&Step, 0, sizeof(TIMESTRUCT));
+  Step.Dt = DT;
+
+  DS = (float *) Allocate(N, sizeof(float));
+  Outflow = (float *) Allocate(N, sizeof(float));
+  Width = (float *) Allocate(N, sizeof(float));
+  Manning = (float *) Allocate(N, sizeof(float));
+  Slope = (float *) Allocate(N, sizeof(float));
+
+  for (i = 0; i < N; i++) {
+    DS[i] = 0.062 * pow(1000., Uniform(0., 1.)) * MMTOM;
+    Outflow[i] = exp(Uniform(log(0.01), log(50.))) * DT;
+    Width[i] = Uniform(1., 20.);
+    Manning[i] = Uniform(0.03, 0.08);
+    Slope[i] = exp(Uniform(log(0.001), log(0.1)));
+  }
+
+  for (r = 0; r < Repeats; r++) {
+    Start = Clock();
+    for (i = 0; i < N; i++)
+      Out[i] = CalcBagnold(DS[i], &Step, Outflow[i], Width[i], Manning[i],
+			   Slope[i]);
+    *Time += Clock() - Start;
+  }
+
+  free(DS);
+  free(Outflow);
+  free(Width);
+  free(Manning);
+  free(Slope);
+  return N;
+}
+
+/*****************************************************************************
+  BenchChannel() - random channel tree, every segment drains to a segment
+  with a lower number and segment 0 is the outlet
+*****************************************************************************/
+static int BenchChannel(int N, int Repeats, float *Out, double *Time)
+{
+  ChannelClass Class[NTYPES];
+  Channel *Segment;
+  float *Lateral;
+  double Start;
+  int r;
+  int i;
+
+  memset(Class, 0, sizeof(Class));
+  for (i = 0; i < NTYPES; i++) {
+    Class[i].id = i + 1;
+    Class[i].width = 1. + 3. * i;
+    Class[i].bank_height = 0.5 + 0.5 * i;
+    Class[i].friction = 0.05 - 0.005 * i;
+  }
+
+  Segment = (Channel *) Allocate(N, sizeof(Channel));
+  Lateral = (float *) Allocate(N, sizeof(float));
+
+  for (i = 0; i < N; i++) {
+    Segment[i].id = i + 1;
+    Segment[i].length = Uniform(CELLSIZE, 5 * CELLSIZE);
+    Segment[i].slope = exp(Uniform(log(0.001), log(0.2)));
+    Segment[i].class2 = &(Class[(int) Uniform(0., NTYPES)]);
+    Segment[i].outlet = (i == 0) ? NULL :
+      &(Segment[(int) Uniform(0., i)]);
+    Segment[i].next = (i == N - 1) ? NULL : &(Segment[i + 1]);
+    Lateral[i] = Uniform(0., 0.05) * DT;
+  }
+
+  /* upstream segments are routed first */
+  for (i = N - 1; i >= 0; i--) {
+    if (Segment[i].order == 0)
+      Segment[i].order = 1;
+    if (Segment[i].outlet != NULL &&
+	Segment[i].outlet->order < Segment[i].order + 1)
+      Segment[i].outlet->order = Segment[i].order + 1;
+  }
+  channel_routing_parameters(Segment, DT);
+
+  for (r = 0; r < Repeats; r++) {
+    for (i = 0; i < N; i++) {
+      Segment[i].storage = 0.;
+      Segment[i].outflow = 0.;
+      Segment[i].lateral_inflow = 0.;
+    }
+    channel_step_initialize_network(Segment);
+    for (i = 0; i < N; i++)
+      Segment[i].lateral_inflow = Lateral[i];
+    Start = Clock();
+    channel_route_network(Segment, DT);
+    *Time += Clock() - Start;
+  }
+
+  for (i = 0; i < N; i++)
+    Out[i] = Segment[i].outflow / DT;
+
+  free(Segment);
+  free(Lateral);
+  return N;
+}
+
+/*****************************************************************************
+  BenchSafetyFactor() - infinite slope stability with soil and root
+  cohesion drawn from their distributions on every call
+*****************************************************************************/
+static int BenchSafetyFactor(int N, int Repeats, float *Out, double *Time)
+{
+  VEGTABLE VType[NTYPES];
+  SEDTABLE SedType[NTYPES];
+  SOILTABLE SType[NTYPES];
+  float Dens[NTYPES];
+  float FCap[NTYPES];
+  float *Slope;
+  float *SoilDepth;
+  float *SatThickness;
+  int *Soil;
+  int *Veg;
+  double Start;
+  int r;
+  int i;
+  int t;
+
+  memset(VType, 0, sizeof(VType));
+  memset(SedType, 0, sizeof(SedType));
+  memset(SType, 0, sizeof(SType));
+  for (t = 0; t < NTYPES; t++) {
+    strcpy(VType[t].RootCoh.Distribution, "UNIFORM");
+    VType[t].RootCoh.min = 0.;
+    VType[t].RootCoh.max = Uniform(1., 10.);
+    strcpy(VType[t].VegSurcharge.Distribution, "UNIFORM");
+    VType[t].VegSurcharge.min = 0.;
+    VType[t].VegSurcharge.max = Uniform(50., 200.);
+    strcpy(SedType[t].Friction.Distribution, "TRIANGULAR");
+    SedType[t].Friction.min = Uniform(25., 30.);
+    SedType[t].Friction.mode = Uniform(32., 36.);
+    SedType[t].Friction.max = Uniform(38., 42.);
+    strcpy(SedType[t].Cohesion.Distribution, "NORMAL");
+    SedType[t].Cohesion.mean = Uniform(1., 5.);
+    SedType[t].Cohesion.stdev = 0.2 * SedType[t].Cohesion.mean;
+    SedType[t].SatDensity = Uniform(1900., 2100.);
+    Dens[t] = Uniform(1300., 1600.);
+    FCap[t] = Uniform(0.2, 0.3);
+    SType[t].NLayers = 1;
+    SType[t].Dens = &(Dens[t]);
+    SType[t].FCap = &(FCap[t]);
+  }
+
+  Slope = (float *) Allocate(N, sizeof(float));
+  SoilDepth = (float *) Allocate(N, sizeof(float));
+  SatThickness = (float *) Allocate(N, sizeof(float));
+  Soil = (int *) Allocate(N, sizeof(int));
+  Veg = (int *) Allocate(N, sizeof(int));
+
+  for (i = 0; i < N; i++) {
+    Slope[i] = Uniform(5., 45.);
+    SoilDepth[i] = Uniform(0.3, 3.);
+    SatThickness[i] = Uniform(0., 1.) * SoilDepth[i];
+    Soil[i] = 1 + (int) Uniform(0., NTYPES);
+    Veg[i] = 1 + (int) Uniform(0., NTYPES);
+  }
+
+  for (r = 0; r < Repeats; r++) {
+    Start = Clock();
+    for (i = 0; i < N; i++)
+      Out[i] = CalcSafetyFactor(Slope[i], Soil[i], SoilDepth[i], Veg[i],
+				SedType, VType, SatThickness[i], SType, 0., 0.,
+				r);
+    *Time += Clock() - Start;
+  }
+
+  free(Slope);
+  free(SoilDepth);
+  free(SatThickness);
+  free(Soil);
+  free(Veg);
+  return N;
+}
+
+/*****************************************************************************
+  BenchInterpolation() - station weights of the inverse distance method, the
+  stations between 200 and 2500 m, the pixels between 0 and 3000 m
+*****************************************************************************/
+static int BenchInterpolation(int N, int Repeats, float *Out, double *Time)
+{
+  METLOCATION *Stat;
+  STATIONARRAYS Stations;
+  uchar *Weights;
+  float *Elev;
+  float Sums[NSTATIONSUMS];
+  float WeightSum;
+  double Start;
+  int r;
+  int i;
+  int j;
+
+  Stat = (METLOCATION *) Allocate(NStations, sizeof(METLOCATION));
+  Weights = (uchar *) Allocate((size_t) N * NStations, sizeof(uchar));
+  Elev = (float *) Allocate(N, sizeof(float));
+  memset(&Stations, 0, sizeof(STATIONARRAYS));
+
+  for (j = 0; j < NStations; j++) {
+    Stat[j].Elev = Uniform(200., 2500.);
+    Stat[j].Data.Tair = Uniform(-10., 25.);
+    Stat[j].Data.TempLapse = Uniform(-0.0075, -0.004);
+    Stat[j].Data.Rh = Uniform(30., 100.);
+    Stat[j].Data.Wind = Uniform(0.5, 8.);
+    Stat[j].Data.Lin = Uniform(200., 330.);
+    Stat[j].Data.Sin = Uniform(0., 900.);
+    Stat[j].Data.SinBeamObs = Uniform(0., 0.7) * Stat[j].Data.Sin;
+    Stat[j].Data.SinDiffuseObs = Stat[j].Data.Sin - Stat[j].Data.SinBeamObs;
+  }
+  PackStations(NStations, Stat, &Stations);
+  for (i = 0; i < N; i++) {
+    Elev[i] = Uniform(0., 3000.);
+    for (j = 0; j < NStations; j++)
+      Weights[(size_t) i * NStations + j] = (uchar) Uniform(1., 255.);
+  }
+
+  for (r = 0; r < Repeats; r++) {
+    Start = Clock();
+    for (i = 0; i < N; i++) {
+      InterpolateStations(NStations, Weights + (size_t) i * NStations,
+			  &Stations, Elev[i], Sums, &WeightSum);
+      Out[i] = Sums[SUM_TAIR];
+    }
+    *Time += Clock() - Start;
+  }
+
+  FreeStations(&Stations);
+  free(Stat);
+  free(Weights);
+  free(Elev);
+  return N;
+}
+
+/*****************************************************************************
+  SampleMet() - meteorology for one cell, derived quantities as in
+  MakeLocalMetData()
+*****************************************************************************/
+static void SampleMet(PIXMET *Met, float TMin, float TMax)
+{
+  memset(Met, 0, sizeof(PIXMET));
+  Met->Tair = Uniform(TMin, TMax);
+  Met->Rh = Uniform(30., 100.);
+  Met->Wind = Uniform(0.5, 8.);
+  Met->Lin = Uniform(200., 330.);
+  Met->Press = Uniform(85000., 101300.);
+  Met->Lv = 2501000 - 2361 * Met->Tair;
+  Met->Gamma = CP * Met->Press / (EPS * Met->Lv);
+  Met->Es = SatVaporPressure(Met->Tair);
+  Met->Slope = 4098.0 * Met->Es / ((237.3 + Met->Tair) * (237.3 + Met->Tair));
+  Met->Eact = Met->Es * (Met->Rh / 100.);
+  Met->Vpd = Met->Es - Met->Eact;
+  Met->AirDens = 0.003486 * Met->Press / (275 + Met->Tair);
+}
+
+/*****************************************************************************
+  Clock() - monotonic clock (s)
+*****************************************************************************/
+static double Clock(void)
+{
+  struct timespec Now;
+
+  clock_gettime(CLOCK_MONOTONIC, &Now);
+  return Now.tv_sec + 1e-9 * Now.tv_nsec;
+}
+
+/*****************************************************************************
+  Uniform() - xorshift random number between Min and Max, every kernel
+  starts from the same seed
+*****************************************************************************/
+static double Uniform(double Min, double Max)
+{
+  RandomState ^= RandomState >> 12;
+  RandomState ^= RandomState << 25;
+  RandomState ^= RandomState >> 27;
+  return Min + (Max - Min) * (((RandomState * 2685821657736338717ULL) >> 11) *
+			      (1.0 / 9007199254740992.0));
+}
+
+/*****************************************************************************
+  Allocate() - zeroed array, exits when out of memory
+*****************************************************************************/
+static void *Allocate(size_t N, size_t Size)
+{
+  void *Array;
+
+  if (!(Array = calloc(N, Size)))
+    ReportError("KernelBench()", 1);
+  return Array;
+}
+
+/*****************************************************************************
+  CompareFloat() - qsort() comparison
+*****************************************************************************/
+static int CompareFloat(const void *A, const void *B)
+{
+  float a = *((const float *) A);
+  float b = *((const float *) B);
+
+  return (a > b) - (a < b);
+}
+
+/*****************************************************************************
+  Usage()
+*****************************************************************************/
+static void Usage(char *Program)
+{
+  int k;
+
+  fprintf(stderr, "Usage: %s [-n samples] [-repeat n] [-seed n] "
+	  "[-kernels name,name,...]\n\t[-cpu scalar|sse4.2|avx2|avx512] "
+	  "[-stations n]\n\tkernels:", Program);
+  for (k = 0; k < NKERNELS; k++)
+    fprintf(stderr, " %s", Kernel[k].Name);
+  fprintf(stderr, "\n");
+  exit(EXIT_FAILURE);
+}
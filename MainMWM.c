@@ -30,6 +30,7 @@
 #include "constants.h"
 #include "DHSVMChannel.h"
 #include "slopeaspect.h"
+#include "profile.h"
 
 #define BUFSIZE      255
 #define empty(s) !(s)
@@ -131,7 +132,7 @@ float **InitialSegmentSedimentm; /* Placeholder of segment sediment mass at
 	    y = (int) i*Map->DY/Map->DMASS + ii;
 	    x = (int) j*Map->DX/Map->DMASS + jj;
 	    
-	    TopoIndex[i][j] += (*FineMap[y][x]).TopoIndex;
+	    TopoIndex[i][j] += FINETOPOINDEX(*FineMap[y][x]);
 	    
 	  }
 	}
@@ -159,10 +160,10 @@ float **InitialSegmentSedimentm; /* Placeholder of segment sediment mass at
 	    y = (int) i*Map->DY/Map->DMASS + ii;
 	    x = (int) j*Map->DX/Map->DMASS + jj;
 	    
-	    if (SoilMap[i][j].Depth > SoilMap[i][j].TableDepth){
+	    if (SOILDEPTH(SoilMap[i][j]) > SoilMap[i][j].TableDepth){
 
 	      FineMapTableDepth = TableDepth + 
-		((TopoIndexAve[i][j]-(*FineMap[y][x]).TopoIndex)/ 
+		((TopoIndexAve[i][j]-FINETOPOINDEX(*FineMap[y][x]))/ 
 		 SType[SoilMap[i][j].Soil - 1].KsLatExp);
 	      
 	      if (FineMapTableDepth < 0.) {
@@ -184,7 +185,7 @@ float **InitialSegmentSedimentm; /* Placeholder of segment sediment mass at
 	      /* Calculating the difference between the volume of water distributed
 		 (only saturated) and available volume of water (m3)*/
 	      Redistribute[i][j] = (Map->DY * Map->DX *
-				    (SoilMap[i][j].Depth - TableDepth)) - 
+				    (SOILDEPTH(SoilMap[i][j]) - TableDepth)) - 
 		(FineMapSatThickness*Map->DMASS*Map->DMASS); 
 	      FineMapSatThickness = 0.;
 	    }
@@ -211,7 +212,7 @@ float **InitialSegmentSedimentm; /* Placeholder of segment sediment mass at
 	    (*FineMap[y][x]).SatThickness *= (Map->DMASS)*(Map->DMASS);
 	    /* Add to volume based on amount to be redistributed */
 	    (*FineMap[y][x]).SatThickness += Redistribute[i][j] * 
-	      ((*FineMap[yy][xx]).TopoIndex/TopoIndex[i][j]); 
+	      (FINETOPOINDEX(*FineMap[yy][xx])/TopoIndex[i][j]); 
 	    /* Convert back to thickness (m)*/
 	    (*FineMap[y][x]).SatThickness /= (Map->DMASS)*(Map->DMASS);
 	    
@@ -238,7 +239,7 @@ float **InitialSegmentSedimentm; /* Placeholder of segment sediment mass at
 	      (*FineMap[y][x]).SatThickness *= (Map->DMASS)*(Map->DMASS);
 	      /* Add to volume based on amount to be redistributed */
 	      (*FineMap[y][x]).SatThickness += Redistribute[i][j] * 
-		((*FineMap[y][x]).TopoIndex/TopoIndex[i][j]);
+		(FINETOPOINDEX(*FineMap[y][x])/TopoIndex[i][j]);
 	      /* Convert back to thickness (m)*/
 	      (*FineMap[y][x]).SatThickness /= (Map->DMASS)*(Map->DMASS);
 	      
@@ -291,20 +292,20 @@ float **InitialSegmentSedimentm; /* Placeholder of segment sediment mass at
       ReportError("MainMWM", 1);
   }
   
-  if (!(SegmentSediment = (float *)calloc(MaxStreamID, sizeof(float ))))
+  if (!(SegmentSediment = (float *)calloc(MaxStreamID + 1, sizeof(float ))))
     ReportError("MainMWM", 1);
 
-  if (!(SegmentSedimentm = (float **)calloc(MaxStreamID, sizeof(float *))))
+  if (!(SegmentSedimentm = (float **)calloc(MaxStreamID + 1, sizeof(float *))))
     ReportError("MainMWM", 1);
   for(i=1; i<MaxStreamID+1; i++) {
     if (!(SegmentSedimentm[i] = (float *)calloc(NSEDSIZES, sizeof(float))))
       ReportError("MainMWM", 1);
   }
   
-  if (!(InitialSegmentSediment = (float *)calloc(MaxStreamID, sizeof(float ))))
+  if (!(InitialSegmentSediment = (float *)calloc(MaxStreamID + 1, sizeof(float ))))
     ReportError("MainMWM", 1);
 
-  if (!(InitialSegmentSedimentm = (float **)calloc(MaxStreamID, sizeof(float *))))
+  if (!(InitialSegmentSedimentm = (float **)calloc(MaxStreamID + 1, sizeof(float *))))
     ReportError("MainMWM", 1);  
  for(i=1; i<MaxStreamID+1; i++) {
     if (!(InitialSegmentSedimentm[i] = (float *)calloc(NSEDSIZES, sizeof(float))))
@@ -343,6 +344,7 @@ float **InitialSegmentSedimentm; /* Placeholder of segment sediment mass at
   numfailures = 0;
   for(iter=0; iter < massitertemp; iter++) {
     
+    PROFILE_COUNT(PROF_MWMITER, 1);
     printf("iter=%d\n",iter);
     
     /************************************************************************/
@@ -370,7 +372,7 @@ float **InitialSegmentSedimentm; /* Placeholder of segment sediment mass at
 		SedFromUpslope = 0.0;
 		SedimentToChannel = 0.0;
 		/* First check for original failure. */
-		if((*FineMap[y][x]).SatThickness/SoilMap[i][j].Depth > MTHRESH && failure[y][x] == 0
+		if((*FineMap[y][x]).SatThickness/SOILDEPTH(SoilMap[i][j]) > MTHRESH && failure[y][x] == 0
 		   && (*FineMap[y][x]).sediment > 0.0) {
 
 		  LocalSlope = ElevationSlope(Map, TopoMap, FineMap, y, x, &nexty, &nextx, y, x, &SlopeAspect);
@@ -653,7 +655,7 @@ float **InitialSegmentSedimentm; /* Placeholder of segment sediment mass at
 	      numlikelyfailedpixels +=1;
 	  
 	    (*FineMap[y][x]).DeltaDepth = (*FineMap[y][x]).sediment - 
-	      SoilMap[i][j].Depth;
+	      SOILDEPTH(SoilMap[i][j]);
 
 	  }
 	}
@@ -714,6 +716,7 @@ float **InitialSegmentSedimentm; /* Placeholder of segment sediment mass at
   }
   for(i=1; i<MaxStreamID+1; i++) {
     free(SegmentSedimentm[i]);
+    free(InitialSegmentSedimentm[i]);
   }
   free(failure);
   free(SedThickness);
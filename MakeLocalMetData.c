@@ -9,6 +9,10 @@
  * DESCRIPTION:  Generates meteorological conditions for each individual cell
  * DESCRIP-END.
  * FUNCTIONS:    MakeLocalMetData()
+ *               InterpolateLocalMet()
+ *               PerturbLocalMet()
+ *               StationPrecip()
+ *               FinishLocalMetData()
  * COMMENTS:
  * $Id: MakeLocalMetData.c,v 1.5 2004/02/19 15:36:17 colleen Exp $     
  */
@@ -24,6 +28,13 @@
 #include "functions.h"
 #include "constants.h"
 #include "rad.h"
+#include "dispatch.h"
+
+static float StationPrecip(int y, int x, OPTIONSTRUCT * Options, int NStats,
+			   METLOCATION * Stat, uchar * MetWeights,
+			   float LocalElev, float **PrismMap,
+			   float **PrecipLapseMap, COMPACTMAPS * Compact,
+			   int Month, float Multiplier);
 
 /*****************************************************************************
   Function name: MakeLocalMetData()
@@ -38,12 +49,15 @@
     unsigned char PrecipType
     int NStats
     METLOCATION *Stat
+    STATIONARRAYS *Stations - Station data of the time step, see PackStations()
     uchar *MetWeights
     float LocalElev
     RADCLASSPIX *RadMap 
     PRECIPPIX *PrecipMap
     MAPSIZE Radar
     RADARPIX **RadarMap
+    COMPACTMAPS *Compact - Compact static maps, see compact.h; replace
+                           WindModel and PrecipLapseMap when Active
 
   Returns      :
     PIXMET LocalMet
@@ -56,18 +70,72 @@
 *****************************************************************************/
 PIXMET MakeLocalMetData(int y, int x, MAPSIZE * Map, int DayStep,
 			OPTIONSTRUCT * Options, int NStats,
-			METLOCATION * Stat, uchar * MetWeights,
+			METLOCATION * Stat, STATIONARRAYS * Stations,
+			uchar * MetWeights,
 			float LocalElev, RADCLASSPIX * RadMap,
 			PRECIPPIX * PrecipMap, MAPSIZE * Radar,
 			RADARPIX ** RadarMap, float **PrismMap,
 			SNOWPIX * LocalSnow, SNOWTABLE * SnowAlbedo,
-			float ***MM5Input, float ***WindModel,
-			float **PrecipLapseMap, MET_MAP_PIX *** MetMap,
+			MM5MAPS MM5Input, float ***WindModel,
+			float **PrecipLapseMap, COMPACTMAPS * Compact,
+			MET_MAP_PIX *** MetMap,
 			int NGraphics, int Month, float skyview,
 			unsigned char shadow, float SunMax,
 			float SineSolarAltitude)
 {
-  float CurrentWeight;		/* weight for current station */
+  PIXMET LocalMet;		/* local met data */
+
+  LocalMet = InterpolateLocalMet(y, x, Map, DayStep, Options, NStats, Stat,
+				 Stations, MetWeights, LocalElev, RadMap, PrecipMap,
+				 Radar, RadarMap, PrismMap, MM5Input,
+				 WindModel, PrecipLapseMap, Compact, Month,
+				 skyview, shadow, SunMax, SineSolarAltitude);
+
+  FinishLocalMetData(Options, &LocalMet, PrecipMap, LocalSnow, SnowAlbedo);
+
+  if (NGraphics > 0) {
+
+    (*MetMap)[y][x].accum_precip =
+      (*MetMap)[y][x].accum_precip + PrecipMap->Precip;
+    (*MetMap)[y][x].air_temp = LocalMet.Tair;
+    (*MetMap)[y][x].wind_speed = LocalMet.Wind;
+    (*MetMap)[y][x].humidity = LocalMet.Rh;
+  }
+
+  return LocalMet;
+}
+
+/*****************************************************************************
+  Function name: InterpolateLocalMet()
+
+  Purpose      : Interpolates the met inputs to the pixel
+
+  Required     : see MakeLocalMetData()
+
+  Returns      :
+    PIXMET LocalMet - air temperature, humidity, wind, radiation and air
+                      pressure for the pixel
+
+  Modifies     : RadMap, PrecipMap->Precip
+
+  Comments     : The derived quantities in LocalMet, the separation of the
+                 precipitation into rain and snow and the snow albedo are
+                 calculated by FinishLocalMetData()
+*****************************************************************************/
+PIXMET InterpolateLocalMet(int y, int x, MAPSIZE * Map, int DayStep,
+			   OPTIONSTRUCT * Options, int NStats,
+			   METLOCATION * Stat, STATIONARRAYS * Stations,
+			   uchar * MetWeights,
+			   float LocalElev, RADCLASSPIX * RadMap,
+			   PRECIPPIX * PrecipMap, MAPSIZE * Radar,
+			   RADARPIX ** RadarMap, float **PrismMap,
+			   MM5MAPS MM5Input, float ***WindModel,
+			   float **PrecipLapseMap, COMPACTMAPS * Compact,
+			   int Month, float skyview,
+			   unsigned char shadow, float SunMax,
+			   float SineSolarAltitude)
+{
+  float Sums[NSTATIONSUMS];	/* weighted sums over the stations */
   float ScaleWind = 1;		/* Wind to be scaled by model factors if 
 				   WindSource == MODEL */
   float Temp;			/* Temporary variable */
@@ -88,19 +156,13 @@ PIXMET MakeLocalMetData(int y, int x, MAPSIZE * Map, int DayStep,
   LocalMet.Lin = 0.0;
   TempLapseRate = 0.0;
 
-  if (Options->MM5 == TRUE && Options->QPF == TRUE) {
-    WeightSum = 0.0;
-    for (i = 0; i < NStats; i++)
-      WeightSum += (float) MetWeights[i];
-  }
-
   if (Options->MM5 == TRUE) {
-    LocalMet.Tair = MM5Input[MM5_temperature - 1][y][x] +
-      (LocalElev - MM5Input[MM5_terrain - 1][y][x]) * MM5Input[MM5_lapse -
-							       1][y][x];
-    LocalMet.Rh = MM5Input[MM5_humidity - 1][y][x];
-    LocalMet.Wind = MM5Input[MM5_wind - 1][y][x];
-    LocalMet.Sin = MM5Input[MM5_shortwave - 1][y][x];
+    LocalMet.Tair = MM5VALUE(MM5Input, MM5_temperature - 1, y, x) +
+      (LocalElev - MM5VALUE(MM5Input, MM5_terrain - 1, y, x)) *
+      MM5VALUE(MM5Input, MM5_lapse - 1, y, x);
+    LocalMet.Rh = MM5VALUE(MM5Input, MM5_humidity - 1, y, x);
+    LocalMet.Wind = MM5VALUE(MM5Input, MM5_wind - 1, y, x);
+    LocalMet.Sin = MM5VALUE(MM5Input, MM5_shortwave - 1, y, x);
 
     if (Options->Shading == TRUE) {
       if (SunMax > 0.0) {
@@ -116,41 +178,42 @@ PIXMET MakeLocalMetData(int y, int x, MAPSIZE * Map, int DayStep,
       }
     }
 
-    LocalMet.Lin = MM5Input[MM5_longwave - 1][y][x];
+    LocalMet.Lin = MM5VALUE(MM5Input, MM5_longwave - 1, y, x);
     LocalMet.Press = 101300.0;
-    PrecipMap->Precip = MM5Input[MM5_precip - 1][y][x];
+    PrecipMap->Precip = MM5VALUE(MM5Input, MM5_precip - 1, y, x);
 /*    if(LocalMet.Sin>0) {
     printf("LocalMet.Sin, LocalMet.Lin are: %f %f \n",LocalMet.Sin, LocalMet.Lin);
 } */
   }
   else {			/* MM5 is false and we need to interpolate the basic met records */
 
-    WeightSum = 0.0;
-    for (i = 0; i < NStats; i++) {
-      WeightSum += (float) MetWeights[i];
-      if (Options->WindSource == MODEL && Stat[i].IsWindModelLocation) {
-	ScaleWind = Stat[i].Data.Wind;
-	WindDirection = Stat[i].Data.WindDirection;
+    if (Options->WindSource == MODEL) {
+      for (i = 0; i < NStats; i++) {
+	if (Stat[i].IsWindModelLocation) {
+	  ScaleWind = Stat[i].Data.Wind;
+	  WindDirection = Stat[i].Data.WindDirection;
+	}
       }
     }
-    for (i = 0; i < NStats; i++) {
-      CurrentWeight = ((float) MetWeights[i]) / WeightSum;
-      LocalMet.Tair += CurrentWeight *
-	LapseT(Stat[i].Data.Tair, Stat[i].Elev, LocalElev,
-	       Stat[i].Data.TempLapse);
-      LocalMet.Rh += CurrentWeight * Stat[i].Data.Rh;
-      if (Options->WindSource == STATION)
-	LocalMet.Wind += CurrentWeight * Stat[i].Data.Wind;
-      LocalMet.Lin += CurrentWeight * Stat[i].Data.Lin;
-      LocalMet.Sin += CurrentWeight * Stat[i].Data.Sin;
-      if (Options->Shading == TRUE) {
-	LocalMet.SinBeam += CurrentWeight * Stat[i].Data.SinBeamObs;
-	LocalMet.SinDiffuse += CurrentWeight * Stat[i].Data.SinDiffuseObs;
-      }
-      TempLapseRate += CurrentWeight * Stat[i].Data.TempLapse;
+
+    /* weighted sums over the stations, see Dispatch.c */
+    InterpolateStations(NStats, MetWeights, Stations, LocalElev, Sums,
+			&WeightSum);
+    LocalMet.Tair = Sums[SUM_TAIR];
+    LocalMet.Rh = Sums[SUM_RH];
+    if (Options->WindSource == STATION)
+      LocalMet.Wind = Sums[SUM_WIND];
+    LocalMet.Lin = Sums[SUM_LIN];
+    LocalMet.Sin = Sums[SUM_SIN];
+    if (Options->Shading == TRUE) {
+      LocalMet.SinBeam = Sums[SUM_SINBEAM];
+      LocalMet.SinDiffuse = Sums[SUM_SINDIFFUSE];
     }
+    TempLapseRate = Sums[SUM_TEMPLAPSE];
     if (Options->WindSource == MODEL)
-      LocalMet.Wind = ScaleWind * WindModel[WindDirection - 1][y][x];
+      LocalMet.Wind = ScaleWind * (Compact->Active ?
+	COMPACTVALUE(&(Compact->Wind[WindDirection - 1]), y, x) :
+	WindModel[WindDirection - 1][y][x]);
 
     if (Options->PrecipType == RADAR) {
       RadarY = (int) ((y + Radar->OffsetY) * Map->DY / Radar->DY);
@@ -218,43 +281,183 @@ PIXMET MakeLocalMetData(int y, int x, MAPSIZE * Map, int DayStep,
   RadMap->Diffuse = LocalMet.SinDiffuse;
   LocalMet.Sin = RadMap->Beam + RadMap->Diffuse;
 
-  if (Options->QPF == TRUE || Options->MM5 == FALSE) {
-    if (Options->PrecipType == STATION && Options->Prism == FALSE) {
-      PrecipMap->Precip = 0.0;
-      for (i = 0; i < NStats; i++) {
-	CurrentWeight = ((float) MetWeights[i]) / WeightSum;
-	if (Options->PrecipLapse == MAP)
-	  PrecipMap->Precip += CurrentWeight *
-	    LapsePrecip(Stat[i].Data.Precip, 0, 1, PrecipLapseMap[y][x]);
-	else
-	  PrecipMap->Precip += CurrentWeight *
-	    LapsePrecip(Stat[i].Data.Precip, Stat[i].Elev, LocalElev,
-			Stat[i].Data.PrecipLapse);
-      }
+  if ((Options->QPF == TRUE || Options->MM5 == FALSE) &&
+      Options->PrecipType == STATION)
+    PrecipMap->Precip = StationPrecip(y, x, Options, NStats, Stat, MetWeights,
+				      LocalElev, PrismMap, PrecipLapseMap,
+				      Compact, Month, 1.0);
+
+  return LocalMet;
+}
+
+/*****************************************************************************
+  Function name: PerturbLocalMet()
+
+  Purpose      : Applies the forcing perturbations of an ensemble member to
+                 the met data that InterpolateLocalMet() has interpolated
+                 from the unperturbed inputs
+
+  Required     : see MakeLocalMetData(), and
+    float TempOffset       - Air temperature offset of the member (C)
+    float PrecipMultiplier - Precipitation multiplier of the member
+    PIXMET *LocalMet       - Met data from InterpolateLocalMet()
+
+  Returns      : void
+
+  Modifies     : LocalMet->Tair, PrecipMap->Precip
+
+  Comments     : The air temperature and the precipitation are interpolated
+                 again from the perturbed inputs, with the perturbations
+                 applied where PerturbMetData() applies them in a member
+                 process, so that the results are the same as those of
+                 ENSEMBLE MODE = PROCESS.  Adding the offset to the
+                 interpolated value instead would round differently.  The
+                 other met variables do not depend on the perturbations.
+*****************************************************************************/
+void PerturbLocalMet(int y, int x, MAPSIZE * Map, OPTIONSTRUCT * Options,
+		     int NStats, METLOCATION * Stat, STATIONARRAYS * Stations,
+		     uchar * MetWeights, float LocalElev,
+		     PRECIPPIX * PrecipMap, MAPSIZE * Radar,
+		     RADARPIX ** RadarMap, float **PrismMap,
+		     MM5MAPS MM5Input, float **PrecipLapseMap,
+		     COMPACTMAPS * Compact, int Month, float TempOffset,
+		     float PrecipMultiplier, PIXMET * LocalMet)
+{
+  float CurrentWeight;		/* weight for current station */
+  float Tair;			/* Air temperature lapsed to the pixel */
+  float WeightSum;		/* sum of the weights */
+  int i;			/* counter */
+  int RadarX;			/* X coordinate of radar map coordinate */
+  int RadarY;			/* Y coordinate of radar map coordinate */
+
+  if (Options->MM5 == TRUE) {
+    LocalMet->Tair =
+      MM5PERTURBED(MM5Input, MM5_temperature - 1, y, x, TempOffset, 1.0) +
+      (LocalElev - MM5VALUE(MM5Input, MM5_terrain - 1, y, x)) *
+      MM5VALUE(MM5Input, MM5_lapse - 1, y, x);
+    PrecipMap->Precip =
+      MM5PERTURBED(MM5Input, MM5_precip - 1, y, x, 0.0, PrecipMultiplier);
+  }
+  else {
+    /* the loop of InterpolateStations() for the air temperature only */
+    WeightSum = 0.0;
+    for (i = 0; i < NStats; i++)
+      WeightSum += (float) MetWeights[i];
+    LocalMet->Tair = 0.0;
+    for (i = 0; i < NStats; i++) {
+      CurrentWeight = ((float) MetWeights[i]) / WeightSum;
+      Tair = (float) (Stations->Tair[i] + TempOffset) +
+	(LocalElev - Stations->Elev[i]) * Stations->TempLapse[i];
+      LocalMet->Tair += CurrentWeight * Tair;
     }
-    else if (Options->PrecipType == STATION && Options->Prism == TRUE) {
-      PrecipMap->Precip = 0.0;
-      for (i = 0; i < NStats; i++) {
-	CurrentWeight = ((float) MetWeights[i]) / WeightSum;
-	/* this is the real prism interpolation */
-	/* note that X = position from left  boundary, ie # of columns */
-	/* note that Y = position from upper boundary, ie # of rows   */
-	if (Options->Outside == FALSE)
-	  PrecipMap->Precip +=
-	    CurrentWeight * Stat[i].Data.Precip /
-	    PrismMap[Stat[i].Loc.N][Stat[i].Loc.E] * PrismMap[y][x];
-	else
-	  PrecipMap->Precip +=
-	    CurrentWeight * Stat[i].Data.Precip /
-	    Stat[i].PrismPrecip[Month - 1] * PrismMap[y][x];
-	if(PrismMap[y][x] < 0){
-	  printf("negative PrismMap value in MakeLocalMetData.c\n");
-	  exit(0);
-	}
+
+    if (Options->PrecipType == RADAR) {
+      RadarY = (int) ((y + Radar->OffsetY) * Map->DY / Radar->DY);
+      RadarX = (int) ((x - Radar->OffsetX) * Map->DX / Radar->DX);
+      PrecipMap->Precip = RadarMap[RadarY][RadarX].Precip * PrecipMultiplier;
+    }
+  }
+
+  if ((Options->QPF == TRUE || Options->MM5 == FALSE) &&
+      Options->PrecipType == STATION)
+    PrecipMap->Precip = StationPrecip(y, x, Options, NStats, Stat, MetWeights,
+				      LocalElev, PrismMap, PrecipLapseMap,
+				      Compact, Month, PrecipMultiplier);
+}
+
+/*****************************************************************************
+  Function name: StationPrecip()
+
+  Purpose      : Interpolates the station precipitation to the pixel
+
+  Required     : see MakeLocalMetData(), and
+    float Multiplier - Multiplier of the station precipitation, 1 unless
+                       the precipitation of an ensemble member is perturbed
+
+  Returns      :
+    float Precip - precipitation of the pixel
+
+  Modifies     :
+
+  Comments     :
+*****************************************************************************/
+static float StationPrecip(int y, int x, OPTIONSTRUCT * Options, int NStats,
+			   METLOCATION * Stat, uchar * MetWeights,
+			   float LocalElev, float **PrismMap,
+			   float **PrecipLapseMap, COMPACTMAPS * Compact,
+			   int Month, float Multiplier)
+{
+  float CurrentWeight;		/* weight for current station */
+  float Precip;			/* precipitation of the pixel */
+  float StatPrecip;		/* precipitation of the station */
+  float WeightSum;		/* sum of the weights */
+  int i;			/* counter */
+
+  WeightSum = 0.0;
+  for (i = 0; i < NStats; i++)
+    WeightSum += (float) MetWeights[i];
+
+  Precip = 0.0;
+  if (Options->Prism == FALSE) {
+    for (i = 0; i < NStats; i++) {
+      CurrentWeight = ((float) MetWeights[i]) / WeightSum;
+      StatPrecip = Stat[i].Data.Precip * Multiplier;
+      if (Options->PrecipLapse == MAP)
+	Precip += CurrentWeight *
+	  LapsePrecip(StatPrecip, 0, 1, Compact->Active ?
+		      COMPACTVALUE(&(Compact->PrecipLapse), y, x) :
+		      PrecipLapseMap[y][x]);
+      else
+	Precip += CurrentWeight *
+	  LapsePrecip(StatPrecip, Stat[i].Elev, LocalElev,
+		      Stat[i].Data.PrecipLapse);
+    }
+  }
+  else {
+    for (i = 0; i < NStats; i++) {
+      CurrentWeight = ((float) MetWeights[i]) / WeightSum;
+      StatPrecip = Stat[i].Data.Precip * Multiplier;
+      /* this is the real prism interpolation */
+      /* note that X = position from left  boundary, ie # of columns */
+      /* note that Y = position from upper boundary, ie # of rows   */
+      if (Options->Outside == FALSE)
+	Precip += CurrentWeight * StatPrecip /
+	  PrismMap[Stat[i].Loc.N][Stat[i].Loc.E] * PrismMap[y][x];
+      else
+	Precip += CurrentWeight * StatPrecip /
+	  Stat[i].PrismPrecip[Month - 1] * PrismMap[y][x];
+      if(PrismMap[y][x] < 0){
+	printf("negative PrismMap value in MakeLocalMetData.c\n");
+	exit(0);
       }
     }
   }
 
+  return Precip;
+}
+
+/*****************************************************************************
+  Function name: FinishLocalMetData()
+
+  Purpose      : Calculates the derived met quantities for the pixel and
+                 separates the precipitation into rain and snow
+
+  Required     :
+    OPTIONSTRUCT *Options - Structure with different program options
+    PIXMET *LocalMet      - Met data from InterpolateLocalMet()
+    PRECIPPIX *PrecipMap  - Precipitation for the pixel
+    SNOWPIX *LocalSnow    - Snow pack for the pixel
+    SNOWTABLE *SnowAlbedo - Snow albedo table
+
+  Returns      : void
+
+  Modifies     : LocalMet, PrecipMap->SnowFall, PrecipMap->RainFall,
+                 LocalSnow->LastSnow, LocalSnow->Albedo
+*****************************************************************************/
+void FinishLocalMetData(OPTIONSTRUCT * Options, PIXMET * LocalMet,
+			PRECIPPIX * PrecipMap, SNOWPIX * LocalSnow,
+			SNOWTABLE * SnowAlbedo)
+{
   /* due to the nature of the interpolation scheme in DHSVM and the */
   /* interpolation scheme to handle the mess of different formats of met stations */
   /* in the PRISM project */
@@ -264,14 +467,14 @@ PIXMET MakeLocalMetData(int y, int x, MAPSIZE * Map, int DayStep,
 
   if (Options->Rhoverride == TRUE) {
     if (PrecipMap->Precip > 0.0)
-      LocalMet.Rh = 100.0;
+      LocalMet->Rh = 100.0;
   }
 
   /* Separate precipitation into rainfall and snowfall */
-  if (PrecipMap->Precip > 0.0 && LocalMet.Tair < MAX_SNOW_TEMP) {
-    if (LocalMet.Tair > MIN_RAIN_TEMP)
+  if (PrecipMap->Precip > 0.0 && LocalMet->Tair < MAX_SNOW_TEMP) {
+    if (LocalMet->Tair > MIN_RAIN_TEMP)
       PrecipMap->SnowFall = PrecipMap->Precip *
-	(MAX_SNOW_TEMP - LocalMet.Tair) / (MAX_SNOW_TEMP - MIN_RAIN_TEMP);
+	(MAX_SNOW_TEMP - LocalMet->Tair) / (MAX_SNOW_TEMP - MIN_RAIN_TEMP);
     else
       PrecipMap->SnowFall = PrecipMap->Precip;
   }
@@ -281,46 +484,36 @@ PIXMET MakeLocalMetData(int y, int x, MAPSIZE * Map, int DayStep,
   PrecipMap->RainFall = PrecipMap->Precip - PrecipMap->SnowFall;
 
   /* Local heat of vaporization, Eq. 4.2.1, Shuttleworth (1993) */
-  LocalMet.Lv = 2501000 - 2361 * LocalMet.Tair;
+  LocalMet->Lv = 2501000 - 2361 * LocalMet->Tair;
 
   /* Psychrometric constant */
-  LocalMet.Gamma = CP * LocalMet.Press / (EPS * LocalMet.Lv);
+  LocalMet->Gamma = CP * LocalMet->Press / (EPS * LocalMet->Lv);
 
   /* Saturated vapor pressure, Eq. 4.2.2, Shuttleworth (1993) */
-  LocalMet.Es = SatVaporPressure(LocalMet.Tair);
+  LocalMet->Es = SatVaporPressure(LocalMet->Tair);
 
   /* Slope of vapor pressure curve, Eq. 4.2.3, Shuttleworth (1993) */
-  LocalMet.Slope = 4098.0 * LocalMet.Es /
-    ((237.3 + LocalMet.Tair) * (237.3 + LocalMet.Tair));
+  LocalMet->Slope = 4098.0 * LocalMet->Es /
+    ((237.3 + LocalMet->Tair) * (237.3 + LocalMet->Tair));
 
   /* Actual vapor pressure */
-  LocalMet.Eact = LocalMet.Es * (LocalMet.Rh / 100.);
+  LocalMet->Eact = LocalMet->Es * (LocalMet->Rh / 100.);
 
   /* Vapor pressure deficit */
-  LocalMet.Vpd = LocalMet.Es - LocalMet.Eact;
+  LocalMet->Vpd = LocalMet->Es - LocalMet->Eact;
 
   /* Air density, Eq. 4.2.4 Shuttleworth (1993) */
-  LocalMet.AirDens = 0.003486 * LocalMet.Press / (275 + LocalMet.Tair);
+  LocalMet->AirDens = 0.003486 * LocalMet->Press / (275 + LocalMet->Tair);
 
   if (LocalSnow->HasSnow) {
     if (PrecipMap->SnowFall > 0.0)
       LocalSnow->LastSnow = 0;
     else
-      LocalSnow->LastSnow++;
+      LocalSnow->LastSnow += Options->Adaptive.Steps;
     LocalSnow->Albedo = CalcSnowAlbedo(LocalSnow->TSurf, LocalSnow->LastSnow,
 				       SnowAlbedo);
   }
   else
     LocalSnow->LastSnow = 0;
-
-  if (NGraphics > 0) {
-
-    (*MetMap)[y][x].accum_precip =
-      (*MetMap)[y][x].accum_precip + PrecipMap->Precip;
-    (*MetMap)[y][x].air_temp = LocalMet.Tair;
-    (*MetMap)[y][x].wind_speed = LocalMet.Wind;
-    (*MetMap)[y][x].humidity = LocalMet.Rh;
-  }
-
-  return LocalMet;
 }
+
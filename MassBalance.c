@@ -23,6 +23,7 @@
 #include "functions.h"
 #include "constants.h"
 #include "Calendar.h"
+#include "profile.h"
 
 /*****************************************************************************
   Aggregate()
@@ -47,6 +48,7 @@ void MassBalance(DATE *Current, FILES *Out, FILES *SedOut, AGGREGATED *Total,
   float MWMMassError;            /* mass wasting mass balance error m3  */
   float SedInput, SedOutput, SedMassError;  /* sediment mass balance variables 
 					       for channel network */
+  long Pos;			/* Position in the output file */
 
   NewWaterStorage = Total->Soil.IExcess + Total->Road.IExcess + 
     Total->CanopyWater + Total->SoilWater +
@@ -73,6 +75,7 @@ void MassBalance(DATE *Current, FILES *Out, FILES *SedOut, AGGREGATED *Total,
   Mass->CumCulvertToChannel += Total->CulvertToChannel;
   Mass->CumRunoffToChannel += Total->RunoffToChannel;
   
+  Pos = PROFILE_TELL(Out->FilePtr);
   PrintDate(Current, Out->FilePtr);
   fprintf(Out->FilePtr, " %7.4f  %7.4f  %6.3f  %8.4f  %.2e  \
 %.2e  %5.2f  %5.2f  %7.4f  %7.4f  %7.4f  %6.3f  %.2e  %5.2f  %.2e  %7.3f \n",
@@ -82,6 +85,7 @@ void MassBalance(DATE *Current, FILES *Out, FILES *SedOut, AGGREGATED *Total,
 	  Total->Precip.Precip, Total->Snow.VaporMassFlux, 
 	  Total->Snow.CanopyVaporMassFlux, Mass->OldWaterStorage, Total->CulvertToChannel,
 	  Total->RunoffToChannel, MassError);
+  PROFILE_COUNT_FILE(PROF_BYTESWRITTEN, Out->FilePtr, Pos);
 
   if(Options->Sediment){
     /* Calculate sediment mass errors */
@@ -127,6 +131,7 @@ void MassBalance(DATE *Current, FILES *Out, FILES *SedOut, AGGREGATED *Total,
     Mass->LastChannelSedimentStorage = Total->ChannelSedimentStorage + 
       Total->ChannelSuspendedSediment;   
     
+    Pos = PROFILE_TELL(SedOut->FilePtr);
     PrintDate(Current, SedOut->FilePtr);
     
     fprintf(SedOut->FilePtr, " %g %g %g %g %g %g %g %g %g %g %g %g %g %g %g \n", 
@@ -137,6 +142,7 @@ void MassBalance(DATE *Current, FILES *Out, FILES *SedOut, AGGREGATED *Total,
 	    Total->SedimentOverroadInflow, Total->SedimentOutflow, 
 	    Total->CulvertReturnSedFlow, Total->CulvertSedToChannel,
 	    Mass->LastChannelSedimentStorage, SedMassError);
+    PROFILE_COUNT_FILE(PROF_BYTESWRITTEN, SedOut->FilePtr, Pos);
   } 
 }
 
@@ -13,19 +13,14 @@
  * $Id: MassEnergyBalance.c,v 1.16 2004/08/18 01:01:31 colleen Exp $     
  */
 
-/* #define NO_ET */
 /* #define NO_SNOW */
 
-#ifdef SNOW_ONLY
-#define NO_ET
-#define NO_SOIL
-#endif
-
 #include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include "settings.h"
 #include "data.h"
+#include "compact.h"
 #include "DHSVMerror.h"
 #include "functions.h"
 #include "massenergy.h"
@@ -63,7 +58,8 @@ Journal of Hydrology, 175, 213-238.
 void MassEnergyBalance(int y, int x, float SineSolarAltitude, float DX, 
 		       float DY, int Dt, int HeatFluxOption, 
 		       int CanopyRadAttOption, int RoadRouteOption,
-		       int InfiltOption, int MaxVegLayers, PIXMET *LocalMet,
+		       int InfiltOption, int ComponentsOption,
+		       int MaxVegLayers, PIXMET *LocalMet,
 		       ROADSTRUCT *LocalNetwork, PRECIPPIX *LocalPrecip,
 		       VEGTABLE *VType, VEGPIX *LocalVeg, SOILTABLE *SType,
 		       SOILPIX *LocalSoil, SNOWPIX *LocalSnow,
@@ -343,7 +339,13 @@ void MassEnergyBalance(int y, int x, float SineSolarAltitude, float DX,
   }
 #endif
 
-#ifndef NO_ET
+  /* In SNOW_MODEL runs the water that reaches the ground is not followed
+     any further, only the radiation totals are needed */
+  if (ComponentsOption == SNOW_MODEL) {
+    AggregateRadiation(MaxVegLayers, VType->NVegLayers, &LocalRad, TotalRad);
+    return;
+  }
+
   /* calculate the amount of evapotranspiration from each vegetation layer 
      above the ground/soil surface.  Also calculate the total amount of 
      evapotranspiration from the vegetation */
@@ -414,12 +416,8 @@ void MassEnergyBalance(int y, int x, float SineSolarAltitude, float DX,
   MoistureFlux += LocalEvap->EvapSoil;
   LocalEvap->ETot += LocalEvap->EvapSoil;
 
-#endif
-
   /* add the water that was not intercepted to the upper soil layer */
 
-#ifndef NO_SOIL
-
   /* This has been modified so that PercArea for infiltration is calculated
      locally to account for the fact that some cells have roads and streams.
      I am not sure if the old PercArea (which does not account for the fact 
@@ -539,7 +537,7 @@ void MassEnergyBalance(int y, int x, float SineSolarAltitude, float DX,
 
   UnsaturatedFlow(Dt, DX, DY, Infiltration, RoadbedInfiltration,
 		  LocalSoil->SatFlow, SType->NLayers,
-		  LocalSoil->Depth, LocalNetwork->Area, VType->RootDepth,
+		  SOILDEPTH(*LocalSoil), LocalNetwork->Area, VType->RootDepth,
 		  SType->Ks, SType->PoreDist, SType->Porosity, SType->FCap,
 		  LocalSoil->Perc, LocalNetwork->PercArea,
 		  LocalNetwork->Adjust, LocalNetwork->CutBankZone,
@@ -573,8 +571,6 @@ void MassEnergyBalance(int y, int x, float SineSolarAltitude, float DX,
   else
     NoSensibleHeatFlux(Dt, LocalMet, MoistureFlux, LocalSoil);
 
-#endif
-
   /* add the components of the radiation balance for the current pixel to 
      the total */
   AggregateRadiation(MaxVegLayers, VType->NVegLayers, &LocalRad, TotalRad);
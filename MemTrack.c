@@ -0,0 +1,814 @@
+/*
+ * SUMMARY:      MemTrack.c - Memory accounting
+ * USAGE:        Part of DHSVM
+ *
+ * AUTHOR:       DHSVM development team
+ * ORG:          University of Washington, Department of Civil Engineering
+ * E-MAIL:
+ * ORIG-DATE:    Oct-2026
+ * DESCRIPTION:  Record the long-lived allocations of the model by subsystem
+ *               and structure, predict them from the configuration, and
+ *               report both, see memtrack.h
+ * DESCRIP-END.
+ * FUNCTIONS:    CallocMap()
+ *               FreeMap()
+ *               FreeMapBuffers()
+ *               TrackedCalloc()
+ *               TrackedMalloc()
+ *               TrackedFree()
+ *               PredictAllocation()
+ *               PredictMemory()
+ *               ResetMemory()
+ *               SetMemTable()
+ *               GetMemTable()
+ *               TrackedBytes()
+ *               ReportMemory()
+ *               ReportPeakMemory()
+ * COMMENTS:     The footprint of a block includes the bookkeeping and the
+ *               rounding of the allocator (16 byte aligned chunks with an
+ *               8 byte header and a minimum of 32 bytes, as in glibc on
+ *               64-bit systems).  For the many small per-pixel arrays the
+ *               footprint is often two or three times the bytes asked for.
+ * $Id: MemTrack.c,v 1.0 2026/10/17 Exp $
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include "settings.h"
+#include "constants.h"
+#include "data.h"
+#include "DHSVMerror.h"
+#include "fileio.h"
+#include "getinit.h"
+#include "sizeofnt.h"
+#include "varid.h"
+#include "params.h"
+#include "compact.h"
+#include "memtrack.h"
+
+#define BLOCKHEADER 8		/* bookkeeping of the allocator per block */
+#define BLOCKALIGN 16		/* alignment of a block */
+#define MINBLOCK 32		/* smallest block */
+#define MB (1024. * 1024.)
+
+static MEMTABLE ProcessTable;	/* Table used outside the model instances */
+static __thread MEMTABLE *Table = &ProcessTable;	/* Table of the
+							   allocations of
+							   the calling
+							   thread */
+
+static char *SubsystemName[NSUBSYSTEMS] = {
+  "Terrain", "Soil", "Vegetation", "Meteorology", "Snow", "Network",
+  "Sediment"
+};
+
+static MEMENTRY *FindEntry(int Subsystem, const char *Structure);
+static void AddBlocks(MEMENTRY *Current, double NBlocks, size_t Size);
+static double BlockFootprint(size_t Size);
+static uchar *ReadClassMap(LISTPTR Input, MAPSIZE *Map, char *Section,
+			   char *Key, int ID);
+static int CompareFootprint(const void *A, const void *B);
+
+/*****************************************************************************
+  Function name: CallocMap()
+
+  Purpose      : Allocate and clear an NY by NX array, such as the buffer of
+                 a map that is read or written
+
+  Required     :
+    size_t NY             - Number of rows
+    size_t NX             - Number of columns
+    size_t Size           - Size of an element
+
+  Returns      : void * - as calloc(), NULL if the memory is not available
+                 or if NY * NX * Size does not fit in a size_t
+
+  Modifies     : The buffers of the table of allocations
+
+  Comments     : The product is checked before it is formed, so that a map
+                 of more than 2^31 pixels is allocated in full and a size
+                 that overflows is refused instead of wrapping around.
+                 Elements of the array are indexed with
+                 (size_t) y * NX + x.  The array is released with
+                 FreeMap().  It is recorded in the table until then, so
+                 that FreeMapBuffers() can release it when an error ends
+                 the initialization of a model instance while the array is
+                 in use.
+*****************************************************************************/
+void *CallocMap(size_t NY, size_t NX, size_t Size)
+{
+  int i;			/* counter */
+  void *Map;
+
+  if (NY > 0 && NX > SIZE_MAX / NY)
+    return NULL;
+  if (NY * NX > 0 && Size > SIZE_MAX / (NY * NX))
+    return NULL;
+
+  if ((Map = calloc(NY * NX, Size)) == NULL)
+    return NULL;
+  for (i = 0; i < MAXMAPBUFFERS; i++) {
+    if (Table->MapBuffer[i] == NULL) {
+      Table->MapBuffer[i] = Map;
+      break;
+    }
+  }
+
+  return Map;
+}
+
+/*****************************************************************************
+  Function name: FreeMap()
+
+  Purpose      : Release an array of CallocMap()
+
+  Required     :
+    void *Map - Array, or NULL
+
+  Returns      : void
+
+  Modifies     : The buffers of the table of allocations
+*****************************************************************************/
+void FreeMap(void *Map)
+{
+  int i;			/* counter */
+
+  if (Map == NULL)
+    return;
+  for (i = 0; i < MAXMAPBUFFERS; i++) {
+    if (Table->MapBuffer[i] == Map) {
+      Table->MapBuffer[i] = NULL;
+      break;
+    }
+  }
+  free(Map);
+}
+
+/*****************************************************************************
+  Function name: FreeMapBuffers()
+
+  Purpose      : Release the arrays of CallocMap() that are still recorded
+
+  Required     : None
+
+  Returns      : void
+
+  Modifies     : The buffers of the table of allocations
+
+  Comments     : Called when a model instance is released, after an error
+                 has ended its initialization in the middle of reading a
+                 map.  More than MAXMAPBUFFERS arrays at a time are not
+                 recorded.
+*****************************************************************************/
+void FreeMapBuffers(void)
+{
+  int i;			/* counter */
+
+  for (i = 0; i < MAXMAPBUFFERS; i++) {
+    free(Table->MapBuffer[i]);
+    Table->MapBuffer[i] = NULL;
+  }
+}
+
+/*****************************************************************************
+  Function name: TrackedCalloc()
+
+  Purpose      : Allocate and clear an array, and record the allocation
+
+  Required     :
+    size_t NElem          - Number of elements
+    size_t Size           - Size of an element
+    int Subsystem         - Subsystem, see memtrack.h
+    const char *Structure - Name of the model structure
+
+  Returns      : void * - as calloc(), NULL if the memory is not available
+
+  Modifies     : The table of allocations
+
+  Comments     : When the allocation fails the request and the memory
+                 allocated so far are printed, the caller reports the error
+*****************************************************************************/
+void *TrackedCalloc(size_t NElem, size_t Size, int Subsystem,
+		    const char *Structure)
+{
+  void *Ptr;
+
+  if ((Ptr = calloc(NElem, Size)) == NULL) {
+    fprintf(stderr, "Cannot allocate %.0f bytes for %s (%s), %.1f MB "
+	    "allocated so far\n", (double) NElem * Size, Structure,
+	    SubsystemName[Subsystem], TrackedBytes() / MB);
+    return NULL;
+  }
+  AddBlocks(FindEntry(Subsystem, Structure), 1., NElem * Size);
+
+  return Ptr;
+}
+
+/*****************************************************************************
+  Function name: TrackedMalloc()
+
+  Purpose      : Allocate a block, and record the allocation
+
+  Required     :
+    size_t Size           - Size of the block
+    int Subsystem         - Subsystem, see memtrack.h
+    const char *Structure - Name of the model structure
+
+  Returns      : void * - as malloc(), NULL if the memory is not available
+
+  Modifies     : The table of allocations
+*****************************************************************************/
+void *TrackedMalloc(size_t Size, int Subsystem, const char *Structure)
+{
+  void *Ptr;
+
+  if ((Ptr = malloc(Size)) == NULL) {
+    fprintf(stderr, "Cannot allocate %.0f bytes for %s (%s), %.1f MB "
+	    "allocated so far\n", (double) Size, Structure,
+	    SubsystemName[Subsystem], TrackedBytes() / MB);
+    return NULL;
+  }
+  AddBlocks(FindEntry(Subsystem, Structure), 1., Size);
+
+  return Ptr;
+}
+
+/*****************************************************************************
+  Function name: TrackedFree()
+
+  Purpose      : Free a block, and remove it from the record
+
+  Required     :
+    void *Ptr             - Block from TrackedCalloc() or TrackedMalloc()
+    size_t Size           - Size of the block as it was allocated
+    int Subsystem         - Subsystem, see memtrack.h
+    const char *Structure - Name of the model structure
+
+  Returns      : void
+
+  Modifies     : The table of allocations
+
+  Comments     : Nothing is done if Ptr is NULL
+*****************************************************************************/
+void TrackedFree(void *Ptr, size_t Size, int Subsystem,
+		 const char *Structure)
+{
+  if (Ptr == NULL)
+    return;
+  free(Ptr);
+  AddBlocks(FindEntry(Subsystem, Structure), -1., Size);
+}
+
+/*****************************************************************************
+  Function name: PredictAllocation()
+
+  Purpose      : Record allocations without making them
+
+  Required     :
+    double NBlocks        - Number of blocks
+    size_t Size           - Size of each block
+    int Subsystem         - Subsystem, see memtrack.h
+    const char *Structure - Name of the model structure
+
+  Returns      : void
+
+  Modifies     : The table of allocations
+*****************************************************************************/
+void PredictAllocation(double NBlocks, size_t Size, int Subsystem,
+		       const char *Structure)
+{
+  AddBlocks(FindEntry(Subsystem, Structure), NBlocks, Size);
+}
+
+/*****************************************************************************
+  Function name: PredictMemory()
+
+  Purpose      : Predict the long-lived allocations of a model run from the
+                 configuration
+
+  Required     :
+    LISTPTR Input         - Configuration
+    OPTIONSTRUCT *Options - Model options
+    MAPSIZE *Map          - Size of the model area
+    LAYER *Soil           - Soil layers of each soil type
+    LAYER *Veg            - Vegetation layers of each vegetation type
+    VEGTABLE *VType       - Vegetation types
+    int NDaySteps         - Number of time steps in a day
+
+  Returns      : void
+
+  Modifies     : The table of allocations
+
+  Comments     : Follows the allocations of InitTerrainMaps(),
+                 InitNetwork(), InitMetMaps(), InitInterpolationWeights(),
+                 InitSnowMap(), InitSedMap() and InitFineMaps().  Only the
+                 mask, soil and vegetation maps are read, the per-pixel
+                 arrays depend on them.  The road erosion arrays of
+                 InitParameters() depend on the road network and are not
+                 predicted.
+*****************************************************************************/
+void PredictMemory(LISTPTR Input, OPTIONSTRUCT *Options, MAPSIZE *Map,
+		   LAYER *Soil, LAYER *Veg, VEGTABLE *VType, int NDaySteps)
+{
+  char VarStr[BUFSIZE + 1];	/* String from the sediment configuration */
+  LISTPTR SedInput = NULL;	/* Sediment configuration */
+  MEMENTRY *SoilMap;		/* Table entries of the per-pixel arrays */
+  MEMENTRY *EvapMap;
+  MEMENTRY *PrecipMap;
+  MEMENTRY *Network = NULL;
+  MEMENTRY *FineMap = NULL;
+  MEMENTRY *TopoIndex = NULL;
+  uchar *Mask;			/* Basin mask */
+  uchar *SoilType;		/* Soil type of each pixel */
+  uchar *VegType;		/* Vegetation type of each pixel */
+  float DMass;			/* Pixel spacing of the mass wasting map */
+  double NY = Map->NY;		/* Number of rows */
+  long NCells = (long) Map->NY * Map->NX;
+  long NBasin = 0;		/* Number of pixels in the basin */
+  long i;			/* counter */
+  int NFine = 0;		/* Fine pixels in a pixel */
+  int NYFine = 0;		/* Rows in the fine map */
+  int NXFine = 0;		/* Columns in the fine map */
+  int NMaps;			/* Number of meteorological maps */
+  int NStats;			/* Number of meteorological stations */
+  int NSoil;			/* Soil layers of the current pixel */
+  int NVeg;			/* Vegetation layers of the current pixel */
+  int NParamLayers;		/* Layered values per pixel of the parameter
+				   maps */
+
+  Mask = ReadClassMap(Input, Map, "TERRAIN", "BASIN MASK FILE", 2);
+  SoilType = ReadClassMap(Input, Map, "SOILS", "SOIL MAP FILE", 3);
+  VegType = ReadClassMap(Input, Map, "VEGETATION", "VEGETATION MAP FILE", 5);
+
+  if (Options->Sediment) {
+    ReadInitFile(Options->SedFile, &SedInput);
+    GetInitString("PARAMETERS", "MASS WASTING SPACING", "", VarStr,
+		  (unsigned long) BUFSIZE, SedInput);
+    if (!CopyFloat(&DMass, VarStr, 1) || DMass <= 0.)
+      ReportError("MASS WASTING SPACING", 51);
+    DeleteList(SedInput);
+    NYFine = Map->NY * (Map->DY / DMass);
+    NXFine = Map->NX * (Map->DY / DMass);
+    NFine = (Map->DX / DMass) * (Map->DY / DMass);
+  }
+
+  /* the per-pixel arrays */
+  SoilMap = FindEntry(MEM_SOIL, "SoilMap");
+  EvapMap = FindEntry(MEM_METEOROLOGY, "EvapMap");
+  PrecipMap = FindEntry(MEM_METEOROLOGY, "PrecipMap");
+  if (Options->Components == FULL_MODEL)
+    Network = FindEntry(MEM_NETWORK, "Network");
+  if (Options->Sediment) {
+    FineMap = FindEntry(MEM_SEDIMENT, "FineMap");
+    TopoIndex = FindEntry(MEM_SEDIMENT, "OrderedTopoIndex");
+  }
+  for (i = 0; i < NCells; i++) {
+    if (!INBASIN(Mask[i]))
+      continue;
+    if (SoilType[i] < 1 || SoilType[i] > Soil->NTypes)
+      ReportError("SOIL MAP FILE", 32);
+    if (VegType[i] < 1 || VegType[i] > Veg->NTypes)
+      ReportError("VEGETATION MAP FILE", 32);
+    NBasin++;
+    NSoil = Soil->NLayers[SoilType[i] - 1];
+    NVeg = Veg->NLayers[VegType[i] - 1];
+    if (Options->Components == FULL_MODEL) {
+      AddBlocks(SoilMap, 1., (NSoil + 1) * sizeof(float));
+      AddBlocks(SoilMap, 2., NSoil * sizeof(float));
+    }
+    AddBlocks(EvapMap, 2., (NVeg + 1) * sizeof(float));
+    AddBlocks(EvapMap, 1., NVeg * sizeof(float));
+    AddBlocks(EvapMap, 1., NVeg * sizeof(float *));
+    AddBlocks(EvapMap, NVeg, NSoil * sizeof(float));
+    AddBlocks(PrecipMap, 2., NVeg * sizeof(float));
+    if (Network)
+      AddBlocks(Network, 2.,
+		(VType[VegType[i] - 1].NSoilLayers + 1) * sizeof(float));
+    if (FineMap) {
+      AddBlocks(FineMap, NFine, sizeof(FINEPIX));
+      AddBlocks(TopoIndex, 1., NFine * sizeof(ITEM));
+    }
+  }
+  free(Mask);
+  free(SoilType);
+  free(VegType);
+
+  /* the maps, an array of row pointers and a block for each row */
+  PredictAllocation(1., Map->NY * sizeof(TOPOPIX *), MEM_TERRAIN, "TopoMap");
+  PredictAllocation(NY, Map->NX * sizeof(TOPOPIX), MEM_TERRAIN, "TopoMap");
+  PredictAllocation(1., NBasin * sizeof(ITEM), MEM_TERRAIN, "OrderedCells");
+  PredictAllocation(1., Map->NY * sizeof(SOILPIX *), MEM_SOIL, "SoilMap");
+  PredictAllocation(NY, Map->NX * sizeof(SOILPIX), MEM_SOIL, "SoilMap");
+  PredictAllocation(1., Map->NY * sizeof(VEGPIX *), MEM_VEGETATION, "VegMap");
+  PredictAllocation(NY, Map->NX * sizeof(VEGPIX), MEM_VEGETATION, "VegMap");
+  PredictAllocation(1., Map->NY * sizeof(SNOWPIX *), MEM_SNOW, "SnowMap");
+  PredictAllocation(NY, Map->NX * sizeof(SNOWPIX), MEM_SNOW, "SnowMap");
+  PredictAllocation(1., Map->NY * sizeof(EVAPPIX *), MEM_METEOROLOGY,
+		    "EvapMap");
+  PredictAllocation(NY, Map->NX * sizeof(EVAPPIX), MEM_METEOROLOGY,
+		    "EvapMap");
+  PredictAllocation(1., Map->NY * sizeof(PRECIPPIX *), MEM_METEOROLOGY,
+		    "PrecipMap");
+  PredictAllocation(NY, Map->NX * sizeof(PRECIPPIX), MEM_METEOROLOGY,
+		    "PrecipMap");
+  PredictAllocation(1., Map->NY * sizeof(RADCLASSPIX *), MEM_METEOROLOGY,
+		    "RadMap");
+  PredictAllocation(NY, Map->NX * sizeof(RADCLASSPIX), MEM_METEOROLOGY,
+		    "RadMap");
+  if (Options->Components == FULL_MODEL) {
+    PredictAllocation(1., Map->NY * sizeof(ROADSTRUCT *), MEM_NETWORK,
+		      "Network");
+    PredictAllocation(NY, Map->NX * sizeof(ROADSTRUCT), MEM_NETWORK,
+		      "Network");
+  }
+
+  /* the storage order of InitCellOrder(), with at most NDIRS downslope
+     neighbors per pixel */
+  if (Options->CellOrder != ORDER_ELEVATION &&
+      Options->Components == FULL_MODEL && Options->Extent == BASIN &&
+      Options->HasNetwork && Options->Routing) {
+    PredictAllocation(1., NBasin * sizeof(COORD), MEM_TERRAIN, "CellOrder");
+    PredictAllocation(1., NBasin * sizeof(long), MEM_TERRAIN, "CellOrder");
+    PredictAllocation(1., (NBasin + 1) * sizeof(long), MEM_TERRAIN,
+		      "CellOrder");
+    PredictAllocation(1., NBasin * NDIRS * sizeof(long), MEM_TERRAIN,
+		      "CellOrder");
+    PredictAllocation(1., NBasin * NDIRS * sizeof(float), MEM_TERRAIN,
+		      "CellOrder");
+    PredictAllocation(1., NBasin * sizeof(double), MEM_TERRAIN, "CellOrder");
+    PredictAllocation(1., NBasin * sizeof(uchar), MEM_TERRAIN, "CellOrder");
+    PredictAllocation(6., NBasin * sizeof(float), MEM_TERRAIN, "CellOrder");
+  }
+
+  /* the parameter maps of InitParamMap() */
+  if (Options->ParamMaps && Options->Components == FULL_MODEL &&
+      Options->Ensemble.Mode != ENSEMBLE_SHARED) {
+    NParamLayers = ParamLayers(Soil, Veg, VType);
+    PredictAllocation(3., NCells * sizeof(float), MEM_SOIL, "ParamMap");
+    PredictAllocation(2., NCells * NParamLayers * sizeof(float), MEM_SOIL,
+		      "ParamMap");
+    PredictAllocation(1., NCells * sizeof(double), MEM_SOIL, "ParamMap");
+    PredictAllocation(1., NCells * sizeof(int), MEM_VEGETATION, "ParamMap");
+    PredictAllocation(1., NCells * NParamLayers * sizeof(float),
+		      MEM_VEGETATION, "ParamMap");
+    PredictAllocation(3., NCells * sizeof(float), MEM_VEGETATION,
+		      "ParamMap");
+  }
+
+  /* the meteorological maps of InitMetMaps() */
+  if (Options->MM5 == TRUE) {
+    NMaps = N_MM5_MAPS + (Options->HeatFlux == TRUE ? Soil->MaxLayers : 0);
+#ifdef COMPACT_MAPS
+    PredictAllocation(1., NMaps * sizeof(COMPACTMAP), MEM_METEOROLOGY,
+		      "MM5Input");
+    PredictAllocation(NMaps, (size_t) Map->NY * Map->NX *
+		      sizeof(unsigned short), MEM_METEOROLOGY, "MM5Input");
+#else
+    PredictAllocation(1., NMaps * sizeof(float **), MEM_METEOROLOGY,
+		      "MM5Input");
+    PredictAllocation(NMaps, Map->NY * sizeof(float *), MEM_METEOROLOGY,
+		      "MM5Input");
+    PredictAllocation(NMaps * NY, Map->NX * sizeof(float), MEM_METEOROLOGY,
+		      "MM5Input");
+#endif
+  }
+  else {
+    if (Options->PrecipType == RADAR) {
+      PredictAllocation(1.,
+			GetInitLong("METEOROLOGY", "RADAR NUMBER OF ROWS", 0,
+				    Input) * sizeof(RADARPIX *),
+			MEM_METEOROLOGY, "RadarMap");
+      PredictAllocation(GetInitLong("METEOROLOGY", "RADAR NUMBER OF ROWS", 0,
+				    Input),
+			GetInitLong("METEOROLOGY", "RADAR NUMBER OF COLUMNS",
+				    0, Input) * sizeof(RADARPIX),
+			MEM_METEOROLOGY, "RadarMap");
+    }
+    if (Options->PrecipLapse == MAP) {
+      PredictAllocation(1., Map->NY * sizeof(float *), MEM_METEOROLOGY,
+			"PrecipLapseMap");
+      PredictAllocation(NY, Map->NX * sizeof(float), MEM_METEOROLOGY,
+			"PrecipLapseMap");
+    }
+    if (Options->WindSource == MODEL) {
+      NMaps = GetInitLong("METEOROLOGY", "NUMBER OF WIND MAPS", 0, Input);
+      PredictAllocation(1., NMaps * sizeof(float **), MEM_METEOROLOGY,
+			"WindModel");
+      PredictAllocation(NMaps, Map->NY * sizeof(float *), MEM_METEOROLOGY,
+			"WindModel");
+      PredictAllocation(NMaps * NY, Map->NX * sizeof(float),
+			MEM_METEOROLOGY, "WindModel");
+    }
+  }
+  if (Options->Prism == TRUE &&
+      (Options->MM5 == FALSE || Options->QPF == TRUE)) {
+    PredictAllocation(1., Map->NY * sizeof(float *), MEM_METEOROLOGY,
+		      "PrismMap");
+    PredictAllocation(NY, Map->NX * sizeof(float), MEM_METEOROLOGY,
+		      "PrismMap");
+  }
+  if (Options->Shading == TRUE) {
+    PredictAllocation(1., NDaySteps * sizeof(uchar **), MEM_METEOROLOGY,
+		      "ShadowMap");
+    PredictAllocation(NDaySteps, Map->NY * sizeof(uchar *), MEM_METEOROLOGY,
+		      "ShadowMap");
+    PredictAllocation(NDaySteps * NY, Map->NX * sizeof(uchar),
+		      MEM_METEOROLOGY, "ShadowMap");
+    PredictAllocation(1., Map->NY * sizeof(float *), MEM_METEOROLOGY,
+		      "SkyViewMap");
+    PredictAllocation(NY, Map->NX * sizeof(float), MEM_METEOROLOGY,
+		      "SkyViewMap");
+  }
+
+#ifdef COMPACT_MAPS
+  /* the 16-bit codes of the static meteorology maps of CompactMaps() */
+  NMaps = (Options->Shading == TRUE ? 1 : 0);
+  if (Options->MM5 == FALSE) {
+    if (Options->PrecipLapse == MAP)
+      NMaps++;
+    if (Options->WindSource == MODEL)
+      NMaps += GetInitLong("METEOROLOGY", "NUMBER OF WIND MAPS", 0, Input);
+  }
+  if (NMaps > 0)
+    PredictAllocation(NMaps, (size_t) Map->NY * Map->NX *
+		      sizeof(unsigned short), MEM_METEOROLOGY, "CompactMap");
+#endif
+
+  /* the interpolation weights of each pixel */
+  PredictAllocation(1., Map->NY * sizeof(uchar **), MEM_METEOROLOGY,
+		    "MetWeights");
+  PredictAllocation(NY, Map->NX * sizeof(uchar *), MEM_METEOROLOGY,
+		    "MetWeights");
+  if (Options->MM5 == FALSE || Options->QPF == TRUE) {
+    NStats = GetInitLong("METEOROLOGY", "NUMBER OF STATIONS", 0, Input);
+    PredictAllocation(NCells, NStats * sizeof(uchar), MEM_METEOROLOGY,
+		      "MetWeights");
+  }
+
+  if (Options->Sediment) {
+    PredictAllocation(1., Map->NY * sizeof(SEDPIX *), MEM_SEDIMENT,
+		      "SedMap");
+    PredictAllocation(NY, Map->NX * sizeof(SEDPIX), MEM_SEDIMENT, "SedMap");
+    PredictAllocation(1., NYFine * sizeof(FINEPIX **), MEM_SEDIMENT,
+		      "FineMap");
+    PredictAllocation(NYFine, NXFine * sizeof(FINEPIX *), MEM_SEDIMENT,
+		      "FineMap");
+  }
+}
+
+/*****************************************************************************
+  Function name: ResetMemory()
+
+  Purpose      : Clear the table of allocations
+
+  Required     : void
+
+  Returns      : void
+
+  Modifies     : The table of allocations
+*****************************************************************************/
+void ResetMemory(void)
+{
+  Table->NEntries = 0;
+  Table->Last = NULL;
+}
+
+/*****************************************************************************
+  Function name: SetMemTable()
+
+  Purpose      : Record the next allocations in the table of a model
+                 instance
+
+  Required     :
+    MEMTABLE *Memory - Table of the instance, or NULL for the table of the
+                       process
+
+  Returns      : void
+
+  Modifies     : The table used by the other functions of this file
+
+  Comments     : Called by the library functions of Model.c on entry, and
+                 with NULL before they return.  The table is selected for
+                 the calling thread only
+*****************************************************************************/
+void SetMemTable(MEMTABLE *Memory)
+{
+  Table = Memory ? Memory : &ProcessTable;
+}
+
+/*****************************************************************************
+  Function name: GetMemTable()
+
+  Purpose      : Table of allocations of the calling thread
+
+  Required     : void
+
+  Returns      : MEMTABLE * - table selected by SetMemTable()
+
+  Modifies     : void
+*****************************************************************************/
+MEMTABLE *GetMemTable(void)
+{
+  return Table;
+}
+
+/*****************************************************************************
+  Function name: TrackedBytes()
+
+  Purpose      : Total footprint of the recorded allocations
+
+  Required     : void
+
+  Returns      : double - footprint (bytes)
+
+  Modifies     : void
+*****************************************************************************/
+double TrackedBytes(void)
+{
+  double Total = 0.;
+  int i;
+
+  for (i = 0; i < Table->NEntries; i++)
+    Total += Table->Entry[i].Footprint;
+
+  return Total;
+}
+
+/*****************************************************************************
+  Function name: ReportMemory()
+
+  Purpose      : Print the recorded allocations by subsystem and by
+                 structure
+
+  Required     :
+    FILE *OutFile     - File to print to
+    const char *Title - What the table shows
+
+  Returns      : void
+
+  Modifies     : void
+*****************************************************************************/
+void ReportMemory(FILE *OutFile, const char *Title)
+{
+  MEMENTRY *Sorted[MAXSTRUCTURES];
+  double Bytes = 0.;
+  double Blocks = 0.;
+  double Footprint = 0.;
+  double Subsystem[NSUBSYSTEMS];
+  int i;
+
+  memset(Subsystem, 0, sizeof(Subsystem));
+  for (i = 0; i < Table->NEntries; i++) {
+    Sorted[i] = &Table->Entry[i];
+    Bytes += Table->Entry[i].Bytes;
+    Blocks += Table->Entry[i].Blocks;
+    Footprint += Table->Entry[i].Footprint;
+    Subsystem[Table->Entry[i].Subsystem] += Table->Entry[i].Footprint;
+  }
+  qsort(Sorted, Table->NEntries, sizeof(MEMENTRY *), CompareFootprint);
+
+  fprintf(OutFile, "\n%s: %.1f MB in %.0f blocks, %.1f MB with allocator "
+	  "overhead\n", Title, Bytes / MB, Blocks, Footprint / MB);
+  fprintf(OutFile, "%-18s %12s %8s\n", "Subsystem", "MB", "%");
+  for (i = 0; i < NSUBSYSTEMS; i++)
+    if (Subsystem[i] > 0.)
+      fprintf(OutFile, "%-18s %12.2f %8.1f\n", SubsystemName[i],
+	      Subsystem[i] / MB, 100. * Subsystem[i] / Footprint);
+  fprintf(OutFile, "%-18s %-12s %12s %10s %14s\n", "Structure", "Subsystem",
+	  "Blocks", "MB", "With overhead");
+  for (i = 0; i < Table->NEntries; i++)
+    fprintf(OutFile, "%-18s %-12s %12.0f %10.2f %14.2f\n", Sorted[i]->Name,
+	    SubsystemName[Sorted[i]->Subsystem], Sorted[i]->Blocks,
+	    Sorted[i]->Bytes / MB, Sorted[i]->Footprint / MB);
+}
+
+/*****************************************************************************
+  Function name: ReportPeakMemory()
+
+  Purpose      : Print the peak resident memory of the process
+
+  Required     :
+    FILE *OutFile - File to print to
+
+  Returns      : void
+
+  Modifies     : void
+*****************************************************************************/
+void ReportPeakMemory(FILE *OutFile)
+{
+  struct rusage Usage;
+  double Peak;
+
+  if (getrusage(RUSAGE_SELF, &Usage) != 0)
+    return;
+#ifdef __APPLE__
+  Peak = (double) Usage.ru_maxrss;
+#else
+  Peak = 1024. * Usage.ru_maxrss;
+#endif
+  fprintf(OutFile, "\nPeak resident memory %.1f MB, %.1f MB of model "
+	  "arrays allocated at initialization\n", Peak / MB,
+	  TrackedBytes() / MB);
+}
+
+/*****************************************************************************
+  FindEntry() - table entry of a structure, added if it is not there yet
+*****************************************************************************/
+static MEMENTRY *FindEntry(int Subsystem, const char *Structure)
+{
+  MEMENTRY *Entry = Table->Entry;
+  int i;
+
+  /* the allocations of a structure mostly follow each other */
+  if (Table->Last && Table->Last->Subsystem == Subsystem &&
+      (Table->Last->Name == Structure ||
+       strcmp(Table->Last->Name, Structure) == 0))
+    return Table->Last;
+
+  for (i = 0; i < Table->NEntries; i++)
+    if (Entry[i].Subsystem == Subsystem &&
+	strcmp(Entry[i].Name, Structure) == 0)
+      break;
+
+  if (i == Table->NEntries) {
+    if (Table->NEntries == MAXSTRUCTURES) {
+      /* keep counting in the last entry */
+      i = MAXSTRUCTURES - 1;
+      Entry[i].Name = "Other";
+    }
+    else {
+      memset(&Entry[i], 0, sizeof(MEMENTRY));
+      Entry[i].Name = Structure;
+      Entry[i].Subsystem = Subsystem;
+      Table->NEntries++;
+    }
+  }
+  Table->Last = &Entry[i];
+
+  return Table->Last;
+}
+
+/*****************************************************************************
+  AddBlocks() - add blocks of one size to a table entry
+*****************************************************************************/
+static void AddBlocks(MEMENTRY *Current, double NBlocks, size_t Size)
+{
+  Current->Blocks += NBlocks;
+  Current->Bytes += NBlocks * Size;
+  Current->Footprint += NBlocks * BlockFootprint(Size);
+}
+
+/*****************************************************************************
+  BlockFootprint() - bytes taken by a block of a given size
+*****************************************************************************/
+static double BlockFootprint(size_t Size)
+{
+  size_t Chunk;
+
+  Chunk = (Size + BLOCKHEADER + BLOCKALIGN - 1) & ~((size_t) BLOCKALIGN - 1);
+
+  return (double) (Chunk < MINBLOCK ? MINBLOCK : Chunk);
+}
+
+/*****************************************************************************
+  ReadClassMap() - read a map of byte values named in the configuration
+*****************************************************************************/
+static uchar *ReadClassMap(LISTPTR Input, MAPSIZE *Map, char *Section,
+			   char *Key, int ID)
+{
+  char FileName[BUFSIZE + 1];
+  char VarName[BUFSIZE + 1];
+  int NumberType;
+  uchar *Array;
+
+  GetInitString(Section, Key, "", FileName, (unsigned long) BUFSIZE, Input);
+  if (IsEmptyStr(FileName))
+    ReportError(Key, 51);
+
+  GetVarName(ID, 0, VarName);
+  GetVarNumberType(ID, &NumberType);
+  if (!(Array = (uchar *) calloc((size_t) Map->NX * Map->NY,
+				 SizeOfNumberType(NumberType))))
+    ReportError("PredictMemory()", 1);
+  Read2DMatrix(FileName, Array, NumberType, Map->NY, Map->NX, 0, VarName, 0);
+
+  return Array;
+}
+
+/*****************************************************************************
+  CompareFootprint() - qsort() order of table entries, largest first
+*****************************************************************************/
+static int CompareFootprint(const void *A, const void *B)
+{
+  const MEMENTRY *EntryA = *(const MEMENTRY **) A;
+  const MEMENTRY *EntryB = *(const MEMENTRY **) B;
+
+  if (EntryA->Footprint > EntryB->Footprint)
+    return -1;
+  if (EntryA->Footprint < EntryB->Footprint)
+    return 1;
+  return 0;
+}
@@ -0,0 +1,1912 @@
+/*
+ * SUMMARY:      Model.c - Run DHSVM as a library (libdhsvm)
+ * USAGE:        Part of DHSVM
+ *
+ * AUTHOR:       DHSVM development team
+ * ORG:          University of Washington, Department of Civil Engineering
+ * E-MAIL:
+ * ORIG-DATE:    Oct-2026
+ * DESCRIPTION:  Initialize, step and release a model instance.  The
+ *               instance owns the whole model state, see model.h.  The
+ *               stand-alone model in MainDHSVM.c is a thin driver around
+ *               these functions, and other programs link libdhsvm.a.
+ * DESCRIP-END.
+ * FUNCTIONS:    dhsvm_init()
+ *               dhsvm_step()
+ *               dhsvm_get_field()
+ *               dhsvm_set_forcing()
+ *               dhsvm_free()
+ *               dhsvm_autotune()
+ * COMMENTS:     The globals of an instance (globals.h) are thread-local.
+ *               They are copied into the instance at the end of
+ *               dhsvm_init() and put back in the calling thread at the
+ *               start of every call, so that instances can be stepped in
+ *               turn, or at the same time from different threads.  The
+ *               profile, the table of allocations (memtrack.h) and the
+ *               autotune settings are kept in the instance itself.  The
+ *               modes that fork the process (ENSEMBLE MODE = PROCESS and
+ *               calibration) are only available in the stand-alone model.
+ * $Id: Model.c,v 1.0 2026/10/17 Exp $
+ */
+
+/******************************************************************************/
+/*				    INCLUDES                                  */
+/******************************************************************************/
+#include <setjmp.h>
+#include <time.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#include <unistd.h>
+#include "settings.h"
+#include "constants.h"
+#include "data.h"
+#include "DHSVMerror.h"
+#include "functions.h"
+#include "fileio.h"
+#include "getinit.h"
+#include "sizeofnt.h"
+#include "DHSVMChannel.h"
+#include "channel.h"
+#include "channel_grid.h"
+#include "sweep.h"
+#include "ensemble.h"
+#include "server.h"
+#include "dhsvm.h"
+#include "model.h"
+#include "profile.h"
+#include "progress.h"
+#include "memtrack.h"
+#include "dispatch.h"
+#include "tuning.h"
+#include "globals.h"
+#include "order.h"
+
+/******************************************************************************/
+/*				GLOBAL VARIABLES                              */
+/******************************************************************************/
+
+/* global function pointers, of the thread that runs a model instance */
+__thread void (*CreateMapFile) (char *FileName, ...);
+__thread int (*Read2DMatrix) (char *FileName, void *Matrix, int NumberType,
+			      int NY, int NX, int NDataSet, ...);
+__thread int (*Write2DMatrix) (char *FileName, void *Matrix, int NumberType,
+			       int NY, int NX, ...);
+
+/* global strings */
+char *version = "Version 3.0 Mon August 9, 2004"; /* store version string */
+char commandline[BUFSIZE + 1] = "";		/* store command line */
+__thread char fileext[BUFSIZ + 1] = "";		/* file extension */
+__thread char errorstr[BUFSIZ + 1] = "";	/* error message */
+
+/* TRUE in the stand-alone model (MainDHSVM.c), which can fork */
+int StandAlone = FALSE;
+
+/* maps that dhsvm_get_field() can return */
+enum { TOPOFIELD, SOILFIELD, VEGFIELD, SNOWFIELD, EVAPFIELD, PRECIPFIELD,
+  RADFIELD };
+
+typedef struct {
+  char *Name;			/* Name of the field, as in VarID.c */
+  int Source;			/* Map that holds the field */
+  size_t Offset;		/* Offset of the field in a pixel */
+  int Type;			/* Number type */
+} FIELDINFO;
+
+/* the elevation and the soil depth are 16-bit codes with COMPACT_MAPS,
+   see compact.h */
+static FIELDINFO Fields[] = {
+#ifdef COMPACT_MAPS
+  {"Basin.Mask", TOPOFIELD, offsetof(TOPOPIX, Mask), NC_BYTE},
+  {"Soil.Type", SOILFIELD, offsetof(SOILPIX, Soil), NC_SHORT},
+#else
+  {"Basin.DEM", TOPOFIELD, offsetof(TOPOPIX, Dem), NC_FLOAT},
+  {"Basin.Mask", TOPOFIELD, offsetof(TOPOPIX, Mask), NC_BYTE},
+  {"Soil.Type", SOILFIELD, offsetof(SOILPIX, Soil), NC_INT},
+  {"Soil.Depth", SOILFIELD, offsetof(SOILPIX, Depth), NC_FLOAT},
+#endif
+  {"Veg.Type", VEGFIELD, offsetof(VEGPIX, Veg), NC_INT},
+  {"Evap.ETot", EVAPFIELD, offsetof(EVAPPIX, ETot), NC_FLOAT},
+  {"Precip", PRECIPFIELD, offsetof(PRECIPPIX, Precip), NC_FLOAT},
+  {"Rad.Beam", RADFIELD, offsetof(RADCLASSPIX, Beam), NC_FLOAT},
+  {"Rad.Diffuse", RADFIELD, offsetof(RADCLASSPIX, Diffuse), NC_FLOAT},
+  {"Snow.HasSnow", SNOWFIELD, offsetof(SNOWPIX, HasSnow), NC_BYTE},
+  {"Snow.Swq", SNOWFIELD, offsetof(SNOWPIX, Swq), NC_FLOAT},
+  {"Snow.Melt", SNOWFIELD, offsetof(SNOWPIX, Melt), NC_FLOAT},
+  {"Snow.PackWater", SNOWFIELD, offsetof(SNOWPIX, PackWater), NC_FLOAT},
+  {"Snow.TPack", SNOWFIELD, offsetof(SNOWPIX, TPack), NC_FLOAT},
+  {"Snow.SurfWater", SNOWFIELD, offsetof(SNOWPIX, SurfWater), NC_FLOAT},
+  {"Snow.TSurf", SNOWFIELD, offsetof(SNOWPIX, TSurf), NC_FLOAT},
+  {"Snow.ColdContent", SNOWFIELD, offsetof(SNOWPIX, ColdContent), NC_FLOAT},
+  {"Soil.TableDepth", SOILFIELD, offsetof(SOILPIX, TableDepth), NC_FLOAT},
+  {"Soil.NetFlux", SOILFIELD, offsetof(SOILPIX, SatFlow), NC_FLOAT},
+  {"Soil.TSurf", SOILFIELD, offsetof(SOILPIX, TSurf), NC_FLOAT},
+  {"Soil.Qnet", SOILFIELD, offsetof(SOILPIX, Qnet), NC_FLOAT},
+  {"Soil.Qs", SOILFIELD, offsetof(SOILPIX, Qs), NC_FLOAT},
+  {"Soil.Qe", SOILFIELD, offsetof(SOILPIX, Qe), NC_FLOAT},
+  {"Soil.Qg", SOILFIELD, offsetof(SOILPIX, Qg), NC_FLOAT},
+  {"Soil.Qst", SOILFIELD, offsetof(SOILPIX, Qst), NC_FLOAT},
+  {"Soil.Runoff", SOILFIELD, offsetof(SOILPIX, Runoff), NC_FLOAT},
+  {"SoilMap.IExcess", SOILFIELD, offsetof(SOILPIX, IExcess), NC_FLOAT},
+  {"SoilMap.InfiltAcc", SOILFIELD, offsetof(SOILPIX, InfiltAcc), NC_FLOAT},
+  {NULL, 0, 0, 0}
+};
+
+static DHSVM *NewModel(const char *ConfigFile, TUNING *Candidate);
+static void InitModel(DHSVM *Model, const char *ConfigFile);
+static void SwapMember(DHSVM *Model, int e);
+static int MoreSteps(DHSVM *Model);
+static void RunStep(DHSVM *Model);
+static void EndRun(DHSVM *Model);
+static void ReleaseModel(DHSVM *Model);
+static void CloseOutput(DUMPSTRUCT *Dump, CHANNEL *ChannelData);
+static void CloseFile(FILE **File);
+static void FreeDump(DUMPSTRUCT *Dump);
+static void FreeRows(void **Rows, int NY);
+static void FreeLayerArrays(DHSVM *Model);
+static void FreeStateMaps(DHSVM *Model);
+static void FreeTables(DHSVM *Model);
+static void FreeAggregated(AGGREGATED *Total, int MaxVegLayers);
+static void FreeMaps(void ***Maps, int N, int NY);
+static void PlaceLayerArrays(DHSVM *Model);
+static int VegLayers(void *Arg, int y, int x, int *NArrays);
+static int VegLayersAndSoil(void *Arg, int y, int x, int *NArrays);
+static int SoilLayers(void *Arg, int y, int x, int *NArrays);
+static int SoilLayersAndSaturated(void *Arg, int y, int x, int *NArrays);
+static int SoilLayersPerVegLayer(void *Arg, int y, int x, int *NArrays);
+static double TimeCandidate(const char *ConfigFile, TUNING *Candidate,
+			    MAPSIZE *Map, char *Path);
+static double Clock(void);
+
+/*****************************************************************************
+  Function name: dhsvm_init()
+
+  Purpose      : Read the configuration file and initialize a model instance
+
+  Required     :
+    const char *ConfigFile - Name of the configuration file
+
+  Returns      : DHSVM * - The model instance, at the start of the run, or
+                           NULL if the configuration or the input has an
+                           error
+
+  Modifies     : The globals of the calling thread, see the comments at
+                 the top
+
+  Comments     : The error is printed by ReportError(), and the arrays and
+                 files of the instance opened before the error are
+                 released.  ENSEMBLE MODE = PROCESS and calibration runs
+                 fork the process and are refused, they are only
+                 available in the stand-alone model.
+*****************************************************************************/
+DHSVM *dhsvm_init(const char *ConfigFile)
+{
+  return NewModel(ConfigFile, NULL);
+}
+
+/*****************************************************************************
+  NewModel()
+
+  Allocate and initialize a model instance, with the settings of an
+  autotune candidate if Candidate is not NULL.  Returns NULL if the
+  initialization reports an error
+*****************************************************************************/
+static DHSVM *NewModel(const char *ConfigFile, TUNING *Candidate)
+{
+  DHSVM *Model;			/* Model instance */
+  jmp_buf Return;		/* Where ReportError() returns to */
+
+  if (!(Model = (DHSVM *) calloc(1, sizeof(DHSVM)))) {
+    printf("Cannot allocate the model instance of %s\n", ConfigFile);
+    return NULL;
+  }
+  if (Candidate) {
+    Model->Candidate = *Candidate;
+    Model->HasCandidate = TRUE;
+  }
+
+  /* release what was set up before the error */
+  if (setjmp(Return) != 0) {
+    SetErrorReturn(NULL);
+    ReleaseModel(Model);
+    return NULL;
+  }
+  SetErrorReturn(&Return);
+  SetMemTable(&(Model->Memory));
+  SetProfile(&(Model->Profile));
+
+  InitModel(Model, ConfigFile);
+
+  SetErrorReturn(NULL);
+  SetMemTable(NULL);
+  SetProfile(NULL);
+
+  return Model;
+}
+
+/*****************************************************************************
+  InitModel()
+
+  The initialization of dhsvm_init()
+*****************************************************************************/
+static void InitModel(DHSVM *Model, const char *ConfigFile)
+{
+  time_t tloc;
+  int i;
+  int j;
+  int e;			/* ensemble member counter */
+  char *Argv[2];		/* command line for InitXGraphics() */
+
+  /* in an MPI run all ranks start here */
+  InitParallel(NULL, NULL, &(Model->Options.Parallel));
+
+  if (commandline[0] == '\0')
+    sprintf(commandline, "libdhsvm %s", ConfigFile);
+  strcpy(Model->InFiles.Const, ConfigFile);
+
+  printf("\nRunning DHSVM %s\n", version);
+  printf("\nSTARTING INITIALIZATION PROCEDURES\n\n");
+
+  ReadInitFile(Model->InFiles.Const, &(Model->Input));
+
+  InitConstants(Model->Input, &(Model->Options), &(Model->Map),
+		&(Model->SolarGeo), &(Model->Time));
+
+  /* a library call must not fork the calling program */
+  if (!StandAlone && Model->Options.Ensemble.NMembers > 0 &&
+      Model->Options.Ensemble.Mode == ENSEMBLE_PROCESS)
+    ReportError("ENSEMBLE MODE = PROCESS outside the stand-alone model", 65);
+  if (!StandAlone && Model->Options.Calibration.Active)
+    ReportError("Calibration outside the stand-alone model", 65);
+
+  /* choose the vector kernels for the instruction set of this processor */
+  printf("Using the %s kernels\n",
+	 CpuName(InitDispatch(Model->Options.Cpu)));
+
+  InitFileIO(Model->Options.FileFormat);
+  InitTables(Model->Time.NDaySteps, Model->Input, &(Model->Options),
+	     &(Model->SType), &(Model->Soil), &(Model->VType), &(Model->Veg),
+	     &(Model->SnowAlbedo));
+
+  InitTerrainMaps(Model->Input, &(Model->Options), &(Model->Map),
+		  &(Model->Soil), &(Model->TopoMap), &(Model->SoilMap),
+		  &(Model->VegMap));
+
+  CheckOut(Model->Options.CanopyRadAtt, Model->Options.Components,
+	   Model->Veg, Model->Soil, Model->VType, Model->SType, &(Model->Map),
+	   Model->TopoMap, Model->VegMap, Model->SoilMap);
+
+  if (Model->Options.HasNetwork)
+    InitChannel(Model->Input, &(Model->Map), Model->Time.Dt,
+		&(Model->ChannelData), Model->SoilMap, &(Model->MaxStreamID),
+		&(Model->MaxRoadID), &(Model->Options));
+  else if (Model->Options.Extent == BASIN &&
+	   Model->Options.Components == FULL_MODEL)
+    InitUnitHydrograph(Model->Input, &(Model->Map), Model->TopoMap,
+		       &(Model->UnitHydrograph),
+		       &(Model->Hydrograph), &(Model->HydrographInfo));
+ 
+  if (Model->Options.Components == FULL_MODEL)
+    InitNetwork(Model->Map.NY, Model->Map.NX, Model->Map.DX, Model->Map.DY,
+		Model->TopoMap, Model->SoilMap, 
+		Model->VegMap, Model->VType, &(Model->Network),
+		&(Model->ChannelData), Model->Veg, &(Model->Options));
+
+  InitMetSources(Model->Input, &(Model->Options), &(Model->Map),
+		 Model->Soil.MaxLayers, &(Model->Time),
+		 &(Model->InFiles), &(Model->NStats), &(Model->Stat),
+		 &(Model->Radar), &(Model->MM5Map));
+
+  /* the following piece of code is for the UW PRISM project */
+  /* for real-time verification of SWE at Snotel sites */
+  /* Other users, set OPTION.SNOTEL to FALSE, or use TRUE with caution */
+
+  if (Model->Options.Snotel == TRUE && Model->Options.Outside == FALSE) {
+    printf
+      ("Warning: All met stations locations are being set to the vegetation class GLACIER\n");
+    printf
+      ("Warning: This requires that you have such a vegetation class in your vegetation table\n");
+    printf("To disable this feature set Snotel OPTION to FALSE\n");
+    for (i = 0; i < Model->NStats; i++) {
+      printf("veg type for station %d is %d ", i,
+	     Model->VegMap[Model->Stat[i].Loc.N][Model->Stat[i].Loc.E].Veg);
+      for (j = 0; j < Model->Veg.NTypes; j++) {
+	if (Model->VType[j].Index == GLACIER) {
+	  Model->VegMap[Model->Stat[i].Loc.N][Model->Stat[i].Loc.E].Veg = j;
+	  break;
+	}
+      }
+      if (j == Model->Veg.NTypes) {	/* glacier class not found */
+	ReportError("dhsvm_init", 62);
+      }
+      printf("setting to glacier type (assumed bare class): %d\n", j);
+    }
+  }
+
+  /* only simulate the subbasin upstream of the clip target, on a grid
+     cropped to the subbasin */
+  if (Model->Options.Clip.Active)
+    ClipToSubbasin(&(Model->Options), &(Model->Map), &(Model->Soil),
+		   Model->VType, &(Model->TopoMap), &(Model->SoilMap),
+		   &(Model->VegMap), &(Model->Network), &(Model->ChannelData),
+		   Model->NStats, Model->Stat);
+
+  /* in an MPI run each rank simulates the pixels of a few subbasins, on a
+     grid cropped to them */
+  PartitionBasin(&(Model->Options), &(Model->Map), &(Model->Soil),
+		 Model->VType, &(Model->TopoMap), &(Model->SoilMap),
+		 &(Model->VegMap), &(Model->Network), &(Model->ChannelData),
+		 Model->NStats, Model->Stat, &(Model->Radar),
+		 &(Model->MM5Map));
+
+  InitMetMaps(Model->Time.NDaySteps, &(Model->Map), &(Model->Radar),
+	      &(Model->Options), Model->InFiles.WindMapPath,
+	      Model->InFiles.PrecipLapseFile, &(Model->PrecipLapseMap),
+	      &(Model->PrismMap),
+	      &(Model->ShadowMap), &(Model->SkyViewMap), &(Model->EvapMap),
+	      &(Model->PrecipMap),
+	      &(Model->RadarMap), &(Model->RadMap), Model->SoilMap,
+	      &(Model->Soil), Model->VegMap, &(Model->Veg), Model->TopoMap,
+	      &(Model->MM5Input), &(Model->WindModel));
+
+  InitInterpolationWeights(&(Model->Map), &(Model->Options), Model->TopoMap,
+			   &(Model->MetWeights), Model->Stat, Model->NStats);
+
+  if (Model->Options.Clip.Active)
+    DropUnusedStations(&(Model->Options), &(Model->Map), Model->TopoMap,
+		       Model->MetWeights, &(Model->NStats), Model->Stat);
+
+  /* in the parent of an ensemble run InitDump() only reads the paths, the
+     output is opened by the members */
+  InitDump(Model->Input, &(Model->Options), &(Model->Map),
+	   Model->Soil.MaxLayers, Model->Veg.MaxLayers, Model->Time.Dt,
+	   Model->TopoMap, &(Model->Dump), &(Model->NGraphics),
+	   &(Model->which_graphics));
+
+  /* threads, tiles and output buffer left out of the configuration file
+     come from the tuning file of DHSVM -autotune */
+  ApplyTuning(&(Model->Options), &(Model->Map), Model->Dump.Path,
+	      Model->HasCandidate ? &(Model->Candidate) : NULL);
+
+  if (Model->Options.HasNetwork == TRUE)
+    ReadChannelState(Model->Dump.InitStatePath, &(Model->Time.Start),
+		     Model->ChannelData.streams);
+
+  InitSnowMap(&(Model->Map), &(Model->SnowMap));
+  InitAggregated(Model->Veg.MaxLayers, Model->Soil.MaxLayers,
+		 &(Model->Total));
+
+  InitModelState(&(Model->Time.Start), &(Model->Map), &(Model->Options),
+		 Model->PrecipMap, Model->SnowMap, Model->SoilMap,
+		 Model->Soil, Model->SType, Model->VegMap, Model->Veg,
+		 Model->VType, Model->Dump.InitStatePath,
+		 Model->SnowAlbedo, Model->TopoMap, Model->Network,
+		 &(Model->HydrographInfo), Model->Hydrograph);
+
+  InitNewMonth(&(Model->Time), &(Model->Options), &(Model->Map),
+	       Model->TopoMap, Model->PrismMap, Model->ShadowMap,
+	       Model->RadMap, &(Model->InFiles), Model->Veg.NTypes,
+	       Model->VType, Model->NStats, Model->Stat, 
+	       Model->Dump.InitStatePath);
+
+  InitNewDay(Model->Time.Current.JDay, &(Model->SolarGeo));
+
+  /* in an ensemble run the initialization so far, including the initial
+     model state, is shared by all members.  RunEnsemble() only returns in
+     the member processes, which open their own output */
+  if (Model->Options.Ensemble.NMembers > 0 &&
+      Model->Options.Ensemble.Mode == ENSEMBLE_PROCESS) {
+    RunEnsemble(&(Model->Options.Ensemble), Model->NStats, Model->Stat);
+    PerturbParameters(&(Model->Options.Ensemble), &(Model->Soil),
+		      Model->SType);
+    InitDump(Model->Input, &(Model->Options), &(Model->Map),
+	     Model->Soil.MaxLayers, Model->Veg.MaxLayers, Model->Time.Dt,
+	     Model->TopoMap, &(Model->Dump), &(Model->NGraphics),
+	     &(Model->which_graphics));
+  }
+
+  /* in a calibration run the initialization so far, including the initial
+     model state, is shared by all parameter sets.  RunCalibration() only
+     returns in the processes that evaluate a parameter set */
+  if (Model->Options.Calibration.Active) {
+    RunCalibration(&(Model->Options.Calibration), Model->NStats, Model->Stat);
+    InitCalibrationDump(&(Model->Options.Calibration), Model->Dump.Path);
+    ApplyCalibration(&(Model->Options.Calibration), &(Model->Map),
+		     &(Model->Soil), &(Model->Veg), Model->SType, Model->VType,
+		     Model->TopoMap, Model->SoilMap, Model->VegMap,
+		     Model->Network);
+  }
+
+  if (Model->Options.HasNetwork == TRUE)
+    InitChannelDump(&(Model->ChannelData), Model->Dump.Path);
+
+  InitProfile(Model->Options.Profile || Model->Options.Progress,
+	      Model->Options.Profile,
+	      Model->Options.Profile && Model->Options.ProfileSteps,
+	      Model->Options.NThreads > 1, Model->Dump.Path);
+  InitProgress(&(Model->Progress), Model->Options.Progress &&
+	       Model->Options.Parallel.Rank == 0,
+	       Model->Options.ProgressInterval, Model->Dump.Path,
+	       Model->Options.Parallel.Active ?
+	       Model->Options.Parallel.NCells : Model->Map.NumCells,
+	       &(Model->Time));
+
+  if (Model->NGraphics > 0) {
+    printf("Initialzing X11 display and graphics \n");
+    Argv[0] = "DHSVM";
+    Argv[1] = NULL;
+    InitXGraphics(1, Argv, Model->Map.NY, Model->Map.NX, Model->NGraphics,
+		  &(Model->MetMap));
+  }
+
+  Model->shade_offset = FALSE;
+  if (Model->Options.Shading == TRUE)
+    Model->shade_offset = TRUE;
+
+  /* if all ensemble members run in this process, set up the model state of
+     the other members.  The first member uses the model state set up above */
+  Model->NMembers = 1;
+  if (Model->Options.Ensemble.Mode == ENSEMBLE_SHARED) {
+    Model->NMembers = Model->Options.Ensemble.NMembers;
+    InitMemberStates(Model->Input, &(Model->Options), &(Model->Map),
+		     &(Model->Time), &(Model->Soil), &(Model->Veg),
+		     Model->SType, Model->VType, Model->VegMap,
+		     Model->TopoMap, Model->SnowAlbedo,
+		     &(Model->HydrographInfo), Model->Hydrograph,
+		     &(Model->MaxStreamID), &(Model->MaxRoadID),
+		     &(Model->Members));
+    Model->Members[0].Total = Model->Total;
+    Model->Members[0].Mass = Model->Mass;
+    Model->Members[0].Dump = Model->Dump;
+    Model->Members[0].ChannelData = Model->ChannelData;
+    Model->Members[0].EvapMap = Model->EvapMap;
+    Model->Members[0].PrecipMap = Model->PrecipMap;
+    Model->Members[0].Network = Model->Network;
+    Model->Members[0].SnowMap = Model->SnowMap;
+    Model->Members[0].SoilMap = Model->SoilMap;
+    Model->Members[0].VegMap = Model->VegMap;
+    Model->Members[0].Hydrograph = Model->Hydrograph;
+    InitMemberSweep(Model->NMembers, Model->Members, &(Model->MemberSweep));
+    Model->Options.Ensemble.Member = 0;
+  }
+
+  /* Done with initialization, delete the list with input strings */
+  DeleteList(Model->Input);
+  Model->Input = NULL;
+
+  if (Model->Options.Extent == MULTIPOINT) {
+    if (!(Model->PointMet =
+	  (PIXMET *) calloc(Model->Options.NPoints, sizeof(PIXMET))))
+      ReportError("dhsvm_init", 1);
+    InitMultiPointDump(Model->Dump.Path, &(Model->Map), &(Model->Options),
+		       &(Model->Time), Model->Soil.MaxLayers,
+		       &(Model->Dump.MultiPoint));
+  }
+
+  /*****************************************************************************
+  Sediment Initialization Procedures 
+  *****************************************************************************/
+  if(Model->Options.Sediment) {
+     time (&tloc);
+     srand (tloc);
+  /* Randomize Random Generator */
+ 
+  /* Commenting the line above and uncommenting the line below 
+     allows for the comparison of scenarios. */
+  /*  srand48 (0);  */
+ 
+
+    printf("\nSTARTING SEDIMENT INITIALIZATION PROCEDURES\n\n");
+
+    ReadInitFile(Model->Options.SedFile, &(Model->Input));
+
+    InitParameters(Model->Input, &(Model->Options), &(Model->Map),
+		   &(Model->Network), &(Model->ChannelData), Model->TopoMap,
+		   &(Model->Time), Model->SedDiams);
+
+    InitSedimentTables(Model->Time.NDaySteps, Model->Input, &(Model->SedType),
+		       &(Model->SType), &(Model->VType), &(Model->Soil),
+		       &(Model->Veg));
+
+    InitFineMaps(Model->Input, &(Model->Options), &(Model->Map),
+		 &(Model->Soil), &(Model->TopoMap), &(Model->SoilMap),
+		 &(Model->FineMap));
+
+    if (Model->Options.HasNetwork){ 
+      printf("Initializing channel sediment\n\n");
+      InitChannelSedimentDump(&(Model->ChannelData), Model->Dump.Path,
+			      Model->Options.ChannelRouting); 
+      InitChannelSediment(Model->ChannelData.streams, &(Model->Total));
+      InitChannelSediment(Model->ChannelData.roads, &(Model->Total));
+    }
+
+    InitSedMap( &(Model->Map), &(Model->SedMap));
+
+    /* Done with initialization, delete the list with input strings */
+    DeleteList(Model->Input);
+    Model->Input = NULL;
+  }
+
+  /* setup for mass balance calculations */
+  for (e = 0; e < Model->NMembers; e++) {
+    SwapMember(Model, e);
+
+    Aggregate(&(Model->Map), &(Model->Options), Model->TopoMap,
+	      &(Model->Soil), &(Model->Veg), Model->VegMap, Model->EvapMap,
+	      Model->PrecipMap, Model->RadMap, Model->SnowMap, Model->SoilMap,
+	      &(Model->Total), Model->VType, Model->Network,
+	      Model->SedMap, Model->FineMap, &(Model->ChannelData),
+	      &(Model->roadarea));
+
+    Model->Mass.StartWaterStorage =
+      Model->Total.Soil.IExcess + Model->Total.CanopyWater +
+      Model->Total.SoilWater + Model->Total.Snow.Swq +
+      Model->Total.Soil.SatFlow;
+    Model->Mass.OldWaterStorage = Model->Mass.StartWaterStorage;
+
+    if (Model->Options.Sediment) {
+      Model->Mass.StartChannelSedimentStorage =
+	Model->Total.ChannelSedimentStorage;
+      Model->Mass.LastChannelSedimentStorage =
+	Model->Mass.StartChannelSedimentStorage;
+    }
+
+    SwapMember(Model, e);
+  }
+
+#ifdef COMPACT_MAPS
+  /* 16-bit codes for the static meteorology maps.  The X11 graphics draw
+     the float maps */
+  if (Model->NGraphics > 0)
+    printf("Not compacting the maps, the graphics use them\n");
+  else
+    CompactMaps(&(Model->Compact), &(Model->Map), &(Model->SkyViewMap),
+		&(Model->PrecipLapseMap), &(Model->WindModel), NWINDMAPS);
+#endif
+
+  /* pointers needed for the per pixel column physics */
+  Model->Sweep.Map = &(Model->Map);
+  Model->Sweep.Radar = &(Model->Radar);
+  Model->Sweep.Time = &(Model->Time);
+  Model->Sweep.Options = &(Model->Options);
+  Model->Sweep.SolarGeo = &(Model->SolarGeo);
+  Model->Sweep.Soil = &(Model->Soil);
+  Model->Sweep.Veg = &(Model->Veg);
+  Model->Sweep.NStats = Model->NStats;
+  Model->Sweep.Stat = Model->Stat;
+  Model->Sweep.Stations = &(Model->Stations);
+  Model->Sweep.MetWeights = Model->MetWeights;
+  Model->Sweep.NGraphics = Model->NGraphics;
+  Model->Sweep.ShadeOffset = Model->shade_offset;
+  Model->Sweep.TopoMap = Model->TopoMap;
+  Model->Sweep.RadMap = Model->RadMap;
+  Model->Sweep.PrecipMap = Model->PrecipMap;
+  Model->Sweep.RadarMap = Model->RadarMap;
+  Model->Sweep.PrismMap = Model->PrismMap;
+  Model->Sweep.SnowMap = Model->SnowMap;
+  Model->Sweep.SnowAlbedo = Model->SnowAlbedo;
+  Model->Sweep.MM5Input = Model->MM5Input;
+  Model->Sweep.WindModel = Model->WindModel;
+  Model->Sweep.PrecipLapseMap = Model->PrecipLapseMap;
+  Model->Sweep.Compact = &(Model->Compact);
+  Model->Sweep.MetMap = &(Model->MetMap);
+  Model->Sweep.SkyViewMap = Model->SkyViewMap;
+  Model->Sweep.ShadowMap = Model->ShadowMap;
+  Model->Sweep.Network = Model->Network;
+  Model->Sweep.VType = Model->VType;
+  Model->Sweep.VegMap = Model->VegMap;
+  Model->Sweep.SType = Model->SType;
+  Model->Sweep.SoilMap = Model->SoilMap;
+  Model->Sweep.EvapMap = Model->EvapMap;
+  Model->Sweep.ChannelData = &(Model->ChannelData);
+
+  /* per-pixel parameters of the routing.  Every ensemble member that runs
+     in this process has its own soil table, these use the tables */
+  if (Model->Options.ParamMaps && Model->Options.Components == FULL_MODEL) {
+    if (Model->Members)
+      printf("Not building the parameter maps, all ensemble members run in "
+	     "this process\n");
+    else
+      InitParamMap(&(Model->Params), &(Model->Map), Model->TopoMap,
+		   Model->SoilMap, Model->VegMap, Model->SType, Model->VType,
+		   &(Model->Soil), &(Model->Veg));
+  }
+
+  /* storage order of the kinematic wave routing */
+  if (Model->Options.CellOrder != ORDER_ELEVATION &&
+      Model->Options.Components == FULL_MODEL &&
+      Model->Options.Extent == BASIN && Model->Options.HasNetwork &&
+      Model->Options.Routing)
+    InitCellOrder(&(Model->Map), Model->TopoMap, Model->SoilMap,
+		  Model->SType, &(Model->Params), &(Model->ChannelData),
+		  Model->Options.CellOrder, Model->Options.TileSize);
+
+  /* with several threads the pixel loop runs tile by tile, and the
+     MULTIPOINT loop block of points by block of points */
+  if (Model->Options.NThreads > 1 && Model->Options.Extent != MULTIPOINT &&
+      !Model->Members)
+    InitTiles(&(Model->Tiles), Model->Options.NThreads,
+	      Model->Options.TileSize, &(Model->Map), Model->TopoMap,
+	      &(Model->Options.Parallel));
+  else if (Model->Options.NThreads > 1 &&
+	   Model->Options.Extent == MULTIPOINT)
+    InitPointTiles(&(Model->PointTiles), Model->Options.NThreads, 0,
+		   Model->Options.NPoints, Model->Options.Points);
+
+  /* pages of the maps of the model state and of the layer arrays of their
+     pixels.  The ensemble members that run in this process swap their
+     maps, these keep the rows of the initialization */
+  if (Model->Options.FirstTouch ||
+      Model->Options.HugePages != HUGEPAGES_NONE) {
+    if (Model->Members)
+      printf("Not placing the model maps, all ensemble members run in this "
+	     "process\n");
+    else {
+      PlaceMap(&(Model->Placement), &(Model->Tiles), &(Model->Map),
+	       (void **) Model->TopoMap, sizeof(TOPOPIX), "TopoMap",
+	       Model->Options.FirstTouch, Model->Options.HugePages);
+      PlaceMap(&(Model->Placement), &(Model->Tiles), &(Model->Map),
+	       (void **) Model->SoilMap, sizeof(SOILPIX), "SoilMap",
+	       Model->Options.FirstTouch, Model->Options.HugePages);
+      PlaceMap(&(Model->Placement), &(Model->Tiles), &(Model->Map),
+	       (void **) Model->VegMap, sizeof(VEGPIX), "VegMap",
+	       Model->Options.FirstTouch, Model->Options.HugePages);
+      PlaceMap(&(Model->Placement), &(Model->Tiles), &(Model->Map),
+	       (void **) Model->EvapMap, sizeof(EVAPPIX), "EvapMap",
+	       Model->Options.FirstTouch, Model->Options.HugePages);
+      PlaceMap(&(Model->Placement), &(Model->Tiles), &(Model->Map),
+	       (void **) Model->PrecipMap, sizeof(PRECIPPIX), "PrecipMap",
+	       Model->Options.FirstTouch, Model->Options.HugePages);
+      PlaceMap(&(Model->Placement), &(Model->Tiles), &(Model->Map),
+	       (void **) Model->SnowMap, sizeof(SNOWPIX), "SnowMap",
+	       Model->Options.FirstTouch, Model->Options.HugePages);
+      PlaceMap(&(Model->Placement), &(Model->Tiles), &(Model->Map),
+	       (void **) Model->RadMap, sizeof(RADCLASSPIX), "RadMap",
+	       Model->Options.FirstTouch, Model->Options.HugePages);
+      PlaceMap(&(Model->Placement), &(Model->Tiles), &(Model->Map),
+	       (void **) Model->Network, sizeof(ROADSTRUCT), "Network",
+	       Model->Options.FirstTouch, Model->Options.HugePages);
+      PlaceMap(&(Model->Placement), &(Model->Tiles), &(Model->Map),
+	       (void **) Model->SedMap, sizeof(SEDPIX), "SedMap",
+	       Model->Options.FirstTouch, Model->Options.HugePages);
+      PlaceLayerArrays(Model);
+      if (Model->Options.Parallel.Rank == 0)
+	ReportPlacement(stdout, &(Model->Placement));
+    }
+  }
+
+  /* pointers needed by the forecast server */
+  if (Model->Options.Server.Active) {
+    Model->Server.Map = &(Model->Map);
+    Model->Server.Time = &(Model->Time);
+    Model->Server.Options = &(Model->Options);
+    Model->Server.Soil = &(Model->Soil);
+    Model->Server.Veg = &(Model->Veg);
+    Model->Server.NStats = Model->NStats;
+    Model->Server.Stat = Model->Stat;
+    Model->Server.TopoMap = Model->TopoMap;
+    Model->Server.PrecipMap = Model->PrecipMap;
+    Model->Server.SnowMap = Model->SnowMap;
+    Model->Server.SoilMap = Model->SoilMap;
+    Model->Server.VegMap = Model->VegMap;
+    Model->Server.SType = Model->SType;
+    Model->Server.VType = Model->VType;
+    Model->Server.SnowAlbedo = Model->SnowAlbedo;
+    Model->Server.Network = Model->Network;
+    Model->Server.MetMap = Model->MetMap;
+    Model->Server.RadMap = Model->RadMap;
+    Model->Server.ChannelData = &(Model->ChannelData);
+    Model->Server.HydrographInfo = &(Model->HydrographInfo);
+    Model->Server.Hydrograph = Model->Hydrograph;
+    Model->Server.Dump = &(Model->Dump);
+    Model->Server.EvapMap = Model->EvapMap;
+    Model->Server.SedMap = Model->SedMap;
+    Model->Server.FineMap = Model->FineMap;
+    Model->Server.Total = &(Model->Total);
+    Model->Server.Mass = &(Model->Mass);
+    Model->Server.Snapshot.Buffer = NULL;
+    InitServer(&(Model->Options.Server));
+  }
+
+  if (Model->Options.Parallel.Rank == 0)
+    ReportMemory(stdout, "Memory allocated at initialization");
+
+  /* the process globals of this instance */
+  SaveGlobals(&(Model->Globals));
+}
+
+/*****************************************************************************
+  Function name: dhsvm_predict_memory()
+
+  Purpose      : Predict the memory of a model run without initializing the
+                 model
+
+  Required     :
+    const char *ConfigFile - Name of the configuration file
+
+  Returns      : double - Predicted memory of the model arrays, including
+                          the allocator overhead (bytes)
+
+  Modifies     : The process globals set by InitConstants()
+
+  Comments     : Prints the prediction in the form of the report at the end
+                 of dhsvm_init().  Only the configuration, the tables and
+                 the mask, soil and vegetation maps are read, see
+                 PredictMemory().
+*****************************************************************************/
+double dhsvm_predict_memory(const char *ConfigFile)
+{
+  DHSVM *Model;			/* Model instance, only the tables are set */
+  LISTPTR Input = NULL;		/* Linked list with input strings */
+  double Bytes;			/* Predicted memory (bytes) */
+
+  if (!(Model = (DHSVM *) calloc(1, sizeof(DHSVM))))
+    ReportError("dhsvm_predict_memory", 1);
+  strcpy(Model->InFiles.Const, ConfigFile);
+
+  ReadInitFile(Model->InFiles.Const, &Input);
+  InitConstants(Input, &(Model->Options), &(Model->Map), &(Model->SolarGeo),
+		&(Model->Time));
+  InitFileIO(Model->Options.FileFormat);
+  InitTables(Model->Time.NDaySteps, Input, &(Model->Options), &(Model->SType),
+	     &(Model->Soil), &(Model->VType), &(Model->Veg),
+	     &(Model->SnowAlbedo));
+
+  SetMemTable(&(Model->Memory));
+  PredictMemory(Input, &(Model->Options), &(Model->Map), &(Model->Soil),
+		&(Model->Veg), Model->VType, Model->Time.NDaySteps);
+  ReportMemory(stdout, "Predicted memory");
+  Bytes = TrackedBytes();
+  SetMemTable(NULL);
+
+  DeleteList(Input);
+  free(Model);
+
+  return Bytes;
+}
+
+/*****************************************************************************
+  Function name: dhsvm_autotune()
+
+  Purpose      : Time the first time steps of a configuration with several
+                 numbers of threads, tile sizes and output buffers, and
+                 write the fastest settings to the tuning file
+
+  Required     :
+    const char *ConfigFile - Name of the configuration file
+
+  Returns      : double - Wall time per time step of the fastest settings
+                          (s), or -1 if the configuration has an error
+
+  Modifies     : The output directory of the configuration, see tuning.h
+
+  Comments     : Each candidate initializes the model, takes one time step
+                 to warm up and times the next TUNINGSTEPS time steps.  The
+                 settings are searched one at a time: the threads with the
+                 default tiles and buffer, then the tile size with the best
+                 threads, then the buffer.  The trial runs write their
+                 output like a normal run.
+*****************************************************************************/
+double dhsvm_autotune(const char *ConfigFile)
+{
+  static int TileSizes[] = { DEFAULTTILESIZE, 16, 64 };
+  static int Buffers[] = { 0, 65536, 1048576 };
+  MAPSIZE Map;			/* Size of the basin */
+  char Path[BUFSIZE + 1];	/* Output directory */
+  TUNING Best;			/* Fastest settings so far */
+  TUNING Try;			/* Settings being timed */
+  double BestTime;		/* Wall time per step of Best (s) */
+  double Time;			/* Wall time per step of Try (s) */
+  int NCpus;			/* Online processors */
+  int i;
+
+  NCpus = (int) sysconf(_SC_NPROCESSORS_ONLN);
+  Best.NThreads = 1;
+  Best.TileSize = DEFAULTTILESIZE;
+  Best.OutputBuffer = 0;
+  if ((BestTime = TimeCandidate(ConfigFile, &Best, &Map, Path)) < 0.)
+    return -1.;
+
+  /* 2, 4, 8, ... threads and all processors */
+  for (i = 2; i <= NCpus; i = (i < NCpus) ? MIN(2 * i, NCpus) : i + 1) {
+    Try = Best;
+    Try.NThreads = i;
+    Time = TimeCandidate(ConfigFile, &Try, &Map, Path);
+    if (Time >= 0. && Time < BestTime) {
+      Best = Try;
+      BestTime = Time;
+    }
+  }
+
+  /* the tiles are only used with several threads */
+  for (i = 1; Best.NThreads > 1 && i < sizeof(TileSizes) / sizeof(int); i++) {
+    Try = Best;
+    Try.TileSize = TileSizes[i];
+    Time = TimeCandidate(ConfigFile, &Try, &Map, Path);
+    if (Time >= 0. && Time < BestTime) {
+      Best = Try;
+      BestTime = Time;
+    }
+  }
+
+  for (i = 1; i < sizeof(Buffers) / sizeof(int); i++) {
+    Try = Best;
+    Try.OutputBuffer = Buffers[i];
+    Time = TimeCandidate(ConfigFile, &Try, &Map, Path);
+    if (Time >= 0. && Time < BestTime) {
+      Best = Try;
+      BestTime = Time;
+    }
+  }
+
+  WriteTuning(Path, &Map, &Best, BestTime);
+
+  return BestTime;
+}
+
+/*****************************************************************************
+  Function name: dhsvm_step()
+
+  Purpose      : Simulate the next time steps of a model instance
+
+  Required     :
+    DHSVM *Model - Model instance
+    int NSteps   - Number of time steps, or a negative number to run to the
+                   end of the run.  In server mode a negative number serves
+                   requests until the client ends the session
+
+  Returns      : int - Number of time steps taken, less than NSteps at the
+                       end of the run
+
+  Modifies     : Model
+
+  Comments     : The final model state and mass balance are written after
+                 the last time step of the run
+*****************************************************************************/
+int dhsvm_step(DHSVM *Model, int NSteps)
+{
+  int Steps;			/* Number of time steps taken */
+  int Done;			/* TRUE at the end of the run */
+
+  RestoreGlobals(&(Model->Globals));
+  SetMemTable(&(Model->Memory));
+
+  Done = FALSE;
+  for (Steps = 0; !Done && (NSteps < 0 || Steps < NSteps);) {
+    if (MoreSteps(Model)) {
+      RunStep(Model);
+      Steps++;
+    }
+    else
+      Done = TRUE;
+  }
+
+  /* write the final output right after the last time step, rather than on
+     the next call */
+  if (!Done && !Model->Options.Server.Active)
+    Done = !MoreSteps(Model);
+  if (Done && !Model->Finished)
+    EndRun(Model);
+
+  SaveGlobals(&(Model->Globals));
+  SetMemTable(NULL);
+  SetProfile(NULL);
+
+  return Steps;
+}
+
+/*****************************************************************************
+  Function name: dhsvm_get_field()
+
+  Purpose      : Find a per-pixel field of the model state
+
+  Required     :
+    DHSVM *Model       - Model instance
+    const char *Name   - Name of the field, as in the MAP and STATE output
+                         (VarID.c), for example "Soil.TableDepth"
+    DHSVMFIELD *Field  - Location of the field
+
+  Returns      : int - 0 if the field was found, -1 otherwise
+
+  Modifies     : Field
+
+  Comments     : Field points into the model state itself, the values can
+                 be read and changed between time steps.  Only fields with
+                 a single value per pixel are available, not the values per
+                 soil or vegetation layer
+*****************************************************************************/
+int dhsvm_get_field(DHSVM *Model, const char *Name, DHSVMFIELD *Field)
+{
+  int i;			/* counter */
+
+  for (i = 0; Fields[i].Name; i++)
+    if (strcmp(Fields[i].Name, Name) == 0)
+      break;
+  if (!Fields[i].Name)
+    return -1;
+
+  Field->NY = Model->Map.NY;
+  Field->NX = Model->Map.NX;
+  Field->Offset = Fields[i].Offset;
+  Field->Type = Fields[i].Type;
+
+  switch (Fields[i].Source) {
+  case TOPOFIELD:
+    Field->Rows = (char **) Model->TopoMap;
+    Field->Stride = sizeof(TOPOPIX);
+    break;
+  case SOILFIELD:
+    Field->Rows = (char **) Model->SoilMap;
+    Field->Stride = sizeof(SOILPIX);
+    break;
+  case VEGFIELD:
+    Field->Rows = (char **) Model->VegMap;
+    Field->Stride = sizeof(VEGPIX);
+    break;
+  case SNOWFIELD:
+    Field->Rows = (char **) Model->SnowMap;
+    Field->Stride = sizeof(SNOWPIX);
+    break;
+  case EVAPFIELD:
+    Field->Rows = (char **) Model->EvapMap;
+    Field->Stride = sizeof(EVAPPIX);
+    break;
+  case PRECIPFIELD:
+    Field->Rows = (char **) Model->PrecipMap;
+    Field->Stride = sizeof(PRECIPPIX);
+    break;
+  case RADFIELD:
+    Field->Rows = (char **) Model->RadMap;
+    Field->Stride = sizeof(RADCLASSPIX);
+    break;
+  }
+
+  return 0;
+}
+
+/*****************************************************************************
+  Function name: dhsvm_set_forcing()
+
+  Purpose      : Replace the observations of a met station for the next
+                 time step
+
+  Required     :
+    DHSVM *Model - Model instance
+    int Station  - Index of the station, in the order of the configuration
+                   file
+    float Tair   - Air temperature (C)
+    float Rh     - Relative humidity (%)
+    float Wind   - Wind speed (m/s)
+    float Sin    - Incoming shortwave radiation (W/m2)
+    float Lin    - Incoming longwave radiation (W/m2)
+    float Precip - Precipitation (m/timestep)
+
+  Returns      : int - 0 on success, -1 if there is no such station
+
+  Modifies     : Model->Stat
+
+  Comments     : The station file is still read, the values replace the
+                 observations of the next time step only.  Stations that
+                 do not cover the basin may have been dropped by CLIP
+*****************************************************************************/
+int dhsvm_set_forcing(DHSVM *Model, int Station, float Tair, float Rh,
+		      float Wind, float Sin, float Lin, float Precip)
+{
+  METLOCATION *Stat;		/* Station */
+
+  if (Station < 0 || Station >= Model->NStats)
+    return -1;
+
+  Stat = &(Model->Stat[Station]);
+  Stat->Forcing.Tair = Tair;
+  Stat->Forcing.Rh = Rh;
+  Stat->Forcing.Wind = Wind;
+  Stat->Forcing.Sin = Sin;
+  Stat->Forcing.Lin = Lin;
+  Stat->Forcing.Precip = Precip;
+  Stat->HasForcing = TRUE;
+
+  return 0;
+}
+
+/*****************************************************************************
+  Function name: dhsvm_free()
+
+  Purpose      : Close the output files and release a model instance
+
+  Required     :
+    DHSVM *Model - Model instance
+
+  Returns      : void
+
+  Modifies     : Model, which can no longer be used
+
+  Comments     : The maps and networks of the model state are released.
+                 The parameter tables are small and are left to the end of
+                 the process
+*****************************************************************************/
+void dhsvm_free(DHSVM *Model)
+{
+  RestoreGlobals(&(Model->Globals));
+  ReleaseModel(Model);
+}
+
+/*****************************************************************************
+  TimeCandidate()
+
+  Wall time per time step of a configuration with the settings of a
+  candidate (s), or -1 if the configuration has an error.  Also returns the
+  size of the basin and the output directory, for the tuning file
+*****************************************************************************/
+static double TimeCandidate(const char *ConfigFile, TUNING *Candidate,
+			    MAPSIZE *Map, char *Path)
+{
+  DHSVM *Model;			/* Model instance */
+  double Start;			/* Clock after the warm-up step (s) */
+  double Time;			/* Wall time per time step (s) */
+  int Steps;			/* Time steps timed */
+
+  if (!(Model = NewModel(ConfigFile, Candidate)))
+    return -1.;
+
+  dhsvm_step(Model, 1);
+  Start = Clock();
+  Steps = dhsvm_step(Model, TUNINGSTEPS);
+  Time = Clock() - Start;
+  if (Steps < 1)
+    ReportError((char *) ConfigFile, 87);
+  Time /= Steps;
+
+  Map->NY = Model->Map.NY;
+  Map->NX = Model->Map.NX;
+  Map->NumCells = Model->Map.NumCells;
+  strcpy(Path, Model->Dump.Path);
+  dhsvm_free(Model);
+
+  printf("\nAUTOTUNE: %d threads, tile size %d, output buffer %d: "
+	 "%.6f s per time step\n\n", Candidate->NThreads,
+	 Candidate->TileSize, Candidate->OutputBuffer, Time);
+
+  return Time;
+}
+
+/*****************************************************************************
+  Clock()
+
+  Monotonic wall clock (s)
+*****************************************************************************/
+static double Clock(void)
+{
+  struct timespec Now;
+
+  clock_gettime(CLOCK_MONOTONIC, &Now);
+  return Now.tv_sec + 1e-9 * Now.tv_nsec;
+}
+
+/*****************************************************************************
+  SwapMember()
+
+  Swap the model state of ensemble member e in or out, if all members run
+  in this process
+*****************************************************************************/
+static void SwapMember(DHSVM *Model, int e)
+{
+  if (Model->Members)
+    SwapMemberState(&(Model->Members[e]), &(Model->Total), &(Model->Mass),
+		    &(Model->Dump), &(Model->ChannelData), &(Model->EvapMap),
+		    &(Model->PrecipMap), &(Model->Network), &(Model->SnowMap),
+		    &(Model->SoilMap), &(Model->VegMap), &(Model->SType),
+		    &(Model->Hydrograph), &(Model->LocalMet));
+}
+
+/*****************************************************************************
+  MoreSteps()
+
+  TRUE if there is another time step to simulate.  In server mode the time
+  steps are simulated on request
+*****************************************************************************/
+static int MoreSteps(DHSVM *Model)
+{
+  if (Model->Finished)
+    return FALSE;
+  if (Model->Options.Server.Active)
+    return ServeRequests(&(Model->Server));
+  return (Before(&(Model->Time.Current), &(Model->Time.End)) ||
+	  IsEqualTime(&(Model->Time.Current), &(Model->Time.End)));
+}
+
+/*****************************************************************************
+  RunStep()
+
+  Simulate one time step
+*****************************************************************************/
+static void RunStep(DHSVM *Model)
+{
+  int flag;
+  int x;			/* row counter */
+  int y;			/* column counter */
+  int e;			/* ensemble member counter */
+  char buffer[32];
+  long Pos;			/* Position in a sediment output file */
+  long Pos2;			/* Position in a sediment flow only file */
+
+  if (Profile->Active)
+    StartStep();
+
+  /* the server has loaded a model state, restart the month, the day and,
+     unless the state is the snapshot in memory, the mass balance at the
+     new model time */
+  if (Model->Options.Server.Restart) {
+    Model->Options.Server.Restart = FALSE;
+    InitNewMonth(&(Model->Time), &(Model->Options), &(Model->Map),
+		 Model->TopoMap, Model->PrismMap, Model->ShadowMap,
+		 Model->RadMap, &(Model->InFiles), Model->Veg.NTypes,
+		 Model->VType, Model->NStats, Model->Stat, 
+		 Model->Dump.InitStatePath);
+    InitNewDay(Model->Time.Current.JDay, &(Model->SolarGeo));
+    if (!Model->Options.Server.Restored) {
+      memset(&(Model->Mass), 0, sizeof(WATERBALANCE));
+      Aggregate(&(Model->Map), &(Model->Options), Model->TopoMap,
+		&(Model->Soil), &(Model->Veg), Model->VegMap, Model->EvapMap,
+		Model->PrecipMap, Model->RadMap, Model->SnowMap,
+		Model->SoilMap, &(Model->Total), Model->VType, Model->Network,
+		Model->SedMap, Model->FineMap, &(Model->ChannelData),
+		&(Model->roadarea));
+      Model->Mass.StartWaterStorage =
+	Model->Total.Soil.IExcess + Model->Total.CanopyWater +
+	Model->Total.SoilWater + Model->Total.Snow.Swq +
+	Model->Total.Soil.SatFlow;
+      Model->Mass.OldWaterStorage = Model->Mass.StartWaterStorage;
+    }
+    Model->Options.Server.Restored = FALSE;
+  }
+
+  if (IsNewMonth(&(Model->Time.Current), Model->Time.Dt))
+    InitNewMonth(&(Model->Time), &(Model->Options), &(Model->Map),
+		 Model->TopoMap, Model->PrismMap, Model->ShadowMap,
+		 Model->RadMap, &(Model->InFiles), Model->Veg.NTypes,
+		 Model->VType, Model->NStats, Model->Stat, 
+		 Model->Dump.InitStatePath);
+
+  if (IsNewDay(Model->Time.DayStep)) {
+    InitNewDay(Model->Time.Current.JDay, &(Model->SolarGeo));
+    PrintDate(&(Model->Time.Current), stdout);
+    printf("\n");
+  }
+
+/*     PrintDate(&(Time.Current),stdout); */
+/*     printf("\n"); */
+/*     uncomment the above lines to print the time at every step */
+
+  /* determine surface erosion and routing scheme */
+  SedimentFlag(&(Model->Options), &(Model->Time)); 
+
+  /* take several base time steps at once in quiet periods */
+  if (Model->Options.Adaptive.Active)
+    ChooseTimeStep(&(Model->Options), &(Model->Time), &(Model->Dump),
+		   Model->Soil.MaxLayers, Model->NStats, Model->Stat,
+		   &(Model->SolarGeo), &(Model->Total),
+		   &(Model->ChannelData));
+
+  PROFILE_START(PROF_INITNEWSTEP);
+  InitNewStep(&(Model->InFiles), &(Model->Map), &(Model->Time),
+	      Model->Soil.MaxLayers, &(Model->Options), Model->NStats,
+	      Model->Stat,
+	      Model->InFiles.RadarFile, &(Model->Radar), Model->RadarMap,
+	      &(Model->SolarGeo), Model->TopoMap, Model->RadMap,
+              Model->SoilMap, Model->MM5Input, Model->WindModel,
+	      &(Model->MM5Map));
+
+  if (Model->Options.Ensemble.Member >= 0)
+    PerturbMetData(&(Model->Options.Ensemble), &(Model->Options),
+		   &(Model->Map), &(Model->Radar), Model->NStats,
+		   Model->Stat,
+		   Model->RadarMap, Model->MM5Input);
+  PackStations(Model->NStats, Model->Stat, &(Model->Stations));
+  PROFILE_STOP(PROF_INITNEWSTEP);
+
+  /* reset basin totals and initialize channel/road networks for time
+     step */
+  for (e = 0; e < Model->NMembers; e++) {
+    SwapMember(Model, e);
+
+    ResetAggregate(&(Model->Soil), &(Model->Veg), &(Model->Total),
+		   &(Model->Options));
+
+    if (Model->Options.HasNetwork) {
+      channel_step_initialize_network(Model->ChannelData.streams);
+      channel_step_initialize_network(Model->ChannelData.roads);
+    }
+
+    SwapMember(Model, e);
+  }
+
+  PROFILE_START(PROF_SWEEP);
+  if (Model->Options.Extent == MULTIPOINT)
+    MultiPointMassEnergyBalance(&(Model->Sweep), &(Model->PointTiles),
+				Model->PointMet, &(Model->Total.Rad));
+  else if (Model->Members)
+    MemberMassEnergyBalance(Model->Members, &(Model->Options.Ensemble),
+			    &(Model->Sweep), &(Model->MemberSweep));
+  else if (Model->Tiles.NThreads > 1) {
+    TiledMassEnergyBalance(&(Model->Sweep), &(Model->Tiles),
+			   &(Model->LocalMet), &(Model->Total.Rad));
+    ExchangeInflow(&(Model->Options.Parallel));
+  }
+  else {
+    for (y = 0; y < Model->Map.NY; y++) {
+      for (x = 0; x < Model->Map.NX; x++) {
+	if (INBASIN(Model->TopoMap[y][x].Mask) &&
+	    ISOWNED(Model->Options.Parallel, y, x))
+	  Model->LocalMet = SweepCell(&(Model->Sweep), y, x,
+				      &(Model->Total.Rad));
+      }
+    }
+    ExchangeInflow(&(Model->Options.Parallel));
+  }
+  PROFILE_STOP(PROF_SWEEP);
+
+  /* route and write the output for each member in turn */
+  for (e = 0; e < Model->NMembers; e++) {
+    SwapMember(Model, e);
+
+    /* soil water, routing, channels and sediment are only simulated in
+       FULL_MODEL runs */
+    if (Model->Options.Components == FULL_MODEL) {
+      /* set sediment inflows to zero - they are incremented elsewhere */
+      if ((Model->Options.HasNetwork) && (Model->Options.Sediment)){ 
+	InitChannelSedInflow(Model->ChannelData.streams);
+	InitChannelSedInflow(Model->ChannelData.roads);
+      }
+
+      PROFILE_START(PROF_SUBSURFACE);
+      RouteSubSurface(Model->Time.Dt, &(Model->Map), Model->TopoMap,
+		      Model->VType, Model->VegMap, Model->Network,
+		      Model->SType, &(Model->Params), Model->SoilMap,
+		      &(Model->ChannelData), &(Model->Time), &(Model->Options),
+		      Model->Dump.Path, Model->SedMap, Model->FineMap,
+		      Model->SedType, Model->MaxStreamID, Model->SnowMap);
+      PROFILE_STOP(PROF_SUBSURFACE);
+
+      PROFILE_START(PROF_CHANNEL);
+      if (Model->Options.HasNetwork)
+	RouteChannel(&(Model->ChannelData), &(Model->Time), &(Model->Map),
+		     Model->TopoMap, Model->SoilMap, &(Model->Total), 
+		     &(Model->Options), Model->Network, Model->SType,
+		     Model->PrecipMap, Model->SedMap,
+		     Model->LocalMet.Tair, Model->LocalMet.Rh,
+		     Model->SedDiams);
+      PROFILE_STOP(PROF_CHANNEL);
+
+      /* Sediment Routing in Channel and output to sediment files */
+      PROFILE_START(PROF_CHANNELSED);
+      if ((Model->Options.HasNetwork) && (Model->Options.Sediment)){
+	SPrintDate(&(Model->Time.Current), buffer);
+	flag = IsEqualTime(&(Model->Time.Current), &(Model->Time.Start));
+	if(Model->Options.ChannelRouting){
+	  if (Model->ChannelData.roads != NULL) {
+	    RouteChannelSediment(Model->ChannelData.roads, Model->Time,
+				 &(Model->Dump), &(Model->Total),
+				 Model->SedDiams);
+	    Pos = PROFILE_TELL(Model->ChannelData.sedroadout);
+	    Pos2 = PROFILE_TELL(Model->ChannelData.sedroadflowout);
+	    channel_save_sed_outflow_text(buffer, Model->ChannelData.roads,
+					  Model->ChannelData.sedroadout,
+					  Model->ChannelData.sedroadflowout,
+					  flag);
+	    PROFILE_COUNT_FILE(PROF_BYTESWRITTEN,
+			       Model->ChannelData.sedroadout, Pos);
+	    PROFILE_COUNT_FILE(PROF_BYTESWRITTEN,
+			       Model->ChannelData.sedroadflowout, Pos2);
+	    RouteCulvertSediment(&(Model->ChannelData), &(Model->Map),
+				 Model->TopoMap, Model->SedMap, 
+				 &(Model->Total), Model->SedDiams);
+	  }
+	  RouteChannelSediment(Model->ChannelData.streams, Model->Time,
+			       &(Model->Dump), &(Model->Total),
+			       Model->SedDiams);
+	  Pos = PROFILE_TELL(Model->ChannelData.sedstreamout);
+	  Pos2 = PROFILE_TELL(Model->ChannelData.sedstreamflowout);
+	  channel_save_sed_outflow_text(buffer, Model->ChannelData.streams,
+					Model->ChannelData.sedstreamout,
+					Model->ChannelData.sedstreamflowout,
+					flag);
+	  PROFILE_COUNT_FILE(PROF_BYTESWRITTEN,
+			     Model->ChannelData.sedstreamout, Pos);
+	  PROFILE_COUNT_FILE(PROF_BYTESWRITTEN,
+			     Model->ChannelData.sedstreamflowout, Pos2);
+	}
+	else{
+	  if (Model->ChannelData.roads != NULL) {
+	    Pos = PROFILE_TELL(Model->ChannelData.sedroadinflow);
+	    channel_save_sed_inflow_text(buffer, Model->ChannelData.roads,
+				       Model->ChannelData.sedroadinflow,
+				       Model->SedDiams,
+				       flag);
+	    PROFILE_COUNT_FILE(PROF_BYTESWRITTEN,
+			       Model->ChannelData.sedroadinflow, Pos);
+	  }
+	  Pos = PROFILE_TELL(Model->ChannelData.sedstreaminflow);
+	  channel_save_sed_inflow_text(buffer, Model->ChannelData.streams,
+				       Model->ChannelData.sedstreaminflow,
+				       Model->SedDiams,
+				       flag);
+	  PROFILE_COUNT_FILE(PROF_BYTESWRITTEN,
+			     Model->ChannelData.sedstreaminflow, Pos);
+	}
+	SaveChannelSedInflow(Model->ChannelData.roads, &(Model->Total));
+	SaveChannelSedInflow(Model->ChannelData.streams, &(Model->Total));
+      }
+      PROFILE_STOP(PROF_CHANNELSED);
+
+      PROFILE_START(PROF_SURFACE);
+      if (Model->Options.Extent == BASIN)
+	RouteSurface(&(Model->Map), &(Model->Time), Model->TopoMap,
+		     Model->SoilMap, &(Model->Options),
+		     Model->UnitHydrograph, &(Model->HydrographInfo),
+		     Model->Hydrograph,
+		     &(Model->Dump), Model->VegMap, Model->VType,
+		     Model->SType, &(Model->Params), &(Model->ChannelData),
+		     Model->SedMap, Model->PrecipMap, Model->SedType,
+		     Model->LocalMet.Tair, Model->LocalMet.Rh,
+		     Model->SedDiams);
+      PROFILE_STOP(PROF_SURFACE);
+    }
+
+    if (e == 0 && Model->NGraphics > 0 && !Model->Options.Spinup.Active)
+      draw(&(Model->Time.Current), IsEqualTime(&(Model->Time.Current),
+	   &(Model->Time.Start)),
+	   Model->Time.DayStep, &(Model->Map), Model->NGraphics,
+	   Model->which_graphics, Model->VType,
+	   Model->SType, Model->SnowMap, Model->SoilMap, Model->SedMap,
+	   Model->FineMap, Model->VegMap, Model->TopoMap, Model->PrecipMap,
+	   Model->PrismMap, Model->SkyViewMap, Model->ShadowMap,
+	   Model->EvapMap, Model->RadMap, Model->MetMap, Model->Network,
+	   &(Model->Options));
+  
+    PROFILE_START(PROF_AGGREGATE);
+    Aggregate(&(Model->Map), &(Model->Options), Model->TopoMap,
+	      &(Model->Soil), &(Model->Veg), Model->VegMap, Model->EvapMap,
+	      Model->PrecipMap,
+	      Model->RadMap, Model->SnowMap, Model->SoilMap, &(Model->Total),
+	      Model->VType, Model->Network, Model->SedMap, Model->FineMap,
+	      &(Model->ChannelData), &(Model->roadarea));
+    PROFILE_STOP(PROF_AGGREGATE);
+  
+    /* no output during the spin-up, and only the stream flow in a
+       calibration run.  In an MPI run rank 0 writes the basin output and
+       the maps, each rank writes the pixels it owns, see ExecDump() */
+    if (!Model->Options.Spinup.Active &&
+	!Model->Options.Calibration.Active) {
+      PROFILE_START(PROF_MASSBALANCE);
+      if (Model->Options.Components == FULL_MODEL &&
+	  Model->Options.Parallel.Rank == 0)
+	MassBalance(&(Model->Time.Current), &(Model->Dump.Balance),
+		    &(Model->Dump.SedBalance),
+		    &(Model->Total), &(Model->Mass), &(Model->Options));
+      PROFILE_STOP(PROF_MASSBALANCE);
+
+      PROFILE_START(PROF_DUMP);
+      ExecDump(&(Model->Map), &(Model->Time.Current), &(Model->Time.Start),
+	       &(Model->Options), &(Model->Dump),
+	       Model->TopoMap, Model->EvapMap, Model->PrecipMap,
+	       Model->RadMap, Model->SnowMap, Model->MetMap, Model->VegMap,
+	       &(Model->Veg), Model->SoilMap, Model->SedMap, Model->Network,
+	       &(Model->ChannelData), Model->FineMap, &(Model->Soil),
+	       &(Model->Total), &(Model->HydrographInfo), Model->Hydrograph);
+
+      if (Model->Options.Extent == MULTIPOINT &&
+	  Model->Options.Parallel.Rank == 0)
+	DumpMultiPoint(&(Model->Dump.MultiPoint), &(Model->Options),
+		       &(Model->Soil), Model->PointMet,
+		       Model->PrecipMap, Model->SnowMap, Model->SoilMap,
+		       Model->EvapMap);
+      PROFILE_STOP(PROF_DUMP);
+    }
+
+    SwapMember(Model, e);
+  }
+
+  if (Profile->Active)
+    EndStep(&(Model->Time.Current));
+  if (Model->Progress.Active)
+    UpdateProgress(&(Model->Progress), &(Model->Time));
+
+  if (Model->Options.Adaptive.Active)
+    EndTimeStep(&(Model->Options.Adaptive), &(Model->Time));
+  else
+    IncreaseTime(&(Model->Time));
+
+  /* at the end of a spin-up cycle check whether the model state has
+     converged, and start the next cycle or the model run */
+  if (Model->Options.Spinup.Active && After(&(Model->Time.Current),
+      &(Model->Time.End))) {
+    EndSpinupCycle(&(Model->Options), &(Model->Time), &(Model->Total),
+		   &(Model->ChannelData), Model->NStats, Model->Stat);
+    if (!Model->Options.Spinup.Active) {
+      Model->Mass.StartWaterStorage =
+	Model->Total.Soil.IExcess + Model->Total.CanopyWater +
+	Model->Total.SoilWater + Model->Total.Snow.Swq +
+	Model->Total.Soil.SatFlow;
+      Model->Mass.OldWaterStorage = Model->Mass.StartWaterStorage;
+    }
+    InitNewMonth(&(Model->Time), &(Model->Options), &(Model->Map),
+		 Model->TopoMap, Model->PrismMap, Model->ShadowMap,
+		 Model->RadMap, &(Model->InFiles), Model->Veg.NTypes,
+		 Model->VType, Model->NStats, Model->Stat, 
+		 Model->Dump.InitStatePath);
+    InitNewDay(Model->Time.Current.JDay, &(Model->SolarGeo));
+  }
+}
+
+/*****************************************************************************
+  EndRun()
+
+  Write the final model state and mass balance
+*****************************************************************************/
+static void EndRun(DHSVM *Model)
+{
+  int e;			/* ensemble member counter */
+
+  if (Model->Options.Adaptive.Active)
+    printf("\nAdaptive time step: %d model steps for %d base steps\n",
+	   Model->Options.Adaptive.NModelSteps,
+	   Model->Options.Adaptive.NBaseSteps);
+
+  if (Model->Options.Parallel.Rank == 0)
+    ReportProfile(stdout);
+  ReportPeakMemory(stdout);
+
+  for (e = 0; e < Model->NMembers && !Model->Options.Calibration.Active;
+       e++) {
+    SwapMember(Model, e);
+
+    ExecDump(&(Model->Map), &(Model->Time.Current), &(Model->Time.Start),
+	     &(Model->Options), &(Model->Dump),
+	     Model->TopoMap, Model->EvapMap, Model->PrecipMap, Model->RadMap,
+	     Model->SnowMap, Model->MetMap, Model->VegMap,
+	     &(Model->Veg), Model->SoilMap, Model->SedMap, Model->Network,
+	     &(Model->ChannelData), Model->FineMap, &(Model->Soil),
+	     &(Model->Total), &(Model->HydrographInfo), Model->Hydrograph);
+
+    if (Model->Options.Components == FULL_MODEL &&
+	Model->Options.Parallel.Rank == 0)
+      FinalMassBalance(&(Model->Dump.Balance), &(Model->Total),
+		       &(Model->Mass), &(Model->Options), Model->roadarea);
+
+    SwapMember(Model, e);
+  }
+
+  EndProgress(&(Model->Progress));
+
+  Model->Finished = TRUE;
+}
+
+/*****************************************************************************
+  ReleaseModel()
+
+  Close the output files and release the model state of an instance, also
+  when the initialization stopped at an error.  Arrays that were not
+  allocated are NULL
+*****************************************************************************/
+static void ReleaseModel(DHSVM *Model)
+{
+  int e;			/* ensemble member counter */
+  int i;			/* counter */
+  int x;			/* counter */
+  int y;			/* counter */
+
+  SetMemTable(&(Model->Memory));
+  FreeMapBuffers();
+
+  /* an error can end the initialization before the members are set up */
+  if (Model->NMembers == 0) {
+    CloseOutput(&(Model->Dump), &(Model->ChannelData));
+    FreeDump(&(Model->Dump));
+  }
+  for (e = 0; e < Model->NMembers; e++) {
+    SwapMember(Model, e);
+    CloseOutput(&(Model->Dump), &(Model->ChannelData));
+    FreeDump(&(Model->Dump));
+    SwapMember(Model, e);
+  }
+  for (i = 0; i < Model->NStats && Model->Stat; i++)
+    CloseFile(&(Model->Stat[i].MetFile.FilePtr));
+  CloseFile(&(Model->Profile.StepFile));
+  DeleteList(Model->Input);
+
+  /* the members other than the first have a model state of their own */
+  for (e = 1; e < Model->NMembers && Model->Members; e++) {
+    SwapMember(Model, e);
+    FreeLayerArrays(Model);
+    FreeStateMaps(Model);
+    SwapMember(Model, e);
+  }
+  for (e = 0; e < Model->NMembers && Model->Members; e++)
+    free(Model->Members[e].SType);
+  if (Model->Members)
+    FreeMemberSweep(&(Model->MemberSweep));
+  free(Model->Members);
+
+  /* the placed layer arrays are released as a whole */
+  FreePlacedLayers(&(Model->Placement));
+  FreeLayerArrays(Model);
+  for (y = 0; y < Model->Map.NY && Model->MetWeights; y++)
+    for (x = 0; x < Model->Map.NX && Model->MetWeights[y]; x++)
+      free(Model->MetWeights[y][x]);
+  FreePlacement(&(Model->Placement));
+  FreeStateMaps(Model);
+  FreeRows((void **) Model->TopoMap, Model->Map.NY);
+  FreeRows((void **) Model->RadMap, Model->Map.NY);
+  FreeRows((void **) Model->SedMap, Model->Map.NY);
+  FreeRows((void **) Model->MetWeights, Model->Map.NY);
+  FreeRows((void **) Model->MetMap, Model->Map.NY);
+  FreeRows((void **) Model->RadarMap, Model->Radar.NY);
+  FreeRows((void **) Model->PrecipLapseMap, Model->Map.NY);
+  FreeRows((void **) Model->PrismMap, Model->Map.NY);
+  FreeRows((void **) Model->SkyViewMap, Model->Map.NY);
+  FreeMaps((void ***) Model->ShadowMap, Model->Time.NDaySteps,
+	   Model->Map.NY);
+  FreeMaps((void ***) Model->WindModel, NWINDMAPS, Model->Map.NY);
+#ifdef COMPACT_MAPS
+  for (i = 0; Model->MM5Input && i < N_MM5_MAPS +
+	 (Model->Options.HeatFlux ? Model->Soil.MaxLayers : 0); i++)
+    free(Model->MM5Input[i].Code);
+  free(Model->MM5Input);
+#else
+  FreeMaps((void ***) Model->MM5Input, N_MM5_MAPS +
+	   (Model->Options.HeatFlux ? Model->Soil.MaxLayers : 0),
+	   Model->Map.NY);
+#endif
+  for (y = 0; y < Model->Map.NYfine && Model->FineMap; y++)
+    for (x = 0; x < Model->Map.NXfine && Model->FineMap[y]; x++)
+      free(Model->FineMap[y][x]);
+  FreeRows((void **) Model->FineMap, Model->Map.NYfine);
+  if (Model->UnitHydrograph)
+    FreeRows((void **) Model->UnitHydrograph,
+	     Model->HydrographInfo.MaxTravelTime);
+  free(Model->HydrographInfo.WaveLength);
+  free(Model->Map.OrderedCells);
+  FreeCellOrder(Model->Map.CellOrder);
+  FreeTables(Model);
+
+  free(Model->PointMet);
+  free(Model->Stat);
+  FreeStations(&(Model->Stations));
+  EndTiles(&(Model->Tiles));
+  EndTiles(&(Model->PointTiles));
+  if (Model->Options.Server.Active)
+    EndServer(&(Model->Server));
+  free(Model->Options.Ensemble.Members);
+  FreeParamMap(&(Model->Params));
+  FreeCompactMaps(&(Model->Compact));
+  EndParallel(&(Model->Options.Parallel));
+  SetMemTable(NULL);
+  SetProfile(NULL);
+  free(Model);
+}
+
+/*****************************************************************************
+  CloseOutput()
+*****************************************************************************/
+static void CloseOutput(DUMPSTRUCT *Dump, CHANNEL *ChannelData)
+{
+  int i;			/* counter */
+
+  CloseFile(&(Dump->Aggregate.FilePtr));
+  CloseFile(&(Dump->AggregateSediment.FilePtr));
+  CloseFile(&(Dump->Balance.FilePtr));
+  CloseFile(&(Dump->SedBalance.FilePtr));
+  CloseFile(&(Dump->Stream.FilePtr));
+  CloseFile(&(Dump->MultiPoint.FilePtr));
+  for (i = 0; i < Dump->NPix && Dump->Pix; i++) {
+    CloseFile(&(Dump->Pix[i].OutFile.FilePtr));
+    CloseFile(&(Dump->Pix[i].OutFileSediment.FilePtr));
+  }
+
+  CloseFile(&(ChannelData->streamout));
+  CloseFile(&(ChannelData->roadout));
+  CloseFile(&(ChannelData->streamflowout));
+  CloseFile(&(ChannelData->roadflowout));
+  CloseFile(&(ChannelData->sedstreamout));
+  CloseFile(&(ChannelData->sedroadout));
+  CloseFile(&(ChannelData->sedstreamflowout));
+  CloseFile(&(ChannelData->sedroadflowout));
+  CloseFile(&(ChannelData->sedstreaminflow));
+  CloseFile(&(ChannelData->sedroadinflow));
+}
+
+/*****************************************************************************
+  FreeDump()
+
+  Free the dates of the state and map dumps and the list of output pixels
+  of InitDump()
+*****************************************************************************/
+static void FreeDump(DUMPSTRUCT *Dump)
+{
+  int i;			/* counter */
+
+  for (i = 0; i < Dump->NMaps && Dump->DMap; i++)
+    free(Dump->DMap[i].DumpDate);
+  free(Dump->DMap);
+  free(Dump->Pix);
+  free(Dump->DState);
+  Dump->DMap = NULL;
+  Dump->Pix = NULL;
+  Dump->DState = NULL;
+}
+
+/*****************************************************************************
+  CloseFile()
+*****************************************************************************/
+static void CloseFile(FILE **File)
+{
+  if (*File) {
+    fclose(*File);
+    *File = NULL;
+  }
+}
+
+/*****************************************************************************
+  FreeLayerArrays()
+
+  Release the layer arrays of the pixels in the model state of a member
+  that are not placed
+*****************************************************************************/
+static void FreeLayerArrays(DHSVM *Model)
+{
+  int i;			/* counter */
+  int x;			/* counter */
+  int y;			/* counter */
+
+  for (y = 0; y < Model->Map.NY; y++) {
+    for (x = 0; x < Model->Map.NX; x++) {
+      if (Model->SoilMap && Model->SoilMap[y]) {
+	free(Model->SoilMap[y][x].Moist);
+	free(Model->SoilMap[y][x].Perc);
+	free(Model->SoilMap[y][x].Temp);
+      }
+      if (Model->EvapMap && Model->EvapMap[y] &&
+	  Model->EvapMap[y][x].ESoil) {
+	for (i = 0; i < Model->Veg.NLayers[Model->VegMap[y][x].Veg - 1]; i++)
+	  free(Model->EvapMap[y][x].ESoil[i]);
+	free(Model->EvapMap[y][x].ESoil);
+      }
+      if (Model->EvapMap && Model->EvapMap[y]) {
+	free(Model->EvapMap[y][x].EPot);
+	free(Model->EvapMap[y][x].EAct);
+	free(Model->EvapMap[y][x].EInt);
+      }
+      if (Model->PrecipMap && Model->PrecipMap[y]) {
+	free(Model->PrecipMap[y][x].IntRain);
+	free(Model->PrecipMap[y][x].IntSnow);
+      }
+      if (Model->Network && Model->Network[y]) {
+	free(Model->Network[y][x].Adjust);
+	free(Model->Network[y][x].PercArea);
+      }
+    }
+  }
+}
+
+/*****************************************************************************
+  FreeStateMaps()
+
+  Release the maps, the totals and the channel network in the model state
+  of a member, after the layer arrays
+*****************************************************************************/
+static void FreeStateMaps(DHSVM *Model)
+{
+  FreeRows((void **) Model->SoilMap, Model->Map.NY);
+  FreeRows((void **) Model->VegMap, Model->Map.NY);
+  FreeRows((void **) Model->EvapMap, Model->Map.NY);
+  FreeRows((void **) Model->PrecipMap, Model->Map.NY);
+  FreeRows((void **) Model->SnowMap, Model->Map.NY);
+  FreeRows((void **) Model->Network, Model->Map.NY);
+  free(Model->Hydrograph);
+  FreeAggregated(&(Model->Total), Model->Veg.MaxLayers);
+
+  if (Model->ChannelData.stream_map)
+    channel_grid_free_map(Model->ChannelData.stream_map);
+  if (Model->ChannelData.road_map)
+    channel_grid_free_map(Model->ChannelData.road_map);
+  if (Model->ChannelData.streams)
+    channel_free_network(Model->ChannelData.streams);
+  if (Model->ChannelData.roads)
+    channel_free_network(Model->ChannelData.roads);
+  if (Model->ChannelData.stream_class)
+    channel_free_classes(Model->ChannelData.stream_class);
+  if (Model->ChannelData.road_class)
+    channel_free_classes(Model->ChannelData.road_class);
+}
+
+/*****************************************************************************
+  FreeTables()
+
+  Release the soil, vegetation and snow albedo tables
+*****************************************************************************/
+static void FreeTables(DHSVM *Model)
+{
+  int i;			/* counter */
+  int j;			/* counter */
+  SOILTABLE *SType;		/* soil type */
+  VEGTABLE *VType;		/* vegetation type */
+
+  for (i = 0; i < Model->Soil.NTypes && Model->SType; i++) {
+    SType = &(Model->SType[i]);
+    free(SType->Porosity);
+    free(SType->PoreDist);
+    free(SType->Press);
+    free(SType->FCap);
+    free(SType->WP);
+    free(SType->Dens);
+    free(SType->Ks);
+    free(SType->KhDry);
+    free(SType->KhSol);
+    free(SType->Ch);
+  }
+  for (i = 0; i < Model->Veg.NTypes && Model->VType; i++) {
+    VType = &(Model->VType[i]);
+    free(VType->Fract);
+    free(VType->HemiFract);
+    free(VType->Height);
+    free(VType->RsMax);
+    free(VType->RsMin);
+    free(VType->MoistThres);
+    free(VType->VpdThres);
+    free(VType->Rpc);
+    free(VType->Albedo);
+    free(VType->MaxInt);
+    free(VType->LAI);
+    for (j = 0; j < VType->NVegLayers && VType->RootFract; j++)
+      free(VType->RootFract[j]);
+    free(VType->RootFract);
+    free(VType->RootDepth);
+    for (j = 0; j < VType->NVegLayers && VType->LAIMonthly; j++)
+      free(VType->LAIMonthly[j]);
+    free(VType->LAIMonthly);
+    for (j = 0; j < VType->NVegLayers && VType->AlbedoMonthly; j++)
+      free(VType->AlbedoMonthly[j]);
+    free(VType->AlbedoMonthly);
+  }
+  free(Model->SType);
+  free(Model->VType);
+  free(Model->Soil.NLayers);
+  free(Model->Veg.NLayers);
+  free(Model->SnowAlbedo);
+}
+
+/*****************************************************************************
+  FreeAggregated()
+
+  Release the arrays of InitAggregated()
+*****************************************************************************/
+static void FreeAggregated(AGGREGATED *Total, int MaxVegLayers)
+{
+  int i;			/* counter */
+
+  free(Total->Evap.EPot);
+  free(Total->Evap.EAct);
+  free(Total->Evap.EInt);
+  for (i = 0; i < MaxVegLayers && Total->Evap.ESoil; i++)
+    free(Total->Evap.ESoil[i]);
+  free(Total->Evap.ESoil);
+  free(Total->Precip.IntRain);
+  free(Total->Precip.IntSnow);
+  free(Total->Soil.Moist);
+  free(Total->Soil.Perc);
+  free(Total->Soil.Temp);
+}
+
+/*****************************************************************************
+  FreeRows()
+*****************************************************************************/
+static void FreeRows(void **Rows, int NY)
+{
+  int y;			/* counter */
+
+  if (!Rows)
+    return;
+  for (y = 0; y < NY; y++)
+    free(Rows[y]);
+  free(Rows);
+}
+
+/*****************************************************************************
+  FreeMaps()
+
+  Free N maps of NY rows, NULL maps and rows are skipped
+*****************************************************************************/
+static void FreeMaps(void ***Maps, int N, int NY)
+{
+  int n;			/* counter */
+
+  if (!Maps)
+    return;
+  for (n = 0; n < N; n++)
+    FreeRows(Maps[n], NY);
+  free(Maps);
+}
+
+/*****************************************************************************
+  PlaceLayerArrays()
+
+  Place the layer arrays of the pixels of the soil, evaporation and
+  precipitation maps, one block per field (placement.h)
+*****************************************************************************/
+static void PlaceLayerArrays(DHSVM *Model)
+{
+  PLACEMENT *Place = &(Model->Placement);
+  TILESTRUCT *Tiles = &(Model->Tiles);
+  MAPSIZE *Map = &(Model->Map);
+  int FirstTouch = Model->Options.FirstTouch;
+  int HugePages = Model->Options.HugePages;
+
+  PlaceLayers(Place, Tiles, Map, (void **) Model->SoilMap, sizeof(SOILPIX),
+	      offsetof(SOILPIX, Moist), FALSE, SoilLayersAndSaturated, Model,
+	      "SoilMap.Moist", FirstTouch, HugePages);
+  PlaceLayers(Place, Tiles, Map, (void **) Model->SoilMap, sizeof(SOILPIX),
+	      offsetof(SOILPIX, Perc), FALSE, SoilLayers, Model,
+	      "SoilMap.Perc", FirstTouch, HugePages);
+  PlaceLayers(Place, Tiles, Map, (void **) Model->SoilMap, sizeof(SOILPIX),
+	      offsetof(SOILPIX, Temp), FALSE, SoilLayers, Model,
+	      "SoilMap.Temp", FirstTouch, HugePages);
+  PlaceLayers(Place, Tiles, Map, (void **) Model->EvapMap, sizeof(EVAPPIX),
+	      offsetof(EVAPPIX, EPot), FALSE, VegLayersAndSoil, Model,
+	      "EvapMap.EPot", FirstTouch, HugePages);
+  PlaceLayers(Place, Tiles, Map, (void **) Model->EvapMap, sizeof(EVAPPIX),
+	      offsetof(EVAPPIX, EAct), FALSE, VegLayersAndSoil, Model,
+	      "EvapMap.EAct", FirstTouch, HugePages);
+  PlaceLayers(Place, Tiles, Map, (void **) Model->EvapMap, sizeof(EVAPPIX),
+	      offsetof(EVAPPIX, EInt), FALSE, VegLayers, Model,
+	      "EvapMap.EInt", FirstTouch, HugePages);
+  PlaceLayers(Place, Tiles, Map, (void **) Model->EvapMap, sizeof(EVAPPIX),
+	      offsetof(EVAPPIX, ESoil), TRUE, SoilLayersPerVegLayer, Model,
+	      "EvapMap.ESoil", FirstTouch, HugePages);
+  PlaceLayers(Place, Tiles, Map, (void **) Model->PrecipMap,
+	      sizeof(PRECIPPIX), offsetof(PRECIPPIX, IntRain), FALSE,
+	      VegLayers, Model, "PrecipMap.IntRain", FirstTouch, HugePages);
+  PlaceLayers(Place, Tiles, Map, (void **) Model->PrecipMap,
+	      sizeof(PRECIPPIX), offsetof(PRECIPPIX, IntSnow), FALSE,
+	      VegLayers, Model, "PrecipMap.IntSnow", FirstTouch, HugePages);
+}
+
+/*****************************************************************************
+  Layer counts of PlaceLayers(): the vegetation layers, the vegetation
+  layers plus the soil surface, the soil layers, the soil layers plus the
+  saturated zone, and the soil layers of each vegetation layer
+*****************************************************************************/
+static int VegLayers(void *Arg, int y, int x, int *NArrays)
+{
+  DHSVM *Model = (DHSVM *) Arg;
+
+  *NArrays = 1;
+  return Model->Veg.NLayers[Model->VegMap[y][x].Veg - 1];
+}
+
+static int VegLayersAndSoil(void *Arg, int y, int x, int *NArrays)
+{
+  return VegLayers(Arg, y, x, NArrays) + 1;
+}
+
+static int SoilLayers(void *Arg, int y, int x, int *NArrays)
+{
+  DHSVM *Model = (DHSVM *) Arg;
+
+  *NArrays = 1;
+  return Model->Soil.NLayers[Model->SoilMap[y][x].Soil - 1];
+}
+
+static int SoilLayersAndSaturated(void *Arg, int y, int x, int *NArrays)
+{
+  return SoilLayers(Arg, y, x, NArrays) + 1;
+}
+
+static int SoilLayersPerVegLayer(void *Arg, int y, int x, int *NArrays)
+{
+  int One;			/* Arrays of a plain layer count */
+
+  *NArrays = VegLayers(Arg, y, x, &One);
+  return SoilLayers(Arg, y, x, &One);
+}
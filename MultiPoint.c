@@ -0,0 +1,398 @@
+/*
+ * SUMMARY:      MultiPoint.c - Batched multi-point simulation
+ * USAGE:        Part of DHSVM
+ *
+ * AUTHOR:       DHSVM development team
+ * ORG:          University of Washington, Department of Civil Engineering
+ * E-MAIL:
+ * ORIG-DATE:    Oct-2026
+ * DESCRIPTION:  Support for running the model for a list of points in a
+ *               single process (EXTENT = MULTIPOINT).  All points share the
+ *               configuration, lookup tables and meteorological station
+ *               reads.  The column physics for the points is run as a
+ *               batched loop over several threads and the results for all
+ *               points are written to one binary table.
+ * DESCRIP-END.
+ * FUNCTIONS:    InitMultiPoint()
+ *               InitMultiPointDump()
+ *               MultiPointMassEnergyBalance()
+ *               DumpMultiPoint()
+ * COMMENTS:
+ * $Id: MultiPoint.c,v 1.0 2026/10/17 Exp $
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "settings.h"
+#include "data.h"
+#include "DHSVMerror.h"
+#include "fileio.h"
+#include "functions.h"
+#include "getinit.h"
+#include "sweep.h"
+#include "tiles.h"
+
+/* Number of variables written for each point, in addition to the soil
+   moisture for each soil layer plus the layer below the root zone */
+#define MP_NVARS 14
+
+static char *MultiPointVars[MP_NVARS] = {
+  "Tair (C)", "Rh (%)", "Wind (m/s)", "Sin (W/m2)", "Lin (W/m2)",
+  "Precip (m)", "SnowFall (m)", "Swq (m)", "Melt (m)", "SnowOutflow (m)",
+  "ETot (m)", "IExcess (m)", "TableDepth (m)", "TSurf (C)"
+};
+
+typedef struct {
+  CELLSWEEP *Sweep;		/* Model structures */
+  TILESTRUCT *Tiles;		/* Blocks of points */
+  PIXMET *PointMet;		/* Local meteorology for each point */
+  PIXRAD *PointRad;		/* Radiation of each point */
+} MULTIPOINTSWEEP;
+
+static int ComparePoints(const void *A, const void *B);
+static void MultiPointTile(void *Arg, TILE *Tile, int Thread);
+
+/*****************************************************************************
+  Function name: InitMultiPoint()
+
+  Purpose      : Read the list of points to model in MULTIPOINT mode
+
+  Required     :
+    char *PointFile       - File with one "north east" coordinate pair per
+                            line.  Empty lines and lines starting with '#'
+                            are skipped
+    MAPSIZE *Map          - Coverage and resolution of model area
+    OPTIONSTRUCT *Options - Structure with different program options
+
+  Returns      : void
+
+  Modifies     : Options->NPoints, Options->Points
+
+  Comments     : The coordinates are converted to rows and columns in the
+                 same way as POINT NORTH and POINT EAST in POINT mode.  Two
+                 points in the same pixel are an error.  Points in
+                 neighbouring pixels are allowed, but subsurface flow will be
+                 exchanged between them, so a warning is issued.
+*****************************************************************************/
+void InitMultiPoint(char *PointFile, MAPSIZE *Map, OPTIONSTRUCT *Options)
+{
+  const char *Routine = "InitMultiPoint";
+  FILE *InFile = NULL;
+  char Buffer[BUFSIZE + 1];
+  char *Str;
+  double North;			/* North coordinate of point */
+  double East;			/* East coordinate of point */
+  int NLines;			/* Number of lines in the point file */
+  int i;			/* counter */
+  int dx;			/* counter */
+  int dy;			/* counter */
+  int NAdjacent;		/* Number of points with a neighbouring point */
+  COORD Key;			/* Location to search for */
+  COORD *Sorted;		/* Point locations sorted by row and column */
+
+  OpenFile(&InFile, PointFile, "r", FALSE);
+
+  NLines = CountLines(InFile);
+  rewind(InFile);
+
+  if (!(Options->Points = (COORD *) calloc(NLines, sizeof(COORD))))
+    ReportError((char *) Routine, 1);
+
+  Options->NPoints = 0;
+  for (i = 0; i < NLines; i++) {
+    if (!fgets(Buffer, BUFSIZE, InFile))
+      break;
+    for (Str = Buffer; *Str == ' ' || *Str == '\t'; Str++)
+      ;
+    if (*Str == '#' || *Str == '\n' || *Str == '\r' || *Str == '\0')
+      continue;
+    if (sscanf(Str, "%lf %lf", &North, &East) != 2)
+      ReportError(PointFile, 2);
+
+    Options->Points[Options->NPoints].N =
+      Round(((Map->Yorig - 0.5 * Map->DY) - North) / Map->DY);
+    Options->Points[Options->NPoints].E =
+      Round((East - (Map->Xorig + 0.5 * Map->DX)) / Map->DX);
+
+    if (Options->Points[Options->NPoints].N < 0 ||
+	Options->Points[Options->NPoints].N >= Map->NY ||
+	Options->Points[Options->NPoints].E < 0 ||
+	Options->Points[Options->NPoints].E >= Map->NX) {
+      sprintf(errorstr, "%s, line %d", PointFile, i + 1);
+      ReportError(errorstr, 75);
+    }
+    Options->NPoints++;
+  }
+  fclose(InFile);
+
+  if (Options->NPoints == 0)
+    ReportError(PointFile, 2);
+
+  /* Check for duplicate and neighbouring points */
+  if (!(Sorted = (COORD *) calloc(Options->NPoints, sizeof(COORD))))
+    ReportError((char *) Routine, 1);
+  memcpy(Sorted, Options->Points, Options->NPoints * sizeof(COORD));
+  qsort(Sorted, Options->NPoints, sizeof(COORD), ComparePoints);
+
+  NAdjacent = 0;
+  for (i = 0; i < Options->NPoints; i++) {
+    if (i > 0 && ComparePoints(&Sorted[i], &Sorted[i - 1]) == 0) {
+      sprintf(errorstr, "%s, row %d, column %d", PointFile, Sorted[i].N,
+	      Sorted[i].E);
+      ReportError(errorstr, 76);
+    }
+    for (dy = -1; dy <= 1; dy++) {
+      for (dx = -1; dx <= 1; dx++) {
+	if (dx == 0 && dy == 0)
+	  continue;
+	Key.N = Sorted[i].N + dy;
+	Key.E = Sorted[i].E + dx;
+	if (bsearch(&Key, Sorted, Options->NPoints, sizeof(COORD),
+		    ComparePoints)) {
+	  NAdjacent++;
+	  dy = 2;
+	  break;
+	}
+      }
+    }
+  }
+  free(Sorted);
+
+  printf("Modeling %d points from %s\n", Options->NPoints, PointFile);
+  if (NAdjacent > 0)
+    printf("Warning: %d points have a point in a neighbouring pixel and will "
+	   "exchange subsurface flow\n", NAdjacent);
+}
+
+/*****************************************************************************
+  Function name: InitMultiPointDump()
+
+  Purpose      : Open the binary table for the MULTIPOINT output and write a
+                 text file that describes its layout
+
+  Required     :
+    char *Path            - Output directory
+    MAPSIZE *Map          - Coverage and resolution of model area
+    OPTIONSTRUCT *Options - Structure with different program options
+    TIMESTRUCT *Time      - Model time
+    int MaxSoilLayers     - Maximum number of soil layers
+    FILES *OutFile        - Binary table
+
+  Returns      : void
+
+  Modifies     : OutFile
+
+  Comments     : The table (MultiPoint.bin) contains one record per model
+                 time step.  Each record holds, for each point in the order
+                 of the point file, the variables listed in MultiPoint.hdr as
+                 4-byte floats in native byte order.
+*****************************************************************************/
+void InitMultiPointDump(char *Path, MAPSIZE *Map, OPTIONSTRUCT *Options,
+			TIMESTRUCT *Time, int MaxSoilLayers, FILES *OutFile)
+{
+  FILE *HdrFile = NULL;
+  char FileName[BUFSIZE + 1];
+  int i;			/* counter */
+
+  sprintf(FileName, "%sMultiPoint.hdr", Path);
+  OpenFile(&HdrFile, FileName, "w", TRUE);
+
+  fprintf(HdrFile, "# Layout of MultiPoint.bin\n");
+  fprintf(HdrFile, "# one record per time step, each record holds for each "
+	  "point the variables below as 4-byte floats\n");
+  fprintf(HdrFile, "Start ");
+  PrintDate(&(Time->Start), HdrFile);
+  fprintf(HdrFile, "\nTimeStep %d\n", Time->Dt);
+  fprintf(HdrFile, "NumberOfPoints %d\n", Options->NPoints);
+  fprintf(HdrFile, "NumberOfVariables %d\n", MP_NVARS + MaxSoilLayers + 1);
+  fprintf(HdrFile, "# Variables\n");
+  for (i = 0; i < MP_NVARS; i++)
+    fprintf(HdrFile, "%d %s\n", i, MultiPointVars[i]);
+  for (i = 0; i < MaxSoilLayers; i++)
+    fprintf(HdrFile, "%d Moist layer %d (-), %d for missing layers\n",
+	    MP_NVARS + i, i, NA);
+  fprintf(HdrFile, "%d Moist below root zone (-)\n",
+	  MP_NVARS + MaxSoilLayers);
+  fprintf(HdrFile, "# Points: index north east row column\n");
+  for (i = 0; i < Options->NPoints; i++)
+    fprintf(HdrFile, "%d %.3f %.3f %d %d\n", i,
+	    Map->Yorig - (Options->Points[i].N + 0.5) * Map->DY,
+	    Map->Xorig + (Options->Points[i].E + 0.5) * Map->DX,
+	    Options->Points[i].N, Options->Points[i].E);
+  fclose(HdrFile);
+
+  sprintf(OutFile->FileName, "%sMultiPoint.bin", Path);
+  OpenFile(&(OutFile->FilePtr), OutFile->FileName, "wb", TRUE);
+}
+
+/*****************************************************************************
+  Function name: MultiPointMassEnergyBalance()
+
+  Purpose      : Run the column physics for all points in MULTIPOINT mode
+
+  Required     :
+    CELLSWEEP *Sweep  - Pointers to the model structures
+    TILESTRUCT *Tiles - Blocks of points and the thread pool, made by
+                        InitPointTiles() (tiles.h)
+    PIXMET *PointMet  - Local meteorology for each point
+    PIXRAD *TotalRad  - Radiation totals
+
+  Returns      : void
+
+  Modifies     : PointMet, TotalRad and the model maps at the points
+
+  Comments     : The blocks of points run on the persistent threads of
+                 the tile scheduler, which are started once by
+                 InitPointTiles().  Without that pool (a single thread)
+                 the points run in list order on the calling thread.  The
+                 radiation of each point is kept apart and added to
+                 TotalRad in point order after the blocks are done, so that
+                 the results do not depend on the number or the scheduling
+                 of the threads.  The threads only read the shared
+                 vegetation and soil tables
+*****************************************************************************/
+void MultiPointMassEnergyBalance(CELLSWEEP *Sweep, TILESTRUCT *Tiles,
+				 PIXMET *PointMet, PIXRAD *TotalRad)
+{
+  const char *Routine = "MultiPointMassEnergyBalance";
+  COORD *Points = Sweep->Options->Points;
+  int NPoints = Sweep->Options->NPoints;
+  int i;			/* counter */
+  MULTIPOINTSWEEP Work;
+  PIXRAD *Rad;
+
+  if (Tiles->NThreads <= 1) {
+    for (i = 0; i < NPoints; i++)
+      PointMet[i] = SweepCell(Sweep, Points[i].N, Points[i].E, TotalRad);
+    return;
+  }
+
+  Work.Sweep = Sweep;
+  Work.Tiles = Tiles;
+  Work.PointMet = PointMet;
+  if (!(Work.PointRad = (PIXRAD *) calloc(NPoints, sizeof(PIXRAD))))
+    ReportError((char *) Routine, 1);
+
+  RunTiles(Tiles, MultiPointTile, &Work);
+
+  for (i = 0; i < NPoints; i++) {
+    Rad = &(Work.PointRad[i]);
+    TotalRad->NetShort[0] += Rad->NetShort[0];
+    TotalRad->NetShort[1] += Rad->NetShort[1];
+    TotalRad->LongIn[0] += Rad->LongIn[0];
+    TotalRad->LongIn[1] += Rad->LongIn[1];
+    TotalRad->LongOut[0] += Rad->LongOut[0];
+    TotalRad->LongOut[1] += Rad->LongOut[1];
+    TotalRad->PixelNetShort += Rad->PixelNetShort;
+    TotalRad->PixelLongIn += Rad->PixelLongIn;
+    TotalRad->PixelLongOut += Rad->PixelLongOut;
+  }
+
+  free(Work.PointRad);
+}
+
+/*****************************************************************************
+  Function name: DumpMultiPoint()
+
+  Purpose      : Write one record of the MULTIPOINT binary table
+
+  Required     :
+    FILES *OutFile        - Binary table
+    OPTIONSTRUCT *Options - Structure with different program options
+    LAYER *Soil           - Soil layer information
+    PIXMET *PointMet      - Local meteorology for each point
+    PRECIPPIX **PrecipMap - Precipitation for each pixel
+    SNOWPIX **SnowMap     - Snow cover for each pixel
+    SOILPIX **SoilMap     - Soil conditions for each pixel
+    EVAPPIX **EvapMap     - Evapotranspiration for each pixel
+
+  Returns      : void
+
+  Modifies     : OutFile
+
+  Comments     : See InitMultiPointDump() for the layout of the record
+*****************************************************************************/
+void DumpMultiPoint(FILES *OutFile, OPTIONSTRUCT *Options, LAYER *Soil,
+		    PIXMET *PointMet, PRECIPPIX **PrecipMap, SNOWPIX **SnowMap,
+		    SOILPIX **SoilMap, EVAPPIX **EvapMap)
+{
+  const char *Routine = "DumpMultiPoint";
+  float *Record;		/* Values for a single point */
+  int NVars;			/* Number of values for each point */
+  int NSoilL;			/* Number of soil layers at the point */
+  int i;			/* counter */
+  int j;			/* counter */
+  int x;			/* column */
+  int y;			/* row */
+
+  NVars = MP_NVARS + Soil->MaxLayers + 1;
+  if (!(Record = (float *) calloc(NVars, sizeof(float))))
+    ReportError((char *) Routine, 1);
+
+  for (i = 0; i < Options->NPoints; i++) {
+    y = Options->Points[i].N;
+    x = Options->Points[i].E;
+    NSoilL = Soil->NLayers[SoilMap[y][x].Soil - 1];
+
+    Record[0] = PointMet[i].Tair;
+    Record[1] = PointMet[i].Rh;
+    Record[2] = PointMet[i].Wind;
+    Record[3] = PointMet[i].Sin;
+    Record[4] = PointMet[i].Lin;
+    Record[5] = PrecipMap[y][x].Precip;
+    Record[6] = PrecipMap[y][x].SnowFall;
+    Record[7] = SnowMap[y][x].Swq;
+    Record[8] = SnowMap[y][x].Melt;
+    Record[9] = SnowMap[y][x].Outflow;
+    Record[10] = EvapMap[y][x].ETot;
+    Record[11] = SoilMap[y][x].IExcess;
+    Record[12] = SoilMap[y][x].TableDepth;
+    Record[13] = SoilMap[y][x].TSurf;
+    for (j = 0; j < Soil->MaxLayers; j++)
+      Record[MP_NVARS + j] = (j < NSoilL && SoilMap[y][x].Moist) ?
+	SoilMap[y][x].Moist[j] : NA;
+    Record[MP_NVARS + Soil->MaxLayers] = SoilMap[y][x].Moist ?
+      SoilMap[y][x].Moist[NSoilL] : NA;
+
+    if (fwrite(Record, sizeof(float), NVars, OutFile->FilePtr) !=
+	(size_t) NVars)
+      ReportError(OutFile->FileName, 78);
+  }
+
+  free(Record);
+}
+
+/*****************************************************************************
+  ComparePoints()
+*****************************************************************************/
+static int ComparePoints(const void *A, const void *B)
+{
+  const COORD *PointA = (const COORD *) A;
+  const COORD *PointB = (const COORD *) B;
+
+  if (PointA->N != PointB->N)
+    return (PointA->N < PointB->N) ? -1 : 1;
+  if (PointA->E != PointB->E)
+    return (PointA->E < PointB->E) ? -1 : 1;
+  return 0;
+}
+
+/*****************************************************************************
+  MultiPointTile()
+
+  Tile function of MultiPointMassEnergyBalance(), runs the column physics
+  for a block of points
+*****************************************************************************/
+static void MultiPointTile(void *Arg, TILE *Tile, int Thread)
+{
+  MULTIPOINTSWEEP *Work = (MULTIPOINTSWEEP *) Arg;
+  COORD *Point;
+  int i;			/* point */
+
+  for (i = Tile->First; i < Tile->First + Tile->NCells; i++) {
+    Point = &(Work->Tiles->Cells[i]);
+    Work->PointMet[i] = SweepCell(Work->Sweep, Point->N, Point->E,
+				  &(Work->PointRad[i]));
+  }
+}
@@ -0,0 +1,556 @@
+/*
+ * SUMMARY:      Order.c - Storage order of the kinematic wave routing
+ * USAGE:        Part of DHSVM
+ *
+ * AUTHOR:       DHSVM development team
+ * ORG:          University of Washington, Department of Civil Engineering
+ * E-MAIL:
+ * ORIG-DATE:    Oct-2026
+ * DESCRIPTION:  Renumber the active pixels tile by tile along a space
+ *               filling curve and route the kinematic wave in that
+ *               storage without changing the results, see order.h
+ * DESCRIP-END.
+ * FUNCTIONS:    InitCellOrder()
+ *               LoadCellOrder()
+ *               StoreCellOrder()
+ *               FreeCellOrder()
+ * COMMENTS:     The constraints between the pixels are found by walking
+ *               the elevation order once and linking each pixel to the
+ *               previous pixel that touched the same runon.
+ * $Id: Order.c,v 1.0 2026/10/17 Exp $
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "settings.h"
+#include "constants.h"
+#include "data.h"
+#include "compact.h"
+#include "DHSVMerror.h"
+#include "DHSVMChannel.h"
+#include "memtrack.h"
+#include "params.h"
+#include "slopeaspect.h"
+#include "tiles.h"
+#include "order.h"
+
+typedef struct {
+  long Key;			/* Position of the tile on the curve */
+  long Tile;			/* Tile number, row by row */
+} TILEKEY;
+
+static void *AllocateOrder(long NElem, size_t Size);
+static long CurveKey(int Order, int NTileX, int Side, int ty, int tx);
+static int CompareTileKeys(const void *a, const void *b);
+static void RouteSchedule(CELLORDER *CellOrder, MAPSIZE *Map, long *Num,
+			  int TileSize, int NTileX, long *TileOf,
+			  long NTiles);
+
+/*****************************************************************************
+  Function name: InitCellOrder()
+
+  Purpose      : Renumber the active pixels for the kinematic wave routing
+                 and find the order in which the routing visits them
+
+  Required     :
+    MAPSIZE *Map          - Size of the basin and the elevation order
+    TOPOPIX **TopoMap     - Basin mask, slope and flow directions
+    SOILPIX **SoilMap     - Soil type of the pixels
+    SOILTABLE *SType      - Manning's n of the soil types
+    PARAMMAP *Params      - Kinematic wave coefficients if Params->Active
+    CHANNEL *ChannelData  - Stream and road maps
+    int Order             - ORDER_ELEVATION, ORDER_TILED, ORDER_MORTON or
+                            ORDER_HILBERT
+    int TileSize          - Tile edge (pixels), 0 for the default
+
+  Returns      : void
+
+  Modifies     : Map->CellOrder
+
+  Comments     : The kinematic wave coefficient depends on the slope and
+                 Manning's n only, which do not change during the run, and
+                 is computed here as in RouteSurface().  The ensemble
+                 members only perturb the lateral conductivity and share
+                 it.
+*****************************************************************************/
+void InitCellOrder(MAPSIZE *Map, TOPOPIX **TopoMap, SOILPIX **SoilMap,
+		   SOILTABLE *SType, PARAMMAP *Params, CHANNEL *ChannelData,
+		   int Order, int TileSize)
+{
+  const char *Routine = "InitCellOrder";
+  const char *Name[] = { "elevation", "tiled", "Morton", "Hilbert" };
+  CELLORDER *CellOrder;
+  TILEKEY *Keys;		/* Tiles with pixels, in curve order */
+  long NGrid = (long) Map->NY * Map->NX;
+  long *Num;			/* Index in Cells of each grid cell, -1
+				   outside the basin */
+  long *TileOf;			/* Rank of each tile in curve order, -1 if the
+				   tile has no pixels */
+  long N = Map->NumCells;	/* Number of pixels */
+  long NEdges;			/* Number of neighbors */
+  long NTiles;			/* Tiles with pixels */
+  long k;			/* index in Cells */
+  long r;			/* tile rank */
+  long s;			/* counter */
+  long t;			/* tile number */
+  double beta = 3. / 5.;	/* Kinematic wave exponent */
+  double slope;			/* Manning's slope */
+  int NTileX;			/* Tile columns */
+  int NTileY;			/* Tile rows */
+  int Side;			/* Edge of the curve (tiles), a power of 2 */
+  int n;			/* direction */
+  int x;			/* counter */
+  int xn;			/* neighbor column */
+  int y;			/* counter */
+  int yn;			/* neighbor row */
+
+  Map->CellOrder = NULL;
+  if (Order == ORDER_ELEVATION || N == 0)
+    return;
+  if (TileSize <= 0)
+    TileSize = DEFAULTTILESIZE;
+
+  if (!(CellOrder = (CELLORDER *) calloc(1, sizeof(CELLORDER))))
+    ReportError((char *) Routine, 1);
+  CellOrder->Order = Order;
+  CellOrder->NCells = N;
+
+  /* rank the tiles with pixels along the curve */
+  NTileX = (Map->NX + TileSize - 1) / TileSize;
+  NTileY = (Map->NY + TileSize - 1) / TileSize;
+  for (Side = 1; Side < NTileX || Side < NTileY; Side *= 2)
+    ;
+  if (!(Num = (long *) malloc(NGrid * sizeof(long))) ||
+      !(TileOf = (long *) malloc((long) NTileX * NTileY * sizeof(long))) ||
+      !(Keys = (TILEKEY *) malloc((long) NTileX * NTileY * sizeof(TILEKEY))))
+    ReportError((char *) Routine, 1);
+  for (s = 0; s < NGrid; s++)
+    Num[s] = -1;
+  for (t = 0; t < (long) NTileX * NTileY; t++)
+    TileOf[t] = -1;
+  for (s = 0; s < N; s++) {
+    y = Map->OrderedCells[s].y;
+    x = Map->OrderedCells[s].x;
+    Num[(long) y * Map->NX + x] = 0;
+    TileOf[(long) (y / TileSize) * NTileX + x / TileSize] = 0;
+  }
+  NTiles = 0;
+  for (t = 0; t < (long) NTileX * NTileY; t++) {
+    if (TileOf[t] == 0) {
+      Keys[NTiles].Key = CurveKey(Order, NTileX, Side, t / NTileX,
+				  t % NTileX);
+      Keys[NTiles].Tile = t;
+      NTiles++;
+    }
+  }
+  qsort(Keys, NTiles, sizeof(TILEKEY), CompareTileKeys);
+
+  /* number the pixels tile by tile, and row by row within a tile */
+  CellOrder->Cells = (COORD *) AllocateOrder(N, sizeof(COORD));
+  k = 0;
+  for (r = 0; r < NTiles; r++) {
+    t = Keys[r].Tile;
+    TileOf[t] = r;
+    for (y = (t / NTileX) * TileSize;
+	 y < (t / NTileX + 1) * TileSize && y < Map->NY; y++) {
+      for (x = (t % NTileX) * TileSize;
+	   x < (t % NTileX + 1) * TileSize && x < Map->NX; x++) {
+	if (Num[(long) y * Map->NX + x] == 0) {
+	  Num[(long) y * Map->NX + x] = k;
+	  CellOrder->Cells[k].N = y;
+	  CellOrder->Cells[k].E = x;
+	  k++;
+	}
+      }
+    }
+  }
+
+  /* the coefficients and the downslope neighbors of the pixels.  A pixel
+     with a channel has no outflow to its neighbors, and a pixel adds to the
+     runon of the neighbors in the basin it drains to, or of all of them if
+     it has no flow direction */
+  CellOrder->Alpha = (double *) AllocateOrder(N, sizeof(double));
+  CellOrder->Channel = (uchar *) AllocateOrder(N, sizeof(uchar));
+  CellOrder->First = (long *) AllocateOrder(N + 1, sizeof(long));
+  for (NEdges = 0, k = 0; k < N; k++) {
+    y = CellOrder->Cells[k].N;
+    x = CellOrder->Cells[k].E;
+    slope = TOPOSLOPE(TopoMap[y][x]);
+    if (slope == 0)
+      slope = 0.0001;
+    else if (slope < 0) {
+      printf("negative slope in RouteSurface.c\n");
+      exit(0);
+    }
+    if (Params->Active)
+      CellOrder->Alpha[k] = Params->Alpha[PARAMINDEX(Params, y, x)];
+    else
+      CellOrder->Alpha[k] =
+	pow(SType[SoilMap[y][x].Soil - 1].Manning *
+	    pow((double) Map->DX, 2. / 3.) / sqrt(slope), beta);
+    CellOrder->Channel[k] =
+      channel_grid_has_channel(ChannelData->stream_map, x, y) ||
+      (channel_grid_has_channel(ChannelData->road_map, x, y) &&
+       !channel_grid_has_sink(ChannelData->road_map, x, y));
+    CellOrder->First[k] = NEdges;
+    for (n = 0; n < NDIRS && !CellOrder->Channel[k]; n++) {
+      xn = x + xdirection[n];
+      yn = y + ydirection[n];
+      if (valid_cell(Map, xn, yn) && INBASIN(TopoMap[yn][xn].Mask) &&
+	  (TopoMap[y][x].Dir[n] > 0 || TopoMap[y][x].TotalDir == 0))
+	NEdges++;
+    }
+  }
+  CellOrder->First[N] = NEdges;
+  CellOrder->Down = (long *) AllocateOrder(NEdges > 0 ? NEdges : 1,
+					   sizeof(long));
+  CellOrder->Frac = (float *) AllocateOrder(NEdges > 0 ? NEdges : 1,
+					    sizeof(float));
+  for (NEdges = 0, k = 0; k < N; k++) {
+    y = CellOrder->Cells[k].N;
+    x = CellOrder->Cells[k].E;
+    for (n = 0; n < NDIRS && !CellOrder->Channel[k]; n++) {
+      xn = x + xdirection[n];
+      yn = y + ydirection[n];
+      if (valid_cell(Map, xn, yn) && INBASIN(TopoMap[yn][xn].Mask) &&
+	  (TopoMap[y][x].Dir[n] > 0 || TopoMap[y][x].TotalDir == 0)) {
+	CellOrder->Down[NEdges] = Num[(long) yn * Map->NX + xn];
+	CellOrder->Frac[NEdges] =
+	  (float) TopoMap[y][x].Dir[n] / (float) TopoMap[y][x].TotalDir;
+	NEdges++;
+      }
+    }
+  }
+
+  /* the state of the routing, see LoadCellOrder() */
+  CellOrder->IExcess = (float *) AllocateOrder(N, sizeof(float));
+  CellOrder->IExcessSed = (float *) AllocateOrder(N, sizeof(float));
+  CellOrder->StartRunoff = (float *) AllocateOrder(N, sizeof(float));
+  CellOrder->StartRunon = (float *) AllocateOrder(N, sizeof(float));
+  CellOrder->Runoff = (float *) AllocateOrder(N, sizeof(float));
+  CellOrder->Runon = (float *) AllocateOrder(N, sizeof(float));
+
+  RouteSchedule(CellOrder, Map, Num, TileSize, NTileX, TileOf, NTiles);
+  Map->CellOrder = CellOrder;
+
+  free(Num);
+  free(TileOf);
+  free(Keys);
+
+  printf("Storing the routing in %s order, %ld tiles of %d by %d pixels\n",
+	 Name[Order], NTiles, TileSize, TileSize);
+}
+
+/*****************************************************************************
+  RouteSchedule()
+
+  Order in which the routing visits the pixels.  Step s of the elevation
+  order routes OrderedCells[NumCells - 1 - s].  A pixel reads and clears its
+  own runon and adds to the runon of the pixels it drains to; the pixels
+  that touch the same runon must keep their order, which gives a graph with
+  an edge from every pixel to the next pixel that touches the same runon.
+  The tiles are then swept in curve order, and every pixel whose
+  predecessors are all done is taken, until all pixels are taken.  The
+  first pixel left in the elevation order is always free, so every sweep
+  takes at least one pixel
+*****************************************************************************/
+static void RouteSchedule(CELLORDER *CellOrder, MAPSIZE *Map, long *Num,
+			  int TileSize, int NTileX, long *TileOf,
+			  long NTiles)
+{
+  const char *Routine = "InitCellOrder";
+  long N = CellOrder->NCells;	/* Number of pixels */
+  long *Cell;			/* Index in Cells of each step */
+  long *Last;			/* Last step that touched each runon */
+  long *First;			/* Index in Succ of the first successor of
+				   each step */
+  long *Succ;			/* Successors of each step */
+  long *NSucc;			/* Successors of each step found so far */
+  long *NPred;			/* Predecessors of each step not yet taken */
+  long *Start;			/* Index in Steps of the first pixel of each
+				   tile */
+  long *Pending;		/* Pixels of each tile not yet taken */
+  long *Steps;			/* Steps of the pixels, tile by tile */
+  long NEdges;			/* Number of edges */
+  long NTaken;			/* Pixels taken so far */
+  long c;			/* step */
+  long e;			/* index in Down */
+  long i;			/* counter */
+  long j;			/* counter */
+  long k;			/* index in Cells */
+  long m;			/* counter */
+  long r;			/* tile rank */
+  long s;			/* step */
+  int Pass;			/* counter */
+
+  if (!(Cell = (long *) malloc(N * sizeof(long))) ||
+      !(Last = (long *) malloc(N * sizeof(long))) ||
+      !(NSucc = (long *) calloc(N, sizeof(long))) ||
+      !(NPred = (long *) calloc(N, sizeof(long))) ||
+      !(First = (long *) calloc(N + 1, sizeof(long))))
+    ReportError((char *) Routine, 1);
+  for (s = 0; s < N; s++)
+    Cell[s] = Num[(long) Map->OrderedCells[N - 1 - s].y * Map->NX +
+		  Map->OrderedCells[N - 1 - s].x];
+
+  /* count the edges, then store them.  A step touches the runon of its own
+     pixel (e = -1) and of its neighbors */
+  for (i = 0; i < N; i++)
+    Last[i] = -1;
+  for (s = 0; s < N; s++) {
+    for (e = CellOrder->First[Cell[s]] - 1;
+	 e < CellOrder->First[Cell[s] + 1]; e++) {
+      k = e < CellOrder->First[Cell[s]] ? Cell[s] : CellOrder->Down[e];
+      if (Last[k] >= 0 && Last[k] != s) {
+	NSucc[Last[k]]++;
+	NPred[s]++;
+      }
+      Last[k] = s;
+    }
+  }
+  for (s = 0; s < N; s++)
+    First[s + 1] = First[s] + NSucc[s];
+  NEdges = First[N];
+  if (!(Succ = (long *) malloc((NEdges > 0 ? NEdges : 1) * sizeof(long))))
+    ReportError((char *) Routine, 1);
+  for (i = 0; i < N; i++) {
+    Last[i] = -1;
+    NSucc[i] = 0;
+  }
+  for (s = 0; s < N; s++) {
+    for (e = CellOrder->First[Cell[s]] - 1;
+	 e < CellOrder->First[Cell[s] + 1]; e++) {
+      k = e < CellOrder->First[Cell[s]] ? Cell[s] : CellOrder->Down[e];
+      if (Last[k] >= 0 && Last[k] != s) {
+	c = Last[k];
+	Succ[First[c] + NSucc[c]++] = s;
+      }
+      Last[k] = s;
+    }
+  }
+  free(Last);
+  free(NSucc);
+
+  /* the pixels of each tile in the elevation order */
+  if (!(Start = (long *) calloc(NTiles + 1, sizeof(long))) ||
+      !(Pending = (long *) calloc(NTiles, sizeof(long))) ||
+      !(Steps = (long *) malloc(N * sizeof(long))))
+    ReportError((char *) Routine, 1);
+  for (s = 0; s < N; s++) {
+    k = Cell[s];
+    Start[TileOf[(long) (CellOrder->Cells[k].N / TileSize) * NTileX +
+		 CellOrder->Cells[k].E / TileSize] + 1]++;
+  }
+  for (r = 0; r < NTiles; r++)
+    Start[r + 1] += Start[r];
+  for (s = 0; s < N; s++) {
+    k = Cell[s];
+    r = TileOf[(long) (CellOrder->Cells[k].N / TileSize) * NTileX +
+	       CellOrder->Cells[k].E / TileSize];
+    Steps[Start[r] + Pending[r]++] = s;
+  }
+
+  CellOrder->Route = (long *) AllocateOrder(N, sizeof(long));
+
+  /* sweep the tiles */
+  NTaken = 0;
+  for (Pass = 0; NTaken < N; Pass++) {
+    for (r = 0; r < NTiles; r++) {
+      for (j = 0, m = 0; j < Pending[r]; j++) {
+	s = Steps[Start[r] + j];
+	if (NPred[s] == 0) {
+	  CellOrder->Route[NTaken++] = Cell[s];
+	  for (i = First[s]; i < First[s + 1]; i++)
+	    NPred[Succ[i]]--;
+	}
+	else
+	  Steps[Start[r] + m++] = s;
+      }
+      Pending[r] = m;
+    }
+  }
+
+  free(Cell);
+  free(Succ);
+  free(First);
+  free(NPred);
+  free(Start);
+  free(Pending);
+  free(Steps);
+}
+
+/*****************************************************************************
+  Function name: LoadCellOrder()
+
+  Purpose      : Copy the state of the kinematic wave routing from the soil
+                 map into the storage order
+
+  Required     :
+    CELLORDER *Order   - Storage order, see order.h
+    SOILPIX **SoilMap  - Surface water and the outflow and inflow of the
+                         last sub-step
+
+  Returns      : void
+
+  Modifies     : The state arrays of Order
+
+  Comments     : The runoff and the runon start at zero, as in the loop over
+                 the elevation order
+*****************************************************************************/
+void LoadCellOrder(CELLORDER *Order, SOILPIX **SoilMap)
+{
+  SOILPIX *Pixel;
+  long k;
+
+  for (k = 0; k < Order->NCells; k++) {
+    Pixel = &(SoilMap[Order->Cells[k].N][Order->Cells[k].E]);
+    Order->IExcess[k] = Pixel->IExcess;
+    Order->IExcessSed[k] = Pixel->IExcessSed;
+    Order->StartRunoff[k] = Pixel->startRunoff;
+    Order->StartRunon[k] = Pixel->startRunon;
+  }
+  memset(Order->Runoff, 0, Order->NCells * sizeof(float));
+  memset(Order->Runon, 0, Order->NCells * sizeof(float));
+}
+
+/*****************************************************************************
+  Function name: StoreCellOrder()
+
+  Purpose      : Copy the state of the kinematic wave routing from the
+                 storage order back into the soil map
+
+  Required     :
+    CELLORDER *Order   - Storage order, see order.h
+    SOILPIX **SoilMap  - Soil map
+
+  Returns      : void
+
+  Modifies     : IExcess, IExcessSed, startRunoff, startRunon and Runoff of
+                 the pixels in SoilMap
+
+  Comments     :
+*****************************************************************************/
+void StoreCellOrder(CELLORDER *Order, SOILPIX **SoilMap)
+{
+  SOILPIX *Pixel;
+  long k;
+
+  for (k = 0; k < Order->NCells; k++) {
+    Pixel = &(SoilMap[Order->Cells[k].N][Order->Cells[k].E]);
+    Pixel->IExcess = Order->IExcess[k];
+    Pixel->IExcessSed = Order->IExcessSed[k];
+    Pixel->startRunoff = Order->StartRunoff[k];
+    Pixel->startRunon = Order->StartRunon[k];
+    Pixel->Runoff = Order->Runoff[k];
+  }
+}
+
+/*****************************************************************************
+  Function name: FreeCellOrder()
+
+  Purpose      : Free the storage order of the kinematic wave routing
+
+  Required     :
+    CELLORDER *Order - Storage order, or NULL
+
+  Returns      : void
+
+  Modifies     : Order
+
+  Comments     :
+*****************************************************************************/
+void FreeCellOrder(CELLORDER *Order)
+{
+  if (!Order)
+    return;
+  free(Order->Cells);
+  free(Order->Route);
+  free(Order->First);
+  free(Order->Down);
+  free(Order->Frac);
+  free(Order->Alpha);
+  free(Order->Channel);
+  free(Order->IExcess);
+  free(Order->IExcessSed);
+  free(Order->StartRunoff);
+  free(Order->StartRunon);
+  free(Order->Runoff);
+  free(Order->Runon);
+  free(Order);
+}
+
+/*****************************************************************************
+  AllocateOrder()
+
+  One zeroed array of the storage order, recorded as "CellOrder"
+*****************************************************************************/
+static void *AllocateOrder(long NElem, size_t Size)
+{
+  void *Array;
+
+  if (!(Array = TrackedCalloc((size_t) NElem, Size, MEM_TERRAIN,
+			      "CellOrder")))
+    ReportError("InitCellOrder", 1);
+
+  return Array;
+}
+
+/*****************************************************************************
+  CurveKey()
+
+  Position of tile (ty, tx) along the curve of the order.  Side is the edge
+  of the square the Hilbert curve fills, a power of 2
+*****************************************************************************/
+static long CurveKey(int Order, int NTileX, int Side, int ty, int tx)
+{
+  long Key = 0;
+  int Bit;			/* bit of the tile coordinates */
+  int rx;			/* quadrant column */
+  int ry;			/* quadrant row */
+  int Swap;
+
+  if (Order == ORDER_MORTON) {
+    for (Bit = 0; (1L << Bit) < Side; Bit++)
+      Key |= (((long) (tx >> Bit) & 1) << (2 * Bit)) |
+	(((long) (ty >> Bit) & 1) << (2 * Bit + 1));
+  }
+  else if (Order == ORDER_HILBERT) {
+    for (Bit = Side / 2; Bit > 0; Bit /= 2) {
+      rx = (tx & Bit) > 0;
+      ry = (ty & Bit) > 0;
+      Key += (long) Bit * Bit * ((3 * rx) ^ ry);
+      if (ry == 0) {
+	if (rx == 1) {
+	  tx = Side - 1 - tx;
+	  ty = Side - 1 - ty;
+	}
+	Swap = tx;
+	tx = ty;
+	ty = Swap;
+      }
+    }
+  }
+  else
+    Key = (long) ty * NTileX + tx;
+
+  return Key;
+}
+
+/*****************************************************************************
+  CompareTileKeys()
+
+  qsort() comparison of two tiles by their position on the curve
+*****************************************************************************/
+static int CompareTileKeys(const void *a, const void *b)
+{
+  const TILEKEY *Ta = (const TILEKEY *) a;
+  const TILEKEY *Tb = (const TILEKEY *) b;
+
+  if (Ta->Key < Tb->Key)
+    return -1;
+  if (Ta->Key > Tb->Key)
+    return 1;
+  return 0;
+}
@@ -0,0 +1,2018 @@
+/*
+ * SUMMARY:      Parallel.c - Divide the basin over MPI ranks
+ * USAGE:        Part of DHSVM
+ *
+ * AUTHOR:       DHSVM development team
+ * ORG:          University of Washington, Department of Civil Engineering
+ * E-MAIL:
+ * ORIG-DATE:    Oct-2026
+ * DESCRIPTION:  When DHSVM is built with -DHAVE_MPI and started with
+ *               mpirun -np N (N > 1), the basin is divided into N parts
+ *               along subbasin divides.  The model grid of each rank is
+ *               cropped to the bounding box of its own pixels and of its
+ *               halo, the pixels of other ranks next to them.  The maps,
+ *               the model state and the met maps are allocated after the
+ *               division, so each rank only holds its part of the basin.
+ *
+ *               Each rank runs the column physics, the subsurface routing
+ *               and the surface routing for its own pixels.  Flow that
+ *               crosses a partition boundary is sent to the rank that owns
+ *               the receiving pixel: after each pixel loop for the
+ *               subsurface flow and the conventional surface routing
+ *               (ExchangeFlow()), and pixel by pixel within each sub-step
+ *               of the kinematic wave routing (AddRunon()).  The water
+ *               levels of the halo are exchanged for the WATERTABLE flow
+ *               gradient (ExchangeHalo()).  The lateral inflows to the
+ *               channel and road networks are collected from all ranks, so
+ *               that every rank routes the networks segment by segment in
+ *               network order with the same inflows.  Flows are added in
+ *               the same order as in a serial run, so the pixel states and
+ *               the stream flow are the same as in a serial run.  The basin
+ *               averages are summed over the ranks and are the same up to
+ *               rounding.
+ *
+ *               Rank 0 writes the basin output, the model state and the
+ *               maps, with the pixels of all ranks (GatherWindow() in
+ *               FileIOBin.c).  Each rank writes the output pixels it owns.
+ *               The other ranks write their standard output and standard
+ *               error to a subdirectory of the output directory.
+ * DESCRIP-END.
+ * FUNCTIONS:    InitParallel()
+ *               InitParallelRank()
+ *               PartitionBasin()
+ *               AddFlow()
+ *               ExchangeFlow()
+ *               ExchangeInflow()
+ *               ExchangeHalo()
+ *               ResetRunon()
+ *               GetRunon()
+ *               AddRunon()
+ *               ExchangeRunon()
+ *               SumOverRanks()
+ *               MinOverRanks()
+ *               ReduceAggregate()
+ *               EndParallel()
+ * COMMENTS:     Without -DHAVE_MPI all functions return immediately, except
+ *               AddFlow() and AddRunon(), which add the flow.  The division
+ *               follows the flow directions and the channel network of the
+ *               whole basin, so every rank reads the terrain, soil and
+ *               vegetation maps of the whole grid before PartitionBasin(),
+ *               and the peak memory of the initialization includes them.
+ * $Id: Parallel.c,v 1.0 2026/10/17 Exp $
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#ifdef HAVE_MPI
+#include <mpi.h>
+#endif
+#include "settings.h"
+#include "constants.h"
+#include "data.h"
+#include "DHSVMerror.h"
+#include "fileio.h"
+#include "functions.h"
+#include "memtrack.h"
+#include "slopeaspect.h"
+
+#define RUNONTAG 100		/* Tag of the runon of the even sub-steps,
+				   RUNONTAG + 1 for the odd ones */
+
+static int MaxSegmentID(Channel *Head);
+static int *DivideBasin(PARALLELSTRUCT *Parallel, MAPSIZE *Map,
+			TOPOPIX **TopoMap, CHANNEL *ChannelData);
+static void FindBoxes(PARALLELSTRUCT *Parallel, MAPSIZE *Map,
+		      TOPOPIX **TopoMap, int *Owner, int *Box, uchar *Keep);
+static void WidenBox(MAPSIZE *Map, int *Box, MAPSIZE *Other);
+static void InitRunon(PARALLELSTRUCT *Parallel, MAPSIZE *Map,
+		      TOPOPIX **TopoMap, int *Owner);
+static void InitHalo(PARALLELSTRUCT *Parallel, MAPSIZE *Map,
+		     TOPOPIX **TopoMap, int *Owner, int *Box);
+static void InitGather(PARALLELSTRUCT *Parallel, MAPSIZE *Map);
+static Channel **SegmentTable(Channel *Head, int *N);
+static void StoreRunon(RUNONPIX *Pix, long Source, double Value, int Step,
+		       int Remote);
+static void LogInflow(ChannelMapPtr **Map, int Col, int Row, float Mass,
+		      void *Arg);
+#ifdef HAVE_MPI
+static void FlushRunon(PARALLELSTRUCT *Parallel);
+static void ReceiveRunon(PARALLELSTRUCT *Parallel);
+static int CompareFlow(const void *A, const void *B);
+static int CompareInflow(const void *A, const void *B);
+static int ComparePair(const void *A, const void *B);
+static int PackAggregate(double *Buffer, int Unpack, OPTIONSTRUCT *Options,
+			 LAYER *Soil, LAYER *Veg, AGGREGATED *Total);
+#endif
+
+/*****************************************************************************
+  Function name: InitParallel()
+
+  Purpose      : Start MPI and find the rank of this process
+
+  Required     :
+    int *argc                - Number of command line arguments
+    char ***argv             - Command line arguments
+    PARALLELSTRUCT *Parallel - Division of the basin over the ranks
+
+  Returns      : void
+
+  Modifies     : Parallel, argc, argv
+
+  Comments     : Must be called before anything else in dhsvm_init().  A
+                 serial build, or an MPI build started with a single rank,
+                 runs the whole basin in this process.  argc and argv may
+                 be NULL, and MPI is only started if the calling program
+                 has not done so already.
+*****************************************************************************/
+void InitParallel(int *argc, char ***argv, PARALLELSTRUCT *Parallel)
+{
+#ifdef HAVE_MPI
+  int Initialized;		/* TRUE if MPI was started before */
+#endif
+
+  memset(Parallel, 0, sizeof(PARALLELSTRUCT));
+  Parallel->Active = FALSE;
+  Parallel->Rank = 0;
+  Parallel->NRanks = 1;
+
+#ifdef HAVE_MPI
+  MPI_Initialized(&Initialized);
+  if (!Initialized) {
+    if (MPI_Init(argc, argv) != MPI_SUCCESS)
+      ReportError("InitParallel", 86);
+    Parallel->Started = TRUE;
+  }
+  MPI_Comm_rank(MPI_COMM_WORLD, &(Parallel->Rank));
+  MPI_Comm_size(MPI_COMM_WORLD, &(Parallel->NRanks));
+  Parallel->Active = (Parallel->NRanks > 1);
+#endif
+}
+
+/*****************************************************************************
+  Function name: InitParallelRank()
+
+  Purpose      : Create the output directory of a rank other than rank 0
+                 and send the standard output and standard error of the
+                 rank to it
+
+  Required     :
+    PARALLELSTRUCT *Parallel - Division of the basin over the ranks
+    char *Path               - Output directory
+
+  Returns      : void
+
+  Modifies     : Path, Parallel->Path, stdout, stderr
+
+  Comments     : The directory is rank.<rank> in the output directory.
+                 Rank 0 writes to the output directory itself.  The output
+                 directory of the run is kept in Parallel->Path, where each
+                 rank writes the output pixels it owns, see InitPixDump().
+*****************************************************************************/
+void InitParallelRank(PARALLELSTRUCT *Parallel, char *Path)
+{
+  char FileName[BUFSIZE + 1];
+
+  strcpy(Parallel->Path, Path);
+  if (!Parallel->Active || Parallel->Rank == 0)
+    return;
+
+  sprintf(Path + strlen(Path), "rank.%d/", Parallel->Rank);
+  if (mkdir(Path, 0755) != 0 && errno != EEXIST)
+    ReportError(Path, 81);
+
+  sprintf(FileName, "%sStandard.Out", Path);
+  if (!freopen(FileName, "w", stdout))
+    ReportError(FileName, 3);
+  sprintf(FileName, "%sStandard.Error", Path);
+  if (!freopen(FileName, "w", stderr))
+    ReportError(FileName, 3);
+}
+
+/*****************************************************************************
+  Function name: PartitionBasin()
+
+  Purpose      : Divide the basin pixels over the ranks along subbasin
+                 divides, and crop the model grid of this rank to its
+                 pixels and their halo
+
+  Required     :
+    OPTIONSTRUCT *Options - Program options
+    MAPSIZE *Map          - Size and location of model area
+    LAYER *Soil           - Number of soil layers of each soil type
+    VEGTABLE *VType       - Vegetation parameters
+    TOPOPIX ***TopoMap    - Topography, with the flow directions
+    SOILPIX ***SoilMap    - Soil map
+    VEGPIX ***VegMap      - Vegetation map
+    ROADSTRUCT ***Network - Channel and road cuts of each pixel
+    CHANNEL *ChannelData  - Channel and road network
+    int NStats            - Number of met stations
+    METLOCATION *Stat     - Met stations
+    MAPSIZE *Radar        - Size and location of the radar grid
+    MAPSIZE *MM5Map       - Size and location of the MM5 grid
+
+  Returns      : void
+
+  Modifies     : Options->Parallel, Map, the maps, ChannelData, the
+                 locations of the stations, the offsets of the radar and
+                 MM5 grids
+
+  Comments     : Each pixel is assigned to the channel segment it drains to
+                 by following the main flow direction downslope.  The
+                 segments are then ordered so that the segments upstream of
+                 any segment come right before it (a post-order walk of the
+                 network from the outlets), and this order is cut into
+                 pieces with about the same number of pixels.  Each piece
+                 is therefore a union of subbasins, and flow crosses the
+                 partition boundaries only along a few divides.  Pixels that
+                 do not drain to a channel go to the rank of the nearest
+                 pixel that does.  A pixel is "mixed" if a neighbor that
+                 belongs to another rank can send surface or subsurface flow
+                 to it, or if the impervious area of a pixel of another rank
+                 drains to it.
+
+                 The halo of a rank are the pixels of other ranks among the
+                 eight neighbors of its pixels and the pixels its impervious
+                 areas drain to.  They stay in the basin of the rank, so
+                 that the flow to them is computed as in a serial run, but
+                 they are not simulated.  Needs the flow directions of FLOW
+                 GRADIENT = TOPOGRAPHY, which do not change during the run,
+                 and must be called before the met maps are allocated.  All
+                 ranks compute the same partition.
+*****************************************************************************/
+void PartitionBasin(OPTIONSTRUCT *Options, MAPSIZE *Map, LAYER *Soil,
+		    VEGTABLE *VType, TOPOPIX ***TopoMap, SOILPIX ***SoilMap,
+		    VEGPIX ***VegMap, ROADSTRUCT ***Network,
+		    CHANNEL *ChannelData, int NStats, METLOCATION *Stat,
+		    MAPSIZE *Radar, MAPSIZE *MM5Map)
+{
+  const char *Routine = "PartitionBasin";
+  PARALLELSTRUCT *Parallel = &(Options->Parallel);
+  TOPOPIX **Topo = *TopoMap;
+  MAPWINDOW Window;		/* window of the grid in the map files */
+  int *Owner;			/* Rank of each pixel, -1 outside the basin */
+  uchar *Mixed;			/* TRUE for the mixed pixels */
+  uchar *Keep;			/* TRUE for the pixels of this rank and of
+				   its halo */
+  int *Box;			/* First row, first column, last row and last
+				   column of the grid of each rank */
+  long *NPixels;		/* Number of pixels of each rank */
+  long *NMixed;			/* Number of mixed pixels of each rank */
+  long Cell;			/* Pixel (y * NX + x) */
+  long i;			/* counter */
+  long k;			/* counter */
+  int n;			/* counter */
+  int r;			/* counter */
+  int x;			/* counter */
+  int y;			/* counter */
+  int xn;			/* x-index of the neighbor */
+  int yn;			/* y-index of the neighbor */
+  int y0;			/* first row of the grid of this rank */
+  int x0;			/* first column of the grid of this rank */
+
+  if (!Parallel->Active)
+    return;
+
+  Parallel->NY = Map->NY;
+  Parallel->NX = Map->NX;
+  Owner = DivideBasin(Parallel, Map, Topo, ChannelData);
+
+  if (!(Mixed = (uchar *) CallocMap(Map->NY, Map->NX, sizeof(uchar))))
+    ReportError((char *) Routine, 1);
+  if (!(Keep = (uchar *) CallocMap(Map->NY, Map->NX, sizeof(uchar))))
+    ReportError((char *) Routine, 1);
+  if (!(Box = (int *) calloc(4 * Parallel->NRanks, sizeof(int))))
+    ReportError((char *) Routine, 1);
+  if (!(NPixels = (long *) calloc(Parallel->NRanks, sizeof(long))))
+    ReportError((char *) Routine, 1);
+  if (!(NMixed = (long *) calloc(Parallel->NRanks, sizeof(long))))
+    ReportError((char *) Routine, 1);
+
+  /* pixels that can receive flow from another rank, see RouteSubSurface()
+     and RouteSurface() */
+  Parallel->NCells = 0;
+  for (y = 0; y < Map->NY; y++) {
+    for (x = 0; x < Map->NX; x++) {
+      Cell = (long) y * Map->NX + x;
+      if (!INBASIN(Topo[y][x].Mask))
+	continue;
+      Parallel->NCells++;
+      NPixels[Owner[Cell]]++;
+      for (n = 0; n < NDIRS; n++) {
+	xn = x + xdirection[n];
+	yn = y + ydirection[n];
+	if (valid_cell(Map, xn, yn) && INBASIN(Topo[yn][xn].Mask) &&
+	    Owner[(long) yn * Map->NX + xn] != Owner[Cell])
+	  Mixed[Cell] = TRUE;
+      }
+      xn = Topo[y][x].drains_x;
+      yn = Topo[y][x].drains_y;
+      if (VType[(*VegMap)[y][x].Veg - 1].ImpervFrac > 0.0 &&
+	  valid_cell(Map, xn, yn) && INBASIN(Topo[yn][xn].Mask) &&
+	  Owner[(long) yn * Map->NX + xn] != Owner[Cell])
+	Mixed[(long) yn * Map->NX + xn] = TRUE;
+    }
+  }
+  for (Cell = 0; Cell < (long) Map->NY * Map->NX; Cell++)
+    if (Mixed[Cell])
+      NMixed[Owner[Cell]]++;
+  for (r = 0; r < Parallel->NRanks; r++)
+    if (NPixels[r] == 0)
+      ReportError("MPI rank without pixels, the basin has too few "
+		  "subbasins for the number of ranks", 65);
+
+  /* the grid of each rank.  A grid with the size of the MM5 or the radar
+     grid would be taken for one of their maps (InWindow() in FileIOBin.c),
+     so it is made a little larger */
+  FindBoxes(Parallel, Map, Topo, Owner, Box, Keep);
+  for (r = 0; r < Parallel->NRanks; r++) {
+    for (n = 0; n < 2; n++) {
+      if (Options->MM5)
+	WidenBox(Map, &(Box[4 * r]), MM5Map);
+      if (Options->PrecipType == RADAR)
+	WidenBox(Map, &(Box[4 * r]), Radar);
+    }
+  }
+  y0 = Box[4 * Parallel->Rank];
+  x0 = Box[4 * Parallel->Rank + 1];
+  Parallel->OffsetY = y0;
+  Parallel->OffsetX = x0;
+  Parallel->NRows = Box[4 * Parallel->Rank + 2] - y0 + 1;
+  Parallel->NCols = Box[4 * Parallel->Rank + 3] - x0 + 1;
+
+  if (Parallel->Rank == 0) {
+    printf("\nDividing the basin over %d MPI ranks\n", Parallel->NRanks);
+    for (r = 0; r < Parallel->NRanks; r++)
+      printf("  rank %d: %ld pixels, %ld at partition boundaries, grid of "
+	     "%d by %d pixels from row %d and column %d\n", r, NPixels[r],
+	     NMixed[r], Box[4 * r + 2] - Box[4 * r] + 1,
+	     Box[4 * r + 3] - Box[4 * r + 1] + 1, Box[4 * r],
+	     Box[4 * r + 1]);
+  }
+
+  /* the kinematic runon and the halo of this rank need the routing order
+     and the ranks of all pixels */
+  if (Options->Routing)
+    InitRunon(Parallel, Map, Topo, Owner);
+  if (Options->FlowGradient == WATERTABLE)
+    InitHalo(Parallel, Map, Topo, Owner, &(Box[4 * Parallel->Rank]));
+
+  /* only the pixels of this rank and of its halo stay in the basin, and
+     only the pixels of this rank are routed */
+  for (y = 0; y < Map->NY; y++)
+    for (x = 0; x < Map->NX; x++)
+      if (INBASIN(Topo[y][x].Mask) && !Keep[(long) y * Map->NX + x])
+	Topo[y][x].Mask = OUTSIDEBASIN;
+  for (i = 0, k = 0; i < Map->NumCells; i++) {
+    y = Map->OrderedCells[i].y;
+    x = Map->OrderedCells[i].x;
+    if (Owner[(long) y * Map->NX + x] == Parallel->Rank)
+      Map->OrderedCells[k++] = Map->OrderedCells[i];
+  }
+  Map->NumCells = k;
+
+  if (!(Parallel->Owner = (int **) calloc(Parallel->NRows, sizeof(int *))))
+    ReportError((char *) Routine, 1);
+  if (!(Parallel->Mixed = (uchar **) calloc(Parallel->NRows,
+					     sizeof(uchar *))))
+    ReportError((char *) Routine, 1);
+  for (y = 0; y < Parallel->NRows; y++) {
+    if (!(Parallel->Owner[y] = (int *) calloc(Parallel->NCols,
+					      sizeof(int))))
+      ReportError((char *) Routine, 1);
+    if (!(Parallel->Mixed[y] = (uchar *) calloc(Parallel->NCols,
+						 sizeof(uchar))))
+      ReportError((char *) Routine, 1);
+    for (x = 0; x < Parallel->NCols; x++) {
+      Cell = (long) (y + y0) * Map->NX + x + x0;
+      Parallel->Owner[y][x] =
+	INBASIN(Topo[y + y0][x + x0].Mask) ? Owner[Cell] : -1;
+      Parallel->Mixed[y][x] = Mixed[Cell];
+    }
+  }
+
+  /* crop the grid, the map files keep their size */
+  if (Parallel->NRows != Map->NY || Parallel->NCols != Map->NX)
+    CropGrid(Map, Soil, VType, TopoMap, SoilMap, VegMap, Network,
+	     ChannelData, NStats, Stat, y0, x0, Parallel->NRows,
+	     Parallel->NCols);
+  GetMapWindow(&Window);
+  if (!Window.Active) {
+    Window.Active = TRUE;
+    Window.NY = Map->NY;
+    Window.NX = Map->NX;
+    Window.OffsetY = 0;
+    Window.OffsetX = 0;
+    Window.ModelNY = Map->NY;
+    Window.ModelNX = Map->NX;
+    Window.Gather = NULL;
+    SetMapWindow(&Window);
+  }
+  InitGather(Parallel, Map);
+
+  /* the MM5 and radar grids stay where they are */
+  if (Options->MM5) {
+    MM5Map->OffsetY += y0;
+    MM5Map->OffsetX -= x0;
+  }
+  if (Options->PrecipType == RADAR) {
+    Radar->OffsetY += y0;
+    Radar->OffsetX -= x0;
+  }
+
+  if (Parallel->NRunon > 0) {
+    if (!(Parallel->RunonMap = (int **) calloc(Parallel->NRows,
+						sizeof(int *))))
+      ReportError((char *) Routine, 1);
+    for (y = 0; y < Parallel->NRows; y++) {
+      if (!(Parallel->RunonMap[y] = (int *) malloc(Parallel->NCols *
+						    sizeof(int))))
+	ReportError((char *) Routine, 1);
+      for (x = 0; x < Parallel->NCols; x++)
+	Parallel->RunonMap[y][x] = -1;
+    }
+    for (i = 0; i < Parallel->NRunon; i++) {
+      Cell = Parallel->Runon[i].Cell;
+      Parallel->RunonMap[Cell / Parallel->NX - y0][Cell % Parallel->NX - x0] =
+	(int) i;
+    }
+  }
+
+  /* collect the channel inflows of all ranks, see ExchangeInflow() */
+  Parallel->Streams = SegmentTable(ChannelData->streams,
+				   &(Parallel->NStreams));
+  Parallel->Roads = SegmentTable(ChannelData->roads, &(Parallel->NRoads));
+  Parallel->RoadMap = ChannelData->road_map;
+  channel_grid_inflow_hook(LogInflow, Parallel);
+
+  printf("Rank %d simulates %ld of the %ld pixels of the basin on a grid "
+	 "of %d by %d pixels\n", Parallel->Rank, Map->NumCells,
+	 Parallel->NCells, Map->NY, Map->NX);
+
+  FreeMap(Owner);
+  FreeMap(Mixed);
+  FreeMap(Keep);
+  free(Box);
+  free(NPixels);
+  free(NMixed);
+}
+
+/*****************************************************************************
+  Function name: AddFlow()
+
+  Purpose      : Add flow from one pixel to a pixel
+
+  Required     :
+    PARALLELSTRUCT *Parallel - Division of the basin over the ranks
+    float *Field             - Value of the receiving pixel
+    int y                    - Y-index of the receiving pixel
+    int x                    - X-index of the receiving pixel
+    int SourceY              - Y-index of the sending pixel
+    int SourceX              - X-index of the sending pixel
+    int Seq                  - Order of the flows from the sending pixel to
+                               the receiving pixel
+    float Value              - Flow
+
+  Returns      : void
+
+  Modifies     : *Field, Parallel->Flow
+
+  Comments     : Flows to mixed pixels are logged and added by
+                 ExchangeFlow() on the rank that owns the pixel.  All other
+                 flows are added right away.
+*****************************************************************************/
+void AddFlow(PARALLELSTRUCT *Parallel, float *Field, int y, int x,
+	     int SourceY, int SourceX, int Seq, float Value)
+{
+  const char *Routine = "AddFlow";
+  FLOWENTRY *Entry;
+
+  if (!Parallel->Active || !Parallel->Mixed[y][x]) {
+    *Field += Value;
+    return;
+  }
+
+  if (Parallel->NFlow == Parallel->MaxFlow) {
+    Parallel->MaxFlow = MAX(2 * Parallel->MaxFlow, 1024);
+    if (!(Parallel->Flow = (FLOWENTRY *) realloc(Parallel->Flow,
+						  Parallel->MaxFlow *
+						  sizeof(FLOWENTRY))))
+      ReportError((char *) Routine, 1);
+  }
+  Entry = &(Parallel->Flow[Parallel->NFlow++]);
+  Entry->Cell = (long) (y + Parallel->OffsetY) * Parallel->NX + x +
+    Parallel->OffsetX;
+  Entry->Source = (long) (SourceY + Parallel->OffsetY) * Parallel->NX +
+    SourceX + Parallel->OffsetX;
+  Entry->Seq = Seq;
+  Entry->Value = Value;
+}
+
+/*****************************************************************************
+  Function name: ExchangeFlow()
+
+  Purpose      : Send the logged flows to the ranks that own the receiving
+                 pixels and add them there
+
+  Required     :
+    PARALLELSTRUCT *Parallel - Division of the basin over the ranks
+    SOILPIX **SoilMap        - Soil moisture
+    size_t Offset            - Offset of the receiving value in SOILPIX,
+                               for example offsetof(SOILPIX, SatFlow)
+
+  Returns      : void
+
+  Modifies     : SoilMap, Parallel->Flow
+
+  Comments     : The flows to a pixel are added in the order of the sending
+                 pixels, as in the serial pixel loop, so the result is the
+                 same as in a serial run.  The receiving value must be zero
+                 before the first flow is added.
+*****************************************************************************/
+void ExchangeFlow(PARALLELSTRUCT *Parallel, SOILPIX **SoilMap, size_t Offset)
+{
+#ifdef HAVE_MPI
+  const char *Routine = "ExchangeFlow";
+  FLOWENTRY *Send;
+  FLOWENTRY *Recv;
+  int *SendCounts;
+  int *SendDispls;
+  int *RecvCounts;
+  int *RecvDispls;
+  int NRecv;
+  int Dest;
+  int i;
+  int y;
+  int x;
+
+  if (!Parallel->Active)
+    return;
+
+  if (!(SendCounts = (int *) calloc(4 * Parallel->NRanks, sizeof(int))))
+    ReportError((char *) Routine, 1);
+  SendDispls = SendCounts + Parallel->NRanks;
+  RecvCounts = SendDispls + Parallel->NRanks;
+  RecvDispls = RecvCounts + Parallel->NRanks;
+  if (!(Send = (FLOWENTRY *) malloc((Parallel->NFlow + 1) *
+				    sizeof(FLOWENTRY))))
+    ReportError((char *) Routine, 1);
+
+  /* sort the flows by the rank that owns the receiving pixel */
+  for (i = 0; i < Parallel->NFlow; i++) {
+    y = Parallel->Flow[i].Cell / Parallel->NX - Parallel->OffsetY;
+    x = Parallel->Flow[i].Cell % Parallel->NX - Parallel->OffsetX;
+    SendCounts[Parallel->Owner[y][x]] += sizeof(FLOWENTRY);
+  }
+  for (i = 1; i < Parallel->NRanks; i++)
+    SendDispls[i] = SendDispls[i - 1] + SendCounts[i - 1];
+  for (i = 0; i < Parallel->NFlow; i++) {
+    y = Parallel->Flow[i].Cell / Parallel->NX - Parallel->OffsetY;
+    x = Parallel->Flow[i].Cell % Parallel->NX - Parallel->OffsetX;
+    Dest = Parallel->Owner[y][x];
+    memcpy((char *) Send + SendDispls[Dest], &(Parallel->Flow[i]),
+	   sizeof(FLOWENTRY));
+    SendDispls[Dest] += sizeof(FLOWENTRY);
+  }
+  for (i = 0; i < Parallel->NRanks; i++)
+    SendDispls[i] -= SendCounts[i];
+
+  MPI_Alltoall(SendCounts, 1, MPI_INT, RecvCounts, 1, MPI_INT,
+	       MPI_COMM_WORLD);
+  for (i = 1; i < Parallel->NRanks; i++)
+    RecvDispls[i] = RecvDispls[i - 1] + RecvCounts[i - 1];
+  NRecv = (RecvDispls[Parallel->NRanks - 1] +
+	   RecvCounts[Parallel->NRanks - 1]) / sizeof(FLOWENTRY);
+  if (!(Recv = (FLOWENTRY *) malloc((NRecv + 1) * sizeof(FLOWENTRY))))
+    ReportError((char *) Routine, 1);
+  MPI_Alltoallv(Send, SendCounts, SendDispls, MPI_BYTE, Recv, RecvCounts,
+		RecvDispls, MPI_BYTE, MPI_COMM_WORLD);
+
+  qsort(Recv, NRecv, sizeof(FLOWENTRY), CompareFlow);
+  for (i = 0; i < NRecv; i++) {
+    y = Recv[i].Cell / Parallel->NX - Parallel->OffsetY;
+    x = Recv[i].Cell % Parallel->NX - Parallel->OffsetX;
+    *((float *) ((char *) &(SoilMap[y][x]) + Offset)) += Recv[i].Value;
+  }
+
+  Parallel->NFlow = 0;
+  free(Send);
+  free(Recv);
+  free(SendCounts);
+#endif
+}
+
+/*****************************************************************************
+  Function name: ExchangeInflow()
+
+  Purpose      : Add the channel and road inflows of all ranks to the
+                 networks
+
+  Required     :
+    PARALLELSTRUCT *Parallel - Division of the basin over the ranks
+
+  Returns      : void
+
+  Modifies     : Lateral inflow of the channel and road segments,
+                 Parallel->Inflow
+
+  Comments     : Called after each pixel loop that adds inflow to the
+                 networks.  Every rank adds the inflows of all pixels in
+                 pixel order, as in the serial pixel loop, so all ranks
+                 route the networks with the same inflows as a serial run.
+                 The channel maps of a rank only cover its own grid, so the
+                 inflows are logged by segment.
+*****************************************************************************/
+void ExchangeInflow(PARALLELSTRUCT *Parallel)
+{
+#ifdef HAVE_MPI
+  const char *Routine = "ExchangeInflow";
+  INFLOWENTRY *Recv;
+  Channel **Table;
+  int *Counts;
+  int *Displs;
+  int Size;
+  int NRecv;
+  int NTable;
+  int i;
+
+  if (!Parallel->Active)
+    return;
+
+  if (!(Counts = (int *) calloc(2 * Parallel->NRanks, sizeof(int))))
+    ReportError((char *) Routine, 1);
+  Displs = Counts + Parallel->NRanks;
+
+  Size = Parallel->NInflow * sizeof(INFLOWENTRY);
+  MPI_Allgather(&Size, 1, MPI_INT, Counts, 1, MPI_INT, MPI_COMM_WORLD);
+  for (i = 1; i < Parallel->NRanks; i++)
+    Displs[i] = Displs[i - 1] + Counts[i - 1];
+  NRecv = (Displs[Parallel->NRanks - 1] + Counts[Parallel->NRanks - 1]) /
+    sizeof(INFLOWENTRY);
+  if (!(Recv = (INFLOWENTRY *) malloc((NRecv + 1) * sizeof(INFLOWENTRY))))
+    ReportError((char *) Routine, 1);
+  MPI_Allgatherv(Parallel->Inflow, Size, MPI_BYTE, Recv, Counts, Displs,
+		 MPI_BYTE, MPI_COMM_WORLD);
+
+  qsort(Recv, NRecv, sizeof(INFLOWENTRY), CompareInflow);
+  for (i = 0; i < NRecv; i++) {
+    Table = Recv[i].Road ? Parallel->Roads : Parallel->Streams;
+    NTable = Recv[i].Road ? Parallel->NRoads : Parallel->NStreams;
+    if (Recv[i].Segment >= 0 && Recv[i].Segment < NTable &&
+	Table[Recv[i].Segment])
+      Table[Recv[i].Segment]->lateral_inflow += Recv[i].Value;
+  }
+
+  Parallel->NInflow = 0;
+  free(Recv);
+  free(Counts);
+#endif
+}
+
+/*****************************************************************************
+  Function name: ExchangeHalo()
+
+  Purpose      : Copy a value of the pixels of the other ranks to the halo
+                 of this rank
+
+  Required     :
+    PARALLELSTRUCT *Parallel - Division of the basin over the ranks
+    SOILPIX **SoilMap        - Soil moisture
+    size_t Offset            - Offset of the float value in SOILPIX, for
+                               example offsetof(SOILPIX, WaterLevel)
+
+  Returns      : void
+
+  Modifies     : SoilMap of the halo
+
+  Comments     : Only the halo pixels next to the pixels of this rank are
+                 copied.  The halo lists are only set up for FLOW GRADIENT =
+                 WATERTABLE, where HeadSlopeAspect() needs the water levels
+                 of the neighbors.
+*****************************************************************************/
+void ExchangeHalo(PARALLELSTRUCT *Parallel, SOILPIX **SoilMap, size_t Offset)
+{
+#ifdef HAVE_MPI
+  const char *Routine = "ExchangeHalo";
+  float *Send;
+  float *Recv;
+  int *SendCounts;
+  int *SendDispls;
+  int *RecvCounts;
+  int *RecvDispls;
+  int NSend;
+  int NRecv;
+  int i;
+
+  if (!Parallel->Active || !Parallel->HaloCounts)
+    return;
+
+  if (!(SendDispls = (int *) calloc(2 * Parallel->NRanks, sizeof(int))))
+    ReportError((char *) Routine, 1);
+  RecvDispls = SendDispls + Parallel->NRanks;
+  SendCounts = Parallel->HaloCounts;
+  RecvCounts = Parallel->HaloCounts + Parallel->NRanks;
+  for (i = 1; i < Parallel->NRanks; i++) {
+    SendDispls[i] = SendDispls[i - 1] + SendCounts[i - 1];
+    RecvDispls[i] = RecvDispls[i - 1] + RecvCounts[i - 1];
+  }
+  NSend = SendDispls[Parallel->NRanks - 1] + SendCounts[Parallel->NRanks - 1];
+  NRecv = RecvDispls[Parallel->NRanks - 1] + RecvCounts[Parallel->NRanks - 1];
+  if (!(Send = (float *) malloc((NSend + NRecv + 1) * sizeof(float))))
+    ReportError((char *) Routine, 1);
+  Recv = Send + NSend;
+
+  for (i = 0; i < NSend; i++)
+    Send[i] = *((float *) ((char *) &(SoilMap[Parallel->HaloSend[i] /
+					       Parallel->NCols]
+				      [Parallel->HaloSend[i] %
+				       Parallel->NCols]) + Offset));
+  MPI_Alltoallv(Send, SendCounts, SendDispls, MPI_FLOAT, Recv, RecvCounts,
+		RecvDispls, MPI_FLOAT, MPI_COMM_WORLD);
+  for (i = 0; i < NRecv; i++)
+    *((float *) ((char *) &(SoilMap[Parallel->HaloRecv[i] / Parallel->NCols]
+			    [Parallel->HaloRecv[i] % Parallel->NCols]) +
+		 Offset)) = Recv[i];
+
+  free(Send);
+  free(SendDispls);
+#endif
+}
+
+/*****************************************************************************
+  Function name: ResetRunon()
+
+  Purpose      : Start the kinematic wave routing of a time step
+
+  Required     :
+    PARALLELSTRUCT *Parallel - Division of the basin over the ranks
+
+  Returns      : void
+
+  Modifies     : Parallel->Runon
+
+  Comments     : The runon starts at zero in each time step, as the runon
+                 matrix of RouteSurface()
+*****************************************************************************/
+void ResetRunon(PARALLELSTRUCT *Parallel)
+{
+  long i;			/* counter */
+  int r;			/* counter */
+
+  if (!Parallel->Active)
+    return;
+
+  for (i = 0; i < Parallel->NRunon; i++) {
+    memset(Parallel->Runon[i].Value, 0, sizeof(Parallel->Runon[i].Value));
+    Parallel->Runon[i].Arrived = 0;
+  }
+  for (r = 0; r < Parallel->NRanks && Parallel->Received; r++)
+    Parallel->Received[r] = 0;
+  Parallel->Step = 0;
+}
+
+/*****************************************************************************
+  Function name: GetRunon()
+
+  Purpose      : Set the runon of a pixel before it is routed in a sub-step
+                 of the kinematic wave routing
+
+  Required     :
+    PARALLELSTRUCT *Parallel - Division of the basin over the ranks
+    float **Runon            - Runon of the pixels (m3/s)
+    int y                    - Y-index of the pixel
+    int x                    - X-index of the pixel
+
+  Returns      : void
+
+  Modifies     : Runon[y][x]
+
+  Comments     : Only changes the pixels with a neighbor of another rank.
+                 Waits for the runon of the neighbors of other ranks that
+                 are routed before the pixel, and adds the runon of the
+                 neighbors in the order of a serial run: first those routed
+                 after the pixel in the previous sub-step, then those routed
+                 before it in this sub-step.
+*****************************************************************************/
+void GetRunon(PARALLELSTRUCT *Parallel, float **Runon, int y, int x)
+{
+#ifdef HAVE_MPI
+  RUNONPIX *Pix;
+  float Sum;			/* Runon of the pixel */
+  int Late;			/* Slot of the previous sub-step */
+  int Now;			/* Slot of this sub-step */
+  int i;			/* counter */
+
+  if (!Parallel->Active || !Parallel->RunonMap ||
+      Parallel->RunonMap[y][x] < 0)
+    return;
+
+  Pix = &(Parallel->Runon[Parallel->RunonMap[y][x]]);
+  if (Pix->Arrived < Pix->NEarly) {
+    FlushRunon(Parallel);
+    while (Pix->Arrived < Pix->NEarly)
+      ReceiveRunon(Parallel);
+  }
+
+  Late = (Parallel->Step + 1) & 1;
+  Now = Parallel->Step & 1;
+  Sum = 0.0;
+  for (i = 0; i < Pix->NSources; i++)
+    Sum = (float) ((double) Sum +
+		   Pix->Value[(i < Pix->NLate) ? Late : Now][i]);
+  Runon[y][x] = Sum;
+#endif
+}
+
+/*****************************************************************************
+  Function name: AddRunon()
+
+  Purpose      : Add the runon of a pixel to a neighbor in the kinematic
+                 wave routing
+
+  Required     :
+    PARALLELSTRUCT *Parallel - Division of the basin over the ranks
+    float **Runon            - Runon of the pixels (m3/s)
+    int yn                   - Y-index of the receiving pixel
+    int xn                   - X-index of the receiving pixel
+    int y                    - Y-index of the sending pixel
+    int x                    - X-index of the sending pixel
+    double Value             - Runon (m3/s)
+
+  Returns      : void
+
+  Modifies     : Runon, Parallel->Runon, Parallel->Pending
+
+  Comments     : In an MPI run the runon to every neighbor is passed on,
+                 also when it is zero, so that the receiving rank knows when
+                 it has all of it.  The runon to the pixels of other ranks
+                 is sent by ExchangeRunon(), or earlier when this rank waits
+                 in GetRunon().
+*****************************************************************************/
+void AddRunon(PARALLELSTRUCT *Parallel, float **Runon, int yn, int xn,
+	      int y, int x, double Value)
+{
+  const char *Routine = "AddRunon";
+  RUNONENTRY *Entry;
+  long Source;			/* Sending pixel in the divided grid */
+  int Dest;			/* Rank of the receiving pixel */
+
+  if (!Parallel->Active ||
+      (Parallel->Owner[yn][xn] == Parallel->Rank &&
+       (!Parallel->RunonMap || Parallel->RunonMap[yn][xn] < 0))) {
+    Runon[yn][xn] += Value;
+    return;
+  }
+
+  Source = (long) (y + Parallel->OffsetY) * Parallel->NX + x +
+    Parallel->OffsetX;
+  Dest = Parallel->Owner[yn][xn];
+  if (Dest == Parallel->Rank) {
+    StoreRunon(&(Parallel->Runon[Parallel->RunonMap[yn][xn]]), Source,
+	       Value, Parallel->Step, FALSE);
+    return;
+  }
+
+  if (Parallel->NPending[Dest] == Parallel->MaxPending[Dest]) {
+    Parallel->MaxPending[Dest] = MAX(2 * Parallel->MaxPending[Dest], 64);
+    if (!(Parallel->Pending[Dest] =
+	  (RUNONENTRY *) realloc(Parallel->Pending[Dest],
+				 Parallel->MaxPending[Dest] *
+				 sizeof(RUNONENTRY))))
+      ReportError((char *) Routine, 1);
+  }
+  Entry = &(Parallel->Pending[Dest][Parallel->NPending[Dest]++]);
+  Entry->Cell = (long) (yn + Parallel->OffsetY) * Parallel->NX + xn +
+    Parallel->OffsetX;
+  Entry->Source = Source;
+  Entry->Value = Value;
+}
+
+/*****************************************************************************
+  Function name: ExchangeRunon()
+
+  Purpose      : End a sub-step of the kinematic wave routing
+
+  Required     :
+    PARALLELSTRUCT *Parallel - Division of the basin over the ranks
+
+  Returns      : void
+
+  Modifies     : Parallel->Runon
+
+  Comments     : Sends the runon that is left and receives the runon of
+                 the pixels of other ranks that were routed after their
+                 neighbors of this rank.  The even and the odd sub-steps
+                 use different tags, so a rank can start the next sub-step
+                 while its neighbors finish this one.
+*****************************************************************************/
+void ExchangeRunon(PARALLELSTRUCT *Parallel)
+{
+#ifdef HAVE_MPI
+  long i;			/* counter */
+  int r;			/* counter */
+
+  if (!Parallel->Active)
+    return;
+
+  FlushRunon(Parallel);
+  for (r = 0; r < Parallel->NRanks; r++)
+    while (Parallel->Received[r] < Parallel->Expected[r])
+      ReceiveRunon(Parallel);
+
+  if (Parallel->NSent > 0)
+    MPI_Waitall(Parallel->NSent, (MPI_Request *) Parallel->Requests,
+		MPI_STATUSES_IGNORE);
+  for (i = 0; i < Parallel->NSent; i++)
+    free(Parallel->Sent[i]);
+  Parallel->NSent = 0;
+
+  for (i = 0; i < Parallel->NRunon; i++)
+    Parallel->Runon[i].Arrived = 0;
+  for (r = 0; r < Parallel->NRanks; r++)
+    Parallel->Received[r] = 0;
+  Parallel->Step++;
+#endif
+}
+
+/*****************************************************************************
+  Function name: SumOverRanks()
+
+  Purpose      : Sum values over all ranks
+
+  Required     :
+    PARALLELSTRUCT *Parallel - Division of the basin over the ranks
+    double *Values           - Values of this rank
+    int N                    - Number of values
+
+  Returns      : void
+
+  Modifies     : Values, the sums over all ranks on return
+*****************************************************************************/
+void SumOverRanks(PARALLELSTRUCT *Parallel, double *Values, int N)
+{
+#ifdef HAVE_MPI
+  if (!Parallel->Active)
+    return;
+
+  MPI_Allreduce(MPI_IN_PLACE, Values, N, MPI_DOUBLE, MPI_SUM,
+		MPI_COMM_WORLD);
+#endif
+}
+
+/*****************************************************************************
+  Function name: MinOverRanks()
+
+  Purpose      : Find the smallest values over all ranks
+
+  Required     :
+    PARALLELSTRUCT *Parallel - Division of the basin over the ranks
+    float *Values            - Values of this rank
+    int N                    - Number of values
+
+  Returns      : void
+
+  Modifies     : Values, the smallest over all ranks on return
+*****************************************************************************/
+void MinOverRanks(PARALLELSTRUCT *Parallel, float *Values, int N)
+{
+#ifdef HAVE_MPI
+  if (!Parallel->Active)
+    return;
+
+  MPI_Allreduce(MPI_IN_PLACE, Values, N, MPI_FLOAT, MPI_MIN,
+		MPI_COMM_WORLD);
+#endif
+}
+
+/*****************************************************************************
+  Function name: ReduceAggregate()
+
+  Purpose      : Sum the basin totals of the pixels of all ranks
+
+  Required     :
+    OPTIONSTRUCT *Options - Program options
+    LAYER *Soil           - Number of soil layers
+    LAYER *Veg            - Number of vegetation layers
+    AGGREGATED *Total     - Sums over the pixels of this rank
+    float LastGlacier     - Glacier total before this time step
+
+  Returns      : void
+
+  Modifies     : Total, the sums over all pixels on return
+
+  Comments     : Called by Aggregate() before the sums are turned into
+                 averages.  Also sums the radiation totals of the column
+                 physics and the culvert totals of RouteChannel().  The
+                 glacier total is kept over the whole run, only its change
+                 in this time step is summed.  The sums are taken in double
+                 precision, but in a different order than in a serial run,
+                 so the basin averages can differ from a serial run in the
+                 last digit.
+*****************************************************************************/
+void ReduceAggregate(OPTIONSTRUCT *Options, LAYER *Soil, LAYER *Veg,
+		     AGGREGATED *Total, float LastGlacier)
+{
+#ifdef HAVE_MPI
+  const char *Routine = "ReduceAggregate";
+  double *Buffer;
+  int N;
+
+  if (!Options->Parallel.Active)
+    return;
+
+  Total->Snow.Glacier -= LastGlacier;
+  N = PackAggregate(NULL, FALSE, Options, Soil, Veg, Total);
+  if (!(Buffer = (double *) calloc(N, sizeof(double))))
+    ReportError((char *) Routine, 1);
+  PackAggregate(Buffer, FALSE, Options, Soil, Veg, Total);
+  SumOverRanks(&(Options->Parallel), Buffer, N);
+  PackAggregate(Buffer, TRUE, Options, Soil, Veg, Total);
+  Total->Snow.Glacier += LastGlacier;
+  free(Buffer);
+#endif
+}
+
+/*****************************************************************************
+  Function name: EndParallel()
+
+  Purpose      : Release the division of the basin and stop MPI at the end
+                 of the run
+
+  Required     :
+    PARALLELSTRUCT *Parallel - Division of the basin over the ranks
+
+  Returns      : void
+
+  Modifies     : Parallel
+
+  Comments     : MPI is only stopped if InitParallel() started it
+*****************************************************************************/
+void EndParallel(PARALLELSTRUCT *Parallel)
+{
+  MAPWINDOW Window;		/* window of the grid in the map files */
+  int r;			/* counter */
+  int y;			/* counter */
+
+  if (Parallel->Owner) {
+    for (y = 0; y < Parallel->NRows; y++) {
+      free(Parallel->Owner[y]);
+      free(Parallel->Mixed[y]);
+    }
+    free(Parallel->Owner);
+    free(Parallel->Mixed);
+  }
+  if (Parallel->RunonMap) {
+    for (y = 0; y < Parallel->NRows; y++)
+      free(Parallel->RunonMap[y]);
+    free(Parallel->RunonMap);
+  }
+  if (Parallel->Pending) {
+    for (r = 0; r < Parallel->NRanks; r++)
+      free(Parallel->Pending[r]);
+    free(Parallel->Pending);
+  }
+  free(Parallel->Flow);
+  free(Parallel->Inflow);
+  free(Parallel->Streams);
+  free(Parallel->Roads);
+  free(Parallel->HaloCounts);
+  free(Parallel->HaloSend);
+  free(Parallel->HaloRecv);
+  free(Parallel->Runon);
+  free(Parallel->Expected);
+  free(Parallel->Received);
+  free(Parallel->NPending);
+  free(Parallel->MaxPending);
+  free(Parallel->Sent);
+  free(Parallel->Requests);
+
+  if (Parallel->Gather) {
+    GetMapWindow(&Window);
+    if (Window.Gather == Parallel->Gather) {
+      Window.Gather = NULL;
+      SetMapWindow(&Window);
+    }
+    free(Parallel->Gather->Owned);
+    free(Parallel->Gather->Counts);
+    free(Parallel->Gather->Cells);
+    free(Parallel->Gather->Entries);
+    free(Parallel->Gather);
+  }
+
+#ifdef HAVE_MPI
+  if (Parallel->Started)
+    MPI_Finalize();
+#endif
+  memset(Parallel, 0, sizeof(PARALLELSTRUCT));
+}
+
+/*****************************************************************************
+  MaxSegmentID()
+*****************************************************************************/
+static int MaxSegmentID(Channel *Head)
+{
+  int MaxID = 0;
+
+  for (; Head; Head = Head->next)
+    if (Head->id > MaxID)
+      MaxID = Head->id;
+  return MaxID;
+}
+
+/*****************************************************************************
+  DivideBasin()
+
+  Returns the rank of each pixel, y * NX + x, -1 outside the basin.  See
+  PartitionBasin().
+*****************************************************************************/
+static int *DivideBasin(PARALLELSTRUCT *Parallel, MAPSIZE *Map,
+			TOPOPIX **TopoMap, CHANNEL *ChannelData)
+{
+  const char *Routine = "PartitionBasin";
+  Channel *Segment;
+  int *Owner;			/* Rank of each pixel, -2 if not known yet */
+  int *CellSegment;		/* Segment index (id + 1) each pixel drains to, 0
+				   if none, -1 if not known yet, -2 while on the
+				   current flow path */
+  long *Path;			/* Pixels on the current flow path, later the
+				   pixels that pass their rank on to their
+				   neighbors */
+  long *Weight;			/* Number of pixels that drain to each
+				   segment */
+  int *FirstChild;		/* First entry in Children for each segment */
+  int *Children;		/* Segments that drain to each segment */
+  int *Order;			/* Segments in post-order */
+  int *Stack;			/* Segments on the current walk */
+  int *Next;			/* Next child to visit for each segment on
+				   the walk */
+  int *SegmentRank;		/* Rank of each segment */
+  int NSegments;		/* Number of segment indices */
+  long NPath;			/* Number of pixels in Path */
+  int NOrder;			/* Number of segments in Order */
+  int NStack;			/* Number of segments on the walk */
+  long Drained;			/* Number of pixels that drain to a segment */
+  long Sum;			/* Pixels of the segments before the current
+				   one */
+  long Cell;			/* Current pixel (y * NX + x) */
+  int Best;			/* Direction with the largest flow fraction */
+  int Seg;			/* Segment index */
+  long i;			/* counter */
+  int k;			/* counter */
+  int n;			/* counter */
+  int x;			/* counter */
+  int y;			/* counter */
+  int xn;			/* x-index of the neighbor */
+  int yn;			/* y-index of the neighbor */
+
+  NSegments = MaxSegmentID(ChannelData->streams) + 2;
+
+  if (!(Owner = (int *) CallocMap(Map->NY, Map->NX, sizeof(int))))
+    ReportError((char *) Routine, 1);
+  if (!(CellSegment = (int *) CallocMap(Map->NY, Map->NX, sizeof(int))))
+    ReportError((char *) Routine, 1);
+  if (!(Path = (long *) CallocMap(Map->NY, Map->NX, sizeof(long))))
+    ReportError((char *) Routine, 1);
+  if (!(Weight = (long *) calloc(NSegments, sizeof(long))))
+    ReportError((char *) Routine, 1);
+  if (!(FirstChild = (int *) calloc(NSegments + 1, sizeof(int))))
+    ReportError((char *) Routine, 1);
+  if (!(Children = (int *) calloc(NSegments, sizeof(int))))
+    ReportError((char *) Routine, 1);
+  if (!(Order = (int *) calloc(NSegments, sizeof(int))))
+    ReportError((char *) Routine, 1);
+  if (!(Stack = (int *) calloc(NSegments, sizeof(int))))
+    ReportError((char *) Routine, 1);
+  if (!(Next = (int *) calloc(NSegments, sizeof(int))))
+    ReportError((char *) Routine, 1);
+  if (!(SegmentRank = (int *) calloc(NSegments, sizeof(int))))
+    ReportError((char *) Routine, 1);
+
+  /* segment each pixel drains to.  Follow the main flow direction down to
+     a pixel whose segment is known, and assign that segment to all pixels
+     on the way */
+  for (i = 0; i < (long) Map->NY * Map->NX; i++)
+    CellSegment[i] = -1;
+  for (y = 0; y < Map->NY; y++) {
+    for (x = 0; x < Map->NX; x++) {
+      if (!INBASIN(TopoMap[y][x].Mask))
+	continue;
+      NPath = 0;
+      Cell = (long) y * Map->NX + x;
+      while (CellSegment[Cell] == -1) {
+	yn = Cell / Map->NX;
+	xn = Cell % Map->NX;
+	if (channel_grid_has_channel(ChannelData->stream_map, xn, yn)) {
+	  CellSegment[Cell] =
+	    ChannelData->stream_map[xn][yn]->channel->id + 1;
+	  break;
+	}
+	CellSegment[Cell] = -2;
+	Path[NPath++] = Cell;
+	Best = -1;
+	for (n = 0; n < NDIRS; n++) {
+	  if (valid_cell(Map, xn + xdirection[n], yn + ydirection[n]) &&
+	      INBASIN(TopoMap[yn + ydirection[n]][xn + xdirection[n]].Mask) &&
+	      TopoMap[yn][xn].Dir[n] > 0 &&
+	      (Best < 0 || TopoMap[yn][xn].Dir[n] > TopoMap[yn][xn].Dir[Best]))
+	    Best = n;
+	}
+	if (Best < 0)
+	  break;
+	Cell = (yn + ydirection[Best]) * Map->NX + xn + xdirection[Best];
+      }
+      /* a pit, or a loop in the flow directions, drains to no segment */
+      Seg = (CellSegment[Cell] >= 0) ? CellSegment[Cell] : 0;
+      for (i = 0; i < NPath; i++)
+	CellSegment[Path[i]] = Seg;
+      Weight[Seg]++;
+    }
+  }
+
+  /* the segments upstream of each segment */
+  for (Segment = ChannelData->streams; Segment; Segment = Segment->next) {
+    if (Segment->outlet)
+      FirstChild[Segment->outlet->id + 1]++;
+  }
+  for (i = 1; i <= NSegments; i++)
+    FirstChild[i] += FirstChild[i - 1];
+  for (Segment = ChannelData->streams; Segment; Segment = Segment->next) {
+    if (Segment->outlet)
+      Children[--FirstChild[Segment->outlet->id + 1]] = Segment->id + 1;
+  }
+
+  /* post-order walk from each outlet */
+  NOrder = 0;
+  for (Segment = ChannelData->streams; Segment; Segment = Segment->next) {
+    if (Segment->outlet)
+      continue;
+    NStack = 0;
+    Stack[NStack] = Segment->id + 1;
+    Next[NStack++] = FirstChild[Segment->id + 1];
+    while (NStack > 0) {
+      Seg = Stack[NStack - 1];
+      if (Next[NStack - 1] < FirstChild[Seg + 1]) {
+	k = Children[Next[NStack - 1]++];
+	Stack[NStack] = k;
+	Next[NStack++] = FirstChild[k];
+      }
+      else {
+	Order[NOrder++] = Seg;
+	NStack--;
+      }
+    }
+  }
+
+  /* cut the walk into pieces with about the same number of pixels */
+  Drained = 0;
+  for (i = 1; i < NSegments; i++)
+    Drained += Weight[i];
+  Drained = MAX(Drained, 1);
+  Sum = 0;
+  for (i = 0; i < NOrder; i++) {
+    Seg = Order[i];
+    k = (int) ((Sum + 0.5 * Weight[Seg]) * Parallel->NRanks / Drained);
+    SegmentRank[Seg] = MIN(k, Parallel->NRanks - 1);
+    Sum += Weight[Seg];
+  }
+
+  /* the pixels that do not drain to a segment get the rank of a neighbor,
+     spreading out from the pixels that do, so that they do not widen the
+     grid of a rank across the basin */
+  NPath = 0;
+  for (Cell = 0; Cell < (long) Map->NY * Map->NX; Cell++) {
+    if (!INBASIN(TopoMap[Cell / Map->NX][Cell % Map->NX].Mask))
+      Owner[Cell] = -1;
+    else if (CellSegment[Cell] == 0)
+      Owner[Cell] = -2;
+    else {
+      Owner[Cell] = SegmentRank[CellSegment[Cell]];
+      Path[NPath++] = Cell;
+    }
+  }
+  for (i = 0; i < NPath; i++) {
+    y = Path[i] / Map->NX;
+    x = Path[i] % Map->NX;
+    for (n = 0; n < NDIRS; n++) {
+      yn = y + ydirection[n];
+      xn = x + xdirection[n];
+      Cell = (long) yn * Map->NX + xn;
+      if (valid_cell(Map, xn, yn) && Owner[Cell] == -2) {
+	Owner[Cell] = Owner[Path[i]];
+	Path[NPath++] = Cell;
+      }
+    }
+  }
+  for (Cell = 0; Cell < (long) Map->NY * Map->NX; Cell++)
+    if (Owner[Cell] == -2)
+      Owner[Cell] = Parallel->NRanks - 1;
+
+  FreeMap(CellSegment);
+  FreeMap(Path);
+  free(Weight);
+  free(FirstChild);
+  free(Children);
+  free(Order);
+  free(Stack);
+  free(Next);
+  free(SegmentRank);
+
+  return Owner;
+}
+
+/*****************************************************************************
+  FindBoxes()
+
+  Finds the grid of each rank, the bounding box of its pixels and of their
+  halo, see PartitionBasin(), and marks the pixels of this rank and of its
+  halo in Keep.
+*****************************************************************************/
+static void FindBoxes(PARALLELSTRUCT *Parallel, MAPSIZE *Map,
+		      TOPOPIX **TopoMap, int *Owner, int *Box, uchar *Keep)
+{
+  int *B;			/* grid of the rank of a pixel */
+  int n;			/* counter */
+  int r;			/* counter */
+  int x;			/* counter */
+  int y;			/* counter */
+  int xn;			/* x-index of a pixel of the grid */
+  int yn;			/* y-index of a pixel of the grid */
+
+  for (r = 0; r < Parallel->NRanks; r++) {
+    Box[4 * r] = Map->NY;
+    Box[4 * r + 1] = Map->NX;
+    Box[4 * r + 2] = -1;
+    Box[4 * r + 3] = -1;
+  }
+
+  /* the pixel, its neighbors and the pixel its impervious area drains
+     to */
+  for (y = 0; y < Map->NY; y++) {
+    for (x = 0; x < Map->NX; x++) {
+      if (!INBASIN(TopoMap[y][x].Mask))
+	continue;
+      r = Owner[(long) y * Map->NX + x];
+      B = &(Box[4 * r]);
+      for (n = -1; n <= NNEIGHBORS; n++) {
+	if (n < 0) {
+	  yn = y;
+	  xn = x;
+	}
+	else if (n < NNEIGHBORS) {
+	  yn = y + yneighbor[n];
+	  xn = x + xneighbor[n];
+	  if (!valid_cell(Map, xn, yn) || !INBASIN(TopoMap[yn][xn].Mask))
+	    continue;
+	}
+	else {
+	  yn = TopoMap[y][x].drains_y;
+	  xn = TopoMap[y][x].drains_x;
+	  if (!valid_cell(Map, xn, yn) || !INBASIN(TopoMap[yn][xn].Mask))
+	    continue;
+	}
+	B[0] = MIN(B[0], yn);
+	B[1] = MIN(B[1], xn);
+	B[2] = MAX(B[2], yn);
+	B[3] = MAX(B[3], xn);
+	if (r == Parallel->Rank)
+	  Keep[(long) yn * Map->NX + xn] = TRUE;
+      }
+    }
+  }
+}
+
+/*****************************************************************************
+  WidenBox()
+
+  Widens the grid Box of a rank by a column, or else by a row, if it has the
+  size of the grid Other.
+*****************************************************************************/
+static void WidenBox(MAPSIZE *Map, int *Box, MAPSIZE *Other)
+{
+  if (Box[2] - Box[0] + 1 != Other->NY || Box[3] - Box[1] + 1 != Other->NX)
+    return;
+
+  if (Box[3] < Map->NX - 1)
+    Box[3]++;
+  else if (Box[1] > 0)
+    Box[1]--;
+  else if (Box[2] < Map->NY - 1)
+    Box[2]++;
+  else if (Box[0] > 0)
+    Box[0]--;
+}
+
+/*****************************************************************************
+  InitRunon()
+
+  Sets up the pixels of this rank with a neighbor of another rank for the
+  kinematic wave routing, see AddRunon().  RouteSurface() routes the pixels
+  from the end of Map->OrderedCells, which is the same on all ranks before
+  it is cut to the pixels of each rank.
+*****************************************************************************/
+static void InitRunon(PARALLELSTRUCT *Parallel, MAPSIZE *Map,
+		      TOPOPIX **TopoMap, int *Owner)
+{
+  const char *Routine = "PartitionBasin";
+  RUNONPIX *Pix;
+  long *Position;		/* Position of each pixel in the routing order,
+				   larger positions are routed first */
+  long Key[NDIRS];		/* Order in which the runon is added */
+  long Swap;
+  long Cell;			/* Pixel (y * NX + x) */
+  long Source;			/* Neighbor */
+  long i;			/* counter */
+  int Pass;			/* counter */
+  int j;			/* counter */
+  int n;			/* counter */
+  int x;			/* counter */
+  int y;			/* counter */
+  int xn;			/* x-index of the neighbor */
+  int yn;			/* y-index of the neighbor */
+
+  if (!(Position = (long *) CallocMap(Map->NY, Map->NX, sizeof(long))))
+    ReportError((char *) Routine, 1);
+  for (i = 0; i < Map->NumCells; i++)
+    Position[(long) Map->OrderedCells[i].y * Map->NX +
+	     Map->OrderedCells[i].x] = i;
+
+  if (!(Parallel->Expected = (int *) calloc(Parallel->NRanks, sizeof(int))))
+    ReportError((char *) Routine, 1);
+  if (!(Parallel->Received = (int *) calloc(Parallel->NRanks, sizeof(int))))
+    ReportError((char *) Routine, 1);
+  if (!(Parallel->NPending = (int *) calloc(Parallel->NRanks, sizeof(int))))
+    ReportError((char *) Routine, 1);
+  if (!(Parallel->MaxPending = (int *) calloc(Parallel->NRanks,
+					       sizeof(int))))
+    ReportError((char *) Routine, 1);
+  if (!(Parallel->Pending = (RUNONENTRY **) calloc(Parallel->NRanks,
+						    sizeof(RUNONENTRY *))))
+    ReportError((char *) Routine, 1);
+
+  /* the pixels of this rank with a neighbor of another rank, in cell order.
+     Counted in the first pass, set up in the second */
+  for (Pass = 0; Pass < 2; Pass++) {
+    for (i = 0, Cell = 0; Cell < (long) Map->NY * Map->NX; Cell++) {
+      if (Owner[Cell] != Parallel->Rank)
+	continue;
+      y = Cell / Map->NX;
+      x = Cell % Map->NX;
+      for (n = 0; n < NDIRS; n++) {
+	yn = y + ydirection[n];
+	xn = x + xdirection[n];
+	if (valid_cell(Map, xn, yn) && INBASIN(TopoMap[yn][xn].Mask) &&
+	    Owner[(long) yn * Map->NX + xn] != Parallel->Rank)
+	  break;
+      }
+      if (n == NDIRS)
+	continue;
+      if (Pass == 0) {
+	i++;
+	continue;
+      }
+
+      /* the neighbors routed after the pixel come first, as their runon
+	 of the previous sub-step is already in the runon of the pixel, then
+	 the neighbors routed before it, each in routing order */
+      Pix = &(Parallel->Runon[i++]);
+      Pix->Cell = Cell;
+      for (n = 0; n < NDIRS; n++) {
+	yn = y + ydirection[n];
+	xn = x + xdirection[n];
+	if (!valid_cell(Map, xn, yn) || !INBASIN(TopoMap[yn][xn].Mask))
+	  continue;
+	Source = (long) yn * Map->NX + xn;
+	if (Position[Source] < Position[Cell]) {
+	  Pix->NLate++;
+	  Key[Pix->NSources] = Map->NumCells - Position[Source];
+	}
+	else {
+	  if (Owner[Source] != Parallel->Rank)
+	    Pix->NEarly++;
+	  Key[Pix->NSources] = 2 * Map->NumCells - Position[Source];
+	}
+	if (Owner[Source] != Parallel->Rank)
+	  Parallel->Expected[Owner[Source]]++;
+	Pix->Source[Pix->NSources++] = Source;
+      }
+      for (n = 1; n < Pix->NSources; n++) {
+	for (j = n; j > 0 && Key[j] < Key[j - 1]; j--) {
+	  Swap = Key[j];
+	  Key[j] = Key[j - 1];
+	  Key[j - 1] = Swap;
+	  Swap = Pix->Source[j];
+	  Pix->Source[j] = Pix->Source[j - 1];
+	  Pix->Source[j - 1] = Swap;
+	}
+      }
+    }
+    if (Pass == 0) {
+      Parallel->NRunon = i;
+      if (!(Parallel->Runon = (RUNONPIX *) calloc(i + 1, sizeof(RUNONPIX))))
+	ReportError((char *) Routine, 1);
+    }
+  }
+
+  FreeMap(Position);
+}
+
+/*****************************************************************************
+  InitHalo()
+
+  Lists the pixels of this rank that ExchangeHalo() sends to each rank, and
+  the pixels of the halo that it receives from each rank.  Both ranks of a
+  pair list their pixels in cell order, as y * NCols + x in the grid Box of
+  this rank.
+*****************************************************************************/
+static void InitHalo(PARALLELSTRUCT *Parallel, MAPSIZE *Map,
+		     TOPOPIX **TopoMap, int *Owner, int *Box)
+{
+  const char *Routine = "PartitionBasin";
+  int *Counts;			/* Pixels sent to and received from each rank */
+  int *Displs;			/* Next entry of each rank in the lists */
+  int Ranks[NNEIGHBORS];	/* Other ranks among the neighbors */
+  long Cell;			/* Pixel (y * NX + x) */
+  long Local;			/* Pixel in the grid of this rank */
+  int NNear;			/* Number of ranks in Ranks */
+  int Pass;			/* counter */
+  int Rank;			/* Rank of a neighbor */
+  int m;			/* counter */
+  int n;			/* counter */
+  int r;			/* counter */
+  int x;			/* counter */
+  int y;			/* counter */
+  int xn;			/* x-index of the neighbor */
+  int yn;			/* y-index of the neighbor */
+
+  if (!(Parallel->HaloCounts = (int *) calloc(2 * Parallel->NRanks,
+					       sizeof(int))))
+    ReportError((char *) Routine, 1);
+  if (!(Displs = (int *) calloc(2 * Parallel->NRanks, sizeof(int))))
+    ReportError((char *) Routine, 1);
+  Counts = Parallel->HaloCounts;
+
+  /* a pixel of this rank is sent to the other ranks among its neighbors, a
+     pixel of another rank is received if it has a neighbor of this rank */
+  for (Pass = 0; Pass < 2; Pass++) {
+    for (Cell = 0; Cell < (long) Map->NY * Map->NX; Cell++) {
+      if (Owner[Cell] < 0)
+	continue;
+      y = Cell / Map->NX;
+      x = Cell % Map->NX;
+      NNear = 0;
+      for (n = 0; n < NNEIGHBORS; n++) {
+	yn = y + yneighbor[n];
+	xn = x + xneighbor[n];
+	if (!valid_cell(Map, xn, yn) || !INBASIN(TopoMap[yn][xn].Mask))
+	  continue;
+	Rank = Owner[(long) yn * Map->NX + xn];
+	if (Rank == Owner[Cell] ||
+	    (Owner[Cell] != Parallel->Rank && Rank != Parallel->Rank))
+	  continue;
+	for (m = 0; m < NNear && Ranks[m] != Rank; m++) ;
+	if (m == NNear)
+	  Ranks[NNear++] = Rank;
+      }
+      if (NNear == 0)
+	continue;
+      Local = (long) (y - Box[0]) * Parallel->NCols + x - Box[1];
+      if (Owner[Cell] == Parallel->Rank) {
+	for (m = 0; m < NNear; m++) {
+	  if (Pass == 0)
+	    Counts[Ranks[m]]++;
+	  else
+	    Parallel->HaloSend[Displs[Ranks[m]]++] = Local;
+	}
+      }
+      else {
+	r = Parallel->NRanks + Owner[Cell];
+	if (Pass == 0)
+	  Counts[r]++;
+	else
+	  Parallel->HaloRecv[Displs[r]++] = Local;
+      }
+    }
+    if (Pass == 0) {
+      for (r = 1; r < Parallel->NRanks; r++) {
+	Displs[r] = Displs[r - 1] + Counts[r - 1];
+	Displs[Parallel->NRanks + r] = Displs[Parallel->NRanks + r - 1] +
+	  Counts[Parallel->NRanks + r - 1];
+      }
+      r = Parallel->NRanks - 1;
+      if (!(Parallel->HaloSend = (long *) malloc((Displs[r] + Counts[r] + 1)
+						 * sizeof(long))))
+	ReportError((char *) Routine, 1);
+      r = 2 * Parallel->NRanks - 1;
+      if (!(Parallel->HaloRecv = (long *) malloc((Displs[r] + Counts[r] + 1)
+						 * sizeof(long))))
+	ReportError((char *) Routine, 1);
+    }
+  }
+
+  free(Displs);
+}
+
+/*****************************************************************************
+  InitGather()
+
+  Sets up the output maps of the pixels of all ranks, see GatherWindow() in
+  FileIOBin.c.  Rank 0 keeps the cells of the map files of all pixels, in
+  file order.
+*****************************************************************************/
+static void InitGather(PARALLELSTRUCT *Parallel, MAPSIZE *Map)
+{
+#ifdef HAVE_MPI
+  const char *Routine = "PartitionBasin";
+  MAPWINDOW Window;		/* window of the grid in the map files */
+  MAPGATHER *Gather;
+  long *Cells;			/* Cells of the files of this rank */
+  long *Pairs;			/* Cell of the files and entry of the pixels
+				   of all ranks */
+  long i;			/* counter */
+  int NOwned;			/* Number of pixels of this rank */
+  int r;			/* counter */
+  int x;			/* counter */
+  int y;			/* counter */
+
+  GetMapWindow(&Window);
+  if (!(Gather = (MAPGATHER *) calloc(1, sizeof(MAPGATHER))))
+    ReportError((char *) Routine, 1);
+  Gather->Rank = Parallel->Rank;
+
+  for (y = 0; y < Map->NY; y++)
+    for (x = 0; x < Map->NX; x++)
+      if (Parallel->Owner[y][x] == Parallel->Rank)
+	Gather->NOwned++;
+  if (!(Gather->Owned = (long *) malloc((Gather->NOwned + 1) *
+					sizeof(long))))
+    ReportError((char *) Routine, 1);
+  if (!(Cells = (long *) malloc((Gather->NOwned + 1) * sizeof(long))))
+    ReportError((char *) Routine, 1);
+  for (i = 0, y = 0; y < Map->NY; y++) {
+    for (x = 0; x < Map->NX; x++) {
+      if (Parallel->Owner[y][x] == Parallel->Rank) {
+	Gather->Owned[i] = (long) y * Map->NX + x;
+	Cells[i++] = (long) (y + Window.OffsetY) * Window.NX + x +
+	  Window.OffsetX;
+      }
+    }
+  }
+
+  if (Parallel->Rank == 0) {
+    if (!(Gather->Counts = (int *) calloc(2 * Parallel->NRanks,
+					  sizeof(int))))
+      ReportError((char *) Routine, 1);
+    Gather->Displs = Gather->Counts + Parallel->NRanks;
+  }
+  NOwned = (int) Gather->NOwned;
+  MPI_Gather(&NOwned, 1, MPI_INT, Gather->Counts, 1, MPI_INT, 0,
+	     MPI_COMM_WORLD);
+  if (Parallel->Rank == 0) {
+    for (r = 1; r < Parallel->NRanks; r++)
+      Gather->Displs[r] = Gather->Displs[r - 1] + Gather->Counts[r - 1];
+    Gather->NCells = Gather->Displs[Parallel->NRanks - 1] +
+      Gather->Counts[Parallel->NRanks - 1];
+    if (!(Gather->Cells = (long *) malloc((Gather->NCells + 1) *
+					  sizeof(long))))
+      ReportError((char *) Routine, 1);
+    if (!(Gather->Entries = (long *) malloc((Gather->NCells + 1) *
+					    sizeof(long))))
+      ReportError((char *) Routine, 1);
+  }
+  MPI_Gatherv(Cells, NOwned, MPI_LONG, Gather->Cells, Gather->Counts,
+	      Gather->Displs, MPI_LONG, 0, MPI_COMM_WORLD);
+
+  if (Parallel->Rank == 0) {
+    if (!(Pairs = (long *) malloc(2 * (Gather->NCells + 1) * sizeof(long))))
+      ReportError((char *) Routine, 1);
+    for (i = 0; i < Gather->NCells; i++) {
+      Pairs[2 * i] = Gather->Cells[i];
+      Pairs[2 * i + 1] = i;
+    }
+    qsort(Pairs, Gather->NCells, 2 * sizeof(long), ComparePair);
+    for (i = 0; i < Gather->NCells; i++) {
+      Gather->Cells[i] = Pairs[2 * i];
+      Gather->Entries[i] = Pairs[2 * i + 1];
+    }
+    free(Pairs);
+  }
+  free(Cells);
+
+  Window.Gather = Gather;
+  SetMapWindow(&Window);
+  Parallel->Gather = Gather;
+#endif
+}
+
+/*****************************************************************************
+  SegmentTable()
+
+  Returns the segments of a network by id, NULL for the ids that are not in
+  the network, with the number of entries in N.
+*****************************************************************************/
+static Channel **SegmentTable(Channel *Head, int *N)
+{
+  Channel **Table;
+  Channel *Segment;
+
+  *N = MaxSegmentID(Head) + 1;
+  if (!(Table = (Channel **) calloc(*N, sizeof(Channel *))))
+    ReportError("PartitionBasin", 1);
+  for (Segment = Head; Segment; Segment = Segment->next)
+    Table[Segment->id] = Segment;
+
+  return Table;
+}
+
+/*****************************************************************************
+  StoreRunon()
+
+  Keeps the runon of the neighbor Source of a pixel in the slot of the
+  sub-step Step.  Remote is TRUE if the neighbor belongs to another rank.
+*****************************************************************************/
+static void StoreRunon(RUNONPIX *Pix, long Source, double Value, int Step,
+		       int Remote)
+{
+  int i;			/* counter */
+
+  for (i = 0; i < Pix->NSources && Pix->Source[i] != Source; i++) ;
+  if (i == Pix->NSources)
+    return;
+  Pix->Value[Step & 1][i] = Value;
+  if (Remote && i >= Pix->NLate)
+    Pix->Arrived++;
+}
+
+/*****************************************************************************
+  LogInflow()
+
+  Inflow hook of the channel grid, see channel_grid_inflow_hook().  Logs
+  the inflow in the PARALLELSTRUCT Arg, divided over the segments in the
+  cell as channel_grid_inc_inflow() does, and ExchangeInflow() adds it to
+  the networks.
+*****************************************************************************/
+static void LogInflow(ChannelMapPtr **Map, int Col, int Row, float Mass,
+		      void *Arg)
+{
+  const char *Routine = "LogInflow";
+  PARALLELSTRUCT *Parallel = (PARALLELSTRUCT *) Arg;
+  ChannelMapPtr Cell;
+  INFLOWENTRY *Entry;
+  float Len;			/* Length of the segments in the cell */
+  int Seq;			/* Order of the inflow */
+  int Sub;			/* counter */
+
+  Len = channel_grid_cell_length(Map, Col, Row);
+  Seq = Parallel->NInflow;
+  for (Cell = Map[Col][Row], Sub = 0; Cell; Cell = Cell->next, Sub++) {
+    if (Parallel->NInflow == Parallel->MaxInflow) {
+      Parallel->MaxInflow = MAX(2 * Parallel->MaxInflow, 1024);
+      if (!(Parallel->Inflow = (INFLOWENTRY *) realloc(Parallel->Inflow,
+							Parallel->MaxInflow *
+							sizeof(INFLOWENTRY))))
+	ReportError((char *) Routine, 1);
+    }
+    Entry = &(Parallel->Inflow[Parallel->NInflow++]);
+    Entry->Cell = (long) (Row + Parallel->OffsetY) * Parallel->NX + Col +
+      Parallel->OffsetX;
+    Entry->Seq = Seq;
+    Entry->Sub = Sub;
+    Entry->Road = (Map == Parallel->RoadMap);
+    Entry->Segment = Cell->channel->id;
+    Entry->Value = Mass * Cell->length / Len;
+  }
+}
+
+#ifdef HAVE_MPI
+/*****************************************************************************
+  FlushRunon()
+
+  Sends the runon logged for the pixels of other ranks.  The buffers are
+  kept until ExchangeRunon() has waited for the messages.
+*****************************************************************************/
+static void FlushRunon(PARALLELSTRUCT *Parallel)
+{
+  const char *Routine = "FlushRunon";
+  int r;			/* counter */
+
+  for (r = 0; r < Parallel->NRanks; r++) {
+    if (Parallel->NPending[r] == 0)
+      continue;
+    if (Parallel->NSent == Parallel->MaxSent) {
+      Parallel->MaxSent = MAX(2 * Parallel->MaxSent, 16);
+      if (!(Parallel->Sent = (RUNONENTRY **) realloc(Parallel->Sent,
+						      Parallel->MaxSent *
+						      sizeof(RUNONENTRY *))))
+	ReportError((char *) Routine, 1);
+      if (!(Parallel->Requests = realloc(Parallel->Requests,
+					 Parallel->MaxSent *
+					 sizeof(MPI_Request))))
+	ReportError((char *) Routine, 1);
+    }
+    Parallel->Sent[Parallel->NSent] = Parallel->Pending[r];
+    MPI_Isend(Parallel->Pending[r],
+	      Parallel->NPending[r] * (int) sizeof(RUNONENTRY), MPI_BYTE, r,
+	      RUNONTAG + (Parallel->Step & 1), MPI_COMM_WORLD,
+	      &(((MPI_Request *) Parallel->Requests)[Parallel->NSent]));
+    Parallel->NSent++;
+    Parallel->Pending[r] = NULL;
+    Parallel->NPending[r] = 0;
+    Parallel->MaxPending[r] = 0;
+  }
+}
+
+/*****************************************************************************
+  ReceiveRunon()
+
+  Waits for a runon message of this sub-step from any rank and keeps its
+  runon.
+*****************************************************************************/
+static void ReceiveRunon(PARALLELSTRUCT *Parallel)
+{
+  const char *Routine = "ReceiveRunon";
+  MPI_Status Status;
+  RUNONENTRY *Recv;
+  int Size;			/* Bytes in the message */
+  int N;			/* Entries in the message */
+  int i;			/* counter */
+  int x;
+  int y;
+
+  MPI_Probe(MPI_ANY_SOURCE, RUNONTAG + (Parallel->Step & 1), MPI_COMM_WORLD,
+	    &Status);
+  MPI_Get_count(&Status, MPI_BYTE, &Size);
+  if (!(Recv = (RUNONENTRY *) malloc(Size + 1)))
+    ReportError((char *) Routine, 1);
+  MPI_Recv(Recv, Size, MPI_BYTE, Status.MPI_SOURCE, Status.MPI_TAG,
+	   MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+
+  N = Size / sizeof(RUNONENTRY);
+  for (i = 0; i < N; i++) {
+    y = Recv[i].Cell / Parallel->NX - Parallel->OffsetY;
+    x = Recv[i].Cell % Parallel->NX - Parallel->OffsetX;
+    StoreRunon(&(Parallel->Runon[Parallel->RunonMap[y][x]]), Recv[i].Source,
+	       Recv[i].Value, Parallel->Step, TRUE);
+  }
+  Parallel->Received[Status.MPI_SOURCE] += N;
+  free(Recv);
+}
+
+/*****************************************************************************
+  CompareFlow()
+
+  Orders flows by receiving pixel, then in the order of the serial pixel
+  loop.
+*****************************************************************************/
+static int CompareFlow(const void *A, const void *B)
+{
+  const FLOWENTRY *a = (const FLOWENTRY *) A;
+  const FLOWENTRY *b = (const FLOWENTRY *) B;
+
+  if (a->Cell != b->Cell)
+    return (a->Cell < b->Cell) ? -1 : 1;
+  if (a->Source != b->Source)
+    return (a->Source < b->Source) ? -1 : 1;
+  if (a->Seq != b->Seq)
+    return (a->Seq < b->Seq) ? -1 : 1;
+  return 0;
+}
+
+/*****************************************************************************
+  CompareInflow()
+
+  Orders inflows by pixel, then in the order in which they were added, then
+  in the order of the segments in the pixel.
+*****************************************************************************/
+static int CompareInflow(const void *A, const void *B)
+{
+  const INFLOWENTRY *a = (const INFLOWENTRY *) A;
+  const INFLOWENTRY *b = (const INFLOWENTRY *) B;
+
+  if (a->Cell != b->Cell)
+    return (a->Cell < b->Cell) ? -1 : 1;
+  if (a->Seq != b->Seq)
+    return (a->Seq < b->Seq) ? -1 : 1;
+  if (a->Sub != b->Sub)
+    return (a->Sub < b->Sub) ? -1 : 1;
+  return 0;
+}
+
+/*****************************************************************************
+  ComparePair()
+
+  Orders pairs of longs by the first one.
+*****************************************************************************/
+static int ComparePair(const void *A, const void *B)
+{
+  const long *a = (const long *) A;
+  const long *b = (const long *) B;
+
+  if (a[0] != b[0])
+    return (a[0] < b[0]) ? -1 : 1;
+  return 0;
+}
+
+/*****************************************************************************
+  PackAggregate()
+
+  Copies the basin totals that are summed over the pixels between Total and
+  Buffer, into Total if Unpack is TRUE.  Only counts the values if Buffer
+  is NULL.  Returns the number of values.
+*****************************************************************************/
+#define PACK(Value) \
+  { if (Buffer) { if (Unpack) (Value) = Buffer[N]; \
+                  else Buffer[N] = (Value); } \
+    N++; }
+
+static int PackAggregate(double *Buffer, int Unpack, OPTIONSTRUCT *Options,
+			 LAYER *Soil, LAYER *Veg, AGGREGATED *Total)
+{
+  int N = 0;
+  int i;
+  int j;
+
+  PACK(Total->Evap.ETot);
+  for (i = 0; i < Veg->MaxLayers + 1; i++) {
+    PACK(Total->Evap.EPot[i]);
+    PACK(Total->Evap.EAct[i]);
+  }
+  for (i = 0; i < Veg->MaxLayers; i++) {
+    PACK(Total->Evap.EInt[i]);
+    for (j = 0; j < Soil->MaxLayers; j++)
+      PACK(Total->Evap.ESoil[i][j]);
+  }
+  PACK(Total->Evap.EvapSoil);
+
+  PACK(Total->Precip.Precip);
+  for (i = 0; i < Veg->MaxLayers; i++) {
+    PACK(Total->Precip.IntRain[i]);
+    PACK(Total->Precip.IntSnow[i]);
+  }
+  PACK(Total->CanopyWater);
+
+  for (i = 0; i < 2; i++) {
+    PACK(Total->Rad.NetShort[i]);
+    PACK(Total->Rad.LongIn[i]);
+    PACK(Total->Rad.LongOut[i]);
+  }
+  PACK(Total->Rad.PixelNetShort);
+  PACK(Total->Rad.PixelLongIn);
+  PACK(Total->Rad.PixelLongOut);
+  if (Options->MM5 == FALSE) {
+    PACK(Total->RadClass.Beam);
+    PACK(Total->RadClass.Diffuse);
+  }
+
+  PACK(Total->Snow.HasSnow);
+  PACK(Total->Snow.Swq);
+  PACK(Total->Snow.Glacier);
+  PACK(Total->Snow.Melt);
+  PACK(Total->Snow.PackWater);
+  PACK(Total->Snow.TPack);
+  PACK(Total->Snow.SurfWater);
+  PACK(Total->Snow.TSurf);
+  PACK(Total->Snow.ColdContent);
+  PACK(Total->Snow.Albedo);
+  PACK(Total->Snow.Depth);
+  PACK(Total->Snow.VaporMassFlux);
+  PACK(Total->Snow.CanopyVaporMassFlux);
+
+  for (i = 0; i < Soil->MaxLayers; i++) {
+    PACK(Total->Soil.Moist[i]);
+    PACK(Total->Soil.Perc[i]);
+    PACK(Total->Soil.Temp[i]);
+  }
+  PACK(Total->Soil.Moist[Soil->MaxLayers]);
+  PACK(Total->Soil.TableDepth);
+  PACK(Total->Soil.WaterLevel);
+  PACK(Total->Soil.SatFlow);
+  PACK(Total->Soil.TSurf);
+  PACK(Total->Soil.Qnet);
+  PACK(Total->Soil.Qs);
+  PACK(Total->Soil.Qe);
+  PACK(Total->Soil.Qg);
+  PACK(Total->Soil.Qst);
+  PACK(Total->Soil.IExcess);
+  PACK(Total->Soil.DetentionStorage);
+  if (Options->Infiltration == DYNAMIC)
+    PACK(Total->Soil.InfiltAcc);
+  PACK(Total->SoilWater);
+  PACK(Total->Saturated);
+  PACK(Total->Runoff);
+  PACK(Total->ChannelInt);
+  PACK(Total->RoadInt);
+  PACK(Total->CulvertReturnFlow);
+  PACK(Total->CulvertToChannel);
+  PACK(Total->RunoffToChannel);
+
+  /* a pixel of any rank has snow */
+  if (Buffer && Unpack)
+    Total->Snow.HasSnow = (Total->Snow.HasSnow > 0) ? TRUE : FALSE;
+
+  return N;
+}
+
+#undef PACK
+#endif
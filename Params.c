@@ -0,0 +1,200 @@
+/*
+ * SUMMARY:      Params.c - Per-pixel parameter maps
+ * USAGE:        Part of DHSVM
+ *
+ * AUTHOR:       DHSVM development team
+ * ORG:          University of Washington, Department of Civil Engineering
+ * E-MAIL:
+ * ORIG-DATE:    Oct-2026
+ * DESCRIPTION:  Copy the soil and vegetation parameters of the routing from
+ *               the type tables into per-pixel arrays, see params.h
+ * DESCRIP-END.
+ * FUNCTIONS:    InitParamMap()
+ *               ParamLayers()
+ *               FreeParamMap()
+ * COMMENTS:
+ * $Id: Params.c,v 1.0 2026/10/17 Exp $
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "settings.h"
+#include "constants.h"
+#include "data.h"
+#include "compact.h"
+#include "DHSVMerror.h"
+#include "memtrack.h"
+#include "params.h"
+
+static void *AllocateParam(long NElem, size_t Size, int Subsystem);
+
+/*****************************************************************************
+  Function name: InitParamMap()
+
+  Purpose      : Build the per-pixel parameter maps
+
+  Required     :
+    PARAMMAP *Params    - Parameter maps
+    MAPSIZE *Map        - Size and location of model area
+    TOPOPIX **TopoMap   - Basin mask and slope
+    SOILPIX **SoilMap   - Soil type of each pixel
+    VEGPIX **VegMap     - Vegetation type of each pixel
+    SOILTABLE *SType    - Soil parameters
+    VEGTABLE *VType     - Vegetation parameters
+    LAYER *Soil         - Number of soil layers of each soil type
+    LAYER *Veg          - Number of vegetation layers of each type
+
+  Returns      : void
+
+  Modifies     : Params
+
+  Comments     : Pixels outside the basin are left at zero.  Alpha is
+                 computed the way RouteSurface() does, with a slope of
+                 0.0001 for flat pixels
+*****************************************************************************/
+void InitParamMap(PARAMMAP *Params, MAPSIZE *Map, TOPOPIX **TopoMap,
+		  SOILPIX **SoilMap, VEGPIX **VegMap, SOILTABLE *SType,
+		  VEGTABLE *VType, LAYER *Soil, LAYER *Veg)
+{
+  SOILTABLE *ST;		/* Soil type of the pixel */
+  VEGTABLE *VT;			/* Vegetation type of the pixel */
+  long NCells = (long) Map->NY * Map->NX;
+  long i;			/* index of the pixel */
+  long l;			/* index of the first layer of the pixel */
+  int k;			/* layer counter */
+  int x;			/* counter */
+  int y;			/* counter */
+  double slope;			/* Manning's slope */
+  double beta = 3. / 5.;	/* Kinematic wave exponent */
+
+  Params->NX = Map->NX;
+  Params->MaxLayers = ParamLayers(Soil, Veg, VType);
+
+  Params->KsLat = AllocateParam(NCells, sizeof(float), MEM_SOIL);
+  Params->KsLatExp = AllocateParam(NCells, sizeof(float), MEM_SOIL);
+  Params->DepthThresh = AllocateParam(NCells, sizeof(float), MEM_SOIL);
+  Params->Porosity = AllocateParam(NCells * Params->MaxLayers, sizeof(float),
+				   MEM_SOIL);
+  Params->FCap = AllocateParam(NCells * Params->MaxLayers, sizeof(float),
+			       MEM_SOIL);
+  Params->Alpha = AllocateParam(NCells, sizeof(double), MEM_SOIL);
+  Params->NSoilLayers = AllocateParam(NCells, sizeof(int), MEM_VEGETATION);
+  Params->RootDepth = AllocateParam(NCells * Params->MaxLayers, sizeof(float),
+				    MEM_VEGETATION);
+  Params->ImpervFrac = AllocateParam(NCells, sizeof(float), MEM_VEGETATION);
+  Params->DetentionFrac = AllocateParam(NCells, sizeof(float),
+					MEM_VEGETATION);
+  Params->DetentionDecay = AllocateParam(NCells, sizeof(float),
+					 MEM_VEGETATION);
+
+  for (y = 0; y < Map->NY; y++) {
+    for (x = 0; x < Map->NX; x++) {
+      if (!INBASIN(TopoMap[y][x].Mask))
+	continue;
+      i = PARAMINDEX(Params, y, x);
+      l = i * Params->MaxLayers;
+      ST = &(SType[SoilMap[y][x].Soil - 1]);
+      VT = &(VType[VegMap[y][x].Veg - 1]);
+
+      Params->KsLat[i] = ST->KsLat;
+      Params->KsLatExp[i] = ST->KsLatExp;
+      Params->DepthThresh[i] = ST->DepthThresh;
+      for (k = 0; k < ST->NLayers; k++) {
+	Params->Porosity[l + k] = ST->Porosity[k];
+	Params->FCap[l + k] = ST->FCap[k];
+      }
+
+      slope = TOPOSLOPE(TopoMap[y][x]);
+      if (slope == 0)
+	slope = 0.0001;
+      Params->Alpha[i] =
+	pow(ST->Manning * pow((double) Map->DX, 2. / 3.) / sqrt(slope), beta);
+
+      Params->NSoilLayers[i] = VT->NSoilLayers;
+      for (k = 0; k < VT->NSoilLayers; k++)
+	Params->RootDepth[l + k] = VT->RootDepth[k];
+      Params->ImpervFrac[i] = VT->ImpervFrac;
+      Params->DetentionFrac[i] = VT->DetentionFrac;
+      Params->DetentionDecay[i] = VT->DetentionDecay;
+    }
+  }
+
+  Params->Active = TRUE;
+  printf("Built the parameter maps, %d layers per pixel\n",
+	 Params->MaxLayers);
+}
+
+/*****************************************************************************
+  Function name: ParamLayers()
+
+  Purpose      : Number of layered values per pixel in the parameter maps
+
+  Required     :
+    LAYER *Soil      - Number of soil layers of each soil type
+    LAYER *Veg       - Number of vegetation types
+    VEGTABLE *VType  - Number of root zones of each vegetation type
+
+  Returns      : int - the largest number of soil layers or root zones
+
+  Modifies     : void
+
+  Comments     : Also used by PredictMemory()
+*****************************************************************************/
+int ParamLayers(LAYER *Soil, LAYER *Veg, VEGTABLE *VType)
+{
+  int MaxLayers = Soil->MaxLayers;
+  int i;			/* counter */
+
+  for (i = 0; i < Veg->NTypes; i++)
+    if (VType[i].NSoilLayers > MaxLayers)
+      MaxLayers = VType[i].NSoilLayers;
+
+  return MaxLayers;
+}
+
+/*****************************************************************************
+  Function name: FreeParamMap()
+
+  Purpose      : Free the parameter maps
+
+  Required     :
+    PARAMMAP *Params - Parameter maps
+
+  Returns      : void
+
+  Modifies     : Params
+
+  Comments     :
+*****************************************************************************/
+void FreeParamMap(PARAMMAP *Params)
+{
+  free(Params->KsLat);
+  free(Params->KsLatExp);
+  free(Params->DepthThresh);
+  free(Params->Porosity);
+  free(Params->FCap);
+  free(Params->Alpha);
+  free(Params->NSoilLayers);
+  free(Params->RootDepth);
+  free(Params->ImpervFrac);
+  free(Params->DetentionFrac);
+  free(Params->DetentionDecay);
+  memset(Params, 0, sizeof(PARAMMAP));
+}
+
+/*****************************************************************************
+  AllocateParam()
+
+  One zeroed parameter map, recorded as "ParamMap"
+*****************************************************************************/
+static void *AllocateParam(long NElem, size_t Size, int Subsystem)
+{
+  void *Array;
+
+  if (!(Array = TrackedCalloc((size_t) NElem, Size, Subsystem, "ParamMap")))
+    ReportError("InitParamMap", 1);
+
+  return Array;
+}
@@ -0,0 +1,760 @@
+/*
+ * SUMMARY:      Placement.c - Placement of the model maps in memory
+ * USAGE:        Part of DHSVM
+ *
+ * AUTHOR:       DHSVM development team
+ * ORG:          University of Washington, Department of Civil Engineering
+ * E-MAIL:
+ * ORIG-DATE:    Oct-2026
+ * DESCRIPTION:  Move the maps of the model state and the layer arrays of
+ *               their pixels into blocks of fresh pages that are first
+ *               touched by the threads of the tiles, and report where the
+ *               pages ended up, see placement.h
+ * DESCRIP-END.
+ * FUNCTIONS:    PlaceMap()
+ *               PlaceLayers()
+ *               ReportPlacement()
+ *               FreePlacedLayers()
+ *               FreePlacement()
+ * COMMENTS:     The huge pages and the page queries use Linux system calls.
+ *               Elsewhere the maps are moved with normal pages and their
+ *               nodes are reported as not known.
+ * $Id: Placement.c,v 1.0 2026/10/17 Exp $
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+#include "settings.h"
+#include "constants.h"
+#include "data.h"
+#include "DHSVMerror.h"
+#include "memtrack.h"
+#include "tiles.h"
+#include "placement.h"
+
+#define MB (1024. * 1024.)
+#define MAXNODES 64		/* Most NUMA nodes reported */
+#define QUERYPAGES 1024		/* Pages per query of their nodes */
+#define DEFAULTHUGEPAGE (2 * 1024 * 1024)	/* Huge page size if
+						   /proc/meminfo has none */
+
+#if !defined(MAP_ANONYMOUS) && defined(MAP_ANON)
+#define MAP_ANONYMOUS MAP_ANON
+#endif
+
+typedef struct {
+  PLACEDMAP *Placed;		/* Map being moved */
+  size_t Size;			/* Size of a pixel */
+  int NX;			/* Columns of the map */
+  int NY;			/* Rows of the map */
+  int TileSize;			/* Edge of the tiles */
+  int NTileX;			/* Number of tile columns */
+  char *Copied;			/* TRUE for each tile position that is done */
+} COPYARG;
+
+typedef struct {
+  PLACEDMAP *Placed;		/* Layer field being moved */
+  TILESTRUCT *Tiles;		/* Tiles of the threaded pixel loop */
+  size_t *Offset;		/* Offset in the block of the arrays of each
+				   pixel, NOLAYERS if the pixel has none */
+  LAYERCOUNT Count;		/* Number of layers of a pixel */
+  void *Arg;			/* Argument of Count */
+} LAYERARG;
+
+#define NOLAYERS ((size_t) -1)
+
+static void AllocateBlock(PLACEDMAP *Placed, size_t Length, int HugePages);
+static void **LayerField(PLACEDMAP *Placed, int y, int x);
+static size_t LayerBytes(PLACEDMAP *Placed, int N, int NArrays);
+static void CopyLayerTile(void *Arg, TILE *Tile, int Thread);
+static void CopyLayers(LAYERARG *Copy, int y, int x, int Node);
+static void CopyTile(void *Arg, TILE *Tile, int Thread);
+static void CopyRect(COPYARG *Copy, int Row, int Col, int NRows, int NCols,
+		     int Node);
+static int CurrentNode(void);
+static size_t HugePageSize(void);
+static int QueryNodes(PLACEDMAP *Placed, double *Count, double *Local,
+		      double *Copied);
+static double TransparentHugeBytes(void);
+
+/*****************************************************************************
+  Function name: PlaceMap()
+
+  Purpose      : Move a map of the model state into a block of fresh pages
+
+  Required     :
+    PLACEMENT *Place  - Maps that are placed
+    TILESTRUCT *Tiles - Tiles of the threaded pixel loop, NThreads is 0 if
+                        the pixel loop is not threaded
+    MAPSIZE *Map      - Size of the model area
+    void **Rows       - Row pointers of the map, NULL if the map is not used
+    size_t Size       - Size of a pixel of the map
+    const char *Name  - Name of the map in the report
+    int FirstTouch    - TRUE if the tiles are copied by their threads
+    int HugePages     - Kind of pages asked for, see settings.h
+
+  Returns      : void
+
+  Modifies     : Place, Rows and the pages of the map
+
+  Comments     : The old rows are freed.  The pixels outside the tiles
+                 (outside the basin or owned by another rank) are copied by
+                 the calling thread.
+*****************************************************************************/
+void PlaceMap(PLACEMENT *Place, TILESTRUCT *Tiles, MAPSIZE *Map,
+	      void **Rows, size_t Size, const char *Name, int FirstTouch,
+	      int HugePages)
+{
+  const char *Routine = "PlaceMap";
+  PLACEDMAP *Placed;
+  COPYARG Copy;
+  size_t NPages;		/* Pages of the block */
+  int Node;			/* Node of the calling thread */
+  int NTileY;			/* Number of tile rows */
+  int tx;			/* tile column */
+  int ty;			/* tile row */
+  int y;			/* counter */
+
+  if (!Rows || Place->NMaps == MAXPLACED)
+    return;
+
+  Placed = &(Place->Map[Place->NMaps]);
+  memset(Placed, 0, sizeof(PLACEDMAP));
+  Placed->Name = Name;
+  Placed->Rows = Rows;
+  Placed->NY = Map->NY;
+  Placed->NX = Map->NX;
+  AllocateBlock(Placed, (size_t) Map->NY * Map->NX * Size, HugePages);
+
+  NPages = Placed->Bytes / Placed->PageSize;
+  if (!(Placed->Node = (signed char *) malloc(NPages)))
+    ReportError((char *) Routine, 1);
+  memset(Placed->Node, -1, NPages);
+
+  Copy.Placed = Placed;
+  Copy.Size = Size;
+  Copy.NX = Map->NX;
+  Copy.NY = Map->NY;
+  Node = CurrentNode();
+
+  if (FirstTouch && Tiles->NThreads > 1) {
+    Copy.TileSize = Tiles->Size;
+    Copy.NTileX = (Map->NX + Tiles->Size - 1) / Tiles->Size;
+    NTileY = (Map->NY + Tiles->Size - 1) / Tiles->Size;
+    if (!(Copy.Copied = (char *) calloc(Copy.NTileX * NTileY, 1)))
+      ReportError((char *) Routine, 1);
+
+    RunTiles(Tiles, CopyTile, &Copy);
+
+    for (ty = 0; ty < NTileY; ty++)
+      for (tx = 0; tx < Copy.NTileX; tx++)
+	if (!Copy.Copied[ty * Copy.NTileX + tx])
+	  CopyRect(&Copy, ty * Tiles->Size, tx * Tiles->Size, Tiles->Size,
+		   Tiles->Size, Node);
+    free(Copy.Copied);
+    Place->NThreads = Tiles->NThreads;
+  }
+  else {
+    CopyRect(&Copy, 0, 0, Map->NY, Map->NX, Node);
+    Place->NThreads = 1;
+  }
+
+  for (y = 0; y < Map->NY; y++) {
+    free(Rows[y]);
+    Rows[y] = Placed->Block + (size_t) y * Map->NX * Size;
+  }
+  Place->NMaps++;
+}
+
+/*****************************************************************************
+  Function name: PlaceLayers()
+
+  Purpose      : Move the layer arrays of a pointer field of the pixels of a
+                 map into a block of fresh pages
+
+  Required     :
+    PLACEMENT *Place  - Maps that are placed
+    TILESTRUCT *Tiles - Tiles of the threaded pixel loop, NThreads is 0 if
+                        the pixel loop is not threaded
+    MAPSIZE *Map      - Size of the model area
+    void **Rows       - Row pointers of the map, NULL if the map is not used
+    size_t Size       - Size of a pixel of the map
+    size_t Field      - Offset of the field in a pixel (offsetof())
+    int Indirect      - TRUE if the field points to an array of pointers to
+                        the layer arrays (float **), FALSE if it points to
+                        the layers (float *)
+    LAYERCOUNT Count  - Number of layers of each array of a pixel
+    void *Arg         - Argument of Count
+    const char *Name  - Name of the field in the report
+    int FirstTouch    - TRUE if the arrays of a tile are copied by the thread
+                        of the tile
+    int HugePages     - Kind of pages asked for, see settings.h
+
+  Returns      : void
+
+  Modifies     : Place, the field of each pixel and the pages of the arrays
+
+  Comments     : The arrays of the active pixels of a tile are next to each
+                 other, tile by tile, followed by those of the pixels that
+                 are in no tile, which are copied by the calling thread.
+                 With Indirect the pointers of a pixel come first, followed
+                 by its arrays.  Pixels without arrays (a NULL field) are
+                 skipped.  The old arrays are freed.
+*****************************************************************************/
+void PlaceLayers(PLACEMENT *Place, TILESTRUCT *Tiles, MAPSIZE *Map,
+		 void **Rows, size_t Size, size_t Field, int Indirect,
+		 LAYERCOUNT Count, void *Arg, const char *Name,
+		 int FirstTouch, int HugePages)
+{
+  const char *Routine = "PlaceLayers";
+  PLACEDMAP *Placed;
+  LAYERARG Copy;
+  size_t Length;		/* Length of the arrays */
+  size_t NPages;		/* Pages of the block */
+  int Threaded;			/* TRUE if the tiles copy their arrays */
+  int NArrays;			/* Arrays of a pixel */
+  int N;			/* Layers of each array of a pixel */
+  int Node;			/* Node of the calling thread */
+  long i;			/* counter */
+  int x;			/* counter */
+  int y;			/* counter */
+
+  if (!Rows || Place->NMaps == MAXPLACED)
+    return;
+
+  Placed = &(Place->Map[Place->NMaps]);
+  memset(Placed, 0, sizeof(PLACEDMAP));
+  Placed->Name = Name;
+  Placed->Rows = Rows;
+  Placed->NY = Map->NY;
+  Placed->NX = Map->NX;
+  Placed->Layers = TRUE;
+  Placed->Indirect = Indirect;
+  Placed->Size = Size;
+  Placed->Field = Field;
+
+  if (!(Copy.Offset = (size_t *) CallocMap(Map->NY, Map->NX,
+					    sizeof(size_t))))
+    ReportError((char *) Routine, 1);
+  for (i = 0; i < (long) Map->NY * Map->NX; i++)
+    Copy.Offset[i] = NOLAYERS;
+
+  /* the arrays of the tiles first, in the order of their active pixels,
+     then the arrays of the pixels in no tile */
+  Threaded = FirstTouch && Tiles->NThreads > 1;
+  Length = 0;
+  for (i = 0; Threaded && i < Tiles->NCells; i++) {
+    y = Tiles->Cells[i].N;
+    x = Tiles->Cells[i].E;
+    if (*LayerField(Placed, y, x)) {
+      Copy.Offset[(size_t) y * Map->NX + x] = Length;
+      N = Count(Arg, y, x, &NArrays);
+      Length += LayerBytes(Placed, N, NArrays);
+    }
+  }
+  for (y = 0; y < Map->NY; y++)
+    for (x = 0; x < Map->NX; x++)
+      if (*LayerField(Placed, y, x) &&
+	  Copy.Offset[(size_t) y * Map->NX + x] == NOLAYERS) {
+	Copy.Offset[(size_t) y * Map->NX + x] = Length;
+	N = Count(Arg, y, x, &NArrays);
+	Length += LayerBytes(Placed, N, NArrays);
+      }
+
+  if (Length == 0) {
+    FreeMap(Copy.Offset);
+    return;
+  }
+
+  AllocateBlock(Placed, Length, HugePages);
+  NPages = Placed->Bytes / Placed->PageSize;
+  if (!(Placed->Node = (signed char *) malloc(NPages)))
+    ReportError((char *) Routine, 1);
+  memset(Placed->Node, -1, NPages);
+
+  Copy.Placed = Placed;
+  Copy.Tiles = Tiles;
+  Copy.Count = Count;
+  Copy.Arg = Arg;
+  Node = CurrentNode();
+
+  if (Threaded) {
+    RunTiles(Tiles, CopyLayerTile, &Copy);
+    Place->NThreads = Tiles->NThreads;
+  }
+  else
+    Place->NThreads = 1;
+
+  /* the pixels in no tile still point to their old arrays */
+  for (y = 0; y < Map->NY; y++)
+    for (x = 0; x < Map->NX; x++)
+      if (Copy.Offset[(size_t) y * Map->NX + x] != NOLAYERS &&
+	  (char *) *LayerField(Placed, y, x) !=
+	  Placed->Block + Copy.Offset[(size_t) y * Map->NX + x])
+	CopyLayers(&Copy, y, x, Node);
+
+  FreeMap(Copy.Offset);
+  Place->NMaps++;
+}
+
+/*****************************************************************************
+  Function name: ReportPlacement()
+
+  Purpose      : Print the page sizes and the nodes of the placed maps
+
+  Required     :
+    FILE *OutFile    - File to print to
+    PLACEMENT *Place - Maps that are placed
+
+  Returns      : void
+
+  Modifies     : void
+
+  Comments     : Local is the part of the pages with a known copying
+                 thread that is on the node of that thread.  With huge
+                 pages a page holds the tiles of several threads and is
+                 placed by the first one that gets to it, so Local is
+                 lower.
+*****************************************************************************/
+void ReportPlacement(FILE *OutFile, PLACEMENT *Place)
+{
+  const char *PageName[] = { "small", "transparent", "explicit" };
+  PLACEDMAP *Placed;
+  double Count[MAXNODES];	/* Pages on each node */
+  double Local;			/* Pages on the node of their thread */
+  double Copied;		/* Pages with a known copying thread */
+  double Total;			/* Pages found */
+  char Nodes[BUFSIZE + 1];	/* Pages per node */
+  int i;			/* counter */
+  int n;			/* node counter */
+
+  if (Place->NMaps == 0)
+    return;
+
+  fprintf(OutFile, "\nPlacement of the model maps, copied by %d thread%s\n",
+	  Place->NThreads, Place->NThreads > 1 ? "s" : "");
+  fprintf(OutFile, "%-18s %10s %-12s %10s %8s  %s\n", "Map", "MB", "Pages",
+	  "Page kB", "Local %", "Pages per node");
+  for (i = 0; i < Place->NMaps; i++) {
+    Placed = &(Place->Map[i]);
+    if (QueryNodes(Placed, Count, &Local, &Copied)) {
+      for (n = 0, Total = 0.; n < MAXNODES; n++)
+	Total += Count[n];
+      Nodes[0] = '\0';
+      for (n = 0; n < MAXNODES; n++)
+	if (Count[n] > 0. && strlen(Nodes) < BUFSIZE - 32)
+	  sprintf(Nodes + strlen(Nodes), "%snode %d %.0f%%",
+		  Nodes[0] ? ", " : "", n, 100. * Count[n] / Total);
+      fprintf(OutFile, "%-18s %10.2f %-12s %10.0f %8.1f  %s\n", Placed->Name,
+	      Placed->Bytes / MB, PageName[Placed->Pages],
+	      Placed->PageSize / 1024.,
+	      Copied > 0. ? 100. * Local / Copied : 0., Nodes);
+    }
+    else
+      fprintf(OutFile, "%-18s %10.2f %-12s %10.0f %8s  %s\n", Placed->Name,
+	      Placed->Bytes / MB, PageName[Placed->Pages],
+	      Placed->PageSize / 1024., "-", "not known");
+  }
+
+  for (i = 0; i < Place->NMaps; i++)
+    if (Place->Map[i].Pages == HUGEPAGES_TRANSPARENT) {
+      fprintf(OutFile, "Transparent huge pages of the process: %.2f MB\n",
+	      TransparentHugeBytes() / MB);
+      break;
+    }
+}
+
+/*****************************************************************************
+  Function name: FreePlacedLayers()
+
+  Purpose      : Release the blocks of the placed layer arrays
+
+  Required     :
+    PLACEMENT *Place - Maps that are placed
+
+  Returns      : void
+
+  Modifies     : Place, the placed fields of the pixels are set to NULL
+
+  Comments     : Called before the layer arrays that were not placed are
+                 freed, while the rows of the maps are still there
+*****************************************************************************/
+void FreePlacedLayers(PLACEMENT *Place)
+{
+  PLACEDMAP *Placed;
+  void **Field;			/* Field of a pixel */
+  int i;			/* counter */
+  int x;			/* counter */
+  int y;			/* counter */
+
+  for (i = 0; i < Place->NMaps; i++) {
+    Placed = &(Place->Map[i]);
+    if (!Placed->Layers || !Placed->Block)
+      continue;
+    for (y = 0; y < Placed->NY; y++)
+      for (x = 0; x < Placed->NX; x++) {
+	Field = LayerField(Placed, y, x);
+	if ((char *) *Field >= Placed->Block &&
+	    (char *) *Field < Placed->Block + Placed->Bytes)
+	  *Field = NULL;
+      }
+    munmap(Placed->Block, Placed->Bytes);
+    free(Placed->Node);
+    Placed->Block = NULL;
+    Placed->Node = NULL;
+  }
+}
+
+/*****************************************************************************
+  Function name: FreePlacement()
+
+  Purpose      : Release the blocks of the placed maps
+
+  Required     :
+    PLACEMENT *Place - Maps that are placed
+
+  Returns      : void
+
+  Modifies     : Place, the row pointers of the maps are set to NULL
+
+  Comments     : Called before the row pointers themselves are freed.  The
+                 layer arrays are released first if FreePlacedLayers() has
+                 not been called
+*****************************************************************************/
+void FreePlacement(PLACEMENT *Place)
+{
+  PLACEDMAP *Placed;
+  int i;			/* counter */
+  int y;			/* counter */
+
+  FreePlacedLayers(Place);
+  for (i = 0; i < Place->NMaps; i++) {
+    Placed = &(Place->Map[i]);
+    if (Placed->Layers)
+      continue;
+    for (y = 0; y < Placed->NY; y++)
+      Placed->Rows[y] = NULL;
+    munmap(Placed->Block, Placed->Bytes);
+    free(Placed->Node);
+  }
+  memset(Place, 0, sizeof(PLACEMENT));
+}
+
+/*****************************************************************************
+  AllocateBlock()
+
+  Map Length bytes of fresh pages.  Explicit huge pages that are not
+  available fall back to transparent huge pages; the blocks for transparent
+  huge pages are aligned to the huge page size
+*****************************************************************************/
+static void AllocateBlock(PLACEDMAP *Placed, size_t Length, int HugePages)
+{
+  const char *Routine = "PlaceMap";
+  size_t Huge;			/* Huge page size */
+  size_t Head;			/* Bytes before the aligned block */
+  char *Start;			/* Start of the mapping */
+
+  Huge = HugePageSize();
+  Placed->PageSize = (size_t) sysconf(_SC_PAGESIZE);
+  Placed->Pages = HUGEPAGES_NONE;
+
+#ifdef MAP_HUGETLB
+  if (HugePages == HUGEPAGES_EXPLICIT) {
+    Placed->Bytes = (Length + Huge - 1) / Huge * Huge;
+    Start = (char *) mmap(NULL, Placed->Bytes, PROT_READ | PROT_WRITE,
+			  MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (Start != MAP_FAILED) {
+      Placed->Block = Start;
+      Placed->PageSize = Huge;
+      Placed->Pages = HUGEPAGES_EXPLICIT;
+      return;
+    }
+    printf("No explicit huge pages for %s, using transparent huge pages\n",
+	   Placed->Name);
+  }
+#endif
+
+  if (HugePages == HUGEPAGES_NONE) {
+    Placed->Bytes = (Length + Placed->PageSize - 1) / Placed->PageSize *
+      Placed->PageSize;
+    Start = (char *) mmap(NULL, Placed->Bytes, PROT_READ | PROT_WRITE,
+			  MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (Start == MAP_FAILED)
+      ReportError((char *) Routine, 1);
+    Placed->Block = Start;
+    return;
+  }
+
+  /* map one huge page more and trim the ends to align the block */
+  Placed->Bytes = (Length + Huge - 1) / Huge * Huge;
+  Start = (char *) mmap(NULL, Placed->Bytes + Huge, PROT_READ | PROT_WRITE,
+			MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (Start == MAP_FAILED)
+    ReportError((char *) Routine, 1);
+  Head = (Huge - (size_t) Start % Huge) % Huge;
+  if (Head > 0)
+    munmap(Start, Head);
+  munmap(Start + Head + Placed->Bytes, Huge - Head);
+  Placed->Block = Start + Head;
+
+#ifdef MADV_HUGEPAGE
+  if (madvise(Placed->Block, Placed->Bytes, MADV_HUGEPAGE) == 0)
+    Placed->Pages = HUGEPAGES_TRANSPARENT;
+#endif
+  if (Placed->Pages != HUGEPAGES_TRANSPARENT)
+    printf("No transparent huge pages for %s, using small pages\n",
+	   Placed->Name);
+}
+
+/*****************************************************************************
+  CopyTile()
+
+  Tile function of RunTiles(): copy the whole square of the tile, including
+  the pixels that are not active
+*****************************************************************************/
+static void CopyTile(void *Arg, TILE *Tile, int Thread)
+{
+  COPYARG *Copy = (COPYARG *) Arg;
+
+  CopyRect(Copy, Tile->Row, Tile->Col, Copy->TileSize, Copy->TileSize,
+	   CurrentNode());
+  Copy->Copied[(Tile->Row / Copy->TileSize) * Copy->NTileX +
+	       Tile->Col / Copy->TileSize] = TRUE;
+}
+
+/*****************************************************************************
+  CopyRect()
+
+  Copy a rectangle of pixels from the old rows into the block, and note
+  Node as the node of the pages whose first byte is copied
+*****************************************************************************/
+static void CopyRect(COPYARG *Copy, int Row, int Col, int NRows, int NCols,
+		     int Node)
+{
+  PLACEDMAP *Placed = Copy->Placed;
+  size_t Start;			/* First byte of a row of the rectangle */
+  size_t Length;		/* Bytes of a row of the rectangle */
+  size_t p;			/* page counter */
+  int y;			/* counter */
+
+  NRows = MIN(NRows, Copy->NY - Row);
+  NCols = MIN(NCols, Copy->NX - Col);
+  Length = (size_t) NCols * Copy->Size;
+
+  for (y = Row; y < Row + NRows; y++) {
+    Start = ((size_t) y * Copy->NX + Col) * Copy->Size;
+    memcpy(Placed->Block + Start, (char *) Placed->Rows[y] + Col * Copy->Size,
+	   Length);
+    for (p = (Start + Placed->PageSize - 1) / Placed->PageSize;
+	 p * Placed->PageSize < Start + Length; p++)
+      Placed->Node[p] = (signed char) Node;
+  }
+}
+
+/*****************************************************************************
+  LayerField()
+
+  Address of the placed field in the pixel at row y, column x
+*****************************************************************************/
+static void **LayerField(PLACEDMAP *Placed, int y, int x)
+{
+  return (void **) ((char *) Placed->Rows[y] + (size_t) x * Placed->Size +
+		    Placed->Field);
+}
+
+/*****************************************************************************
+  LayerBytes()
+
+  Bytes taken in the block by the arrays of a pixel.  With Indirect the
+  pointers come first and the arrays are padded, so that the pointers of
+  the next pixel are aligned
+*****************************************************************************/
+static size_t LayerBytes(PLACEDMAP *Placed, int N, int NArrays)
+{
+  size_t Bytes;			/* Bytes of the arrays */
+
+  if (!Placed->Indirect)
+    return (size_t) N * sizeof(float);
+  Bytes = (size_t) NArrays * N * sizeof(float);
+  Bytes = (Bytes + sizeof(float *) - 1) / sizeof(float *) * sizeof(float *);
+  return NArrays * sizeof(float *) + Bytes;
+}
+
+/*****************************************************************************
+  CopyLayerTile()
+
+  Tile function of RunTiles(): copy the arrays of the active pixels of the
+  tile
+*****************************************************************************/
+static void CopyLayerTile(void *Arg, TILE *Tile, int Thread)
+{
+  LAYERARG *Copy = (LAYERARG *) Arg;
+  COORD *Cell;			/* Active pixel */
+  int Node;			/* Node of this thread */
+  long i;			/* counter */
+
+  Node = CurrentNode();
+  for (i = Tile->First; i < Tile->First + Tile->NCells; i++) {
+    Cell = &(Copy->Tiles->Cells[i]);
+    if (Copy->Offset[(size_t) Cell->N * Copy->Placed->NX + Cell->E] != NOLAYERS)
+      CopyLayers(Copy, Cell->N, Cell->E, Node);
+  }
+}
+
+/*****************************************************************************
+  CopyLayers()
+
+  Copy the arrays of the pixel at row y, column x into the block, point
+  the field of the pixel to them, free the old arrays, and note Node as the
+  node of the pages whose first byte is copied
+*****************************************************************************/
+static void CopyLayers(LAYERARG *Copy, int y, int x, int Node)
+{
+  PLACEDMAP *Placed = Copy->Placed;
+  void **Field;			/* Field of the pixel */
+  float **Old;			/* Old arrays with Indirect */
+  float **New;			/* New pointers with Indirect */
+  float *Data;			/* New arrays */
+  size_t Start;			/* Offset of the arrays in the block */
+  size_t Length;		/* Bytes of the arrays */
+  size_t p;			/* page counter */
+  int NArrays;			/* Arrays of the pixel */
+  int N;			/* Layers of each array */
+  int i;			/* counter */
+
+  Field = LayerField(Placed, y, x);
+  Start = Copy->Offset[(size_t) y * Placed->NX + x];
+  N = Copy->Count(Copy->Arg, y, x, &NArrays);
+  Length = LayerBytes(Placed, N, NArrays);
+
+  if (Placed->Indirect) {
+    Old = (float **) *Field;
+    New = (float **) (Placed->Block + Start);
+    Data = (float *) (Placed->Block + Start + NArrays * sizeof(float *));
+    for (i = 0; i < NArrays; i++) {
+      memcpy(Data + (size_t) i * N, Old[i], N * sizeof(float));
+      New[i] = Data + (size_t) i * N;
+      free(Old[i]);
+    }
+    free(Old);
+  }
+  else {
+    memcpy(Placed->Block + Start, *Field, Length);
+    free(*Field);
+  }
+  *Field = Placed->Block + Start;
+
+  for (p = (Start + Placed->PageSize - 1) / Placed->PageSize;
+       p * Placed->PageSize < Start + Length; p++)
+    Placed->Node[p] = (signed char) Node;
+}
+
+/*****************************************************************************
+  CurrentNode()
+
+  NUMA node of the calling thread, -1 if not known
+*****************************************************************************/
+static int CurrentNode(void)
+{
+#if defined(__linux__) && defined(SYS_getcpu)
+  unsigned int Cpu;
+  unsigned int Node;
+
+  if (syscall(SYS_getcpu, &Cpu, &Node, NULL) == 0 && Node < MAXNODES)
+    return (int) Node;
+#endif
+  return -1;
+}
+
+/*****************************************************************************
+  HugePageSize()
+
+  Size of the huge pages from /proc/meminfo
+*****************************************************************************/
+static size_t HugePageSize(void)
+{
+  FILE *MemInfo;		/* /proc/meminfo */
+  char Line[BUFSIZE + 1];	/* Line of /proc/meminfo */
+  long KBytes = 0;		/* Huge page size (kB) */
+
+  if ((MemInfo = fopen("/proc/meminfo", "r"))) {
+    while (fgets(Line, BUFSIZE, MemInfo))
+      if (sscanf(Line, "Hugepagesize: %ld", &KBytes) == 1)
+	break;
+    fclose(MemInfo);
+  }
+  return KBytes > 0 ? (size_t) KBytes * 1024 : DEFAULTHUGEPAGE;
+}
+
+/*****************************************************************************
+  QueryNodes()
+
+  Count the pages of a placed map on each node, the pages with a known
+  copying thread and the ones among them on the node of that thread.  Pages
+  that are not present are not counted.  Returns FALSE if the nodes cannot
+  be queried
+*****************************************************************************/
+static int QueryNodes(PLACEDMAP *Placed, double *Count, double *Local,
+		      double *Copied)
+{
+#if defined(__linux__) && defined(SYS_move_pages)
+  void *Page[QUERYPAGES];	/* Pages of a query */
+  int Status[QUERYPAGES];	/* Node of each page */
+  size_t NPages;		/* Pages of the block */
+  size_t p;			/* page counter */
+  int i;			/* counter */
+  int n;			/* pages in a query */
+
+  memset(Count, 0, MAXNODES * sizeof(double));
+  *Local = 0.;
+  *Copied = 0.;
+  NPages = Placed->Bytes / Placed->PageSize;
+  for (p = 0; p < NPages; p += n) {
+    n = (int) MIN(QUERYPAGES, NPages - p);
+    for (i = 0; i < n; i++)
+      Page[i] = Placed->Block + (p + i) * Placed->PageSize;
+    if (syscall(SYS_move_pages, 0, (unsigned long) n, Page, NULL, Status, 0)
+	!= 0)
+      return FALSE;
+    for (i = 0; i < n; i++) {
+      if (Status[i] < 0 || Status[i] >= MAXNODES)
+	continue;
+      Count[Status[i]]++;
+      if (Placed->Node[p + i] >= 0)
+	(*Copied)++;
+      if (Status[i] == Placed->Node[p + i])
+	(*Local)++;
+    }
+  }
+  return TRUE;
+#else
+  return FALSE;
+#endif
+}
+
+/*****************************************************************************
+  TransparentHugeBytes()
+
+  Bytes of the process in transparent huge pages, from
+  /proc/self/smaps_rollup
+*****************************************************************************/
+static double TransparentHugeBytes(void)
+{
+  FILE *Smaps;			/* /proc/self/smaps_rollup */
+  char Line[BUFSIZE + 1];	/* Line of the file */
+  long KBytes = 0;		/* Anonymous huge pages (kB) */
+
+  if ((Smaps = fopen("/proc/self/smaps_rollup", "r"))) {
+    while (fgets(Line, BUFSIZE, Smaps))
+      if (sscanf(Line, "AnonHugePages: %ld", &KBytes) == 1)
+	break;
+    fclose(Smaps);
+  }
+  return KBytes * 1024.;
+}
@@ -0,0 +1,370 @@
+/*
+ * SUMMARY:      Profile.c - Built-in profiler
+ * USAGE:        Part of DHSVM
+ *
+ * AUTHOR:       DHSVM development team
+ * ORG:          University of Washington, Department of Civil Engineering
+ * E-MAIL:
+ * ORIG-DATE:    Oct-2026
+ * DESCRIPTION:  Time the phases of each model time step with a monotonic
+ *               clock, count the work done in the hot paths, and report
+ *               both at the end of the run, see profile.h
+ * DESCRIP-END.
+ * FUNCTIONS:    SetProfile()
+ *               InitProfile()
+ *               StartStep()
+ *               StartPhase()
+ *               StopPhase()
+ *               SetProfileThread()
+ *               CountEvent()
+ *               EndStep()
+ *               ReportProfile()
+ * COMMENTS:     Mass wasting runs inside the subsurface routing, its time
+ *               is part of both phases.
+ * $Id: Profile.c,v 1.0 2026/10/17 Exp $
+ */
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "settings.h"
+#include "DHSVMerror.h"
+#include "fileio.h"
+#include "profile.h"
+
+static PROFILESTRUCT ProcessProfile;	/* Profile outside the model
+					   instances, never active */
+__thread PROFILESTRUCT *Profile = &ProcessProfile;	/* Profile of the
+							   calling thread */
+static __thread int MyThread = -1;	/* Counters of this thread in
+					   Profile->ThreadCount, -1 for the
+					   shared counters */
+
+static char *PhaseName[NPHASES] = {
+  "InitNewStep", "MassEnergyBalance", "RouteSubSurface", "MainMWM",
+  "RouteChannel", "RouteChannelSediment", "RouteSurface", "Aggregate",
+  "MassBalance", "ExecDump"
+};
+
+static char *CounterName[NCOUNTERS] = {
+  "KinematicSteps", "RootBrentIterations", "MassWastingIterations",
+  "BytesRead", "BytesWritten"
+};
+
+static double Clock(void);
+
+/*****************************************************************************
+  Function name: SetProfile()
+
+  Purpose      : Select the profile of the calling thread
+
+  Required     :
+    PROFILESTRUCT *Instance - Profile of a model instance, NULL for the
+                              profile outside the instances
+
+  Returns      : void
+
+  Modifies     : Profile
+
+  Comments     : The profile of an instance is cleared by InitProfile()
+                 before it is used
+*****************************************************************************/
+void SetProfile(PROFILESTRUCT *Instance)
+{
+  Profile = Instance ? Instance : &ProcessProfile;
+}
+
+/*****************************************************************************
+  Function name: InitProfile()
+
+  Purpose      : Switch the profiler on and open the file for the profile
+                 of each time step
+
+  Required     :
+    int Active   - TRUE if the timers and counters run
+    int Report   - TRUE if the profile is printed at the end of the run
+    int Steps    - TRUE if the profile of each time step is written
+    int Threaded - TRUE if counters can be updated by several threads
+    char *Path   - Output directory
+
+  Returns      : void
+
+  Modifies     : Profile
+
+  Comments     : Called after InitDump(), the counters of the initialization
+                 are not part of the profile.  The progress file (progress.h)
+                 needs the counters without the report.  With several
+                 threads each thread counts in counters of its own, which
+                 are added up by EndStep().  The calling thread gets the
+                 counters of thread 0
+*****************************************************************************/
+void InitProfile(int Active, int Report, int Steps, int Threaded,
+		 char *Path)
+{
+  char FileName[BUFSIZE + 1];	/* Name of the step file */
+  int i;			/* counter */
+
+  memset(Profile, 0, sizeof(PROFILESTRUCT));
+  pthread_mutex_init(&(Profile->CountLock), NULL);
+  if (!Active)
+    return;
+
+  Profile->Report = Report;
+  Profile->Threaded = Threaded;
+  if (Steps) {
+    sprintf(FileName, "%sProfile.csv", Path);
+    OpenFile(&(Profile->StepFile), FileName, "w", TRUE);
+    fprintf(Profile->StepFile, "Date,Total");
+    for (i = 0; i < NPHASES; i++)
+      fprintf(Profile->StepFile, ",%s", PhaseName[i]);
+    for (i = 0; i < NCOUNTERS; i++)
+      fprintf(Profile->StepFile, ",%s", CounterName[i]);
+    fprintf(Profile->StepFile, "\n");
+  }
+  Profile->Active = TRUE;
+  SetProfileThread(0);
+}
+
+/*****************************************************************************
+  Function name: StartStep()
+
+  Purpose      : Start the profile of a time step
+
+  Required     : void
+
+  Returns      : void
+
+  Modifies     : Profile
+*****************************************************************************/
+void StartStep(void)
+{
+  int i;			/* counter */
+
+  memset(Profile->StepTime, 0, sizeof(Profile->StepTime));
+  memset(Profile->StepCount, 0, sizeof(Profile->StepCount));
+  for (i = 0; i < Profile->NThreadCounts; i++)
+    memset(Profile->ThreadCount[i].Count, 0,
+	   sizeof(Profile->ThreadCount[i].Count));
+  Profile->StepStart = Clock();
+}
+
+/*****************************************************************************
+  Function name: StartPhase()
+
+  Purpose      : Start the timer of a phase
+
+  Required     :
+    int Phase - Phase of the time step, see profile.h
+
+  Returns      : void
+
+  Modifies     : Profile
+*****************************************************************************/
+void StartPhase(int Phase)
+{
+  Profile->Start[Phase] = Clock();
+}
+
+/*****************************************************************************
+  Function name: StopPhase()
+
+  Purpose      : Stop the timer of a phase and add the elapsed time
+
+  Required     :
+    int Phase - Phase of the time step, see profile.h
+
+  Returns      : void
+
+  Modifies     : Profile
+
+  Comments     : A phase can be timed several times in a time step, for
+                 example once for each ensemble member
+*****************************************************************************/
+void StopPhase(int Phase)
+{
+  Profile->StepTime[Phase] += Clock() - Profile->Start[Phase];
+}
+
+/*****************************************************************************
+  Function name: SetProfileThread()
+
+  Purpose      : Give the calling thread the counters of a thread number
+
+  Required     :
+    int Thread - Number of the thread in its pool, 0 for the model thread
+
+  Returns      : void
+
+  Modifies     : The counters of the calling thread
+
+  Comments     : Called once by each worker thread when it starts.  The
+                 counters belong to the number and not to the thread, so
+                 a pool that is started again every time step keeps using
+                 the same counters.  Two threads with the same number must
+                 not run at the same time.  Threads without a number, or
+                 with a number of MAXPROFILETHREADS or more, count in the
+                 counters of the profile, under a lock.  The worker
+                 threads call it again whenever they take up the profile
+                 of another run
+*****************************************************************************/
+void SetProfileThread(int Thread)
+{
+  if (Thread < 0 || Thread >= MAXPROFILETHREADS) {
+    MyThread = -1;
+    return;
+  }
+  MyThread = Thread;
+  if (!Profile->Active)
+    return;
+  pthread_mutex_lock(&(Profile->CountLock));
+  if (Thread >= Profile->NThreadCounts)
+    Profile->NThreadCounts = Thread + 1;
+  pthread_mutex_unlock(&(Profile->CountLock));
+}
+
+/*****************************************************************************
+  Function name: CountEvent()
+
+  Purpose      : Add to a counter
+
+  Required     :
+    int Counter - Counter, see profile.h
+    double N    - Number to add
+
+  Returns      : void
+
+  Modifies     : Profile, or the counters of the calling thread
+
+  Comments     : Threads that did not call SetProfileThread() share the
+                 counters of the profile, under a lock
+*****************************************************************************/
+void CountEvent(int Counter, double N)
+{
+  if (!Profile->Threaded) {
+    Profile->StepCount[Counter] += N;
+    return;
+  }
+
+  if (MyThread >= 0)
+    Profile->ThreadCount[MyThread].Count[Counter] += N;
+  else {
+    pthread_mutex_lock(&(Profile->CountLock));
+    Profile->StepCount[Counter] += N;
+    pthread_mutex_unlock(&(Profile->CountLock));
+  }
+}
+
+/*****************************************************************************
+  Function name: EndStep()
+
+  Purpose      : End the profile of a time step, add it to the run and
+                 write it to Profile.csv
+
+  Required     :
+    DATE *Current - Model time of the step
+
+  Returns      : void
+
+  Modifies     : Profile
+
+  Comments     : Called from the main thread when the threads of the time
+                 step are done
+*****************************************************************************/
+void EndStep(DATE *Current)
+{
+  char Buffer[BUFSIZE + 1];	/* Date of the step */
+  double StepTotal;		/* Time in this step (s) */
+  int i;			/* counter */
+  int j;			/* counter */
+
+  StepTotal = Clock() - Profile->StepStart;
+  pthread_mutex_lock(&(Profile->CountLock));
+  for (j = 0; j < Profile->NThreadCounts; j++)
+    for (i = 0; i < NCOUNTERS; i++)
+      Profile->StepCount[i] += Profile->ThreadCount[j].Count[i];
+  pthread_mutex_unlock(&(Profile->CountLock));
+  Profile->StepTotal += StepTotal;
+  for (i = 0; i < NPHASES; i++)
+    Profile->Time[i] += Profile->StepTime[i];
+  for (i = 0; i < NCOUNTERS; i++)
+    Profile->Count[i] += Profile->StepCount[i];
+  Profile->NSteps++;
+
+  if (Profile->StepFile) {
+    SPrintDate(Current, Buffer);
+    fprintf(Profile->StepFile, "%s,%.6f", Buffer, StepTotal);
+    for (i = 0; i < NPHASES; i++)
+      fprintf(Profile->StepFile, ",%.6f", Profile->StepTime[i]);
+    for (i = 0; i < NCOUNTERS; i++)
+      fprintf(Profile->StepFile, ",%.0f", Profile->StepCount[i]);
+    fprintf(Profile->StepFile, "\n");
+  }
+}
+
+/*****************************************************************************
+  Function name: ReportProfile()
+
+  Purpose      : Print the profile of the run
+
+  Required     :
+    FILE *OutFile - File to print to
+
+  Returns      : void
+
+  Modifies     : Profile
+
+  Comments     : Closes Profile.csv
+*****************************************************************************/
+void ReportProfile(FILE *OutFile)
+{
+  double Other;			/* Time outside the timed phases (s) */
+  int i;			/* counter */
+
+  if (!Profile->Report)
+    return;
+
+  fprintf(OutFile, "\nProfile of %d time steps, %.3f s\n", Profile->NSteps,
+	  Profile->StepTotal);
+  fprintf(OutFile, "%-22s %12s %8s %12s\n", "Phase", "Time (s)", "%",
+	  "ms/step");
+  Other = Profile->StepTotal;
+  for (i = 0; i < NPHASES; i++) {
+    if (i != PROF_MASSWASTING)
+      Other -= Profile->Time[i];
+    fprintf(OutFile, "%-22s %12.3f %8.1f %12.3f\n", PhaseName[i],
+	    Profile->Time[i],
+	    Profile->StepTotal > 0. ? 100. * Profile->Time[i] /
+	    Profile->StepTotal : 0.,
+	    Profile->NSteps > 0 ? 1000. * Profile->Time[i] / Profile->NSteps : 0.);
+  }
+  fprintf(OutFile, "%-22s %12.3f %8.1f %12.3f\n", "Other", Other,
+	  Profile->StepTotal > 0. ? 100. * Other / Profile->StepTotal : 0.,
+	  Profile->NSteps > 0 ? 1000. * Other / Profile->NSteps : 0.);
+  fprintf(OutFile, "(MainMWM is part of RouteSubSurface)\n");
+
+  fprintf(OutFile, "%-22s %16s %16s\n", "Counter", "Total", "Per step");
+  for (i = 0; i < NCOUNTERS; i++)
+    fprintf(OutFile, "%-22s %16.0f %16.1f\n", CounterName[i],
+	    Profile->Count[i],
+	    Profile->NSteps > 0 ? Profile->Count[i] / Profile->NSteps : 0.);
+
+  if (Profile->StepFile) {
+    fclose(Profile->StepFile);
+    Profile->StepFile = NULL;
+  }
+}
+
+/*****************************************************************************
+  Clock()
+
+  Monotonic clock (s)
+*****************************************************************************/
+static double Clock(void)
+{
+  struct timespec Now;
+
+  clock_gettime(CLOCK_MONOTONIC, &Now);
+  return Now.tv_sec + 1e-9 * Now.tv_nsec;
+}
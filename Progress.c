@@ -0,0 +1,274 @@
+/*
+ * SUMMARY:      Progress.c - Progress file of a model run
+ * USAGE:        Part of DHSVM
+ *
+ * AUTHOR:       DHSVM development team
+ * ORG:          University of Washington, Department of Civil Engineering
+ * E-MAIL:
+ * ORIG-DATE:    Oct-2026
+ * DESCRIPTION:  Keep moving averages of the wall time, the sub-steps and
+ *               the input and output of the last time steps and rewrite
+ *               Progress.json with them, see progress.h
+ * DESCRIP-END.
+ * FUNCTIONS:    InitProgress()
+ *               UpdateProgress()
+ *               EndProgress()
+ * COMMENTS:     The estimated completion assumes that the remaining model
+ *               time is simulated at the rate of the last PROGRESSWINDOW
+ *               steps.  In a spin-up cycle the estimate is for the end of
+ *               the cycle.
+ * $Id: Progress.c,v 1.0 2026/10/17 Exp $
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "settings.h"
+#include "Calendar.h"
+#include "DHSVMerror.h"
+#include "profile.h"
+#include "progress.h"
+
+#define DEFAULTINTERVAL 60	/* Default time between updates (s) */
+
+static double Clock(void);
+static void WriteProgress(PROGRESSSTRUCT *Progress, const char *Status);
+static void PrintISODate(DATE *Day, char *Buffer);
+static void PrintWallTime(time_t Time, char *Buffer);
+
+/*****************************************************************************
+  Function name: InitProgress()
+
+  Purpose      : Start the progress file
+
+  Required     :
+    PROGRESSSTRUCT *Progress - Progress of the run
+    int Active               - TRUE if the progress file is written
+    int Interval             - Time between two updates (s), 0 for the
+                               default
+    char *Path               - Output directory
+    long NCells              - Number of pixels in the basin
+    TIMESTRUCT *Time         - Begin and end times, model time step
+
+  Returns      : void
+
+  Modifies     : Progress
+
+  Comments     : Called after InitDump(), so that the members of an ensemble
+                 write to their own output directory
+*****************************************************************************/
+void InitProgress(PROGRESSSTRUCT *Progress, int Active, int Interval,
+		  char *Path, long NCells, TIMESTRUCT *Time)
+{
+  memset(Progress, 0, sizeof(PROGRESSSTRUCT));
+  if (!Active)
+    return;
+
+  Progress->Active = TRUE;
+  Progress->Interval = Interval > 0 ? Interval : DEFAULTINTERVAL;
+  sprintf(Progress->FileName, "%sProgress.json", Path);
+  sprintf(Progress->TempName, "%sProgress.json.tmp", Path);
+  Progress->NCells = NCells;
+  Progress->BaseDt = Time->Dt;
+  CopyDate(&(Progress->Simulated), &(Time->Start));
+  CopyDate(&(Progress->End), &(Time->End));
+  Progress->Start = Clock();
+  Progress->LastStep = Progress->Start;
+  Progress->LastWrite = Progress->Start;
+
+  WriteProgress(Progress, "running");
+}
+
+/*****************************************************************************
+  Function name: UpdateProgress()
+
+  Purpose      : Add a time step to the progress and rewrite the progress
+                 file when the interval has passed
+
+  Required     :
+    PROGRESSSTRUCT *Progress - Progress of the run
+    TIMESTRUCT *Time         - Model time of the step just done
+
+  Returns      : void
+
+  Modifies     : Progress
+
+  Comments     : Called after EndStep(), which leaves the counters of the
+                 step in Profile->StepCount
+*****************************************************************************/
+void UpdateProgress(PROGRESSSTRUCT *Progress, TIMESTRUCT *Time)
+{
+  double Now;			/* Clock at the end of this step (s) */
+  int i;			/* Entry of the window */
+
+  Now = Clock();
+  i = Progress->Next;
+  Progress->WallTime[i] = Now - Progress->LastStep;
+  Progress->ModelTime[i] = Time->Dt;
+  Progress->SubSteps[i] = Profile->StepCount[PROF_KINEMATICSTEPS];
+  Progress->Bytes[i] = Profile->StepCount[PROF_BYTESREAD] +
+    Profile->StepCount[PROF_BYTESWRITTEN];
+  Progress->Next = (i + 1) % PROGRESSWINDOW;
+  if (Progress->NWindow < PROGRESSWINDOW)
+    Progress->NWindow++;
+
+  Progress->NSteps++;
+  Progress->LastStep = Now;
+  CopyDate(&(Progress->Simulated), &(Time->Current));
+  CopyDate(&(Progress->End), &(Time->End));
+
+  if (Now - Progress->LastWrite >= Progress->Interval) {
+    WriteProgress(Progress, "running");
+    Progress->LastWrite = Now;
+  }
+}
+
+/*****************************************************************************
+  Function name: EndProgress()
+
+  Purpose      : Write the progress file at the end of the run
+
+  Required     :
+    PROGRESSSTRUCT *Progress - Progress of the run
+
+  Returns      : void
+
+  Modifies     : Progress
+*****************************************************************************/
+void EndProgress(PROGRESSSTRUCT *Progress)
+{
+  if (!Progress->Active)
+    return;
+
+  WriteProgress(Progress, "finished");
+  Progress->Active = FALSE;
+}
+
+/*****************************************************************************
+  WriteProgress()
+
+  Write the progress to the temporary file and rename it to the progress
+  file.  A failure to write is reported but does not end the run
+*****************************************************************************/
+static void WriteProgress(PROGRESSSTRUCT *Progress, const char *Status)
+{
+  FILE *OutFile;		/* Temporary file */
+  char Simulated[BUFSIZE + 1];	/* Model time of the last step done */
+  char End[BUFSIZE + 1];	/* End of the run */
+  char Updated[BUFSIZE + 1];	/* Wall clock time of this update */
+  char Completion[BUFSIZE + 1];	/* Estimated completion */
+  double Elapsed;		/* Wall time since the start of the run (s) */
+  double WallTime = 0.;		/* Sums over the window */
+  double ModelTime = 0.;
+  double SubSteps = 0.;
+  double Bytes = 0.;
+  double StepTime;		/* Wall time per step (s) */
+  double Remaining;		/* Model time still to simulate (s) */
+  double ETA;			/* Estimated wall time to completion (s) */
+  double NRemaining;		/* Time steps still to simulate */
+  time_t Now;			/* Wall clock time */
+  int i;			/* counter */
+
+  for (i = 0; i < Progress->NWindow; i++) {
+    WallTime += Progress->WallTime[i];
+    ModelTime += Progress->ModelTime[i];
+    SubSteps += Progress->SubSteps[i];
+    Bytes += Progress->Bytes[i];
+  }
+  StepTime = Progress->NWindow > 0 ? WallTime / Progress->NWindow : 0.;
+
+  if (strcmp(Status, "finished") == 0)
+    Remaining = 0.;
+  else
+    Remaining = (Progress->End.Julian - Progress->Simulated.Julian) * SECPDAY;
+  if (Remaining < 0.)
+    Remaining = 0.;
+  NRemaining = Remaining / Progress->BaseDt;
+  ETA = ModelTime > 0. ? Remaining * WallTime / ModelTime : -1.;
+
+  Elapsed = Clock() - Progress->Start;
+  Now = time(NULL);
+  PrintISODate(&(Progress->Simulated), Simulated);
+  PrintISODate(&(Progress->End), End);
+  PrintWallTime(Now, Updated);
+  if (ETA >= 0.)
+    PrintWallTime(Now + (time_t) (ETA + 0.5), Completion);
+
+  if (!(OutFile = fopen(Progress->TempName, "w"))) {
+    ReportWarning(Progress->TempName, 3);
+    return;
+  }
+  fprintf(OutFile, "{\n");
+  fprintf(OutFile, "  \"status\": \"%s\",\n", Status);
+  fprintf(OutFile, "  \"updated\": \"%s\",\n", Updated);
+  fprintf(OutFile, "  \"elapsed_seconds\": %.1f,\n", Elapsed);
+  fprintf(OutFile, "  \"simulated_date\": \"%s\",\n", Simulated);
+  fprintf(OutFile, "  \"end_date\": \"%s\",\n", End);
+  fprintf(OutFile, "  \"steps_done\": %d,\n", Progress->NSteps);
+  fprintf(OutFile, "  \"steps_remaining\": %.0f,\n", NRemaining);
+  fprintf(OutFile, "  \"window_steps\": %d,\n", Progress->NWindow);
+  fprintf(OutFile, "  \"seconds_per_step\": %.6f,\n", StepTime);
+  fprintf(OutFile, "  \"cell_steps_per_second\": %.1f,\n",
+	  WallTime > 0. ? Progress->NCells * Progress->NWindow / WallTime : 0.);
+  fprintf(OutFile, "  \"model_seconds_per_second\": %.1f,\n",
+	  WallTime > 0. ? ModelTime / WallTime : 0.);
+  fprintf(OutFile, "  \"kinematic_substeps\": %.0f,\n",
+	  Profile->Count[PROF_KINEMATICSTEPS]);
+  fprintf(OutFile, "  \"kinematic_substeps_per_step\": %.2f,\n",
+	  Progress->NWindow > 0 ? SubSteps / Progress->NWindow : 0.);
+  fprintf(OutFile, "  \"bytes_read\": %.0f,\n",
+	  Profile->Count[PROF_BYTESREAD]);
+  fprintf(OutFile, "  \"bytes_written\": %.0f,\n",
+	  Profile->Count[PROF_BYTESWRITTEN]);
+  fprintf(OutFile, "  \"io_bytes_per_second\": %.1f,\n",
+	  WallTime > 0. ? Bytes / WallTime : 0.);
+  if (ETA >= 0.) {
+    fprintf(OutFile, "  \"remaining_seconds\": %.0f,\n", ETA);
+    fprintf(OutFile, "  \"estimated_completion\": \"%s\"\n", Completion);
+  }
+  else {
+    fprintf(OutFile, "  \"remaining_seconds\": null,\n");
+    fprintf(OutFile, "  \"estimated_completion\": null\n");
+  }
+  fprintf(OutFile, "}\n");
+
+  if (fclose(OutFile) != 0 ||
+      rename(Progress->TempName, Progress->FileName) != 0)
+    ReportWarning(Progress->FileName, 3);
+}
+
+/*****************************************************************************
+  PrintISODate()
+*****************************************************************************/
+static void PrintISODate(DATE *Day, char *Buffer)
+{
+  sprintf(Buffer, "%04d-%02d-%02dT%02d:%02d:%02d", Day->Year, Day->Month,
+	  Day->Day, Day->Hour, Day->Min, Day->Sec);
+}
+
+/*****************************************************************************
+  PrintWallTime()
+
+  Wall clock time in UTC
+*****************************************************************************/
+static void PrintWallTime(time_t Time, char *Buffer)
+{
+  struct tm *UTC;
+
+  UTC = gmtime(&Time);
+  strftime(Buffer, BUFSIZE, "%Y-%m-%dT%H:%M:%SZ", UTC);
+}
+
+/*****************************************************************************
+  Clock()
+
+  Monotonic wall clock (s)
+*****************************************************************************/
+static double Clock(void)
+{
+  struct timespec Now;
+
+  clock_gettime(CLOCK_MONOTONIC, &Now);
+  return Now.tv_sec + 1e-9 * Now.tv_nsec;
+}
@@ -20,6 +20,7 @@
 #include "DHSVMerror.h"
 #include "functions.h"
 #include "constants.h"
+#include "profile.h"
 
 #define MAXMETVARS    21	/* Maximum Number of meteorological variables 
 				   to read.  Hack to be replaced by something
@@ -37,6 +38,7 @@ void ReadMetRecord(OPTIONSTRUCT * Options, DATE * Current, int NSoilLayers,
   int i;
   int NMetVars;			/* Number of meteorological variables to 
 				   read */
+  long Start;			/* Position in the file before the record */
   NMetVars = 5;
   /* these are - in order: 
      air temp,
@@ -57,6 +59,7 @@ void ReadMetRecord(OPTIONSTRUCT * Options, DATE * Current, int NSoilLayers,
   if (IsWindModelLocation)
     NMetVars++;
 
+  Start = PROFILE_TELL(InFile->FilePtr);
   if (!ScanDate(InFile->FilePtr, &MetDate))
     ReportError(InFile->FileName, 23);
 
@@ -79,6 +82,7 @@ void ReadMetRecord(OPTIONSTRUCT * Options, DATE * Current, int NSoilLayers,
 
   if (ScanFloats(InFile->FilePtr, Array, NMetVars) != NMetVars)
     ReportError(InFile->FileName, 5);
+  PROFILE_COUNT_FILE(PROF_BYTESREAD, InFile->FilePtr, Start);
 
   MetRecord->Tair = Array[0];
   MetRecord->Wind = Array[1];
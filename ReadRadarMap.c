@@ -20,6 +20,7 @@
 #include "DHSVMerror.h"
 #include "fileio.h"
 #include "functions.h"
+#include "memtrack.h"
 #include "constants.h"
 #include "sizeofnt.h"
 
@@ -43,8 +44,8 @@ void ReadRadarMap(DATE * Current, DATE * StartRadar, int Dt, MAPSIZE * Radar,
 
   NumberType = NC_FLOAT;
 
-  if (!(Array = (float *) calloc(Radar->NY * Radar->NX,
-				 SizeOfNumberType(NumberType))))
+  if (!(Array = (float *) CallocMap(Radar->NY, Radar->NX,
+				    SizeOfNumberType(NumberType))))
     ReportError((char *) Routine, 1);
 
   RadarStep = NumberOfSteps(StartRadar, Current, Dt);
@@ -57,5 +58,5 @@ void ReadRadarMap(DATE * Current, DATE * StartRadar, int Dt, MAPSIZE * Radar,
     for (x = 0; x < Radar->NX; x++, i++)
       RadarMap[y][x].Precip = ((float *) Array)[i];
 
-  free(Array);
+  FreeMap(Array);
 }
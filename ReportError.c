@@ -10,10 +10,12 @@
  * DESCRIP-END.
  * FUNCTIONS:    ReportError()
  *               ReportWarning()
+ *               SetErrorReturn()
  * COMMENTS:
  * $Id: ReportError.c,v 1.6 2004/08/24 23:21:48 tbohn Exp $     
  */
 
+#include <setjmp.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include "settings.h"
@@ -95,13 +97,33 @@ static char *ErrorMessage[] = {
   "Water quality mass balance error greater than 10%: ",	/* 72 */
   "Runoff mass balance error greater than 10%: ",	/* 73 */
   "Number of pollutants for each land use category must be equal to the number of pollutants specified in [POLLUTANTS] section:", /* 74 */
+  "Point location outside model area:", /* 75 */
+  "More than one point in the same pixel:", /* 76 */
+  "Cannot create thread in function:", /* 77 */
+  "Error while writing file:", /* 78 */
+  "Spin-up cannot be combined with the sediment model:", /* 79 */
+  "Cannot start ensemble member:", /* 80 */
+  "Cannot create directory:", /* 81 */
+  "Cannot create server socket:", /* 82 */
+  "Invalid calibration parameter set:", /* 83 */
+  "Cannot start parameter set:", /* 84 */
+  "Clip target is not in the basin:", /* 85 */
+  "MPI error in function:", /* 86 */
+  "Too few time steps to tune the run:", /* 87 */
   NULL
 };
 
+static __thread jmp_buf *ErrorReturn = NULL;	/* Where errors of the
+						   calling thread return
+						   to, see
+						   SetErrorReturn() */
+
 void ReportError(char *ErrorString, int ErrorCode)
 {
   printf("%s %s\n", ErrorMessage[ErrorCode - 1], ErrorString);
 
+  if (ErrorReturn)
+    longjmp(*ErrorReturn, ErrorCode);
   exit(ErrorCode);
 }
 
@@ -110,6 +132,30 @@ void ReportWarning(char *ErrorString, int ErrorCode)
   fprintf(stderr, "%s %s\n", ErrorMessage[ErrorCode - 1], ErrorString);
 }
 
+/*****************************************************************************
+  Function name: SetErrorReturn()
+
+  Purpose      : Return to the caller instead of ending the process when
+                 ReportError() is called
+
+  Required     :
+    jmp_buf *Return - Set by setjmp() in the caller, which sees the error
+                      code as the value of setjmp().  NULL to go back to
+                      ending the process
+
+  Returns      : void
+
+  Modifies     : The action of ReportError()
+
+  Comments     : Used by dhsvm_init() (Model.c).  Only errors in the
+                 calling thread return, the other threads still end the
+                 process
+*****************************************************************************/
+void SetErrorReturn(jmp_buf *Return)
+{
+  ErrorReturn = Return;
+}
+
 /*******************************************************************************
   Test main. Compile by typing:
   gcc -DTEST_REPORTERROR -o test_error ReportError.c
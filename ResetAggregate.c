@@ -86,7 +86,6 @@ void ResetAggregate(LAYER * Soil, LAYER * Veg, AGGREGATED * Total,
      in the RouteSurface() routine */
 
   Total->Soil.Soil = 0;
-  Total->Soil.Depth = 0.0;
   for (i = 0; i < Soil->MaxLayers + 1; i++)
     Total->Soil.Moist[i] = 0.0;
   for (i = 0; i < Soil->MaxLayers; i++) {
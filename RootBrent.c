@@ -24,6 +24,7 @@
 #include "massenergy.h"
 #include "functions.h"
 #include "DHSVMerror.h"
+#include "profile.h"
 
 /*****************************************************************************
   GENERAL DOCUMENTATION FOR THIS MODULE
@@ -161,6 +162,7 @@ float RootBrent(int y, int x, float LowerBound, float UpperBound,
 
     if (fabs(m) <= tol || fequal(fb, 0.0)) {
       va_end(ap);
+      PROFILE_COUNT(PROF_BRENTITER, i + 1);
       return b;
     }
 
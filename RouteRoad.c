@@ -56,7 +56,8 @@
 void RouteRoad(MAPSIZE * Map, TIMESTRUCT * Time, TOPOPIX ** TopoMap,
 	       SOILPIX ** SoilMap, ROADSTRUCT ** Network, SOILTABLE * SType,
 	       CHANNEL * ChannelData, PRECIPPIX ** PrecipMap, SEDPIX **SedMap,
-	       float Tair, float Rh, float *SedDiams) 
+	       ADAPTIVESTRUCT *Adaptive, float Tair, float Rh,
+	       float *SedDiams) 
 {
   const char *Routine = "RouteRoad";
   int i,j,x,y;                   /* Counters */
@@ -102,10 +103,8 @@ void RouteRoad(MAPSIZE * Map, TIMESTRUCT * Time, TOPOPIX ** TopoMap,
   if ((SedIn = (float *) calloc(CELLFACTOR, sizeof(float))) == NULL)
     ReportError((char *) Routine, 1);
 
-  NextTime = *Time;
-  
   /* Holds the value of the next DHSVM time step. */ 
-  IncreaseTime(&NextTime);
+  StepEndTime(Adaptive, Time, &NextTime);
 
   knviscosity = viscosity(Tair, Rh);
  
@@ -9,11 +9,14 @@
  * DESCRIPTION:  Route subsurface flow
  * DESCRIP-END.
  * FUNCTIONS:    RouteSubSurface()
- * COMMENTS:
+ * COMMENTS:     The transmissivities of a row of pixels are calculated
+ *               together by the dispatched kernel CalcTransmissivities(),
+ *               see dispatch.h, before the flow of the row is routed.
  * $Id: RouteSubSurface.c,v 1.20 2004/08/18 01:01:32 colleen Exp $     
  */
 
 #include <math.h>
+#include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include "settings.h"
@@ -24,6 +27,9 @@
 #include "soilmoisture.h"
 #include "slopeaspect.h"
 #include "DHSVMChannel.h"
+#include "profile.h"
+#include "params.h"
+#include "dispatch.h"
 
 #ifndef MIN_GRAD
 #define MIN_GRAD .3		/* minimum slope for flow to channel */
@@ -98,7 +104,7 @@
 void RouteSubSurface(int Dt, MAPSIZE *Map, TOPOPIX **TopoMap,
 		     VEGTABLE *VType, VEGPIX **VegMap,
 		     ROADSTRUCT **Network, SOILTABLE *SType,
-		     SOILPIX **SoilMap, CHANNEL *ChannelData,
+		     PARAMMAP *Params, SOILPIX **SoilMap, CHANNEL *ChannelData,
 		     TIMESTRUCT *Time, OPTIONSTRUCT *Options, 
 		     char *DumpPath, SEDPIX **SedMap, FINEPIX ***FineMap,
 		     SEDTABLE *SedType, int MaxStreamID, SNOWPIX **SnowMap)
@@ -110,11 +116,32 @@ void RouteSubSurface(int Dt, MAPSIZE *Map, TOPOPIX **TopoMap,
   float BankHeight;
   float *Adjust;
   float fract_used;
-  float depth;
   float OutFlow;
   float water_out_road;
   float Transmissivity;
   float AvailableWater;
+  float KsLat;			/* Parameters of the pixel, from the */
+  float KsLatExp;		/* parameter maps or the type tables */
+  float DepthThresh;
+  float *TransBuffer;		/* Inputs and results of CalcTransmissivities
+				   for one row */
+  float *TransDepth;		/* Soil depth */
+  float *TransTable;		/* Water table depth */
+  float *TransKsLat;		/* KsLat */
+  float *TransKsLatExp;		/* KsLatExp */
+  float *TransThresh;		/* DepthThresh */
+  float *Trans;			/* Transmissivity */
+  int *TransSlot;		/* Entries of pixel x in the row buffers,
+				   2 * x for the flow to the neighbours and
+				   2 * x + 1 for the flow to a road or stream
+				   channel, -1 if not needed */
+  int NTrans;			/* Number of entries in the row buffers */
+  int FirstTrans;		/* First entry of the pixel */
+  int NRootLayers;
+  float *RootDepth;
+  float *Porosity;
+  float *FCap;
+  long p;			/* index of the pixel in the parameter maps */
   int k;
   float **SubFlowGrad;	        /* Magnitude of subsurface flow gradient
 				   slope * width */
@@ -123,6 +150,7 @@ void RouteSubSurface(int Dt, MAPSIZE *Map, TOPOPIX **TopoMap,
 
   /* variables for mass wasting trigger. */
   int count, totalcount;
+  double Counts[2];		/* count and totalcount of all MPI ranks */
   float mgrid, sat;
   char buffer[32];
   char satoutfile[100];          /* Character arrays to hold file name. */ 
@@ -156,6 +184,17 @@ void RouteSubSurface(int Dt, MAPSIZE *Map, TOPOPIX **TopoMap,
     if (!(SubTotalDir[i] = (unsigned int *)calloc(Map->NX, sizeof(unsigned int))))
       ReportError((char *) Routine, 1);
   }
+
+  if (!(TransBuffer = (float *) calloc(12 * Map->NX, sizeof(float))))
+    ReportError((char *) Routine, 1);
+  TransDepth = TransBuffer;
+  TransTable = TransBuffer + 2 * Map->NX;
+  TransKsLat = TransBuffer + 4 * Map->NX;
+  TransKsLatExp = TransBuffer + 6 * Map->NX;
+  TransThresh = TransBuffer + 8 * Map->NX;
+  Trans = TransBuffer + 10 * Map->NX;
+  if (!(TransSlot = (int *) calloc(2 * Map->NX, sizeof(int))))
+    ReportError((char *) Routine, 1);
   
   /* reset the saturated subsurface flow to zero */
   for (y = 0; y < Map->NY; y++) {
@@ -174,11 +213,83 @@ void RouteSubSurface(int Dt, MAPSIZE *Map, TOPOPIX **TopoMap,
 
   /* next sweep through all the grid cells, calculate the amount of
      flow in each direction, and divide the flow over the surrounding
-     pixels */
+     pixels.  In an MPI run only the pixels of this rank */
 
   for (y = 0; y < Map->NY; y++) {
+
+    /* collect the transmissivities that the row needs, in the order in
+       which they are used, and calculate them together */
+    NTrans = 0;
     for (x = 0; x < Map->NX; x++) {
-      if (INBASIN(TopoMap[y][x].Mask)) {
+      TransSlot[2 * x] = -1;
+      TransSlot[2 * x + 1] = -1;
+      if (INBASIN(TopoMap[y][x].Mask) && ISOWNED(Options->Parallel, y, x)) {
+	if (Params->Active) {
+	  p = PARAMINDEX(Params, y, x);
+	  KsLat = Params->KsLat[p];
+	  KsLatExp = Params->KsLatExp[p];
+	  DepthThresh = Params->DepthThresh[p];
+	}
+	else {
+	  KsLat = SType[SoilMap[y][x].Soil - 1].KsLat;
+	  KsLatExp = SType[SoilMap[y][x].Soil - 1].KsLatExp;
+	  DepthThresh = SType[SoilMap[y][x].Soil - 1].DepthThresh;
+	}
+	BankHeight = (Network[y][x].BankHeight > SOILDEPTH(SoilMap[y][x])) ?
+	  SOILDEPTH(SoilMap[y][x]) : Network[y][x].BankHeight;
+
+	FirstTrans = NTrans;
+	if (!channel_grid_has_channel(ChannelData->stream_map, x, y) &&
+	    SoilMap[y][x].TableDepth < SOILDEPTH(SoilMap[y][x])) {
+	  TransSlot[2 * x] = NTrans;
+	  TransDepth[NTrans] = SOILDEPTH(SoilMap[y][x]);
+	  TransTable[NTrans] = (SoilMap[y][x].TableDepth > BankHeight) ?
+	    SoilMap[y][x].TableDepth : BankHeight;
+	  NTrans++;
+	}
+	if (SoilMap[y][x].TableDepth < BankHeight &&
+	    (channel_grid_has_channel(ChannelData->stream_map, x, y) ||
+	     channel_grid_has_channel(ChannelData->road_map, x, y))) {
+	  TransSlot[2 * x + 1] = NTrans;
+	  TransDepth[NTrans] = BankHeight;
+	  TransTable[NTrans] = SoilMap[y][x].TableDepth;
+	  NTrans++;
+	}
+	for (i = FirstTrans; i < NTrans; i++) {
+	  TransKsLat[i] = KsLat;
+	  TransKsLatExp[i] = KsLatExp;
+	  TransThresh[i] = DepthThresh;
+	}
+      }
+    }
+    CalcTransmissivities(NTrans, TransDepth, TransTable, TransKsLat,
+			 TransKsLatExp, TransThresh, Trans);
+    for (i = 0; i < NTrans; i++) {
+      if (!fequal(TransKsLatExp[i], 0.0) &&
+	  TransTable[i] >= TransThresh[i] && TransDepth[i] < TransThresh[i]) {
+	printf("Warning: Soil DepthThreshold (%.2f) > the soil depth "
+	       "(%.2f)!\n", TransThresh[i], TransDepth[i]);
+	printf("Transmissivity is set to zero!");
+      }
+    }
+
+    for (x = 0; x < Map->NX; x++) {
+      if (INBASIN(TopoMap[y][x].Mask) && ISOWNED(Options->Parallel, y, x)) {
+
+	/* parameters of the pixel, see params.h */
+	if (Params->Active) {
+	  p = PARAMINDEX(Params, y, x);
+	  NRootLayers = Params->NSoilLayers[p];
+	  RootDepth = &(Params->RootDepth[p * Params->MaxLayers]);
+	  Porosity = &(Params->Porosity[p * Params->MaxLayers]);
+	  FCap = &(Params->FCap[p * Params->MaxLayers]);
+	}
+	else {
+	  NRootLayers = VType[VegMap[y][x].Veg - 1].NSoilLayers;
+	  RootDepth = VType[VegMap[y][x].Veg - 1].RootDepth;
+	  Porosity = SType[SoilMap[y][x].Soil - 1].Porosity;
+	  FCap = SType[SoilMap[y][x].Soil - 1].FCap;
+	}
 	
 	if (Options->FlowGradient == TOPOGRAPHY){
 	  SubTotalDir[y][x] = TopoMap[y][x].TotalDir;
@@ -187,8 +298,8 @@ void RouteSubSurface(int Dt, MAPSIZE *Map, TOPOPIX **TopoMap,
 	    SubDir[y][x][k] = TopoMap[y][x].Dir[k];
 	}
 
-	BankHeight = (Network[y][x].BankHeight > SoilMap[y][x].Depth) ?
-	  SoilMap[y][x].Depth : Network[y][x].BankHeight;
+	BankHeight = (Network[y][x].BankHeight > SOILDEPTH(SoilMap[y][x])) ?
+	  SOILDEPTH(SoilMap[y][x]) : Network[y][x].BankHeight;
 	Adjust = Network[y][x].Adjust;
 	fract_used = 0.0f;
 	water_out_road = 0.0;
@@ -206,16 +317,8 @@ void RouteSubSurface(int Dt, MAPSIZE *Map, TOPOPIX **TopoMap,
 	    fract_used = 0.;
 
 	  /* only bother calculating subsurface flow if water table is above bedrock */
-	  if (SoilMap[y][x].TableDepth < SoilMap[y][x].Depth) {
-	    depth =
-	      ((SoilMap[y][x].TableDepth > BankHeight) ?
-	       SoilMap[y][x].TableDepth : BankHeight);
-
-	    Transmissivity =
-	      CalcTransmissivity(SoilMap[y][x].Depth, depth,
-				 SType[SoilMap[y][x].Soil - 1].KsLat,
-				 SType[SoilMap[y][x].Soil - 1].KsLatExp,
-				 SType[SoilMap[y][x].Soil - 1].DepthThresh);
+	  if (SoilMap[y][x].TableDepth < SOILDEPTH(SoilMap[y][x])) {
+	    Transmissivity = Trans[TransSlot[2 * x]];
 
 	    OutFlow =
 	      (Transmissivity * fract_used * SubFlowGrad[y][x] * Dt) /
@@ -226,19 +329,15 @@ void RouteSubSurface(int Dt, MAPSIZE *Map, TOPOPIX **TopoMap,
 	    /* check whether enough water is available for redistribution */
 
 	    AvailableWater =
-	      CalcAvailableWater(VType[VegMap[y][x].Veg - 1].NSoilLayers,
-				 SoilMap[y][x].Depth,
-				 VType[VegMap[y][x].Veg - 1].RootDepth,
-				 SType[SoilMap[y][x].Soil - 1].Porosity,
-				 SType[SoilMap[y][x].Soil - 1].FCap,
+	      CalcAvailableWater(NRootLayers,
+				 SOILDEPTH(SoilMap[y][x]),
+				 RootDepth, Porosity, FCap,
 				 SoilMap[y][x].TableDepth, Adjust);
 
 	    OutFlow = (OutFlow > AvailableWater) ? AvailableWater : OutFlow;
 	  }
-	  else {
-	    depth = SoilMap[y][x].Depth;
+	  else
 	    OutFlow = 0.0f;
-	  }
 
 	  /* compute road interception if water table is above road cut */
 
@@ -252,11 +351,7 @@ void RouteSubSurface(int Dt, MAPSIZE *Map, TOPOPIX **TopoMap,
 	    else
 	      fract_used = 0.;
 
-	    Transmissivity =
-	      CalcTransmissivity(BankHeight, SoilMap[y][x].TableDepth,
-				 SType[SoilMap[y][x].Soil - 1].KsLat,
-				 SType[SoilMap[y][x].Soil - 1].KsLatExp,
-				 SType[SoilMap[y][x].Soil - 1].DepthThresh);
+	    Transmissivity = Trans[TransSlot[2 * x + 1]];
 	    water_out_road = (Transmissivity * fract_used *
 			      SubFlowGrad[y][x] * Dt) / (Map->DX *
 							      Map->DY);
@@ -265,11 +360,9 @@ void RouteSubSurface(int Dt, MAPSIZE *Map, TOPOPIX **TopoMap,
 /* 							      Map->DY); */
 
 	    AvailableWater =
-	      CalcAvailableWater(VType[VegMap[y][x].Veg - 1].NSoilLayers,
+	      CalcAvailableWater(NRootLayers,
 				 BankHeight,
-				 VType[VegMap[y][x].Veg - 1].RootDepth,
-				 SType[SoilMap[y][x].Soil - 1].Porosity,
-				 SType[SoilMap[y][x].Soil - 1].FCap,
+				 RootDepth, Porosity, FCap,
 				 SoilMap[y][x].TableDepth, Adjust);
 	    water_out_road = (water_out_road > AvailableWater) ? AvailableWater
 	      : water_out_road;
@@ -283,7 +376,8 @@ void RouteSubSurface(int Dt, MAPSIZE *Map, TOPOPIX **TopoMap,
 
 	  /* Subsurface Component - Decrease water change by outwater */
 
-	  SoilMap[y][x].SatFlow -= OutFlow + water_out_road;
+	  AddFlow(&(Options->Parallel), &(SoilMap[y][x].SatFlow), y, x, y, x,
+		  0, -(OutFlow + water_out_road));
 
 	  /* Assign the water to appropriate surrounding pixels */
 
@@ -298,7 +392,8 @@ void RouteSubSurface(int Dt, MAPSIZE *Map, TOPOPIX **TopoMap,
 	    int nx = xdirection[k] + x;
 	    int ny = ydirection[k] + y;
 	    if (valid_cell(Map, nx, ny)) {
-	      SoilMap[ny][nx].SatFlow += OutFlow * SubDir[y][x][k];
+	      AddFlow(&(Options->Parallel), &(SoilMap[ny][nx].SatFlow), ny, nx,
+		      y, x, 0, OutFlow * SubDir[y][x][k]);
 /* 	      SoilMap[ny][nx].SatFlow += OutFlow * TopoMap[y][x].Dir[k]; */
 	    }
 	  }
@@ -309,35 +404,30 @@ void RouteSubSurface(int Dt, MAPSIZE *Map, TOPOPIX **TopoMap,
 	  if (SoilMap[y][x].TableDepth < BankHeight &&
 	      channel_grid_has_channel(ChannelData->stream_map, x, y)) {
 	    /* float gradient =  */
-	    /*   (4.0 * SoilMap[y][x].Depth > 2.0 * MIN_GRAD * Map->DX) ?  */
-	    /*   4.0 * SoilMap[y][x].Depth : 2.0 * MIN_GRAD * Map->DX; */
+	    /*   (4.0 * SOILDEPTH(SoilMap[y][x]) > 2.0 * MIN_GRAD * Map->DX) ?  */
+	    /*   4.0 * SOILDEPTH(SoilMap[y][x]) : 2.0 * MIN_GRAD * Map->DX; */
 
 	    float gradient = 4.0 * (BankHeight - SoilMap[y][x].TableDepth);
 	    if (gradient < 0.0)
 	      gradient = 0.0;
 
-	    Transmissivity =
-	      CalcTransmissivity(BankHeight, SoilMap[y][x].TableDepth,
-				 SType[SoilMap[y][x].Soil - 1].KsLat,
-				 SType[SoilMap[y][x].Soil - 1].KsLatExp,
-				 SType[SoilMap[y][x].Soil - 1].DepthThresh);
+	    Transmissivity = Trans[TransSlot[2 * x + 1]];
 
 	    OutFlow = (Transmissivity * gradient * Dt) / (Map->DX * Map->DY);
 
 	    /* check whether enough water is available for redistribution */
 
 	    AvailableWater =
-	      CalcAvailableWater(VType[VegMap[y][x].Veg - 1].NSoilLayers,
+	      CalcAvailableWater(NRootLayers,
 				 BankHeight,
-				 VType[VegMap[y][x].Veg - 1].RootDepth,
-				 SType[SoilMap[y][x].Soil - 1].Porosity,
-				 SType[SoilMap[y][x].Soil - 1].FCap,
+				 RootDepth, Porosity, FCap,
 				 SoilMap[y][x].TableDepth, Adjust);
 
 	    OutFlow = (OutFlow > AvailableWater) ? AvailableWater : OutFlow;
 
 	    /* remove water going to channel from the grid cell */
-	    SoilMap[y][x].SatFlow -= OutFlow;
+	    AddFlow(&(Options->Parallel), &(SoilMap[y][x].SatFlow), y, x, y, x,
+		    0, -OutFlow);
 
 	    /* contribute to channel segment lateral inflow */
 	    channel_grid_inc_inflow(ChannelData->stream_map, x, y,
@@ -350,6 +440,10 @@ void RouteSubSurface(int Dt, MAPSIZE *Map, TOPOPIX **TopoMap,
     }
   }
 
+  /* add the flows across the partition boundaries of an MPI run */
+  ExchangeFlow(&(Options->Parallel), SoilMap, offsetof(SOILPIX, SatFlow));
+  ExchangeInflow(&(Options->Parallel));
+
  for(i=0; i<Map->NY; i++) { 
     free(SubTotalDir[i]);
     free(SubFlowGrad[i]);
@@ -361,6 +455,8 @@ void RouteSubSurface(int Dt, MAPSIZE *Map, TOPOPIX **TopoMap,
   free(SubDir);
   free(SubTotalDir);
   free(SubFlowGrad);
+  free(TransBuffer);
+  free(TransSlot);
 
   /**********************************************************************/
   /* Dump saturation extent file to screen for Mass Wasting dates.
@@ -371,26 +467,33 @@ void RouteSubSurface(int Dt, MAPSIZE *Map, TOPOPIX **TopoMap,
   totalcount = 0;
   for (y = 0; y < Map->NY; y++) {
     for (x = 0; x < Map->NX; x++) {
-      if (INBASIN(TopoMap[y][x].Mask)) {
-	mgrid = (SoilMap[y][x].Depth - SoilMap[y][x].TableDepth)/SoilMap[y][x].Depth;
+      if (INBASIN(TopoMap[y][x].Mask) && ISOWNED(Options->Parallel, y, x)) {
+	mgrid = (SOILDEPTH(SoilMap[y][x]) - SoilMap[y][x].TableDepth)/SOILDEPTH(SoilMap[y][x]);
 	if(mgrid > MTHRESH) count += 1;
 	totalcount +=1;
       }
     }
   }
+  Counts[0] = count;
+  Counts[1] = totalcount;
+  SumOverRanks(&(Options->Parallel), Counts, 2);
+  count = (int) Counts[0];
+  totalcount = (int) Counts[1];
  
   sat = 100.*((float)count/(float)totalcount);
   
-  sprintf(satoutfile, "%ssaturation_extent.txt", DumpPath);
+  if (!Options->Spinup.Active && Options->Parallel.Rank == 0) {
+    sprintf(satoutfile, "%ssaturation_extent.txt", DumpPath);
   
-  if((fs=fopen(satoutfile,"a")) == NULL){
-    printf("Cannot open saturation extent output file.\n");
-    exit(0);
-  }
+    if((fs=fopen(satoutfile,"a")) == NULL){
+      printf("Cannot open saturation extent output file.\n");
+      exit(0);
+    }
   
-  SPrintDate(&(Time->Current), buffer);
-  fprintf(fs, "%-20s %.4f \n", buffer, sat); 
-  fclose(fs);    
+    SPrintDate(&(Time->Current), buffer);
+    fprintf(fs, "%-20s %.4f \n", buffer, sat); 
+    fclose(fs);    
+  }
   
   /* Initialize the mass wasting variables for all time steps
      to maintain the mass balance */
@@ -416,8 +519,10 @@ void RouteSubSurface(int Dt, MAPSIZE *Map, TOPOPIX **TopoMap,
     if(Options->MassWaste){
       if(Time->NMWMTotalSteps > 0){
 	if(Time->Current.Julian == Time->MWMnext.Julian){   
+	  PROFILE_START(PROF_MASSWASTING);
 	  MainMWM(SedMap, FineMap, VType, SedType, ChannelData, DumpPath, SoilMap,
 		  Time, Map, TopoMap, SType, VegMap, MaxStreamID, SnowMap);
+	  PROFILE_STOP(PROF_MASSWASTING);
 	  
 	  /* catch the next date */
 	  for (i = 0; i < Time->NMWMTotalSteps; i++){
@@ -430,8 +535,10 @@ void RouteSubSurface(int Dt, MAPSIZE *Map, TOPOPIX **TopoMap,
       }
       else{ /* Time->NMWMTotalSteps == 0 run the old way*/
 	if((float)count/((float)totalcount) > SATPERCENT) {
+	  PROFILE_START(PROF_MASSWASTING);
 	  MainMWM(SedMap, FineMap, VType, SedType, ChannelData, DumpPath, SoilMap,
 		  Time, Map, TopoMap, SType, VegMap, MaxStreamID, SnowMap);
+	  PROFILE_STOP(PROF_MASSWASTING);
 	}
       }
     }
@@ -9,6 +9,7 @@
  * DESCRIPTION:  Route surface flow
  * DESCRIP-END.
  * FUNCTIONS:    RouteSurface()
+ *               RouteCellOrder()
  * Modification: Changes are made to exclude the impervious channel cell (with 
                  a non-zero impervious fraction) from surface routing. In the original
   			 code, some impervious channel cells are routed to themselves causing 
@@ -17,6 +18,7 @@
  * $Id: RouteSurface.c, v 3.1.1  2013/1/7   Ning Exp $  
  */
 #include <assert.h>
+#include <stddef.h>
 #include <stdio.h>
 #include <math.h>
 #include <stdlib.h>
@@ -26,6 +28,13 @@
 #include "DHSVMerror.h"
 #include "functions.h"
 #include "constants.h"
+#include "profile.h"
+#include "params.h"
+#include "order.h"
+
+static void RouteCellOrder(CELLORDER *Order, MAPSIZE *Map, TIMESTRUCT *Time,
+			   float VariableDT);
+
 /*****************************************************************************
   RouteSurface()
 
@@ -49,8 +58,8 @@ void RouteSurface(MAPSIZE * Map, TIMESTRUCT * Time, TOPOPIX ** TopoMap,
 		  UNITHYDR ** UnitHydrograph,
 		  UNITHYDRINFO * HydrographInfo, float *Hydrograph,
 		  DUMPSTRUCT *Dump, VEGPIX ** VegMap, VEGTABLE * VType, 
-		  SOILTABLE *SType, CHANNEL *ChannelData, SEDPIX **SedMap,
-		  PRECIPPIX **PrecipMap, SEDTABLE *SedType,
+		  SOILTABLE *SType, PARAMMAP *Params, CHANNEL *ChannelData,
+		  SEDPIX **SedMap, PRECIPPIX **PrecipMap, SEDTABLE *SedType,
 		  float Tair, float Rh, float *SedDiams)
 {
   const char *Routine = "RouteSurface";
@@ -61,8 +70,12 @@ void RouteSurface(MAPSIZE * Map, TIMESTRUCT * Time, TOPOPIX ** TopoMap,
   int WaveLength;
   TIMESTRUCT NextTime;
   TIMESTRUCT VariableTime;
-  int i, j, x, y, n, k;         /* Counters */
+  int i, j, x, y, n;            /* Counters */
+  long k;                       /* Index in Map->OrderedCells */
   float **Runon;                /* (m3/s) */
+  float ImpervFrac;             /* Parameters of the pixel, from the */
+  float DetentionFrac;          /* parameter maps or the type tables */
+  float DetentionDecay;
 
   /*************************** Kinematic wave routing**************************************** */
   float knviscosity;           /* kinematic viscosity JSL */  
@@ -130,22 +143,39 @@ void RouteSurface(MAPSIZE * Map, TIMESTRUCT * Time, TOPOPIX ** TopoMap,
 		        }
 			 }
 	   } 
+	   /* in an MPI run only the pixels of this rank */
 	   for (y = 0; y < Map->NY; y++) {
 		   for (x = 0; x < Map->NX; x++) {
-			   if (INBASIN(TopoMap[y][x].Mask)) {
+			   if (INBASIN(TopoMap[y][x].Mask) && ISOWNED(Options->Parallel, y, x)) {
 				   if (!channel_grid_has_channel(ChannelData->stream_map, x, y)) {
-					   if (VType[VegMap[y][x].Veg - 1].ImpervFrac > 0.0) {
+					   /* parameters of the pixel, see params.h */
+					   if (Params->Active) {
+						   ImpervFrac = Params->ImpervFrac[PARAMINDEX(Params, y, x)];
+						   DetentionFrac = Params->DetentionFrac[PARAMINDEX(Params, y, x)];
+						   DetentionDecay = Params->DetentionDecay[PARAMINDEX(Params, y, x)];
+					   }
+					   else {
+						   ImpervFrac = VType[VegMap[y][x].Veg - 1].ImpervFrac;
+						   DetentionFrac = VType[VegMap[y][x].Veg - 1].DetentionFrac;
+						   DetentionDecay = VType[VegMap[y][x].Veg - 1].DetentionDecay;
+					   }
+					   if (ImpervFrac > 0.0) {
 						   /* Calculate the outflow from impervious portion of urban cell straight to nearest channel cell */		
-					       SoilMap[TopoMap[y][x].drains_y][TopoMap[y][x].drains_x].IExcess += 
-							   (1 - VType[VegMap[y][x].Veg - 1].DetentionFrac) * 
-							   VType[VegMap[y][x].Veg - 1].ImpervFrac * SoilMap[y][x].Runoff;
+					       AddFlow(&(Options->Parallel),
+						       &(SoilMap[TopoMap[y][x].drains_y][TopoMap[y][x].drains_x].IExcess),
+						       TopoMap[y][x].drains_y, TopoMap[y][x].drains_x, y, x, 0,
+							   (1 - DetentionFrac) * 
+							   ImpervFrac * SoilMap[y][x].Runoff);
 						   /* Retained water in detention storage */
-						   SoilMap[y][x].DetentionIn = VType[VegMap[y][x].Veg - 1].DetentionFrac * 
-							   VType[VegMap[y][x].Veg - 1].ImpervFrac * SoilMap[y][x].Runoff;		
+						   SoilMap[y][x].DetentionIn = DetentionFrac * 
+							   ImpervFrac * SoilMap[y][x].Runoff;		
 						   /* Retained water in Detention storage routed to channel */   
 					       SoilMap[y][x].DetentionStorage += SoilMap[y][x].DetentionIn;
-					       SoilMap[y][x].DetentionOut = SoilMap[y][x].DetentionStorage * VType[VegMap[y][x].Veg - 1].DetentionDecay;
-					       SoilMap[TopoMap[y][x].drains_y][TopoMap[y][x].drains_x].IExcess += SoilMap[y][x].DetentionOut;
+					       SoilMap[y][x].DetentionOut = SoilMap[y][x].DetentionStorage * DetentionDecay;
+					       AddFlow(&(Options->Parallel),
+						       &(SoilMap[TopoMap[y][x].drains_y][TopoMap[y][x].drains_x].IExcess),
+						       TopoMap[y][x].drains_y, TopoMap[y][x].drains_x, y, x, 1,
+						       SoilMap[y][x].DetentionOut);
 					       SoilMap[y][x].DetentionStorage -= SoilMap[y][x].DetentionOut;
 					       if (SoilMap[y][x].DetentionStorage < 0.0) 
 						       SoilMap[y][x].DetentionStorage = 0.0;
@@ -154,8 +184,9 @@ void RouteSurface(MAPSIZE * Map, TIMESTRUCT * Time, TOPOPIX ** TopoMap,
 								int xn = x + xdirection[n];
 								int yn = y + ydirection[n];
 								if (valid_cell(Map, xn, yn)) {
-									SoilMap[yn][xn].IExcess += (1 - VType[VegMap[y][x].Veg - 1].ImpervFrac) * SoilMap[y][x].Runoff 
-										*((float) TopoMap[y][x].Dir[n] /(float) TopoMap[y][x].TotalDir);
+									AddFlow(&(Options->Parallel), &(SoilMap[yn][xn].IExcess), yn, xn, y, x, 2,
+										(1 - ImpervFrac) * SoilMap[y][x].Runoff 
+										*((float) TopoMap[y][x].Dir[n] /(float) TopoMap[y][x].TotalDir));
 								}
 						   }
 					   }
@@ -164,30 +195,40 @@ void RouteSurface(MAPSIZE * Map, TIMESTRUCT * Time, TOPOPIX ** TopoMap,
 						int xn = x + xdirection[n];
 						int yn = y + ydirection[n];
 					    if (valid_cell(Map, xn, yn)) {
-							SoilMap[yn][xn].IExcess += SoilMap[y][x].Runoff *((float)TopoMap[y][x].Dir[n]/(float)TopoMap[y][x].TotalDir);
+							AddFlow(&(Options->Parallel), &(SoilMap[yn][xn].IExcess), yn, xn, y, x, 2,
+								SoilMap[y][x].Runoff *((float)TopoMap[y][x].Dir[n]/(float)TopoMap[y][x].TotalDir));
 						}
 					}
 				  }
 			   }
 			   else if (channel_grid_has_channel(ChannelData->stream_map, x, y)){
-				   SoilMap[y][x].IExcess += SoilMap[y][x].Runoff;}
+				   AddFlow(&(Options->Parallel), &(SoilMap[y][x].IExcess), y, x, y, x, 0,
+					   SoilMap[y][x].Runoff);}
 			 }
 		  }
 	   }
+	   /* add the flows across the partition boundaries of an MPI run */
+	   ExchangeFlow(&(Options->Parallel), SoilMap, offsetof(SOILPIX, IExcess));
 }/* end if Options->routing = conventional */
 /***********************************************************************************************************************/ 
 else {/* Begin code for kinematic wave routing. */ 
-	NextTime = *Time;
 	VariableTime = *Time;
       
 	/* Holds the value of the next DHSVM time step. */ 
-	IncreaseTime(&NextTime);
+	StepEndTime(&(Options->Adaptive), Time, &NextTime);
       
     /* Use the Courant condition to find the maximum stable time step (in seconds). Must be an even increment of Dt. */
-    VariableDT = FindDT(SoilMap, Map, Time, TopoMap, SType); 
+    VariableDT = FindDT(SoilMap, Map, Time, TopoMap, SType,
+			&(Options->Parallel)); 
+    PROFILE_COUNT(PROF_KINEMATICSTEPS, floor(Time->Dt / VariableDT + 0.5));
       
+	/* the routing state in the storage order of Map->CellOrder, see
+	   order.h */
+	if (Map->CellOrder)
+		LoadCellOrder(Map->CellOrder, SoilMap);
+
 	/*Numcells = cells in the basin*/
-    for (k = 0; k < Map->NumCells; k++) {
+    for (k = 0; k < Map->NumCells && !Map->CellOrder; k++) {
 		y = Map->OrderedCells[k].y;
 		x = Map->OrderedCells[k].x;
 		SoilMap[y][x].Runoff = 0.;		  
@@ -202,21 +243,33 @@ else {/* Begin code for kinematic wave routing. */
     /* converting units to m2/sec */
     knviscosity /= 1000. * 1000.;
 	
+	/* the runon across the partition boundaries of an MPI run */
+	ResetRunon(&(Options->Parallel));
+
 	/* Must loop through surface routing multiple times within one DHSVM  model time step. */
 	while (Before(&(VariableTime.Current), &(NextTime.Current))) {
+		if (Map->CellOrder) {
+			RouteCellOrder(Map->CellOrder, Map, Time, VariableDT);
+			IncreaseVariableTime(&VariableTime, VariableDT, &NextTime);
+			continue;
+		}
 		/* Loop thru all of the cells in descending order of elevation */
 		for (k = (Map->NumCells)-1; k >-1;  k--) {
 			y = Map->OrderedCells[k].y;
 			x = Map->OrderedCells[k].x;
+			GetRunon(&(Options->Parallel), Runon, y, x);
 			outflow = SoilMap[y][x].startRunoff;   
-			slope = TopoMap[y][x].Slope;
+			slope = TOPOSLOPE(TopoMap[y][x]);
 			if (slope == 0) slope=0.0001;
 			else if (slope < 0) {
 				printf("negative slope in RouteSurface.c\n");
 				exit(0);
 			}
 			beta = 3./5.;
-			alpha = pow(SType[SoilMap[y][x].Soil-1].Manning* pow((double)Map->DX,2./3.)/sqrt(slope),beta);
+			if (Params->Active)
+				alpha = Params->Alpha[PARAMINDEX(Params, y, x)];
+			else
+				alpha = pow(SType[SoilMap[y][x].Soil-1].Manning* pow((double)Map->DX,2./3.)/sqrt(slope),beta);
 			
 			/* Calculate discharge (m3/s) from the grid cell using an explicit 
 			  finite difference solution of the linear kinematic wave. */
@@ -401,8 +454,9 @@ else {/* Begin code for kinematic wave routing. */
 			  }	  
 			  
 			  /********************************************************************************************************/
-			  /* Redistribute surface water to downslope pixels. */
-			  if(outflow > 0.) {  
+			  /* Redistribute surface water to downslope pixels.  An MPI
+			     run passes on the runon to every neighbor, see AddRunon() */
+			  if(outflow > 0. || Options->Parallel.Active) {  
 				  for (n = 0; n < NDIRS; n++) {
 					  int xn = x + xdirection[n];
 					  int yn = y + ydirection[n];
@@ -410,7 +464,8 @@ else {/* Begin code for kinematic wave routing. */
 					  /* If a channel cell runoff does not go to downslope pixels. */
 					  if (valid_cell(Map, xn, yn)) {
 						  if (INBASIN(TopoMap[yn][xn].Mask)) {
-							  Runon[yn][xn] += outflow * ((float) TopoMap[y][x].Dir[n]/(float) TopoMap[y][x].TotalDir);
+							  AddRunon(&(Options->Parallel), Runon, yn, xn, y, x,
+								  (outflow > 0.) ? outflow * ((float) TopoMap[y][x].Dir[n]/(float) TopoMap[y][x].TotalDir) : 0.);
 							  
 							  /* No need to distribute sediment if there isn't any*/
 							  if((Options->SurfaceErosion)&&(SedOut > 0.)){ 	
@@ -429,6 +484,9 @@ else {/* Begin code for kinematic wave routing. */
 				  SedIn[y][x] = 0.0;
 } /* end loop thru ordered basin cells */
 
+/* the runon of this sub-step across the partition boundaries */
+ExchangeRunon(&(Options->Parallel));
+
 /* Increases time by VariableDT. */
 
 
@@ -436,6 +494,8 @@ IncreaseVariableTime(&VariableTime, VariableDT, &NextTime);
 
 /*************************************************************/
 } /* End of internal time step loop. */
+	if (Map->CellOrder)
+		StoreCellOrder(Map->CellOrder, SoilMap);
 }/* End of code added for kinematic wave routing. */
     
 if(Options->SurfaceErosion) {
@@ -485,18 +545,98 @@ else {			/* No network, so use unit hydrograph method */
   for (i = 0; i < Time->Dt; i++)
       Hydrograph[HydrographInfo->TotalWaveLength - (i + 1)] = 0.0;
     
-  PrintDate(&(Time->Current), Dump->Stream.FilePtr);
-  fprintf(Dump->Stream.FilePtr, " %g\n", StreamFlow);
+  if (!Options->Spinup.Active) {
+    PrintDate(&(Time->Current), Dump->Stream.FilePtr);
+    fprintf(Dump->Stream.FilePtr, " %g\n", StreamFlow);
+  }
  }
 }
 
+/*****************************************************************************
+  RouteCellOrder()
+
+  One sub-step of the kinematic wave routing in the storage order of
+  Map->CellOrder, see order.h.  The same explicit finite difference
+  solution as the loop over Map->OrderedCells in RouteSurface(), without
+  the hillslope sediment routing, on the ordered arrays
+*****************************************************************************/
+static void RouteCellOrder(CELLORDER *Order, MAPSIZE *Map, TIMESTRUCT *Time,
+			   float VariableDT)
+{
+  double alpha, beta;		/* Kinematic wave coefficient and exponent */
+  double outflow;		/* Outflow of the pixel (m3/s) */
+  double sedoutflow;		/* Outflow for the sediment routing (m3/s) */
+  float Runon;			/* Inflow of the pixel (m3/s) */
+  long e;			/* index in Order->Down */
+  long i;			/* counter */
+  long k;			/* index in Order->Cells */
+
+  beta = 3./5.;
+  for (i = 0; i < Order->NCells; i++) {
+    k = Order->Route[i];
+    outflow = Order->StartRunoff[k];
+    alpha = Order->Alpha[k];
+    Runon = Order->Runon[k];
+
+    if (Runon > 0.0001 || outflow > 0.0001) {
+      outflow = ((VariableDT/Map->DX)*Runon + alpha*beta*outflow *
+		 pow((outflow+Runon)/2.0,beta-1.) +
+		 Order->IExcess[k]*Map->DX*VariableDT/Time->Dt)/
+	((VariableDT/Map->DX) + alpha*beta*pow((outflow+Runon)/2.0, beta-1.));
+    }
+    else if (Order->IExcess[k] > 0.0)
+      outflow = Order->IExcess[k]*Map->DX*Map->DY/Time->Dt;
+    else
+      outflow = 0.0;
+    if (outflow < 0.0)
+      outflow = 0.0;
+
+    sedoutflow = outflow;
+    if (Order->Channel[k]) {
+      if (Runon > 0.0001 || outflow > 0.0001) {
+	sedoutflow = ((VariableDT/Map->DX)*Runon + alpha*beta*outflow *
+		      pow((outflow+Runon)/2.0,beta-1.) +
+		      (Order->IExcessSed[k])*Map->DX*VariableDT/Time->Dt)/
+	  ((VariableDT/Map->DX) + alpha*beta*pow((outflow+Runon)/2.0,
+						 beta-1.));
+      }
+      else if (Order->IExcessSed[k] > 0.0)
+	sedoutflow = Order->IExcessSed[k]*Map->DX*Map->DY/Time->Dt;
+      else
+	sedoutflow = 0.0;
+      if (sedoutflow < 0.0)
+	sedoutflow = 0.0;
+      outflow = 0.0;
+      if (sedoutflow > (Order->IExcessSed[k]*(Map->DX*Map->DY)/Time->Dt +
+			Runon))
+	sedoutflow = Order->IExcessSed[k]*(Map->DX*Map->DY)/Time->Dt + (Runon);
+      Order->IExcessSed[k] += (Runon - sedoutflow)* VariableDT/
+	(Map->DX*Map->DY);
+    }
+    if (outflow > (Order->IExcess[k]*(Map->DX*Map->DY)/Time->Dt + Runon))
+      outflow = Order->IExcess[k]*(Map->DX*Map->DY)/Time->Dt + (Runon);
+    Order->IExcess[k] += (Runon - outflow)* VariableDT/(Map->DX*Map->DY);
+
+    Order->StartRunoff[k] = sedoutflow;
+    Order->StartRunon[k] = Runon;
+    Order->Runoff[k] += sedoutflow*VariableDT/(Map->DX*Map->DY);
+
+    /* a pixel with a channel has no neighbors in Order->Down */
+    if (outflow > 0.) {
+      for (e = Order->First[k]; e < Order->First[k + 1]; e++)
+	Order->Runon[Order->Down[e]] += outflow * Order->Frac[e];
+    }
+    Order->Runon[k] = 0.0;
+  }
+}
+
 /*****************************************************************************
   FindDT()
   Find the variable time step that will satisfy the courant condition for stability 
   in overland flow routing.
 *****************************************************************************/
 float FindDT(SOILPIX **SoilMap, MAPSIZE *Map, TIMESTRUCT *Time, 
-	     TOPOPIX **TopoMap, SOILTABLE *SType)
+	     TOPOPIX **TopoMap, SOILTABLE *SType, PARALLELSTRUCT *Parallel)
 {
   int x, y;
   /* JSL: slope is manning's slope; alpha is channel parameter including wetted perimeter, 
@@ -512,9 +652,9 @@ float FindDT(SOILPIX **SoilMap, MAPSIZE *Map, TIMESTRUCT *Time,
   
   for (y = 0; y < Map->NY; y++) {
     for (x = 0; x < Map->NX; x++) {
-      if (INBASIN(TopoMap[y][x].Mask)) {
+      if (INBASIN(TopoMap[y][x].Mask) && ISOWNED(*Parallel, y, x)) {
 		  if (SoilMap[y][x].Runoff >0.0){
-			  slope = TopoMap[y][x].Slope;
+			  slope = TOPOSLOPE(TopoMap[y][x]);
 			  if (slope <= 0) slope = 0.0001;
 			  beta = 3./5.;
 			  alpha = pow((double)SType[SoilMap[y][x].Soil-1].Manning *pow((double)Map->DX,(double)(2./3.))/sqrt(slope), (double)beta);
@@ -529,6 +669,9 @@ float FindDT(SOILPIX **SoilMap, MAPSIZE *Map, TIMESTRUCT *Time,
       }
     }
   }
+  /* the same time step on all ranks of an MPI run */
+  MinOverRanks(Parallel, &minDT, 1);
+
   /* Find the time step that divides evenly into Time->DT */
   
   numinc = (float) ceil((double)Time->Dt/minDT);
@@ -14,14 +14,17 @@
  * $Id: SatVaporPressure.c,v 1.4 2003/07/01 21:26:23 olivier Exp $     
  */
 
+#include <pthread.h>
 #include <stdlib.h>
 #include <math.h>
 #include "lookuptable.h"
 
 float CalcVaporPressure(float T);
+static void MakeSatVaporTable(void);
 static FLOATTABLE svp;		/* Table that contains saturated vapor 
 				   pressures as a function of temperature 
 				   in degrees C */
+static pthread_once_t svpOnce = PTHREAD_ONCE_INIT;	/* Makes svp once */
 
 /*****************************************************************************
   Function name: InitSatVaporTable()
@@ -35,9 +38,20 @@ static FLOATTABLE svp;		/* Table that contains saturated vapor
 
   Modifies     : none
   
-  Comments     :  Table runs from -100 C to 100 C with an interval of 0.02 C
+  Comments     :  Table runs from -100 C to 100 C with an interval of 0.02 C.
+                  The table is the same for every model instance, it is
+                  made by the first call only, so that instances that are
+                  initialized while others run do not replace it
 *****************************************************************************/
 void InitSatVaporTable(void)
+{
+  pthread_once(&svpOnce, MakeSatVaporTable);
+}
+
+/*****************************************************************************
+  MakeSatVaporTable()
+*****************************************************************************/
+static void MakeSatVaporTable(void)
 {
   InitFloatTable(10000L, -100., .02, CalcVaporPressure, &svp);
 }
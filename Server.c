@@ -0,0 +1,665 @@
+/*
+ * SUMMARY:      Server.c - Forecast server
+ * USAGE:        Part of DHSVM
+ *
+ * AUTHOR:       DHSVM development team
+ * ORG:          University of Washington, Department of Civil Engineering
+ * E-MAIL:
+ * ORIG-DATE:    Oct-2026
+ * DESCRIPTION:  Keeps the initialized model in memory and runs it on request.
+ *               Requests are read from a Unix domain socket, one line per
+ *               request, and each request is answered with one line that
+ *               starts with OK or ERROR.  The requests are:
+ *
+ *                 LOAD <date> [<state directory>]
+ *                   read the model state for <date> and set the model time
+ *                   to <date>.  The default directory is the INITIAL STATE
+ *                   directory of the input file
+ *                 ADVANCE <date> [<forcing directory>]
+ *                   run the model up to and including the time step that
+ *                   starts at <date>.  If a forcing directory is given, the
+ *                   met station files are read from that directory, using
+ *                   the file names of the input file.  The request is
+ *                   refused if a met station file has no record for one of
+ *                   the time steps
+ *                 SNAPSHOT [<directory>]
+ *                   copy the model state at the current model time in
+ *                   memory, store it in the state files of <directory> as
+ *                   well and flush all output files.  The default directory
+ *                   is the subdirectory snapshot of the output directory
+ *                 RESTORE
+ *                   go back to the copy in memory of the last SNAPSHOT.
+ *                   The model continues as if it had not run past the
+ *                   snapshot, with the same basin totals and mass balance
+ *                 QUIT
+ *                   end the model run
+ *
+ *               The reply to LOAD, ADVANCE, SNAPSHOT and RESTORE contains
+ *               the model time after the request.  Only met station forcing
+ *               can be served, MM5 input and radar precipitation are
+ *               rejected when the options are read.
+ *
+ *               The state files do not hold the complete model state (the
+ *               canopy temperature, the interception and kinematic wave
+ *               terms and the sediment state are missing), so a run started
+ *               with LOAD from the files of a SNAPSHOT is a cold restart and
+ *               drifts from the run that continued.  RESTORE uses the copy
+ *               in memory and does not.
+ * DESCRIP-END.
+ * FUNCTIONS:    InitServer()
+ *               ServeRequests()
+ *               EndServer()
+ * COMMENTS:
+ * $Id: Server.c,v 1.0 2026/10/17 Exp $
+ */
+
+#include <errno.h>
+#include <signal.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "settings.h"
+#include "data.h"
+#include "constants.h"
+#include "DHSVMerror.h"
+#include "fileio.h"
+#include "functions.h"
+#include "server.h"
+
+static int ReadRequest(SERVERSTRUCT *Server, char *Line);
+static void SendReply(SERVERSTRUCT *Server, const char *Format, ...);
+static void DirectoryPath(char *Path);
+static int HasModelState(DATE *Date, char *Path);
+static void LoadModelState(SERVERSTATE *State, DATE *Date, char *Path);
+static void CopyModelState(SERVERSTATE *State, int Store);
+static void CopyBytes(SNAPSHOTBUFFER *Snapshot, void *Data, size_t Size,
+		      int Store);
+static void RewindForcing(SERVERSTATE *State);
+static int OpenForcing(SERVERSTATE *State, char *Path, char *Failed);
+static int HasMetRecords(FILE *MetFile, DATE *Start, DATE *End, int Dt);
+
+/*****************************************************************************
+  Function name: InitServer()
+
+  Purpose      : Create the socket on which the forecast server listens
+
+  Required     :
+    SERVERSTRUCT *Server - Server->SocketPath holds the name of the socket
+
+  Returns      : void
+
+  Modifies     : Server
+
+  Comments     : An existing file with the name of the socket is removed.
+                 SIGPIPE is ignored, so that a client that disconnects
+                 before it has received its reply does not end the model
+                 run.
+*****************************************************************************/
+void InitServer(SERVERSTRUCT *Server)
+{
+  struct sockaddr_un Address;
+
+  if (strlen(Server->SocketPath) >= sizeof(Address.sun_path))
+    ReportError(Server->SocketPath, 82);
+
+  memset(&Address, 0, sizeof(Address));
+  Address.sun_family = AF_UNIX;
+  strcpy(Address.sun_path, Server->SocketPath);
+  unlink(Server->SocketPath);
+
+  Server->ListenSocket = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (Server->ListenSocket < 0 ||
+      bind(Server->ListenSocket, (struct sockaddr *) &Address,
+	   sizeof(Address)) != 0 || listen(Server->ListenSocket, 1) != 0)
+    ReportError(Server->SocketPath, 82);
+
+  signal(SIGPIPE, SIG_IGN);
+
+  Server->In = NULL;
+  Server->Out = NULL;
+  Server->Advancing = FALSE;
+  Server->Restart = FALSE;
+  Server->Restored = FALSE;
+  Server->HasSnapshot = FALSE;
+
+  printf("Forecast server listening on %s\n", Server->SocketPath);
+}
+
+/*****************************************************************************
+  Function name: ServeRequests()
+
+  Purpose      : Decide whether the model simulates the current time step,
+                 and handle the requests of the clients when it does not
+
+  Required     :
+    SERVERSTATE *State - Pointers to the model structures
+
+  Returns      : int - TRUE if the time step that starts at
+                       State->Time->Current is to be simulated, FALSE if the
+                       model run ends
+
+  Modifies     : the model state, State->Time, State->Options->Server, the
+                 met file positions
+
+  Comments     : While an ADVANCE request is running this returns TRUE
+                 until the end date of the request has been simulated.  It
+                 then replies to the request and waits for the next one.
+                 Requests are handled one connection at a time.  After a LOAD
+                 or RESTORE request Server->Restart is set, and the main
+                 program restarts the month and day, and after a LOAD the
+                 mass balance.
+*****************************************************************************/
+int ServeRequests(SERVERSTATE *State)
+{
+  SERVERSTRUCT *Server = &(State->Options->Server);
+  TIMESTRUCT *Time = State->Time;
+  char Line[BUFSIZE + 1];
+  char Command[BUFSIZE + 1];
+  char Argument[BUFSIZE + 1];
+  char Path[BUFSIZE + 1];
+  char DateStr[BUFSIZE + 1];
+  char Failed[BUFSIZE + 1];
+  DATE Date;
+  int NArgs;
+  int i;
+
+  if (Server->Advancing) {
+    if (!After(&(Time->Current), &(Time->End)))
+      return TRUE;
+    Server->Advancing = FALSE;
+    fflush(NULL);
+    SPrintDate(&(Time->Current), DateStr);
+    SendReply(Server, "OK %s", DateStr);
+  }
+
+  while (TRUE) {
+    if (!ReadRequest(Server, Line))
+      continue;
+
+    NArgs = sscanf(Line, "%s %s %s", Command, Argument, Path);
+    if (NArgs < 1)
+      continue;
+
+    if (strcmp(Command, "LOAD") == 0) {
+      if (NArgs < 2 || !SScanDate(Argument, &Date)) {
+	SendReply(Server, "ERROR LOAD needs a date");
+	continue;
+      }
+      if (NArgs < 3)
+	strcpy(Path, State->Dump->InitStatePath);
+      DirectoryPath(Path);
+      if (!HasModelState(&Date, Path)) {
+	SendReply(Server, "ERROR No model state for %s in %s", Argument,
+		  Path);
+	continue;
+      }
+      LoadModelState(State, &Date, Path);
+      SPrintDate(&(Time->Current), DateStr);
+      SendReply(Server, "OK %s", DateStr);
+    }
+
+    else if (strcmp(Command, "ADVANCE") == 0) {
+      if (NArgs < 2 || !SScanDate(Argument, &Date)) {
+	SendReply(Server, "ERROR ADVANCE needs a date");
+	continue;
+      }
+      InitTime(Time, NULL, &Date, NULL, NULL, Time->Dt);
+      if (Before(&(Time->End), &(Time->Current))) {
+	SPrintDate(&(Time->Current), DateStr);
+	SendReply(Server, "ERROR %s is before the model time %s", Argument,
+		  DateStr);
+	continue;
+      }
+      if (NArgs == 3) {
+	DirectoryPath(Path);
+	if (!OpenForcing(State, Path, Failed)) {
+	  SendReply(Server, "ERROR Cannot read met data up to %s from %s",
+		    Argument, Failed);
+	  continue;
+	}
+      }
+      else {
+	for (i = 0; i < State->NStats; i++)
+	  if (!HasMetRecords(State->Stat[i].MetFile.FilePtr, &(Time->Current),
+			     &(Time->End), Time->Dt))
+	    break;
+	if (i < State->NStats) {
+	  SendReply(Server, "ERROR Cannot read met data up to %s from %s",
+		    Argument, State->Stat[i].MetFile.FileName);
+	  continue;
+	}
+      }
+      Server->Advancing = TRUE;
+      return TRUE;
+    }
+
+    else if (strcmp(Command, "SNAPSHOT") == 0) {
+      if (NArgs < 2) {
+	if (snprintf(Path, BUFSIZE + 1, "%ssnapshot", State->Dump->Path) >
+	    BUFSIZE) {
+	  SendReply(Server, "ERROR Output directory name too long");
+	  continue;
+	}
+      }
+      else
+	strcpy(Path, Argument);
+      if (mkdir(Path, 0755) != 0 && errno != EEXIST) {
+	SendReply(Server, "ERROR Cannot create directory %s", Path);
+	continue;
+      }
+      DirectoryPath(Path);
+      StoreModelState(Path, &(Time->Current), State->Map, State->Options,
+		      State->TopoMap, State->PrecipMap, State->SnowMap,
+		      State->MetMap, State->RadMap, State->VegMap, State->Veg,
+		      State->SoilMap, State->Soil, State->Network,
+		      State->HydrographInfo, State->Hydrograph,
+		      State->ChannelData);
+      if (State->Options->HasNetwork)
+	StoreChannelState(Path, &(Time->Current),
+			  State->ChannelData->streams);
+      CopyModelState(State, TRUE);
+      fflush(NULL);
+      Server->HasSnapshot = TRUE;
+      CopyDate(&(Server->Snapshot), &(Time->Current));
+      strcpy(Server->SnapshotPath, Path);
+      SPrintDate(&(Time->Current), DateStr);
+      SendReply(Server, "OK %s %s", DateStr, Path);
+    }
+
+    else if (strcmp(Command, "RESTORE") == 0) {
+      if (!Server->HasSnapshot) {
+	SendReply(Server, "ERROR No snapshot has been taken");
+	continue;
+      }
+      CopyModelState(State, FALSE);
+      RewindForcing(State);
+      Server->Restart = TRUE;
+      Server->Restored = TRUE;
+      SPrintDate(&(Time->Current), DateStr);
+      SendReply(Server, "OK %s", DateStr);
+    }
+
+    else if (strcmp(Command, "QUIT") == 0) {
+      SendReply(Server, "OK");
+      fclose(Server->In);
+      fclose(Server->Out);
+      Server->In = NULL;
+      Server->Out = NULL;
+      close(Server->ListenSocket);
+      unlink(Server->SocketPath);
+      return FALSE;
+    }
+
+    else
+      SendReply(Server, "ERROR Unknown request %s", Command);
+  }
+}
+
+/*****************************************************************************
+  Function name: EndServer()
+
+  Purpose      : Free the snapshot of the model state
+
+  Required     :
+    SERVERSTATE *State - Pointers to the model structures
+
+  Returns      : void
+
+  Modifies     : State->Snapshot
+*****************************************************************************/
+void EndServer(SERVERSTATE *State)
+{
+  free(State->Snapshot.Buffer);
+  State->Snapshot.Buffer = NULL;
+  State->Snapshot.Size = 0;
+}
+
+/*****************************************************************************
+  ReadRequest()
+
+  Waits for a client if there is none, and reads the next request.  Returns
+  FALSE if the client has closed the connection.
+*****************************************************************************/
+static int ReadRequest(SERVERSTRUCT *Server, char *Line)
+{
+  int Socket;
+
+  while (Server->In == NULL) {
+    Socket = accept(Server->ListenSocket, NULL, NULL);
+    if (Socket < 0) {
+      if (errno == EINTR)
+	continue;
+      ReportError(Server->SocketPath, 82);
+    }
+    if (!(Server->In = fdopen(Socket, "r")) ||
+	!(Server->Out = fdopen(dup(Socket), "w")))
+      ReportError(Server->SocketPath, 82);
+  }
+
+  if (fgets(Line, BUFSIZE + 1, Server->In) == NULL) {
+    fclose(Server->In);
+    fclose(Server->Out);
+    Server->In = NULL;
+    Server->Out = NULL;
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+/*****************************************************************************
+  SendReply()
+
+  Sends a one line reply to the current client, if there still is one
+*****************************************************************************/
+static void SendReply(SERVERSTRUCT *Server, const char *Format, ...)
+{
+  va_list Args;
+
+  if (Server->Out == NULL)
+    return;
+
+  va_start(Args, Format);
+  vfprintf(Server->Out, Format, Args);
+  va_end(Args);
+  fprintf(Server->Out, "\n");
+  fflush(Server->Out);
+}
+
+/*****************************************************************************
+  DirectoryPath()
+
+  Makes sure that a directory name ends with a '/', because the state file
+  names are appended to it
+*****************************************************************************/
+static void DirectoryPath(char *Path)
+{
+  int Length;
+
+  Length = strlen(Path);
+  if (Length > 0 && Length < BUFSIZE && Path[Length - 1] != '/')
+    strcat(Path, "/");
+}
+
+/*****************************************************************************
+  HasModelState()
+
+  Checks whether the soil state file for Date exists in Path, so that a
+  request for a missing state is answered with an error instead of ending
+  the model run
+*****************************************************************************/
+static int HasModelState(DATE *Date, char *Path)
+{
+  char FileName[BUFSIZE + 1];
+
+  snprintf(FileName, BUFSIZE + 1,
+	   "%sSoil.State.%02d.%02d.%02d.%02d.%02d.%02d%s", Path, Date->Month,
+	   Date->Day, Date->Year, Date->Hour, Date->Min, Date->Sec, fileext);
+
+  return (access(FileName, R_OK) == 0);
+}
+
+/*****************************************************************************
+  LoadModelState()
+
+  Reads the model state for Date from Path and sets the model time to Date.
+  The canopy temperature is not part of the stored state and is reset as at
+  the start of a model run.
+*****************************************************************************/
+static void LoadModelState(SERVERSTATE *State, DATE *Date, char *Path)
+{
+  TIMESTRUCT *Time = State->Time;
+  int x;
+  int y;
+
+  InitTime(Time, Date, Date, NULL, NULL, Time->Dt);
+
+  InitModelState(&(Time->Start), State->Map, State->Options,
+		 State->PrecipMap, State->SnowMap, State->SoilMap,
+		 *(State->Soil), State->SType, State->VegMap, *(State->Veg),
+		 State->VType, Path, State->SnowAlbedo, State->TopoMap,
+		 State->Network, State->HydrographInfo, State->Hydrograph);
+
+  if (State->Options->HasNetwork)
+    ReadChannelState(Path, &(Time->Start), State->ChannelData->streams);
+
+  for (y = 0; y < State->Map->NY; y++)
+    for (x = 0; x < State->Map->NX; x++)
+      State->VegMap[y][x].Tcanopy = 0.0;
+
+  RewindForcing(State);
+
+  State->Options->Server.Restart = TRUE;
+  State->Options->Server.Restored = FALSE;
+}
+
+/*****************************************************************************
+  CopyModelState()
+
+  Copies the model state to the snapshot in memory (Store is TRUE) or back
+  from it.  Everything that a time step carries over to the next one is
+  copied: the model time, the basin totals and mass balance, the pixel
+  structures with their layer arrays, the stream and road segments and the
+  unit hydrograph.  The structures are copied whole, pointers included, and
+  the arrays they point to after them.  The maps are never reallocated while
+  the server runs, so the pointers in the copy stay valid.  The buffer is
+  allocated at the first SNAPSHOT, after a pass that only counts its size.
+*****************************************************************************/
+static void CopyModelState(SERVERSTATE *State, int Store)
+{
+  SNAPSHOTBUFFER *Snapshot = &(State->Snapshot);
+  MAPSIZE *Map = State->Map;
+  Channel *Segment;
+  ROADSTRUCT *Road;
+  EVAPPIX *Evap;
+  int NSoil;
+  int NVeg;
+  int Pass;
+  int i;
+  int x;
+  int y;
+
+  for (Pass = (Snapshot->Buffer == NULL) ? 0 : 1; Pass < 2; Pass++) {
+    if (Pass == 1 && Snapshot->Buffer == NULL &&
+	!(Snapshot->Buffer = (unsigned char *) malloc(Snapshot->Size)))
+      ReportError("CopyModelState", 1);
+    Snapshot->Offset = 0;
+
+    CopyBytes(Snapshot, State->Time, sizeof(TIMESTRUCT), Store);
+    CopyBytes(Snapshot, State->Total, sizeof(AGGREGATED), Store);
+    CopyBytes(Snapshot, State->Mass, sizeof(WATERBALANCE), Store);
+
+    for (y = 0; y < Map->NY; y++) {
+      CopyBytes(Snapshot, State->TopoMap[y], Map->NX * sizeof(TOPOPIX),
+		Store);
+      CopyBytes(Snapshot, State->PrecipMap[y], Map->NX * sizeof(PRECIPPIX),
+		Store);
+      CopyBytes(Snapshot, State->SnowMap[y], Map->NX * sizeof(SNOWPIX),
+		Store);
+      CopyBytes(Snapshot, State->SoilMap[y], Map->NX * sizeof(SOILPIX),
+		Store);
+      CopyBytes(Snapshot, State->VegMap[y], Map->NX * sizeof(VEGPIX),
+		Store);
+      CopyBytes(Snapshot, State->EvapMap[y], Map->NX * sizeof(EVAPPIX),
+		Store);
+      CopyBytes(Snapshot, State->Network[y], Map->NX * sizeof(ROADSTRUCT),
+		Store);
+      if (State->SedMap != NULL)
+	CopyBytes(Snapshot, State->SedMap[y], Map->NX * sizeof(SEDPIX),
+		  Store);
+
+      for (x = 0; x < Map->NX; x++) {
+	if (!INBASIN(State->TopoMap[y][x].Mask))
+	  continue;
+	NVeg = State->Veg->NLayers[State->VegMap[y][x].Veg - 1];
+	NSoil = State->Soil->NLayers[State->SoilMap[y][x].Soil - 1];
+	CopyBytes(Snapshot, State->PrecipMap[y][x].IntRain,
+		  NVeg * sizeof(float), Store);
+	CopyBytes(Snapshot, State->PrecipMap[y][x].IntSnow,
+		  NVeg * sizeof(float), Store);
+	CopyBytes(Snapshot, State->SoilMap[y][x].Moist,
+		  (NSoil + 1) * sizeof(float), Store);
+	CopyBytes(Snapshot, State->SoilMap[y][x].Perc,
+		  NSoil * sizeof(float), Store);
+	CopyBytes(Snapshot, State->SoilMap[y][x].Temp,
+		  NSoil * sizeof(float), Store);
+	Evap = &(State->EvapMap[y][x]);
+	CopyBytes(Snapshot, Evap->EPot, (NVeg + 1) * sizeof(float), Store);
+	CopyBytes(Snapshot, Evap->EAct, (NVeg + 1) * sizeof(float), Store);
+	CopyBytes(Snapshot, Evap->EInt, NVeg * sizeof(float), Store);
+	for (i = 0; i < NVeg; i++)
+	  CopyBytes(Snapshot, Evap->ESoil[i], NSoil * sizeof(float), Store);
+	Road = &(State->Network[y][x]);
+	if (Road->h != NULL) {
+	  CopyBytes(Snapshot, Road->h, CELLFACTOR * sizeof(float), Store);
+	  CopyBytes(Snapshot, Road->startRunoff, CELLFACTOR * sizeof(float),
+		    Store);
+	  CopyBytes(Snapshot, Road->startRunon, CELLFACTOR * sizeof(float),
+		    Store);
+	  CopyBytes(Snapshot, Road->OldSedIn, CELLFACTOR * sizeof(float),
+		    Store);
+	  CopyBytes(Snapshot, Road->OldSedOut, CELLFACTOR * sizeof(float),
+		    Store);
+	}
+      }
+    }
+
+    if (State->FineMap != NULL)
+      for (y = 0; y < Map->NYfine; y++)
+	for (x = 0; x < Map->NXfine; x++)
+	  if (State->FineMap[y][x] != NULL)
+	    CopyBytes(Snapshot, State->FineMap[y][x], sizeof(FINEPIX), Store);
+
+    for (Segment = State->ChannelData->streams; Segment != NULL;
+	 Segment = Segment->next)
+      CopyBytes(Snapshot, Segment, sizeof(Channel), Store);
+    for (Segment = State->ChannelData->roads; Segment != NULL;
+	 Segment = Segment->next)
+      CopyBytes(Snapshot, Segment, sizeof(Channel), Store);
+
+    if (State->Hydrograph != NULL)
+      CopyBytes(Snapshot, State->Hydrograph,
+		State->HydrographInfo->TotalWaveLength * sizeof(float), Store);
+
+    Snapshot->Size = Snapshot->Offset;
+  }
+}
+
+/*****************************************************************************
+  CopyBytes()
+
+  Copies Size bytes of the model state at Data to the snapshot buffer (Store
+  is TRUE) or back from it, and moves on in the buffer.  Only adds up the
+  size while the buffer has not been allocated.
+*****************************************************************************/
+static void CopyBytes(SNAPSHOTBUFFER *Snapshot, void *Data, size_t Size,
+		      int Store)
+{
+  if (Snapshot->Buffer != NULL) {
+    if (Store)
+      memcpy(Snapshot->Buffer + Snapshot->Offset, Data, Size);
+    else
+      memcpy(Data, Snapshot->Buffer + Snapshot->Offset, Size);
+  }
+  Snapshot->Offset += Size;
+}
+
+/*****************************************************************************
+  RewindForcing()
+
+  The met files are read sequentially, after the model time has been set
+  back they are read from the top again
+*****************************************************************************/
+static void RewindForcing(SERVERSTATE *State)
+{
+  int i;
+
+  for (i = 0; i < State->NStats; i++)
+    if (State->Stat[i].MetFile.FilePtr != NULL)
+      rewind(State->Stat[i].MetFile.FilePtr);
+}
+
+/*****************************************************************************
+  OpenForcing()
+
+  Opens the met station files with the same names in the directory Path.
+  Either all files are replaced, or none when one of them cannot be opened or
+  lacks a record for one of the time steps up to the end of the request.  In
+  that case the name of that file is copied to Failed.
+*****************************************************************************/
+static int OpenForcing(SERVERSTATE *State, char *Path, char *Failed)
+{
+  TIMESTRUCT *Time = State->Time;
+  FILE **NewFile;
+  char (*NewName)[BUFSIZE + 1];
+  char *Name;
+  int i;
+  int Success = TRUE;
+
+  if (State->NStats == 0)
+    return TRUE;
+
+  if (!(NewFile = (FILE **) calloc(State->NStats, sizeof(FILE *))) ||
+      !(NewName = calloc(State->NStats, BUFSIZE + 1)))
+    ReportError("OpenForcing", 1);
+
+  for (i = 0; i < State->NStats && Success; i++) {
+    Name = strrchr(State->Stat[i].MetFile.FileName, '/');
+    Name = (Name == NULL) ? State->Stat[i].MetFile.FileName : Name + 1;
+    snprintf(NewName[i], BUFSIZE + 1, "%s%s", Path, Name);
+    if (!(NewFile[i] = fopen(NewName[i], "r")) ||
+	!HasMetRecords(NewFile[i], &(Time->Current), &(Time->End),
+		       Time->Dt)) {
+      strcpy(Failed, NewName[i]);
+      Success = FALSE;
+    }
+  }
+
+  for (i = 0; i < State->NStats; i++) {
+    if (Success) {
+      fclose(State->Stat[i].MetFile.FilePtr);
+      State->Stat[i].MetFile.FilePtr = NewFile[i];
+      strcpy(State->Stat[i].MetFile.FileName, NewName[i]);
+    }
+    else if (NewFile[i] != NULL)
+      fclose(NewFile[i]);
+  }
+
+  free(NewFile);
+  free(NewName);
+
+  return Success;
+}
+
+/*****************************************************************************
+  HasMetRecords()
+
+  Checks whether a met station file has a record for every time step from
+  Start to End, in order, from the current file position on.  ReadMetRecord()
+  ends the model run when a record is missing, so an ADVANCE request is
+  checked first.  The file position is left unchanged.
+*****************************************************************************/
+static int HasMetRecords(FILE *MetFile, DATE *Start, DATE *End, int Dt)
+{
+  char Line[BUFSIZ + 1];
+  char DateStr[BUFSIZ + 1];
+  DATE MetDate;
+  DATE Next;			/* next time step without a record */
+  long Offset;
+
+  Offset = ftell(MetFile);
+  CopyDate(&Next, Start);
+  while (!After(&Next, End) && fgets(Line, BUFSIZ, MetFile))
+    if (sscanf(Line, "%s", DateStr) == 1 && SScanDate(DateStr, &MetDate) &&
+	IsEqualTime(&MetDate, &Next))
+      Next = NextDate(&Next, Dt);
+  fseek(MetFile, Offset, SEEK_SET);
+
+  return After(&Next, End);
+}
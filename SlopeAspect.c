@@ -37,8 +37,10 @@
 #include "settings.h"
 #include "data.h"
 #include "functions.h"
+#include "compact.h"
 #include "slopeaspect.h"
 #include "DHSVMerror.h"
+#include "memtrack.h"
 
 /* These indices are so neighbors can be looked up quickly */
 int xdirection[NDIRS] = {
@@ -204,18 +206,25 @@ static void flow_fractions(float dx, float dy, float slope, float aspect,
 }
 /* -------------------------------------------------------------
    ElevationSlopeAspect
+   Elev is the surface elevation as read from the DEM file, [y][x]
    ------------------------------------------------------------- */
-void ElevationSlopeAspect(MAPSIZE * Map, TOPOPIX ** TopoMap)
+void ElevationSlopeAspect(MAPSIZE * Map, TOPOPIX ** TopoMap, float **Elev)
 {
   const char *Routine = "ElevationSlopeAspect";
   int x;
   int y;
   int n;
-  int k;
+  long k;
   float neighbor_elev[NNEIGHBORS];
   int steepestdirection;
   float min;
   int xn, yn;
+  float slope;			/* slope of the pixel */
+  float aspect;			/* aspect of the pixel */
+  unsigned int total_dir;	/* sum of the flow fractions */
+
+  /* the aspect of atan2() is stored in fixed point with COMPACT_MAPS */
+  SetFixedScale(ASPECT_CODE, "Basin.Aspect", -PI, PI);
 
   /* fill neighbor array */
   
@@ -230,20 +239,23 @@ void ElevationSlopeAspect(MAPSIZE * Map, TOPOPIX ** TopoMap)
 	  xn = x + xneighbor[n];
 	  yn = y + yneighbor[n];	  
 	  if (valid_cell(Map, xn, yn)) {
-	    neighbor_elev[n] = ((TopoMap[yn][xn].Mask) ? TopoMap[yn][xn].Dem : (float) OUTSIDEBASIN);
+	    neighbor_elev[n] = ((TopoMap[yn][xn].Mask) ? Elev[yn][xn] : (float) OUTSIDEBASIN);
 	  }
 	  else {
 	    neighbor_elev[n] = (float) OUTSIDEBASIN;
 	  }
 	}	
-	slope_aspect(Map->DX, Map->DY, TopoMap[y][x].Dem, neighbor_elev,
-		     &(TopoMap[y][x].Slope), &(TopoMap[y][x].Aspect));	
+	slope_aspect(Map->DX, Map->DY, Elev[y][x], neighbor_elev,
+		     &slope, &aspect);
+	SETTOPOSLOPE(TopoMap[y][x], slope);
+	SETTOPOASPECT(TopoMap[y][x], aspect);
 
-	/* fill Dirs in TopoMap too */
-	flow_fractions(Map->DX, Map->DY, TopoMap[y][x].Slope,
-		       TopoMap[y][x].Aspect,
+	/* fill Dirs in TopoMap too, from the slope and aspect before they
+	   are rounded to 16 bits */
+	flow_fractions(Map->DX, Map->DY, slope, aspect,
 		       neighbor_elev, &(TopoMap[y][x].FlowGrad),
-		       TopoMap[y][x].Dir, &(TopoMap[y][x].TotalDir));
+		       TopoMap[y][x].Dir, &total_dir);
+	TopoMap[y][x].TotalDir = total_dir;
 	   
 	/* If there is a sink, check again to see if there 
 	   is a direction of steepest descent. Does not account 
@@ -256,13 +268,13 @@ void ElevationSlopeAspect(MAPSIZE * Map, TOPOPIX ** TopoMap)
 	    yn = y + ydirection[n];	  
 	    if (valid_cell(Map, xn, yn)) {
 	      if (INBASIN(TopoMap[yn][xn].Mask)) {
-			  if(TopoMap[yn][xn].Dem < min) { 
-				  min = TopoMap[yn][xn].Dem;
+			  if(Elev[yn][xn] < min) { 
+				  min = Elev[yn][xn];
 				  steepestdirection = n;}
 		  }
 	    }
 	  }	  
-	  if(min < TopoMap[y][x].Dem) {
+	  if(min < Elev[y][x]) {
 	    TopoMap[y][x].Dir[steepestdirection] = (int)(255.0 + 0.5);
 	    TopoMap[y][x].TotalDir = (int)(255.0 + 0.5);
 	  }
@@ -281,14 +293,16 @@ void ElevationSlopeAspect(MAPSIZE * Map, TOPOPIX ** TopoMap)
  } 	
   /* Create a structure to hold elevations of only those cells
      within the basin and the y,x of those cells.*/
-  if (!(Map->OrderedCells = (ITEM *) calloc(Map->NumCells, sizeof(ITEM))))
+  if (!(Map->OrderedCells = (ITEM *) TrackedCalloc(Map->NumCells, sizeof(ITEM),
+						   MEM_TERRAIN,
+						   "OrderedCells")))
     ReportError((char *) Routine, 1);
   k = 0;
   for (y = 0; y < Map->NY; y++) {
     for (x = 0; x < Map->NX; x++) {
       /* Save the elevation, y, and x in the ITEM structure. */
       if (INBASIN(TopoMap[y][x].Mask)) {
-        Map->OrderedCells[k].Rank = TopoMap[y][x].Dem;
+        Map->OrderedCells[k].Rank = Elev[y][x];
         Map->OrderedCells[k].y = y;
         Map->OrderedCells[k].x = x;
         k++;
@@ -310,18 +324,18 @@ void ElevationSlopeAspect(MAPSIZE * Map, TOPOPIX ** TopoMap)
         this subroutine starts the quick sort
 **********************************************************************/
 
-void quick(ITEM *OrderedCells, int count)
+void quick(ITEM *OrderedCells, long count)
 {
   qs(OrderedCells,0,count-1);
 }
 
-void qs(ITEM *item, int left, int right)
+void qs(ITEM *item, long left, long right)
 /**********************************************************************
         this is the quick sort subroutine - it returns the values in
         an array from high to low.
 **********************************************************************/
 {
-  register int i,j;
+  register long i,j;
   ITEM x,y;
 
   i=left;
@@ -421,8 +435,8 @@ float ElevationSlope(MAPSIZE *Map, TOPOPIX **TopoMap, FINEPIX ***FineMap, int y,
       // (equivalent to checking whether parent coarse grid cell is within coarse mask)
       if (INBASIN(TopoMap[coarsej][coarsei].Mask)) { 
 
-	bedrock_elev[n] = (((*FineMap[yn][xn]).Mask) ? (*FineMap[yn][xn]).bedrock : (float) OUTSIDEBASIN);
-	soil_elev[n] = (((*FineMap[yn][xn]).Mask) ? (*FineMap[yn][xn]).bedrock+(*FineMap[yn][xn]).sediment : (float) OUTSIDEBASIN);
+	bedrock_elev[n] = (((*FineMap[yn][xn]).Mask) ? FINEBEDROCK(*FineMap[yn][xn]) : (float) OUTSIDEBASIN);
+	soil_elev[n] = (((*FineMap[yn][xn]).Mask) ? FINEBEDROCK(*FineMap[yn][xn])+(*FineMap[yn][xn]).sediment : (float) OUTSIDEBASIN);
 	
       }
     }
@@ -431,7 +445,7 @@ float ElevationSlope(MAPSIZE *Map, TOPOPIX **TopoMap, FINEPIX ***FineMap, int y,
   /*  Find bedrock slope in all directions. Negative slope = ascent, positive slope = descent.  */     
   dx = Map->DMASS;
   dy = Map->DMASS;
-  celev = (*FineMap[y][x]).bedrock;
+  celev = FINEBEDROCK(*FineMap[y][x]);
 
 
   length_diagonal = sqrt((pow((double)dx, (double)2)) + (pow((double)dy, (double)2))); 
@@ -471,7 +485,7 @@ float ElevationSlope(MAPSIZE *Map, TOPOPIX **TopoMap, FINEPIX ***FineMap, int y,
 
   /* Find dynamic slope in direction of steepest descent. */
   
-  celev = (*FineMap[y][x]).bedrock + (*FineMap[y][x]).sediment;
+  celev = FINEBEDROCK(*FineMap[y][x]) + (*FineMap[y][x]).sediment;
   if(direction==0 || direction==2 || direction==4 || direction==6)
     Slope = (atan((celev - soil_elev[direction]) / length_diagonal))
       * DEGPRAD;
@@ -0,0 +1,125 @@
+/*
+ * SUMMARY:      Spinup.c - Spin up the model state
+ * USAGE:        Part of DHSVM
+ *
+ * AUTHOR:       DHSVM development team
+ * ORG:          University of Washington, Department of Civil Engineering
+ * E-MAIL:
+ * ORIG-DATE:    Oct-2026
+ * DESCRIPTION:  Repeats the spin-up period in memory until the soil water,
+ *               the water table and the channel storage no longer change
+ *               between cycles, and then starts the model run
+ * DESCRIP-END.
+ * FUNCTIONS:    EndSpinupCycle()
+ * COMMENTS:
+ * $Id: Spinup.c,v 1.0 2026/10/17 Exp $
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "settings.h"
+#include "data.h"
+#include "functions.h"
+
+static float RelativeChange(float Old, float New);
+
+/*****************************************************************************
+  Function name: EndSpinupCycle()
+
+  Purpose      : Check whether the model state has converged at the end of a
+                 spin-up cycle and reset the model time for the next cycle or
+                 for the model run
+
+  Required     :
+    OPTIONSTRUCT *Options - Options->Spinup holds the spin-up information
+    TIMESTRUCT *Time      - Model time
+    AGGREGATED *Total     - Basin averages for the last time step
+    CHANNEL *ChannelData  - Channel network
+    int NStats            - Number of met stations
+    METLOCATION *Stat     - Met stations
+
+  Returns      : void
+
+  Modifies     : Options->Spinup, Time, the met file positions
+
+  Comments     : The model state stays in memory between cycles.  Only the
+                 model time and the positions in the met station files are
+                 reset.  The state has converged when the relative changes in
+                 the basin average soil water, the basin average water table
+                 depth and the total channel storage over a cycle are all
+                 less than the spin-up tolerance.  The model run starts after
+                 MaxCycles cycles whether or not the state has converged.
+*****************************************************************************/
+void EndSpinupCycle(OPTIONSTRUCT *Options, TIMESTRUCT *Time,
+		    AGGREGATED *Total, CHANNEL *ChannelData, int NStats,
+		    METLOCATION *Stat)
+{
+  SPINUPSTRUCT *Spinup = &(Options->Spinup);
+  Channel *Current;
+  float ChannelStorage;
+  float dSoilWater;
+  float dTableDepth;
+  float dChannelStorage;
+  int Converged;
+  int i;
+
+  ChannelStorage = 0.0;
+  if (Options->HasNetwork)
+    for (Current = ChannelData->streams; Current != NULL;
+	 Current = Current->next)
+      ChannelStorage += Current->storage;
+
+  (Spinup->Cycle)++;
+  Converged = FALSE;
+  printf("\nSpin-up cycle %d: soil water %g m, water table depth %g m, "
+	 "channel storage %g m3\n", Spinup->Cycle, Total->SoilWater,
+	 Total->Soil.TableDepth, ChannelStorage);
+
+  if (Spinup->Cycle > 1) {
+    dSoilWater = RelativeChange(Spinup->SoilWater, Total->SoilWater);
+    dTableDepth = RelativeChange(Spinup->TableDepth, Total->Soil.TableDepth);
+    dChannelStorage = RelativeChange(Spinup->ChannelStorage, ChannelStorage);
+    printf("Relative change: soil water %g, water table depth %g, "
+	   "channel storage %g\n", dSoilWater, dTableDepth, dChannelStorage);
+    if (dSoilWater < Spinup->Tolerance && dTableDepth < Spinup->Tolerance &&
+	dChannelStorage < Spinup->Tolerance)
+      Converged = TRUE;
+  }
+
+  Spinup->SoilWater = Total->SoilWater;
+  Spinup->TableDepth = Total->Soil.TableDepth;
+  Spinup->ChannelStorage = ChannelStorage;
+
+  /* the met files are read sequentially, start reading at the top again */
+  for (i = 0; i < NStats; i++)
+    if (Stat[i].MetFile.FilePtr != NULL)
+      rewind(Stat[i].MetFile.FilePtr);
+
+  if (Converged || Spinup->Cycle >= Spinup->MaxCycles) {
+    if (Converged)
+      printf("Model state converged after %d spin-up cycles\n\n",
+	     Spinup->Cycle);
+    else
+      printf("WARNING: Model state has not converged after %d spin-up "
+	     "cycles\n\n", Spinup->Cycle);
+    Spinup->Active = FALSE;
+    InitTime(Time, &(Spinup->ModelStart), &(Spinup->ModelEnd), NULL, NULL,
+	     Spinup->Dt);
+  }
+  else
+    InitTime(Time, &(Spinup->Start), &(Spinup->End), NULL, NULL, Spinup->Dt);
+}
+
+/*****************************************************************************
+  RelativeChange()
+*****************************************************************************/
+static float RelativeChange(float Old, float New)
+{
+  float Scale;
+
+  Scale = MAX(fabs(Old), fabs(New));
+  if (Scale == 0.0)
+    return 0.0;
+  return fabs(New - Old) / Scale;
+}
@@ -22,6 +22,7 @@
 #include "DHSVMerror.h"
 #include "fileio.h"
 #include "functions.h"
+#include "memtrack.h"
 #include "constants.h"
 #include "sizeofnt.h"
 #include "varid.h"
@@ -89,18 +90,18 @@ void StoreModelState(char *Path, DATE * Current, MAPSIZE * Map,
 
     CreateMapFile(FileName, FileLabel, Map);
 
-    if (!(Array = (float *) calloc(Map->NY * Map->NX, sizeof(float))))
+    if (!(Array = (float *) CallocMap(Map->NY, Map->NX, sizeof(float))))
       ReportError((char *) Routine, 1);
 
     for (y = 0; y < Map->NY; y++) {
       for (x = 0; x < Map->NX; x++) {
 	if (INBASIN(TopoMap[y][x].Mask)) {
 
-	  ((float *) Array)[y * Map->NX + x] = PrecipMap[y][x].Precip;
+	  ((float *) Array)[(size_t) y * Map->NX + x] = PrecipMap[y][x].Precip;
 
 	}
 	else
-	  ((float *) Array)[y * Map->NX + x] = NA;
+	  ((float *) Array)[(size_t) y * Map->NX + x] = NA;
       }
     }
     DMap.ID = 201;
@@ -113,11 +114,11 @@ void StoreModelState(char *Path, DATE * Current, MAPSIZE * Map,
       for (x = 0; x < Map->NX; x++) {
 	if (INBASIN(TopoMap[y][x].Mask)) {
 
-	  ((float *) Array)[y * Map->NX + x] = MetMap[y][x].accum_precip;
+	  ((float *) Array)[(size_t) y * Map->NX + x] = MetMap[y][x].accum_precip;
 
 	}
 	else
-	  ((float *) Array)[y * Map->NX + x] = NA;
+	  ((float *) Array)[(size_t) y * Map->NX + x] = NA;
       }
     }
     DMap.ID = 701;
@@ -130,11 +131,11 @@ void StoreModelState(char *Path, DATE * Current, MAPSIZE * Map,
       for (x = 0; x < Map->NX; x++) {
 	if (INBASIN(TopoMap[y][x].Mask)) {
 
-	  ((float *) Array)[y * Map->NX + x] = MetMap[y][x].air_temp;
+	  ((float *) Array)[(size_t) y * Map->NX + x] = MetMap[y][x].air_temp;
 
 	}
 	else
-	  ((float *) Array)[y * Map->NX + x] = NA;
+	  ((float *) Array)[(size_t) y * Map->NX + x] = NA;
       }
     }
     DMap.ID = 702;
@@ -147,11 +148,11 @@ void StoreModelState(char *Path, DATE * Current, MAPSIZE * Map,
       for (x = 0; x < Map->NX; x++) {
 	if (INBASIN(TopoMap[y][x].Mask)) {
 
-	  ((float *) Array)[y * Map->NX + x] = MetMap[y][x].wind_speed;
+	  ((float *) Array)[(size_t) y * Map->NX + x] = MetMap[y][x].wind_speed;
 
 	}
 	else
-	  ((float *) Array)[y * Map->NX + x] = NA;
+	  ((float *) Array)[(size_t) y * Map->NX + x] = NA;
       }
     }
     DMap.ID = 703;
@@ -164,11 +165,11 @@ void StoreModelState(char *Path, DATE * Current, MAPSIZE * Map,
       for (x = 0; x < Map->NX; x++) {
 	if (INBASIN(TopoMap[y][x].Mask)) {
 
-	  ((float *) Array)[y * Map->NX + x] = MetMap[y][x].humidity;
+	  ((float *) Array)[(size_t) y * Map->NX + x] = MetMap[y][x].humidity;
 
 	}
 	else
-	  ((float *) Array)[y * Map->NX + x] = NA;
+	  ((float *) Array)[(size_t) y * Map->NX + x] = NA;
       }
     }
     DMap.ID = 704;
@@ -181,12 +182,12 @@ void StoreModelState(char *Path, DATE * Current, MAPSIZE * Map,
       for (x = 0; x < Map->NX; x++) {
 	if (INBASIN(TopoMap[y][x].Mask)) {
 
-	  ((float *) Array)[y * Map->NX + x] = RadMap[y][x].Beam +
+	  ((float *) Array)[(size_t) y * Map->NX + x] = RadMap[y][x].Beam +
 	    RadMap[y][x].Diffuse;
 
 	}
 	else
-	  ((float *) Array)[y * Map->NX + x] = NA;
+	  ((float *) Array)[(size_t) y * Map->NX + x] = NA;
       }
     }
     DMap.ID = 303;
@@ -195,7 +196,7 @@ void StoreModelState(char *Path, DATE * Current, MAPSIZE * Map,
     GetVarAttr(&DMap);
     Write2DMatrix(FileName, Array, DMap.NumberType, Map->NY, Map->NX, &DMap, 0);
 
-    free(Array);
+    FreeMap(Array);
   }
   /* Store the canopy interception */
 
@@ -206,7 +207,7 @@ void StoreModelState(char *Path, DATE * Current, MAPSIZE * Map,
 
   CreateMapFile(FileName, FileLabel, Map);
 
-  if (!(Array = (float *) calloc(Map->NY * Map->NX, sizeof(float))))
+  if (!(Array = (float *) CallocMap(Map->NY, Map->NX, sizeof(float))))
     ReportError((char *) Routine, 1);
 
   for (i = 0; i < Veg->MaxLayers; i++) {
@@ -215,12 +216,12 @@ void StoreModelState(char *Path, DATE * Current, MAPSIZE * Map,
 	if (INBASIN(TopoMap[y][x].Mask)) {
 	  NVeg = Veg->NLayers[(VegMap[y][x].Veg - 1)];
 	  if (i < NVeg)
-	    ((float *) Array)[y * Map->NX + x] = PrecipMap[y][x].IntRain[i];
+	    ((float *) Array)[(size_t) y * Map->NX + x] = PrecipMap[y][x].IntRain[i];
 	  else
-	    ((float *) Array)[y * Map->NX + x] = NA;
+	    ((float *) Array)[(size_t) y * Map->NX + x] = NA;
 	}
 	else
-	  ((float *) Array)[y * Map->NX + x] = NA;
+	  ((float *) Array)[(size_t) y * Map->NX + x] = NA;
       }
     }
     DMap.ID = 202;
@@ -237,12 +238,12 @@ void StoreModelState(char *Path, DATE * Current, MAPSIZE * Map,
 	if (INBASIN(TopoMap[y][x].Mask)) {
 	  NVeg = Veg->NLayers[(VegMap[y][x].Veg - 1)];
 	  if (i < NVeg)
-	    ((float *) Array)[y * Map->NX + x] = PrecipMap[y][x].IntSnow[i];
+	    ((float *) Array)[(size_t) y * Map->NX + x] = PrecipMap[y][x].IntSnow[i];
 	  else
-	    ((float *) Array)[y * Map->NX + x] = NA;
+	    ((float *) Array)[(size_t) y * Map->NX + x] = NA;
 	}
 	else
-	  ((float *) Array)[y * Map->NX + x] = NA;
+	  ((float *) Array)[(size_t) y * Map->NX + x] = NA;
       }
     }
     DMap.ID = 203;
@@ -256,10 +257,10 @@ void StoreModelState(char *Path, DATE * Current, MAPSIZE * Map,
   for (y = 0; y < Map->NY; y++) {
     for (x = 0; x < Map->NX; x++) {
       if (INBASIN(TopoMap[y][x].Mask)) {
-	((float *) Array)[y * Map->NX + x] = PrecipMap[y][x].TempIntStorage;
+	((float *) Array)[(size_t) y * Map->NX + x] = PrecipMap[y][x].TempIntStorage;
       }
       else {
-	((float *) Array)[y * Map->NX + x] = NA;
+	((float *) Array)[(size_t) y * Map->NX + x] = NA;
       }
     }
   }
@@ -269,7 +270,7 @@ void StoreModelState(char *Path, DATE * Current, MAPSIZE * Map,
   GetVarAttr(&DMap);
   Write2DMatrix(FileName, Array, DMap.NumberType, Map->NY, Map->NX, &DMap, 0);
 
-  free(Array);
+  FreeMap(Array);
 
   /* Store the snow pack conditions */
 
@@ -277,15 +278,15 @@ void StoreModelState(char *Path, DATE * Current, MAPSIZE * Map,
   strcpy(FileLabel, "Snow pack moisture and temperature state");
   CreateMapFile(FileName, FileLabel, Map);
 
-  if (!(Array = (float *) calloc(Map->NY * Map->NX, sizeof(float))))
+  if (!(Array = (float *) CallocMap(Map->NY, Map->NX, sizeof(float))))
     ReportError((char *) Routine, 1);
 
   for (y = 0; y < Map->NY; y++) {
     for (x = 0; x < Map->NX; x++) {
       if (INBASIN(TopoMap[y][x].Mask))
-	((float *) Array)[y * Map->NX + x] = (float) SnowMap[y][x].HasSnow;
+	((float *) Array)[(size_t) y * Map->NX + x] = (float) SnowMap[y][x].HasSnow;
       else
-	((float *) Array)[y * Map->NX + x] = NA;
+	((float *) Array)[(size_t) y * Map->NX + x] = NA;
     }
   }
   DMap.ID = 401;
@@ -297,9 +298,9 @@ void StoreModelState(char *Path, DATE * Current, MAPSIZE * Map,
   for (y = 0; y < Map->NY; y++) {
     for (x = 0; x < Map->NX; x++) {
       if (INBASIN(TopoMap[y][x].Mask))
-	((float *) Array)[y * Map->NX + x] = (float) SnowMap[y][x].LastSnow;
+	((float *) Array)[(size_t) y * Map->NX + x] = (float) SnowMap[y][x].LastSnow;
       else
-	((float *) Array)[y * Map->NX + x] = NA;
+	((float *) Array)[(size_t) y * Map->NX + x] = NA;
     }
   }
   DMap.ID = 403;
@@ -311,9 +312,9 @@ void StoreModelState(char *Path, DATE * Current, MAPSIZE * Map,
   for (y = 0; y < Map->NY; y++) {
     for (x = 0; x < Map->NX; x++) {
       if (INBASIN(TopoMap[y][x].Mask))
-	((float *) Array)[y * Map->NX + x] = SnowMap[y][x].Swq;
+	((float *) Array)[(size_t) y * Map->NX + x] = SnowMap[y][x].Swq;
       else
-	((float *) Array)[y * Map->NX + x] = NA;
+	((float *) Array)[(size_t) y * Map->NX + x] = NA;
     }
   }
   DMap.ID = 404;
@@ -325,9 +326,9 @@ void StoreModelState(char *Path, DATE * Current, MAPSIZE * Map,
   for (y = 0; y < Map->NY; y++) {
     for (x = 0; x < Map->NX; x++) {
       if (INBASIN(TopoMap[y][x].Mask))
-	((float *) Array)[y * Map->NX + x] = SnowMap[y][x].PackWater;
+	((float *) Array)[(size_t) y * Map->NX + x] = SnowMap[y][x].PackWater;
       else
-	((float *) Array)[y * Map->NX + x] = NA;
+	((float *) Array)[(size_t) y * Map->NX + x] = NA;
     }
   }
   DMap.ID = 406;
@@ -339,9 +340,9 @@ void StoreModelState(char *Path, DATE * Current, MAPSIZE * Map,
   for (y = 0; y < Map->NY; y++) {
     for (x = 0; x < Map->NX; x++) {
       if (INBASIN(TopoMap[y][x].Mask))
-	((float *) Array)[y * Map->NX + x] = SnowMap[y][x].TPack;
+	((float *) Array)[(size_t) y * Map->NX + x] = SnowMap[y][x].TPack;
       else
-	((float *) Array)[y * Map->NX + x] = NA;
+	((float *) Array)[(size_t) y * Map->NX + x] = NA;
     }
   }
   DMap.ID = 407;
@@ -353,9 +354,9 @@ void StoreModelState(char *Path, DATE * Current, MAPSIZE * Map,
   for (y = 0; y < Map->NY; y++) {
     for (x = 0; x < Map->NX; x++) {
       if (INBASIN(TopoMap[y][x].Mask))
-	((float *) Array)[y * Map->NX + x] = SnowMap[y][x].SurfWater;
+	((float *) Array)[(size_t) y * Map->NX + x] = SnowMap[y][x].SurfWater;
       else
-	((float *) Array)[y * Map->NX + x] = NA;
+	((float *) Array)[(size_t) y * Map->NX + x] = NA;
     }
   }
   DMap.ID = 408;
@@ -367,9 +368,9 @@ void StoreModelState(char *Path, DATE * Current, MAPSIZE * Map,
   for (y = 0; y < Map->NY; y++) {
     for (x = 0; x < Map->NX; x++) {
       if (INBASIN(TopoMap[y][x].Mask))
-	((float *) Array)[y * Map->NX + x] = SnowMap[y][x].TSurf;
+	((float *) Array)[(size_t) y * Map->NX + x] = SnowMap[y][x].TSurf;
       else
-	((float *) Array)[y * Map->NX + x] = NA;
+	((float *) Array)[(size_t) y * Map->NX + x] = NA;
     }
   }
   DMap.ID = 409;
@@ -381,9 +382,9 @@ void StoreModelState(char *Path, DATE * Current, MAPSIZE * Map,
   for (y = 0; y < Map->NY; y++) {
     for (x = 0; x < Map->NX; x++) {
       if (INBASIN(TopoMap[y][x].Mask))
-	((float *) Array)[y * Map->NX + x] = SnowMap[y][x].ColdContent;
+	((float *) Array)[(size_t) y * Map->NX + x] = SnowMap[y][x].ColdContent;
       else
-	((float *) Array)[y * Map->NX + x] = NA;
+	((float *) Array)[(size_t) y * Map->NX + x] = NA;
     }
   }
   DMap.ID = 410;
@@ -392,7 +393,12 @@ void StoreModelState(char *Path, DATE * Current, MAPSIZE * Map,
   GetVarAttr(&DMap);
   Write2DMatrix(FileName, Array, DMap.NumberType, Map->NY, Map->NX, &DMap, 0);
 
-  free(Array);
+  FreeMap(Array);
+
+  /* The soil conditions, and with them the unit hydrograph, are only
+     simulated in FULL_MODEL runs */
+  if (Options->Components != FULL_MODEL)
+    return;
 
   /* Store the soil conditions */
 
@@ -400,7 +406,7 @@ void StoreModelState(char *Path, DATE * Current, MAPSIZE * Map,
   strcpy(FileLabel, "Soil moisture and temperature state");
   CreateMapFile(FileName, FileLabel, Map);
 
-  if (!(Array = (float *) calloc(Map->NY * Map->NX, sizeof(float))))
+  if (!(Array = (float *) CallocMap(Map->NY, Map->NX, sizeof(float))))
     ReportError((char *) Routine, 1);
 
   for (i = 0; i < Soil->MaxLayers + 1; i++) {
@@ -409,12 +415,12 @@ void StoreModelState(char *Path, DATE * Current, MAPSIZE * Map,
 	if (INBASIN(TopoMap[y][x].Mask)) {
 	  NSoil = Soil->NLayers[(SoilMap[y][x].Soil - 1)];
 	  if (i <= NSoil)
-	    ((float *) Array)[y * Map->NX + x] = SoilMap[y][x].Moist[i];
+	    ((float *) Array)[(size_t) y * Map->NX + x] = SoilMap[y][x].Moist[i];
 	  else
-	    ((float *) Array)[y * Map->NX + x] = NA;
+	    ((float *) Array)[(size_t) y * Map->NX + x] = NA;
 	}
 	else
-	  ((float *) Array)[y * Map->NX + x] = NA;
+	  ((float *) Array)[(size_t) y * Map->NX + x] = NA;
       }
     }
     DMap.ID = 501;
@@ -428,9 +434,9 @@ void StoreModelState(char *Path, DATE * Current, MAPSIZE * Map,
   for (y = 0; y < Map->NY; y++) {
     for (x = 0; x < Map->NX; x++) {
       if (INBASIN(TopoMap[y][x].Mask))
-	((float *) Array)[y * Map->NX + x] = SoilMap[y][x].TSurf;
+	((float *) Array)[(size_t) y * Map->NX + x] = SoilMap[y][x].TSurf;
       else
-	((float *) Array)[y * Map->NX + x] = SoilMap[y][x].TSurf;
+	((float *) Array)[(size_t) y * Map->NX + x] = SoilMap[y][x].TSurf;
     }
   }
   DMap.ID = 505;
@@ -445,12 +451,12 @@ void StoreModelState(char *Path, DATE * Current, MAPSIZE * Map,
 	if (INBASIN(TopoMap[y][x].Mask)) {
 	  NSoil = Soil->NLayers[SoilMap[y][x].Soil - 1];
 	  if (i < NSoil)
-	    ((float *) Array)[y * Map->NX + x] = SoilMap[y][x].Temp[i];
+	    ((float *) Array)[(size_t) y * Map->NX + x] = SoilMap[y][x].Temp[i];
 	  else
-	    ((float *) Array)[y * Map->NX + x] = NA;
+	    ((float *) Array)[(size_t) y * Map->NX + x] = NA;
 	}
 	else
-	  ((float *) Array)[y * Map->NX + x] = NA;
+	  ((float *) Array)[(size_t) y * Map->NX + x] = NA;
       }
     }
     DMap.ID = 511;
@@ -464,9 +470,9 @@ void StoreModelState(char *Path, DATE * Current, MAPSIZE * Map,
   for (y = 0; y < Map->NY; y++) {
     for (x = 0; x < Map->NX; x++) {
       if (INBASIN(TopoMap[y][x].Mask))
-	((float *) Array)[y * Map->NX + x] = SoilMap[y][x].Qst;
+	((float *) Array)[(size_t) y * Map->NX + x] = SoilMap[y][x].Qst;
       else
-	((float *) Array)[y * Map->NX + x] = NA;
+	((float *) Array)[(size_t) y * Map->NX + x] = NA;
     }
   }
   DMap.ID = 510;
@@ -486,10 +492,10 @@ void StoreModelState(char *Path, DATE * Current, MAPSIZE * Map,
 		((float)CELLFACTOR * (Map->DX*Map->DY));
 	  } 
 	}
-	((float *) Array)[y * Map->NX + x] = SoilMap[y][x].IExcess + RoadIExcess;
+	((float *) Array)[(size_t) y * Map->NX + x] = SoilMap[y][x].IExcess + RoadIExcess;
       }
       else
-	((float *) Array)[y * Map->NX + x] = NA;
+	((float *) Array)[(size_t) y * Map->NX + x] = NA;
     }
   }
   DMap.ID = 512;
@@ -498,12 +504,13 @@ void StoreModelState(char *Path, DATE * Current, MAPSIZE * Map,
   GetVarAttr(&DMap);
   Write2DMatrix(FileName, Array, DMap.NumberType, Map->NY, Map->NX, &DMap, 0);
 
-  free(Array);
+  FreeMap(Array);
 
   /* If the unit hydrograph is used for flow routing, store the unit 
      hydrograph array */
 
-  if (Options->Extent == BASIN && Options->HasNetwork == FALSE) {
+  if (Options->Extent == BASIN && Options->HasNetwork == FALSE &&
+      Options->Components == FULL_MODEL) {
     sprintf(FileName, "%sHydrograph.State.%s", Path, Str);
     OpenFile(&HydroStateFile, FileName, "w", FALSE);
     for (i = 0; i < HydrographInfo->TotalWaveLength; i++)
@@ -0,0 +1,372 @@
+/*
+ * SUMMARY:      SweepCell.c - Column physics for a single pixel
+ * USAGE:        Part of DHSVM
+ *
+ * AUTHOR:       DHSVM development team
+ * ORG:          University of Washington, Department of Civil Engineering
+ * E-MAIL:
+ * ORIG-DATE:    Oct-2026
+ * DESCRIPTION:  Calculates the local meteorology, sets the soil temperatures
+ *               and calculates the mass and energy balance for one pixel
+ * DESCRIP-END.
+ * FUNCTIONS:    SweepCell()
+ *               SweepCellMembers()
+ *               TiledMassEnergyBalance()
+ * COMMENTS:
+ * $Id: SweepCell.c,v 1.0 2026/10/17 Exp $
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "settings.h"
+#include "data.h"
+#include "DHSVMerror.h"
+#include "functions.h"
+#include "channel_grid.h"
+#include "sweep.h"
+
+typedef struct {
+  ChannelMapPtr **Map;		/* Network the inflow goes to, NULL if none */
+  float Mass;			/* Inflow */
+} CELLINFLOW;
+
+typedef struct {
+  CELLSWEEP *Sweep;		/* Model structures */
+  TILESTRUCT *Tiles;		/* Tiles of the pixel loop */
+  PIXRAD *Rad;			/* Radiation of each active pixel */
+  CELLINFLOW *Inflow;		/* Channel inflow of each active pixel */
+  long *Current;		/* Pixel being processed by each thread */
+  long Last;			/* Last pixel of the serial pixel loop */
+  PIXMET LastMet;		/* Local meteorology of that pixel */
+} TILEDSWEEP;
+
+static void ColumnMassEnergyBalance(CELLSWEEP *Sweep, int y, int x,
+				    PIXMET *LocalMet, PIXRAD *TotalRad);
+static void SweepTile(void *Arg, TILE *Tile, int Thread);
+static void LogCellInflow(ChannelMapPtr **Map, int Col, int Row, float Mass,
+			  void *Arg);
+
+/*****************************************************************************
+  Function name: SweepCell()
+
+  Purpose      : Run the column physics (MakeLocalMetData() followed by
+                 MassEnergyBalance()) for the pixel at (y, x).  In MET_MODEL
+                 runs only the local meteorology is calculated
+
+  Required     :
+    CELLSWEEP *Sweep - Pointers to the model structures
+    int y            - Row of the pixel
+    int x            - Column of the pixel
+    PIXRAD *TotalRad - Radiation totals to which the pixel is added
+
+  Returns      : PIXMET - local meteorology for the pixel
+
+  Modifies     : the pixel's entries in the model maps, TotalRad
+
+  Comments     : Writes the model maps at (y, x), TotalRad, the road
+                 network of the pixel and the channel inflows.  The soil and
+                 vegetation tables are shared by all pixels and must only be
+                 read (EvapoTranspiration() scales a local copy of MaxInt).
+                 Pixels can run concurrently if each one has its own TotalRad
+                 and the channel inflows are collected as in
+                 TiledMassEnergyBalance().  The road network
+                 (Sweep->Network) is NULL unless the soil water is simulated
+*****************************************************************************/
+PIXMET SweepCell(CELLSWEEP *Sweep, int y, int x, PIXRAD *TotalRad)
+{
+  float skyview;		/* sky view factor for the pixel */
+  unsigned char shadow;		/* shadow value for the pixel */
+  OPTIONSTRUCT *Options = Sweep->Options;
+  TIMESTRUCT *Time = Sweep->Time;
+  PIXMET LocalMet;		/* local met data */
+
+  if (Options->Shading) {
+    skyview = Sweep->Compact->Active ?
+      COMPACTVALUE(&(Sweep->Compact->SkyView), y, x) :
+      Sweep->SkyViewMap[y][x];
+    if (Options->Adaptive.Steps > 1)
+      shadow = StepShadow(&(Options->Adaptive), Sweep->ShadowMap,
+			  Time->DayStep, y, x);
+    else
+      shadow = Sweep->ShadowMap[Time->DayStep][y][x];
+  }
+  else {
+    skyview = 0.0;
+    shadow = 0;
+  }
+
+  LocalMet =
+    MakeLocalMetData(y, x, Sweep->Map, Time->DayStep, Options, Sweep->NStats,
+		     Sweep->Stat, Sweep->Stations, Sweep->MetWeights[y][x],
+		     TOPODEM(Sweep->TopoMap[y][x]), &(Sweep->RadMap[y][x]),
+		     &(Sweep->PrecipMap[y][x]), Sweep->Radar, Sweep->RadarMap,
+		     Sweep->PrismMap, &(Sweep->SnowMap[y][x]),
+		     Sweep->SnowAlbedo, Sweep->MM5Input, Sweep->WindModel,
+		     Sweep->PrecipLapseMap, Sweep->Compact, Sweep->MetMap,
+		     Sweep->NGraphics, Time->Current.Month, skyview, shadow,
+		     Sweep->SolarGeo->SunMax,
+		     Sweep->SolarGeo->SineSolarAltitude);
+
+  if (Options->Components == MET_MODEL)
+    return LocalMet;
+
+  ColumnMassEnergyBalance(Sweep, y, x, &LocalMet, TotalRad);
+
+  return LocalMet;
+}
+
+/*****************************************************************************
+  Function name: SweepCellMembers()
+
+  Purpose      : Run the column physics for the pixel at (y, x) for all
+                 members of an in-process ensemble
+
+  Required     :
+    CELLSWEEP *Sweep  - Pointers to the model structures for each member
+    int NMembers      - Number of members
+    ENSMEMBER *Member - Forcing perturbations for each member
+    int y             - Row of the pixel
+    int x             - Column of the pixel
+    PIXRAD **TotalRad - Radiation totals for each member
+    PIXMET *LocalMet  - Local meteorology for each member
+
+  Returns      : void
+
+  Modifies     : the pixel's entries in the model maps of each member,
+                 TotalRad, LocalMet
+
+  Comments     : The members only differ in their model state and forcing
+                 perturbations, so the met interpolation is done once for the
+                 pixel, after which the column physics is run for each member
+                 in turn on the maps of that member.  The air temperature
+                 and the precipitation of a perturbed member are
+                 interpolated again from its perturbed inputs by
+                 PerturbLocalMet(), so that each member gets the same
+                 results as in a member process.
+*****************************************************************************/
+void SweepCellMembers(CELLSWEEP *Sweep, int NMembers, ENSMEMBER *Member,
+		      int y, int x, PIXRAD **TotalRad, PIXMET *LocalMet)
+{
+  int e;			/* member counter */
+  float skyview;		/* sky view factor for the pixel */
+  unsigned char shadow;		/* shadow value for the pixel */
+  OPTIONSTRUCT *Options = Sweep->Options;
+  TIMESTRUCT *Time = Sweep->Time;
+  PIXMET BaseMet;		/* unperturbed local met data */
+  PRECIPPIX BasePrecip;		/* unperturbed precipitation */
+  PRECIPPIX *LocalPrecip;
+
+  if (Options->Shading) {
+    skyview = Sweep->Compact->Active ?
+      COMPACTVALUE(&(Sweep->Compact->SkyView), y, x) :
+      Sweep->SkyViewMap[y][x];
+    shadow = Sweep->ShadowMap[Time->DayStep][y][x];
+  }
+  else {
+    skyview = 0.0;
+    shadow = 0;
+  }
+
+  BasePrecip.Precip = 0.0;
+  BaseMet =
+    InterpolateLocalMet(y, x, Sweep->Map, Time->DayStep, Options,
+			Sweep->NStats, Sweep->Stat, Sweep->Stations,
+			Sweep->MetWeights[y][x],
+			TOPODEM(Sweep->TopoMap[y][x]), &(Sweep->RadMap[y][x]),
+			&BasePrecip, Sweep->Radar, Sweep->RadarMap,
+			Sweep->PrismMap, Sweep->MM5Input, Sweep->WindModel,
+			Sweep->PrecipLapseMap, Sweep->Compact,
+			Time->Current.Month, skyview,
+			shadow, Sweep->SolarGeo->SunMax,
+			Sweep->SolarGeo->SineSolarAltitude);
+
+  for (e = 0; e < NMembers; e++) {
+    LocalMet[e] = BaseMet;
+    LocalPrecip = &(Sweep[e].PrecipMap[y][x]);
+    LocalPrecip->Precip = BasePrecip.Precip;
+    if (Member[e].TempOffset != 0.0 || Member[e].PrecipMultiplier != 1.0)
+      PerturbLocalMet(y, x, Sweep->Map, Options, Sweep->NStats, Sweep->Stat,
+		      Sweep->Stations, Sweep->MetWeights[y][x],
+		      TOPODEM(Sweep->TopoMap[y][x]), LocalPrecip, Sweep->Radar,
+		      Sweep->RadarMap, Sweep->PrismMap, Sweep->MM5Input,
+		      Sweep->PrecipLapseMap, Sweep->Compact,
+		      Time->Current.Month, Member[e].TempOffset,
+		      Member[e].PrecipMultiplier, &(LocalMet[e]));
+    FinishLocalMetData(Options, &(LocalMet[e]), LocalPrecip,
+		       &(Sweep[e].SnowMap[y][x]), Sweep->SnowAlbedo);
+
+    if (Options->Components != MET_MODEL)
+      ColumnMassEnergyBalance(&(Sweep[e]), y, x, &(LocalMet[e]), TotalRad[e]);
+  }
+
+  /* the graphics show the first member */
+  if (Sweep->NGraphics > 0) {
+    (*Sweep->MetMap)[y][x].accum_precip += Sweep->PrecipMap[y][x].Precip;
+    (*Sweep->MetMap)[y][x].air_temp = LocalMet[0].Tair;
+    (*Sweep->MetMap)[y][x].wind_speed = LocalMet[0].Wind;
+    (*Sweep->MetMap)[y][x].humidity = LocalMet[0].Rh;
+  }
+}
+
+/*****************************************************************************
+  Function name: TiledMassEnergyBalance()
+
+  Purpose      : Run the column physics for all active pixels on the
+                 threads of the tile scheduler
+
+  Required     :
+    CELLSWEEP *Sweep   - Pointers to the model structures
+    TILESTRUCT *Tiles  - Tiles of the pixel loop (tiles.h)
+    PIXMET *LastMet    - Local meteorology of the last pixel
+    PIXRAD *TotalRad   - Radiation totals
+
+  Returns      : void
+
+  Modifies     : the model maps, LastMet, TotalRad and the lateral inflow
+                 of the channel network
+
+  Comments     : The radiation and the channel inflow of each pixel are
+                 kept and added to the totals after the loop, in the order
+                 of the serial pixel loop, and LastMet is set to the local
+                 meteorology of the last pixel of that loop (it is used by
+                 RouteChannel()), so the results are the same as those of
+                 the serial loop for any number of threads.
+                 MassEnergyBalance() adds at most one inflow per pixel.
+*****************************************************************************/
+void TiledMassEnergyBalance(CELLSWEEP *Sweep, TILESTRUCT *Tiles,
+			    PIXMET *LastMet, PIXRAD *TotalRad)
+{
+  const char *Routine = "TiledMassEnergyBalance";
+  ChannelGridState State;	/* Inflow hook outside the loop */
+  TILEDSWEEP Work;
+  PIXRAD *Rad;
+  COORD *Cell;
+  long i;			/* counter */
+  long k;			/* active pixel */
+
+  if (Tiles->NCells == 0)
+    return;
+
+  Work.Sweep = Sweep;
+  Work.Tiles = Tiles;
+  Work.Last = Tiles->RowMajor[Tiles->NCells - 1];
+  if (!(Work.Rad = (PIXRAD *) calloc(Tiles->NCells, sizeof(PIXRAD))))
+    ReportError((char *) Routine, 1);
+  if (!(Work.Inflow = (CELLINFLOW *) calloc(Tiles->NCells,
+					    sizeof(CELLINFLOW))))
+    ReportError((char *) Routine, 1);
+  if (!(Work.Current = (long *) calloc(Tiles->NThreads, sizeof(long))))
+    ReportError((char *) Routine, 1);
+
+  channel_grid_save_state(&State);
+  channel_grid_inflow_hook(LogCellInflow, &Work);
+
+  RunTiles(Tiles, SweepTile, &Work);
+
+  channel_grid_restore_state(&State);
+
+  for (i = 0; i < Tiles->NCells; i++) {
+    k = Tiles->RowMajor[i];
+    Cell = &(Tiles->Cells[k]);
+    if (Work.Inflow[k].Map)
+      channel_grid_inc_inflow(Work.Inflow[k].Map, Cell->E, Cell->N,
+			      Work.Inflow[k].Mass);
+    Rad = &(Work.Rad[k]);
+    TotalRad->NetShort[0] += Rad->NetShort[0];
+    TotalRad->NetShort[1] += Rad->NetShort[1];
+    TotalRad->LongIn[0] += Rad->LongIn[0];
+    TotalRad->LongIn[1] += Rad->LongIn[1];
+    TotalRad->LongOut[0] += Rad->LongOut[0];
+    TotalRad->LongOut[1] += Rad->LongOut[1];
+    TotalRad->PixelNetShort += Rad->PixelNetShort;
+    TotalRad->PixelLongIn += Rad->PixelLongIn;
+    TotalRad->PixelLongOut += Rad->PixelLongOut;
+  }
+  *LastMet = Work.LastMet;
+
+  free(Work.Current);
+  free(Work.Inflow);
+  free(Work.Rad);
+}
+
+/*****************************************************************************
+  SweepTile()
+
+  Tile function of TiledMassEnergyBalance(), runs the column physics for the
+  active pixels of a tile
+*****************************************************************************/
+static void SweepTile(void *Arg, TILE *Tile, int Thread)
+{
+  TILEDSWEEP *Work = (TILEDSWEEP *) Arg;
+  COORD *Cell;
+  PIXMET LocalMet;
+  long k;			/* active pixel */
+
+  for (k = Tile->First; k < Tile->First + Tile->NCells; k++) {
+    Cell = &(Work->Tiles->Cells[k]);
+    Work->Current[Thread] = k;
+    LocalMet = SweepCell(Work->Sweep, Cell->N, Cell->E, &(Work->Rad[k]));
+    if (k == Work->Last)
+      Work->LastMet = LocalMet;
+  }
+}
+
+/*****************************************************************************
+  LogCellInflow()
+
+  Inflow hook of the channel grid during TiledMassEnergyBalance(), keeps the
+  inflow of the pixel processed by the calling thread.  Arg is the
+  TILEDSWEEP of the pixel loop
+*****************************************************************************/
+static void LogCellInflow(ChannelMapPtr **Map, int Col, int Row, float Mass,
+			  void *Arg)
+{
+  TILEDSWEEP *Work = (TILEDSWEEP *) Arg;
+  CELLINFLOW *Inflow = &(Work->Inflow[Work->Current[TileThread()]]);
+
+  Inflow->Map = Map;
+  Inflow->Mass += Mass;
+}
+
+/*****************************************************************************
+  ColumnMassEnergyBalance()
+
+  Sets the soil temperatures and calculates the mass and energy balance for
+  the pixel at (y, x)
+*****************************************************************************/
+static void ColumnMassEnergyBalance(CELLSWEEP *Sweep, int y, int x,
+				    PIXMET *LocalMet, PIXRAD *TotalRad)
+{
+  OPTIONSTRUCT *Options = Sweep->Options;
+  TIMESTRUCT *Time = Sweep->Time;
+  int i;			/* counter */
+
+  /* the soil layers are only allocated when the soil water is simulated */
+  if (Options->Components == FULL_MODEL) {
+    for (i = 0; i < Sweep->Soil->MaxLayers; i++) {
+      if (Options->HeatFlux == TRUE) {
+	if (Options->MM5 == TRUE)
+	  Sweep->SoilMap[y][x].Temp[i] =
+	    MM5VALUE(Sweep->MM5Input, Sweep->ShadeOffset + i + N_MM5_MAPS,
+		     y, x);
+	else
+	  Sweep->SoilMap[y][x].Temp[i] = Sweep->Stat[0].Data.Tsoil[i];
+      }
+      else
+	Sweep->SoilMap[y][x].Temp[i] = LocalMet->Tair;
+    }
+  }
+
+  MassEnergyBalance(y, x, Sweep->SolarGeo->SineSolarAltitude, Sweep->Map->DX,
+		    Sweep->Map->DY, Time->Dt, Options->HeatFlux,
+		    Options->CanopyRadAtt, Options->RoadRouting,
+		    Options->Infiltration, Options->Components,
+		    Sweep->Veg->MaxLayers, LocalMet,
+		    Sweep->Network ? &(Sweep->Network[y][x]) : NULL,
+		    &(Sweep->PrecipMap[y][x]),
+		    &(Sweep->VType[Sweep->VegMap[y][x].Veg - 1]),
+		    &(Sweep->VegMap[y][x]),
+		    &(Sweep->SType[Sweep->SoilMap[y][x].Soil - 1]),
+		    &(Sweep->SoilMap[y][x]), &(Sweep->SnowMap[y][x]),
+		    &(Sweep->EvapMap[y][x]), TotalRad, Sweep->ChannelData);
+}
@@ -0,0 +1,455 @@
+/*
+ * SUMMARY:      Tiles.c - Tiled pixel scheduler with work stealing
+ * USAGE:        Part of DHSVM
+ *
+ * AUTHOR:       DHSVM development team
+ * ORG:          University of Washington, Department of Civil Engineering
+ * E-MAIL:
+ * ORIG-DATE:    Oct-2026
+ * DESCRIPTION:  Divide the active pixels into tiles and run a function for
+ *               every tile on a pool of threads, see tiles.h
+ * DESCRIP-END.
+ * FUNCTIONS:    InitTiles()
+ *               InitPointTiles()
+ *               RunTiles()
+ *               TileThread()
+ *               EndTiles()
+ * COMMENTS:     The worker threads are started once by InitTiles() and
+ *               wait for the next run between runs.  The calling thread
+ *               works on the first queue.
+ * $Id: Tiles.c,v 1.0 2026/10/17 Exp $
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "settings.h"
+#include "constants.h"
+#include "data.h"
+#include "DHSVMerror.h"
+#include "profile.h"
+#include "globals.h"
+#include "tiles.h"
+
+static pthread_key_t ThreadKey;	/* Thread number of the workers */
+static pthread_once_t ThreadKeyOnce = PTHREAD_ONCE_INIT;
+
+static void CreateThreadKey(void);
+static void FillQueues(TILESTRUCT *Tiles);
+static void StartWorkers(TILESTRUCT *Tiles, const char *Routine);
+static void RunQueue(TILESTRUCT *Tiles, int Thread);
+static int TakeTile(TILESTRUCT *Tiles, int Thread);
+static void *TileWorker(void *Arg);
+
+/*****************************************************************************
+  Function name: InitTiles()
+
+  Purpose      : Divide the active pixels into tiles and start the worker
+                 threads
+
+  Required     :
+    TILESTRUCT *Tiles        - Tiles and thread pool
+    int NThreads             - Number of threads, including the calling
+                               thread
+    int Size                 - Tile edge (pixels), 0 for the default
+    MAPSIZE *Map             - Size and location of model area
+    TOPOPIX **TopoMap        - Basin mask
+    PARALLELSTRUCT *Parallel - Division of the basin over MPI ranks
+
+  Returns      : void
+
+  Modifies     : Tiles
+
+  Comments     : A pixel is active if it is in the basin and owned by this
+                 rank.  No threads are started if there is a single thread
+                 or a single tile.
+*****************************************************************************/
+void InitTiles(TILESTRUCT *Tiles, int NThreads, int Size, MAPSIZE *Map,
+	       TOPOPIX **TopoMap, PARALLELSTRUCT *Parallel)
+{
+  const char *Routine = "InitTiles";
+  int NTileX;			/* Number of tile columns */
+  int NTileY;			/* Number of tile rows */
+  int *TileOf;			/* Tile number of each tile position, -1 if
+				   the position has no active pixels */
+  int *Filled;			/* Active pixels placed in each tile */
+  long i;			/* counter */
+  int t;			/* tile counter */
+  int tx;			/* tile column */
+  int ty;			/* tile row */
+  int x;			/* counter */
+  int y;			/* counter */
+  TILE *Tile;
+
+  memset(Tiles, 0, sizeof(TILESTRUCT));
+  Tiles->Size = Size > 0 ? Size : DEFAULTTILESIZE;
+  NTileX = (Map->NX + Tiles->Size - 1) / Tiles->Size;
+  NTileY = (Map->NY + Tiles->Size - 1) / Tiles->Size;
+
+  if (!(TileOf = (int *) malloc(NTileX * NTileY * sizeof(int))))
+    ReportError((char *) Routine, 1);
+  if (!(Tiles->Tile = (TILE *) calloc(NTileX * NTileY, sizeof(TILE))))
+    ReportError((char *) Routine, 1);
+
+  /* count the active pixels in each tile and drop the empty tiles */
+  for (ty = 0; ty < NTileY; ty++) {
+    for (tx = 0; tx < NTileX; tx++) {
+      Tile = &(Tiles->Tile[Tiles->NTiles]);
+      Tile->Row = ty * Tiles->Size;
+      Tile->Col = tx * Tiles->Size;
+      Tile->First = Tiles->NCells;
+      Tile->NCells = 0;
+      for (y = Tile->Row; y < MIN(Tile->Row + Tiles->Size, Map->NY); y++)
+	for (x = Tile->Col; x < MIN(Tile->Col + Tiles->Size, Map->NX); x++)
+	  if (INBASIN(TopoMap[y][x].Mask) && ISOWNED(*Parallel, y, x))
+	    Tile->NCells++;
+      if (Tile->NCells > 0) {
+	TileOf[ty * NTileX + tx] = Tiles->NTiles++;
+	Tiles->NCells += Tile->NCells;
+      }
+      else
+	TileOf[ty * NTileX + tx] = -1;
+    }
+  }
+
+  if (!(Tiles->Cells = (COORD *) calloc(Tiles->NCells + 1, sizeof(COORD))))
+    ReportError((char *) Routine, 1);
+  if (!(Tiles->RowMajor = (long *) calloc(Tiles->NCells + 1, sizeof(long))))
+    ReportError((char *) Routine, 1);
+  if (!(Filled = (int *) calloc(Tiles->NTiles + 1, sizeof(int))))
+    ReportError((char *) Routine, 1);
+
+  /* the serial pixel loop visits the pixels of a tile row by row, in the
+     same order as they are stored in the tile */
+  for (y = 0, i = 0; y < Map->NY; y++) {
+    for (x = 0; x < Map->NX; x++) {
+      if (INBASIN(TopoMap[y][x].Mask) && ISOWNED(*Parallel, y, x)) {
+	t = TileOf[(y / Tiles->Size) * NTileX + x / Tiles->Size];
+	Tiles->RowMajor[i] = Tiles->Tile[t].First + Filled[t]++;
+	Tiles->Cells[Tiles->RowMajor[i]].N = y;
+	Tiles->Cells[Tiles->RowMajor[i]].E = x;
+	i++;
+      }
+    }
+  }
+  free(Filled);
+  free(TileOf);
+
+  Tiles->NThreads = MAX(1, MIN(NThreads, Tiles->NTiles));
+  if (Tiles->NThreads > 1)
+    StartWorkers(Tiles, Routine);
+}
+
+/*****************************************************************************
+  Function name: InitPointTiles()
+
+  Purpose      : Divide a list of points into blocks and start the worker
+                 threads
+
+  Required     :
+    TILESTRUCT *Tiles - Tiles and thread pool
+    int NThreads      - Number of threads, including the calling thread
+    int Size          - Points per block, 0 for the default
+    int NPoints       - Number of points
+    COORD *Points     - Row and column of each point
+
+  Returns      : void
+
+  Modifies     : Tiles
+
+  Comments     : For the MULTIPOINT extent, where the points are scattered
+                 over the grid.  Each tile is a block of consecutive points
+                 of the list, Tiles->Cells holds the points in list order
+                 and Tiles->RowMajor is the identity, so totals added in the
+                 order of RowMajor are added in the order of the list.  Row
+                 and Col of a tile are those of its first point.
+*****************************************************************************/
+void InitPointTiles(TILESTRUCT *Tiles, int NThreads, int Size, int NPoints,
+		    COORD *Points)
+{
+  const char *Routine = "InitPointTiles";
+  int i;			/* counter */
+  TILE *Tile;
+
+  memset(Tiles, 0, sizeof(TILESTRUCT));
+  Tiles->Size = Size > 0 ? Size : DEFAULTPOINTBLOCK;
+  Tiles->NCells = NPoints;
+  Tiles->NTiles = (NPoints + Tiles->Size - 1) / Tiles->Size;
+
+  if (!(Tiles->Tile = (TILE *) calloc(Tiles->NTiles + 1, sizeof(TILE))))
+    ReportError((char *) Routine, 1);
+  if (!(Tiles->Cells = (COORD *) calloc(NPoints + 1, sizeof(COORD))))
+    ReportError((char *) Routine, 1);
+  if (!(Tiles->RowMajor = (long *) calloc(NPoints + 1, sizeof(long))))
+    ReportError((char *) Routine, 1);
+
+  for (i = 0; i < NPoints; i++) {
+    Tiles->Cells[i] = Points[i];
+    Tiles->RowMajor[i] = i;
+  }
+  for (i = 0; i < Tiles->NTiles; i++) {
+    Tile = &(Tiles->Tile[i]);
+    Tile->First = i * Tiles->Size;
+    Tile->NCells = MIN(Tiles->Size, NPoints - Tile->First);
+    Tile->Row = Points[Tile->First].N;
+    Tile->Col = Points[Tile->First].E;
+  }
+
+  Tiles->NThreads = MAX(1, MIN(NThreads, Tiles->NTiles));
+  if (Tiles->NThreads > 1)
+    StartWorkers(Tiles, Routine);
+}
+
+/*****************************************************************************
+  Function name: RunTiles()
+
+  Purpose      : Call a function for every tile
+
+  Required     :
+    TILESTRUCT *Tiles - Tiles and thread pool
+    TILEFUNC Func     - Function called as Func(Arg, Tile, Thread), where
+                        Thread is the number of the calling thread, from 0
+                        to Tiles->NThreads - 1
+    void *Arg         - Argument passed to Func
+
+  Returns      : void
+
+  Modifies     : whatever Func modifies
+
+  Comments     : Returns when all tiles are done.  Func must only modify
+                 the pixels of its tile and data owned by Thread.  The
+                 worker threads run Func with the globals of the calling
+                 thread (globals.h).
+*****************************************************************************/
+void RunTiles(TILESTRUCT *Tiles, TILEFUNC Func, void *Arg)
+{
+  int t;			/* tile counter */
+
+  if (Tiles->NThreads <= 1) {
+    for (t = 0; t < Tiles->NTiles; t++)
+      Func(Arg, &(Tiles->Tile[t]), 0);
+    return;
+  }
+
+  FillQueues(Tiles);
+
+  pthread_mutex_lock(&(Tiles->Lock));
+  SaveGlobals(&(Tiles->Globals));
+  Tiles->Func = Func;
+  Tiles->Arg = Arg;
+  Tiles->Busy = Tiles->NThreads - 1;
+  Tiles->Generation++;
+  pthread_cond_broadcast(&(Tiles->Start));
+  pthread_mutex_unlock(&(Tiles->Lock));
+
+  RunQueue(Tiles, 0);
+
+  pthread_mutex_lock(&(Tiles->Lock));
+  while (Tiles->Busy > 0)
+    pthread_cond_wait(&(Tiles->Done), &(Tiles->Lock));
+  pthread_mutex_unlock(&(Tiles->Lock));
+}
+
+/*****************************************************************************
+  Function name: TileThread()
+
+  Purpose      : Number of the calling thread in the current run
+
+  Required     : None
+
+  Returns      : int - from 1 to NThreads - 1 for the worker threads, 0 for
+                       any other thread
+
+  Modifies     : None
+
+  Comments     : For callbacks that are called from a tile function but
+                 do not get the thread number
+*****************************************************************************/
+int TileThread(void)
+{
+  pthread_once(&ThreadKeyOnce, CreateThreadKey);
+  return (int) (long) pthread_getspecific(ThreadKey);
+}
+
+/*****************************************************************************
+  Function name: EndTiles()
+
+  Purpose      : Stop the worker threads and free the tiles
+
+  Required     :
+    TILESTRUCT *Tiles - Tiles and thread pool
+
+  Returns      : void
+
+  Modifies     : Tiles
+*****************************************************************************/
+void EndTiles(TILESTRUCT *Tiles)
+{
+  int i;			/* counter */
+
+  if (Tiles->NThreads > 1) {
+    pthread_mutex_lock(&(Tiles->Lock));
+    Tiles->Quit = TRUE;
+    pthread_cond_broadcast(&(Tiles->Start));
+    pthread_mutex_unlock(&(Tiles->Lock));
+    for (i = 1; i < Tiles->NThreads; i++)
+      pthread_join(Tiles->Threads[i], NULL);
+    for (i = 0; i < Tiles->NThreads; i++)
+      pthread_mutex_destroy(&(Tiles->Queue[i].Lock));
+    pthread_cond_destroy(&(Tiles->Done));
+    pthread_cond_destroy(&(Tiles->Start));
+    pthread_mutex_destroy(&(Tiles->Lock));
+  }
+
+  free(Tiles->Threads);
+  free(Tiles->Queue);
+  free(Tiles->RowMajor);
+  free(Tiles->Cells);
+  free(Tiles->Tile);
+  memset(Tiles, 0, sizeof(TILESTRUCT));
+}
+
+/*****************************************************************************
+  CreateThreadKey()
+*****************************************************************************/
+static void CreateThreadKey(void)
+{
+  pthread_key_create(&ThreadKey, NULL);
+}
+
+/*****************************************************************************
+  StartWorkers()
+
+  Make the queues and start worker threads 1 .. NThreads - 1
+*****************************************************************************/
+static void StartWorkers(TILESTRUCT *Tiles, const char *Routine)
+{
+  int i;			/* counter */
+
+  pthread_once(&ThreadKeyOnce, CreateThreadKey);
+  pthread_mutex_init(&(Tiles->Lock), NULL);
+  pthread_cond_init(&(Tiles->Start), NULL);
+  pthread_cond_init(&(Tiles->Done), NULL);
+
+  if (!(Tiles->Queue = (TILEQUEUE *) calloc(Tiles->NThreads,
+					    sizeof(TILEQUEUE))))
+    ReportError((char *) Routine, 1);
+  if (!(Tiles->Threads = (pthread_t *) calloc(Tiles->NThreads,
+					      sizeof(pthread_t))))
+    ReportError((char *) Routine, 1);
+
+  for (i = 0; i < Tiles->NThreads; i++) {
+    Tiles->Queue[i].Tiles = Tiles;
+    Tiles->Queue[i].Thread = i;
+    pthread_mutex_init(&(Tiles->Queue[i].Lock), NULL);
+  }
+  for (i = 1; i < Tiles->NThreads; i++)
+    if (pthread_create(&(Tiles->Threads[i]), NULL, TileWorker,
+		       &(Tiles->Queue[i])))
+      ReportError((char *) Routine, 77);
+}
+
+/*****************************************************************************
+  FillQueues()
+
+  Give each thread a contiguous block of tiles with about the same number
+  of active pixels, so that neighbouring tiles run on the same thread and
+  stealing is only needed to even out the cost per pixel
+*****************************************************************************/
+static void FillQueues(TILESTRUCT *Tiles)
+{
+  int Thread;			/* thread counter */
+  int t;			/* tile counter */
+
+  for (Thread = 0, t = 0; Thread < Tiles->NThreads; Thread++) {
+    Tiles->Queue[Thread].Front = t;
+    while (t < Tiles->NTiles &&
+	   (Thread == Tiles->NThreads - 1 ||
+	    (double) Tiles->Tile[t].First <
+	    (double) Tiles->NCells * (Thread + 1) / Tiles->NThreads))
+      t++;
+    Tiles->Queue[Thread].Back = t;
+  }
+}
+
+/*****************************************************************************
+  RunQueue()
+
+  Run tiles until all queues are empty
+*****************************************************************************/
+static void RunQueue(TILESTRUCT *Tiles, int Thread)
+{
+  int t;			/* tile */
+
+  while ((t = TakeTile(Tiles, Thread)) >= 0)
+    Tiles->Func(Tiles->Arg, &(Tiles->Tile[t]), Thread);
+}
+
+/*****************************************************************************
+  TakeTile()
+
+  Take the next tile from the front of the own queue, or steal the last
+  tile of the next queue that is not empty.  Returns -1 if all queues are
+  empty.  No tiles are added during a run, so a thread that finds all
+  queues empty is done.
+*****************************************************************************/
+static int TakeTile(TILESTRUCT *Tiles, int Thread)
+{
+  TILEQUEUE *Queue;
+  int i;			/* counter */
+  int t = -1;			/* tile */
+
+  Queue = &(Tiles->Queue[Thread]);
+  pthread_mutex_lock(&(Queue->Lock));
+  if (Queue->Front < Queue->Back)
+    t = Queue->Front++;
+  pthread_mutex_unlock(&(Queue->Lock));
+  if (t >= 0)
+    return t;
+
+  for (i = 1; i < Tiles->NThreads && t < 0; i++) {
+    Queue = &(Tiles->Queue[(Thread + i) % Tiles->NThreads]);
+    pthread_mutex_lock(&(Queue->Lock));
+    if (Queue->Front < Queue->Back)
+      t = --Queue->Back;
+    pthread_mutex_unlock(&(Queue->Lock));
+  }
+  return t;
+}
+
+/*****************************************************************************
+  TileWorker()
+
+  Worker thread: wait for a run, work on the tiles and report back
+*****************************************************************************/
+static void *TileWorker(void *Arg)
+{
+  TILEQUEUE *Queue = (TILEQUEUE *) Arg;
+  TILESTRUCT *Tiles = Queue->Tiles;
+  int Seen = 0;			/* Last run worked on */
+
+  pthread_setspecific(ThreadKey, (void *) (long) Queue->Thread);
+
+  for (;;) {
+    pthread_mutex_lock(&(Tiles->Lock));
+    while (Tiles->Generation == Seen && !Tiles->Quit)
+      pthread_cond_wait(&(Tiles->Start), &(Tiles->Lock));
+    if (Tiles->Quit) {
+      pthread_mutex_unlock(&(Tiles->Lock));
+      break;
+    }
+    Seen = Tiles->Generation;
+    RestoreGlobals(&(Tiles->Globals));
+    pthread_mutex_unlock(&(Tiles->Lock));
+    SetProfileThread(Queue->Thread);
+
+    RunQueue(Tiles, Queue->Thread);
+
+    pthread_mutex_lock(&(Tiles->Lock));
+    if (--Tiles->Busy == 0)
+      pthread_cond_signal(&(Tiles->Done));
+    pthread_mutex_unlock(&(Tiles->Lock));
+  }
+  return NULL;
+}
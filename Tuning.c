@@ -0,0 +1,239 @@
+/*
+ * SUMMARY:      Tuning.c - Tuning file of a basin and processor
+ * USAGE:        Part of DHSVM
+ *
+ * AUTHOR:       DHSVM development team
+ * ORG:          University of Washington, Department of Civil Engineering
+ * E-MAIL:
+ * ORIG-DATE:    Oct-2026
+ * DESCRIPTION:  Read and write Tuning.txt and fill in the options that the
+ *               configuration file leaves out, see tuning.h
+ * DESCRIP-END.
+ * FUNCTIONS:    ApplyTuning()
+ *               WriteTuning()
+ * COMMENTS:     The tuning file has the format of the configuration file,
+ *               with a [TUNING] section.  The processor is identified by
+ *               the model name in /proc/cpuinfo, or by the instruction set
+ *               where there is no /proc/cpuinfo, and the number of online
+ *               processors.
+ * $Id: Tuning.c,v 1.0 2026/10/17 Exp $
+ */
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include "settings.h"
+#include "data.h"
+#include "DHSVMerror.h"
+#include "fileio.h"
+#include "getinit.h"
+#include "dispatch.h"
+#include "tuning.h"
+
+#define MAXMODELNAME 80		/* Longest processor name kept (chars) */
+
+static int ReadTuning(char *Path, MAPSIZE *Map, TUNING *Tuned);
+static void BasinKey(MAPSIZE *Map, char *Key);
+static void HardwareKey(char *Key);
+
+/*****************************************************************************
+  Function name: ApplyTuning()
+
+  Purpose      : Fill in the tuned options that the configuration file
+                 leaves out
+
+  Required     :
+    OPTIONSTRUCT *Options - Options of the run, NThreads, TileSize and
+                            OutputBuffer are 0 when they are left out
+    MAPSIZE *Map          - Size of the basin
+    char *Path            - Output directory
+    TUNING *Candidate     - Settings timed by DHSVM -autotune, or NULL
+
+  Returns      : void
+
+  Modifies     : Options->NThreads, Options->TileSize, Options->OutputBuffer
+                 and the buffer of the output files, see SetOutputBuffer()
+
+  Comments     : Called right after InitDump(), which sets the output
+                 directory.  While DHSVM -autotune times a candidate the
+                 candidate replaces the options of the configuration file
+*****************************************************************************/
+void ApplyTuning(OPTIONSTRUCT *Options, MAPSIZE *Map, char *Path,
+		 TUNING *Candidate)
+{
+  TUNING Tuned;			/* Settings of the tuning file */
+
+  if (Candidate) {
+    Options->NThreads = Candidate->NThreads;
+    Options->TileSize = Candidate->TileSize;
+    Options->OutputBuffer = Candidate->OutputBuffer;
+  }
+  else if ((Options->NThreads == 0 || Options->TileSize == 0 ||
+	    Options->OutputBuffer == 0) && ReadTuning(Path, Map, &Tuned)) {
+    if (Options->NThreads == 0)
+      Options->NThreads = Tuned.NThreads;
+    if (Options->TileSize == 0)
+      Options->TileSize = Tuned.TileSize;
+    if (Options->OutputBuffer == 0)
+      Options->OutputBuffer = Tuned.OutputBuffer;
+    printf("Using the tuned settings of %s%s: %d threads, tile size %d, "
+	   "output buffer %d\n", Path, TUNINGFILE, Options->NThreads,
+	   Options->TileSize, Options->OutputBuffer);
+  }
+
+  if (Options->NThreads == 0)
+    Options->NThreads = 1;
+  SetOutputBuffer(Options->OutputBuffer);
+}
+
+/*****************************************************************************
+  Function name: WriteTuning()
+
+  Purpose      : Write the fastest settings found by DHSVM -autotune
+
+  Required     :
+    char *Path     - Output directory
+    MAPSIZE *Map   - Size of the basin
+    TUNING *Best   - Fastest settings
+    double Seconds - Wall time per time step of the fastest settings (s)
+
+  Returns      : void
+
+  Modifies     : Tuning.txt in the output directory
+
+  Comments     :
+*****************************************************************************/
+void WriteTuning(char *Path, MAPSIZE *Map, TUNING *Best, double Seconds)
+{
+  FILE *OutFile;		/* Tuning file */
+  char FileName[BUFSIZE + 1];	/* Name of the tuning file */
+  char Basin[BUFSIZE + 1];	/* Key of the basin */
+  char Hardware[BUFSIZE + 1];	/* Key of the processor */
+
+  sprintf(FileName, "%s%s", Path, TUNINGFILE);
+  BasinKey(Map, Basin);
+  HardwareKey(Hardware);
+
+  OpenFile(&OutFile, FileName, "w", TRUE);
+  fprintf(OutFile, "# Written by DHSVM -autotune.  Options in the "
+	  "configuration file win over\n");
+  fprintf(OutFile, "# these settings, delete this file to go back to the "
+	  "defaults\n");
+  fprintf(OutFile, "[TUNING]\n");
+  fprintf(OutFile, "Basin            = %s\n", Basin);
+  fprintf(OutFile, "Hardware         = %s\n", Hardware);
+  fprintf(OutFile, "Threads          = %d\n", Best->NThreads);
+  fprintf(OutFile, "Tile Size        = %d\n", Best->TileSize);
+  fprintf(OutFile, "Output Buffer    = %d\n", Best->OutputBuffer);
+  fprintf(OutFile, "Seconds Per Step = %.6f\n", Seconds);
+  if (fclose(OutFile) != 0)
+    ReportError(FileName, 78);
+
+  printf("Wrote %s: %d threads, tile size %d, output buffer %d, "
+	 "%.6f s per time step\n", FileName, Best->NThreads, Best->TileSize,
+	 Best->OutputBuffer, Seconds);
+}
+
+/*****************************************************************************
+  ReadTuning()
+
+  Read the tuning file in the output directory.  Returns FALSE if there is
+  no tuning file or if it was written for another basin or processor
+*****************************************************************************/
+static int ReadTuning(char *Path, MAPSIZE *Map, TUNING *Tuned)
+{
+  struct stat FileInfo;
+  LISTPTR Input = NULL;		/* Linked list with input strings */
+  char FileName[BUFSIZE + 1];	/* Name of the tuning file */
+  char Key[BUFSIZE + 1];	/* Key of this run */
+  char Entry[BUFSIZE + 1];	/* Key in the tuning file */
+  int Match;			/* TRUE if the keys are the same */
+
+  sprintf(FileName, "%s%s", Path, TUNINGFILE);
+  if (stat(FileName, &FileInfo) != 0)
+    return FALSE;
+
+  ReadInitFile(FileName, &Input);
+
+  BasinKey(Map, Key);
+  GetInitString("TUNING", "BASIN", "", Entry, BUFSIZE, Input);
+  Match = (strcmp(Key, Entry) == 0);
+  HardwareKey(Key);
+  GetInitString("TUNING", "HARDWARE", "", Entry, BUFSIZE, Input);
+  Match = Match && (strcmp(Key, Entry) == 0);
+
+  Tuned->NThreads = (int) GetInitLong("TUNING", "THREADS", 0, Input);
+  Tuned->TileSize = (int) GetInitLong("TUNING", "TILE SIZE", 0, Input);
+  Tuned->OutputBuffer = (int) GetInitLong("TUNING", "OUTPUT BUFFER", 0,
+					  Input);
+  DeleteList(Input);
+
+  if (!Match) {
+    printf("Ignoring %s, it was written for another basin or processor\n",
+	   FileName);
+    return FALSE;
+  }
+  if (Tuned->NThreads < 1 || Tuned->TileSize < 1 || Tuned->OutputBuffer < 0)
+    ReportError(FileName, 51);
+
+  return TRUE;
+}
+
+/*****************************************************************************
+  BasinKey()
+
+  Size of the basin, as written to the tuning file
+*****************************************************************************/
+static void BasinKey(MAPSIZE *Map, char *Key)
+{
+  sprintf(Key, "%d rows, %d columns, %ld pixels", Map->NY, Map->NX,
+	  Map->NumCells);
+}
+
+/*****************************************************************************
+  HardwareKey()
+
+  Processor model and number of online processors, as written to the tuning
+  file.  Runs of white space are collapsed and the characters that have a
+  meaning in the configuration file are dropped
+*****************************************************************************/
+static void HardwareKey(char *Key)
+{
+  FILE *CpuInfo;		/* /proc/cpuinfo */
+  char Line[BUFSIZE + 1];	/* Line of /proc/cpuinfo */
+  char Model[MAXMODELNAME + 1];	/* Processor model */
+  char Name[MAXMODELNAME + 1];	/* Model name in /proc/cpuinfo */
+  char *Value;			/* Model name in Line */
+  int n;			/* Length of Model */
+
+  strcpy(Model, CpuName(DetectCpu()));
+  if ((CpuInfo = fopen("/proc/cpuinfo", "r"))) {
+    while (fgets(Line, BUFSIZE, CpuInfo)) {
+      if (strncmp(Line, "model name", 10) == 0 &&
+	  (Value = strchr(Line, ':'))) {
+	for (n = 0, Value++; *Value != '\0' && n < MAXMODELNAME; Value++) {
+	  if (*Value == OPENCOMMENT || *Value == SEPARATOR ||
+	      isspace((int) *Value)) {
+	    if (n > 0 && Name[n - 1] != ' ')
+	      Name[n++] = ' ';
+	  }
+	  else
+	    Name[n++] = *Value;
+	}
+	if (n > 0 && Name[n - 1] == ' ')
+	  n--;
+	Name[n] = '\0';
+	if (n > 0)
+	  strcpy(Model, Name);
+	break;
+      }
+    }
+    fclose(CpuInfo);
+  }
+
+  sprintf(Key, "%s, %ld processors", Model, sysconf(_SC_NPROCESSORS_ONLN));
+}
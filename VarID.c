@@ -31,7 +31,7 @@
 #ifdef TEST_VARID
 char *fileext = ".test";
 #else
-extern char fileext[];
+extern __thread char fileext[];
 #endif
 
 struct {
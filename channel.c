@@ -861,6 +861,7 @@ void channel_free_network(Channel * net)
   if (net->next != NULL) {
     channel_free_network(net->next);
   }
+  free(net->record_name);
   free(net);
 }
 
@@ -24,6 +24,7 @@
 #include "errorhandler.h"
 #include "settings.h"
 #include "data.h"
+#include "compact.h"
 #include "DHSVMChannel.h"
 #include "constants.h"
 
@@ -43,9 +44,12 @@ char channel_grid_has_intersection(ChannelMapPtr ** map, int Currid, int Nextid,
 /* -------------------------------------------------------------
    local module variables
    ------------------------------------------------------------- */
-static int channel_grid_cols = 0;
-static int channel_grid_rows = 0;
-static char channel_grid_initialized = FALSE;
+/* module state of the thread that runs a model instance, see globals.h */
+static __thread int channel_grid_cols = 0;
+static __thread int channel_grid_rows = 0;
+static __thread char channel_grid_initialized = FALSE;
+static __thread ChannelInflowHook channel_grid_hook = NULL;
+static __thread void *channel_grid_hook_arg = NULL;
 
 /* -------------------------------------------------------------
    RouteDebrisFlow
@@ -414,6 +418,36 @@ void channel_grid_free_map(ChannelMapPtr ** map)
   free(map);
 }
 
+/* -------------------------------------------------------------
+   channel_grid_crop_map
+   Returns a map of the cols by rows cells that start at col0,
+   row0.  The records of the cells outside the window are freed,
+   together with map.  channel_grid_init() has to be called with
+   the new size once all maps are cropped
+   ------------------------------------------------------------- */
+ChannelMapPtr **channel_grid_crop_map(ChannelMapPtr ** map, int col0,
+				      int row0, int cols, int rows)
+{
+  ChannelMapPtr **cropped;
+  int c, r;
+
+  if (map == NULL)
+    return (NULL);
+
+  cropped = channel_grid_create_map(cols, rows);
+  for (c = 0; c < channel_grid_cols; c++) {
+    for (r = 0; r < channel_grid_rows; r++) {
+      if (c >= col0 && c < col0 + cols && r >= row0 && r < row0 + rows)
+	cropped[c - col0][r - row0] = map[c][r];
+      else if (map[c][r] != NULL)
+	free_channel_map_record(map[c][r]);
+    }
+  }
+  free(map[0]);
+  free(map);
+  return (cropped);
+}
+
 /* -------------------------------------------------------------
    ------------------- Input Functions -------------------------
    ------------------------------------------------------------- */
@@ -542,12 +576,12 @@ ChannelMapPtr **channel_grid_read_map(Channel * net, const char *file,
 	  break;
 	case 4:
 	  cell->cut_height = map_fields[i].value.real;
-	  if (cell->cut_height > SoilMap[row][col].Depth) {
+	  if (cell->cut_height > SOILDEPTH(SoilMap[row][col])) {
 	    printf("warning overriding cut depths with 0.95 soil depth \n");
-	    cell->cut_height = SoilMap[row][col].Depth*0.95;
+	    cell->cut_height = SOILDEPTH(SoilMap[row][col])*0.95;
 	  }
 	  if (cell->cut_height < 0.0
-	      || cell->cut_height > SoilMap[row][col].Depth) {
+	      || cell->cut_height > SOILDEPTH(SoilMap[row][col])) {
 	    error_handler(ERRHDL_ERROR, "%s, line %d: bad cut_depth", file,
 			  table_lineno());
 	    err++;
@@ -755,12 +789,30 @@ void channel_grid_inc_inflow(ChannelMapPtr ** map, int col, int row, float mass)
      }
    */
 
+  if (channel_grid_hook != NULL) {
+    (*channel_grid_hook) (map, col, row, mass, channel_grid_hook_arg);
+    return;
+  }
+
   while (cell != NULL) {
     cell->channel->lateral_inflow += mass * cell->length / len;
     cell = cell->next;
   }
 }
 
+/* -------------------------------------------------------------
+   channel_grid_inflow_hook
+   While a hook is set, channel_grid_inc_inflow passes the mass to
+   the hook instead of adding it to the channels.  Used to collect the
+   inflows of the pixels of all MPI ranks, see Parallel.c.  arg is
+   passed to the hook.  NULL removes the hook.
+   ------------------------------------------------------------- */
+void channel_grid_inflow_hook(ChannelInflowHook hook, void *arg)
+{
+  channel_grid_hook = hook;
+  channel_grid_hook_arg = arg;
+}
+
 /* -------------------------------------------------------------
    channel_grid_outflow
    If the channel(s) within the cell are marked as ``sinks'', this
@@ -907,6 +959,32 @@ void channel_grid_done(void)
   /* ? */
 }
 
+/* -------------------------------------------------------------
+   channel_grid_save_state
+   Copies the module state into State, so that several model
+   instances in one process can each keep their own, see globals.h
+   ------------------------------------------------------------- */
+void channel_grid_save_state(ChannelGridState * State)
+{
+  State->cols = channel_grid_cols;
+  State->rows = channel_grid_rows;
+  State->initialized = channel_grid_initialized;
+  State->hook = channel_grid_hook;
+  State->hook_arg = channel_grid_hook_arg;
+}
+
+/* -------------------------------------------------------------
+   channel_grid_restore_state
+   ------------------------------------------------------------- */
+void channel_grid_restore_state(ChannelGridState * State)
+{
+  channel_grid_cols = State->cols;
+  channel_grid_rows = State->rows;
+  channel_grid_initialized = State->initialized;
+  channel_grid_hook = State->hook;
+  channel_grid_hook_arg = State->hook_arg;
+}
+
 #ifdef TEST_MAIN
 /* -------------------------------------------------------------
    interpolate
@@ -41,6 +41,22 @@ struct _channel_map_rec_ {
 typedef struct _channel_map_rec_ ChannelMapRec;
 typedef struct _channel_map_rec_ *ChannelMapPtr;
 
+typedef void (*ChannelInflowHook) (ChannelMapPtr ** map, int col, int row,
+				   float mass, void *arg);
+
+/* -------------------------------------------------------------
+   struct ChannelGridState
+   The module state, saved and restored when several model instances
+   share the process
+   ------------------------------------------------------------- */
+typedef struct {
+  int cols;
+  int rows;
+  char initialized;
+  ChannelInflowHook hook;
+  void *hook_arg;
+} ChannelGridState;
+
 /* -------------------------------------------------------------
    externally available routines
    ------------------------------------------------------------- */
@@ -49,6 +65,8 @@ typedef struct _channel_map_rec_ *ChannelMapPtr;
 
 void channel_grid_init(int cols, int rows);
 void channel_grid_done(void);
+void channel_grid_save_state(ChannelGridState * State);
+void channel_grid_restore_state(ChannelGridState * State);
 
 				/* Input Functions */
 
@@ -65,6 +83,7 @@ double channel_grid_cell_bankht(ChannelMapPtr ** map, int col, int row);
 
 void channel_grid_inc_inflow(ChannelMapPtr ** map, int col, int row,
 			     float mass);
+void channel_grid_inflow_hook(ChannelInflowHook hook, void *arg);
 double channel_grid_outflow(ChannelMapPtr ** map, int col, int row);
 double channel_grid_sed_outflow(ChannelMapPtr ** map, int col, int row, int i);
 double channel_grid_flowlength(ChannelMapPtr ** map, int col, int row, 
@@ -75,5 +94,7 @@ ChannelClass* channel_grid_class(ChannelMapPtr ** map, int col, int row);
 				/* clean up */
 
 void channel_grid_free_map(ChannelMapPtr ** map);
+ChannelMapPtr **channel_grid_crop_map(ChannelMapPtr ** map, int col0,
+				      int row0, int cols, int rows);
 
 #endif
@@ -0,0 +1,165 @@
+/*
+ * SUMMARY:      compact.h - header file for the compact storage of the
+ *               static maps
+ * USAGE:        Part of DHSVM
+ *
+ * AUTHOR:       DHSVM development team
+ * ORG:          University of Washington, Department of Civil Engineering
+ * E-MAIL:
+ * ORIG-DATE:    Oct-2026
+ * DESCRIPTION:  When DHSVM is built with -DCOMPACT_MAPS (DEFS in the
+ *               makefile) the static and slowly varying fields are stored
+ *               in 16 bits instead of float:
+ *               - the elevation, slope and aspect of the pixels (TOPOPIX),
+ *                 and the soil depth (SOILPIX)
+ *               - the elevation, bedrock elevation and topographic index of
+ *                 the mass wasting grid (FINEPIX)
+ *               - the MM5 input maps, which are encoded again every time
+ *                 step when they are read
+ *               - the sky view factor, precipitation lapse rate and wind
+ *                 model maps, encoded at the end of the initialization
+ *               The elevations, the aspect, the soil depth and the maps
+ *               are fixed point with an offset and a scale per field,
+ *                 value = Offset + Scale * code,
+ *               with the offset at the smallest value and 65535 codes up
+ *               to the largest, so the error is at most half a code step.
+ *               The slope and the topographic index are half precision
+ *               floats (11 significant bits), because their small values
+ *               matter as much as the large ones.  The slope, the aspect,
+ *               the flow directions and the order of the pixels are
+ *               computed from the elevations as read, before they are
+ *               rounded.  The fields are read
+ *               with TOPODEM(), SOILDEPTH(), ... and the maps with
+ *               COMPACTVALUE() and MM5VALUE(), which decode them.  Without
+ *               COMPACT_MAPS the macros read the float fields and the
+ *               results do not change.
+ *               The 16-bit fields of the pixel structs are packed with the
+ *               other small fields, which takes TOPOPIX from 48 to 40
+ *               bytes, SOILPIX from 128 to 120 bytes (the soil type is
+ *               then 16 bits as well) and FINEPIX from 44 to 36 bytes.
+ * DESCRIP-END.
+ * FUNCTIONS:
+ * COMMENTS:     The scale and the largest error of each field are printed
+ *               when it is encoded, programs/RunRegression.scr -compact
+ *               compares the results of a COMPACT_MAPS build with the
+ *               full precision results.  The dynamic fields of the mass
+ *               wasting grid (sediment, SatThickness, ...) stay float, they
+ *               change by small amounts every time step that 16 bits would
+ *               lose.  The shadow maps are already stored in one byte per
+ *               pixel.  The maps are not compacted when there are X11
+ *               graphics, which draw the float maps.  Basin.DEM and
+ *               Soil.Depth are not available through dhsvm_get_field(),
+ *               which only returns float fields.
+ * $Id: compact.h,v 1.0 2026/10/17 Exp $
+ */
+
+#ifndef COMPACT_H
+#define COMPACT_H
+
+#include "settings.h"
+#include "data.h"
+
+#define MAXCODE 65535		/* Largest code */
+
+/* fields of the pixels stored in fixed point */
+enum { ELEVATION_CODE, ASPECT_CODE, SOILDEPTH_CODE, FINEDEM_CODE,
+  BEDROCK_CODE, NFIXEDCODES };
+
+typedef struct {
+  float Offset;			/* Value of code 0 */
+  float Scale;			/* Value of one code step */
+} FIXEDSCALE;
+
+typedef struct {
+  float Offset;			/* Value of code 0 */
+  float Scale;			/* Value of one code step */
+  int NX;			/* Columns of the map */
+  unsigned short *Code;		/* Codes of the pixels, row by row */
+} COMPACTMAP;
+
+typedef struct {
+  int Active;			/* TRUE if the maps below replace the float
+				   maps */
+  COMPACTMAP SkyView;		/* Sky view factor */
+  COMPACTMAP PrecipLapse;	/* Precipitation lapse rate */
+  int NWind;			/* Number of wind model maps */
+  COMPACTMAP *Wind;		/* Wind model maps */
+} COMPACTMAPS;
+
+/* scales of the fixed point fields, they belong to the thread that runs
+   the model instance, see globals.h */
+extern __thread FIXEDSCALE FixedScale[NFIXEDCODES];
+
+/* value of a pixel of a compact map */
+#define COMPACTVALUE(Compact, y, x) \
+  ((Compact)->Offset + (Compact)->Scale * \
+   (float) (Compact)->Code[(long) (y) * (Compact)->NX + (x)])
+
+#ifdef COMPACT_MAPS
+#define FIXEDVALUE(Field, Code) \
+  (FixedScale[Field].Offset + FixedScale[Field].Scale * (float) (Code))
+#define FIXEDCODE(Field, Value) FixedCode(Field, Value)
+#define HALFVALUE(Code) HalfToFloat(Code)
+#define HALFCODE(Value) FloatToHalf(Value)
+
+/* the MM5 input maps, one compact map each.  A map is read into Scratch
+   and then encoded.  MM5PERTURBED() is the value of a map shifted and then
+   multiplied, rounded as if the map itself had been changed, see
+   PerturbMetData() */
+typedef COMPACTMAP *MM5MAPS;
+#define MM5VALUE(MM5Input, n, y, x) COMPACTVALUE(&((MM5Input)[n]), y, x)
+#define MM5PERTURBED(MM5Input, n, y, x, Shift, Multiplier) \
+  (((MM5Input)[n].Offset + (float) (Shift)) * (float) (Multiplier) + \
+   (MM5Input)[n].Scale * (float) (Multiplier) * \
+   (float) (MM5Input)[n].Code[(long) (y) * (MM5Input)[n].NX + (x)])
+#define MM5ROWS(MM5Input, n, Scratch) (Scratch)
+#define STOREMM5(MM5Input, n, Scratch, NY, NX) \
+  EncodeMap(&((MM5Input)[n]), Scratch, NY, NX)
+#else
+#define FIXEDVALUE(Field, Code) (Code)
+#define FIXEDCODE(Field, Value) (Value)
+#define HALFVALUE(Code) (Code)
+#define HALFCODE(Value) (Value)
+
+typedef float ***MM5MAPS;
+#define MM5VALUE(MM5Input, n, y, x) ((MM5Input)[n][y][x])
+#define MM5PERTURBED(MM5Input, n, y, x, Shift, Multiplier) \
+  (((MM5Input)[n][y][x] + (float) (Shift)) * (float) (Multiplier))
+#define MM5ROWS(MM5Input, n, Scratch) ((MM5Input)[n])
+#define STOREMM5(MM5Input, n, Scratch, NY, NX) ((void) 0)
+#endif
+
+/* the static fields of a pixel */
+#define TOPODEM(Topo) FIXEDVALUE(ELEVATION_CODE, (Topo).Dem)
+#define TOPOSLOPE(Topo) HALFVALUE((Topo).Slope)
+#define TOPOASPECT(Topo) FIXEDVALUE(ASPECT_CODE, (Topo).Aspect)
+#define SOILDEPTH(Soil) FIXEDVALUE(SOILDEPTH_CODE, (Soil).Depth)
+#define FINEDEM(Fine) FIXEDVALUE(FINEDEM_CODE, (Fine).Dem)
+#define FINEBEDROCK(Fine) FIXEDVALUE(BEDROCK_CODE, (Fine).bedrock)
+#define FINETOPOINDEX(Fine) HALFVALUE((Fine).TopoIndex)
+
+#define SETTOPODEM(Topo, Value) \
+  ((Topo).Dem = FIXEDCODE(ELEVATION_CODE, Value))
+#define SETTOPOSLOPE(Topo, Value) ((Topo).Slope = HALFCODE(Value))
+#define SETTOPOASPECT(Topo, Value) \
+  ((Topo).Aspect = FIXEDCODE(ASPECT_CODE, Value))
+#define SETSOILDEPTH(Soil, Value) \
+  ((Soil).Depth = FIXEDCODE(SOILDEPTH_CODE, Value))
+#define SETFINEDEM(Fine, Value) \
+  ((Fine).Dem = FIXEDCODE(FINEDEM_CODE, Value))
+#define SETFINEBEDROCK(Fine, Value) \
+  ((Fine).bedrock = FIXEDCODE(BEDROCK_CODE, Value))
+#define SETFINETOPOINDEX(Fine, Value) ((Fine).TopoIndex = HALFCODE(Value))
+
+void CompactMap(COMPACTMAP *Compact, float ***Map, int NY, int NX,
+		const char *Name);
+void CompactMaps(COMPACTMAPS *Compact, MAPSIZE *Map, float ***SkyViewMap,
+		 float ***PrecipLapseMap, float ****WindModel, int NWindMaps);
+double EncodeMap(COMPACTMAP *Compact, float **Map, int NY, int NX);
+unsigned short FixedCode(int Field, float Value);
+unsigned short FloatToHalf(float Value);
+void FreeCompactMaps(COMPACTMAPS *Compact);
+float HalfToFloat(unsigned short Code);
+void SetFixedScale(int Field, const char *Name, float Min, float Max);
+
+#endif
@@ -110,31 +110,41 @@
 
 /**************** extern constants - see globals.c ****************/
 
-extern float LAI_SNOW_MULTIPLIER;	/* multiplier to calculate the amount
-					   of available snow interception as 
-					   a function of LAI */
-extern float LAI_WATER_MULTIPLIER;	/* multiplier to determine maximum
-					   interception storage as a function of
-					   LAI  */
-extern float LIQUID_WATER_CAPACITY;	/* water holding capacity of snow as a
-					   fraction of snow-water-equivalent */
-extern float MAX_SNOW_TEMP;	/* maximum temperature at which snow
-				   can occur (C) */
-extern float MIN_INTERCEPTION_STORAGE;	/* the amount of snow on the canopy
-					   that can only be melted off. (m) */
-extern float MIN_RAIN_TEMP;	/* minimum temperature at which rain
-				   can occur (C) */
-extern unsigned char OUTSIDEBASIN;	/* Mask value indicating outside the basin */
-extern float PRECIPLAPSE;	/* Precipitation lapse rate in m/timestep / m */
-extern float TEMPLAPSE;		/* Temperature lapse rate in C/m */
-extern int NWINDMAPS;		/* Number of wind maps in case the wind source
-				   is MODEL */
-extern float Z0_GROUND;		/* Roughness length for bare soil (m) */
-extern float Z0_SNOW;		/* Roughness length for snow (m) */
-extern float Zref;		/* Reference height (m) */
-extern float MASSITER;           /* Maximum number of iterations. */
-extern float DEBRISd50;          /* (mm) */
-extern float DEBRISd90;          /* (mm) */ 
-extern float CHANNELd50;         /* Currently not used */
-extern float CHANNELd90;         /* Currently not used */
+/* the constants belong to the thread that runs a model instance, see
+   globals.h */
+extern __thread float LAI_SNOW_MULTIPLIER;	/* multiplier to calculate
+						   the amount of available
+						   snow interception as a
+						   function of LAI */
+extern __thread float LAI_WATER_MULTIPLIER;	/* multiplier to determine
+						   maximum interception
+						   storage as a function of
+						   LAI */
+extern __thread float LIQUID_WATER_CAPACITY;	/* water holding capacity of
+						   snow as a fraction of
+						   snow-water-equivalent */
+extern __thread float MAX_SNOW_TEMP;	/* maximum temperature at which snow
+					   can occur (C) */
+extern __thread float MIN_INTERCEPTION_STORAGE;	/* the amount of snow on
+							   the canopy that can
+							   only be melted off.
+							   (m) */
+extern __thread float MIN_RAIN_TEMP;	/* minimum temperature at which rain
+					   can occur (C) */
+extern __thread unsigned char OUTSIDEBASIN;	/* Mask value indicating
+						   outside the basin */
+extern __thread float PRECIPLAPSE;	/* Precipitation lapse rate in
+					   m/timestep / m */
+extern __thread float TEMPLAPSE;	/* Temperature lapse rate in C/m */
+extern __thread int NWINDMAPS;	/* Number of wind maps in case the wind
+				   source is MODEL */
+extern __thread float Z0_GROUND;	/* Roughness length for bare soil
+					   (m) */
+extern __thread float Z0_SNOW;	/* Roughness length for snow (m) */
+extern __thread float Zref;	/* Reference height (m) */
+extern __thread float MASSITER;	/* Maximum number of iterations. */
+extern __thread float DEBRISd50;	/* (mm) */
+extern __thread float DEBRISd90;	/* (mm) */
+extern __thread float CHANNELd50;	/* Currently not used */
+extern __thread float CHANNELd90;	/* Currently not used */
 #endif
@@ -68,6 +68,7 @@ typedef struct {
   PIXDUMP *Pix;						/* Array with info on pixels for which to output timeseries */
   int NMaps;						/* Number of variables for which to output maps */
   MAPDUMP *DMap;					/* Array with info on each map to output */
+  FILES MultiPoint;					/* Binary table with point values in MULTIPOINT mode */
 } DUMPSTRUCT;
 
 typedef struct {
@@ -153,13 +154,15 @@ typedef struct {
   float DXY;					 /* Pixel spacing in diagonal */
   int OffsetX;					 /* Offset in x-direction compared to basemap */
   int OffsetY;					 /* Offset in y-direction compared to basemap */
-  int NumCells;                  /* Number of cells within the basin */
+  long NumCells;                 /* Number of cells within the basin */
   int NYfine;                    /* Number of pixels for mass wasting algorithm in x direction */
   int NXfine;                    /* Number of pixels for mass wasting algorithm in y direction */
   float DMASS;					 /* Pixel spacing for mass wasting algorithm */
-  int NumCellsfine;              /* Number of cells for mass wasting algorithm within the basin */
+  long NumCellsfine;             /* Number of cells for mass wasting algorithm within the basin */
   int NumFineIn;                 /* Number of fine cells in one coarse cell */  
   ITEM *OrderedCells;            /* Structure array to hold the ranked elevations; NumCells in size */
+  struct _cellorder_ *CellOrder; /* Storage order of the kinematic wave routing, NULL for the
+                                    elevation order, see order.h */
 } MAPSIZE;
 
 typedef struct {
@@ -199,8 +202,246 @@ typedef struct {
 				   for all others */
   FILES MetFile;		/* File with observations */
   MET Data;
+  uchar HasForcing;		/* TRUE if Forcing replaces the observations of
+				   the next time step, see dhsvm_set_forcing() */
+  MET Forcing;			/* Tair, Rh, Wind, Sin, Lin and Precip set by
+				   the calling program */
 } METLOCATION;
 
+/* station data of the current time step, one array per variable, see
+   dispatch.h */
+typedef struct {
+  int NStats;			/* Number of stations packed */
+  int NAlloc;			/* Number of stations allocated */
+  float *Tair;			/* Air temperature (C) */
+  float *Elev;			/* Station elevation (m) */
+  float *TempLapse;		/* Temperature lapse rate (C/m) */
+  float *Rh;			/* Relative humidity (%) */
+  float *Wind;			/* Wind (m/s) */
+  float *Lin;			/* Incoming longwave (W/m^2) */
+  float *Sin;			/* Incoming shortwave (W/m^2) */
+  float *SinBeamObs;		/* Observed beam radiation (W/m^2) */
+  float *SinDiffuseObs;		/* Observed diffuse radiation (W/m^2) */
+} STATIONARRAYS;
+
+typedef struct {
+  int Active;					/* TRUE while the model state is spun up */
+  int Cycle;					/* Number of completed spin-up cycles */
+  int MaxCycles;				/* Maximum number of spin-up cycles */
+  int Dt;						/* Model time step (sec) */
+  float Tolerance;				/* Relative change between cycles below which
+								   the model state is considered stable */
+  DATE Start;					/* Start of the spin-up period */
+  DATE End;						/* End of the spin-up period */
+  DATE ModelStart;				/* Start of the model run after the spin-up */
+  DATE ModelEnd;				/* End of the model run after the spin-up */
+  float SoilWater;				/* Soil water storage at the end of the
+								   previous cycle (m) */
+  float TableDepth;				/* Water table depth at the end of the
+								   previous cycle (m) */
+  float ChannelStorage;			/* Channel storage at the end of the previous
+								   cycle (m3) */
+} SPINUPSTRUCT;
+
+typedef struct {
+  char Name[BUFSIZE + 1];		/* Name of the member, also the name of the
+								   output subdirectory */
+  float PrecipMultiplier;		/* Multiplier for the precipitation input */
+  float TempOffset;				/* Offset added to the air temperature
+								   input (C) */
+  float KsLatMultiplier;		/* Multiplier for the lateral saturated
+								   hydraulic conductivity of all soil types */
+} ENSMEMBER;
+
+typedef struct {
+  int Mode;						/* ENSEMBLE_PROCESS if each member runs in
+								   its own process, ENSEMBLE_SHARED if all
+								   members run in one process */
+  int NMembers;					/* Number of ensemble members, 0 if no
+								   ensemble is run */
+  int MaxProcesses;				/* Maximum number of members that run at the
+								   same time */
+  int Member;					/* ENSEMBLE_PROCESS: member simulated by this
+								   process, -1 for the ensemble parent.
+								   ENSEMBLE_SHARED: member that is being
+								   initialized */
+  ENSMEMBER *Members;			/* Perturbations for each member */
+} ENSEMBLESTRUCT;
+
+typedef struct {
+  int Active;					/* TRUE if the model runs as a forecast
+								   server */
+  char SocketPath[BUFSIZE + 1];	/* Unix domain socket of the server */
+  int ListenSocket;				/* Socket on which requests are accepted */
+  FILE *In;						/* Requests of the current client, NULL if
+								   there is no client */
+  FILE *Out;					/* Replies to the current client */
+  int Advancing;				/* TRUE while the model advances to the end
+								   date of a request */
+  int Restart;					/* TRUE after a model state has been loaded,
+								   until the main program has restarted the
+								   month, day and mass balance */
+  int Restored;					/* TRUE if the state of the restart is the
+								   snapshot in memory, which includes the
+								   mass balance */
+  int HasSnapshot;				/* TRUE if a snapshot has been taken */
+  DATE Snapshot;				/* Model time of the snapshot */
+  char SnapshotPath[BUFSIZE + 1];	/* Directory with the snapshot state */
+} SERVERSTRUCT;
+
+typedef struct {
+  int Id;						/* Calibration parameter, see Calibrate.c */
+  int Type;						/* Soil or vegetation type (1-based) the
+								   value applies to, 0 for all types */
+  float Value;					/* New value of the parameter */
+} CALIBPARAM;
+
+typedef struct {
+  int Active;					/* TRUE if parameter sets are evaluated */
+  FILE *In;						/* Parameter sets, one per line */
+  int MaxProcesses;				/* Maximum number of parameter sets that are
+								   evaluated at the same time */
+  char Name[BUFSIZE + 1];		/* Name of the parameter set evaluated by
+								   this process, also the name of the output
+								   subdirectory */
+  int NParams;					/* Number of parameters in the set */
+  CALIBPARAM Params[MAXCALIBPARAMS];	/* Parameters of the set */
+} CALIBRATIONSTRUCT;
+
+typedef struct {
+  int Active;					/* TRUE if the basin is clipped to the area
+								   upstream of a target */
+  int Segment;					/* Target channel segment, -1 if the target
+								   is a cell */
+  int CellY;					/* Y-index of the target cell */
+  int CellX;					/* X-index of the target cell */
+} CLIPSTRUCT;
+
+typedef struct {
+  int Active;					/* TRUE if the model time step is adapted to
+								   the forcing and the model state */
+  int MaxSteps;					/* Maximum number of base time steps in one
+								   model time step */
+  int Steps;					/* Number of base time steps in the current
+								   model time step, 1 if not active */
+  int Dt;						/* Base time step (sec) */
+  float PrecipThreshold;		/* Station precipitation per base time step
+								   (m) above which the base step is used */
+  float MeltThreshold;			/* Basin average snow pack outflow per base
+								   time step (m) above which the base step
+								   is used */
+  float FlowThreshold;			/* Relative change in the stream outflow
+								   above which the base step is used */
+  float LastFlow;				/* Stream outflow at the end of the previous
+								   model time step (m3/s), negative if not
+								   known */
+  float ShadowWeight[MAXADAPTIVESTEPS];	/* Weight of the shadow map of each
+								   base step in a longer time step */
+  int NModelSteps;				/* Number of model time steps */
+  int NBaseSteps;				/* Number of base time steps */
+} ADAPTIVESTRUCT;
+
+typedef struct {
+  long Cell;					/* Pixel that receives the flow, y * NX + x
+								   in the divided grid */
+  long Source;					/* Pixel that sends the flow */
+  int Seq;						/* Order of the flows from the same source
+								   pixel to the same pixel */
+  float Value;					/* Flow (m) */
+} FLOWENTRY;
+
+typedef struct {
+  long Cell;					/* Pixel that adds the inflow, y * NX + x
+								   in the divided grid */
+  int Seq;						/* Order in which the inflow was added */
+  int Sub;						/* Order of the segments in the pixel */
+  int Road;						/* TRUE for the road network, FALSE for the
+								   stream network */
+  int Segment;					/* Segment id */
+  float Value;					/* Lateral inflow of the segment (m3) */
+} INFLOWENTRY;
+
+typedef struct {
+  long Cell;					/* Pixel that receives the runon */
+  long Source;					/* Pixel that sends it */
+  double Value;					/* Runon (m3/s) */
+} RUNONENTRY;
+
+typedef struct {
+  long Cell;					/* Pixel of this rank with a neighbor of
+								   another rank, y * NX + x in the divided
+								   grid */
+  int NSources;					/* Number of neighbors that can send runon */
+  int NLate;					/* Number of them that come later in the
+								   pixel order, they are added first */
+  int NEarly;					/* Number of neighbors of other ranks that
+								   come earlier in the pixel order */
+  int Arrived;					/* Number of those received in this sub-step */
+  long Source[NDIRS];			/* Neighbors in the order in which their
+								   runon is added */
+  double Value[2][NDIRS];		/* Runon of each neighbor in the even and
+								   the odd sub-steps */
+} RUNONPIX;
+
+typedef struct {
+  int Active;					/* TRUE if the basin is divided over several
+								   MPI ranks */
+  int Rank;						/* MPI rank of this process, 0 in a serial
+								   run */
+  int NRanks;					/* Number of MPI ranks, 1 in a serial run */
+  int Started;					/* TRUE if InitParallel() started MPI */
+  char Path[BUFSIZE + 1];		/* Output directory shared by the ranks */
+  int NY;						/* Number of rows of the divided grid */
+  int NX;						/* Number of columns of the divided grid */
+  int OffsetY;					/* First row of the grid of this rank in the
+								   divided grid */
+  int OffsetX;					/* First column of the grid of this rank */
+  int NRows;					/* Number of rows of the grid of this rank */
+  int NCols;					/* Number of columns of the grid of this
+								   rank */
+  long NCells;					/* Number of pixels in the basin */
+  int **Owner;					/* Rank that simulates each pixel, -1 outside
+								   the basin and the halo */
+  uchar **Mixed;				/* TRUE for pixels that can receive surface
+								   or subsurface flow from pixels of another
+								   rank */
+  int NFlow;					/* Number of logged flows to mixed pixels */
+  int MaxFlow;					/* Allocated length of Flow */
+  FLOWENTRY *Flow;				/* Flows to mixed pixels */
+  int NInflow;					/* Number of logged channel inflows */
+  int MaxInflow;				/* Allocated length of Inflow */
+  INFLOWENTRY *Inflow;			/* Channel and road lateral inflows */
+  struct _channel_map_rec_ ***RoadMap;	/* Road map of this rank */
+  int NStreams;					/* Length of Streams */
+  Channel **Streams;			/* Channel segments by id, all ranks route
+								   the whole networks */
+  int NRoads;					/* Length of Roads */
+  Channel **Roads;				/* Road segments by id */
+  int *HaloCounts;				/* Number of pixels sent to and received
+								   from each rank, see ExchangeHalo() */
+  long *HaloSend;				/* Pixels sent to each rank, y * NCols + x in
+								   the grid of this rank */
+  long *HaloRecv;				/* Pixels received from each rank */
+  long NRunon;					/* Number of pixels in Runon */
+  RUNONPIX *Runon;				/* Pixels of this rank that receive runon
+								   from another rank, in cell order, see
+								   AddRunon() */
+  int **RunonMap;				/* Entry in Runon of each pixel, -1 if none */
+  int Step;						/* Kinematic wave sub-step */
+  int *Expected;				/* Runon entries received from each rank in
+								   a sub-step */
+  int *Received;				/* Entries received in this sub-step */
+  int *NPending;				/* Entries not sent yet to each rank */
+  int *MaxPending;				/* Allocated length of Pending */
+  RUNONENTRY **Pending;			/* Entries not sent yet */
+  int NSent;					/* Number of messages sent in this
+								   sub-step */
+  int MaxSent;					/* Allocated length of Sent */
+  RUNONENTRY **Sent;			/* Buffers of the messages sent */
+  void *Requests;				/* MPI_Request of each message sent */
+  struct _map_gather_ *Gather;	/* Output maps of all ranks, see fileio.h */
+} PARALLELSTRUCT;
+
 typedef struct {
   int FileFormat;				/* File format indicator, BIN or HDF */
   int HasNetwork;				/* Flag to indicate whether roads and/or channels are imposed on the model area,
@@ -245,6 +486,42 @@ typedef struct {
   int QPF;						/* TRUE if QPF override, else FALSE */
   int PointX;					/* X-index of point to model in POINT mode */
   int PointY;					/* Y-index of point to model in POINT mode */
+  int NPoints;					/* Number of points to model in MULTIPOINT mode */
+  COORD *Points;				/* Locations of the points to model in MULTIPOINT
+								   mode (N is the row, E the column) */
+  int NThreads;					/* Number of threads for the column physics */
+  int TileSize;					/* Edge of the tiles of the threaded pixel
+								   loop (pixels), 0 for the default */
+  int OutputBuffer;				/* Buffer of the output files (bytes), 0 for
+								   the default of the C library */
+  int ParamMaps;				/* TRUE if the routing reads the soil and
+								   vegetation parameters from per-pixel
+								   maps, see params.h */
+  int FirstTouch;				/* TRUE if the pages of the model maps are
+								   first touched by the threads of their
+								   tiles, see placement.h */
+  int HugePages;				/* Pages of the model maps, see
+								   placement.h */
+  int CellOrder;				/* Storage order of the kinematic wave
+								   routing, see order.h */
+  int Profile;					/* TRUE if the time steps are profiled */
+  int ProfileSteps;				/* TRUE if the profile of each time step is
+								   written to Profile.csv */
+  int Progress;					/* TRUE if Progress.json is written */
+  int ProgressInterval;			/* Time between two updates of
+								   Progress.json (s), 0 for the default */
+  int Cpu;						/* Highest instruction set of the vector
+								   kernels, CPU_AUTO for the best one of the
+								   processor, see dispatch.h */
+  int Components;				/* Model components that are simulated, either
+								   FULL_MODEL, SNOW_MODEL or MET_MODEL */
+  SPINUPSTRUCT Spinup;			/* Spin-up of the model state */
+  ENSEMBLESTRUCT Ensemble;		/* Scenario ensemble */
+  SERVERSTRUCT Server;			/* Forecast server */
+  CALIBRATIONSTRUCT Calibration;	/* Calibration parameter sets */
+  CLIPSTRUCT Clip;				/* Clipping to the subbasin of a target */
+  ADAPTIVESTRUCT Adaptive;		/* Adaptive model time step */
+  PARALLELSTRUCT Parallel;		/* Division of the basin over MPI ranks */
   int Snotel;					/* if TRUE then station veg = bare for output */
   int Outside;					/* if TRUE then all listed met stats are used */
   int Rhoverride;				/* if TRUE then RH=100% if Precip>0 */
@@ -361,9 +638,6 @@ typedef struct {
 } SNOWPIX;
 
 typedef struct {
-  int   Soil;			/* Soil type */
-  float Depth;			/* Depth of total soil zone, including all root
-						zone layers, and the saturated zone */
   float *Moist;			/* Soil moisture content in layers (0-1) */
   float *Perc;			/* Percolation from layers */
   float *Temp;			/* Temperature in each layer (C) */
@@ -391,6 +665,15 @@ typedef struct {
   float DetentionStorage;        /* amount of water kept in detention storage when impervious fraction > 0 */
   float DetentionIn;			 /* detention storage change in current time step */
   float DetentionOut;            /* water flow out of detention storage */
+#ifdef COMPACT_MAPS
+  unshort Soil;			/* Soil type, 16 bits so that it packs with
+				   Depth */
+#else
+  int   Soil;			/* Soil type */
+#endif
+  mapcode Depth;		/* Depth of total soil zone, including all root
+						zone layers, and the saturated zone, see
+						SOILDEPTH() */
 } SOILPIX;
 
 typedef struct {
@@ -431,16 +714,20 @@ typedef struct {
 } STATSTABLE;
 
 
+/* the fields of less than 4 bytes come first, so that they pack when the
+   mapcode fields are 16-bit codes (compact.h) */
 typedef struct {
-  float Dem;					/* Elevations */
-  uchar Mask;					/* Mask for modeled area */
+  mapcode Dem;					/* Elevations, see TOPODEM() */
+  mapcode Slope;				/* Land surface slope, see TOPOSLOPE() */
+  mapcode Aspect;				/* Land surface slope direction, see
+								   TOPOASPECT() */
   unshort Travel;				/* Travel time */
+  unshort TotalDir;				/* Sum of Dir array (at most
+								   NDIRS * 255) */
+  uchar Mask;					/* Mask for modeled area */
+  unsigned char Dir[NDIRS];		/* Fraction of surface flux moving in each direction*/
   float Grad;					/* Sum of downslope slope-width products */
-  float Slope;					/* Land surface slope */
-  float Aspect;					/* Land surface slope direction */
   float FlowGrad;				/* Magnitude of subsurface flow gradient slope * width */
-  unsigned char Dir[NDIRS];		/* Fraction of surface flux moving in each direction*/
-  unsigned int TotalDir;	    /* Sum of Dir array */
   int drains_x;					/* x-loc of cell to which this impervious cell drains */
   int drains_y;					/* y-loc of cell to which this impervious cell drains */
   ITEM *OrderedTopoIndex;       /* Structure array to hold the ranked topoindex for fine pixels in a coarse pixel */
@@ -565,9 +852,13 @@ struct node {
 };
 
 typedef struct {
-  float Dem;                     /* Elevations */
+  mapcode Dem;                   /* Elevations, see FINEDEM() */
+  mapcode bedrock;               /* Bedrock elevation (m), see
+				    FINEBEDROCK() */
+  mapcode TopoIndex;             /* Topographic Index used for soil moisture
+				    redistribution from coarse grid to fine
+				    grid, see FINETOPOINDEX() */
   uchar Mask;                   /* Mask for modeled area */
-  float bedrock;                 /* Bedrock elevation (m) */
   float sediment;                /* Sediment thickness (m) */
   float SatThickness;            /* Water table thickness (m) */
   float DeltaDepth;              /* Change in sediment thickness (m) */
@@ -575,8 +866,6 @@ typedef struct {
   float MassWasting;             /* Sediment (m3) lost due to mass wasting */
   float MassDeposition;          /* Sediment (m3) deposited in grid cell from mass wasting elsewhere */
   float SedimentToChannel;       /* Sediment (m3) deposited in channel from mass wasting */
-  float TopoIndex;               /* Topographic Index used for soil moisture redistribution from coarse 
-								grid to fine grid */
 } FINEPIX; 
  
 typedef struct {
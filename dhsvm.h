@@ -0,0 +1,89 @@
+/*
+ * SUMMARY:      dhsvm.h - header file for the DHSVM library (libdhsvm)
+ * USAGE:        Include in programs that run DHSVM in-process
+ *
+ * AUTHOR:       DHSVM development team
+ * ORG:          University of Washington, Department of Civil Engineering
+ * E-MAIL:
+ * ORIG-DATE:    Oct-2026
+ * DESCRIPTION:  Interface to run one or more model instances from another
+ *               program, for example a coupling framework or a calibration
+ *               driver, without exchanging files.
+ *
+ *                 DHSVM *Model = dhsvm_init("INPUT.dhsvm");
+ *                 while (dhsvm_step(Model, 1) == 1) {
+ *                   dhsvm_get_field(Model, "Soil.TableDepth", &Field);
+ *                   ... DHSVM_FLOAT_AT(&Field, y, x) ...
+ *                   dhsvm_set_forcing(Model, 0, Tair, Rh, Wind, Sin, Lin,
+ *                                     Precip);
+ *                 }
+ *                 dhsvm_free(Model);
+ *
+ *               Link with libdhsvm.a and -lm -lpthread.
+ *               dhsvm_predict_memory() sizes a run before it is started,
+ *               dhsvm_autotune() tunes the threads of a basin.
+ * DESCRIP-END.
+ * FUNCTIONS:
+ * COMMENTS:     dhsvm_init() returns NULL if the configuration or the input
+ *               has an error, later errors still end the process, see
+ *               ReportError().  Several instances can be stepped in turn
+ *               from one thread, but not from several threads at once,
+ *               and only one instance at a time can use MPI or X11
+ *               graphics.
+ * $Id: dhsvm.h,v 1.0 2026/10/17 Exp $
+ */
+
+#ifndef DHSVM_H
+#define DHSVM_H
+
+#include <stddef.h>
+
+/* number types of a field, the codes of sizeofnt.h */
+#define DHSVM_BYTE  1
+#define DHSVM_SHORT 3
+#define DHSVM_INT   4
+#define DHSVM_FLOAT 5
+
+typedef struct dhsvm_model DHSVM;	/* Model instance */
+
+typedef struct {
+  int NY;			/* Number of rows */
+  int NX;			/* Number of columns */
+  char **Rows;			/* Row pointers of the model map that holds
+				   the field */
+  size_t Offset;		/* Offset of the field in a pixel (bytes) */
+  size_t Stride;		/* Distance between two pixels in a row
+				   (bytes) */
+  int Type;			/* Number type of the field */
+} DHSVMFIELD;
+
+/* address of the value of a field at row y and column x.  The address
+   stays valid until dhsvm_free() */
+#define DHSVM_FIELD_AT(Field, y, x) \
+  ((void *) ((Field)->Rows[y] + (Field)->Offset + (size_t) (x) * (Field)->Stride))
+#define DHSVM_FLOAT_AT(Field, y, x) (*(float *) DHSVM_FIELD_AT(Field, y, x))
+
+/* NULL if the configuration or the input has an error */
+DHSVM *dhsvm_init(const char *ConfigFile);
+
+int dhsvm_step(DHSVM *Model, int NSteps);
+
+int dhsvm_get_field(DHSVM *Model, const char *Name, DHSVMFIELD *Field);
+
+int dhsvm_set_forcing(DHSVM *Model, int Station, float Tair, float Rh,
+		      float Wind, float Sin, float Lin, float Precip);
+
+void dhsvm_free(DHSVM *Model);
+
+/* memory of the model arrays of a configuration (bytes), predicted without
+   initializing the model */
+double dhsvm_predict_memory(const char *ConfigFile);
+
+/* time the first time steps of a configuration with several numbers of
+   threads, tile sizes and output buffers, and write the fastest settings to
+   Tuning.txt in the output directory, for the later runs.  Returns the wall
+   time per time step of the fastest settings (s), or -1 if the
+   configuration has an error */
+double dhsvm_autotune(const char *ConfigFile);
+
+#endif
@@ -0,0 +1,61 @@
+/*
+ * SUMMARY:      dispatch.h - header file for the CPU dispatch of the kernels
+ * USAGE:        Part of DHSVM
+ *
+ * AUTHOR:       DHSVM development team
+ * ORG:          University of Washington, Department of Civil Engineering
+ * E-MAIL:
+ * ORIG-DATE:    Oct-2026
+ * DESCRIPTION:  The instruction set of the processor is detected when the
+ *               model starts, and the vector kernels (the transmissivities
+ *               of RouteSubSurface) are called through
+ *               function pointers that are set to the SSE4.2, AVX2 or
+ *               AVX-512 version, or to the scalar version on other
+ *               processors.  CPU = AUTO (the default), SCALAR, SSE4.2, AVX2
+ *               or AVX512 in the [OPTIONS] section caps the instruction set,
+ *               for comparisons.
+ * DESCRIP-END.
+ * FUNCTIONS:
+ * COMMENTS:     All versions are compiled into the same binary, no -march
+ *               flag is needed.  The versions give the same results to the
+ *               last bit, see Dispatch.c.
+ * $Id: dispatch.h,v 1.0 2026/10/17 Exp $
+ */
+
+#ifndef DISPATCH_H
+#define DISPATCH_H
+
+#include "settings.h"
+#include "data.h"
+
+/* instruction sets, list order must match the names in Dispatch.c */
+enum CPULEVELS {
+  CPU_SCALAR = 0, CPU_SSE42, CPU_AVX2, CPU_AVX512, NCPULEVELS
+};
+#define CPU_AUTO -1
+
+/* interpolated station variables, see InterpolateStations */
+enum STATIONSUMS {
+  SUM_TAIR = 0, SUM_RH, SUM_WIND, SUM_LIN, SUM_SIN, SUM_SINBEAM,
+  SUM_SINDIFFUSE, SUM_TEMPLAPSE, NSTATIONSUMS
+};
+
+/* transmissivities of N pixels for the given soil depths and water table
+   depths, element by element as CalcTransmissivity() but without its
+   warning.  The kernel belongs to the thread that runs a model instance,
+   see globals.h */
+extern __thread void (*CalcTransmissivities) (int N, float *SoilDepth,
+					      float *WaterTable,
+					      float *LateralKs,
+					      float *KsExponent,
+					      float *DepthThresh, float *Out);
+
+int DetectCpu(void);
+int InitDispatch(int Requested);
+const char *CpuName(int Level);
+void InterpolateStations(int NStats, uchar *Weights, STATIONARRAYS *Stations,
+			 float LocalElev, float *Sums, float *WeightSum);
+void PackStations(int NStats, METLOCATION *Stat, STATIONARRAYS *Stations);
+void FreeStations(STATIONARRAYS *Stations);
+
+#endif
@@ -0,0 +1,88 @@
+/*
+ * SUMMARY:      ensemble.h - header file for the in-process ensemble
+ * USAGE:        Part of DHSVM
+ *
+ * AUTHOR:       DHSVM development team
+ * ORG:          University of Washington, Department of Civil Engineering
+ * E-MAIL:
+ * ORIG-DATE:    Oct-2026
+ * DESCRIPTION:  Model state of each member when all members of an ensemble
+ *               run in one process (ENSEMBLE MODE = SHARED).  The terrain,
+ *               the parameter tables, the met inputs and the met
+ *               interpolation of each pixel are shared by all members.  Each
+ *               member has its own full set of model state maps, which are
+ *               swapped into the main program for the routing and the
+ *               output.  The results of each member are the same as with
+ *               ENSEMBLE MODE = PROCESS.
+ * DESCRIP-END.
+ * FUNCTIONS:
+ * COMMENTS:     The members are not interleaved in the model state maps,
+ *               and the column physics runs for one member after the
+ *               other: it branches on the state of the pixel (snow, soil
+ *               layers, saturation), so members of one pixel would not
+ *               stay in step across vector lanes, and the routing and the
+ *               output would all have to learn a member dimension.  What
+ *               SHARED saves over PROCESS is the fork, the copy-on-write
+ *               of the shared maps and the interpolation of the met
+ *               variables that the perturbations do not change.
+ * $Id: ensemble.h,v 1.0 2026/10/17 Exp $
+ */
+
+#ifndef ENSEMBLE_H
+#define ENSEMBLE_H
+
+#include "settings.h"
+#include "data.h"
+#include "DHSVMChannel.h"
+#include "getinit.h"
+#include "sweep.h"
+
+typedef struct {
+  AGGREGATED Total;		/* Basin totals of the member */
+  WATERBALANCE Mass;		/* Mass balance of the member */
+  DUMPSTRUCT Dump;		/* Output of the member */
+  CHANNEL ChannelData;		/* Channel and road network of the member */
+  EVAPPIX **EvapMap;
+  PRECIPPIX **PrecipMap;
+  ROADSTRUCT **Network;
+  SNOWPIX **SnowMap;
+  SOILPIX **SoilMap;
+  VEGPIX **VegMap;		/* Vegetation map of the member, the canopy
+				   temperature is part of the model state */
+  SOILTABLE *SType;		/* Soil parameters, with the perturbations of
+				   the member */
+  float *Hydrograph;		/* Unit hydrograph outflow of the member */
+  PIXMET LocalMet;		/* Met data of the last pixel */
+} MEMBERSTATE;
+
+typedef struct {
+  CELLSWEEP *Sweep;		/* Model structures of each member */
+  PIXRAD **TotalRad;		/* Radiation totals of each member */
+  PIXMET *LocalMet;		/* Met data of each member */
+} MEMBERSWEEP;
+
+void InitMemberStates(LISTPTR Input, OPTIONSTRUCT *Options, MAPSIZE *Map,
+		      TIMESTRUCT *Time, LAYER *Soil, LAYER *Veg,
+		      SOILTABLE *SType, VEGTABLE *VType, VEGPIX **VegMap,
+		      TOPOPIX **TopoMap, SNOWTABLE *SnowAlbedo,
+		      UNITHYDRINFO *HydrographInfo, float *Hydrograph,
+		      int *MaxStreamID, int *MaxRoadID,
+		      MEMBERSTATE **Members);
+
+void InitMemberSweep(int NMembers, MEMBERSTATE *Members,
+		     MEMBERSWEEP *MemberSweep);
+
+void MemberMassEnergyBalance(MEMBERSTATE *Members, ENSEMBLESTRUCT *Ensemble,
+			     CELLSWEEP *Sweep, MEMBERSWEEP *MemberSweep);
+
+void FreeMemberSweep(MEMBERSWEEP *MemberSweep);
+
+void SwapMemberState(MEMBERSTATE *Member, AGGREGATED *Total,
+		     WATERBALANCE *Mass, DUMPSTRUCT *Dump,
+		     CHANNEL *ChannelData, EVAPPIX ***EvapMap,
+		     PRECIPPIX ***PrecipMap, ROADSTRUCT ***Network,
+		     SNOWPIX ***SnowMap, SOILPIX ***SoilMap,
+		     VEGPIX ***VegMap, SOILTABLE **SType, float **Hydrograph,
+		     PIXMET *LocalMet);
+
+#endif
@@ -16,6 +16,8 @@
 #ifndef FIFOBIN_H
 #define FIFOBIN_H
 
+#include <stddef.h>
+
 void CreateMapFileBin(char *FileName, ...);
 int Read2DMatrixBin(char *FileName, void *Matrix, int NumberType, int NY,
 		    int NX, int NDataSet, ...); 
@@ -25,7 +27,7 @@ int Write2DMatrixBin(char *FileName, void *Matrix, int NumberType, int NY,
 		     int NX, ...); 
 int Write2DMatrixByteSwapBin(char *FileName, void *Matrix, int NumberType,
 			     int NY, int NX, ...); 
-void byte_swap_long(long *buffer, int number_of_swaps);
-void byte_swap_short(short *buffer, int number_of_swaps);
+void byte_swap_long(unsigned int *buffer, size_t number_of_swaps);
+void byte_swap_short(short *buffer, size_t number_of_swaps);
 
 #endif
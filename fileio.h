@@ -23,21 +23,62 @@
 #define BYTESWAP 3		/* binary IO but byteswap reads */
 void InitFileIO(int FileFormat);
 
+/* pixels of the ranks of an MPI run.  Each rank holds a window of the grid
+   and simulates part of its pixels (Parallel.c), rank 0 writes the output
+   maps from the pixels of all ranks */
+typedef struct _map_gather_ {
+  int Rank;			/* MPI rank of this process */
+  long NOwned;			/* Number of pixels of this rank */
+  long *Owned;			/* Pixels of this rank, y * ModelNX + x */
+  long NCells;			/* Rank 0: number of pixels of all ranks */
+  int *Counts;			/* Rank 0: number of pixels of each rank */
+  int *Displs;			/* Rank 0: first pixel of each rank in the
+				   gathered values */
+  long *Cells;			/* Rank 0: pixels of all ranks in file order,
+				   y * NX + x in the files */
+  long *Entries;		/* Rank 0: position of each of them in the
+				   gathered values */
+} MAPGATHER;
+
+/* window of the model grid in larger map files.  When the basin is clipped
+   (Clip.c) or divided over MPI ranks (Parallel.c) the model grid is
+   cropped, but the maps that are read later and the output maps keep the
+   size of the original grid */
+typedef struct {
+  int Active;			/* TRUE if the model grid is a window */
+  int NY;			/* Number of rows in the map files */
+  int NX;			/* Number of columns in the map files */
+  int OffsetY;			/* First row of the model grid in the files */
+  int OffsetX;			/* First column of the model grid in the
+				   files */
+  int ModelNY;			/* Number of rows of the model grid */
+  int ModelNX;			/* Number of columns of the model grid */
+  MAPGATHER *Gather;		/* Pixels of all ranks of an MPI run, NULL if
+				   the output maps are written by each
+				   process */
+} MAPWINDOW;
+
+void GetMapWindow(MAPWINDOW *Window);
+void SetMapWindow(MAPWINDOW *Window);
+
 /* global file extension string */
-extern char fileext[];
+extern __thread char fileext[];
 
 /* function pointers for 2D file IO */
 
-extern void (*CreateMapFile) (char *FileName, ...);
-extern int (*Read2DMatrix) (char *FileName, void *Matrix, int NumberType,
-			    int NY, int NX, int NDataSet, ...);
-extern int (*Write2DMatrix) (char *Filename, void *Matrix, int NumberType,
-			     int NY, int NX, ...);
+extern __thread void (*CreateMapFile) (char *FileName, ...);
+extern __thread int (*Read2DMatrix) (char *FileName, void *Matrix,
+				     int NumberType, int NY, int NX,
+				     int NDataSet, ...);
+extern __thread int (*Write2DMatrix) (char *Filename, void *Matrix,
+				      int NumberType, int NY, int NX, ...);
 
 
 /* generic file functions */
 
 void OpenFile(FILE ** FilePtr, char *FileName, char *Mode,
 	      unsigned char OverWrite);
+void SetOutputBuffer(int Bytes);
+int GetOutputBuffer(void);
 
 #endif
@@ -16,9 +16,23 @@
 #ifndef FUNCTIONS_H
 #define FUNCTIONS_H
 
+#include <sys/types.h>
 #include "data.h"
 #include "channel.h"
 #include "DHSVMChannel.h"
+#include "params.h"
+#include "compact.h"
+
+void AddFlow(PARALLELSTRUCT *Parallel, float *Field, int y, int x,
+	     int SourceY, int SourceX, int Seq, float Value);
+
+void AddRunon(PARALLELSTRUCT *Parallel, float **Runon, int yn, int xn,
+	      int y, int x, double Value);
+
+void ApplyCalibration(CALIBRATIONSTRUCT *Calibration, MAPSIZE *Map,
+		      LAYER *Soil, LAYER *Veg, SOILTABLE *SType,
+		      VEGTABLE *VType, TOPOPIX **TopoMap, SOILPIX **SoilMap,
+		      VEGPIX **VegMap, ROADSTRUCT **Network);
 
 void Aggregate(MAPSIZE *Map, OPTIONSTRUCT *Options, TOPOPIX **TopoMap,
 	       LAYER *Soil, LAYER *Veg, VEGPIX **VegMap, EVAPPIX **Evap,
@@ -27,6 +41,9 @@ void Aggregate(MAPSIZE *Map, OPTIONSTRUCT *Options, TOPOPIX **TopoMap,
 	       ROADSTRUCT **Network, SEDPIX **SedMap, FINEPIX ***FineMap,
 	       CHANNEL *ChannelData, float *roadarea);
 
+void AggregateMetRecord(OPTIONSTRUCT *Options, TIMESTRUCT *Time,
+			int NSoilLayers, METLOCATION *Stat);
+
 void Alloc_Chan_Sed_Mem(float ** DummyVar);
 
 void CalcAerodynamic(int NVegLayers, unsigned char OverStory,
@@ -61,10 +78,25 @@ void CalcWeights(METLOCATION *Station, int NStats, int NX, int NY,
 
 double ChannelCulvertSedFlow(int y, int x, CHANNEL * ChannelData, int i);
 
-void CheckOut(int CanopyRadAttOption, LAYER Veg, LAYER Soil, 
-	      VEGTABLE *VType, SOILTABLE *SType, MAPSIZE *Map, 
+void CheckOut(int CanopyRadAttOption, int ComponentsOption, LAYER Veg,
+	      LAYER Soil, VEGTABLE *VType, SOILTABLE *SType, MAPSIZE *Map, 
 	      TOPOPIX **TopoMap, VEGPIX **VegMap, SOILPIX **SoilMap);
 
+void ChooseTimeStep(OPTIONSTRUCT *Options, TIMESTRUCT *Time,
+		    DUMPSTRUCT *Dump, int NSoilLayers, int NStats,
+		    METLOCATION *Stat, SOLARGEOMETRY *SolarGeo,
+		    AGGREGATED *Total, CHANNEL *ChannelData);
+
+void ClipToSubbasin(OPTIONSTRUCT *Options, MAPSIZE *Map, LAYER *Soil,
+		    VEGTABLE *VType, TOPOPIX ***TopoMap, SOILPIX ***SoilMap,
+		    VEGPIX ***VegMap, ROADSTRUCT ***Network,
+		    CHANNEL *ChannelData, int NStats, METLOCATION *Stat);
+
+void CropGrid(MAPSIZE *Map, LAYER *Soil, VEGTABLE *VType, TOPOPIX ***TopoMap,
+	      SOILPIX ***SoilMap, VEGPIX ***VegMap, ROADSTRUCT ***Network,
+	      CHANNEL *ChannelData, int NStats, METLOCATION *Stat, int y0,
+	      int x0, int NY, int NX);
+
 unsigned char dequal(double a, double b);
 
 void draw(DATE *Day, int first, int DayStep, MAPSIZE *Map, int NGraphics,
@@ -78,6 +110,10 @@ void draw(DATE *Day, int first, int DayStep, MAPSIZE *Map, int NGraphics,
 
 void DistributeSedimentDiams(float SedDiams[NSEDSIZES]);
 
+void DropUnusedStations(OPTIONSTRUCT *Options, MAPSIZE *Map,
+			TOPOPIX **TopoMap, uchar ***MetWeights, int *NStats,
+			METLOCATION *Stat);
+
 void DumpMap(MAPSIZE *Map, DATE *Current, MAPDUMP *DMap, TOPOPIX **TopoMap,
 	     EVAPPIX **EvapMap, PRECIPPIX **PrecipMap, RADCLASSPIX **RadMap,
 	     SNOWPIX **Snowap, SOILPIX **SoilMap, SEDPIX **SedMap, FINEPIX ***FineMap,
@@ -92,6 +128,22 @@ void DumpPixSed(DATE *Current, int first, FILES *OutFileSediment, SEDPIX *SedMap
              ROADSTRUCT *Network, float SedimentOverlandInflow, 
              float SedimentOverroadInflow, FINEPIX *FineMap);
 
+void EndParallel(PARALLELSTRUCT *Parallel);
+
+void EndSpinupCycle(OPTIONSTRUCT *Options, TIMESTRUCT *Time,
+		    AGGREGATED *Total, CHANNEL *ChannelData, int NStats,
+		    METLOCATION *Stat);
+
+void EndTimeStep(ADAPTIVESTRUCT *Adaptive, TIMESTRUCT *Time);
+
+void ExchangeFlow(PARALLELSTRUCT *Parallel, SOILPIX **SoilMap, size_t Offset);
+
+void ExchangeHalo(PARALLELSTRUCT *Parallel, SOILPIX **SoilMap, size_t Offset);
+
+void ExchangeInflow(PARALLELSTRUCT *Parallel);
+
+void ExchangeRunon(PARALLELSTRUCT *Parallel);
+
 void ExecDump(MAPSIZE * Map, DATE * Current, DATE * Start, OPTIONSTRUCT * Options,
 	      DUMPSTRUCT * Dump, TOPOPIX ** TopoMap, EVAPPIX ** EvapMap,
 	      PRECIPPIX ** PrecipMap, RADCLASSPIX ** RadMap, SNOWPIX ** SnowMap,
@@ -102,11 +154,15 @@ void ExecDump(MAPSIZE * Map, DATE * Current, DATE * Start, OPTIONSTRUCT * Option
 
 unsigned char fequal(float a, float b);
 
+void FinishLocalMetData(OPTIONSTRUCT *Options, PIXMET *LocalMet,
+			PRECIPPIX *PrecipMap, SNOWPIX *LocalSnow,
+			SNOWTABLE *SnowAlbedo);
+
 void FinalMassBalance(FILES *Out, AGGREGATED *Total, WATERBALANCE *Mass,
 		      OPTIONSTRUCT * Options, float roadarea);
 
 float FindDT(SOILPIX **SoilMap, MAPSIZE *Map, TIMESTRUCT *Time, 
-	     TOPOPIX **TopoMap, SOILTABLE *SType); 
+	     TOPOPIX **TopoMap, SOILTABLE *SType, PARALLELSTRUCT *Parallel); 
 
 float FindDTRoad(ROADSTRUCT **Network, TIMESTRUCT *Time, int y, int x, 
 		 float dx, float beta, float alpha);
@@ -118,10 +174,16 @@ void GetMetData(OPTIONSTRUCT *Options, TIMESTRUCT *Time, int NSoilLayers,
 		int NStats, float SunMax, METLOCATION *Stat, MAPSIZE *Radar,
 		RADARPIX **RadarMap, char *RadarFileName);
 
+void GetRunon(PARALLELSTRUCT *Parallel, float **Runon, int y, int x);
+
 uchar InArea(MAPSIZE *Map, COORD *Loc);
 
 void InitAggregated(int MaxVegLayers, int MaxSoilLayers, AGGREGATED *Total);
 
+void InitCalibration(char *CalibrationFile, CALIBRATIONSTRUCT *Calibration);
+
+void InitCalibrationDump(CALIBRATIONSTRUCT *Calibration, char *Path);
+
 int InitChannelSediment(Channel * Head, AGGREGATED *Total);
 
 int InitChannelSedInflow(Channel * Head);
@@ -144,6 +206,10 @@ void InitFineMaps(LISTPTR Input, OPTIONSTRUCT *Options, MAPSIZE *Map,
 		     LAYER *Soil, TOPOPIX ***TopoMap, SOILPIX ***SoilMap, 
 		  FINEPIX ****FineMap);
 
+void InitEnsemble(char *EnsembleFile, ENSEMBLESTRUCT *Ensemble);
+
+void InitEnsembleMember(ENSEMBLESTRUCT *Ensemble, char *Path);
+
 void InitImageDump(LISTPTR Input, int Dt, MAPSIZE *Map, int MaxSoilLayers,
 		   int MaxVegLayers, char *Path, int NMaps, int NImages,
 		   MAPDUMP **DMap);
@@ -167,7 +233,7 @@ void InitMetMaps(int NDaySteps, MAPSIZE *Map, MAPSIZE *Radar,
 		 EVAPPIX ***EvapMap, PRECIPPIX ***PrecipMap,
 		 RADARPIX ***RadarMap, RADCLASSPIX ***RadMap,
 		 SOILPIX **SoilMap, LAYER *Soil, VEGPIX **VegMap,
-		 LAYER *Veg, TOPOPIX **TopoMap, float ****MM5Input,
+		 LAYER *Veg, TOPOPIX **TopoMap, MM5MAPS *MM5Input,
 		 float ****WindModel);
 
 void InitMetSources(LISTPTR Input, OPTIONSTRUCT *Options, MAPSIZE *Map,
@@ -179,7 +245,7 @@ void InitMM5(LISTPTR Input, int NSoilLayers, TIMESTRUCT *Time,
 	     INPUTFILES *InFiles, OPTIONSTRUCT *Options, MAPSIZE *MM5Map,
 	     MAPSIZE *Map);
 
-void InitMM5Maps(int NSoilLayers, int NY, int NX, float ****MM5Input,
+void InitMM5Maps(int NSoilLayers, int NY, int NX, MM5MAPS *MM5Input,
 		 RADCLASSPIX ***RadMap, OPTIONSTRUCT *Options);
 
 void InitModelState(DATE *Start, MAPSIZE *Map, OPTIONSTRUCT *Options,
@@ -208,7 +274,11 @@ void InitNewStep(INPUTFILES *InFiles, MAPSIZE *Map, TIMESTRUCT *Time,
 		 METLOCATION *Stat, char *RadarFileName, MAPSIZE *Radar,
 		 RADARPIX **RadarMap, SOLARGEOMETRY *SolarGeo, 
 		 TOPOPIX **TopoMap, RADCLASSPIX **RadMap, SOILPIX **SoilMap,
-		 float ***MM5Input, float ***WindModel, MAPSIZE *MM5Map);
+		 MM5MAPS MM5Input, float ***WindModel, MAPSIZE *MM5Map);
+
+void InitParallel(int *argc, char ***argv, PARALLELSTRUCT *Parallel);
+
+void InitParallelRank(PARALLELSTRUCT *Parallel, char *Path);
 
 void InitParameters(LISTPTR Input, OPTIONSTRUCT * Options, MAPSIZE * Map,
 		    ROADSTRUCT ***Network, CHANNEL *ChannelData, TOPOPIX **TopoMap,
@@ -266,6 +336,11 @@ void InitTables(int StepsPerDay, LISTPTR Input, OPTIONSTRUCT *Options,
 		SOILTABLE **SType, LAYER *Soil, VEGTABLE **VType,
 		LAYER *Veg, SNOWTABLE **SnowAlbedo);
 
+void InitMultiPoint(char *PointFile, MAPSIZE *Map, OPTIONSTRUCT *Options);
+
+void InitMultiPointDump(char *Path, MAPSIZE *Map, OPTIONSTRUCT *Options,
+			TIMESTRUCT *Time, int MaxSoilLayers, FILES *OutFile);
+
 void InitTerrainMaps(LISTPTR Input, OPTIONSTRUCT *Options, MAPSIZE *Map,
 		     LAYER *Soil, TOPOPIX ***TopoMap, SOILPIX ***SoilMap,
 		     VEGPIX ***VegMap);
@@ -295,6 +370,19 @@ uchar IsStationLocation(COORD *Loc, int NStats, METLOCATION *Station,
 void InitXGraphics(int argc, char **argv,
 		   int ny, int nx, int nd, MET_MAP_PIX ***MetMap);
 
+PIXMET InterpolateLocalMet(int y, int x, MAPSIZE *Map, int DayStep,
+			   OPTIONSTRUCT *Options, int NStats,
+			   METLOCATION *Stat, STATIONARRAYS *Stations,
+			   uchar *MetWeights,
+			   float LocalElev, RADCLASSPIX *RadMap,
+			   PRECIPPIX *PrecipMap, MAPSIZE *Radar,
+			   RADARPIX **RadarMap, float **PrismMap,
+			   MM5MAPS MM5Input, float ***WindModel,
+			   float **PrecipLapseMap, COMPACTMAPS *Compact,
+			   int Month, float skyview,
+			   unsigned char shadow, float SunMax,
+			   float SineSolarAltitude);
+
 float LapsePrecip(float Precip, float FromElev, float ToElev,
 		  float PrecipLapse);
 
@@ -307,13 +395,15 @@ void MainMWM(SEDPIX **SedMap, FINEPIX ***FineMap, VEGTABLE *VType, SEDTABLE *Sed
  
 PIXMET MakeLocalMetData(int y, int x, MAPSIZE *Map, int DayStep,
 			OPTIONSTRUCT *Options, int NStats,
-			METLOCATION *Stat, uchar *MetWeights,
+			METLOCATION *Stat, STATIONARRAYS *Stations,
+			uchar *MetWeights,
 			float LocalElev, RADCLASSPIX *RadMap,
 			PRECIPPIX *PrecipMap, MAPSIZE *Radar,
 			RADARPIX **RadarMap, float **PrismMap,
 			SNOWPIX *LocalSnow, SNOWTABLE *SnowAlbedo,
-			float ***MM5Input, float ***WindModel,
-			float **PrecipLapseMap, MET_MAP_PIX ***MetMap,
+			MM5MAPS MM5Input, float ***WindModel,
+			float **PrecipLapseMap, COMPACTMAPS *Compact,
+			MET_MAP_PIX ***MetMap,
 			int NGraphics, int Month, float skyview,
 			unsigned char shadow, float SunMax,
 			float SineSolarAltitude);
@@ -324,22 +414,52 @@ void MassBalance(DATE *Current, FILES *Out, FILES *SedOut, AGGREGATED *Total,
 void MassEnergyBalance(int y, int x, float SineSolarAltitude, float DX, 
 		       float DY, int Dt, int HeatFluxOption, 
 		       int CanopyRadAttOption, int RoadRouteOption,
-		       int InfiltOption,int MaxVegLayers,  PIXMET *LocalMet,
+		       int InfiltOption, int ComponentsOption,
+		       int MaxVegLayers, PIXMET *LocalMet,
 		       ROADSTRUCT *LocalNetwork, PRECIPPIX *LocalPrecip,
 		       VEGTABLE *VType, VEGPIX *LocalVeg, SOILTABLE *SType,
 		       SOILPIX *LocalSoil, SNOWPIX *LocalSnow,
 		       EVAPPIX *LocalEvap, PIXRAD *TotalRad,
 		       CHANNEL *ChannelData);
 
+void DumpMultiPoint(FILES *OutFile, OPTIONSTRUCT *Options, LAYER *Soil,
+		    PIXMET *PointMet, PRECIPPIX **PrecipMap, SNOWPIX **SnowMap,
+		    SOILPIX **SoilMap, EVAPPIX **EvapMap);
+
 float MaxRoadInfiltration(ChannelMapPtr **map, int col, int row);
 
+void MinOverRanks(PARALLELSTRUCT *Parallel, float *Values, int N);
+
 void OutputChannelSediment(Channel * Head, TIMESTRUCT Time, DUMPSTRUCT *Dump);
 
 double pow (double a, double b);
 
-void quick(ITEM *OrderedCells, int count);
+void quick(ITEM *OrderedCells, long count);
+
+void qs(ITEM *OrderedCells, long left, long right);
+
+void PartitionBasin(OPTIONSTRUCT *Options, MAPSIZE *Map, LAYER *Soil,
+		    VEGTABLE *VType, TOPOPIX ***TopoMap, SOILPIX ***SoilMap,
+		    VEGPIX ***VegMap, ROADSTRUCT ***Network,
+		    CHANNEL *ChannelData, int NStats, METLOCATION *Stat,
+		    MAPSIZE *Radar, MAPSIZE *MM5Map);
+
+void PerturbLocalMet(int y, int x, MAPSIZE *Map, OPTIONSTRUCT *Options,
+		     int NStats, METLOCATION *Stat, STATIONARRAYS *Stations,
+		     uchar *MetWeights, float LocalElev, PRECIPPIX *PrecipMap,
+		     MAPSIZE *Radar, RADARPIX **RadarMap, float **PrismMap,
+		     MM5MAPS MM5Input, float **PrecipLapseMap,
+		     COMPACTMAPS *Compact, int Month, float TempOffset,
+		     float PrecipMultiplier, PIXMET *LocalMet);
 
-void qs(ITEM *OrderedCells, int left, int right);
+void PerturbMetData(ENSEMBLESTRUCT *Ensemble, OPTIONSTRUCT *Options,
+		    MAPSIZE *Map, MAPSIZE *Radar, int NStats,
+		    METLOCATION *Stat, RADARPIX **RadarMap, MM5MAPS MM5Input);
+
+void PerturbParameters(ENSEMBLESTRUCT *Ensemble, LAYER *Soil,
+		       SOILTABLE *SType);
+
+int ProcessFailed(char *Kind, char *Name, int ExitStatus);
 
 void ReadChannelState(char *Path, DATE *Current, Channel *Head);
 
@@ -353,9 +473,14 @@ void ReadRadarMap(DATE *Current, DATE *StartRadar, int Dt, MAPSIZE *Radar,
 void ReadPRISMMap(DATE *Current, DATE *StartRadar, int Dt, MAPSIZE *Radar,
 		  RADARPIX **RadarMap, char *HDFFileName);
 
+void ReduceAggregate(OPTIONSTRUCT *Options, LAYER *Soil, LAYER *Veg,
+		     AGGREGATED *Total, float LastGlacier);
+
 void ResetAggregate(LAYER *Soil, LAYER *Veg, AGGREGATED *Total,
                     OPTIONSTRUCT *Options);
 
+void ResetRunon(PARALLELSTRUCT *Parallel);
+
 void ResetValues(MAPSIZE *Map, SOILPIX **SoilMap);
 
 int Round(double x);
@@ -374,12 +499,13 @@ void RouteDebrisFlow(float *SedimentToChannel, int prevy,
 void RouteRoad(MAPSIZE * Map, TIMESTRUCT * Time, TOPOPIX ** TopoMap, 
 	       SOILPIX ** SoilMap, ROADSTRUCT ** Network, SOILTABLE * SType, 
 	       CHANNEL * ChannelData, PRECIPPIX ** PrecipMap, SEDPIX **SedMap,
-	       float Tair, float Rh, float *SedDiams); 
+	       ADAPTIVESTRUCT *Adaptive, float Tair, float Rh,
+	       float *SedDiams); 
 
 void RouteSubSurface(int Dt, MAPSIZE *Map, TOPOPIX **TopoMap,
 		     VEGTABLE *VType, VEGPIX **VegMap,
 		     ROADSTRUCT **Network, SOILTABLE *SType,
-		     SOILPIX **SoilMap, CHANNEL *ChannelData, 
+		     PARAMMAP *Params, SOILPIX **SoilMap, CHANNEL *ChannelData, 
 		     TIMESTRUCT *Time, OPTIONSTRUCT *Options, 
 		     char *DumpPath, SEDPIX **SedMap, FINEPIX ***FineMap,
 		     SEDTABLE *SedType, int MaxStreamID, SNOWPIX **SnowMap);
@@ -389,9 +515,14 @@ void RouteSurface(MAPSIZE *Map, TIMESTRUCT *Time, TOPOPIX **TopoMap,
 		  UNITHYDR **UnitHydrograph,
 		  UNITHYDRINFO *HydrographInfo, float *Hydrograph,
 		  DUMPSTRUCT *Dump, VEGPIX **VegMap, VEGTABLE *VType,
-		  SOILTABLE *SType, CHANNEL *ChannelData, SEDPIX **SedMap,
-		  PRECIPPIX **PrecipMap, SEDTABLE *SedType, float Tair, 
-		  float Rh, float *SedDiams);
+		  SOILTABLE *SType, PARAMMAP *Params, CHANNEL *ChannelData,
+		  SEDPIX **SedMap, PRECIPPIX **PrecipMap, SEDTABLE *SedType,
+		  float Tair, float Rh, float *SedDiams);
+
+void RunCalibration(CALIBRATIONSTRUCT *Calibration, int NStats,
+		    METLOCATION *Stat);
+
+void RunEnsemble(ENSEMBLESTRUCT *Ensemble, int NStats, METLOCATION *Stat);
 
 float SatVaporPressure(float Temperature);
 
@@ -411,6 +542,12 @@ void SkipHeader(FILES *InFile, int NLines);
 
 void SkipLines(FILES *InFile, int NLines);
 
+void StepEndTime(ADAPTIVESTRUCT *Adaptive, TIMESTRUCT *Time,
+		 TIMESTRUCT *End);
+
+uchar StepShadow(ADAPTIVESTRUCT *Adaptive, uchar ***ShadowMap, int DayStep,
+		 int y, int x);
+
 void StoreChannelState(char *Path, DATE *Current, Channel *Head);
 
 void StoreModelState(char *Path, DATE * Current, MAPSIZE * Map,
@@ -422,6 +559,10 @@ void StoreModelState(char *Path, DATE * Current, MAPSIZE * Map,
 		     UNITHYDRINFO * HydrographInfo, float *Hydrograph,
 		     CHANNEL * ChannelData);
 
+void SumOverRanks(PARALLELSTRUCT *Parallel, double *Values, int N);
+
 float viscosity(float Tair, float Rh);
 
+int WaitForProcess(char *Routine, pid_t *Pid, int NSlots, int *ExitStatus);
+
 #endif
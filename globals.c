@@ -6,32 +6,148 @@
  * ORG:          University of Washington, Department of Civil Engineering
  * E-MAIL:       nijssen@u.washington.edu
  * ORIG-DATE:    29-May-97 at 20:27:40
+ * DESCRIPTION:  The constants of the configuration file, and the copy of
+ *               the globals of a model run, see globals.h
+ * DESCRIP-END.
+ * FUNCTIONS:    SaveGlobals()
+ *               RestoreGlobals()
  * $Id: globals.c,v 1.4 2003/07/01 21:26:30 olivier Exp $
  */
 
-float LAI_SNOW_MULTIPLIER;	/* multiplier to calculate the amount of 
-				   available snow interception as a function of
-				   LAI */
-float LAI_WATER_MULTIPLIER;	/* multiplier to determine maximum interception 
-				   storage as a function of LAI  */
-float LIQUID_WATER_CAPACITY;	/* water holding capacity of snow as a fraction
-				   of snow-water-equivalent */
-float MAX_SNOW_TEMP;		/* maximum temperature at which snow can 
+#include <stdio.h>
+#include <string.h>
+#include "settings.h"
+#include "constants.h"
+#include "fileio.h"
+#include "channel_grid.h"
+#include "dispatch.h"
+#include "profile.h"
+#include "memtrack.h"
+#include "globals.h"
+
+/* the constants belong to the thread that runs a model instance, see
+   globals.h */
+__thread float LAI_SNOW_MULTIPLIER;	/* multiplier to calculate the amount
+					   of available snow interception as
+					   a function of LAI */
+__thread float LAI_WATER_MULTIPLIER;	/* multiplier to determine maximum
+					   interception storage as a function
+					   of LAI */
+__thread float LIQUID_WATER_CAPACITY;	/* water holding capacity of snow as
+					   a fraction of
+					   snow-water-equivalent */
+__thread float MAX_SNOW_TEMP;	/* maximum temperature at which snow can
 				   occur (C) */
-float MIN_INTERCEPTION_STORAGE;	/* the amount of snow on the canopy that can 
-				   only be melted off. (m) */
-float MIN_RAIN_TEMP;		/* minimum temperature at which rain can 
+__thread float MIN_INTERCEPTION_STORAGE;	/* the amount of snow on the
+						   canopy that can only be
+						   melted off. (m) */
+__thread float MIN_RAIN_TEMP;	/* minimum temperature at which rain can
 				   occur (C) */
-int NWINDMAPS;			/* Number of wind maps in case the wind source
-				   is model */
-unsigned char OUTSIDEBASIN;	/* Mask value indicating outside the basin */
-float PRECIPLAPSE;		/* Precipitation lapse rate in m/timestep / m */
-float TEMPLAPSE;		/* Temperature lapse rate in C/m */
-float Z0_GROUND;		/* Roughness length for bare soil (m) */
-float Z0_SNOW;			/* Roughness length for snow (m) */
-float Zref;			/* Reference height (m) */
-float MASSITER;                    /* Maximum number of iterations for mass wasting*/
-float DEBRISd50;
-float DEBRISd90;
-float CHANNELd50;
-float CHANNELd90;
+__thread int NWINDMAPS;		/* Number of wind maps in case the wind
+				   source is model */
+__thread unsigned char OUTSIDEBASIN;	/* Mask value indicating outside the
+					   basin */
+__thread float PRECIPLAPSE;	/* Precipitation lapse rate in m/timestep /
+				   m */
+__thread float TEMPLAPSE;	/* Temperature lapse rate in C/m */
+__thread float Z0_GROUND;	/* Roughness length for bare soil (m) */
+__thread float Z0_SNOW;		/* Roughness length for snow (m) */
+__thread float Zref;		/* Reference height (m) */
+__thread float MASSITER;	/* Maximum number of iterations for mass
+				   wasting */
+__thread float DEBRISd50;
+__thread float DEBRISd90;
+__thread float CHANNELd50;
+__thread float CHANNELd90;
+
+/*****************************************************************************
+  Function name: SaveGlobals()
+
+  Purpose      : Copy the globals of the calling thread
+
+  Required     :
+    GLOBALSTATE *Globals - Copy of the globals
+
+  Returns      : void
+
+  Modifies     : Globals
+
+  Comments     : See globals.h for the globals that are copied
+*****************************************************************************/
+void SaveGlobals(GLOBALSTATE *Globals)
+{
+  Globals->LaiSnowMultiplier = LAI_SNOW_MULTIPLIER;
+  Globals->LaiWaterMultiplier = LAI_WATER_MULTIPLIER;
+  Globals->LiquidWaterCapacity = LIQUID_WATER_CAPACITY;
+  Globals->MaxSnowTemp = MAX_SNOW_TEMP;
+  Globals->MinInterceptionStorage = MIN_INTERCEPTION_STORAGE;
+  Globals->MinRainTemp = MIN_RAIN_TEMP;
+  Globals->NWindMaps = NWINDMAPS;
+  Globals->OutsideBasin = OUTSIDEBASIN;
+  Globals->PrecipLapse = PRECIPLAPSE;
+  Globals->TempLapse = TEMPLAPSE;
+  Globals->Z0Ground = Z0_GROUND;
+  Globals->Z0Snow = Z0_SNOW;
+  Globals->Zref = Zref;
+  Globals->MassIter = MASSITER;
+  Globals->Debrisd50 = DEBRISd50;
+  Globals->Debrisd90 = DEBRISd90;
+  Globals->Channeld50 = CHANNELd50;
+  Globals->Channeld90 = CHANNELd90;
+  strcpy(Globals->FileExt, fileext);
+  Globals->CreateMapFile = CreateMapFile;
+  Globals->Read2DMatrix = Read2DMatrix;
+  Globals->Write2DMatrix = Write2DMatrix;
+  GetMapWindow(&(Globals->MapWindow));
+  Globals->OutputBuffer = GetOutputBuffer();
+  channel_grid_save_state(&(Globals->ChannelGrid));
+  Globals->CalcTransmissivities = CalcTransmissivities;
+  Globals->Profile = Profile;
+  Globals->Memory = GetMemTable();
+  memcpy(Globals->FixedScale, FixedScale, sizeof(FixedScale));
+}
+
+/*****************************************************************************
+  Function name: RestoreGlobals()
+
+  Purpose      : Give the calling thread the globals of a copy
+
+  Required     :
+    GLOBALSTATE *Globals - Copy made by SaveGlobals()
+
+  Returns      : void
+
+  Modifies     : The globals of the calling thread
+*****************************************************************************/
+void RestoreGlobals(GLOBALSTATE *Globals)
+{
+  LAI_SNOW_MULTIPLIER = Globals->LaiSnowMultiplier;
+  LAI_WATER_MULTIPLIER = Globals->LaiWaterMultiplier;
+  LIQUID_WATER_CAPACITY = Globals->LiquidWaterCapacity;
+  MAX_SNOW_TEMP = Globals->MaxSnowTemp;
+  MIN_INTERCEPTION_STORAGE = Globals->MinInterceptionStorage;
+  MIN_RAIN_TEMP = Globals->MinRainTemp;
+  NWINDMAPS = Globals->NWindMaps;
+  OUTSIDEBASIN = Globals->OutsideBasin;
+  PRECIPLAPSE = Globals->PrecipLapse;
+  TEMPLAPSE = Globals->TempLapse;
+  Z0_GROUND = Globals->Z0Ground;
+  Z0_SNOW = Globals->Z0Snow;
+  Zref = Globals->Zref;
+  MASSITER = Globals->MassIter;
+  DEBRISd50 = Globals->Debrisd50;
+  DEBRISd90 = Globals->Debrisd90;
+  CHANNELd50 = Globals->Channeld50;
+  CHANNELd90 = Globals->Channeld90;
+  strcpy(fileext, Globals->FileExt);
+  CreateMapFile = Globals->CreateMapFile;
+  Read2DMatrix = Globals->Read2DMatrix;
+  Write2DMatrix = Globals->Write2DMatrix;
+  SetMapWindow(&(Globals->MapWindow));
+  SetOutputBuffer(Globals->OutputBuffer);
+  channel_grid_restore_state(&(Globals->ChannelGrid));
+  CalcTransmissivities = Globals->CalcTransmissivities;
+  SetProfile(Globals->Profile);
+  SetMemTable(Globals->Memory);
+  memcpy(FixedScale, Globals->FixedScale, sizeof(FixedScale));
+}
@@ -0,0 +1,76 @@
+/*
+ * SUMMARY:      globals.h - header file for the globals of a model run
+ * USAGE:        Part of DHSVM
+ *
+ * AUTHOR:       DHSVM development team
+ * ORG:          University of Washington, Department of Civil Engineering
+ * E-MAIL:
+ * ORIG-DATE:    Oct-2026
+ * DESCRIPTION:  The constants of the configuration file (constants.h), the
+ *               file format (fileio.h), the channel grid module, the
+ *               vector kernels (dispatch.h), the profile and the table of
+ *               allocations are globals of the thread that runs the
+ *               model.  A model instance (model.h) owns a GLOBALSTATE with
+ *               its values, which SaveGlobals() fills at the end of the
+ *               initialization and RestoreGlobals() puts back in the
+ *               thread that steps the instance.  The worker threads of
+ *               the pixel loop get the globals of the thread that starts
+ *               the loop, see RunTiles().
+ * DESCRIP-END.
+ * FUNCTIONS:
+ * COMMENTS:     Two instances can therefore be stepped at the same time
+ *               from two threads.
+ * $Id: globals.h,v 1.0 2026/10/17 Exp $
+ */
+
+#ifndef GLOBALS_H
+#define GLOBALS_H
+
+#include <stdio.h>
+#include "settings.h"
+#include "fileio.h"
+#include "channel_grid.h"
+#include "profile.h"
+#include "memtrack.h"
+#include "compact.h"
+
+typedef struct {
+  float LaiSnowMultiplier;	/* LAI_SNOW_MULTIPLIER */
+  float LaiWaterMultiplier;	/* LAI_WATER_MULTIPLIER */
+  float LiquidWaterCapacity;	/* LIQUID_WATER_CAPACITY */
+  float MaxSnowTemp;		/* MAX_SNOW_TEMP */
+  float MinInterceptionStorage;	/* MIN_INTERCEPTION_STORAGE */
+  float MinRainTemp;		/* MIN_RAIN_TEMP */
+  int NWindMaps;		/* NWINDMAPS */
+  uchar OutsideBasin;		/* OUTSIDEBASIN */
+  float PrecipLapse;		/* PRECIPLAPSE */
+  float TempLapse;		/* TEMPLAPSE */
+  float Z0Ground;		/* Z0_GROUND */
+  float Z0Snow;			/* Z0_SNOW */
+  float Zref;			/* Zref */
+  float MassIter;		/* MASSITER */
+  float Debrisd50;		/* DEBRISd50 */
+  float Debrisd90;		/* DEBRISd90 */
+  float Channeld50;		/* CHANNELd50 */
+  float Channeld90;		/* CHANNELd90 */
+  char FileExt[BUFSIZ + 1];	/* fileext */
+  void (*CreateMapFile) (char *FileName, ...);
+  int (*Read2DMatrix) (char *FileName, void *Matrix, int NumberType, int NY,
+		       int NX, int NDataSet, ...);
+  int (*Write2DMatrix) (char *FileName, void *Matrix, int NumberType, int NY,
+			int NX, ...);
+  MAPWINDOW MapWindow;		/* Window of the grid in the map files */
+  int OutputBuffer;		/* Buffer of the output files (bytes) */
+  ChannelGridState ChannelGrid;	/* State of the channel grid module */
+  void (*CalcTransmissivities) (int N, float *SoilDepth, float *WaterTable,
+				float *LateralKs, float *KsExponent,
+				float *DepthThresh, float *Out);
+  PROFILESTRUCT *Profile;	/* Profile of the run */
+  MEMTABLE *Memory;		/* Table of the allocations of the run */
+  FIXEDSCALE FixedScale[NFIXEDCODES];	/* Scales of the fixed point fields */
+} GLOBALSTATE;
+
+void SaveGlobals(GLOBALSTATE *Globals);
+void RestoreGlobals(GLOBALSTATE *Globals);
+
+#endif
@@ -0,0 +1,76 @@
+/*
+ * SUMMARY:      memtrack.h - header file for the memory accounting
+ * USAGE:        Part of DHSVM
+ *
+ * AUTHOR:       DHSVM development team
+ * ORG:          University of Washington, Department of Civil Engineering
+ * E-MAIL:
+ * ORIG-DATE:    Oct-2026
+ * DESCRIPTION:  The long-lived model arrays are allocated with
+ *               TrackedCalloc(), which records the bytes and the number of
+ *               blocks of each structure, tagged by subsystem.  The totals
+ *               are reported at the end of the initialization, the peak
+ *               resident memory at the end of the run.  PredictMemory()
+ *               fills the same table from the configuration alone, for the
+ *               dry run (DHSVM -dryrun).
+ * DESCRIP-END.
+ * FUNCTIONS:
+ * COMMENTS:     Each model instance (dhsvm.h) has its own table, selected
+ *               by SetMemTable(), and the table is cleared by ResetMemory().
+ * $Id: memtrack.h,v 1.0 2026/10/17 Exp $
+ */
+
+#ifndef MEMTRACK_H
+#define MEMTRACK_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include "settings.h"
+#include "data.h"
+#include "getinit.h"
+
+/* subsystems, list order must match the names in MemTrack.c */
+enum SUBSYSTEMS {
+  MEM_TERRAIN = 0, MEM_SOIL, MEM_VEGETATION, MEM_METEOROLOGY, MEM_SNOW,
+  MEM_NETWORK, MEM_SEDIMENT, NSUBSYSTEMS
+};
+
+#define MAXSTRUCTURES 64	/* Structures in a table of allocations */
+#define MAXMAPBUFFERS 8	/* Buffers of CallocMap() recorded at a time */
+
+typedef struct {
+  const char *Name;		/* Name of the structure */
+  int Subsystem;		/* Subsystem, see enum SUBSYSTEMS */
+  double Blocks;		/* Number of blocks */
+  double Bytes;			/* Bytes asked for */
+  double Footprint;		/* Bytes including the allocator overhead */
+} MEMENTRY;
+
+typedef struct {
+  MEMENTRY Entry[MAXSTRUCTURES];	/* Allocations of each structure */
+  int NEntries;			/* Number of structures */
+  MEMENTRY *Last;		/* Entry of the previous allocation */
+  void *MapBuffer[MAXMAPBUFFERS];	/* Buffers of CallocMap() that are
+					   not freed yet */
+} MEMTABLE;
+
+void *CallocMap(size_t NY, size_t NX, size_t Size);
+void FreeMap(void *Map);
+void FreeMapBuffers(void);
+void *TrackedCalloc(size_t NElem, size_t Size, int Subsystem,
+		    const char *Structure);
+void *TrackedMalloc(size_t Size, int Subsystem, const char *Structure);
+void TrackedFree(void *Ptr, size_t Size, int Subsystem,
+		 const char *Structure);
+void PredictAllocation(double NBlocks, size_t Size, int Subsystem,
+		       const char *Structure);
+void PredictMemory(LISTPTR Input, OPTIONSTRUCT *Options, MAPSIZE *Map,
+		   LAYER *Soil, LAYER *Veg, VEGTABLE *VType, int NDaySteps);
+void ResetMemory(void);
+void SetMemTable(MEMTABLE *Memory);
+MEMTABLE *GetMemTable(void);
+double TrackedBytes(void);
+void ReportMemory(FILE *OutFile, const char *Title);
+void ReportPeakMemory(FILE *OutFile);
+
+#endif
@@ -0,0 +1,135 @@
+/*
+ * SUMMARY:      model.h - header file for the model instance of libdhsvm
+ * USAGE:        Part of DHSVM
+ *
+ * AUTHOR:       DHSVM development team
+ * ORG:          University of Washington, Department of Civil Engineering
+ * E-MAIL:
+ * ORIG-DATE:    Oct-2026
+ * DESCRIPTION:  Everything a model run owns: the state that used to be local
+ *               to main(), its profile and table of allocations, and the
+ *               values of the globals of the run (globals.h).  The globals
+ *               are thread-local and are put back in the calling thread
+ *               whenever the instance is stepped, so that several
+ *               instances can share a process and run at the same time.
+ * DESCRIP-END.
+ * FUNCTIONS:
+ * COMMENTS:
+ * $Id: model.h,v 1.0 2026/10/17 Exp $
+ */
+
+#ifndef MODEL_H
+#define MODEL_H
+
+#include "settings.h"
+#include "data.h"
+#include "getinit.h"
+#include "fileio.h"
+#include "DHSVMChannel.h"
+#include "channel_grid.h"
+#include "sweep.h"
+#include "ensemble.h"
+#include "server.h"
+#include "progress.h"
+#include "tiles.h"
+#include "params.h"
+#include "placement.h"
+#include "compact.h"
+#include "memtrack.h"
+#include "tuning.h"
+#include "profile.h"
+#include "globals.h"
+#include "dhsvm.h"
+
+struct dhsvm_model {
+  float *Hydrograph;
+  MM5MAPS MM5Input;		/* MM5 input maps, see compact.h */
+  float **PrecipLapseMap;
+  float **PrismMap;
+  unsigned char ***ShadowMap;
+  float **SkyViewMap;
+  float ***WindModel;
+  int MaxStreamID;
+  int MaxRoadID;
+  float SedDiams[NSEDSIZES];	/* Sediment particle diameters (mm) */
+  float roadarea;
+  int shade_offset;		/* a fast way of handling arraay position
+				   given the number of mm5 input options */
+  int NStats;			/* Number of meteorological stations */
+  uchar ***MetWeights;		/* 3D array with weights for interpolating
+				   meteorological variables between the
+				   stations */
+  int NMembers;			/* number of members simulated in this
+				   process */
+  int NGraphics;		/* number of graphics for X11 */
+  int *which_graphics;		/* which graphics for X11 */
+  AGGREGATED Total;		/* Total or average value of a variable over
+				   the entire basin */
+  CHANNEL ChannelData;
+  DUMPSTRUCT Dump;
+  EVAPPIX **EvapMap;
+  INPUTFILES InFiles;
+  LAYER Soil;
+  LAYER Veg;
+  MAPSIZE Map;			/* Size and location of model area */
+  MAPSIZE Radar;		/* Size and location of area covered by
+				   precipitation radar */
+  MAPSIZE MM5Map;		/* Size and location of area covered by MM5
+				   input files */
+  METLOCATION *Stat;
+  TILESTRUCT Tiles;		/* Tiles of the threaded pixel loop */
+  TILESTRUCT PointTiles;	/* Blocks of points of the threaded
+				   MULTIPOINT loop */
+  PARAMMAP Params;		/* Per-pixel parameters of the routing */
+  PLACEMENT Placement;		/* Pages of the maps of the model state */
+  COMPACTMAPS Compact;		/* Compact static maps of the meteorology */
+  STATIONARRAYS Stations;	/* Station data of the time step, for
+				   InterpolateStations() (dispatch.h) */
+  OPTIONSTRUCT Options;		/* Structure with information which program
+				   options to follow */
+  PIXMET LocalMet;		/* Meteorological conditions for current
+				   pixel */
+  PIXMET *PointMet;		/* Meteorological conditions for each point
+				   in MULTIPOINT mode */
+  CELLSWEEP Sweep;		/* Pointers needed for the per pixel column
+				   physics */
+  MEMBERSTATE *Members;		/* Model state of each member if all
+				   ensemble members run in this process */
+  MEMBERSWEEP MemberSweep;	/* Model structures of each member for the
+				   column physics */
+  SERVERSTATE Server;		/* Pointers needed by the forecast server */
+  PROGRESSSTRUCT Progress;	/* Progress of the run, for Progress.json */
+  FINEPIX ***FineMap;
+  PRECIPPIX **PrecipMap;
+  RADARPIX **RadarMap;
+  RADCLASSPIX **RadMap;
+  ROADSTRUCT **Network;		/* 2D Array with channel information for each
+				   pixel */
+  SNOWPIX **SnowMap;
+  MET_MAP_PIX **MetMap;
+  SNOWTABLE *SnowAlbedo;
+  SOILPIX **SoilMap;
+  SEDPIX **SedMap;
+  SOILTABLE *SType;
+  SEDTABLE *SedType;
+  SOLARGEOMETRY SolarGeo;	/* Geometry of Sun-Earth system (needed for
+				   INLINE radiation calculations */
+  TIMESTRUCT Time;
+  TOPOPIX **TopoMap;
+  UNITHYDR **UnitHydrograph;
+  UNITHYDRINFO HydrographInfo;	/* Information about unit hydrograph */
+  VEGPIX **VegMap;
+  VEGTABLE *VType;
+  WATERBALANCE Mass;		/* parameter for mass balance calculations */
+  GLOBALSTATE Globals;		/* Globals of this run, see globals.h */
+  MEMTABLE Memory;		/* Allocations of this run, see memtrack.h */
+  PROFILESTRUCT Profile;	/* Profile of this run, see profile.h */
+  LISTPTR Input;		/* Input strings of the file being read by
+				   dhsvm_init() */
+  TUNING Candidate;		/* Settings timed by DHSVM -autotune */
+  int HasCandidate;		/* TRUE if Candidate replaces the options of
+				   the configuration file */
+  int Finished;			/* TRUE after the last time step */
+};
+
+#endif
@@ -0,0 +1,79 @@
+/*
+ * SUMMARY:      order.h - header file for the storage order of the
+ *               kinematic wave routing
+ * USAGE:        Part of DHSVM
+ *
+ * AUTHOR:       DHSVM development team
+ * ORG:          University of Washington, Department of Civil Engineering
+ * E-MAIL:
+ * ORIG-DATE:    Oct-2026
+ * DESCRIPTION:  The kinematic wave routing in RouteSurface() visits the
+ *               pixels from the highest to the lowest (Map->OrderedCells),
+ *               which jumps all over the [y][x] maps of the model state.
+ *               With CELL ORDER = TILED, MORTON or HILBERT in the [OPTIONS]
+ *               section the active pixels are renumbered instead: the
+ *               tiles of TILE SIZE pixels are taken row by row or along a
+ *               Morton (Z) or Hilbert curve, and the pixels row by row
+ *               within a tile.  The state of the routing (surface water,
+ *               runon, runoff), the kinematic wave coefficient and the
+ *               downslope neighbors are stored as arrays in this order, and
+ *               the routing visits the pixels tile by tile, so that the
+ *               pixels it routes one after the other are close together
+ *               in memory.  Within a tile the pixels keep the elevation
+ *               order.  A pixel is deferred to a later pass over the tiles
+ *               while a pixel that comes before it in the elevation order
+ *               still has to add runon to it or to a pixel it drains to.
+ *               Every sum therefore gets its terms in the same order as
+ *               with the elevation order, and the results do not change.
+ * DESCRIP-END.
+ * FUNCTIONS:
+ * COMMENTS:     The renumbering stops at RouteSurface():
+ *               LoadCellOrder() copies the state from the soil map when
+ *               the routing starts and StoreCellOrder() copies it back when
+ *               it ends, so the other modules, the model state files and
+ *               the output do not see it.  The order is kept in
+ *               Map->CellOrder, NULL for CELL ORDER = ELEVATION.
+ * $Id: order.h,v 1.0 2026/10/17 Exp $
+ */
+
+#ifndef ORDER_H
+#define ORDER_H
+
+#include "settings.h"
+#include "data.h"
+#include "params.h"
+#include "DHSVMChannel.h"
+
+typedef struct _cellorder_ {
+  int Order;			/* ORDER_TILED, ORDER_MORTON or ORDER_HILBERT */
+  long NCells;			/* Number of active pixels */
+  COORD *Cells;			/* Row (N) and column (E) of the active
+				   pixels, tile by tile along the curve and
+				   row by row within a tile */
+  long *Route;			/* Index in Cells of the pixels in the order
+				   of the routing */
+  long *First;			/* Index in Down of the first neighbor of
+				   each pixel, NCells + 1 in size */
+  long *Down;			/* Index in Cells of the neighbors a pixel
+				   drains to */
+  float *Frac;			/* Fraction of the outflow to each of them */
+  double *Alpha;		/* Kinematic wave coefficient */
+  uchar *Channel;		/* TRUE if the surface water goes into a
+				   stream or road channel in the pixel */
+  float *IExcess;		/* Surface water (m) */
+  float *IExcessSed;		/* Surface water of the sediment routing in
+				   a channel pixel (m) */
+  float *StartRunoff;		/* Outflow of the last sub-step (m3/s) */
+  float *StartRunon;		/* Inflow of the last sub-step (m3/s) */
+  float *Runoff;		/* Runoff of the time step (m) */
+  float *Runon;			/* Inflow of the current sub-step (m3/s) */
+} CELLORDER;
+
+void FreeCellOrder(CELLORDER *Order);
+void InitCellOrder(MAPSIZE *Map, TOPOPIX **TopoMap, SOILPIX **SoilMap,
+		   SOILTABLE *SType, PARAMMAP *Params, CHANNEL *ChannelData,
+		   int Order, int TileSize);
+void LoadCellOrder(CELLORDER *Order, SOILPIX **SoilMap);
+void StoreCellOrder(CELLORDER *Order, SOILPIX **SoilMap);
+
+#endif
@@ -0,0 +1,62 @@
+/*
+ * SUMMARY:      params.h - header file for the per-pixel parameter maps
+ * USAGE:        Part of DHSVM
+ *
+ * AUTHOR:       DHSVM development team
+ * ORG:          University of Washington, Department of Civil Engineering
+ * E-MAIL:
+ * ORIG-DATE:    Oct-2026
+ * DESCRIPTION:  With PARAMETER MAPS = TRUE in the [OPTIONS] section the
+ *               soil and vegetation parameters of the subsurface and
+ *               surface routing are copied from the type tables into one
+ *               array per parameter at the end of the initialization, so
+ *               that the routing loops read them pixel by pixel instead of
+ *               through SoilMap[y][x].Soil and VegMap[y][x].Veg.  The
+ *               arrays are indexed by y * NX + x, the layered parameters
+ *               have MaxLayers values per pixel.  The kinematic wave
+ *               coefficient alpha, which only depends on the slope and the
+ *               Manning roughness of the pixel, is computed once.
+ * DESCRIP-END.
+ * FUNCTIONS:
+ * COMMENTS:     The maps are a copy of the tables and give the same
+ *               results.  They are built after the calibration and the
+ *               ensemble perturbations, and are not used when all ensemble
+ *               members run in one process, since each member has its own
+ *               soil table.
+ * $Id: params.h,v 1.0 2026/10/17 Exp $
+ */
+
+#ifndef PARAMS_H
+#define PARAMS_H
+
+#include "settings.h"
+#include "data.h"
+
+typedef struct {
+  int Active;			/* TRUE if the maps are used */
+  int NX;			/* Columns of the maps */
+  int MaxLayers;		/* Layered values per pixel */
+  float *KsLat;			/* Lateral saturated hydraulic conductivity */
+  float *KsLatExp;		/* Exponent for vertical change of KsLat */
+  float *DepthThresh;		/* Threshold water table depth */
+  float *Porosity;		/* Soil porosity of each layer */
+  float *FCap;			/* Field capacity of each layer */
+  int *NSoilLayers;		/* Number of root zones */
+  float *RootDepth;		/* Depth of each root zone (m) */
+  float *ImpervFrac;		/* Impervious fraction */
+  float *DetentionFrac;		/* Fraction of the impervious runoff that goes
+				   to detention storage */
+  float *DetentionDecay;	/* Decay coefficient of detention storage */
+  double *Alpha;		/* Kinematic wave coefficient */
+} PARAMMAP;
+
+/* index of a pixel in the maps */
+#define PARAMINDEX(Params, y, x) ((long) (y) * (Params)->NX + (x))
+
+void InitParamMap(PARAMMAP *Params, MAPSIZE *Map, TOPOPIX **TopoMap,
+		  SOILPIX **SoilMap, VEGPIX **VegMap, SOILTABLE *SType,
+		  VEGTABLE *VType, LAYER *Soil, LAYER *Veg);
+int ParamLayers(LAYER *Soil, LAYER *Veg, VEGTABLE *VType);
+void FreeParamMap(PARAMMAP *Params);
+
+#endif
@@ -0,0 +1,92 @@
+/*
+ * SUMMARY:      placement.h - header file for the placement of the model maps
+ * USAGE:        Part of DHSVM
+ *
+ * AUTHOR:       DHSVM development team
+ * ORG:          University of Washington, Department of Civil Engineering
+ * E-MAIL:
+ * ORIG-DATE:    Oct-2026
+ * DESCRIPTION:  The maps of the model state are allocated row by row and
+ *               filled by the main thread during the initialization, so on
+ *               a machine with several NUMA nodes all their pages end up
+ *               on the node of the main thread.  With FIRST TOUCH = TRUE
+ *               in the [OPTIONS] section each map is moved at the end of
+ *               the initialization into one block of fresh pages, and every
+ *               tile is copied by the thread that runs it in the threaded
+ *               pixel loop (tiles.h), so that the kernel puts its pages on
+ *               the node of that thread.  HUGE PAGES = TRANSPARENT asks the
+ *               kernel to back the blocks with transparent huge pages
+ *               (madvise(MADV_HUGEPAGE)), HUGE PAGES = EXPLICIT takes them
+ *               from the reserved huge pages (MAP_HUGETLB) and falls back
+ *               to transparent huge pages if there are not enough.  The
+ *               page sizes and the nodes the pages actually ended up on are
+ *               reported after the move.  The layer arrays of the pixels
+ *               (soil moisture, interception, evaporation) are moved the
+ *               same way, one block per field, with the arrays of each tile
+ *               next to each other in the order of the active pixels of
+ *               the tiles.
+ * DESCRIP-END.
+ * FUNCTIONS:
+ * COMMENTS:     Only the row pointers of a map and the layer pointers of
+ *               its pixels change, so the rest of the model is not affected
+ *               and the results do not change.  A
+ *               huge page is placed as a whole, so with huge pages the
+ *               tiles of a thread should cover several megabytes.  The
+ *               placement is not done when all ensemble members run in
+ *               this process, since they swap their maps.
+ * $Id: placement.h,v 1.0 2026/10/17 Exp $
+ */
+
+#ifndef PLACEMENT_H
+#define PLACEMENT_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include "settings.h"
+#include "data.h"
+#include "tiles.h"
+
+#define MAXPLACED 32		/* Most maps and layer fields that are
+				   placed */
+
+/* number of layers in each array of the pixel at row y, column x, with the
+   number of arrays in *NArrays */
+typedef int (*LAYERCOUNT) (void *Arg, int y, int x, int *NArrays);
+
+typedef struct {
+  const char *Name;		/* Name of the map or layer field */
+  void **Rows;			/* Row pointers of the map */
+  int NY;			/* Rows of the map */
+  int NX;			/* Columns of the map */
+  int Layers;			/* TRUE if Block holds the layer arrays of a
+				   pointer field of the pixels */
+  int Indirect;			/* TRUE if the field points to an array of
+				   pointers to the layer arrays */
+  size_t Size;			/* Size of a pixel */
+  size_t Field;			/* Offset of the field in a pixel */
+  char *Block;			/* Pixels of the map, row by row */
+  size_t Bytes;			/* Length of Block, a whole number of pages */
+  size_t PageSize;		/* Size of the pages of Block */
+  int Pages;			/* Kind of pages obtained, see settings.h */
+  signed char *Node;		/* Node of the thread that copied the first
+				   byte of each page, -1 if not known */
+} PLACEDMAP;
+
+typedef struct {
+  int NMaps;			/* Maps that are placed */
+  int NThreads;			/* Threads that copied the maps */
+  PLACEDMAP Map[MAXPLACED];
+} PLACEMENT;
+
+void PlaceMap(PLACEMENT *Place, TILESTRUCT *Tiles, MAPSIZE *Map,
+	      void **Rows, size_t Size, const char *Name, int FirstTouch,
+	      int HugePages);
+void PlaceLayers(PLACEMENT *Place, TILESTRUCT *Tiles, MAPSIZE *Map,
+		 void **Rows, size_t Size, size_t Field, int Indirect,
+		 LAYERCOUNT Count, void *Arg, const char *Name,
+		 int FirstTouch, int HugePages);
+void ReportPlacement(FILE *OutFile, PLACEMENT *Place);
+void FreePlacedLayers(PLACEMENT *Place);
+void FreePlacement(PLACEMENT *Place);
+
+#endif
@@ -0,0 +1,105 @@
+/*
+ * SUMMARY:      profile.h - header file for the built-in profiler
+ * USAGE:        Part of DHSVM
+ *
+ * AUTHOR:       DHSVM development team
+ * ORG:          University of Washington, Department of Civil Engineering
+ * E-MAIL:
+ * ORIG-DATE:    Oct-2026
+ * DESCRIPTION:  Monotonic timers around the phases of a model time step and
+ *               counters of the work done in the hot paths.  Switched on
+ *               with PROFILE = TRUE in the [OPTIONS] section, with
+ *               PROFILE STEPS = TRUE the timers and counters of every time
+ *               step are written to Profile.csv in the output directory.
+ * DESCRIP-END.
+ * FUNCTIONS:
+ * COMMENTS:     When the profiler is off every timer and counter costs a
+ *               single test of Profile->Active.  Each model instance
+ *               (model.h) has a profile of its own, Profile points to the
+ *               profile of the instance that the calling thread runs, see
+ *               SetProfile() and globals.h.
+ * $Id: profile.h,v 1.0 2026/10/17 Exp $
+ */
+
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <pthread.h>
+#include <stdio.h>
+#include "settings.h"
+#include "Calendar.h"
+
+/* phases of a time step, list order must match the names in Profile.c */
+enum PHASES {
+  PROF_INITNEWSTEP = 0, PROF_SWEEP, PROF_SUBSURFACE, PROF_MASSWASTING,
+  PROF_CHANNEL, PROF_CHANNELSED, PROF_SURFACE, PROF_AGGREGATE,
+  PROF_MASSBALANCE, PROF_DUMP, NPHASES
+};
+
+/* counters, list order must match the names in Profile.c */
+enum COUNTERS {
+  PROF_KINEMATICSTEPS = 0, PROF_BRENTITER, PROF_MWMITER, PROF_BYTESREAD,
+  PROF_BYTESWRITTEN, NCOUNTERS
+};
+
+#define MAXPROFILETHREADS 256	/* Threads with counters of their own */
+#define PROFILECACHELINE 64	/* Size of a cache line (bytes) */
+
+/* counters of a thread in the current time step, padded so that two
+   threads never update the same cache line */
+typedef struct {
+  double Count[NCOUNTERS];
+  char Pad[PROFILECACHELINE];
+} THREADCOUNT;
+
+typedef struct {
+  int Active;			/* TRUE if the profiler is on */
+  int Report;			/* TRUE if the profile is printed */
+  int Threaded;			/* TRUE if counters can be updated by several
+				   threads at once, each thread then has
+				   counters of its own */
+  FILE *StepFile;		/* Profile.csv, NULL if not written */
+  int NSteps;			/* Number of time steps profiled */
+  double StepStart;		/* Clock at the start of the current step (s) */
+  double StepTotal;		/* Time in the time steps (s) */
+  double Start[NPHASES];	/* Clock at the start of each phase (s) */
+  double StepTime[NPHASES];	/* Time in each phase in this step (s) */
+  double Time[NPHASES];		/* Time in each phase in the run (s) */
+  double StepCount[NCOUNTERS];	/* Counters in this step */
+  double Count[NCOUNTERS];	/* Counters in the run */
+  THREADCOUNT ThreadCount[MAXPROFILETHREADS];	/* Counters of each thread
+						   in this step */
+  int NThreadCounts;		/* Entries of ThreadCount in use, one past
+				   the highest thread number seen */
+  pthread_mutex_t CountLock;	/* Protects NThreadCounts and the shared
+				   counters */
+} PROFILESTRUCT;
+
+extern __thread PROFILESTRUCT *Profile;
+
+#define PROFILE_START(Phase) \
+  do { if (Profile->Active) StartPhase(Phase); } while (0)
+#define PROFILE_STOP(Phase) \
+  do { if (Profile->Active) StopPhase(Phase); } while (0)
+#define PROFILE_COUNT(Counter, N) \
+  do { if (Profile->Active) CountEvent(Counter, N); } while (0)
+
+/* bytes read from or written to a text file: PROFILE_TELL() before the
+   reads or writes, PROFILE_COUNT_FILE() with that position after them */
+#define PROFILE_TELL(File) (Profile->Active ? ftell(File) : 0L)
+#define PROFILE_COUNT_FILE(Counter, File, Start) \
+  do { if (Profile->Active) \
+      CountEvent(Counter, (double) (ftell(File) - (Start))); } while (0)
+
+void SetProfile(PROFILESTRUCT *Instance);
+void InitProfile(int Active, int Report, int Steps, int Threaded,
+		 char *Path);
+void StartStep(void);
+void StartPhase(int Phase);
+void StopPhase(int Phase);
+void SetProfileThread(int Thread);
+void CountEvent(int Counter, double N);
+void EndStep(DATE *Current);
+void ReportProfile(FILE *OutFile);
+
+#endif
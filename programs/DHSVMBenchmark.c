@@ -0,0 +1,180 @@
+/*
+ * SUMMARY:      DHSVMBenchmark.c - Scaling benchmark on synthetic basins
+ * USAGE:        DHSVMBenchmark [-sizes n,n,...] [-modes m,m,...] [-days n]
+ *                              [-generator path] [-o outdir]
+ *
+ * AUTHOR:       DHSVM development team
+ * ORG:          University of Washington, Department of Civil Engineering
+ * E-MAIL:
+ * ORIG-DATE:    Oct-2026
+ * DESCRIPTION:  Runs a standard set of model configurations on synthetic
+ *               square basins of several sizes and reports the throughput in
+ *               cell-steps per second (basin cells times model time steps
+ *               per second of wall clock time).  The basins are created with
+ *               MakeSyntheticBasin, the model is run in-process through
+ *               libdhsvm (dhsvm.h).  The standard configurations are
+ *                 snow        - meteorology, interception and snow only
+ *                 basin       - full model with kinematic overland routing
+ *                 sediment    - basin plus surface erosion and channel
+ *                               sediment routing
+ *                 masswasting - sediment plus one mass wasting event
+ *               The default sizes are 64, 128 and 256 cells on a side.
+ * DESCRIP-END.
+ * FUNCTIONS:    main()
+ * COMMENTS:     Initialization is timed separately and is not part of the
+ *               throughput.  The same seed is used for every basin, so the
+ *               numbers can be compared between builds and machines.
+ * $Id: DHSVMBenchmark.c,v 1.0 2026/10/17 Exp $
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "dhsvm.h"
+
+#define BUFSIZE 255
+#define MAXRUNS 64
+
+typedef struct {
+  char Mode[BUFSIZE + 1];	/* standard configuration */
+  int Size;			/* cells on a side */
+  int Steps;			/* model time steps taken */
+  double InitTime;		/* time in dhsvm_init() (s) */
+  double RunTime;		/* time in dhsvm_step() (s) */
+} BENCHRUN;
+
+static double Clock(void);
+static void Usage(char *Program);
+static int SplitList(char *List, char Items[][BUFSIZE + 1], int MaxItems);
+
+/*****************************************************************************
+  main()
+*****************************************************************************/
+int main(int argc, char **argv)
+{
+  BENCHRUN Run[MAXRUNS];
+  DHSVM *Model;
+  char Generator[BUFSIZE + 1] = "./MakeSyntheticBasin";
+  char Path[BUFSIZE + 1] = "benchmark";
+  char SizeList[BUFSIZE + 1] = "64,128,256";
+  char ModeList[BUFSIZE + 1] = "snow,basin,sediment,masswasting";
+  char Sizes[MAXRUNS][BUFSIZE + 1];
+  char Modes[MAXRUNS][BUFSIZE + 1];
+  char Basin[2 * BUFSIZE + 1];
+  char Command[4 * BUFSIZE + 1];
+  char ConfigFile[3 * BUFSIZE + 1];
+  int NSizes;
+  int NModes;
+  int NRuns = 0;
+  int Days = 10;
+  int Steps;
+  int i;
+  int m;
+  int s;
+  double Start;
+
+  for (i = 1; i < argc; i++) {
+    if (i + 1 >= argc)
+      Usage(argv[0]);
+    if (strcmp(argv[i], "-sizes") == 0)
+      strncpy(SizeList, argv[++i], BUFSIZE);
+    else if (strcmp(argv[i], "-modes") == 0)
+      strncpy(ModeList, argv[++i], BUFSIZE);
+    else if (strcmp(argv[i], "-days") == 0)
+      Days = atoi(argv[++i]);
+    else if (strcmp(argv[i], "-generator") == 0)
+      strncpy(Generator, argv[++i], BUFSIZE);
+    else if (strcmp(argv[i], "-o") == 0)
+      strncpy(Path, argv[++i], BUFSIZE);
+    else
+      Usage(argv[0]);
+  }
+  NSizes = SplitList(SizeList, Sizes, MAXRUNS);
+  NModes = SplitList(ModeList, Modes, MAXRUNS);
+  if (Days < 1 || NSizes < 1 || NModes < 1 || NSizes * NModes > MAXRUNS)
+    Usage(argv[0]);
+
+  for (m = 0; m < NModes; m++) {
+    for (s = 0; s < NSizes; s++) {
+      Run[NRuns].Size = atoi(Sizes[s]);
+      strcpy(Run[NRuns].Mode, Modes[m]);
+
+      snprintf(Basin, sizeof(Basin), "%s/%s_%d", Path, Modes[m],
+	       Run[NRuns].Size);
+      snprintf(Command, sizeof(Command), "mkdir -p %s && %s -nx %d -ny %d "
+	       "-days %d -mode %s -o %s > /dev/null", Path, Generator, Run[NRuns].Size,
+	       Run[NRuns].Size, Days, Modes[m], Basin);
+      if (system(Command) != 0) {
+	fprintf(stderr, "Cannot create the basin: %s\n", Command);
+	exit(EXIT_FAILURE);
+      }
+      snprintf(ConfigFile, sizeof(ConfigFile), "%s/config.txt", Basin);
+
+      Start = Clock();
+      Model = dhsvm_init(ConfigFile);
+      Run[NRuns].InitTime = Clock() - Start;
+      if (Model == NULL) {
+	fprintf(stderr, "Cannot initialize the model for %s\n", ConfigFile);
+	exit(EXIT_FAILURE);
+      }
+
+      Start = Clock();
+      for (Run[NRuns].Steps = 0; (Steps = dhsvm_step(Model, 1)) > 0;)
+	Run[NRuns].Steps += Steps;
+      Run[NRuns].RunTime = Clock() - Start;
+
+      dhsvm_free(Model);
+      NRuns++;
+    }
+  }
+
+  printf("\nDHSVM benchmark, %d days per run\n", Days);
+  printf("%-12s %6s %10s %7s %10s %10s %15s\n", "Mode", "Size", "Cells",
+	 "Steps", "Init (s)", "Run (s)", "Cell-steps/s");
+  for (i = 0; i < NRuns; i++)
+    printf("%-12s %6d %10d %7d %10.3f %10.3f %15.4g\n", Run[i].Mode,
+	   Run[i].Size, Run[i].Size * Run[i].Size, Run[i].Steps,
+	   Run[i].InitTime, Run[i].RunTime,
+	   Run[i].RunTime > 0. ? (double) Run[i].Size * Run[i].Size *
+	   Run[i].Steps / Run[i].RunTime : 0.);
+
+  return EXIT_SUCCESS;
+}
+
+/*****************************************************************************
+  Clock() - monotonic clock (s)
+*****************************************************************************/
+static double Clock(void)
+{
+  struct timespec Now;
+
+  clock_gettime(CLOCK_MONOTONIC, &Now);
+  return Now.tv_sec + 1e-9 * Now.tv_nsec;
+}
+
+/*****************************************************************************
+  Usage()
+*****************************************************************************/
+static void Usage(char *Program)
+{
+  fprintf(stderr, "Usage: %s [-sizes n,n,...] "
+	  "[-modes snow,basin,sediment,masswasting]\n\t[-days n] "
+	  "[-generator path] [-o outdir]\n", Program);
+  exit(EXIT_FAILURE);
+}
+
+/*****************************************************************************
+  SplitList() - split a comma separated list, returns the number of items
+*****************************************************************************/
+static int SplitList(char *List, char Items[][BUFSIZE + 1], int MaxItems)
+{
+  char *Item;
+  int N = 0;
+
+  for (Item = strtok(List, ","); Item && N < MaxItems;
+       Item = strtok(NULL, ","))
+    strncpy(Items[N++], Item, BUFSIZE);
+
+  return N;
+}
@@ -0,0 +1,1060 @@
+/*
+ * SUMMARY:      MakeSyntheticBasin.c - Create a synthetic basin for DHSVM
+ * USAGE:        MakeSyntheticBasin [options] [-dumps] [-lapsemap]
+ *
+ * AUTHOR:       DHSVM development team
+ * ORG:          University of Washington, Department of Civil Engineering
+ * E-MAIL:
+ * ORIG-DATE:    Oct-2026
+ * DESCRIPTION:  Creates a complete, self-consistent set of DHSVM inputs for a
+ *               synthetic basin of a chosen size: a fractal DEM (with the
+ *               sinks filled), basin mask, soil and vegetation maps, soil
+ *               depth, a stream network with map and class files, met
+ *               station files, an initial model state and the configuration
+ *               file.  All maps are written in the binary (BIN) format.
+ *               The same seed always gives the same basin.  With -dumps the
+ *               configuration also asks for pixel time series, daily maps
+ *               and model states, so that every type of model output is
+ *               written (used by the regression tests).  With -lapsemap
+ *               (one station only) the precipitation is lapsed with a map
+ *               instead of a constant rate, which exercises the compact
+ *               maps (RunRegression.scr -compact).
+ * DESCRIP-END.
+ * FUNCTIONS:    main()
+ * COMMENTS:
+ * $Id: MakeSyntheticBasin.c,v 1.0 2026/10/17 Exp $
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#define BUFSIZE 255
+#define NSOILLAYERS 3
+#define NSTATEMAPS 64		/* number of zero maps in each state file */
+
+typedef struct {
+  int NX;			/* number of columns */
+  int NY;			/* number of rows */
+  float DX;			/* grid spacing (m) */
+  int NStations;		/* number of met stations */
+  int Days;			/* length of the run (days) */
+  int Dt;			/* time step (hours) */
+  long Seed;			/* seed for the random number generator */
+  float Relief;			/* total relief (m) */
+  float ChannelArea;		/* contributing area for channel initiation (m2) */
+  char Mode[BUFSIZE + 1];	/* type of run: snow, basin, sediment or
+				   masswasting */
+  char Path[BUFSIZE + 1];	/* output directory */
+  int Dumps;			/* also write pixel, map and state output */
+  int LapseMap;			/* lapse the precipitation with a map */
+} GENOPTIONS;
+
+static unsigned long long RandomState;
+
+static double Uniform(void);
+static double Gaussian(void);
+static void Usage(char *Program);
+static void MakeDEM(GENOPTIONS *Gen, float *Dem);
+static void FillSinks(int NY, int NX, float *Dem);
+static void FlowDirections(int NY, int NX, float DX, float *Dem, int *Down);
+static int MakeStreams(GENOPTIONS *Gen, float *Dem, int *Down, int *SegId);
+static void WriteMap(char *Path, char *Name, void *Data, size_t Size,
+		     size_t N);
+static void WriteMet(GENOPTIONS *Gen, int Station, float Elev);
+static void WriteState(GENOPTIONS *Gen, int NSegments);
+static int StationCell(GENOPTIONS *Gen, int Station);
+static void DayToDate(int Day, int *Month, int *DayOfMonth);
+static void WriteConfig(GENOPTIONS *Gen, float *Dem);
+static void WriteSediment(GENOPTIONS *Gen);
+
+/*****************************************************************************
+  main()
+*****************************************************************************/
+int main(int argc, char **argv)
+{
+  GENOPTIONS Gen;
+  float *Dem;
+  float *Depth;
+  unsigned char *Mask;
+  unsigned char *SoilType;
+  unsigned char *VegType;
+  int *Down;
+  int *SegId;
+  int NSegments;
+  int i;
+  int s;
+
+  Gen.NX = 64;
+  Gen.NY = 64;
+  Gen.DX = 90.;
+  Gen.NStations = 2;
+  Gen.Days = 30;
+  Gen.Dt = 3;
+  Gen.Seed = 1;
+  Gen.Relief = 800.;
+  Gen.ChannelArea = 0.5e6;
+  strcpy(Gen.Mode, "basin");
+  strcpy(Gen.Path, "synthetic/");
+  Gen.Dumps = 0;
+  Gen.LapseMap = 0;
+
+  for (i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "-dumps") == 0) {
+      Gen.Dumps = 1;
+      continue;
+    }
+    if (strcmp(argv[i], "-lapsemap") == 0) {
+      Gen.LapseMap = 1;
+      continue;
+    }
+    if (i + 1 >= argc)
+      Usage(argv[0]);
+    if (strcmp(argv[i], "-nx") == 0)
+      Gen.NX = atoi(argv[++i]);
+    else if (strcmp(argv[i], "-ny") == 0)
+      Gen.NY = atoi(argv[++i]);
+    else if (strcmp(argv[i], "-dx") == 0)
+      Gen.DX = atof(argv[++i]);
+    else if (strcmp(argv[i], "-stations") == 0)
+      Gen.NStations = atoi(argv[++i]);
+    else if (strcmp(argv[i], "-days") == 0)
+      Gen.Days = atoi(argv[++i]);
+    else if (strcmp(argv[i], "-dt") == 0)
+      Gen.Dt = atoi(argv[++i]);
+    else if (strcmp(argv[i], "-seed") == 0)
+      Gen.Seed = atol(argv[++i]);
+    else if (strcmp(argv[i], "-relief") == 0)
+      Gen.Relief = atof(argv[++i]);
+    else if (strcmp(argv[i], "-channelarea") == 0)
+      Gen.ChannelArea = atof(argv[++i]);
+    else if (strcmp(argv[i], "-mode") == 0)
+      strncpy(Gen.Mode, argv[++i], BUFSIZE);
+    else if (strcmp(argv[i], "-o") == 0) {
+      strncpy(Gen.Path, argv[++i], BUFSIZE - 1);
+      if (Gen.Path[strlen(Gen.Path) - 1] != '/')
+	strcat(Gen.Path, "/");
+    }
+    else
+      Usage(argv[0]);
+  }
+  if (Gen.NX < 4 || Gen.NY < 4 || Gen.DX <= 0 || Gen.NStations < 1 ||
+      (Gen.LapseMap && Gen.NStations != 1) ||
+      Gen.Days < 1 || Gen.Dt < 1 || 24 % Gen.Dt != 0 ||
+      (strcmp(Gen.Mode, "snow") && strcmp(Gen.Mode, "basin") &&
+       strcmp(Gen.Mode, "sediment") && strcmp(Gen.Mode, "masswasting")))
+    Usage(argv[0]);
+
+  RandomState = 0x9E3779B97F4A7C15ULL ^ (unsigned long long) Gen.Seed;
+
+  mkdir(Gen.Path, 0755);
+  {
+    char Dir[2 * BUFSIZE + 1];
+    sprintf(Dir, "%soutput", Gen.Path);
+    mkdir(Dir, 0755);
+    sprintf(Dir, "%sstate", Gen.Path);
+    mkdir(Dir, 0755);
+  }
+
+  Dem = (float *) calloc(Gen.NX * Gen.NY, sizeof(float));
+  Depth = (float *) calloc(Gen.NX * Gen.NY, sizeof(float));
+  Mask = (unsigned char *) calloc(Gen.NX * Gen.NY, 1);
+  SoilType = (unsigned char *) calloc(Gen.NX * Gen.NY, 1);
+  VegType = (unsigned char *) calloc(Gen.NX * Gen.NY, 1);
+  Down = (int *) calloc(Gen.NX * Gen.NY, sizeof(int));
+  SegId = (int *) calloc(Gen.NX * Gen.NY, sizeof(int));
+  if (!Dem || !Depth || !Mask || !SoilType || !VegType || !Down || !SegId) {
+    fprintf(stderr, "Cannot allocate memory\n");
+    exit(EXIT_FAILURE);
+  }
+
+  MakeDEM(&Gen, Dem);
+  FillSinks(Gen.NY, Gen.NX, Dem);
+  FlowDirections(Gen.NY, Gen.NX, Gen.DX, Dem, Down);
+  NSegments = MakeStreams(&Gen, Dem, Down, SegId);
+
+  /* soils are deeper and finer in the valleys, vegetation changes from
+     forest to open with elevation */
+  for (i = 0; i < Gen.NX * Gen.NY; i++) {
+    float Rel = Dem[i] / Gen.Relief;
+    Mask[i] = 1;
+    SoilType[i] = (Rel < 0.4 + 0.1 * Uniform()) ? 1 : 2;
+    VegType[i] = (Rel < 0.6 + 0.1 * Uniform()) ? 1 : 2;
+    Depth[i] = 3.0 - 1.5 * Rel + 0.2 * Uniform();
+  }
+
+  WriteMap(Gen.Path, "dem.bin", Dem, sizeof(float), Gen.NX * Gen.NY);
+  WriteMap(Gen.Path, "mask.bin", Mask, 1, Gen.NX * Gen.NY);
+  WriteMap(Gen.Path, "soil.bin", SoilType, 1, Gen.NX * Gen.NY);
+  WriteMap(Gen.Path, "veg.bin", VegType, 1, Gen.NX * Gen.NY);
+  WriteMap(Gen.Path, "soildepth.bin", Depth, sizeof(float), Gen.NX * Gen.NY);
+
+  for (s = 0; s < Gen.NStations; s++)
+    WriteMet(&Gen, s, Dem[StationCell(&Gen, s)]);
+
+  /* the lapse map holds the change of the station precipitation at each
+     cell, 0.05 percent per meter above or below the station */
+  if (Gen.LapseMap) {
+    for (i = 0; i < Gen.NX * Gen.NY; i++)
+      Depth[i] = 0.0005 * (Dem[i] - Dem[StationCell(&Gen, 0)]);
+    WriteMap(Gen.Path, "preciplapse.bin", Depth, sizeof(float),
+	     Gen.NX * Gen.NY);
+  }
+  WriteState(&Gen, NSegments);
+  WriteConfig(&Gen, Dem);
+  if (strcmp(Gen.Mode, "sediment") == 0 || strcmp(Gen.Mode, "masswasting") == 0)
+    WriteSediment(&Gen);
+
+  printf("Synthetic basin: %d x %d cells, %d stream segments, written to %s\n",
+	 Gen.NY, Gen.NX, NSegments, Gen.Path);
+
+  free(Dem);
+  free(Depth);
+  free(Mask);
+  free(SoilType);
+  free(VegType);
+  free(Down);
+  free(SegId);
+  return EXIT_SUCCESS;
+}
+
+/*****************************************************************************
+  Uniform() / Gaussian() - xorshift random numbers, so that the same seed
+  gives the same basin on every platform
+*****************************************************************************/
+static double Uniform(void)
+{
+  RandomState ^= RandomState >> 12;
+  RandomState ^= RandomState << 25;
+  RandomState ^= RandomState >> 27;
+  return ((RandomState * 2685821657736338717ULL) >> 11) *
+    (1.0 / 9007199254740992.0);
+}
+
+static double Gaussian(void)
+{
+  double U1 = Uniform() + 1e-12;
+  double U2 = Uniform();
+  return sqrt(-2. * log(U1)) * cos(2. * M_PI * U2);
+}
+
+/*****************************************************************************
+  Usage()
+*****************************************************************************/
+static void Usage(char *Program)
+{
+  fprintf(stderr, "Usage: %s [-nx cols] [-ny rows] [-dx spacing] "
+	  "[-stations n]\n\t[-days n] [-dt hours] [-seed n] [-relief m] "
+	  "[-channelarea m2]\n\t[-mode snow|basin|sediment|masswasting] "
+	  "[-o outdir] [-dumps]\n\t[-lapsemap]\n", Program);
+  exit(EXIT_FAILURE);
+}
+
+/*****************************************************************************
+  MakeDEM()
+
+  Diamond-square fractal surface on the smallest 2^n+1 square that covers
+  the grid, superimposed on a valley that drains to the south edge
+*****************************************************************************/
+static void MakeDEM(GENOPTIONS *Gen, float *Dem)
+{
+  int N;
+  int Step;
+  int Half;
+  int x;
+  int y;
+  double Scale;
+  double *Grid;
+  double Min;
+  double Max;
+
+  for (N = 2; N + 1 < Gen->NX || N + 1 < Gen->NY; N *= 2)
+    ;
+  Grid = (double *) calloc((N + 1) * (N + 1), sizeof(double));
+
+#define G(y, x) Grid[(y) * (N + 1) + (x)]
+  Scale = 1.0;
+  for (Step = N; Step > 1; Step /= 2) {
+    Half = Step / 2;
+    for (y = Half; y < N; y += Step)
+      for (x = Half; x < N; x += Step)
+	G(y, x) = (G(y - Half, x - Half) + G(y - Half, x + Half) +
+		   G(y + Half, x - Half) + G(y + Half, x + Half)) / 4. +
+	  Scale * Gaussian();
+    for (y = 0; y <= N; y += Half) {
+      for (x = (y / Half) % 2 ? 0 : Half; x <= N; x += Step) {
+	double Sum = 0.;
+	int Count = 0;
+	if (y >= Half) { Sum += G(y - Half, x); Count++; }
+	if (y + Half <= N) { Sum += G(y + Half, x); Count++; }
+	if (x >= Half) { Sum += G(y, x - Half); Count++; }
+	if (x + Half <= N) { Sum += G(y, x + Half); Count++; }
+	G(y, x) = Sum / Count + Scale * Gaussian();
+      }
+    }
+    Scale *= 0.55;
+  }
+
+  Min = 1e30;
+  Max = -1e30;
+  for (y = 0; y < Gen->NY; y++) {
+    for (x = 0; x < Gen->NX; x++) {
+      double Valley = fabs((double) x / (Gen->NX - 1) - 0.5) * 2.;
+      double Slope = 1.0 - (double) y / (Gen->NY - 1);
+      double Z = 0.5 * G(y, x) + 1.5 * Valley + 2.0 * Slope;
+      Dem[y * Gen->NX + x] = (float) Z;
+      if (Z < Min)
+	Min = Z;
+      if (Z > Max)
+	Max = Z;
+    }
+  }
+#undef G
+  for (x = 0; x < Gen->NX * Gen->NY; x++)
+    Dem[x] = (float) ((Dem[x] - Min) / (Max - Min) * Gen->Relief) + 100.;
+
+  free(Grid);
+}
+
+/*****************************************************************************
+  FillSinks()
+
+  Priority-flood sink filling.  All edge cells are outlets.  Filled cells
+  get a small increment so that every cell has a downhill path.
+*****************************************************************************/
+typedef struct {
+  float Z;
+  int Cell;
+} HEAPITEM;
+
+static void HeapPush(HEAPITEM *Heap, int *N, float Z, int Cell)
+{
+  int i = (*N)++;
+  while (i > 0 && Heap[(i - 1) / 2].Z > Z) {
+    Heap[i] = Heap[(i - 1) / 2];
+    i = (i - 1) / 2;
+  }
+  Heap[i].Z = Z;
+  Heap[i].Cell = Cell;
+}
+
+static HEAPITEM HeapPop(HEAPITEM *Heap, int *N)
+{
+  HEAPITEM Top = Heap[0];
+  HEAPITEM Last = Heap[--(*N)];
+  int i = 0;
+  int c;
+  while ((c = 2 * i + 1) < *N) {
+    if (c + 1 < *N && Heap[c + 1].Z < Heap[c].Z)
+      c++;
+    if (Heap[c].Z >= Last.Z)
+      break;
+    Heap[i] = Heap[c];
+    i = c;
+  }
+  Heap[i] = Last;
+  return Top;
+}
+
+static void FillSinks(int NY, int NX, float *Dem)
+{
+  HEAPITEM *Heap;
+  unsigned char *Done;
+  int N = 0;
+  int x;
+  int y;
+  int dx;
+  int dy;
+
+  Heap = (HEAPITEM *) calloc(NX * NY, sizeof(HEAPITEM));
+  Done = (unsigned char *) calloc(NX * NY, 1);
+
+  for (y = 0; y < NY; y++)
+    for (x = 0; x < NX; x++)
+      if (y == 0 || x == 0 || y == NY - 1 || x == NX - 1) {
+	HeapPush(Heap, &N, Dem[y * NX + x], y * NX + x);
+	Done[y * NX + x] = 1;
+      }
+
+  while (N > 0) {
+    HEAPITEM Item = HeapPop(Heap, &N);
+    y = Item.Cell / NX;
+    x = Item.Cell % NX;
+    for (dy = -1; dy <= 1; dy++)
+      for (dx = -1; dx <= 1; dx++) {
+	int yy = y + dy;
+	int xx = x + dx;
+	if (yy < 0 || xx < 0 || yy >= NY || xx >= NX || Done[yy * NX + xx])
+	  continue;
+	Done[yy * NX + xx] = 1;
+	if (Dem[yy * NX + xx] <= Item.Z)
+	  Dem[yy * NX + xx] = Item.Z + 0.01;
+	HeapPush(Heap, &N, Dem[yy * NX + xx], yy * NX + xx);
+      }
+  }
+  free(Heap);
+  free(Done);
+}
+
+/*****************************************************************************
+  FlowDirections() - D8 steepest descent, -1 for cells that drain off the
+  grid
+*****************************************************************************/
+static void FlowDirections(int NY, int NX, float DX, float *Dem, int *Down)
+{
+  int x;
+  int y;
+  int dx;
+  int dy;
+
+  for (y = 0; y < NY; y++)
+    for (x = 0; x < NX; x++) {
+      float Best = 0.;
+      int i = y * NX + x;
+      Down[i] = -1;
+      for (dy = -1; dy <= 1; dy++)
+	for (dx = -1; dx <= 1; dx++) {
+	  int yy = y + dy;
+	  int xx = x + dx;
+	  float Slope;
+	  if ((dx == 0 && dy == 0) || yy < 0 || xx < 0 || yy >= NY || xx >= NX)
+	    continue;
+	  Slope = (Dem[i] - Dem[yy * NX + xx]) /
+	    (DX * ((dx && dy) ? 1.41421356f : 1.f));
+	  if (Slope > Best) {
+	    Best = Slope;
+	    Down[i] = yy * NX + xx;
+	  }
+	}
+      if (Down[i] < 0 && y != 0 && x != 0 && y != NY - 1 && x != NX - 1) {
+	fprintf(stderr, "Sink remaining at row %d column %d\n", y, x);
+	exit(EXIT_FAILURE);
+      }
+    }
+}
+
+/*****************************************************************************
+  MakeStreams()
+
+  Cells with a contributing area above the threshold are channel cells.  A
+  segment runs from a channel head or junction to the next junction.  The
+  network, map and class files are written in the format read by
+  channel_read_network(), channel_grid_read_map() and
+  channel_read_classes().
+*****************************************************************************/
+static int MakeStreams(GENOPTIONS *Gen, float *Dem, int *Down, int *SegId)
+{
+  int NCells = Gen->NX * Gen->NY;
+  int *Order;			/* cells sorted from high to low */
+  float *Area;			/* contributing area */
+  int *NUp;			/* number of upstream channel cells */
+  int *SegOrder;		/* routing order of each segment */
+  int *SegDown;			/* downstream segment */
+  float *SegLength;
+  float *SegDrop;
+  float *SegArea;
+  int NSegments = 0;
+  int i;
+  int k;
+  char FileName[2 * BUFSIZE + 1];
+  FILE *Map;
+  FILE *Net;
+  FILE *Class;
+
+  Order = (int *) calloc(NCells, sizeof(int));
+  Area = (float *) calloc(NCells, sizeof(float));
+  NUp = (int *) calloc(NCells, sizeof(int));
+
+  /* heap sort on elevation, from high to low */
+  {
+    HEAPITEM *Heap = (HEAPITEM *) calloc(NCells, sizeof(HEAPITEM));
+    int N = 0;
+    for (i = 0; i < NCells; i++)
+      HeapPush(Heap, &N, -Dem[i], i);
+    for (i = 0; i < NCells; i++)
+      Order[i] = HeapPop(Heap, &N).Cell;
+    free(Heap);
+  }
+
+  for (i = 0; i < NCells; i++)
+    Area[i] = Gen->DX * Gen->DX;
+  for (k = 0; k < NCells; k++) {
+    i = Order[k];
+    if (Down[i] >= 0)
+      Area[Down[i]] += Area[i];
+  }
+
+  for (i = 0; i < NCells; i++) {
+    SegId[i] = 0;
+    if (Area[i] >= Gen->ChannelArea && Down[i] >= 0)
+      NUp[Down[i]]++;
+  }
+
+  /* assign segment ids from high to low: a new segment starts at a channel
+     head, below a junction, or where the segment gets too long */
+  SegOrder = (int *) calloc(NCells + 1, sizeof(int));
+  SegDown = (int *) calloc(NCells + 1, sizeof(int));
+  SegLength = (float *) calloc(NCells + 1, sizeof(float));
+  SegDrop = (float *) calloc(NCells + 1, sizeof(float));
+  SegArea = (float *) calloc(NCells + 1, sizeof(float));
+  for (k = 0; k < NCells; k++) {
+    int Up;
+    i = Order[k];
+    if (Area[i] < Gen->ChannelArea)
+      continue;
+    /* find the upstream channel cell if there is exactly one */
+    Up = -1;
+    if (NUp[i] == 1) {
+      int x = i % Gen->NX;
+      int y = i / Gen->NX;
+      int dx;
+      int dy;
+      for (dy = -1; dy <= 1; dy++)
+	for (dx = -1; dx <= 1; dx++) {
+	  int yy = y + dy;
+	  int xx = x + dx;
+	  if (yy < 0 || xx < 0 || yy >= Gen->NY || xx >= Gen->NX)
+	    continue;
+	  if (Down[yy * Gen->NX + xx] == i &&
+	      Area[yy * Gen->NX + xx] >= Gen->ChannelArea)
+	    Up = yy * Gen->NX + xx;
+	}
+    }
+    if (Up >= 0 && SegLength[SegId[Up]] < 10 * Gen->DX)
+      SegId[i] = SegId[Up];
+    else
+      SegId[i] = ++NSegments;
+    SegLength[SegId[i]] +=
+      (Down[i] >= 0 && Down[i] % Gen->NX != i % Gen->NX &&
+       Down[i] / Gen->NX != i / Gen->NX) ? 1.41421356f * Gen->DX : Gen->DX;
+    SegArea[SegId[i]] = Area[i];
+  }
+
+  /* downstream segment, drop and routing order */
+  for (k = 0; k < NCells; k++) {
+    int s;
+    i = Order[k];
+    s = SegId[i];
+    if (s == 0)
+      continue;
+    if (Down[i] >= 0) {
+      SegDrop[s] += Dem[i] - Dem[Down[i]];
+      if (SegId[Down[i]] != s)
+	SegDown[s] = SegId[Down[i]];
+    }
+    else
+      SegDrop[s] += 0.01 * Gen->DX;
+  }
+  for (i = 1; i <= NSegments; i++)
+    if (SegOrder[i] == 0)
+      SegOrder[i] = 1;
+  /* segments are numbered from high to low, so one pass in id order
+     propagates the order downstream */
+  for (i = 1; i <= NSegments; i++)
+    if (SegDown[i] > 0 && SegOrder[SegDown[i]] < SegOrder[i] + 1)
+      SegOrder[SegDown[i]] = SegOrder[i] + 1;
+
+  sprintf(FileName, "%sstream.class", Gen->Path);
+  Class = fopen(FileName, "w");
+  fprintf(Class, "# ID Width Bank Friction\n");
+  fprintf(Class, "1 2.0 0.5 0.05\n");
+  fprintf(Class, "2 5.0 1.0 0.04\n");
+  fprintf(Class, "3 10.0 1.5 0.035\n");
+  fclose(Class);
+
+  sprintf(FileName, "%sstream.network", Gen->Path);
+  Net = fopen(FileName, "w");
+  fprintf(Net, "# ID Order Slope Length Class Outlet\n");
+  for (i = 1; i <= NSegments; i++) {
+    int Cls = SegArea[i] < 4 * Gen->ChannelArea ? 1 :
+      (SegArea[i] < 20 * Gen->ChannelArea ? 2 : 3);
+    float Slope = SegDrop[i] / SegLength[i];
+    if (Slope < 0.0005)
+      Slope = 0.0005;
+    if (SegDown[i] == 0)
+      fprintf(Net, "%d %d %.5f %.2f %d 0 SAVE \"outlet_%d\"\n", i,
+	      SegOrder[i], Slope, SegLength[i], Cls, i);
+    else
+      fprintf(Net, "%d %d %.5f %.2f %d %d\n", i, SegOrder[i], Slope,
+	      SegLength[i], Cls, SegDown[i]);
+  }
+  fclose(Net);
+
+  sprintf(FileName, "%sstream.map", Gen->Path);
+  Map = fopen(FileName, "w");
+  fprintf(Map, "# Column Row Segment Length CutHeight CutWidth\n");
+  for (i = 0; i < NCells; i++) {
+    int s = SegId[i];
+    if (s == 0)
+      continue;
+    fprintf(Map, "%d %d %d %.2f %.2f %.2f\n", i % Gen->NX, i / Gen->NX, s,
+	    Gen->DX, 0.5, SegArea[s] < 4 * Gen->ChannelArea ? 2.0 : 5.0);
+  }
+  fclose(Map);
+
+  free(Order);
+  free(Area);
+  free(NUp);
+  free(SegOrder);
+  free(SegDown);
+  free(SegLength);
+  free(SegDrop);
+  free(SegArea);
+  return NSegments;
+}
+
+/*****************************************************************************
+  WriteMap()
+*****************************************************************************/
+static void WriteMap(char *Path, char *Name, void *Data, size_t Size,
+		     size_t N)
+{
+  char FileName[2 * BUFSIZE + 1];
+  FILE *Out;
+
+  sprintf(FileName, "%s%s", Path, Name);
+  if (!(Out = fopen(FileName, "wb")) || fwrite(Data, Size, N, Out) != N) {
+    fprintf(stderr, "Cannot write %s\n", FileName);
+    exit(EXIT_FAILURE);
+  }
+  fclose(Out);
+}
+
+/*****************************************************************************
+  WriteMet()
+
+  Hourly-resolution synthetic forcing with seasonal and diurnal cycles and
+  random storms, aggregated to the model time step.  The columns are those
+  read by ReadMetRecord(): Tair Wind Rh Sin Lin Precip
+*****************************************************************************/
+static void WriteMet(GENOPTIONS *Gen, int Station, float Elev)
+{
+  char FileName[2 * BUFSIZE + 1];
+  FILE *Out;
+  int Step;
+  int NSteps = Gen->Days * 24 / Gen->Dt;
+  int Storm = 0;
+  int DaysPerMonth[] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+  int Month = 1;
+  int Day = 1;
+  int Year = 2000;
+  int Hour = 0;
+
+  sprintf(FileName, "%smet_station_%d.txt", Gen->Path, Station + 1);
+  if (!(Out = fopen(FileName, "w"))) {
+    fprintf(stderr, "Cannot write %s\n", FileName);
+    exit(EXIT_FAILURE);
+  }
+  for (Step = 0; Step < NSteps; Step++) {
+    double DOY = (Step * Gen->Dt) / 24.;
+    double HourAngle = 2. * M_PI * (Hour + 0.5 * Gen->Dt - 12.) / 24.;
+    double Tair = -2. + 8. * sin(2. * M_PI * (DOY - 30.) / 365.) +
+      5. * cos(HourAngle) - 0.0065 * (Elev - 100.) + Gaussian();
+    double Sin = 700. * cos(HourAngle);
+    double Precip = 0.;
+    double Rh;
+
+    if (Storm > 0) {
+      Precip = 0.001 * Gen->Dt * (0.5 + Uniform());
+      Storm--;
+    }
+    else if (Uniform() < 0.02 * Gen->Dt)
+      Storm = (int) (6 + 24 * Uniform()) / Gen->Dt + 1;
+    Rh = Precip > 0 ? 95. : 50. + 30. * Uniform();
+    if (Sin < 0.)
+      Sin = 0.;
+    if (Precip > 0.)
+      Sin *= 0.3;
+
+    fprintf(Out, "%02d/%02d/%04d-%02d %.2f %.2f %.1f %.1f %.1f %.5f\n", Month,
+	    Day, Year, Hour, Tair, 1. + 4. * Uniform(), Rh, Sin,
+	    250. + 3. * Tair + (Precip > 0 ? 40. : 0.), Precip);
+
+    Hour += Gen->Dt;
+    if (Hour >= 24) {
+      Hour = 0;
+      if (++Day > DaysPerMonth[Month - 1]) {
+	Day = 1;
+	if (++Month > 12) {
+	  Month = 1;
+	  Year++;
+	}
+      }
+    }
+  }
+  fclose(Out);
+}
+
+/*****************************************************************************
+  WriteState()
+
+  Initial state: dry canopy, no snow, wet soil so that the channels carry
+  base flow from the first step, and empty channels.  All state maps are
+  4-byte floats, soil moisture comes first in the soil state file.
+*****************************************************************************/
+static void WriteState(GENOPTIONS *Gen, int NSegments)
+{
+  char *Names[] = { "Interception", "Snow", "Soil" };
+  char FileName[2 * BUFSIZE + 1];
+  FILE *Out;
+  float *Zero;
+  float *Moist;
+  int i;
+  int k;
+
+  Zero = (float *) calloc(Gen->NX * Gen->NY, sizeof(float));
+  Moist = (float *) calloc(Gen->NX * Gen->NY, sizeof(float));
+  for (i = 0; i < Gen->NX * Gen->NY; i++)
+    Moist[i] = 0.40;
+  for (k = 0; k < 3; k++) {
+    sprintf(FileName, "%sstate/%s.State.01.01.2000.00.00.00.bin", Gen->Path,
+	    Names[k]);
+    Out = fopen(FileName, "wb");
+    for (i = 0; i < NSTATEMAPS; i++)
+      fwrite((k == 2 && i <= NSOILLAYERS) ? Moist : Zero, sizeof(float),
+	     Gen->NX * Gen->NY, Out);
+    fclose(Out);
+  }
+  free(Zero);
+  free(Moist);
+
+  sprintf(FileName, "%sstate/Channel.State.01.01.2000.00.00.00", Gen->Path);
+  Out = fopen(FileName, "w");
+  for (i = 1; i <= NSegments; i++)
+    fprintf(Out, "%d 0.0\n", i);
+  fclose(Out);
+}
+
+/*****************************************************************************
+  StationCell() - stations are spread along the valley, alternating between
+  the two valley sides
+*****************************************************************************/
+static int StationCell(GENOPTIONS *Gen, int Station)
+{
+  int y = (int) (Gen->NY * (Station + 0.5) / Gen->NStations);
+  int x = (int) (Gen->NX * (0.25 + 0.5 * (Station % 2)));
+
+  return y * Gen->NX + x;
+}
+
+/*****************************************************************************
+  DayToDate() - month and day of month of day Day of 2000 (1 is Jan 1)
+*****************************************************************************/
+static void DayToDate(int Day, int *Month, int *DayOfMonth)
+{
+  int DaysPerMonth[] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+
+  for (*Month = 1; Day > DaysPerMonth[(*Month - 1) % 12]; (*Month)++)
+    Day -= DaysPerMonth[(*Month - 1) % 12];
+  *DayOfMonth = Day;
+}
+
+/*****************************************************************************
+  WriteConfig()
+*****************************************************************************/
+static void WriteConfig(GENOPTIONS *Gen, float *Dem)
+{
+  char FileName[2 * BUFSIZE + 1];
+  FILE *Out;
+  int s;
+  int EndDay;
+  int EndMonth;
+  int Month;
+  int Day;
+  int d;
+  int Sediment = strcmp(Gen->Mode, "sediment") == 0 ||
+    strcmp(Gen->Mode, "masswasting") == 0;
+  double North = 5000000.;
+  double West = 500000.;
+
+  /* last model step is the last step in the met files */
+  DayToDate(Gen->Days, &EndMonth, &EndDay);
+
+  sprintf(FileName, "%sconfig.txt", Gen->Path);
+  if (!(Out = fopen(FileName, "w"))) {
+    fprintf(stderr, "Cannot write %s\n", FileName);
+    exit(EXIT_FAILURE);
+  }
+
+  fprintf(Out, "# Synthetic basin %d x %d, mode %s, seed %ld\n\n", Gen->NY,
+	  Gen->NX, Gen->Mode, Gen->Seed);
+  fprintf(Out, "[OPTIONS]\n");
+  fprintf(Out, "Format = BIN\n");
+  fprintf(Out, "Extent = BASIN\n");
+  fprintf(Out, "Gradient = TOPOGRAPHY\n");
+  fprintf(Out, "Flow Routing = NETWORK\n");
+  fprintf(Out, "Sensible Heat Flux = FALSE\n");
+  fprintf(Out, "Sediment = %s\n", Sediment ? "TRUE" : "FALSE");
+  fprintf(Out, "Sediment Input File = %ssediment.txt\n", Gen->Path);
+  fprintf(Out, "Overland Routing = %s\n",
+	  strcmp(Gen->Mode, "snow") ? "KINEMATIC" : "CONVENTIONAL");
+  fprintf(Out, "Infiltration = STATIC\n");
+  fprintf(Out, "Interpolation = INVDIST\n");
+  fprintf(Out, "MM5 = FALSE\n");
+  fprintf(Out, "QPF = FALSE\n");
+  fprintf(Out, "PRISM = FALSE\n");
+  fprintf(Out, "Canopy radiation attenuation mode = FIXED\n");
+  fprintf(Out, "Shading = FALSE\n");
+  fprintf(Out, "Snotel = FALSE\n");
+  fprintf(Out, "Outside = FALSE\n");
+  fprintf(Out, "Rhoverride = FALSE\n");
+  fprintf(Out, "Precipitation Source = STATION\n");
+  fprintf(Out, "Wind Source = STATION\n");
+  fprintf(Out, "Temperature lapse rate = CONSTANT\n");
+  fprintf(Out, "Precipitation lapse rate = %s\n",
+	  Gen->LapseMap ? "MAP" : "CONSTANT");
+  if (strcmp(Gen->Mode, "snow") == 0)
+    fprintf(Out, "Model Components = SNOW\n");
+  fprintf(Out, "\n[AREA]\n");
+  fprintf(Out, "Coordinate System = UTM\n");
+  fprintf(Out, "Extreme North = %.1f\n", North);
+  fprintf(Out, "Extreme West = %.1f\n", West);
+  fprintf(Out, "Center Latitude = 47.0\n");
+  fprintf(Out, "Center Longitude = -121.0\n");
+  fprintf(Out, "Time Zone Meridian = -120.0\n");
+  fprintf(Out, "Number of Rows = %d\n", Gen->NY);
+  fprintf(Out, "Number of Columns = %d\n", Gen->NX);
+  fprintf(Out, "Grid spacing = %.1f\n", Gen->DX);
+  fprintf(Out, "Point North = %.1f\n", North - (Gen->NY / 2 + 0.5) * Gen->DX);
+  fprintf(Out, "Point East = %.1f\n", West + (Gen->NX / 2 + 0.5) * Gen->DX);
+  fprintf(Out, "\n[TIME]\n");
+  fprintf(Out, "Time Step = %d\n", Gen->Dt);
+  fprintf(Out, "Model Start = 01/01/2000-00\n");
+  fprintf(Out, "Model End = %02d/%02d/2000-%02d\n", EndMonth, EndDay,
+	  24 - Gen->Dt);
+  fprintf(Out, "\n[CONSTANTS]\n");
+  fprintf(Out, "Ground Roughness = 0.02\n");
+  fprintf(Out, "Snow Roughness = 0.01\n");
+  fprintf(Out, "Rain Threshold = -1.1\n");
+  fprintf(Out, "Snow Threshold = 0.5\n");
+  fprintf(Out, "Snow Water Capacity = 0.03\n");
+  fprintf(Out, "Reference Height = 40.0\n");
+  fprintf(Out, "Rain LAI Multiplier = 0.0001\n");
+  fprintf(Out, "Snow LAI Multiplier = 0.0005\n");
+  fprintf(Out, "Min Intercepted Snow = 0.005\n");
+  fprintf(Out, "Outside Basin Value = 0\n");
+  fprintf(Out, "Temperature Lapse Rate = -0.0065\n");
+  fprintf(Out, "Precipitation Lapse Rate = 0.0\n");
+
+  fprintf(Out, "\n[TERRAIN]\n");
+  fprintf(Out, "DEM File = %sdem.bin\n", Gen->Path);
+  fprintf(Out, "Basin Mask File = %smask.bin\n", Gen->Path);
+
+  fprintf(Out, "\n[ROUTING]\n");
+  fprintf(Out, "Stream Network File = %sstream.network\n", Gen->Path);
+  fprintf(Out, "Stream Map File = %sstream.map\n", Gen->Path);
+  fprintf(Out, "Stream Class File = %sstream.class\n", Gen->Path);
+
+  fprintf(Out, "\n[METEOROLOGY]\n");
+  fprintf(Out, "Number of Stations = %d\n", Gen->NStations);
+  for (s = 0; s < Gen->NStations; s++) {
+    int y = StationCell(Gen, s) / Gen->NX;
+    int x = StationCell(Gen, s) % Gen->NX;
+    fprintf(Out, "Station Name %d = Station%d\n", s + 1, s + 1);
+    fprintf(Out, "North Coordinate %d = %.1f\n", s + 1,
+	    North - (y + 0.5) * Gen->DX);
+    fprintf(Out, "East Coordinate %d = %.1f\n", s + 1,
+	    West + (x + 0.5) * Gen->DX);
+    fprintf(Out, "Elevation %d = %.1f\n", s + 1, Dem[y * Gen->NX + x]);
+    fprintf(Out, "Station File %d = %smet_station_%d.txt\n", s + 1,
+	    Gen->Path, s + 1);
+  }
+  if (Gen->LapseMap)
+    fprintf(Out, "Precipitation Lapse Rate Map = %spreciplapse.bin\n",
+	    Gen->Path);
+
+  fprintf(Out, "\n[SOILS]\n");
+  fprintf(Out, "Soil Map File = %ssoil.bin\n", Gen->Path);
+  fprintf(Out, "Soil Depth File = %ssoildepth.bin\n", Gen->Path);
+  fprintf(Out, "Number of Soil Types = 2\n");
+  for (s = 1; s <= 2; s++) {
+    fprintf(Out, "Soil Description %d = %s\n", s, s == 1 ? "Loam" : "Sandy loam");
+    fprintf(Out, "Lateral Conductivity %d = %s\n", s, s == 1 ? "0.002" : "0.01");
+    fprintf(Out, "Exponential Decrease %d = 3.0\n", s);
+    fprintf(Out, "Depth Threshold %d = 2.0\n", s);
+    fprintf(Out, "Maximum Infiltration %d = 3.0e-5\n", s);
+    fprintf(Out, "Capillary Drive %d = 0.1\n", s);
+    fprintf(Out, "Surface Albedo %d = 0.1\n", s);
+    fprintf(Out, "Mannings n %d = 0.1\n", s);
+    fprintf(Out, "Number of Soil Layers %d = %d\n", s, NSOILLAYERS);
+    fprintf(Out, "Porosity %d = 0.43 0.43 0.43\n", s);
+    fprintf(Out, "Pore Size Distribution %d = 0.25 0.25 0.25\n", s);
+    fprintf(Out, "Bubbling Pressure %d = 0.11 0.11 0.11\n", s);
+    fprintf(Out, "Field Capacity %d = 0.25 0.25 0.25\n", s);
+    fprintf(Out, "Wilting Point %d = 0.10 0.10 0.10\n", s);
+    fprintf(Out, "Bulk Density %d = 1485. 1485. 1485.\n", s);
+    fprintf(Out, "Vertical Conductivity %d = 0.001 0.001 0.001\n", s);
+    fprintf(Out, "Thermal Conductivity %d = 7.114 6.923 7.0\n", s);
+    fprintf(Out, "Thermal Capacity %d = 1.4e6 1.4e6 1.4e6\n", s);
+  }
+
+  fprintf(Out, "\n[VEGETATION]\n");
+  fprintf(Out, "Vegetation Map File = %sveg.bin\n", Gen->Path);
+  fprintf(Out, "Number of Vegetation Types = 2\n");
+  fprintf(Out, "Vegetation Description 1 = Evergreen forest\n");
+  fprintf(Out, "Overstory Present 1 = TRUE\n");
+  fprintf(Out, "Understory Present 1 = TRUE\n");
+  fprintf(Out, "Fractional Coverage 1 = 0.8\n");
+  fprintf(Out, "Trunk Space 1 = 0.4\n");
+  fprintf(Out, "Aerodynamic Attenuation 1 = 2.5\n");
+  fprintf(Out, "Radiation Attenuation 1 = 0.2\n");
+  fprintf(Out, "Max Snow Int Capacity 1 = 0.03\n");
+  fprintf(Out, "Mass Release Drip Ratio 1 = 0.4\n");
+  fprintf(Out, "Snow Interception Eff 1 = 0.6\n");
+  fprintf(Out, "Impervious Fraction 1 = 0.0\n");
+  fprintf(Out, "Detention Fraction 1 = 0.0\n");
+  fprintf(Out, "Detention Decay 1 = 0.0\n");
+  fprintf(Out, "Height 1 = 30.0 0.5\n");
+  fprintf(Out, "Maximum Resistance 1 = 5000. 3000.\n");
+  fprintf(Out, "Minimum Resistance 1 = 666.6 200.0\n");
+  fprintf(Out, "Moisture Threshold 1 = 0.33 0.13\n");
+  fprintf(Out, "Vapor Pressure Deficit 1 = 4000 4000\n");
+  fprintf(Out, "Rpc 1 = 0.108 0.108\n");
+  fprintf(Out, "Number of Root Zones 1 = 3\n");
+  fprintf(Out, "Root Zone Depths 1 = 0.10 0.25 0.40\n");
+  fprintf(Out, "Overstory Root Fraction 1 = 0.20 0.40 0.40\n");
+  fprintf(Out, "Understory Root Fraction 1 = 0.40 0.60 0.00\n");
+  fprintf(Out, "Overstory Monthly LAI 1 = 4 4 4 4 4 4 4 4 4 4 4 4\n");
+  fprintf(Out, "Understory Monthly LAI 1 = 1 1 1 1 1 1 1 1 1 1 1 1\n");
+  fprintf(Out, "Overstory Monthly Alb 1 = .2 .2 .2 .2 .2 .2 .2 .2 .2 .2 .2 .2\n");
+  fprintf(Out, "Understory Monthly Alb 1 = .2 .2 .2 .2 .2 .2 .2 .2 .2 .2 .2 .2\n");
+  fprintf(Out, "Vegetation Description 2 = Shrub\n");
+  fprintf(Out, "Overstory Present 2 = FALSE\n");
+  fprintf(Out, "Understory Present 2 = TRUE\n");
+  fprintf(Out, "Impervious Fraction 2 = 0.0\n");
+  fprintf(Out, "Detention Fraction 2 = 0.0\n");
+  fprintf(Out, "Detention Decay 2 = 0.0\n");
+  fprintf(Out, "Height 2 = 0.5\n");
+  fprintf(Out, "Maximum Resistance 2 = 600.\n");
+  fprintf(Out, "Minimum Resistance 2 = 120.\n");
+  fprintf(Out, "Moisture Threshold 2 = 0.33\n");
+  fprintf(Out, "Vapor Pressure Deficit 2 = 4000\n");
+  fprintf(Out, "Rpc 2 = 0.108\n");
+  fprintf(Out, "Number of Root Zones 2 = 3\n");
+  fprintf(Out, "Root Zone Depths 2 = 0.10 0.25 0.40\n");
+  fprintf(Out, "Understory Root Fraction 2 = 0.40 0.60 0.00\n");
+  fprintf(Out, "Understory Monthly LAI 2 = 2 2 2 2 2 2 2 2 2 2 2 2\n");
+  fprintf(Out, "Understory Monthly Alb 2 = .2 .2 .2 .2 .2 .2 .2 .2 .2 .2 .2 .2\n");
+
+  fprintf(Out, "\n[OUTPUT]\n");
+  fprintf(Out, "Output Directory = %soutput/\n", Gen->Path);
+  fprintf(Out, "Initial State Directory = %sstate/\n", Gen->Path);
+  if (!Gen->Dumps) {
+    fprintf(Out, "Number of Output Pixels = 0\n");
+    fprintf(Out, "Number of Model States = 0\n");
+    fprintf(Out, "Number of Map Variables = 0\n");
+  }
+  else {
+    /* time series at the met stations, states half way and at the start of
+       the last day, and daily maps of snow, soil moisture, water table and
+       runoff at noon */
+    fprintf(Out, "Number of Output Pixels = %d\n", Gen->NStations);
+    for (s = 0; s < Gen->NStations; s++) {
+      fprintf(Out, "North Coordinate %d = %.1f\n", s + 1,
+	      North - (StationCell(Gen, s) / Gen->NX + 0.5) * Gen->DX);
+      fprintf(Out, "East Coordinate %d = %.1f\n", s + 1,
+	      West + (StationCell(Gen, s) % Gen->NX + 0.5) * Gen->DX);
+      fprintf(Out, "Name %d = Station%d\n", s + 1, s + 1);
+    }
+    fprintf(Out, "Number of Model States = 2\n");
+    DayToDate(Gen->Days / 2 + 1, &Month, &Day);
+    fprintf(Out, "State Date 1 = %02d/%02d/2000-00\n", Month, Day);
+    fprintf(Out, "State Date 2 = %02d/%02d/2000-00\n", EndMonth, EndDay);
+    fprintf(Out, "Number of Map Variables = 4\n");
+    fprintf(Out, "Map Variable 1 = 404\n");
+    fprintf(Out, "Map Variable 2 = 501\n");
+    fprintf(Out, "Map Variable 3 = 503\n");
+    fprintf(Out, "Map Variable 4 = 513\n");
+    for (s = 0; s < 4; s++) {
+      fprintf(Out, "Map Layer %d = 1\n", s + 1);
+      fprintf(Out, "Number of Maps %d = %d\n", s + 1, Gen->Days);
+      for (d = 0; d < Gen->Days; d++) {
+	DayToDate(d + 1, &Month, &Day);
+	fprintf(Out, "Map Date %d %d = %02d/%02d/2000-12\n", d + 1, s + 1,
+		Month, Day);
+      }
+    }
+  }
+  fprintf(Out, "Number of Image Variables = 0\n");
+  fprintf(Out, "Number of Graphics = 0\n");
+  fclose(Out);
+}
+
+/*****************************************************************************
+  WriteSediment()
+
+  Sediment input file.  The mass wasting grid has the spacing of the model
+  grid, so the model DEM and mask double as the fine resolution maps.  In
+  masswasting mode the mass wasting model runs half way through the run.
+*****************************************************************************/
+static void WriteSediment(GENOPTIONS *Gen)
+{
+  char FileName[2 * BUFSIZE + 1];
+  FILE *Out;
+  int MassWaste = strcmp(Gen->Mode, "masswasting") == 0;
+  int Day;
+  int Month;
+  int s;
+
+  /* date half way through the run, on a model step */
+  DayToDate(Gen->Days / 2 + 1, &Month, &Day);
+
+  sprintf(FileName, "%ssediment.txt", Gen->Path);
+  if (!(Out = fopen(FileName, "w"))) {
+    fprintf(stderr, "Cannot write %s\n", FileName);
+    exit(EXIT_FAILURE);
+  }
+
+  fprintf(Out, "[SEDOPTIONS]\n");
+  fprintf(Out, "Mass Wasting = %s\n", MassWaste ? "TRUE" : "FALSE");
+  fprintf(Out, "Surface Erosion = TRUE\n");
+  fprintf(Out, "Road Erosion = FALSE\n");
+  fprintf(Out, "Channel Routing = TRUE\n");
+
+  fprintf(Out, "\n[PARAMETERS]\n");
+  fprintf(Out, "Mass Wasting Spacing = %.1f\n", Gen->DX);
+  fprintf(Out, "Maximum Iterations = 10\n");
+  fprintf(Out, "Debris Flow D50 = 50.\n");
+  fprintf(Out, "Debris Flow D90 = 200.\n");
+
+  fprintf(Out, "\n[SEDTIME]\n");
+  fprintf(Out, "MWM Time Steps = 1\n");
+  fprintf(Out, "Mass Wasting Date 1 = %02d/%02d/2000-00\n", Month, Day);
+  fprintf(Out, "SE Time Steps = 1\n");
+  fprintf(Out, "Erosion Start 1 = 01/01/2000-00\n");
+  fprintf(Out, "Erosion End 1 = 12/31/2000-00\n");
+
+  fprintf(Out, "\n[FINEDEM]\n");
+  fprintf(Out, "DEM File = %sdem.bin\n", Gen->Path);
+  fprintf(Out, "Mask File = %smask.bin\n", Gen->Path);
+
+  fprintf(Out, "\n[SEDIMENT]\n");
+  fprintf(Out, "Number of Soil Types = 2\n");
+  for (s = 1; s <= 2; s++) {
+    fprintf(Out, "Soil Description %d = %s\n", s,
+	    s == 1 ? "Loam" : "Sandy loam");
+    fprintf(Out, "KIndex %d = %s\n", s, s == 1 ? "25.0" : "40.0");
+    fprintf(Out, "D50 %d = %s\n", s, s == 1 ? "0.1" : "0.4");
+    fprintf(Out, "Soil Cohesion Distribution %d = UNIFORM\n", s);
+    fprintf(Out, "SC min %d = 0.5\n", s);
+    fprintf(Out, "SC max %d = 5.0\n", s);
+    fprintf(Out, "Angle of Internal Friction Distribution %d = NORMAL\n", s);
+    fprintf(Out, "AIF mean %d = 33.0\n", s);
+    fprintf(Out, "AIF dev %d = 3.0\n", s);
+  }
+
+  fprintf(Out, "\n[VEGETATION]\n");
+  fprintf(Out, "Number of Vegetation Types = 2\n");
+  for (s = 1; s <= 2; s++) {
+    fprintf(Out, "Root Cohesion Distribution %d = UNIFORM\n", s);
+    fprintf(Out, "RC min %d = %s\n", s, s == 1 ? "2.0" : "0.5");
+    fprintf(Out, "RC max %d = %s\n", s, s == 1 ? "10.0" : "3.0");
+    fprintf(Out, "Vegetation Surcharge Distribution %d = UNIFORM\n", s);
+    fprintf(Out, "VS min %d = 0.0\n", s);
+    fprintf(Out, "VS max %d = %s\n", s, s == 1 ? "2.0" : "0.1");
+  }
+  fclose(Out);
+}
@@ -0,0 +1,64 @@
+/*
+ * SUMMARY:      progress.h - header file for the progress file
+ * USAGE:        Part of DHSVM
+ *
+ * AUTHOR:       DHSVM development team
+ * ORG:          University of Washington, Department of Civil Engineering
+ * E-MAIL:
+ * ORIG-DATE:    Oct-2026
+ * DESCRIPTION:  With PROGRESS = TRUE in the [OPTIONS] section the state of
+ *               the run is written to Progress.json in the output directory
+ *               every PROGRESS INTERVAL seconds (default 60) and at the end
+ *               of the run: simulated date, steps done and remaining, wall
+ *               time per step, cell-steps per second, kinematic wave
+ *               sub-steps, bytes read and written and the estimated
+ *               completion time.  The rates are averages over the last
+ *               PROGRESSWINDOW time steps.
+ * DESCRIP-END.
+ * FUNCTIONS:
+ * COMMENTS:     The file is written to Progress.json.tmp and renamed, so
+ *               that a reader never sees a partial file.  The counters come
+ *               from the profiler (profile.h), which counts without
+ *               reporting when only the progress file is asked for.  The
+ *               bytes are those of the binary and NetCDF maps and of the
+ *               text files read or written every step: the met station
+ *               records, Aggregated.Values, the pixel dumps, Mass.Balance
+ *               and the stream, road and sediment flow files.
+ * $Id: progress.h,v 1.0 2026/10/17 Exp $
+ */
+
+#ifndef PROGRESS_H
+#define PROGRESS_H
+
+#include "settings.h"
+#include "Calendar.h"
+
+#define PROGRESSWINDOW 64	/* Time steps in the moving averages */
+
+typedef struct {
+  int Active;			/* TRUE if the progress file is written */
+  int Interval;			/* Time between two updates (s) */
+  char FileName[BUFSIZE + 1];	/* Progress.json */
+  char TempName[BUFSIZE + 1];	/* File written before the rename */
+  double NCells;		/* Number of pixels in the basin */
+  int BaseDt;			/* Time step of the configuration (s) */
+  int NSteps;			/* Time steps done */
+  double Start;			/* Clock at the start of the run (s) */
+  double LastStep;		/* Clock at the end of the previous step (s) */
+  double LastWrite;		/* Clock at the previous update (s) */
+  DATE Simulated;		/* Model time of the last step done */
+  DATE End;			/* End of the run */
+  int Next;			/* Next entry of the window */
+  int NWindow;			/* Entries filled in the window */
+  double WallTime[PROGRESSWINDOW];	/* Wall time of each step (s) */
+  double ModelTime[PROGRESSWINDOW];	/* Model time of each step (s) */
+  double SubSteps[PROGRESSWINDOW];	/* Kinematic wave sub-steps */
+  double Bytes[PROGRESSWINDOW];		/* Bytes read and written */
+} PROGRESSSTRUCT;
+
+void InitProgress(PROGRESSSTRUCT *Progress, int Active, int Interval,
+		  char *Path, long NCells, TIMESTRUCT *Time);
+void UpdateProgress(PROGRESSSTRUCT *Progress, TIMESTRUCT *Time);
+void EndProgress(PROGRESSSTRUCT *Progress);
+
+#endif
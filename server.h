@@ -0,0 +1,71 @@
+/*
+ * SUMMARY:      server.h - header file for the forecast server
+ * USAGE:        Part of DHSVM
+ *
+ * AUTHOR:       DHSVM development team
+ * ORG:          University of Washington, Department of Civil Engineering
+ * E-MAIL:
+ * ORIG-DATE:    Oct-2026
+ * DESCRIPTION:  Collects the pointers that the forecast server needs to load,
+ *               store and advance the model state of the main program, and
+ *               the copy of the model state taken by SNAPSHOT
+ * DESCRIP-END.
+ * FUNCTIONS:
+ * COMMENTS:
+ * $Id: server.h,v 1.0 2026/10/17 Exp $
+ */
+
+#ifndef SERVER_H
+#define SERVER_H
+
+#include <stddef.h>
+#include "settings.h"
+#include "data.h"
+#include "DHSVMChannel.h"
+
+/* copy of the model state in memory, taken by SNAPSHOT */
+typedef struct {
+  size_t Size;			/* Size of the model state (bytes) */
+  size_t Offset;		/* Bytes copied so far */
+  unsigned char *Buffer;	/* Copy of the model state, NULL while the
+				   size is counted */
+} SNAPSHOTBUFFER;
+
+typedef struct {
+  MAPSIZE *Map;			/* Size and location of model area */
+  TIMESTRUCT *Time;		/* Model time */
+  OPTIONSTRUCT *Options;	/* Program options */
+  LAYER *Soil;			/* Soil layer information */
+  LAYER *Veg;			/* Vegetation layer information */
+  int NStats;			/* Number of met stations */
+  METLOCATION *Stat;		/* Met stations */
+  TOPOPIX **TopoMap;
+  PRECIPPIX **PrecipMap;
+  SNOWPIX **SnowMap;
+  SOILPIX **SoilMap;
+  VEGPIX **VegMap;
+  EVAPPIX **EvapMap;
+  SEDPIX **SedMap;
+  FINEPIX ***FineMap;
+  SOILTABLE *SType;
+  VEGTABLE *VType;
+  SNOWTABLE *SnowAlbedo;
+  ROADSTRUCT **Network;
+  MET_MAP_PIX **MetMap;
+  RADCLASSPIX **RadMap;
+  CHANNEL *ChannelData;
+  UNITHYDRINFO *HydrographInfo;
+  float *Hydrograph;
+  DUMPSTRUCT *Dump;		/* Output paths */
+  AGGREGATED *Total;		/* Basin totals */
+  WATERBALANCE *Mass;		/* Mass balance */
+  SNAPSHOTBUFFER Snapshot;	/* Model state of the last SNAPSHOT */
+} SERVERSTATE;
+
+void InitServer(SERVERSTRUCT *Server);
+
+int ServeRequests(SERVERSTATE *State);
+
+void EndServer(SERVERSTATE *State);
+
+#endif
@@ -22,9 +22,19 @@ typedef unsigned char uchar;
 typedef unsigned short unshort;
 typedef unsigned int unint;
 
+/* a static field of the pixels, stored as a 16-bit code when DHSVM is
+   built with -DCOMPACT_MAPS, see compact.h */
+#ifdef COMPACT_MAPS
+typedef unsigned short mapcode;
+#else
+typedef float mapcode;
+#endif
+
 #define MAX(x,y) ((x) > (y) ? (x) : (y))
 #define MIN(x,y) ((x) < (y) ? (x) : (y))
 #define INBASIN(x) ((x) != OUTSIDEBASIN)
+#define ISOWNED(Parallel, y, x) (!(Parallel).Active || \
+				 (Parallel).Owner[y][x] == (Parallel).Rank)
 #ifndef ABSVAL
 #define ABSVAL(x)  ( (x) < 0 ? -(x) : (x) )
 #endif
@@ -67,6 +77,28 @@ typedef unsigned int unint;
 /* Options for model extent */
 #define POINT 1
 #define BASIN 2
+#define MULTIPOINT 3
+
+/* Options for model components */
+#define FULL_MODEL 1
+#define SNOW_MODEL 2
+#define MET_MODEL 3
+
+/* Options for running an ensemble */
+#define ENSEMBLE_PROCESS 1
+#define ENSEMBLE_SHARED 2
+
+/* Options for the pages of the model maps, see placement.h */
+#define HUGEPAGES_NONE 0
+#define HUGEPAGES_TRANSPARENT 1
+#define HUGEPAGES_EXPLICIT 2
+
+/* Options for the storage order of the kinematic wave routing, see
+   order.h */
+#define ORDER_ELEVATION 0
+#define ORDER_TILED 1
+#define ORDER_MORTON 2
+#define ORDER_HILBERT 3
 
 /* Options for temperature and precipitation lapse rates */
 #define CONSTANT 1
@@ -92,6 +124,10 @@ typedef unsigned int unint;
 #define MAXUCHAR     255	/* Maximum value of a 1-byte uchar */
 #define MAXSTRING    255
 #define NAMESIZE     127
+#define MAXCALIBPARAMS 64	/* Maximum number of parameters in a calibration
+				   parameter set */
+#define MAXADAPTIVESTEPS 24	/* Maximum number of base time steps in one
+				   adaptive model time step */
 
 #define NDIRS          4	/* Number of directions in which water can flow, must equal 4 */
 #define NNEIGHBORS      8 /* Number of directions in which water and  sediment can flow based on fine grid, must equal 8 */
@@ -111,12 +147,20 @@ enum KEYS {
   shading, snotel, outside, rhoverride, precipitation_source, wind_source, 
   temp_lapse, precip_lapse, cressman_radius, cressman_stations, prism_data_path, 
   prism_data_ext, shading_data_path, shading_data_ext, skyview_data_path, 
+  threads, model_components, ensemble_file, ensemble_processes,
+  ensemble_mode, server_socket, calibration_file, calibration_processes,
+  profile, profile_steps, progress, progress_interval, cpu, tile_size,
+  output_buffer, param_maps, first_touch, huge_pages,
+  cell_order,
   /* Area */
   coordinate_system, extreme_north, extreme_west, center_latitude,
   center_longitude, time_zone_meridian, number_of_rows,
-  number_of_columns, grid_spacing, point_north, point_east,
+  number_of_columns, grid_spacing, point_north, point_east, point_file,
+  clip_segment, clip_north, clip_east,
   /* Time */
-  time_step, model_start, model_end, 
+  time_step, model_start, model_end, spinup_start, spinup_end, spinup_cycles,
+  spinup_tolerance, adaptive_steps, adaptive_precip, adaptive_melt,
+  adaptive_flow,
   /* Constants */
   ground_roughness, snow_roughness, rain_threshold, snow_threshold,
   snow_water_capacity, reference_height, rain_lai_multiplier,
@@ -30,7 +30,7 @@ extern int ydirection[NDIRS];
 /* -------------------------------------------------------------
    available functions
    ------------------------------------------------------------- */
-void ElevationSlopeAspect(MAPSIZE * Map, TOPOPIX ** TopoMap);
+void ElevationSlopeAspect(MAPSIZE * Map, TOPOPIX ** TopoMap, float **Elev);
 void HeadSlopeAspect(MAPSIZE * Map, TOPOPIX ** TopoMap, SOILPIX ** SoilMap,
 		     float **FlowGrad, unsigned char ***Dir, unsigned int **TotalDir);
 int valid_cell(MAPSIZE * Map, int x, int y);
@@ -38,6 +38,6 @@ int valid_cell_fine(MAPSIZE *Map, int x, int y);
 float ElevationSlope(MAPSIZE *Map, TOPOPIX ** TopoMap, FINEPIX ***FineMap, int y, int x, int *nexty, 
 		     int *nextx, int prevy, int prevx, float *Aspect);
 /* void ElevationSlopeAspectfine(MAPSIZE * Map, FINEPIX *** FineMap, TOPOPIX **TopoMap) ;*/
-void quick(ITEM *OrderedCells, int count);
+void quick(ITEM *OrderedCells, long count);
 #endif
 
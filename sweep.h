@@ -0,0 +1,77 @@
+/*
+ * SUMMARY:      sweep.h - header file for the per-pixel column physics sweep
+ * USAGE:        Part of DHSVM
+ *
+ * AUTHOR:       DHSVM development team
+ * ORG:          University of Washington, Department of Civil Engineering
+ * E-MAIL:
+ * ORIG-DATE:    Oct-2026
+ * DESCRIPTION:  Collects the pointers needed to run MakeLocalMetData() and
+ *               MassEnergyBalance() for a single pixel, so that the pixel
+ *               loop can be driven from the main program, from the threaded
+ *               multi-point loop, from the tiled pixel loop, or from any
+ *               other driver.
+ * DESCRIP-END.
+ * FUNCTIONS:
+ * COMMENTS:
+ * $Id: sweep.h,v 1.0 2026/10/17 Exp $
+ */
+
+#ifndef SWEEP_H
+#define SWEEP_H
+
+#include "settings.h"
+#include "data.h"
+#include "DHSVMChannel.h"
+#include "tiles.h"
+#include "compact.h"
+
+typedef struct {
+  MAPSIZE *Map;			/* Size and location of model area */
+  MAPSIZE *Radar;		/* Area covered by precipitation radar */
+  TIMESTRUCT *Time;		/* Model time */
+  OPTIONSTRUCT *Options;	/* Program options */
+  SOLARGEOMETRY *SolarGeo;	/* Sun-Earth geometry for the current step */
+  LAYER *Soil;			/* Soil layer information */
+  LAYER *Veg;			/* Vegetation layer information */
+  int NStats;			/* Number of meteorological stations */
+  METLOCATION *Stat;		/* Meteorological stations */
+  STATIONARRAYS *Stations;	/* Station data of the time step */
+  uchar ***MetWeights;		/* Station interpolation weights */
+  int NGraphics;		/* Number of X11 graphics */
+  int ShadeOffset;		/* Offset of the soil temperatures in MM5Input */
+  TOPOPIX **TopoMap;
+  RADCLASSPIX **RadMap;
+  PRECIPPIX **PrecipMap;
+  RADARPIX **RadarMap;
+  float **PrismMap;
+  SNOWPIX **SnowMap;
+  SNOWTABLE *SnowAlbedo;
+  MM5MAPS MM5Input;		/* MM5 input maps, see compact.h */
+  float ***WindModel;
+  float **PrecipLapseMap;
+  COMPACTMAPS *Compact;		/* Compact static maps, see compact.h */
+  MET_MAP_PIX ***MetMap;
+  float **SkyViewMap;
+  unsigned char ***ShadowMap;
+  ROADSTRUCT **Network;
+  VEGTABLE *VType;
+  VEGPIX **VegMap;
+  SOILTABLE *SType;
+  SOILPIX **SoilMap;
+  EVAPPIX **EvapMap;
+  CHANNEL *ChannelData;
+} CELLSWEEP;
+
+PIXMET SweepCell(CELLSWEEP *Sweep, int y, int x, PIXRAD *TotalRad);
+
+void SweepCellMembers(CELLSWEEP *Sweep, int NMembers, ENSMEMBER *Member,
+		      int y, int x, PIXRAD **TotalRad, PIXMET *LocalMet);
+
+void MultiPointMassEnergyBalance(CELLSWEEP *Sweep, TILESTRUCT *Tiles,
+				 PIXMET *PointMet, PIXRAD *TotalRad);
+
+void TiledMassEnergyBalance(CELLSWEEP *Sweep, TILESTRUCT *Tiles,
+			    PIXMET *LastMet, PIXRAD *TotalRad);
+
+#endif
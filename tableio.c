@@ -525,10 +525,17 @@ const char* TABLE_LEX_ID = "$Id: tableio.lex,v 1.4 2003/07/01 21:26:33 olivier E
 #include <stdlib.h>
 #include <string.h>
 #include <errno.h>
+#include <pthread.h>
 #include "tableio.h"
 #include "errorhandler.h"
 #include "settings.h"
 
+/* the scanner has a single state, model instances that run in different
+   threads read their tables one after the other */
+static pthread_mutex_t table_lock = PTHREAD_MUTEX_INITIALIZER;
+static __thread int table_reading = 0;	/* TRUE between table_open and
+					   table_close in this thread */
+
 static FILE *table_file = NULL;
 static char *table_file_name = NULL;
 static int table_lines = 1;
@@ -2014,19 +2021,22 @@ void table_yyfree (void * ptr )
 int
 table_open(const char *filename) 
 {
-  if (table_file != NULL) {
+  if (table_reading) {
     error_handler(ERRHDL_ERROR,
                  "table_open: already reading another table: %s",
                  table_file_name);
     return (-1);
   } 
+  pthread_mutex_lock(&table_lock);
   if ((table_file = fopen(filename, "r")) == NULL) {
     error_handler(ERRHDL_ERROR,
                  "table_open: can not open file \"%s\": %s",
                  filename, strerror(errno));
     table_file = NULL;
+    pthread_mutex_unlock(&table_lock);
     return (-1);
   }
+  table_reading = 1;
   table_file_name = (char *)strdup(filename);
   table_lines = 1;
   table_errors = 0;  
@@ -2232,7 +2242,8 @@ table_close(void)
     free(table_file_name);
     table_file_name = NULL;
   }
-  
+  table_reading = 0;
+  pthread_mutex_unlock(&table_lock);
 }
 
 
@@ -0,0 +1,95 @@
+/*
+ * SUMMARY:      tiles.h - header file for the tiled pixel scheduler
+ * USAGE:        Part of DHSVM
+ *
+ * AUTHOR:       DHSVM development team
+ * ORG:          University of Washington, Department of Civil Engineering
+ * E-MAIL:
+ * ORIG-DATE:    Oct-2026
+ * DESCRIPTION:  The basin is divided into square tiles of TILE SIZE pixels
+ *               (default 32) in the [OPTIONS] section, and tiles without
+ *               active pixels are dropped.  RunTiles() calls a function for
+ *               every tile on THREADS threads.  Each thread starts with a
+ *               contiguous block of tiles in its own queue and takes the
+ *               next tile from the front of that queue; a thread whose
+ *               queue is empty steals the last tile of another queue, so
+ *               that expensive tiles (snow, forest) do not leave the other
+ *               threads idle.  InitPointTiles() makes the tiles from a
+ *               list of points instead (EXTENT = MULTIPOINT), in blocks of
+ *               consecutive points.
+ * DESCRIP-END.
+ * FUNCTIONS:
+ * COMMENTS:     The order in which the tiles are run depends on the
+ *               scheduling.  Functions that add to a total should store a
+ *               value per active pixel (index Tile->First to
+ *               Tile->First + Tile->NCells - 1) and add the values
+ *               afterwards in the order of Tiles->RowMajor, which is the
+ *               order of the serial pixel loop, so that the totals do not
+ *               depend on the number of threads.
+ * $Id: tiles.h,v 1.0 2026/10/17 Exp $
+ */
+
+#ifndef TILES_H
+#define TILES_H
+
+#include <pthread.h>
+#include "settings.h"
+#include "data.h"
+#include "globals.h"
+
+#define DEFAULTTILESIZE 32	/* Default tile edge (pixels) */
+#define DEFAULTPOINTBLOCK 16	/* Default points per tile of a point list */
+
+typedef struct {
+  int Row;			/* First row of the tile */
+  int Col;			/* First column of the tile */
+  long First;			/* Index of the first active pixel in Cells */
+  int NCells;			/* Number of active pixels */
+} TILE;
+
+struct _tiles_;
+
+typedef struct {
+  struct _tiles_ *Tiles;	/* Scheduler of the queue */
+  int Thread;			/* Thread that owns the queue */
+  int Front;			/* Next tile taken by the owner */
+  int Back;			/* One past the tile taken by a thief */
+  pthread_mutex_t Lock;
+} TILEQUEUE;
+
+typedef void (*TILEFUNC) (void *Arg, TILE *Tile, int Thread);
+
+typedef struct _tiles_ {
+  int Size;			/* Tile edge (pixels), or points per tile of a
+				   point list */
+  int NThreads;			/* Threads, including the calling thread */
+  int NTiles;			/* Tiles with active pixels */
+  TILE *Tile;			/* Tiles, row by row */
+  long NCells;			/* Number of active pixels */
+  COORD *Cells;			/* Active pixels, tile by tile and row by row
+				   within a tile */
+  long *RowMajor;		/* Index in Cells of the active pixels in the
+				   order of the serial pixel loop */
+  TILEQUEUE *Queue;		/* Queue of each thread */
+  pthread_t *Threads;		/* Worker threads 1 .. NThreads - 1 */
+  pthread_mutex_t Lock;		/* Protects the fields below */
+  pthread_cond_t Start;		/* Signals a new run or the end */
+  pthread_cond_t Done;		/* Signals that a worker has finished */
+  int Generation;		/* Number of runs started */
+  int Busy;			/* Workers still running */
+  int Quit;			/* TRUE when the workers must exit */
+  TILEFUNC Func;		/* Function of the current run */
+  void *Arg;			/* Argument of the current run */
+  GLOBALSTATE Globals;		/* Globals of the thread that started the
+				   current run */
+} TILESTRUCT;
+
+void InitTiles(TILESTRUCT *Tiles, int NThreads, int Size, MAPSIZE *Map,
+	       TOPOPIX **TopoMap, PARALLELSTRUCT *Parallel);
+void InitPointTiles(TILESTRUCT *Tiles, int NThreads, int Size, int NPoints,
+		    COORD *Points);
+void RunTiles(TILESTRUCT *Tiles, TILEFUNC Func, void *Arg);
+int TileThread(void);
+void EndTiles(TILESTRUCT *Tiles);
+
+#endif
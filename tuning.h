@@ -0,0 +1,44 @@
+/*
+ * SUMMARY:      tuning.h - header file for the tuning file
+ * USAGE:        Part of DHSVM
+ *
+ * AUTHOR:       DHSVM development team
+ * ORG:          University of Washington, Department of Civil Engineering
+ * E-MAIL:
+ * ORIG-DATE:    Oct-2026
+ * DESCRIPTION:  DHSVM -autotune inputfile runs the first time steps of the
+ *               configuration with several values of THREADS, TILE SIZE and
+ *               OUTPUT BUFFER in the [OPTIONS] section, and writes the
+ *               fastest combination to Tuning.txt in the output directory,
+ *               together with the size of the basin and the processor.
+ *               Later runs that leave these options out take them from
+ *               Tuning.txt when the basin and the processor are the same.
+ * DESCRIP-END.
+ * FUNCTIONS:
+ * COMMENTS:     Only settings that do not change the results are tuned.
+ *               The options in the configuration file always win over the
+ *               tuning file.
+ * $Id: tuning.h,v 1.0 2026/10/17 Exp $
+ */
+
+#ifndef TUNING_H
+#define TUNING_H
+
+#include "settings.h"
+#include "data.h"
+
+#define TUNINGFILE "Tuning.txt"	/* Tuning file in the output directory */
+#define TUNINGSTEPS 4		/* Time steps timed for each candidate */
+
+typedef struct {
+  int NThreads;			/* Threads of the column physics */
+  int TileSize;			/* Edge of the tiles (pixels) */
+  int OutputBuffer;		/* Buffer of the output files (bytes), 0 for
+				   the default of the C library */
+} TUNING;
+
+void ApplyTuning(OPTIONSTRUCT *Options, MAPSIZE *Map, char *Path,
+		 TUNING *Candidate);
+void WriteTuning(char *Path, MAPSIZE *Map, TUNING *Best, double Seconds);
+
+#endif